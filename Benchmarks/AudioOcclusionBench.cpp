@@ -0,0 +1,134 @@
+// AudioOcclusionBench.cpp
+// Occlusion ray cost for AudioOcclusion against a generated island layout: a grid of rotated island slabs with a
+// terrain height grid over them, like App1::updateAudioOcclusion builds. Checks the SSE packets against the scalar
+// reference, reports ns per ray for both, then runs the per-frame budget over an emitter table to show how long a
+// full refresh of every emitter takes.
+
+#include "AudioOcclusion.h"
+#include "NullAudioBackend.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+namespace {
+
+	constexpr int ISLAND_COLUMNS = 6;
+	constexpr int ISLAND_ROWS = 6;
+	constexpr float REGION = 150.0f;	// Islands.h REGION_SIZE
+	constexpr float ISLAND_HALF = 50.0f;	// Islands.h ISLAND_SIZE
+	constexpr float CELL_SIZE = 2.0f;
+	constexpr int RAYS = 4096;
+	constexpr int REPEATS = 50;
+	constexpr int EMITTERS = 64;
+	constexpr int FRAMES = 600;
+	constexpr float DT = 1.0f / 60.0f;
+
+	float terrainHeight(float x, float z) {
+		return sinf(x * 0.1f) * cosf(z * 0.1f);	// TerrainManipulation::getHeight
+	}
+
+	AudioOcclusionGeometry makeGeometry(mt19937& rng) {
+		uniform_real_distribution<float> rotation(0.0f, 6.2831853f);
+		AudioOcclusionGeometry geometry;
+		for (int row = 0; row < ISLAND_ROWS; row++) {
+			for (int column = 0; column < ISLAND_COLUMNS; column++) {
+				AudioOccluderBox box;
+				const float x = column * REGION, z = row * REGION;
+				box.centre = AudioVector(x, terrainHeight(x, z), z);
+				box.halfExtents = AudioVector(ISLAND_HALF, 1.0f, ISLAND_HALF);
+				box.rotationY = rotation(rng);
+				geometry.boxes.push_back(box);
+			}
+		}
+
+		// Terrain wherever a point falls inside an island's rotated square
+		const float reach = ISLAND_HALF * 1.4143f;
+		geometry.originX = -reach;
+		geometry.originZ = -reach;
+		geometry.cellSize = CELL_SIZE;
+		geometry.width = (int)(((ISLAND_COLUMNS - 1) * REGION + 2.0f * reach) / CELL_SIZE);
+		geometry.depth = (int)(((ISLAND_ROWS - 1) * REGION + 2.0f * reach) / CELL_SIZE);
+		geometry.heights.assign((size_t)geometry.width * geometry.depth, AudioOcclusionGeometry::NO_TERRAIN);
+		for (int gz = 0; gz < geometry.depth; gz++) {
+			for (int gx = 0; gx < geometry.width; gx++) {
+				const float x = geometry.originX + (gx + 0.5f) * CELL_SIZE, z = geometry.originZ + (gz + 0.5f) * CELL_SIZE;
+				for (const AudioOccluderBox& box : geometry.boxes) {
+					const float lx = x - box.centre.x, lz = z - box.centre.z;
+					const float c = cosf(box.rotationY), s = sinf(box.rotationY);
+					if (fabsf(lx * c - lz * s) <= ISLAND_HALF && fabsf(lx * s + lz * c) <= ISLAND_HALF) {
+						geometry.heights[(size_t)gz * geometry.width + gx] = terrainHeight(x, z);
+						break;
+					}
+				}
+			}
+		}
+		return geometry;
+	}
+
+	double timeRays(AudioOcclusion& occlusion, const AudioVector& listener, const vector<AudioVector>& targets, vector<float>& results) {
+		const auto start = chrono::high_resolution_clock::now();
+		for (int repeat = 0; repeat < REPEATS; repeat++) occlusion.castRays(listener, targets.data(), targets.size(), results.data());
+		return chrono::duration<double, nano>(chrono::high_resolution_clock::now() - start).count() / ((double)REPEATS * targets.size());
+	}
+}
+
+int main() {
+	mt19937 rng(505);
+	const AudioOcclusionGeometry geometry = makeGeometry(rng);
+	AudioOcclusion occlusion;
+	occlusion.setGeometry(geometry);
+
+	// Listener standing on an island in the middle; emitters scattered on and between islands, at ground level
+	const AudioVector listener(2.0f * REGION + 10.0f, terrainHeight(2.0f * REGION + 10.0f, 2.0f * REGION) + 2.5f, 2.0f * REGION);
+	uniform_real_distribution<float> x(-ISLAND_HALF, (ISLAND_COLUMNS - 1) * REGION + ISLAND_HALF);
+	uniform_real_distribution<float> z(-ISLAND_HALF, (ISLAND_ROWS - 1) * REGION + ISLAND_HALF);
+	uniform_real_distribution<float> y(-3.0f, 4.0f);
+	vector<AudioVector> targets;
+	for (int i = 0; i < RAYS; i++) targets.push_back(AudioVector(x(rng), y(rng), z(rng)));
+
+	vector<float> scalarResults(RAYS), simdResults(RAYS);
+	occlusion.setSimd(false);
+	const double scalarNs = timeRays(occlusion, listener, targets, scalarResults);
+	occlusion.setSimd(true);
+	const double simdNs = timeRays(occlusion, listener, targets, simdResults);
+
+	int mismatches = 0, occluded = 0;
+	for (int i = 0; i < RAYS; i++) {
+		if (fabsf(scalarResults[i] - simdResults[i]) > 1e-6f) mismatches++;
+		if (simdResults[i] > 0.0f) occluded++;
+	}
+
+	printf("AudioOcclusion: %zu island boxes, %dx%d height grid, %d samples per ray, SSE %s\n", geometry.boxes.size(),
+		geometry.width, geometry.depth, AudioOcclusion::HEIGHT_SAMPLES, AudioDSP::hasSimd() ? "available" : "unavailable");
+	printf("  scalar         : %8.1f ns/ray\n", scalarNs);
+	printf("  SIMD           : %8.1f ns/ray, %.2fx speed-up\n", simdNs, scalarNs / simdNs);
+	printf("  results        : %d of %d rays occluded, %d SIMD/scalar mismatches\n", occluded, RAYS, mismatches);
+
+	// Budgeted updates over an emitter table, the way AudioController::flush drives it
+	AudioEmitterTable emitters;
+	NullAudioBackend backend;
+	backend.setRecording(false);
+	for (int i = 0; i < EMITTERS; i++) {
+		const int id = emitters.add(backend.createVoice("event:/Ambience"));
+		emitters.setPosition(id, targets[i]);
+		emitters.setVolume(id, 1.0f);
+	}
+
+	double updateSeconds = 0.0;
+	for (int frame = 0; frame < FRAMES; frame++) {
+		emitters.advance(DT);
+		const float t = frame * DT;
+		emitters.setListener(AudioVector(listener.x + sinf(t * 0.5f) * 60.0f, listener.y, listener.z + cosf(t * 0.5f) * 60.0f),
+			AudioVector(0.0f, 0.0f, 1.0f), AudioVector(0.0f, 1.0f, 0.0f));
+
+		const auto start = chrono::high_resolution_clock::now();
+		occlusion.update(emitters, DT);
+		updateSeconds += chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+		emitters.flush(&backend);
+	}
+
+	printf("  %d emitters    : %d rays/frame budget, %.2f us/frame, every emitter re-cast each %.1f frames\n",
+		EMITTERS, AudioOcclusion::DEFAULT_RAY_BUDGET, updateSeconds * 1e6 / FRAMES, (double)EMITTERS / AudioOcclusion::DEFAULT_RAY_BUDGET);
+	printf("  backend calls  : %zu low-pass changes over %d frames\n", backend.getCallCount(NullAudioBackend::Call::SetLowpass), FRAMES);
+	return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,146 @@
+// AudioSystemBench.cpp
+// Runs the game-side AudioSystem headless against NullAudioBackend: a scripted two minute session (BGM, sonar
+// ducking, a wandering ghost whisper and a walk past 64 island ambiences) at a fixed 60 fps. Reports the per-frame
+// cost of the audio calls the game makes, backend call counts, and optionally writes the call log as CSV for
+// plotting volume curves.
+//
+// Usage: AudioSystemBench [log.csv]
+
+#include "AudioSystem.h"
+#include "NullAudioBackend.h"
+#include <chrono>
+#include <cstdio>
+
+namespace {
+
+	constexpr int FRAMES = 60 * 120;
+	constexpr float DT = 1.0f / 60.0f;
+	constexpr int ISLANDS = 64;
+	constexpr float ISLAND_SPACING = 40.0f;
+	constexpr float SONAR_INTERVAL = 8.0f;
+	constexpr double RENDER_WORK = 200e-6;	// Non-audio time per frame in the timed runs
+
+	AudioVector listenerAt(int frame) {
+		// Walks the length of the island row and back
+		const float t = frame * DT;
+		const float length = ISLANDS * ISLAND_SPACING;
+		const float along = fmodf(t * 25.0f, 2.0f * length);
+		return AudioVector(along < length ? along : 2.0f * length - along, 5.0f, 10.0f);
+	}
+
+	AudioVector ghostAt(int frame, const AudioVector& listener) {
+		// Circles the listener, drifting in and out of whisper range
+		const float t = frame * DT;
+		const float radius = 30.0f + 25.0f * sinf(t * 0.3f);
+		return AudioVector(listener.x + cosf(t * 0.7f) * radius, listener.y + 2.0f, listener.z + sinf(t * 0.7f) * radius);
+	}
+
+	void spin(double seconds) {
+		const auto until = chrono::high_resolution_clock::now() + chrono::duration<double>(seconds);
+		while (chrono::high_resolution_clock::now() < until) {}
+	}
+
+	// Same order of calls as App1::renderAudio, Player::handleSonar, App1::updateGhostAudio and the end-of-frame flush.
+	// renderWork stands in for the rest of the frame, so a threaded backend gets time to drain the queue.
+	// Returns the seconds spent inside AudioSystem calls.
+	double runSession(AudioSystem& audio, NullAudioBackend* backend, double renderWork = 0.0) {
+		double audioTime = 0.0;
+		for (int i = 0; i < ISLANDS; i++) audio.createIslandAmbience(AudioVector(i * ISLAND_SPACING, 0.0f, 0.0f));
+		audio.playBGM1();
+
+		float sonarTimer = 0.0f;
+		for (int frame = 0; frame < FRAMES; frame++) {
+			if (backend) backend->setTime(frame * DT);
+			const auto start = chrono::high_resolution_clock::now();
+
+			const AudioVector listener = listenerAt(frame);
+			audio.update(DT);
+			audio.updateListenerPosition(listener, AudioVector(1.0f, 0.0f, 0.0f), AudioVector(0.0f, 1.0f, 0.0f));
+			audio.updateIslandAmbiences(listener, (int)(listener.x / ISLAND_SPACING + 0.5f));
+
+			sonarTimer += DT;
+			if (sonarTimer >= SONAR_INTERVAL) {
+				sonarTimer = 0.0f;
+				audio.playOneShot("event:/EchoPulse");
+				audio.dimBGM(AudioSystem::ECHO_EFFECT_DURATION);
+			}
+
+			const AudioVector ghost = ghostAt(frame, listener);
+			audio.playGhostWhisper(ghost);
+			audio.updateGhostPosition(ghost);
+			audio.updateGhostWhisperVolume(listener);
+			audio.updateGhostEffects(DT, listener);
+
+			audio.flush();
+
+			audioTime += chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+			if (renderWork > 0.0) spin(renderWork);
+		}
+		return audioTime;
+	}
+}
+
+double timeSession(bool threaded, double callCost, size_t& stalls) {
+	NullAudioBackend* backend = new NullAudioBackend();
+	backend->setRecording(false);
+	backend->setSimulatedCallCost(callCost);
+	AudioSystem audio;
+	audio.init(backend, threaded);
+
+	const double ms = runSession(audio, nullptr, RENDER_WORK) * 1000.0;
+	stalls = audio.getQueueStalls();
+	return ms;
+}
+
+int main(int argc, char** argv) {
+	srand(505);
+
+	// Timed runs: counters only, so the log does not grow inside the measurement. The times are what the
+	// calling (render) thread spends; threaded, that is only queue pushes. The second pair charges every backend
+	// call 2 us, roughly what a real engine costs, which the render thread stops paying once audio is threaded.
+	size_t stalls, threadedStalls, costlyStalls;
+	const double inlineMs = timeSession(false, 0.0, stalls);
+	const double threadedMs = timeSession(true, 0.0, threadedStalls);
+	const double costlyInlineMs = timeSession(false, 2e-6, stalls);
+	const double costlyThreadedMs = timeSession(true, 2e-6, costlyStalls);
+
+	// Recorded run, inline on simulated time so the log is reproducible
+	NullAudioBackend* backend = new NullAudioBackend();
+	AudioSystem audio;
+	audio.init(backend, false);
+	runSession(audio, backend);
+
+	printf("AudioSystem: %d frames at 60 fps, %d island ambiences, %u hardware threads\n", FRAMES, ISLANDS, thread::hardware_concurrency());
+	printf("  render thread  : %8.3f us/frame inline, %.3f us/frame threaded (%zu full-queue waits)\n",
+		inlineMs * 1000.0 / FRAMES, threadedMs * 1000.0 / FRAMES, threadedStalls);
+	printf("  2 us per call  : %8.3f us/frame inline, %.3f us/frame threaded (%zu full-queue waits)\n",
+		costlyInlineMs * 1000.0 / FRAMES, costlyThreadedMs * 1000.0 / FRAMES, costlyStalls);
+	printf("  backend calls  : %.1f per frame, %zu voices alive at the end\n", (double)backend->getTotalCalls() / FRAMES, backend->getActiveVoices());
+	for (int call = 0; call < (int)NullAudioBackend::Call::Count; call++) {
+		const size_t count = backend->getCallCount((NullAudioBackend::Call)call);
+		if (count) printf("    %-18s %8zu\n", NullAudioBackend::getCallName((NullAudioBackend::Call)call), count);
+	}
+
+	// BGM volume over the session; ducking shows as dips after every sonar pulse
+	const vector<NullAudioBackend::VolumePoint> bgmCurve = backend->getVolumeCurve(audio.getController().getEmitters().getVoice(audio.getController().events.bgm1));
+	if (!bgmCurve.empty()) {
+		float lowest = bgmCurve[0].volume, highest = bgmCurve[0].volume;
+		for (const auto& point : bgmCurve) {
+			lowest = min(lowest, point.volume);
+			highest = max(highest, point.volume);
+		}
+		printf("  BGM volume     : %zu points, %.2f to %.2f\n", bgmCurve.size(), lowest, highest);
+	}
+
+	if (argc > 1) {
+		FILE* file = fopen(argv[1], "w");
+		if (!file) {
+			fprintf(stderr, "Could not write %s\n", argv[1]);
+			return 1;
+		}
+		backend->writeLog(file);
+		fclose(file);
+		printf("  log written to %s\n", argv[1]);
+	}
+	return 0;
+}
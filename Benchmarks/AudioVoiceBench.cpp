@@ -0,0 +1,110 @@
+// AudioVoiceBench.cpp
+// Voice selection cost for AudioVoiceManager with 10k island-ambience style emitters, against the previous
+// approach of touching every emitter every frame. The stub backend only counts the instance create/release
+// calls a promotion or demotion would cost in FMOD. First, a check that voices go by XZ distance, as the
+// controller's ambiences do: an emitter high above the listener keeps its voice over a farther one at its height.
+
+#include "AudioVoiceManager.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+namespace {
+
+	struct StubVoiceBackend {
+		size_t created = 0;
+		size_t released = 0;
+		size_t attributeUpdates = 0;
+
+		void promote(int) { created++; }
+		void demote(int) { released++; }
+		void setAttributes(int) { attributeUpdates++; }
+	};
+
+	constexpr int EMITTERS = 10000;
+	constexpr int FRAMES = 2000;
+	constexpr float WORLD_SIZE = 2000.0f;	// ~40 emitters inside any listener's audible radius
+	constexpr float MAX_DISTANCE = 70.0f;	// AudioSystem::AMBIENCE_MAX_DISTANCE
+	constexpr int MAX_VOICES = 8;
+}
+
+int main() {
+	// Height ignored: the emitter 5 units off and 40 up beats the one 20 units off at the listener's height
+	AudioVoiceManager ranking(100.0f);
+	ranking.setMaxVoices(1);
+	const int above = ranking.addEmitter(AudioVector(5.0f, 40.0f, 0.0f), MAX_DISTANCE);
+	ranking.addEmitter(AudioVector(20.0f, 0.0f, 0.0f), MAX_DISTANCE);
+	vector<int> rankPromoted, rankDemoted;
+	ranking.update(AudioVector(0.0f, 0.0f, 0.0f), rankPromoted, rankDemoted);
+	const bool heightIgnored = rankPromoted.size() == 1 && rankPromoted[0] == above && ranking.isReal(above);
+
+	mt19937 rng(505);
+	uniform_real_distribution<float> coordinate(0.0f, WORLD_SIZE);
+	uniform_real_distribution<float> volume(0.5f, 1.0f);
+
+	AudioVoiceManager voices(100.0f);
+	voices.setMaxVoices(MAX_VOICES);
+	vector<AudioVector> positions;
+	for (int i = 0; i < EMITTERS; i++) {
+		positions.push_back(AudioVector(coordinate(rng), 0.0f, coordinate(rng)));
+		voices.addEmitter(positions.back(), MAX_DISTANCE, volume(rng));
+	}
+
+	// Listener walks a slow circle through the emitter field, like a player crossing islands
+	auto listenerAt = [](int frame) {
+		const float t = frame * 0.002f;
+		return AudioVector(WORLD_SIZE * 0.5f + cosf(t) * 600.0f, 0.0f, WORLD_SIZE * 0.5f + sinf(t) * 600.0f);
+	};
+
+	struct GridRun {
+		StubVoiceBackend backend;
+		size_t visited = 0;
+		double ms = 0.0;
+	};
+
+	auto runGrid = [&](float hysteresis) {
+		GridRun run;
+		vector<int> promoted, demoted;
+		voices.setHysteresis(hysteresis);
+
+		const auto start = chrono::high_resolution_clock::now();
+		for (int frame = 0; frame < FRAMES; frame++) {
+			voices.update(listenerAt(frame), promoted, demoted);
+			for (int id : demoted) run.backend.demote(id);
+			for (int id : promoted) run.backend.promote(id);
+			for (int id : voices.getRealVoices()) run.backend.setAttributes(id);
+			run.visited += voices.getLastVisited();
+		}
+		run.ms = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+
+		// Release everything so the next run starts from silence
+		voices.update(AudioVector(-1e6f, 0.0f, -1e6f), promoted, demoted);
+		return run;
+	};
+
+	const GridRun withHysteresis = runGrid(0.25f);
+	const GridRun noHysteresis = runGrid(0.0f);
+
+	// Baseline: score every emitter every frame, as updateIslandAmbiences did
+	StubVoiceBackend bruteBackend;
+	float checksum = 0.0f;
+	const auto bruteStart = chrono::high_resolution_clock::now();
+	for (int frame = 0; frame < FRAMES; frame++) {
+		const AudioVector listener = listenerAt(frame);
+		for (int i = 0; i < EMITTERS; i++) {
+			const float distance = audioDistanceXZ(positions[i], listener);
+			checksum += distance < MAX_DISTANCE ? 1.0f - distance / MAX_DISTANCE : 0.0f;
+			bruteBackend.setAttributes(i);
+		}
+	}
+	const double bruteMs = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - bruteStart).count();
+
+	printf("AudioVoiceManager: %d emitters, %d frames, max %d voices\n", EMITTERS, FRAMES, MAX_VOICES);
+	printf("  XZ ranking     : %s\n", heightIgnored ? "height ignored" : "FAILED, a higher emitter lost its voice");
+	printf("  grid selection : %8.3f us/frame, %.1f emitters scored/frame\n", withHysteresis.ms * 1000.0 / FRAMES, (double)withHysteresis.visited / FRAMES);
+	printf("  all emitters   : %8.3f us/frame (checksum %.1f)\n", bruteMs * 1000.0 / FRAMES, checksum);
+	printf("  backend calls  : %zu creates, %zu releases, %zu attribute updates (vs %zu touching every emitter)\n",
+		withHysteresis.backend.created, withHysteresis.backend.released, withHysteresis.backend.attributeUpdates, bruteBackend.attributeUpdates);
+	printf("  no hysteresis  : %zu creates, %zu releases\n", noHysteresis.backend.created, noHysteresis.backend.released);
+	return heightIgnored ? 0 : 1;
+}
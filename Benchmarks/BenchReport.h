@@ -0,0 +1,75 @@
+#pragma once
+// Benchmark results as rows of name, size, value and unit: printed as they come in, and written out as JSON when the
+// run is given --json <path>, so a dashboard can follow each row from build to build. Sizes say what the value was
+// measured against (islands, queries), so one name can be plotted along them.
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class BenchReport {
+public:
+	BenchReport(const char* suiteName, int argc, char** argv) : suite(suiteName) {
+		for (int i = 1; i + 1 < argc; i++) {
+			if (strcmp(argv[i], "--json") == 0) jsonPath = argv[i + 1];
+		}
+	}
+
+	void setInfo(const string& key, const string& value) { info.push_back({ key, value }); }
+
+	void add(const string& name, long long size, double value, const char* unit) {
+		rows.push_back({ name, size, value, unit });
+		printf("  %-32s %9lld %14.4f %s\n", name.c_str(), size, value, unit);
+	}
+
+	// True when there was nothing to write or it was all written
+	bool write() const {
+		if (jsonPath.empty()) return true;
+		FILE* file = fopen(jsonPath.c_str(), "w");
+		if (!file) {
+			fprintf(stderr, "Could not write %s\n", jsonPath.c_str());
+			return false;
+		}
+		fprintf(file, "{\n  \"suite\": \"%s\",\n  \"info\": {", escape(suite).c_str());
+		for (size_t i = 0; i < info.size(); i++) {
+			fprintf(file, "%s\"%s\": \"%s\"", i ? ", " : "", escape(info[i].key).c_str(), escape(info[i].value).c_str());
+		}
+		fprintf(file, "},\n  \"results\": [\n");
+		for (size_t i = 0; i < rows.size(); i++) {
+			const Row& row = rows[i];
+			fprintf(file, "    {\"name\": \"%s\", \"size\": %lld, \"value\": %.6g, \"unit\": \"%s\"}%s\n",
+				escape(row.name).c_str(), row.size, row.value, escape(row.unit).c_str(), i + 1 < rows.size() ? "," : "");
+		}
+		fprintf(file, "  ]\n}\n");
+		return fclose(file) == 0;
+	}
+
+private:
+	struct Row {
+		string name;
+		long long size;
+		double value;
+		string unit;
+	};
+
+	struct Info {
+		string key, value;
+	};
+
+	static string escape(const string& text) {
+		string escaped;
+		for (char c : text) {
+			if (c == '"' || c == '\\') escaped += '\\';
+			escaped += c;
+		}
+		return escaped;
+	}
+
+	string suite;
+	string jsonPath;
+	vector<Info> info;
+	vector<Row> rows;
+};
@@ -0,0 +1,109 @@
+// BlockDecoderBench.cpp
+// BlockDecoder, which gives TerrainDisplacement its heights from the baked island floor texture, against
+// TextureBaker's reference decoder: a generated 90x38 image, smooth with noise and odd sizes so edge blocks are cut,
+// is baked to BC1, BC3 and BC7 and both decoders must give the same bytes, rows written at a padded pitch without
+// touching the padding. A BC7 block in a mode the baker never writes must be refused rather than decoded wrong. Then
+// the heights TerrainDisplacement keeps from the decoded BC7 against those from the source, and what decoding a
+// 1024x1024 BC7 level costs at startup.
+
+#include "BlockDecoder.h"
+#include "BCEncoder.h"
+#include "TerrainDisplacement.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+namespace {
+
+	constexpr int WIDTH = 90, HEIGHT = 38;
+	constexpr int PADDING = 12;	// Bytes after each decoded row
+	constexpr int LARGE = 1024;
+	constexpr int REPEATS = 10;
+
+	ImageRGBA image(int width, int height, unsigned seed) {
+		mt19937 rng(seed);
+		uniform_int_distribution<int> noise(-12, 12);
+		ImageRGBA result;
+		result.resize(width, height);
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				uint8_t* texel = result.row(y) + x * 4;
+				const float u = (float)x / width, v = (float)y / height;
+				const int base[4] = { (int)(128 + 100 * sinf(u * 9.0f)), (int)(255 * v), (int)(200 * u * v), (int)(255 - 200 * u) };
+				for (int c = 0; c < 4; c++) texel[c] = (uint8_t)min(255, max(0, base[c] + noise(rng)));
+			}
+		}
+		return result;
+	}
+
+	BlockFormat blockFormat(BCFormat format) {
+		return format == BCFormat::BC1 ? BlockFormat::BC1 : format == BCFormat::BC3 ? BlockFormat::BC3 : BlockFormat::BC7;
+	}
+
+	bool matchesReference(const ImageRGBA& source, BCFormat format) {
+		vector<uint8_t> blocks;
+		BCEncoder::encodeImage(source, format, blocks);
+		ImageRGBA reference;
+		BCEncoder::decodeImage(blocks.data(), format, source.width, source.height, reference);
+
+		const size_t pitch = (size_t)source.width * 4 + PADDING;
+		vector<uint8_t> decoded(pitch * source.height, 0xcd);
+		if (!BlockDecoder::decode(blockFormat(format), blocks.data(), source.width, source.height, decoded.data(), pitch)) return false;
+		for (int y = 0; y < source.height; y++) {
+			const uint8_t* row = decoded.data() + y * pitch;
+			if (memcmp(row, reference.row(y), (size_t)source.width * 4) != 0) return false;
+			for (int i = 0; i < PADDING; i++) {
+				if (row[source.width * 4 + i] != 0xcd) return false;
+			}
+		}
+		return true;
+	}
+
+	// Mode 5 sets bit 5 of the first byte; mode 6 is bit 6
+	bool refusesOtherModes() {
+		const ImageRGBA source = image(4, 4, 3);
+		vector<uint8_t> block;
+		BCEncoder::encodeImage(source, BCFormat::BC7, block);
+		uint8_t texels[64];
+		if (!BlockDecoder::decodeBC7(block.data(), texels)) return false;
+		block[0] = (uint8_t)((block[0] & 0x80) | 0x20);
+		return !BlockDecoder::decodeBC7(block.data(), texels);
+	}
+}
+
+int main() {
+	const ImageRGBA source = image(WIDTH, HEIGHT, 7);
+	const bool bc1 = matchesReference(source, BCFormat::BC1);
+	const bool bc3 = matchesReference(source, BCFormat::BC3);
+	const bool bc7 = matchesReference(source, BCFormat::BC7);
+	const bool refused = refusesOtherModes();
+	printf("BlockDecoder: %dx%d against TextureBaker's decoder: BC1 %s, BC3 %s, BC7 %s; other BC7 modes refused %s\n",
+		WIDTH, HEIGHT, bc1 ? "ok" : "FAILED", bc3 ? "ok" : "FAILED", bc7 ? "ok" : "FAILED", refused ? "ok" : "FAILED");
+
+	// The floor baked to BC7: heights from it stay within BC7's error of the source's, which they now stand in for
+	const ImageRGBA floor = image(LARGE, LARGE, 11);
+	vector<uint8_t> blocks;
+	BCEncoder::encodeImage(floor, BCFormat::BC7, blocks);
+	vector<uint8_t> decoded((size_t)LARGE * LARGE * 4);
+	bool decodedOk = true;
+	const auto start = chrono::high_resolution_clock::now();
+	for (int i = 0; i < REPEATS; i++) {
+		decodedOk = BlockDecoder::decode(BlockFormat::BC7, blocks.data(), LARGE, LARGE, decoded.data(), LARGE * 4) && decodedOk;
+	}
+	const double ms = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count() / REPEATS;
+
+	TerrainDisplacement fromSource, fromBaked;
+	fromSource.setTexture(LARGE, LARGE, floor.pixels.data(), LARGE * 4);
+	fromBaked.setTexture(LARGE, LARGE, decoded.data(), LARGE * 4);
+	float worst = 0.0f;
+	for (int i = 0; i < 10000; i++) {
+		const float u = (i % 100 + 0.37f) / 100.0f, v = (i / 100 + 0.61f) / 100.0f;
+		worst = max(worst, fabsf(fromSource.sample(u, v) - fromBaked.sample(u, v)));
+	}
+	const bool close = decodedOk && worst < 0.1f;
+	printf("  %dx%d BC7 level: %.2f ms to decode; heights against the source within %.4f of full scale %s\n", LARGE, LARGE,
+		ms, worst, close ? "ok" : "FAILED");
+	return bc1 && bc3 && bc7 && refused && close ? 0 : 1;
+}
@@ -0,0 +1,212 @@
+// FlowFieldBench.cpp
+// FlowFields over a generated island layout: rotated islands joined by bridges in a snake, so most pings are only
+// reachable the long way round. Reports the cost of one field built in one go and spread over frames at the default
+// budget, the cost of a sample, and then pings a 10k-ghost GhostSwarm to compare how much of the response is spent
+// over open water flying straight versus following the shared field. Also checks the SSE swarm against the scalar
+// reference with fields in use.
+
+#include "FlowFields.h"
+#include "GhostSwarm.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+namespace {
+
+	constexpr int ISLAND_COLUMNS = 6;
+	constexpr int ISLAND_ROWS = 6;
+	constexpr float REGION = 150.0f;	// Islands.h REGION_SIZE
+	constexpr float ISLAND_HALF = 50.0f;	// TerrainManipulation::isOnTerrain
+	constexpr float BRIDGE_WIDTH = 5.0f;	// TerrainManipulation::BRIDGE_WIDTH
+	constexpr float CELL_SIZE = 2.0f;
+	constexpr int SAMPLES = 4000000;
+	constexpr int GHOSTS = 10000;
+	constexpr float DT = 1.0f / 60.0f;
+	constexpr float PING_DURATION = 5.0f;	// SonarData::sonarDuration
+	constexpr int SETTLE_FRAMES = 120;
+
+	struct Layout {
+		vector<GhostVector> islands;
+		vector<float> rotations;
+		vector<pair<int, int>> bridges;
+	};
+
+	// Rows joined end to end, alternating sides, so neighbouring rows only meet at one end
+	Layout makeLayout(mt19937& rng) {
+		uniform_real_distribution<float> rotation(-0.3f, 0.3f);
+		Layout layout;
+		for (int row = 0; row < ISLAND_ROWS; row++) {
+			for (int column = 0; column < ISLAND_COLUMNS; column++) {
+				layout.islands.push_back(GhostVector(column * REGION, 0.0f, row * REGION));
+				layout.rotations.push_back(rotation(rng));
+				if (column > 0) layout.bridges.push_back({ row * ISLAND_COLUMNS + column - 1, row * ISLAND_COLUMNS + column });
+			}
+			if (row > 0) {
+				const int column = row % 2 ? ISLAND_COLUMNS - 1 : 0;
+				layout.bridges.push_back({ (row - 1) * ISLAND_COLUMNS + column, row * ISLAND_COLUMNS + column });
+			}
+		}
+		return layout;
+	}
+
+	float distanceToSegment(float x, float z, const GhostVector& a, const GhostVector& b) {
+		const float abX = b.x - a.x, abZ = b.z - a.z;
+		const float t = max(0.0f, min(1.0f, ((x - a.x) * abX + (z - a.z) * abZ) / (abX * abX + abZ * abZ)));
+		const float dx = x - (a.x + abX * t), dz = z - (a.z + abZ * t);
+		return sqrtf(dx * dx + dz * dz);
+	}
+
+	// Same walkability App1::updateGhostIslands builds from TerrainManipulation::isOnTerrain and onBridge
+	FlowFieldGrid makeGrid(const Layout& layout) {
+		const float reach = ISLAND_HALF * 1.4143f;
+		FlowFieldGrid grid;
+		grid.originX = -reach;
+		grid.originZ = -reach;
+		grid.cellSize = CELL_SIZE;
+		grid.width = (int)ceilf(((ISLAND_COLUMNS - 1) * REGION + 2.0f * reach) / CELL_SIZE);
+		grid.depth = (int)ceilf(((ISLAND_ROWS - 1) * REGION + 2.0f * reach) / CELL_SIZE);
+		grid.walkable.assign((size_t)grid.width * grid.depth, 0);
+		for (int gz = 0; gz < grid.depth; gz++) {
+			for (int gx = 0; gx < grid.width; gx++) {
+				const float x = grid.originX + (gx + 0.5f) * CELL_SIZE, z = grid.originZ + (gz + 0.5f) * CELL_SIZE;
+				bool walkable = false;
+				for (size_t i = 0; i < layout.islands.size() && !walkable; i++) {
+					const float lx = x - layout.islands[i].x, lz = z - layout.islands[i].z;
+					const float c = cosf(layout.rotations[i]), s = sinf(layout.rotations[i]);
+					walkable = fabsf(lx * c - lz * s) <= ISLAND_HALF && fabsf(lx * s + lz * c) <= ISLAND_HALF;
+				}
+				for (size_t b = 0; b < layout.bridges.size() && !walkable; b++) {
+					walkable = distanceToSegment(x, z, layout.islands[layout.bridges[b].first], layout.islands[layout.bridges[b].second]) < BRIDGE_WIDTH * 0.5f;
+				}
+				grid.walkable[(size_t)gz * grid.width + gx] = walkable ? 1 : 0;
+			}
+		}
+		return grid;
+	}
+
+	bool walkableAt(const FlowFieldGrid& grid, float x, float z) {
+		const int gx = (int)floorf((x - grid.originX) / grid.cellSize), gz = (int)floorf((z - grid.originZ) / grid.cellSize);
+		return gx >= 0 && gx < grid.width && gz >= 0 && gz < grid.depth && grid.walkable[(size_t)gz * grid.width + gx];
+	}
+
+	struct ResponseStats {
+		long long steps = 0, overWater = 0;
+		int responders = 0, reached = 0;
+	};
+
+	// Lets the swarm settle, pings the far corner of the snake and follows the response to the end
+	ResponseStats runResponse(GhostSwarm& swarm, FlowFields* fields, const Layout& layout, const FlowFieldGrid& grid, bool simd) {
+		swarm.setSimd(simd);
+		swarm.setFlowFields(fields);
+		swarm.resize(GHOSTS, 505);
+		swarm.setIslands(layout.islands);
+		for (int frame = 0; frame < SETTLE_FRAMES; frame++) swarm.update(DT);
+
+		const GhostVector& corner = layout.islands[(ISLAND_ROWS - 1) * ISLAND_COLUMNS + (ISLAND_ROWS % 2 ? ISLAND_COLUMNS - 1 : 0)];
+		const GhostVector target(corner.x, corner.y + 3.0f, corner.z);
+		const int field = fields ? fields->request(target.x, target.z) : -1;
+		swarm.respondToSonar(target, PING_DURATION, field);
+
+		ResponseStats stats;
+		vector<char> reached(GHOSTS, 0);
+		for (int i = 0; i < GHOSTS; i++) if (swarm.isRespondingToSonar(i)) stats.responders++;
+		const int frames = (int)(PING_DURATION / DT) + 2;
+		for (int frame = 0; frame < frames; frame++) {
+			if (fields) fields->update();
+			for (int i = 0; i < GHOSTS; i++) {
+				if (!swarm.isRespondingToSonar(i)) continue;
+				const GhostVector position = swarm.getPosition(i);
+				stats.steps++;
+				if (!walkableAt(grid, position.x, position.z)) stats.overWater++;
+				const float dx = position.x - target.x, dz = position.z - target.z;
+				if (dx * dx + dz * dz < 4.0f * CELL_SIZE * CELL_SIZE) reached[i] = 1;
+			}
+			swarm.update(DT);
+		}
+		for (char ghost : reached) stats.reached += ghost;
+		return stats;
+	}
+
+	bool sameBits(float a, float b) {
+		return memcmp(&a, &b, sizeof(float)) == 0;
+	}
+}
+
+int main() {
+	mt19937 rng(505);
+	const Layout layout = makeLayout(rng);
+	const FlowFieldGrid grid = makeGrid(layout);
+	size_t walkableCells = 0;
+	for (uint8_t cell : grid.walkable) walkableCells += cell;
+	printf("FlowFields: %d islands, %zu bridges, %dx%d grid of %.0f-unit cells, %.0f%% walkable\n", (int)layout.islands.size(),
+		layout.bridges.size(), grid.width, grid.depth, CELL_SIZE, 100.0 * walkableCells / grid.walkable.size());
+
+	// One field in one go
+	FlowFields fields;
+	fields.setGrid(grid);
+	fields.setCellBudget(grid.width * grid.depth);
+	auto start = chrono::high_resolution_clock::now();
+	const int whole = fields.request(layout.islands.back().x, layout.islands.back().z);
+	fields.update();
+	const double wholeMs = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+	printf("  whole field    : %.2f ms, %d cells settled\n", wholeMs, fields.getLastSettledCount());
+
+	// The same field spread over frames at the default budget
+	fields.setGrid(grid);
+	fields.setCellBudget(FlowFields::DEFAULT_CELL_BUDGET);
+	const int handle = fields.request(layout.islands.back().x, layout.islands.back().z);
+	int frames = 0;
+	double worstUs = 0.0;
+	while (!fields.isComplete(handle)) {
+		start = chrono::high_resolution_clock::now();
+		fields.update();
+		worstUs = max(worstUs, chrono::duration<double, micro>(chrono::high_resolution_clock::now() - start).count());
+		frames++;
+	}
+	printf("  incremental    : %d cells per update, complete after %d updates, worst %.0f us\n", FlowFields::DEFAULT_CELL_BUDGET, frames, worstUs);
+	printf("  stale handle   : %s\n", fields.isComplete(whole) ? "still valid (WRONG)" : "rejected");
+
+	// O(1) sampling
+	uniform_real_distribution<float> x(grid.originX, grid.originX + grid.width * CELL_SIZE);
+	uniform_real_distribution<float> z(grid.originZ, grid.originZ + grid.depth * CELL_SIZE);
+	vector<float> points(2 * 4096);
+	for (float& point : points) point = ((&point - points.data()) & 1) ? z(rng) : x(rng);
+	float checksum = 0.0f;
+	int hits = 0;
+	start = chrono::high_resolution_clock::now();
+	for (int i = 0; i < SAMPLES; i++) {
+		FlowFieldSample sample;
+		const size_t p = (size_t)(i & 4095) * 2;
+		if (fields.sample(handle, points[p], points[p + 1], sample)) {
+			checksum += sample.distance;
+			hits++;
+		}
+	}
+	const double sampleNs = chrono::duration<double, nano>(chrono::high_resolution_clock::now() - start).count() / SAMPLES;
+	printf("  sample         : %.1f ns (%d%% of random points settled, checksum %.0f)\n", sampleNs, (int)(100.0 * hits / SAMPLES), checksum);
+
+	// A swarm answering a ping at the far end of the snake, straight versus along the shared field
+	GhostSwarm straightSwarm, fieldSwarm, scalarSwarm;
+	FlowFields swarmFields, scalarFields;
+	swarmFields.setGrid(grid);
+	scalarFields.setGrid(grid);
+	const ResponseStats straight = runResponse(straightSwarm, nullptr, layout, grid, true);
+	const ResponseStats followed = runResponse(fieldSwarm, &swarmFields, layout, grid, true);
+	runResponse(scalarSwarm, &scalarFields, layout, grid, false);
+	printf("  straight line  : %d responders, %4.1f%% of response steps over water, %d reached the ping\n",
+		straight.responders, 100.0 * straight.overWater / max(straight.steps, 1LL), straight.reached);
+	printf("  flow field     : %d responders, %4.1f%% of response steps over water, %d reached the ping\n",
+		followed.responders, 100.0 * followed.overWater / max(followed.steps, 1LL), followed.reached);
+	printf("  shared cost    : one field for %d responders, %.2f us each\n", followed.responders, wholeMs * 1000.0 / max(followed.responders, 1));
+
+	int mismatches = 0;
+	for (int i = 0; i < GHOSTS; i++) {
+		const GhostVector a = fieldSwarm.getPosition(i), b = scalarSwarm.getPosition(i);
+		if (!sameBits(a.x, b.x) || !sameBits(a.y, b.y) || !sameBits(a.z, b.z)) mismatches++;
+	}
+	printf("  SIMD vs scalar : %d mismatches\n", mismatches);
+	return mismatches == 0 && !fields.isComplete(whole) ? 0 : 1;
+}
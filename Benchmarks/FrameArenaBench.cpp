@@ -0,0 +1,299 @@
+// FrameArenaBench.cpp
+// FrameArena, ScratchScope and ArenaAllocator. First correctness: every alignment is honoured, allocations never
+// overlap across block boundaries, scopes rewind to where they started without being counted as a frame, and
+// containers on an arena grow, copy and rebind. Then the steady state: frames shaped like App1's (a frame-lived array of pickup heights, scratch rows for
+// terrain queries, a mesh's vertex and index arrays and a spanning tree over the islands) run with every global
+// operator new counted, and after a few frames of warming up neither the heap nor the arena's own blocks may be
+// touched again. Last, what it costs: one allocation against new/delete, and Islands' spanning tree as it was, with a
+// matrix of every pair in nested vectors, against Prim's over scratch arrays measuring distances as it goes.
+
+#include "FrameArena.h"
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+namespace {
+	atomic<size_t> heapAllocations{ 0 };
+}
+
+void* operator new(size_t size) {
+	heapAllocations++;
+	if (void* data = malloc(size ? size : 1)) return data;
+	throw bad_alloc();
+}
+
+void operator delete(void* data) noexcept { free(data); }
+void operator delete(void* data, size_t) noexcept { free(data); }
+
+namespace {
+
+	constexpr int WARM_UP_FRAMES = 8;
+	constexpr int FRAMES = 240;
+	constexpr int ISLANDS = 100;	// SceneData's default island count is far lower; this is a busy world
+	constexpr int PICKUPS = 4 * ISLANDS;
+	constexpr int ROW = 600;	// Terrain query row, as App1::updateHeightPyramid makes them
+	constexpr int MESH_RESOLUTION = 100;	// PlaneMesh's default
+	constexpr int ALLOCATIONS = 1000000;
+	const int MST_COUNTS[] = { 250, 1000, 2000 };
+
+	struct Vertex {
+		float position[3], texture[2], normal[3];
+	};
+
+	struct Point {
+		float x, z;
+	};
+
+	double milliseconds(chrono::high_resolution_clock::time_point start) {
+		return chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+	}
+
+	// Islands::GenerateMinimumSpanningTree as it was
+	vector<size_t> spanningTreeMatrix(const vector<Point>& points) {
+		const size_t count = points.size();
+		vector<vector<float>> distanceMatrix(count, vector<float>(count));
+		for (size_t i = 0; i < count; ++i) {
+			for (size_t j = i + 1; j < count; ++j) {
+				distanceMatrix[i][j] = distanceMatrix[j][i] = hypotf(points[j].x - points[i].x, points[j].z - points[i].z);
+			}
+		}
+		vector<bool> inMST(count, false);
+		vector<size_t> parent(count, 0);
+		vector<float> key(count, FLT_MAX);
+		key[0] = 0;
+		parent[0] = (size_t)-1;
+		for (size_t added = 0; added < count - 1; ++added) {
+			const size_t u = min_element(key.begin(), key.end()) - key.begin();
+			inMST[u] = true;
+			key[u] = FLT_MAX;
+			for (size_t v = 0; v < count; ++v) {
+				if (!inMST[v] && distanceMatrix[u][v] < key[v]) {
+					parent[v] = u;
+					key[v] = distanceMatrix[u][v];
+				}
+			}
+		}
+		return parent;
+	}
+
+	// As it is now; parents go to the caller's array
+	void spanningTreeScratch(const Point* points, size_t count, size_t* parent) {
+		ScratchScope scratch;
+		bool* inMST = scratch.allocate<bool>(count);
+		float* key = scratch.allocate<float>(count);
+		fill(inMST, inMST + count, false);
+		fill(parent, parent + count, 0);
+		fill(key, key + count, FLT_MAX);
+		key[0] = 0;
+		parent[0] = (size_t)-1;
+		for (size_t added = 0; added < count - 1; ++added) {
+			const size_t u = min_element(key, key + count) - key;
+			inMST[u] = true;
+			key[u] = FLT_MAX;
+			for (size_t v = 0; v < count; ++v) {
+				if (inMST[v]) continue;
+				const float distance = hypotf(points[v].x - points[u].x, points[v].z - points[u].z);
+				if (distance < key[v]) {
+					parent[v] = u;
+					key[v] = distance;
+				}
+			}
+		}
+	}
+
+	bool checkAlignment() {
+		FrameArena arena(256);	// Small blocks, so plenty of allocations straddle where a block would end
+		mt19937 rng(3);
+		vector<pair<uintptr_t, size_t>> spans;
+		for (int i = 0; i < 2000; i++) {
+			const size_t alignment = (size_t)1 << (rng() % 7);
+			const size_t bytes = 1 + rng() % 300;
+			const uintptr_t address = reinterpret_cast<uintptr_t>(arena.allocate(bytes, alignment));
+			if (address % alignment != 0) return false;
+			memset(reinterpret_cast<void*>(address), i & 0xff, bytes);
+			spans.push_back({ address, bytes });
+		}
+		sort(spans.begin(), spans.end());
+		for (size_t i = 1; i < spans.size(); i++) {
+			if (spans[i - 1].first + spans[i - 1].second > spans[i].first) return false;
+		}
+		return arena.getStats().allocations == 2000;
+	}
+
+	bool checkScopes() {
+		FrameArena arena(1024);
+		int* outer = arena.allocate<int>(10);
+		const FrameArena::Marker start = arena.getMarker();
+		{
+			ScratchScope scope(arena);
+			scope.allocate<double>(1000);	// Past the first block
+			{
+				ScratchScope inner(arena);
+				inner.allocate<char>(5000);
+			}
+			scope.allocate<float>(3);
+		}
+		const FrameArena::Marker end = arena.getMarker();
+		if (start.block != end.block || start.offset != end.offset || start.bytes != end.bytes) return false;
+
+		// The last allocation can be given back; anything under it cannot
+		int* last = arena.allocate<int>(4);
+		arena.release(outer, 10 * sizeof(int));
+		const size_t before = arena.getStats().bytes;
+		arena.release(last, 4 * sizeof(int));
+		if (arena.getStats().bytes != before - 4 * sizeof(int)) return false;
+
+		// Three blocks became one that holds them all
+		const size_t capacity = arena.getStats().capacity;
+		arena.reset();
+		return arena.getStats().capacity == capacity && arena.getStats().bytes == 0 && arena.getStats().lastAllocations == 5;
+	}
+
+	// A scope opened on an empty arena, as a mesh's initBuffers is at load, rewinds without standing in for reset()
+	bool checkScopeOnEmptyArena() {
+		FrameArena arena(1024);
+		arena.allocate<char>(3000);
+		arena.allocate<char>(10);	// Past the first block
+		arena.reset();
+		const size_t blocks = arena.getStats().blockAllocations;
+		{
+			ScratchScope scope(arena);
+			scope.allocate<char>(10000);	// Past the merged one; the new block stays beside it
+		}
+		const FrameArena::Stats& stats = arena.getStats();
+		return stats.bytes == 0 && stats.lastAllocations == 2 && stats.allocations == 1 && stats.blockAllocations == blocks + 1;
+	}
+
+	bool checkContainers() {
+		FrameArena arena(512);
+		ArenaVector<int> numbers(arena);
+		for (int i = 0; i < 1000; i++) numbers.push_back(i);	// Each growth leaves the old buffer behind
+		ArenaVector<int> copy(numbers);
+		vector<pair<int, float>, ArenaAllocator<pair<int, float>>> pairs{ ArenaAllocator<char>(arena) };
+		pairs.assign(100, { 1, 2.0f });
+		long long sum = 0;
+		for (int number : copy) sum += number;
+		return sum == 999 * 1000 / 2 && copy.get_allocator() == numbers.get_allocator() && pairs.back().first == 1;
+	}
+
+	// One frame shaped like App1's; returns something from everything so none of it is optimised away
+	float frame(FrameArena& frameArena, const vector<Point>& islands, mt19937& rng) {
+		frameArena.reset();
+		float* pickupHeights = frameArena.allocate<float>(PICKUPS);
+		float total = 0.0f;
+		{
+			ScratchScope scratch(frameArena);
+			float* x = scratch.allocate<float>(PICKUPS);
+			float* z = scratch.allocate<float>(PICKUPS);
+			for (int i = 0; i < PICKUPS; i++) {
+				x[i] = islands[i / 4].x;
+				z[i] = islands[i / 4].z;
+				pickupHeights[i] = sinf(x[i]) + cosf(z[i]);
+			}
+		}
+		{
+			ScratchScope scratch;
+			ArenaVector<float> rowX(ROW, 0.0f, scratch), rowZ(ROW, 0.0f, scratch);
+			for (int i = 0; i < ROW; i++) rowX[i] = (float)i;
+			total += rowX[rng() % ROW] + rowZ[0];
+		}
+		{
+			ScratchScope scratch;
+			const int vertexCount = (MESH_RESOLUTION - 1) * (MESH_RESOLUTION - 1) * 6;
+			Vertex* vertices = scratch.allocate<Vertex>(vertexCount);
+			unsigned long* indices = scratch.allocate<unsigned long>(vertexCount);
+			for (int i = 0; i < vertexCount; i++) {
+				vertices[i].position[0] = (float)i;
+				indices[i] = i;
+			}
+			total += vertices[rng() % vertexCount].position[0] + indices[vertexCount - 1];
+		}
+		{
+			ScratchScope scratch;
+			size_t* parent = scratch.allocate<size_t>(islands.size());
+			spanningTreeScratch(islands.data(), islands.size(), parent);
+			total += (float)parent[islands.size() - 1];
+		}
+		return total + pickupHeights[rng() % PICKUPS];
+	}
+}
+
+int main() {
+	const bool aligned = checkAlignment(), scoped = checkScopes() && checkScopeOnEmptyArena(), contained = checkContainers();
+	printf("FrameArena: alignment and overlap %s, scopes %s, containers %s\n",
+		aligned ? "ok" : "FAILED", scoped ? "ok" : "FAILED", contained ? "ok" : "FAILED");
+
+	// Steady state
+	mt19937 rng(5);
+	uniform_real_distribution<float> across(0.0f, 1500.0f);
+	vector<Point> islands(ISLANDS);
+	for (Point& island : islands) island = { across(rng), across(rng) };
+	FrameArena frameArena;
+	float sink = 0.0f;
+	for (int i = 0; i < WARM_UP_FRAMES; i++) sink += frame(frameArena, islands, rng);
+	const size_t heapBefore = heapAllocations, blocksBefore = frameArena.getStats().blockAllocations;
+	const size_t scratchBlocksBefore = FrameArena::scratch().getStats().blockAllocations;
+	const auto steadyStart = chrono::high_resolution_clock::now();
+	for (int i = 0; i < FRAMES; i++) sink += frame(frameArena, islands, rng);
+	const double steadyTime = milliseconds(steadyStart);
+	const size_t heapDuring = heapAllocations - heapBefore;
+	const size_t blocksDuring = frameArena.getStats().blockAllocations - blocksBefore +
+		FrameArena::scratch().getStats().blockAllocations - scratchBlocksBefore;
+	printf("  steady state, %d frames: %zu heap allocations, %zu new blocks; %zu arena allocations a frame, "
+		"frame arena %.1f KB, scratch %.1f KB, %.3f ms a frame\n",
+		FRAMES, heapDuring, blocksDuring, frameArena.getStats().lastAllocations, frameArena.getStats().capacity / 1024.0,
+		FrameArena::scratch().getStats().capacity / 1024.0, steadyTime / FRAMES);
+
+	// One allocation
+	FrameArena arena;
+	auto start = chrono::high_resolution_clock::now();
+	for (int i = 0; i < ALLOCATIONS; i++) {
+		if ((i & 1023) == 0) arena.reset();
+		sink += *arena.allocate<float>(16 + (i & 15));
+	}
+	const double arenaTime = milliseconds(start) * 1e6 / ALLOCATIONS;
+	start = chrono::high_resolution_clock::now();
+	for (int i = 0; i < ALLOCATIONS; i++) {
+		float* data = new float[16 + (i & 15)];
+		data[0] = (float)i;
+		sink += data[0];
+		delete[] data;
+	}
+	const double heapTime = milliseconds(start) * 1e6 / ALLOCATIONS;
+	printf("  one allocation: arena %.1f ns, new/delete %.1f ns\n", arenaTime, heapTime);
+
+	// Islands' spanning tree
+	bool treesMatch = true;
+	printf("  %-10s %14s %14s %12s %12s\n", "islands", "matrix ms", "scratch ms", "matrix KB", "scratch KB");
+	for (int count : MST_COUNTS) {
+		vector<Point> points(count);
+		for (Point& point : points) point = { across(rng) * 10.0f, across(rng) * 10.0f };
+		const size_t heapStart = heapAllocations;
+		start = chrono::high_resolution_clock::now();
+		const vector<size_t> expected = spanningTreeMatrix(points);
+		const double matrixTime = milliseconds(start);
+		const size_t matrixAllocations = heapAllocations - heapStart;
+		vector<size_t> parent(count);
+		start = chrono::high_resolution_clock::now();
+		spanningTreeScratch(points.data(), count, parent.data());
+		const double scratchTime = milliseconds(start);
+		treesMatch = treesMatch && parent == expected;
+		printf("  %-10d %14.2f %14.2f %12.0f %12.1f   (%zu heap allocations for the matrix)\n", count, matrixTime, scratchTime,
+			(double)count * count * sizeof(float) / 1024.0, count * (sizeof(bool) + sizeof(float)) / 1024.0, matrixAllocations);
+	}
+	printf("  spanning trees %s\n", treesMatch ? "match" : "DIFFER");
+
+	const bool ok = aligned && scoped && contained && heapDuring == 0 && blocksDuring == 0 && treesMatch && sink != 0.5f;
+	return ok ? 0 : 1;
+}
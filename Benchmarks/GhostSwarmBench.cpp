@@ -0,0 +1,106 @@
+// GhostSwarmBench.cpp
+// GhostSwarm update cost on a generated island layout: thousands of ghosts wandering, bouncing off their island
+// bounds, expiring and respawning, with a sonar ping every two seconds pulling in everything near it. Checks the SSE
+// batches against the scalar reference over the same run, then reports the cost per frame and per ghost and how many
+// ghosts one core can keep updating at 60 Hz.
+
+#include "GhostSwarm.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+namespace {
+
+	constexpr int ISLAND_COLUMNS = 6;
+	constexpr int ISLAND_ROWS = 6;
+	constexpr float REGION = 150.0f;	// Islands.h REGION_SIZE
+	constexpr int FRAMES = 2400;	// Long enough for every ghost to outlive MAX_LIFETIME once
+	constexpr float DT = 1.0f / 60.0f;
+	constexpr int PING_INTERVAL = 120;	// Frames
+	constexpr float PING_DURATION = 5.0f;	// SonarData::sonarDuration
+	constexpr float PING_RADIUS = 100.0f;
+	constexpr int CHECK_GHOSTS = 10000;
+	const int GHOST_COUNTS[] = { 1000, 10000, 50000, 100000 };
+
+	vector<GhostVector> makeIslands() {
+		vector<GhostVector> islands;
+		for (int row = 0; row < ISLAND_ROWS; row++)
+			for (int column = 0; column < ISLAND_COLUMNS; column++)
+				islands.push_back(GhostVector(column * REGION, 0.0f, row * REGION));
+		return islands;
+	}
+
+	// Runs FRAMES updates; returns seconds spent in update and the respawns seen
+	double runSwarm(GhostSwarm& swarm, int ghostCount, bool simd, int& respawns) {
+		const vector<GhostVector> islands = makeIslands();
+		mt19937 rng(505);
+		uniform_int_distribution<int> pick(0, (int)islands.size() - 1);
+
+		swarm.setSimd(simd);
+		swarm.resize(ghostCount, 505);
+		swarm.setIslands(islands);
+
+		double seconds = 0.0;
+		respawns = 0;
+		for (int frame = 0; frame < FRAMES; frame++) {
+			if (frame % PING_INTERVAL == PING_INTERVAL - 1) {
+				const GhostVector& centre = islands[pick(rng)];
+				swarm.respondToSonar(GhostVector(centre.x + 10.0f, centre.y + 2.0f, centre.z - 10.0f), PING_DURATION, -1, PING_RADIUS);
+			}
+
+			const auto start = chrono::high_resolution_clock::now();
+			swarm.update(DT);
+			seconds += chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+			respawns += swarm.getLastRespawnCount();
+		}
+		return seconds;
+	}
+
+	bool sameBits(float a, float b) {
+		return memcmp(&a, &b, sizeof(float)) == 0;
+	}
+}
+
+int main() {
+	printf("GhostSwarm: %d islands, %d frames at 60 Hz, sonar ping every %d frames, SSE %s\n",
+		ISLAND_COLUMNS * ISLAND_ROWS, FRAMES, PING_INTERVAL, GhostSwarm::hasSimd() ? "available" : "unavailable");
+
+	// Same run through both paths; every lane takes the same draws, so the state should match bit for bit
+	GhostSwarm scalar, simd;
+	int scalarRespawns, simdRespawns;
+	runSwarm(scalar, CHECK_GHOSTS, false, scalarRespawns);
+	runSwarm(simd, CHECK_GHOSTS, true, simdRespawns);
+	int mismatches = 0, responding = 0;
+	for (int i = 0; i < CHECK_GHOSTS; i++) {
+		const GhostVector a = scalar.getPosition(i), b = simd.getPosition(i);
+		const GhostVector va = scalar.getVelocity(i), vb = simd.getVelocity(i);
+		const bool same = sameBits(a.x, b.x) && sameBits(a.y, b.y) && sameBits(a.z, b.z) &&
+			sameBits(va.x, vb.x) && sameBits(va.y, vb.y) && sameBits(va.z, vb.z) &&
+			sameBits(scalar.getAliveTime(i), simd.getAliveTime(i)) && sameBits(scalar.getSonarTimer(i), simd.getSonarTimer(i)) &&
+			sameBits(scalar.getDirectionTimer(i), simd.getDirectionTimer(i)) && sameBits(scalar.getNextDirectionTime(i), simd.getNextDirectionTime(i)) &&
+			scalar.getIslandIndex(i) == simd.getIslandIndex(i) && scalar.isActive(i) == simd.isActive(i) &&
+			scalar.isRespondingToSonar(i) == simd.isRespondingToSonar(i);
+		if (!same) mismatches++;
+		if (simd.isRespondingToSonar(i)) responding++;
+	}
+	printf("  SIMD vs scalar : %d ghosts, %d respawns, %d responding at the end, %d mismatches\n",
+		CHECK_GHOSTS, simdRespawns, responding, mismatches + (scalarRespawns != simdRespawns ? 1 : 0));
+
+	const double frameBudget = 1.0 / 60.0;
+	for (int ghostCount : GHOST_COUNTS) {
+		GhostSwarm scalarSwarm, simdSwarm;
+		int respawns;
+		const double scalarSeconds = runSwarm(scalarSwarm, ghostCount, false, respawns);
+		const double simdSeconds = GhostSwarm::hasSimd() ? runSwarm(simdSwarm, ghostCount, true, respawns) : scalarSeconds;
+
+		// Ghosts one core could update inside a 60 Hz frame, assuming cost grows linearly with ghost count
+		const double scalarNs = scalarSeconds * 1e9 / ((double)FRAMES * ghostCount);
+		const double simdNs = simdSeconds * 1e9 / ((double)FRAMES * ghostCount);
+		printf("  %6d ghosts  : scalar %8.1f us/frame (%5.2f ns/ghost), SIMD %8.1f us/frame (%5.2f ns/ghost), %.2fx speed-up, %.1fM ghosts per 60 Hz frame\n",
+			ghostCount, scalarSeconds * 1e6 / FRAMES, scalarNs, simdSeconds * 1e6 / FRAMES, simdNs, scalarSeconds / simdSeconds,
+			frameBudget * 1e9 / simdNs / 1e6);
+	}
+
+	return mismatches == 0 && scalarRespawns == simdRespawns ? 0 : 1;
+}
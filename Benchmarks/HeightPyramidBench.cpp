@@ -0,0 +1,231 @@
+// HeightPyramidBench.cpp
+// HeightPyramid against an independent reference: a 2D DDA that steps the ray through every cell it crosses and solves
+// each solid cell's bilinear patch in double precision from the ray's start. The world is a grid of square islands
+// with open water between them, hillier than the game's so that rays have something to miss. Two sets of rays: camera
+// picking rays, one per pixel of a small view in row order, so neighbours head almost the same way; and line-of-sight
+// rays between random points above the world, which mostly cross water and clear terrain and hit nothing. Every ray's
+// hit and distance is checked against the reference; the DDA's cost grows with the cells a ray crosses, the pyramid's
+// with the few nodes near where it meets the surface. Packets pay off for the camera's coherent rays; random
+// line-of-sight rays share little of their walk, so there they cost more than casting alone.
+
+#include "HeightPyramid.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+namespace {
+
+	constexpr float CELL_SIZE = 2.0f;	// App1::updateHeightPyramid
+	constexpr int VERTICES = 1025;
+	constexpr float ISLAND_SIZE = 100.0f;	// Islands.h ISLAND_SIZE is the half size
+	constexpr float ISLAND_SPACING = 160.0f;
+	constexpr float HILL_HEIGHT = 12.0f;
+	constexpr int VIEW_SIZE = 256;
+	constexpr float FIELD_OF_VIEW = 0.8f;
+	constexpr int CAMERAS = 4;
+	constexpr int LINE_OF_SIGHT_RAYS = 65536;
+	constexpr float TOLERANCE = 1e-2f;
+
+	double nanoseconds(chrono::high_resolution_clock::time_point start) {
+		return chrono::duration<double, nano>(chrono::high_resolution_clock::now() - start).count();
+	}
+
+	HeightPyramidGrid makeWorld() {
+		HeightPyramidGrid grid;
+		grid.cellSize = CELL_SIZE;
+		grid.width = grid.depth = VERTICES;
+		grid.heights.resize((size_t)VERTICES * VERTICES);
+		for (int z = 0; z < VERTICES; z++) {
+			for (int x = 0; x < VERTICES; x++) {
+				const float worldX = x * CELL_SIZE, worldZ = z * CELL_SIZE;
+				const float localX = fmodf(worldX, ISLAND_SPACING) - ISLAND_SIZE * 0.5f, localZ = fmodf(worldZ, ISLAND_SPACING) - ISLAND_SIZE * 0.5f;
+				float& height = grid.heights[(size_t)z * VERTICES + x];
+				if (localX < -ISLAND_SIZE * 0.5f || localX > ISLAND_SIZE * 0.5f || localZ < -ISLAND_SIZE * 0.5f || localZ > ISLAND_SIZE * 0.5f) {
+					height = HeightPyramidGrid::NO_HEIGHT;
+					continue;
+				}
+				// TerrainManipulation::getHeight's ripple on a dome
+				const float dome = 1.0f - (localX * localX + localZ * localZ) / (ISLAND_SIZE * ISLAND_SIZE * 0.5f);
+				height = sinf(worldX * 0.1f) * cosf(worldZ * 0.1f) + HILL_HEIGHT * max(dome, 0.0f);
+			}
+		}
+		return grid;
+	}
+
+	// Cell by cell along the ray, everything in double from the ray's own start
+	bool referenceCast(const HeightPyramidGrid& grid, const HeightRay& ray, double& distance) {
+		const double length = sqrt((double)ray.direction.x * ray.direction.x + (double)ray.direction.y * ray.direction.y + (double)ray.direction.z * ray.direction.z);
+		const double dx = ray.direction.x / length, dy = ray.direction.y / length, dz = ray.direction.z / length;
+		const double ox = ray.origin.x, oy = ray.origin.y, oz = ray.origin.z;
+		const double size = grid.cellSize, extentX = (grid.width - 1) * size, extentZ = (grid.depth - 1) * size;
+
+		double start = 0.0, end = ray.length;
+		auto clip = [&](double origin, double direction, double low, double high) {
+			if (fabs(direction) < 1e-12) return origin >= low && origin <= high;
+			double a = (low - origin) / direction, b = (high - origin) / direction;
+			if (a > b) swap(a, b);
+			start = max(start, a);
+			end = min(end, b);
+			return start <= end;
+		};
+		if (!clip(ox - grid.originX, dx, 0.0, extentX) || !clip(oz - grid.originZ, dz, 0.0, extentZ)) return false;
+
+		int cellX = min(max((int)floor((ox + dx * start - grid.originX) / size), 0), grid.width - 2);
+		int cellZ = min(max((int)floor((oz + dz * start - grid.originZ) / size), 0), grid.depth - 2);
+		const int stepX = dx > 0.0 ? 1 : -1, stepZ = dz > 0.0 ? 1 : -1;
+		double nextX = fabs(dx) < 1e-12 ? 1e300 : (grid.originX + (cellX + (dx > 0.0)) * size - ox) / dx;
+		double nextZ = fabs(dz) < 1e-12 ? 1e300 : (grid.originZ + (cellZ + (dz > 0.0)) * size - oz) / dz;
+		const double deltaX = fabs(dx) < 1e-12 ? 1e300 : size / fabs(dx), deltaZ = fabs(dz) < 1e-12 ? 1e300 : size / fabs(dz);
+
+		double t = start;
+		while (true) {
+			const double leave = min(min(nextX, nextZ), end);
+			const float* row = &grid.heights[(size_t)cellZ * grid.width + cellX];
+			const double h00 = row[0], h10 = row[1], h01 = row[grid.width], h11 = row[grid.width + 1];
+			if (min(min(h00, h10), min(h01, h11)) > HeightPyramidGrid::NO_HEIGHT * 0.5) {
+				// u, v and the height over the cell as polynomials in t
+				const double u0 = (ox - grid.originX - cellX * size) / size, du = dx / size;
+				const double v0 = (oz - grid.originZ - cellZ * size) / size, dv = dz / size;
+				const double a = h10 - h00, b = h01 - h00, c = h00 - h10 - h01 + h11;
+				const double constant = oy - (h00 + a * u0 + b * v0 + c * u0 * v0);
+				const double linear = dy - (a * du + b * dv + c * (u0 * dv + v0 * du));
+				const double quadratic = -c * du * dv;
+				auto above = [&](double at) { return constant + linear * at + quadratic * at * at; };
+
+				if (above(t) <= 0.0) {
+					distance = t;
+					return true;
+				}
+				double roots[2];
+				int count = 0;
+				if (fabs(quadratic) < 1e-15) {
+					if (linear != 0.0) roots[count++] = -constant / linear;
+				}
+				else {
+					const double discriminant = linear * linear - 4.0 * quadratic * constant;
+					if (discriminant >= 0.0) {
+						roots[count++] = (-linear - sqrt(discriminant)) / (2.0 * quadratic);
+						roots[count++] = (-linear + sqrt(discriminant)) / (2.0 * quadratic);
+						if (roots[0] > roots[1]) swap(roots[0], roots[1]);
+					}
+				}
+				for (int i = 0; i < count; i++) {
+					if (roots[i] >= t && roots[i] <= leave) {
+						distance = roots[i];
+						return true;
+					}
+				}
+			}
+
+			if (leave >= end) return false;
+			if (nextX < nextZ) {
+				cellX += stepX;
+				t = nextX;
+				nextX += deltaX;
+			}
+			else {
+				cellZ += stepZ;
+				t = nextZ;
+				nextZ += deltaZ;
+			}
+			if (cellX < 0 || cellZ < 0 || cellX > grid.width - 2 || cellZ > grid.depth - 2) return false;
+		}
+	}
+
+	vector<HeightRay> cameraRays(mt19937& rng) {
+		const float extent = (VERTICES - 1) * CELL_SIZE;
+		uniform_real_distribution<float> position(extent * 0.1f, extent * 0.9f), heading(0.0f, 6.2832f), pitch(0.15f, 0.6f);
+		vector<HeightRay> rays;
+		for (int camera = 0; camera < CAMERAS; camera++) {
+			const float yaw = heading(rng), down = pitch(rng);
+			const HeightVector eye(position(rng), 30.0f, position(rng));
+			// Forward, right and up of a camera looking along yaw, tilted down
+			const float forwardX = cosf(down) * sinf(yaw), forwardY = -sinf(down), forwardZ = cosf(down) * cosf(yaw);
+			const float rightX = cosf(yaw), rightZ = -sinf(yaw);
+			const float upX = sinf(down) * sinf(yaw), upY = cosf(down), upZ = sinf(down) * cosf(yaw);
+			const float scale = tanf(FIELD_OF_VIEW * 0.5f);
+			for (int y = 0; y < VIEW_SIZE; y++) {
+				for (int x = 0; x < VIEW_SIZE; x++) {
+					const float sx = ((x + 0.5f) / VIEW_SIZE * 2.0f - 1.0f) * scale, sy = (1.0f - (y + 0.5f) / VIEW_SIZE * 2.0f) * scale;
+					HeightRay ray;
+					ray.origin = eye;
+					ray.direction = HeightVector(forwardX + rightX * sx + upX * sy, forwardY + upY * sy, forwardZ + rightZ * sx + upZ * sy);
+					rays.push_back(ray);
+				}
+			}
+		}
+		return rays;
+	}
+
+	vector<HeightRay> lineOfSightRays(mt19937& rng) {
+		const float extent = (VERTICES - 1) * CELL_SIZE;
+		uniform_real_distribution<float> coordinate(0.0f, extent), height(HILL_HEIGHT * 0.5f, HILL_HEIGHT * 2.5f);
+		vector<HeightRay> rays(LINE_OF_SIGHT_RAYS);
+		for (HeightRay& ray : rays) {
+			ray.origin = HeightVector(coordinate(rng), height(rng), coordinate(rng));
+			const HeightVector target(coordinate(rng), height(rng), coordinate(rng));
+			ray.direction = HeightVector(target.x - ray.origin.x, target.y - ray.origin.y, target.z - ray.origin.z);
+			ray.length = sqrtf(ray.direction.x * ray.direction.x + ray.direction.y * ray.direction.y + ray.direction.z * ray.direction.z);
+		}
+		return rays;
+	}
+
+	struct Result {
+		double referenceNs = 0.0, singleNs = 0.0, packetNs = 0.0;
+		HeightRayStats single, packet;
+		int hits = 0, wrong = 0;
+	};
+
+	Result run(const HeightPyramidGrid& grid, HeightPyramid& pyramid, const vector<HeightRay>& rays) {
+		Result result;
+		const size_t count = rays.size();
+		vector<double> expected(count);
+		vector<char> expectedHit(count);
+		auto start = chrono::high_resolution_clock::now();
+		for (size_t i = 0; i < count; i++) expectedHit[i] = referenceCast(grid, rays[i], expected[i]);
+		result.referenceNs = nanoseconds(start) / count;
+
+		vector<HeightHit> single(count), packet(count);
+		start = chrono::high_resolution_clock::now();
+		for (size_t i = 0; i < count; i++) pyramid.raycast(rays[i], single[i], &result.single);
+		result.singleNs = nanoseconds(start) / count;
+
+		pyramid.setPackets(true);
+		start = chrono::high_resolution_clock::now();
+		pyramid.raycast(rays.data(), count, packet.data(), &result.packet);
+		result.packetNs = nanoseconds(start) / count;
+
+		for (size_t i = 0; i < count; i++) {
+			result.hits += expectedHit[i];
+			for (const HeightHit* hit : { &single[i], &packet[i] }) {
+				if (hit->hit != (bool)expectedHit[i]) result.wrong++;
+				else if (hit->hit && fabs(hit->distance - expected[i]) > TOLERANCE * max(1.0, expected[i] * 1e-3)) result.wrong++;
+			}
+		}
+		return result;
+	}
+
+	void report(const char* name, const Result& result, size_t count) {
+		printf("  %-14s: %6zu rays, %5.1f%% hit; DDA %7.1f ns/ray, pyramid %6.1f ns/ray (%5.1f nodes, %4.1f cells), packets %6.1f ns/ray (%5.1f nodes per ray), %d wrong\n",
+			name, count, 100.0 * result.hits / count, result.referenceNs, result.singleNs, (double)result.single.nodes / count,
+			(double)result.single.cells / count, result.packetNs, (double)result.packet.nodes / count, result.wrong);
+	}
+}
+
+int main() {
+	const HeightPyramidGrid grid = makeWorld();
+	HeightPyramid pyramid;
+	const auto start = chrono::high_resolution_clock::now();
+	pyramid.build(grid);
+	printf("HeightPyramid: %dx%d vertices at %.0f units, %d levels built in %.1f ms\n", VERTICES, VERTICES, CELL_SIZE,
+		pyramid.getLevelCount(), nanoseconds(start) * 1e-6);
+
+	mt19937 rng(41);
+	const vector<HeightRay> picking = cameraRays(rng), sight = lineOfSightRays(rng);
+	const Result pickingResult = run(grid, pyramid, picking), sightResult = run(grid, pyramid, sight);
+	report("camera picking", pickingResult, picking.size());
+	report("line of sight", sightResult, sight.size());
+	return pickingResult.wrong == 0 && sightResult.wrong == 0 ? 0 : 1;
+}
@@ -0,0 +1,150 @@
+// JobSystemBench.cpp
+// JobSystem micro-benchmarks: the cost of creating and running an empty job with and without workers, parallelFor
+// scaling over a fixed amount of arithmetic as threads are added, how often workers had to steal to stay busy, and
+// a diamond of continuations checked for ordering. Finishes with a 100k-ghost GhostSwarm updated on the job system,
+// checked bit for bit against the same swarm updated on one thread. Thread counts past the core count are still run
+// but are oversubscribed, so expect them to flatten out rather than scale.
+
+#include "JobSystem.h"
+#include "GhostSwarm.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+	constexpr int SPAWN_JOBS = 1000000;
+	constexpr int SPAWN_BATCH = 1024;	// Well inside JOBS_PER_THREAD
+	constexpr int WORK_ITEMS = 1 << 20;
+	constexpr int WORK_GRAIN = 1024;
+	constexpr int WORK_ROUNDS = 20;
+	constexpr int DIAMOND_ROUNDS = 10000;
+	constexpr int SWARM_GHOSTS = 100000;
+	constexpr int SWARM_FRAMES = 600;
+	constexpr float DT = 1.0f / 60.0f;
+	const int THREAD_COUNTS[] = { 1, 2, 4, 8 };
+
+	double seconds(chrono::high_resolution_clock::time_point start) {
+		return chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+	}
+
+	// Empty children of one root, waited on in batches
+	double spawnCost(JobSystem& jobs) {
+		const auto start = chrono::high_resolution_clock::now();
+		for (int done = 0; done < SPAWN_JOBS; done += SPAWN_BATCH) {
+			JobSystem::Job* root = jobs.create([] {});
+			for (int i = 0; i < SPAWN_BATCH; i++) jobs.run(jobs.create([] {}, root));
+			jobs.run(root);
+			jobs.wait(root);
+		}
+		return seconds(start) * 1e9 / SPAWN_JOBS;
+	}
+
+	// A few hundred cycles of dependent arithmetic per item, so the split is the only thing that varies
+	float work(vector<float>& values, JobSystem& jobs) {
+		jobs.parallelFor(WORK_ITEMS, WORK_GRAIN, [&](int begin, int end) {
+			for (int i = begin; i < end; i++) {
+				float x = values[i];
+				for (int step = 0; step < 32; step++) x = sqrtf(x * x + 1.0f) * 0.5f;
+				values[i] = x;
+			}
+		});
+		return values[WORK_ITEMS / 2];
+	}
+
+	// a -> (b, c) -> d; d must see both b and c, and b and c must see a
+	bool diamond(JobSystem& jobs) {
+		for (int round = 0; round < DIAMOND_ROUNDS; round++) {
+			atomic<int> order{ 0 };
+			int a = -1, b = -1, c = -1, d = -1;
+			JobSystem::Job* first = jobs.create([&] { a = order.fetch_add(1); });
+			JobSystem::Job* left = jobs.create([&] { b = a >= 0 ? order.fetch_add(1) : -2; });
+			JobSystem::Job* right = jobs.create([&] { c = a >= 0 ? order.fetch_add(1) : -2; });
+			JobSystem::Job* last = jobs.create([&] { d = b >= 0 && c >= 0 ? order.fetch_add(1) : -2; });
+			jobs.addContinuation(first, left);
+			jobs.addContinuation(first, right);
+			jobs.addContinuation(left, last);
+			jobs.addContinuation(right, last);
+			jobs.run(last);
+			jobs.run(right);
+			jobs.run(left);
+			jobs.run(first);
+			jobs.wait(last);
+			if (a != 0 || b < 1 || c < 1 || d != 3) return false;
+		}
+		return true;
+	}
+
+	vector<GhostVector> makeIslands() {
+		vector<GhostVector> islands;
+		for (int row = 0; row < 6; row++)
+			for (int column = 0; column < 6; column++)
+				islands.push_back(GhostVector(column * 150.0f, 0.0f, row * 150.0f));
+		return islands;
+	}
+
+	double runSwarm(GhostSwarm& swarm, JobSystem* jobs) {
+		const vector<GhostVector> islands = makeIslands();
+		swarm.resize(SWARM_GHOSTS, 505);
+		swarm.setIslands(islands);
+		const auto start = chrono::high_resolution_clock::now();
+		for (int frame = 0; frame < SWARM_FRAMES; frame++) {
+			if (frame % 120 == 119) swarm.respondToSonar(islands[frame % islands.size()], 5.0f, -1, 100.0f);
+			swarm.update(DT, jobs);
+		}
+		return seconds(start) * 1e6 / SWARM_FRAMES;
+	}
+
+	bool sameBits(float a, float b) {
+		return memcmp(&a, &b, sizeof(float)) == 0;
+	}
+}
+
+int main() {
+	printf("JobSystem: %u hardware threads, %d workers by default\n", thread::hardware_concurrency(), JobSystem::defaultWorkerCount());
+
+	{
+		JobSystem inline0(0);
+		printf("  spawn+run      : %.1f ns/job on the calling thread alone\n", spawnCost(inline0));
+	}
+	{
+		JobSystem pooled(3);
+		printf("  spawn+run      : %.1f ns/job with 3 workers\n", spawnCost(pooled));
+	}
+
+	vector<float> values(WORK_ITEMS);
+	double single = 0.0;
+	for (int threads : THREAD_COUNTS) {
+		JobSystem jobs(threads - 1);
+		for (int i = 0; i < WORK_ITEMS; i++) values[i] = (float)i;
+		jobs.resetStats();
+		const auto start = chrono::high_resolution_clock::now();
+		float checksum = 0.0f;
+		for (int round = 0; round < WORK_ROUNDS; round++) checksum += work(values, jobs);
+		const double ms = seconds(start) * 1e3 / WORK_ROUNDS;
+		if (threads == 1) single = ms;
+		const JobSystem::Stats stats = jobs.getStats();
+		printf("  parallelFor %dT : %7.2f ms, %.2fx, %llu jobs, %4.1f%% stolen, %llu steal attempts (checksum %.3f)\n", threads, ms,
+			single / ms, (unsigned long long)stats.executed, 100.0 * stats.stolen / max<uint64_t>(stats.executed, 1),
+			(unsigned long long)stats.stealAttempts, checksum);
+	}
+
+	// At least a few workers even on small machines, so the swarm check goes through the split path
+	JobSystem jobs(max(JobSystem::defaultWorkerCount(), 3));
+	const bool ordered = diamond(jobs);
+	printf("  continuations  : %d diamonds, %s\n", DIAMOND_ROUNDS, ordered ? "ordered" : "OUT OF ORDER");
+
+	GhostSwarm serial, parallel;
+	const double serialUs = runSwarm(serial, nullptr);
+	const double parallelUs = runSwarm(parallel, &jobs);
+	int mismatches = 0;
+	for (int i = 0; i < SWARM_GHOSTS; i++) {
+		const GhostVector a = serial.getPosition(i), b = parallel.getPosition(i);
+		if (!sameBits(a.x, b.x) || !sameBits(a.y, b.y) || !sameBits(a.z, b.z) || serial.isActive(i) != parallel.isActive(i)) mismatches++;
+	}
+	printf("  %dk ghosts    : %.1f us/frame on one thread, %.1f us/frame on %d threads, %.2fx, %d mismatches\n", SWARM_GHOSTS / 1000,
+		serialUs, parallelUs, jobs.getThreadCount(), serialUs / parallelUs, mismatches);
+
+	return ordered && mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,213 @@
+// MemoryTrackerBench.cpp
+// MemoryTracker and TrackedAllocator. First correctness: bytes, peaks and counts come out exactly for a known sequence,
+// GPU kinds are kept apart and summed, a stray free can't wrap a count round, tracked containers report what they
+// hold and give it all back, a FrameArena's blocks show up under Arenas, and the JSON dump names every tag. Then the
+// same counters hammered from several threads at once, which have to come back to zero with nothing lost. Last, what
+// it costs: one report, and filling a tracked vector against a plain one.
+
+#include "MemoryTracker.h"
+#include "FrameArena.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <list>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+	constexpr int THREADS = 8;
+	constexpr int OPERATIONS = 200000;	// Per thread
+	constexpr int REPORTS = 10000000;
+	constexpr int ELEMENTS = 1000000;
+
+	double milliseconds(chrono::high_resolution_clock::time_point start) {
+		return chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+	}
+
+	bool checkCounts() {
+		const MemoryTag tag = MemoryTag::Islands;
+		MemoryTracker::allocate(tag, 100);
+		MemoryTracker::allocate(tag, 200);
+		MemoryTracker::free(tag, 100);
+		MemoryTracker::allocate(tag, 50);
+		MemoryTracker::TagStats stats = MemoryTracker::getStats(tag);
+		bool ok = stats.bytes == 250 && stats.peakBytes == 300 && stats.allocations == 3 && stats.frees == 1;
+
+		MemoryTracker::free(tag, 200);
+		MemoryTracker::free(tag, 50);
+		MemoryTracker::free(tag, 1000);	// Never allocated
+		stats = MemoryTracker::getStats(tag);
+		ok = ok && stats.bytes == 0 && stats.peakBytes == 300 && stats.frees == 4;
+
+		MemoryTracker::setExternal(MemoryTag::Audio, 4096, 8192);
+		MemoryTracker::setExternal(MemoryTag::Audio, 2048, 2048);	// The peak stays where it got to
+		stats = MemoryTracker::getStats(MemoryTag::Audio);
+		return ok && stats.externalBytes == 2048 && stats.externalPeakBytes == 8192 && stats.getCpuBytes() == 2048;
+	}
+
+	bool checkGpu() {
+		const MemoryTag tag = MemoryTag::Rendering;
+		MemoryTracker::allocateGpu(tag, GpuMemory::Buffer, 64);
+		MemoryTracker::allocateGpu(tag, GpuMemory::Texture, 1024);
+		MemoryTracker::allocateGpu(tag, GpuMemory::RenderTarget, 4096);
+		MemoryTracker::TagStats stats = MemoryTracker::getStats(tag);
+		bool ok = stats.gpuBytes[(int)GpuMemory::Buffer] == 64 && stats.gpuBytes[(int)GpuMemory::Texture] == 1024 &&
+			stats.gpuBytes[(int)GpuMemory::RenderTarget] == 4096 && stats.getGpuBytes() == 5184 &&
+			stats.gpuPeakBytes == 5184 && stats.gpuAllocations == 3 && stats.bytes == 0;
+
+		MemoryTracker::freeGpu(tag, GpuMemory::Texture, 1024);
+		MemoryTracker::freeGpu(tag, GpuMemory::RenderTarget, 4096);
+		stats = MemoryTracker::getStats(tag);
+		ok = ok && stats.getGpuBytes() == 64 && stats.gpuPeakBytes == 5184 && stats.gpuFrees == 2;
+		MemoryTracker::freeGpu(tag, GpuMemory::Buffer, 64);
+		return ok && MemoryTracker::getStats(tag).getGpuBytes() == 0;
+	}
+
+	bool checkContainers() {
+		const MemoryTag tag = MemoryTag::Models;
+		bool ok = true;
+		{
+			TrackedVector<int, MemoryTag::Models> values;
+			for (int i = 0; i < 1000; i++) values.push_back(i);
+			ok = ok && MemoryTracker::getStats(tag).bytes == values.capacity() * sizeof(int);
+
+			TrackedVector<int, MemoryTag::Models> copy = values;
+			ok = ok && MemoryTracker::getStats(tag).bytes == (values.capacity() + copy.capacity()) * sizeof(int);
+
+			// Rebound to the list's nodes, which are counted at whatever size they turn out to be
+			list<int, TrackedAllocator<int, MemoryTag::Models>> nodes(values.begin(), values.begin() + 10);
+			ok = ok && MemoryTracker::getStats(tag).bytes > (values.capacity() + copy.capacity()) * sizeof(int);
+		}
+		const MemoryTracker::TagStats stats = MemoryTracker::getStats(tag);
+		return ok && stats.bytes == 0 && stats.allocations == stats.frees;
+	}
+
+	bool checkArena() {
+		bool ok;
+		{
+			FrameArena arena(4096);
+			arena.allocate(100);
+			arena.allocate(8192);	// Outgrows the first block
+			ok = MemoryTracker::getStats(MemoryTag::Arenas).bytes == arena.getStats().capacity;
+			arena.reset();	// Merges them
+			ok = ok && MemoryTracker::getStats(MemoryTag::Arenas).bytes == arena.getStats().capacity;
+		}
+		return ok && MemoryTracker::getStats(MemoryTag::Arenas).bytes == 0;
+	}
+
+	bool checkJson() {
+		const string json = MemoryTracker::toJson();
+		bool ok = json.find("\"Total\"") != string::npos;
+		for (int tag = 0; tag < (int)MemoryTag::Count; tag++) {
+			ok = ok && json.find(string("\"") + MemoryTracker::getName((MemoryTag)tag) + "\"") != string::npos;
+		}
+		for (int kind = 0; kind < (int)GpuMemory::Count; kind++) {
+			ok = ok && json.find(string("\"") + MemoryTracker::getName((GpuMemory)kind) + "\"") != string::npos;
+		}
+
+		const char* path = "MemoryTrackerBench.json";
+		if (!MemoryTracker::writeJson(path)) return false;
+		ifstream file(path, ios::binary);
+		stringstream written;
+		written << file.rdbuf();
+		file.close();
+		remove(path);
+		return ok && written.str() == json;
+	}
+
+	// Each thread allocates and frees random sizes on every tag, keeping a tracked vector of its own growing as it goes
+	bool checkThreads() {
+		struct Allocation {
+			MemoryTag tag;
+			GpuMemory kind;
+			size_t bytes;
+		};
+
+		MemoryTracker::TagStats before[(int)MemoryTag::Count];
+		for (int tag = 0; tag < (int)MemoryTag::Count; tag++) before[tag] = MemoryTracker::getStats((MemoryTag)tag);
+
+		vector<thread> threads;
+		for (int t = 0; t < THREADS; t++) {
+			threads.emplace_back([t]() {
+				mt19937 rng(t);
+				uniform_int_distribution<size_t> size(1, 4096);
+				vector<Allocation> live;
+				TrackedVector<int, MemoryTag::Islands> grown;
+				for (int i = 0; i < OPERATIONS; i++) {
+					if (live.empty() || rng() % 3) {
+						const Allocation allocation = { (MemoryTag)(rng() % (int)MemoryTag::Count),
+							(GpuMemory)(rng() % (int)GpuMemory::Count), size(rng) };
+						MemoryTracker::allocate(allocation.tag, allocation.bytes);
+						MemoryTracker::allocateGpu(allocation.tag, allocation.kind, allocation.bytes);
+						live.push_back(allocation);
+					}
+					else {
+						MemoryTracker::free(live.back().tag, live.back().bytes);
+						MemoryTracker::freeGpu(live.back().tag, live.back().kind, live.back().bytes);
+						live.pop_back();
+					}
+					if ((i & 63) == 0) grown.push_back(i);
+				}
+				for (const Allocation& allocation : live) {
+					MemoryTracker::free(allocation.tag, allocation.bytes);
+					MemoryTracker::freeGpu(allocation.tag, allocation.kind, allocation.bytes);
+				}
+			});
+		}
+		for (thread& worker : threads) worker.join();
+
+		bool ok = true;
+		for (int tag = 0; tag < (int)MemoryTag::Count; tag++) {
+			const MemoryTracker::TagStats stats = MemoryTracker::getStats((MemoryTag)tag);
+			ok = ok && stats.bytes == before[tag].bytes && stats.getGpuBytes() == before[tag].getGpuBytes();
+			ok = ok && stats.allocations - before[tag].allocations == stats.frees - before[tag].frees;
+			ok = ok && stats.gpuAllocations - before[tag].gpuAllocations == stats.gpuFrees - before[tag].gpuFrees;
+			ok = ok && stats.allocations > before[tag].allocations && stats.peakBytes > 0 && stats.gpuPeakBytes > 0;
+		}
+		return ok;
+	}
+}
+
+int main() {
+	const bool counted = checkCounts(), gpu = checkGpu(), contained = checkContainers(), arena = checkArena(),
+		dumped = checkJson(), threaded = checkThreads();
+	printf("MemoryTracker: counts %s, gpu %s, containers %s, arenas %s, json %s, %d threads %s\n",
+		counted ? "ok" : "FAILED", gpu ? "ok" : "FAILED", contained ? "ok" : "FAILED", arena ? "ok" : "FAILED",
+		dumped ? "ok" : "FAILED", THREADS, threaded ? "ok" : "FAILED");
+
+	// One report, given back straight away
+	auto start = chrono::high_resolution_clock::now();
+	for (int i = 0; i < REPORTS; i++) {
+		MemoryTracker::allocate(MemoryTag::Meshes, 64);
+		MemoryTracker::free(MemoryTag::Meshes, 64);
+	}
+	const double reportTime = milliseconds(start);
+	printf("  allocate and free: %.2f ns a pair\n", reportTime * 1e6 / REPORTS);
+
+	// Filling a vector, tracked and not
+	long long sink = 0;
+	start = chrono::high_resolution_clock::now();
+	for (int pass = 0; pass < 10; pass++) {
+		vector<int> plain;
+		for (int i = 0; i < ELEMENTS; i++) plain.push_back(i);
+		sink += plain.back();
+	}
+	const double plainTime = milliseconds(start);
+	start = chrono::high_resolution_clock::now();
+	for (int pass = 0; pass < 10; pass++) {
+		TrackedVector<int, MemoryTag::Meshes> tracked;
+		for (int i = 0; i < ELEMENTS; i++) tracked.push_back(i);
+		sink += tracked.back();
+	}
+	const double trackedTime = milliseconds(start);
+	printf("  %d push_backs: vector %.2f ms, TrackedVector %.2f ms (%lld)\n", ELEMENTS, plainTime / 10, trackedTime / 10, sink);
+
+	printf("\n%s", MemoryTracker::toJson().c_str());
+	return counted && gpu && contained && arena && dumped && threaded ? 0 : 1;
+}
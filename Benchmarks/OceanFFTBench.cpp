@@ -0,0 +1,100 @@
+// OceanFFTBench.cpp
+// OceanFFT against a direct sum of every wave in its spectrum, in double precision, at each sample of a small patch;
+// then the SSE2 path against the scalar one on a larger patch, and the surface a whole period earlier against the
+// surface now. Then the cost of one update, spectrum to packed textures, at 64 to 512 samples a side: scalar on one
+// thread, SSE2 on one thread, and SSE2 spread over the job system.
+
+#include "JobSystem.h"
+#include "OceanFFT.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+
+	constexpr int CHECK_SIZE = 32;
+	constexpr float CHECK_TIME = 37.25f;
+	constexpr double TOLERANCE = 1e-4;	// Of the largest height
+	const int SIZES[] = { 64, 128, 256, 512 };
+
+	double milliseconds(chrono::high_resolution_clock::time_point start) {
+		return chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+	}
+
+	float largestHeight(const OceanFFT& ocean) {
+		float largest = 0.0f;
+		for (int i = 0; i < ocean.getSize() * ocean.getSize(); i++) largest = max(largest, fabsf(ocean.getDisplacement()[i * 4 + 1]));
+		return largest;
+	}
+
+	float largestDifference(const OceanFFT& a, const OceanFFT& b) {
+		float worst = 0.0f;
+		for (int i = 0; i < a.getSize() * a.getSize() * 4; i++) {
+			worst = max(worst, fabsf(a.getDisplacement()[i] - b.getDisplacement()[i]));
+			worst = max(worst, fabsf(a.getNormals()[i] - b.getNormals()[i]));
+		}
+		return worst;
+	}
+
+	// Updates for at least a quarter of a second; milliseconds per update
+	double time(OceanFFT& ocean, JobSystem* jobs) {
+		int updates = 0;
+		const auto start = chrono::high_resolution_clock::now();
+		do ocean.update(0.1f * updates++, jobs);
+		while (milliseconds(start) < 250.0);
+		return milliseconds(start) / updates;
+	}
+}
+
+int main() {
+	OceanSettings settings;
+	settings.size = CHECK_SIZE;
+	settings.patchLength = 32.0f;
+	OceanFFT ocean;
+	ocean.setup(settings);
+	ocean.update(CHECK_TIME);
+	const float scale = largestHeight(ocean);
+	double worst = 0.0;
+	const int n = ocean.getSize();
+	for (int z = 0; z < n; z++) {
+		for (int x = 0; x < n; x++) {
+			double expected[3];
+			ocean.sumWaves(CHECK_TIME, x * settings.patchLength / n, z * settings.patchLength / n, expected);
+			const float* texel = &ocean.getDisplacement()[((size_t)z * n + x) * 4];
+			for (int axis = 0; axis < 3; axis++) worst = max(worst, fabs(texel[axis] - expected[axis]));
+		}
+	}
+	printf("OceanFFT: %dx%d patch against every wave summed directly, largest height %.3f, largest error %.2e\n", n, n, scale, worst);
+
+	settings.size = 256;
+	settings.patchLength = 64.0f;
+	OceanFFT scalar, batched, later;
+	for (OceanFFT* each : { &scalar, &batched, &later }) each->setup(settings);
+	scalar.setSimd(false);
+	scalar.update(CHECK_TIME);
+	batched.update(CHECK_TIME);
+	later.update(CHECK_TIME - settings.period);	// Wrapped to a different phase time, so only whole cycles per period match
+	const float patchScale = largestHeight(scalar);
+	const float simdDifference = largestDifference(scalar, batched), loopDifference = largestDifference(batched, later);
+	double squares = 0.0;
+	for (int i = 0; i < 256 * 256; i++) squares += (double)scalar.getDisplacement()[i * 4 + 1] * scalar.getDisplacement()[i * 4 + 1];
+	printf("  256x256 over %.0f units, wind %.0f: significant wave height %.2f, SSE2 against scalar %.2e, a period earlier %.2e\n",
+		settings.patchLength, settings.windSpeed, 4.0 * sqrt(squares / (256 * 256)), simdDifference, loopDifference);
+
+	JobSystem jobs;
+	printf("  %-9s %12s %12s %12s   (ms per update, %d threads)\n", "size", "scalar", "sse2", "sse2+jobs", jobs.getThreadCount());
+	for (int size : SIZES) {
+		settings.size = size;
+		OceanFFT timed;
+		timed.setup(settings);
+		timed.setSimd(false);
+		const double scalarMs = time(timed, nullptr);
+		timed.setSimd(true);
+		const double simdMs = time(timed, nullptr), jobsMs = time(timed, &jobs);
+		printf("  %4dx%-4d %12.3f %12.3f %12.3f\n", size, size, scalarMs, simdMs, jobsMs);
+	}
+
+	const bool ok = worst <= TOLERANCE * scale && simdDifference <= TOLERANCE * patchScale && loopDifference <= TOLERANCE * patchScale;
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,195 @@
+// PlayerCollisionBench.cpp
+// PlayerCollision on a row of rotated islands joined by bridges. Fires the player's sphere at bridge decks from the
+// side and from above and at island walls from the water, over a range of speeds and frame lengths, and counts how
+// often it ends up on the far side: continuous sweeps against the discrete move-then-push-out collision the game used
+// before. Then walks the player from the first island to the last at 60 Hz and at 4 Hz, and reports the cost of one
+// sweep query and one move.
+
+#include "PlayerCollision.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+namespace {
+
+	constexpr int ISLANDS = 4;
+	constexpr float REGION = 150.0f;	// Islands.h REGION_SIZE
+	constexpr float ISLAND_HALF = 50.0f;	// TerrainManipulation::isOnTerrain
+	constexpr float BRIDGE_WIDTH = 5.0f;	// App1::generateBridges
+	constexpr float BRIDGE_HEIGHT = 0.5f;
+	constexpr float RADIUS = 1.8f;	// PlayerData::cameraEyeHeight
+	constexpr float CELL_SIZE = 2.0f;
+	constexpr float GRAVITY = 15.8f;	// Player::update
+	constexpr int TRIALS = 200;
+	constexpr int QUERIES = 200000;
+	const float SPEEDS[] = { 40.0f, 100.0f, 400.0f };
+	const float FRAME_TIMES[] = { 1.0f / 60.0f, 1.0f / 15.0f, 1.0f / 4.0f };
+
+	float terrainHeight(float x, float z) {
+		return sinf(x * 0.1f) * cosf(z * 0.1f);	// TerrainManipulation::getHeight
+	}
+
+	struct World {
+		CollisionGeometry geometry;
+		vector<float> rotations;
+	};
+
+	World makeWorld(mt19937& rng) {
+		uniform_real_distribution<float> rotation(-0.3f, 0.3f);
+		World world;
+		for (int i = 0; i < ISLANDS; i++) {
+			CollisionSlab slab;
+			slab.centreX = i * REGION;
+			slab.centreZ = 0.0f;
+			slab.halfSize = ISLAND_HALF;
+			slab.rotationY = rotation(rng);
+			slab.bottom = terrainHeight(slab.centreX, slab.centreZ) - 1.0f;
+			world.geometry.slabs.push_back(slab);
+			world.rotations.push_back(slab.rotationY);
+		}
+		for (int i = 1; i < ISLANDS; i++) {
+			const CollisionSlab& a = world.geometry.slabs[i - 1];
+			const CollisionSlab& b = world.geometry.slabs[i];
+			const float deck = (terrainHeight(a.centreX, a.centreZ) + terrainHeight(b.centreX, b.centreZ)) * 0.5f + BRIDGE_HEIGHT;
+			CollisionCapsule capsule;
+			capsule.radius = BRIDGE_WIDTH * 0.5f;
+			capsule.a = CollisionVector(a.centreX, deck - capsule.radius, a.centreZ);
+			capsule.b = CollisionVector(b.centreX, deck - capsule.radius, b.centreZ);
+			world.geometry.capsules.push_back(capsule);
+		}
+
+		CollisionGeometry& geometry = world.geometry;
+		const float reach = ISLAND_HALF * 1.4143f;
+		geometry.originX = -reach;
+		geometry.originZ = -reach;
+		geometry.cellSize = CELL_SIZE;
+		geometry.width = (int)ceilf(((ISLANDS - 1) * REGION + 2.0f * reach) / CELL_SIZE) + 1;
+		geometry.depth = (int)ceilf(2.0f * reach / CELL_SIZE) + 1;
+		for (int z = 0; z < geometry.depth; z++)
+			for (int x = 0; x < geometry.width; x++)
+				geometry.heights.push_back(terrainHeight(geometry.originX + x * CELL_SIZE, geometry.originZ + z * CELL_SIZE));
+		return world;
+	}
+
+	// Runs frames of fixed length with no gravity, so only the collision decides where the sphere stops
+	CollisionVector fire(const PlayerCollision& collision, CollisionVector position, CollisionVector velocity, float frameTime, float seconds) {
+		for (float time = 0.0f; time < seconds; time += frameTime) collision.move(position, velocity, frameTime, RADIUS);
+		return position;
+	}
+
+	struct Tunnels {
+		int bridgeSide = 0, bridgeTop = 0, wall = 0, shots = 0;
+	};
+
+	Tunnels shoot(const PlayerCollision& collision, const World& world, float speed, float frameTime, mt19937 rng) {
+		uniform_real_distribution<float> unit(0.0f, 1.0f);
+		Tunnels tunnels;
+		for (int trial = 0; trial < TRIALS; trial++) {
+			tunnels.shots++;
+
+			// Across a bridge deck at its centre line, from the side; the deck runs along x
+			const CollisionCapsule& bridge = world.geometry.capsules[trial % world.geometry.capsules.size()];
+			const float along = bridge.a.x + ISLAND_HALF * 1.5f + unit(rng) * (REGION - ISLAND_HALF * 3.0f);
+			const float side = trial & 1 ? 1.0f : -1.0f;
+			CollisionVector end = fire(collision, CollisionVector(along, bridge.a.y, side * 12.0f), CollisionVector(0.0f, 0.0f, -side * speed), frameTime, 1.0f);
+			tunnels.bridgeSide += end.z * side < 0.0f;
+
+			// Straight down onto the deck
+			end = fire(collision, CollisionVector(along, bridge.a.y + 40.0f, 0.0f), CollisionVector(0.0f, -speed, 0.0f), frameTime, 1.0f);
+			tunnels.bridgeTop += end.y < bridge.a.y;
+
+			// At an island wall from the water, low enough that it cannot step up, square on in the island's frame; anything
+			// but stopping at the wall is going through it. Offset to whichever side the rotation carries away from the
+			// bridges, which run along z = 0.
+			const int island = trial % ISLANDS;
+			const CollisionSlab& slab = world.geometry.slabs[island];
+			const float c = cosf(slab.rotationY), s = sinf(slab.rotationY);
+			const float localZ = (15.0f + unit(rng) * 25.0f) * (s < 0.0f ? -1.0f : 1.0f);
+			const float localX = -(ISLAND_HALF + 15.0f);
+			const CollisionVector start(slab.centreX + localX * c + localZ * s, slab.bottom - 0.5f, slab.centreZ - localX * s + localZ * c);
+			end = fire(collision, start, CollisionVector(speed * c, 0.0f, -speed * s), frameTime, 1.0f);
+			const float endX = (end.x - slab.centreX) * c - (end.z - slab.centreZ) * s;
+			tunnels.wall += endX > -ISLAND_HALF;
+		}
+		return tunnels;
+	}
+
+	// Walks along the bridges from the first island to the last, gravity on, as Player::update drives it
+	bool walk(const PlayerCollision& collision, const World& world, float frameTime, float& endX) {
+		const CollisionSlab& first = world.geometry.slabs.front();
+		CollisionVector position(first.centreX, terrainHeight(first.centreX, first.centreZ) + RADIUS + 0.5f, first.centreZ);
+		CollisionVector velocity(0.0f, 0.0f, 0.0f);
+		const float goal = world.geometry.slabs.back().centreX;
+		for (float time = 0.0f; time < 30.0f && position.x < goal; time += frameTime) {
+			const bool grounded = collision.isGrounded(position, RADIUS);
+			if (grounded) {
+				if (velocity.y < 0.0f) velocity.y = 0.0f;
+				velocity.x = 40.0f;	// Player::speed
+				velocity.z = -position.z * 2.0f;	// Keep to the deck's centre line
+			}
+			else velocity.y -= GRAVITY * frameTime;
+			collision.move(position, velocity, frameTime, RADIUS);
+			if (position.y < -50.0f) break;
+		}
+		endX = position.x;
+		return position.x >= goal && position.y > -5.0f;
+	}
+}
+
+int main() {
+	mt19937 rng(505);
+	const World world = makeWorld(rng);
+	PlayerCollision continuous, discrete;
+	continuous.setGeometry(world.geometry);
+	discrete.setGeometry(world.geometry);
+	discrete.setContinuous(false);
+	printf("PlayerCollision: %d islands, %d bridges, sphere radius %.1f, %d shots of each kind per case\n",
+		ISLANDS, ISLANDS - 1, RADIUS, TRIALS);
+
+	int continuousTunnels = 0;
+	for (float speed : SPEEDS) {
+		for (float frameTime : FRAME_TIMES) {
+			const Tunnels swept = shoot(continuous, world, speed, frameTime, rng);
+			const Tunnels jumped = shoot(discrete, world, speed, frameTime, rng);
+			printf("  %3.0f u/s %5.1f Hz : through bridge side %3d vs %3d, bridge top %3d vs %3d, island wall %3d vs %3d (swept vs discrete)\n",
+				speed, 1.0f / frameTime, swept.bridgeSide, jumped.bridgeSide, swept.bridgeTop, jumped.bridgeTop, swept.wall, jumped.wall);
+			continuousTunnels += swept.bridgeSide + swept.bridgeTop + swept.wall;
+		}
+	}
+
+	float endX;
+	const bool walked60 = walk(continuous, world, 1.0f / 60.0f, endX);
+	printf("  walk at 60 Hz    : %s (x %.1f)\n", walked60 ? "reached the last island" : "FELL OR STUCK", endX);
+	const bool walked4 = walk(continuous, world, 1.0f / 4.0f, endX);
+	printf("  walk at 4 Hz     : %s (x %.1f)\n", walked4 ? "reached the last island" : "FELL OR STUCK", endX);
+
+	// Query cost: random segments of up to a 4 Hz frame at speed around the islands and bridges
+	uniform_real_distribution<float> x(-60.0f, (ISLANDS - 1) * REGION + 60.0f), z(-60.0f, 60.0f), y(-3.0f, 8.0f), step(-10.0f, 10.0f);
+	vector<CollisionVector> starts(4096), moves(4096);
+	for (size_t i = 0; i < starts.size(); i++) {
+		starts[i] = CollisionVector(x(rng), y(rng), z(rng));
+		moves[i] = CollisionVector(step(rng), step(rng) * 0.3f, step(rng));
+	}
+	int hits = 0;
+	auto start = chrono::high_resolution_clock::now();
+	for (int i = 0; i < QUERIES; i++) {
+		CollisionHit hit;
+		hits += continuous.sweep(starts[i & 4095], moves[i & 4095], RADIUS, hit);
+	}
+	const double sweepNs = chrono::duration<double, nano>(chrono::high_resolution_clock::now() - start).count() / QUERIES;
+
+	start = chrono::high_resolution_clock::now();
+	float checksum = 0.0f;
+	for (int i = 0; i < QUERIES / 10; i++) {
+		const CollisionVector& move = moves[i & 4095];
+		CollisionVector position = starts[i & 4095], velocity(move.x * 4.0f, move.y * 4.0f, move.z * 4.0f);
+		continuous.move(position, velocity, 1.0f / 60.0f, RADIUS);
+		checksum += position.y;
+	}
+	const double moveNs = chrono::duration<double, nano>(chrono::high_resolution_clock::now() - start).count() / (QUERIES / 10);
+	printf("  sweep            : %.0f ns/query (%d%% hit)\n", sweepNs, 100 * hits / QUERIES);
+	printf("  move at 60 Hz    : %.0f ns/call (checksum %.0f)\n", moveNs, checksum);
+
+	return continuousTunnels == 0 && walked60 && walked4 ? 0 : 1;
+}
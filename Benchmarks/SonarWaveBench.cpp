@@ -0,0 +1,144 @@
+// SonarWaveBench.cpp
+// SonarWave against a brute-force scan of every entity each tick. Worlds grow at a fixed entity density while the
+// ping stays the game's size, so the wave's cost per tick should stay flat while the scan grows with the world.
+// Checks that every static entity inside the final radius is hit exactly once and nothing outside it is, then runs a
+// crowd of wandering ghosts regridded every tick and checks none is hit twice and none inside the ring slips past it.
+
+#include "SonarWave.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+namespace {
+
+	constexpr float DENSITY = 0.01f;	// Entities per square unit
+	constexpr float MAX_RADIUS = 100.0f;	// AudioState::sonarMaxRadius
+	constexpr float DURATION = 5.0f;	// SonarData::sonarDuration
+	constexpr float DT = 1.0f / 60.0f;
+	constexpr int MOVING = 20000;
+	constexpr float MOVING_AREA = 400.0f;
+	constexpr float MOVING_SPEED = 8.0f;	// GhostSwarm::WANDER_SPEED_MAX
+	const float WORLD_SIZES[] = { 500.0f, 2000.0f, 8000.0f };
+
+	struct Result {
+		double waveUs = 0.0, scanUs = 0.0;
+		long long cells = 0, tested = 0;
+		int hits = 0, duplicates = 0, missed = 0, wrong = 0;
+		int scanHits = 0;
+	};
+
+	Result runStatic(float worldSize, mt19937& rng) {
+		uniform_real_distribution<float> coordinate(-worldSize * 0.5f, worldSize * 0.5f);
+		vector<SonarPoint> points((size_t)(worldSize * worldSize * DENSITY));
+		for (size_t i = 0; i < points.size(); i++) points[i] = { coordinate(rng), coordinate(rng), (int)i };
+
+		SonarWave wave;
+		wave.setTargets(SonarTarget::Pickup, points);
+		vector<SonarHit> hits;
+		vector<int> hitCount(points.size(), 0);
+		Result result;
+
+		const float originX = coordinate(rng) * 0.5f, originZ = coordinate(rng) * 0.5f;
+		wave.ping(originX, originZ, MAX_RADIUS / DURATION, MAX_RADIUS);
+		wave.update(0.0f, hits);	// Builds the grid outside the timed loop, as the game does when islands change
+		for (const SonarHit& hit : hits) hitCount[hit.id]++;
+
+		int ticks = 0;
+		while (wave.isRunning()) {
+			auto start = chrono::high_resolution_clock::now();
+			wave.update(DT, hits);
+			result.waveUs += chrono::duration<double, micro>(chrono::high_resolution_clock::now() - start).count();
+			result.cells += wave.getLastCellsVisited();
+			result.tested += wave.getLastEntitiesTested();
+			for (const SonarHit& hit : hits) hitCount[hit.id]++;
+
+			// What a per-tick scan of the whole world would cost for the same answer
+			const float inner = max(wave.getRadius() - MAX_RADIUS / DURATION * DT, 0.0f), outer = wave.getRadius();
+			start = chrono::high_resolution_clock::now();
+			int scanned = 0;
+			for (const SonarPoint& point : points) {
+				const float dx = point.x - originX, dz = point.z - originZ, distanceSq = dx * dx + dz * dz;
+				scanned += distanceSq > inner * inner && distanceSq <= outer * outer;
+			}
+			result.scanUs += chrono::duration<double, micro>(chrono::high_resolution_clock::now() - start).count();
+			result.scanHits += scanned;
+			ticks++;
+		}
+
+		for (size_t i = 0; i < points.size(); i++) {
+			const float dx = points[i].x - originX, dz = points[i].z - originZ;
+			const bool inside = sqrtf(dx * dx + dz * dz) <= MAX_RADIUS;
+			result.hits += hitCount[i] > 0;
+			result.duplicates += hitCount[i] > 1;
+			result.missed += inside && hitCount[i] == 0;
+			result.wrong += !inside && hitCount[i] > 0;
+		}
+		result.waveUs /= ticks;
+		result.scanUs /= ticks;
+		result.cells /= ticks;
+		result.tested /= ticks;
+		return result;
+	}
+
+	// Random walkers at up to MOVING_SPEED, handed to the wave afresh every tick
+	Result runMoving(mt19937& rng) {
+		uniform_real_distribution<float> coordinate(-MOVING_AREA * 0.5f, MOVING_AREA * 0.5f), angle(0.0f, 6.2831853f);
+		vector<SonarPoint> points(MOVING);
+		vector<float> headings(MOVING);
+		for (int i = 0; i < MOVING; i++) {
+			points[i] = { coordinate(rng), coordinate(rng), i };
+			headings[i] = angle(rng);
+		}
+
+		SonarWave wave;
+		wave.setSlack(SonarTarget::Ghost, MOVING_SPEED * DT);
+		vector<SonarHit> hits;
+		vector<int> hitCount(MOVING, 0);
+		Result result;
+
+		wave.ping(0.0f, 0.0f, MAX_RADIUS / DURATION, MAX_RADIUS);
+		int ticks = 0;
+		while (wave.isRunning()) {
+			for (int i = 0; i < MOVING; i++) {
+				if (i % 16 == ticks % 16) headings[i] = angle(rng);
+				points[i].x += cosf(headings[i]) * MOVING_SPEED * DT;
+				points[i].z += sinf(headings[i]) * MOVING_SPEED * DT;
+			}
+			wave.setTargets(SonarTarget::Ghost, points);
+			const auto start = chrono::high_resolution_clock::now();
+			wave.update(DT, hits);
+			result.waveUs += chrono::duration<double, micro>(chrono::high_resolution_clock::now() - start).count();
+			for (const SonarHit& hit : hits) hitCount[hit.id]++;
+			ticks++;
+		}
+
+		for (int i = 0; i < MOVING; i++) {
+			const float distance = sqrtf(points[i].x * points[i].x + points[i].z * points[i].z);
+			result.hits += hitCount[i] > 0;
+			result.duplicates += hitCount[i] > 1;
+			result.missed += distance <= MAX_RADIUS && hitCount[i] == 0;
+		}
+		result.waveUs /= ticks;
+		return result;
+	}
+}
+
+int main() {
+	printf("SonarWave: ring to %.0f units over %.0f s at 60 Hz, %.2f entities per square unit\n", MAX_RADIUS, DURATION, DENSITY);
+	mt19937 rng(505);
+	bool ok = true;
+	for (float worldSize : WORLD_SIZES) {
+		const Result result = runStatic(worldSize, rng);
+		printf("  %5.0f world   : %7d entities, wave %6.2f us/tick (%lld cells, %lld tested), scan %8.2f us/tick, %d hit (scan %d), %d twice, %d missed, %d wrong\n",
+			worldSize, (int)(worldSize * worldSize * DENSITY), result.waveUs, result.cells, result.tested, result.scanUs,
+			result.hits, result.scanHits, result.duplicates, result.missed, result.wrong);
+		ok = ok && result.duplicates == 0 && result.missed == 0 && result.wrong == 0;
+	}
+
+	const Result moving = runMoving(rng);
+	printf("  moving        : %d ghosts regridded every tick, wave %.2f us/tick incl. rebuild, %d hit, %d twice, %d slipped past\n",
+		MOVING, moving.waveUs, moving.hits, moving.duplicates, moving.missed);
+	ok = ok && moving.duplicates == 0 && moving.missed == 0;
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,254 @@
+// SweepAndPruneBench.cpp
+// SweepAndPrune against an independent reference: sort by min x and sweep, testing every box against every other that
+// is still open. Worlds grow at a fixed box density with every box able to pair with every other, and each box drifts
+// a little every frame while one in a hundred is removed and replaced. Testing all pairs grows with the square of the
+// box count; the incremental update grows with the swaps, which per box only grow with the square root, since a wider
+// world at the same density packs more endpoints along each axis. Pairs are checked against the reference every
+// frame. Then a game-shaped stress test: a player with a pickup sensor and a ghost sensor among tens of thousands of
+// ghosts and pickups that never pair with each other. First, a handle's life: removed twice in a frame, recycled for
+// a new box, and removed again by that box's owner.
+
+#include "SweepAndPrune.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <set>
+
+namespace {
+
+	constexpr float HALF_SIZE = 1.0f;
+	constexpr float DENSITY = 0.02f;	// Boxes per square unit over x and z; y is shallow, like the islands
+	constexpr float WORLD_HEIGHT = 8.0f;
+	constexpr float DRIFT = 8.0f / 60.0f;	// GhostSwarm::WANDER_SPEED_MAX at 60 Hz
+	constexpr int FRAMES = 60;
+	constexpr int CHURN = 100;	// One box in this many replaced each frame
+	constexpr int BRUTE_FORCE_MAX = 16000;
+	const int COUNTS[] = { 1000, 4000, 16000, 64000 };
+
+	constexpr uint32_t LAYER_PLAYER = 1, LAYER_GHOST = 2, LAYER_PICKUP = 4;
+	constexpr int GAME_GHOSTS = 50000;
+	constexpr int GAME_PICKUPS = 2000;
+	constexpr float GAME_WORLD = 600.0f;
+	constexpr float PROXIMITY = 50.0f;	// App1::updateChromaticAberration
+
+	double microseconds(chrono::high_resolution_clock::time_point start) {
+		return chrono::duration<double, micro>(chrono::high_resolution_clock::now() - start).count();
+	}
+
+	struct Body {
+		BroadphaseBox box;
+		uint32_t layer, mask;
+		bool alive;
+	};
+
+	bool overlaps(const BroadphaseBox& a, const BroadphaseBox& b) {
+		for (int axis = 0; axis < 3; axis++) if (a.min[axis] > b.max[axis] || b.min[axis] > a.max[axis]) return false;
+		return true;
+	}
+
+	set<pair<int, int>> reference(const vector<Body>& bodies) {
+		vector<int> order;
+		for (int i = 0; i < (int)bodies.size(); i++) if (bodies[i].alive) order.push_back(i);
+		sort(order.begin(), order.end(), [&](int a, int b) { return bodies[a].box.min[0] < bodies[b].box.min[0]; });
+
+		set<pair<int, int>> found;
+		for (size_t i = 0; i < order.size(); i++) {
+			const Body& a = bodies[order[i]];
+			for (size_t j = i + 1; j < order.size() && bodies[order[j]].box.min[0] <= a.box.max[0]; j++) {
+				const Body& b = bodies[order[j]];
+				if (!(a.mask & b.layer) && !(b.mask & a.layer)) continue;
+				if (overlaps(a.box, b.box)) found.insert({ min(order[i], order[j]), max(order[i], order[j]) });
+			}
+		}
+		return found;
+	}
+
+	int mismatches(const SweepAndPrune& broadphase, const vector<Body>& bodies) {
+		set<pair<int, int>> found;
+		for (const BroadphasePair& pair : broadphase.getPairs()) found.insert({ pair.a, pair.b });
+		const set<pair<int, int>> expected = reference(bodies);
+		int wrong = 0;
+		for (const auto& pair : found) wrong += !expected.count(pair);
+		for (const auto& pair : expected) wrong += !found.count(pair);
+		return wrong;
+	}
+
+	// Every box tested against every other, as a loop over the world would
+	double bruteForceUs(const vector<Body>& bodies, int& pairs) {
+		const auto start = chrono::high_resolution_clock::now();
+		pairs = 0;
+		for (size_t i = 0; i < bodies.size(); i++) {
+			if (!bodies[i].alive) continue;
+			for (size_t j = i + 1; j < bodies.size(); j++) pairs += bodies[j].alive && overlaps(bodies[i].box, bodies[j].box);
+		}
+		return microseconds(start);
+	}
+
+	struct Result {
+		double updateUs = 0.0, rebuildUs = 0.0, bruteUs = 0.0;
+		long long swaps = 0, pairs = 0;
+		int wrong = 0, brutePairs = 0;
+	};
+
+	Result runUniform(int count, mt19937& rng) {
+		const float worldSize = sqrtf(count / DENSITY);
+		uniform_real_distribution<float> coordinate(0.0f, worldSize), height(0.0f, WORLD_HEIGHT), drift(-DRIFT, DRIFT);
+		auto randomBox = [&]() { return BroadphaseBox(coordinate(rng), height(rng), coordinate(rng), HALF_SIZE); };
+
+		SweepAndPrune broadphase;
+		vector<Body> bodies;
+		for (int i = 0; i < count; i++) {
+			const BroadphaseBox box = randomBox();
+			const int handle = broadphase.add(box, 1, 1);
+			if (handle >= (int)bodies.size()) bodies.resize(handle + 1);
+			bodies[handle] = { box, 1, 1, true };
+		}
+		Result result;
+		auto start = chrono::high_resolution_clock::now();
+		broadphase.update();
+		result.rebuildUs = microseconds(start);
+		result.wrong += mismatches(broadphase, bodies);
+
+		uniform_int_distribution<int> pick(0, count - 1);
+		for (int frame = 0; frame < FRAMES; frame++) {
+			for (int i = 0; i < count / CHURN; i++) {
+				int handle = pick(rng) % (int)bodies.size();
+				while (!bodies[handle].alive) handle = (handle + 1) % (int)bodies.size();
+				broadphase.remove(handle);
+				bodies[handle].alive = false;
+			}
+			for (int i = 0; i < count / CHURN; i++) {
+				const BroadphaseBox box = randomBox();
+				const int handle = broadphase.add(box, 1, 1);
+				if (handle >= (int)bodies.size()) bodies.resize(handle + 1);
+				bodies[handle] = { box, 1, 1, true };
+			}
+			for (int handle = 0; handle < (int)bodies.size(); handle++) {
+				Body& body = bodies[handle];
+				if (!body.alive) continue;
+				for (int axis = 0; axis < 3; axis += 2) {
+					const float step = drift(rng);
+					body.box.min[axis] += step;
+					body.box.max[axis] += step;
+				}
+				broadphase.move(handle, body.box);
+			}
+
+			start = chrono::high_resolution_clock::now();
+			broadphase.update();
+			result.updateUs += microseconds(start);
+			result.swaps += broadphase.getLastSwaps();
+			result.pairs += broadphase.getPairs().size();
+			result.wrong += mismatches(broadphase, bodies);
+		}
+		result.updateUs /= FRAMES;
+		result.swaps /= FRAMES;
+		result.pairs /= FRAMES;
+		if (count <= BRUTE_FORCE_MAX) result.bruteUs = bruteForceUs(bodies, result.brutePairs);
+		return result;
+	}
+
+	// A player's pickup and ghost sensors among ghosts and pickups that only pair with the player
+	Result runGame(mt19937& rng) {
+		uniform_real_distribution<float> coordinate(0.0f, GAME_WORLD), drift(-DRIFT, DRIFT);
+		SweepAndPrune broadphase;
+		vector<Body> bodies;
+		auto add = [&](const BroadphaseBox& box, uint32_t layer, uint32_t mask) {
+			const int handle = broadphase.add(box, layer, mask);
+			if (handle >= (int)bodies.size()) bodies.resize(handle + 1);
+			bodies[handle] = { box, layer, mask, true };
+			return handle;
+		};
+		for (int i = 0; i < GAME_GHOSTS; i++) add(BroadphaseBox(coordinate(rng), 3.0f, coordinate(rng), 0.5f), LAYER_GHOST, 0);
+		for (int i = 0; i < GAME_PICKUPS; i++) add(BroadphaseBox(coordinate(rng), 1.0f, coordinate(rng), 2.0f), LAYER_PICKUP, 0);
+		float playerX = GAME_WORLD * 0.5f, playerZ = GAME_WORLD * 0.5f;
+		const int body = add(BroadphaseBox(playerX, 3.0f, playerZ, 3.0f), LAYER_PLAYER, LAYER_PICKUP);
+		const int sensor = add(BroadphaseBox(playerX, 3.0f, playerZ, PROXIMITY), LAYER_PLAYER, LAYER_GHOST);
+		broadphase.update();
+
+		Result result;
+		result.wrong += mismatches(broadphase, bodies);
+		for (int frame = 0; frame < FRAMES; frame++) {
+			for (int handle = 0; handle < (int)bodies.size(); handle++) {
+				if (handle == body || handle == sensor) continue;
+				Body& ghost = bodies[handle];
+				if (ghost.layer != LAYER_GHOST) continue;
+				for (int axis = 0; axis < 3; axis += 2) {
+					const float step = drift(rng);
+					ghost.box.min[axis] += step;
+					ghost.box.max[axis] += step;
+				}
+				broadphase.move(handle, ghost.box);
+			}
+			playerX += 20.0f / 60.0f;	// Player::speed
+			bodies[body].box = BroadphaseBox(playerX, 3.0f, playerZ, 3.0f);
+			bodies[sensor].box = BroadphaseBox(playerX, 3.0f, playerZ, PROXIMITY);
+			broadphase.move(body, bodies[body].box);
+			broadphase.move(sensor, bodies[sensor].box);
+
+			const auto start = chrono::high_resolution_clock::now();
+			broadphase.update();
+			result.updateUs += microseconds(start);
+			result.swaps += broadphase.getLastSwaps();
+			result.pairs += broadphase.getPairs().size();
+			result.wrong += mismatches(broadphase, bodies);
+		}
+		result.updateUs /= FRAMES;
+		result.swaps /= FRAMES;
+		result.pairs /= FRAMES;
+		return result;
+	}
+
+	// A pickup collected twice over in one frame is removed once; after the update its handle goes to the next ghost,
+	// which pairs as itself and which its own remove() takes out again, leaving the handle free once more
+	bool checkRecycledHandle() {
+		SweepAndPrune broadphase;
+		const int player = broadphase.add(BroadphaseBox(0.0f, 0.0f, 0.0f, 2.0f), LAYER_PLAYER, LAYER_GHOST | LAYER_PICKUP);
+		const int pickup = broadphase.add(BroadphaseBox(1.0f, 0.0f, 0.0f, 1.0f), LAYER_PICKUP, 0);
+		broadphase.update();
+		if (broadphase.getPairs().size() != 1) return false;
+		broadphase.remove(pickup);
+		broadphase.remove(pickup);
+		broadphase.update();
+		if (broadphase.size() != 1 || !broadphase.getPairs().empty()) return false;
+
+		const int ghost = broadphase.add(BroadphaseBox(-1.0f, 0.0f, 0.0f, 1.0f), LAYER_GHOST, 0, 7);
+		broadphase.update();
+		broadphase.move(ghost, BroadphaseBox(-0.5f, 0.0f, 0.0f, 1.0f));
+		broadphase.update();
+		const vector<BroadphasePair>& pairs = broadphase.getPairs();
+		if (ghost != pickup || broadphase.size() != 2 || pairs.size() != 1 || broadphase.getUser(ghost) != 7 ||
+			broadphase.getLayer(ghost) != LAYER_GHOST || pairs[0].a != min(player, ghost) || pairs[0].b != max(player, ghost)) {
+			return false;
+		}
+		broadphase.remove(ghost);
+		broadphase.update();
+		return broadphase.size() == 1 && broadphase.getPairs().empty() &&
+			broadphase.add(BroadphaseBox(0.0f, 0.0f, 0.0f, 1.0f), LAYER_PICKUP, 0) == ghost;
+	}
+}
+
+int main() {
+	printf("SweepAndPrune: %d frames of drift at up to %.2f units a frame, 1 box in %d replaced each frame, %.2f boxes per square unit\n",
+		FRAMES, DRIFT, CHURN, DENSITY);
+	const bool recycled = checkRecycledHandle();
+	printf("  recycled handle: %s\n", recycled ? "ok" : "FAILED");
+	mt19937 rng(505);
+	bool ok = recycled;
+	for (int count : COUNTS) {
+		const Result result = runUniform(count, rng);
+		printf("  %6d boxes  : update %8.1f us (%5.3f us/box, %lld swaps, %lld pairs), first sort %8.1f us", count, result.updateUs,
+			result.updateUs / count, result.swaps, result.pairs, result.rebuildUs);
+		if (result.bruteUs > 0.0) printf(", all pairs %10.1f us (%d pairs)", result.bruteUs, result.brutePairs);
+		printf(", %d wrong\n", result.wrong);
+		ok = ok && result.wrong == 0;
+	}
+
+	const Result game = runGame(rng);
+	printf("  game          : %d ghosts, %d pickups, player sensors; update %.1f us (%lld swaps, %lld pairs), %d wrong\n",
+		GAME_GHOSTS, GAME_PICKUPS, game.updateUs, game.swaps, game.pairs, game.wrong);
+	ok = ok && game.wrong == 0;
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,238 @@
+// TerrainDisplacementBench.cpp
+// TerrainDisplacement against a CPU evaluation of the terrain domain shader. The reference builds the island cube's
+// top face the way CubeMesh does, picks points inside its triangles by barycentric weights, interpolates position and
+// texture coordinate as terrain_ds.hlsl does, displaces by a double-precision SampleLevel, and takes the result through
+// the island's scale, rotation and translation matrix. The height TerrainDisplacement gives at the resulting x and z
+// must match its y. The texture is generated, since there is no JPG decoder on Linux, with odd sizes so that the wrap
+// at each edge is exercised. Then the SSE2 sampler against the scalar one at every mip level, and the cost of filling
+// a collision height grid the size App1 builds, point by point and batched.
+
+#include "TerrainDisplacement.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+namespace {
+
+	constexpr int TEXTURE_WIDTH = 1000, TEXTURE_HEIGHT = 750;
+	constexpr float ISLAND_HALF_SIZE = 50.0f;	// Islands.h ISLAND_SIZE
+	constexpr int MESH_RESOLUTION = 20;	// CubeMesh's default
+	constexpr int ISLANDS = 6;
+	constexpr int SURFACE_POINTS = 200000;
+	constexpr int SAMPLER_POINTS = 100000;
+	constexpr float CELL_SIZE = 2.0f;	// App1::updatePlayerCollision
+	constexpr int GRID_REPEATS = 10;
+	constexpr double HEIGHT_TOLERANCE = 1e-4;
+	constexpr double SAMPLE_TOLERANCE = 1e-5;
+
+	double nanoseconds(chrono::high_resolution_clock::time_point start) {
+		return chrono::duration<double, nano>(chrono::high_resolution_clock::now() - start).count();
+	}
+
+	// A few octaves of smoothed value noise, so that neighbouring texels differ like a photo's do
+	vector<uint8_t> makeTexture(mt19937& rng) {
+		uniform_real_distribution<float> unit(0.0f, 1.0f);
+		vector<float> field((size_t)TEXTURE_WIDTH * TEXTURE_HEIGHT, 0.0f);
+		for (int octave = 0, step = 64; octave < 5; octave++, step /= 2) {
+			const int columns = TEXTURE_WIDTH / step + 2, rows = TEXTURE_HEIGHT / step + 2;
+			vector<float> lattice((size_t)columns * rows);
+			for (float& value : lattice) value = unit(rng);
+			for (int y = 0; y < TEXTURE_HEIGHT; y++) {
+				for (int x = 0; x < TEXTURE_WIDTH; x++) {
+					const int cx = x / step, cy = y / step;
+					const float fx = (float)(x % step) / step, fy = (float)(y % step) / step;
+					const float* row0 = &lattice[(size_t)cy * columns], *row1 = &lattice[(size_t)(cy + 1) * columns];
+					const float value = (row0[cx] * (1 - fx) + row0[cx + 1] * fx) * (1 - fy) + (row1[cx] * (1 - fx) + row1[cx + 1] * fx) * fy;
+					field[(size_t)y * TEXTURE_WIDTH + x] += value / (1 << octave);
+				}
+			}
+		}
+		vector<uint8_t> rgba((size_t)TEXTURE_WIDTH * TEXTURE_HEIGHT * 4);
+		for (size_t i = 0; i < field.size(); i++) {
+			const uint8_t red = (uint8_t)min(255.0f, field[i] / 1.9375f * 255.0f + 0.5f);
+			rgba[i * 4] = red;
+			rgba[i * 4 + 1] = (uint8_t)(255 - red);
+			rgba[i * 4 + 2] = 128;
+			rgba[i * 4 + 3] = 255;
+		}
+		return rgba;
+	}
+
+	// SampleLevel(0) with a linear filter and wrap addressing, in double
+	double referenceSample(const vector<uint8_t>& rgba, double u, double v) {
+		const double x = (u - floor(u)) * TEXTURE_WIDTH - 0.5, y = (v - floor(v)) * TEXTURE_HEIGHT - 0.5;
+		const double x0 = floor(x), y0 = floor(y);
+		auto texel = [&](double column, double row) {
+			const int wrappedX = ((int)column % TEXTURE_WIDTH + TEXTURE_WIDTH) % TEXTURE_WIDTH;
+			const int wrappedY = ((int)row % TEXTURE_HEIGHT + TEXTURE_HEIGHT) % TEXTURE_HEIGHT;
+			return rgba[((size_t)wrappedY * TEXTURE_WIDTH + wrappedX) * 4] / 255.0;
+		};
+		const double fx = x - x0, fy = y - y0;
+		const double above = texel(x0, y0) * (1 - fx) + texel(x0 + 1, y0) * fx;
+		const double below = texel(x0, y0 + 1) * (1 - fx) + texel(x0 + 1, y0 + 1) * fx;
+		return above * (1 - fy) + below * fy;
+	}
+
+	struct MeshVertex {
+		double x, y, z, u, v;
+	};
+
+	// The two triangles of one top-face quad, in CubeMesh's winding and texture layout
+	void topFaceQuad(int column, int row, MeshVertex triangles[2][3]) {
+		const double increment = 2.0 / MESH_RESOLUTION, texIncrement = 1.0 / MESH_RESOLUTION;
+		const double xstart = -1.0 + column * increment, ystart = 1.0 - row * increment;
+		const double txu = column * texIncrement, txv = row * texIncrement;
+		const MeshVertex bottomLeft = { xstart, 1.0, ystart - increment, txu, txv + texIncrement };
+		const MeshVertex topRight = { xstart + increment, 1.0, ystart, txu + texIncrement, txv };
+		const MeshVertex topLeft = { xstart, 1.0, ystart, txu, txv };
+		const MeshVertex bottomRight = { xstart + increment, 1.0, ystart - increment, txu + texIncrement, txv + texIncrement };
+		triangles[0][0] = bottomLeft; triangles[0][1] = topRight; triangles[0][2] = topLeft;
+		triangles[1][0] = bottomLeft; triangles[1][1] = bottomRight; triangles[1][2] = topRight;
+	}
+
+	// XMMatrixScaling(s, 1, s) * XMMatrixRotationY(r) * XMMatrixTranslation(cx, base, cz), row vector on the left
+	void transform(const DisplacedIsland& island, double x, double y, double z, double& worldX, double& worldY, double& worldZ) {
+		double scale[4][4] = { { ISLAND_HALF_SIZE, 0, 0, 0 }, { 0, 1, 0, 0 }, { 0, 0, ISLAND_HALF_SIZE, 0 }, { 0, 0, 0, 1 } };
+		const double c = cos(island.rotationY), s = sin(island.rotationY);
+		double rotation[4][4] = { { c, 0, -s, 0 }, { 0, 1, 0, 0 }, { s, 0, c, 0 }, { 0, 0, 0, 1 } };
+		double translation[4][4] = { { 1, 0, 0, 0 }, { 0, 1, 0, 0 }, { 0, 0, 1, 0 }, { island.centreX, island.baseHeight, island.centreZ, 1 } };
+		auto multiply = [](const double a[4][4], const double b[4][4], double out[4][4]) {
+			for (int i = 0; i < 4; i++)
+				for (int j = 0; j < 4; j++) {
+					out[i][j] = 0;
+					for (int k = 0; k < 4; k++) out[i][j] += a[i][k] * b[k][j];
+				}
+		};
+		double scaled[4][4], world[4][4];
+		multiply(scale, rotation, scaled);
+		multiply(scaled, translation, world);
+		const double point[4] = { x, y, z, 1 };
+		double out[3] = {};
+		for (int j = 0; j < 3; j++) for (int k = 0; k < 4; k++) out[j] += point[k] * world[k][j];
+		worldX = out[0];
+		worldY = out[1];
+		worldZ = out[2];
+	}
+
+	vector<DisplacedIsland> makeIslands(mt19937& rng) {
+		uniform_real_distribution<float> jitter(-10.0f, 10.0f), turn(0.0f, 6.2832f);
+		vector<DisplacedIsland> islands;
+		for (int i = 0; i < ISLANDS; i++) {
+			DisplacedIsland island;
+			island.centreX = (i % 3) * 160.0f + jitter(rng);
+			island.centreZ = (i / 3) * 160.0f + jitter(rng);
+			island.rotationY = turn(rng);
+			island.baseHeight = sinf(island.centreX * 0.1f) * cosf(island.centreZ * 0.1f);	// TerrainManipulation::getHeight
+			islands.push_back(island);
+		}
+		return islands;
+	}
+}
+
+int main() {
+	mt19937 rng(42);
+	const vector<uint8_t> rgba = makeTexture(rng);
+	const vector<DisplacedIsland> islands = makeIslands(rng);
+	TerrainDisplacement displacement;
+	displacement.setTexture(TEXTURE_WIDTH, TEXTURE_HEIGHT, rgba.data(), TEXTURE_WIDTH * 4);
+	displacement.setIslands(islands, ISLAND_HALF_SIZE);
+	printf("TerrainDisplacement: %dx%d texture, %d mip levels, %d islands\n", TEXTURE_WIDTH, TEXTURE_HEIGHT,
+		displacement.getLevelCount(), ISLANDS);
+	bool ok = true;
+
+	// Domain shader points against heightAt
+	uniform_int_distribution<int> pickIsland(0, ISLANDS - 1), pickQuad(0, MESH_RESOLUTION - 1), pickTriangle(0, 1);
+	uniform_real_distribution<double> unit(0.0, 1.0);
+	double worst = 0.0;
+	int missing = 0;
+	for (int i = 0; i < SURFACE_POINTS; i++) {
+		MeshVertex triangles[2][3];
+		topFaceQuad(pickQuad(rng), pickQuad(rng), triangles);
+		const MeshVertex* patch = triangles[pickTriangle(rng)];
+		double a = unit(rng), b = unit(rng);
+		if (a + b > 1.0) {
+			a = 1.0 - a;
+			b = 1.0 - b;
+		}
+		const double weights[3] = { a, b, 1.0 - a - b };
+		MeshVertex vertex = {};
+		for (int corner = 0; corner < 3; corner++) {
+			vertex.x += weights[corner] * patch[corner].x;
+			vertex.y += weights[corner] * patch[corner].y;
+			vertex.z += weights[corner] * patch[corner].z;
+			vertex.u += weights[corner] * patch[corner].u;
+			vertex.v += weights[corner] * patch[corner].v;
+		}
+		vertex.y += referenceSample(rgba, vertex.u, vertex.v) * TerrainDisplacement::DISPLACEMENT_SCALE;
+
+		// Islands are far enough apart that the point can only be on its own
+		double worldX, worldY, worldZ;
+		transform(islands[pickIsland(rng)], vertex.x, vertex.y, vertex.z, worldX, worldY, worldZ);
+		float height;
+		if (!displacement.heightAt((float)worldX, (float)worldZ, height)) {
+			// Points exactly on the face's edge may land a rounding error outside it
+			missing += max(fabs(vertex.x), fabs(vertex.z)) < 1.0 - 1e-5;
+			continue;
+		}
+		worst = max(worst, fabs(height - worldY));
+	}
+	printf("  domain shader : %d points, worst height error %.2e, %d missed\n", SURFACE_POINTS, worst, missing);
+	ok = ok && worst <= HEIGHT_TOLERANCE && missing == 0;
+
+	// SSE2 against scalar at every level, coordinates well outside 0..1 so that the wrap is tested
+	uniform_real_distribution<float> coordinate(-3.0f, 3.0f);
+	vector<float> u(SAMPLER_POINTS), v(SAMPLER_POINTS), batched(SAMPLER_POINTS);
+	for (int i = 0; i < SAMPLER_POINTS; i++) {
+		u[i] = coordinate(rng);
+		v[i] = coordinate(rng);
+	}
+	double worstSample = 0.0;
+	for (int level = 0; level < displacement.getLevelCount(); level++) {
+		displacement.sample(u.data(), v.data(), SAMPLER_POINTS, batched.data(), level);
+		for (int i = 0; i < SAMPLER_POINTS; i++) worstSample = max(worstSample, (double)fabsf(batched[i] - displacement.sample(u[i], v[i], level)));
+	}
+	double worstReference = 0.0;
+	displacement.sample(u.data(), v.data(), SAMPLER_POINTS, batched.data());
+	for (int i = 0; i < SAMPLER_POINTS; i++) worstReference = max(worstReference, fabs(batched[i] - referenceSample(rgba, u[i], v[i])));
+	printf("  sampler       : %s, worst batched against scalar %.2e over %d levels, against reference %.2e\n",
+		TerrainDisplacement::hasSimd() ? "SSE2" : "scalar only", worstSample, displacement.getLevelCount(), worstReference);
+	ok = ok && worstSample <= SAMPLE_TOLERANCE && worstReference <= SAMPLE_TOLERANCE;
+
+	// A collision grid over every island, as App1 fills it
+	const float minX = -80.0f, minZ = -80.0f, maxX = 400.0f, maxZ = 240.0f;
+	const int width = (int)((maxX - minX) / CELL_SIZE) + 1, depth = (int)((maxZ - minZ) / CELL_SIZE) + 1;
+	vector<float> xs((size_t)width * depth), zs(xs.size()), single(xs.size()), scalar(xs.size()), simd(xs.size());
+	for (int z = 0; z < depth; z++) {
+		for (int x = 0; x < width; x++) {
+			xs[(size_t)z * width + x] = minX + x * CELL_SIZE;
+			zs[(size_t)z * width + x] = minZ + z * CELL_SIZE;
+		}
+	}
+	auto start = chrono::high_resolution_clock::now();
+	for (int repeat = 0; repeat < GRID_REPEATS; repeat++) {
+		for (size_t i = 0; i < xs.size(); i++) {
+			if (!displacement.heightAt(xs[i], zs[i], single[i])) single[i] = -1e30f;
+		}
+	}
+	const double singleNs = nanoseconds(start) / (GRID_REPEATS * xs.size());
+	displacement.setSimd(false);
+	start = chrono::high_resolution_clock::now();
+	for (int repeat = 0; repeat < GRID_REPEATS; repeat++) displacement.heightsAt(xs.data(), zs.data(), xs.size(), scalar.data(), -1e30f);
+	const double scalarNs = nanoseconds(start) / (GRID_REPEATS * xs.size());
+	displacement.setSimd(true);
+	start = chrono::high_resolution_clock::now();
+	for (int repeat = 0; repeat < GRID_REPEATS; repeat++) displacement.heightsAt(xs.data(), zs.data(), xs.size(), simd.data(), -1e30f);
+	const double simdNs = nanoseconds(start) / (GRID_REPEATS * xs.size());
+
+	int wrong = 0, onTerrain = 0;
+	for (size_t i = 0; i < xs.size(); i++) {
+		onTerrain += single[i] > -1e29f;
+		wrong += fabsf(single[i] - scalar[i]) > SAMPLE_TOLERANCE || fabsf(single[i] - simd[i]) > SAMPLE_TOLERANCE;
+	}
+	printf("  height grid   : %dx%d points, %d on an island; heightAt %.1f ns/point, batched %.1f ns/point, batched SSE2 %.1f ns/point, %d wrong\n",
+		width, depth, onTerrain, singleNs, scalarNs, simdNs, wrong);
+	ok = ok && wrong == 0;
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,138 @@
+// TerrainLodBench.cpp
+// TerrainLod against an independent restatement of its rule, frame by frame: tessellate when the error projected from
+// the nearest point of an object's bounds passes the threshold and it is inside the hull shader's range, and stay
+// tessellated until it falls below the hysteresis band. The world is a field of islands and the bridges between
+// neighbours, with the islands' error measured from a generated texture by TerrainDisplacement::flatError and a
+// bridge's scaled by its half-height deck. A camera flies low across the field, reporting how many of the patches the
+// hull shader would have run are left once distant objects take the plain mesh. Then a camera hovering at the
+// threshold of one island, where hysteresis has to keep the path from flipping back and forth every frame.
+
+#include "TerrainDisplacement.h"
+#include "TerrainLod.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+namespace {
+
+	constexpr int GRID = 32;	// Islands along each side
+	constexpr float SPACING = 160.0f;
+	constexpr float ISLAND_HALF_SIZE = 50.0f;
+	constexpr float BRIDGE_HEIGHT = 0.5f;	// App1::generateBridges scales the cube's y by this
+	constexpr int MESH_RESOLUTION = 20;	// CubeMesh's default
+	constexpr int PATCHES = MESH_RESOLUTION * MESH_RESOLUTION * 2 * 6;
+	constexpr float VIEWPORT_HEIGHT = 720.0f;
+	constexpr float FIELD_OF_VIEW = 3.14159265f / 4.0f;	// D3D's projection
+	constexpr int FRAMES = 2000;
+	constexpr int HOVER_FRAMES = 600;
+
+	double microseconds(chrono::high_resolution_clock::time_point start) {
+		return chrono::duration<double, micro>(chrono::high_resolution_clock::now() - start).count();
+	}
+
+	vector<uint8_t> makeTexture(mt19937& rng, int size) {
+		uniform_int_distribution<int> texel(0, 255);
+		vector<uint8_t> rgba((size_t)size * size * 4, 255);
+		for (size_t i = 0; i < rgba.size(); i += 4) rgba[i] = (uint8_t)texel(rng);
+		return rgba;
+	}
+
+	vector<LodObject> makeWorld(float islandError) {
+		vector<LodObject> objects;
+		const float islandRadius = sqrtf(2.0f * ISLAND_HALF_SIZE * ISLAND_HALF_SIZE + 1.2f * 1.2f);
+		for (int z = 0; z < GRID; z++) {
+			for (int x = 0; x < GRID; x++) {
+				const float centreX = x * SPACING, centreZ = z * SPACING, base = sinf(centreX * 0.1f) * cosf(centreZ * 0.1f);
+				objects.push_back({ centreX, base + 1.0f, centreZ, islandRadius, islandError });
+				// A bridge to the next island along x and along z
+				const float length = SPACING - 2.0f * ISLAND_HALF_SIZE, bridgeRadius = sqrtf(length * length * 0.25f + 2.5f * 2.5f);
+				if (x + 1 < GRID) objects.push_back({ centreX + SPACING * 0.5f, base + BRIDGE_HEIGHT, centreZ, bridgeRadius, islandError * BRIDGE_HEIGHT });
+				if (z + 1 < GRID) objects.push_back({ centreX, base + BRIDGE_HEIGHT, centreZ + SPACING * 0.5f, bridgeRadius, islandError * BRIDGE_HEIGHT });
+			}
+		}
+		return objects;
+	}
+
+	// The rule written out again from the header's description
+	struct Reference {
+		vector<bool> tessellated;
+		float pixelsPerUnit, threshold, lower, range, hysteresis;
+
+		int update(const vector<LodObject>& objects, float x, float y, float z) {
+			int switches = 0;
+			for (size_t i = 0; i < objects.size(); i++) {
+				const LodObject& object = objects[i];
+				const double distance = max(sqrt(pow(object.centreX - x, 2.0) + pow(object.centreY - y, 2.0) + pow(object.centreZ - z, 2.0)) - object.radius, 0.01);
+				const double error = object.error * pixelsPerUnit / distance;
+				const bool wanted = tessellated[i] ? error >= lower && distance < range * (1.0 + hysteresis) : error > threshold && distance < range;
+				switches += wanted != tessellated[i];
+				tessellated[i] = wanted;
+			}
+			return switches;
+		}
+	};
+
+	// A steady hover at the first island's boundary, wherever the error or the hull shader's range puts it
+	int hover(const vector<LodObject>& objects, float hysteresis, mt19937& rng) {
+		TerrainLod lod;
+		lod.setObjects(objects);
+		lod.setProjection(VIEWPORT_HEIGHT, FIELD_OF_VIEW);
+		lod.setHysteresis(hysteresis);
+		const LodObject& island = objects[0];
+		const float pixelsPerUnit = VIEWPORT_HEIGHT * 0.5f / tanf(FIELD_OF_VIEW * 0.5f);
+		const float boundary = min(island.error * pixelsPerUnit / TerrainLod::DEFAULT_THRESHOLD, TerrainLod::HULL_RANGE);
+		normal_distribution<float> sway(0.0f, 0.05f);
+		int switches = 0;
+		for (int frame = 0; frame < HOVER_FRAMES; frame++) {
+			lod.update(island.centreX - island.radius - boundary + sway(rng), island.centreY, island.centreZ);
+			switches += lod.getLastSwitches();
+		}
+		return switches;
+	}
+}
+
+int main() {
+	mt19937 rng(43);
+	const int textureSize = 256;
+	const vector<uint8_t> rgba = makeTexture(rng, textureSize);
+	TerrainDisplacement displacement;
+	displacement.setTexture(textureSize, textureSize, rgba.data(), textureSize * 4);
+	const float islandError = displacement.flatError(MESH_RESOLUTION);
+
+	const vector<LodObject> objects = makeWorld(islandError);
+	TerrainLod lod;
+	lod.setObjects(objects);
+	lod.setProjection(VIEWPORT_HEIGHT, FIELD_OF_VIEW);
+	Reference reference = { vector<bool>(objects.size(), false), VIEWPORT_HEIGHT * 0.5f / tanf(FIELD_OF_VIEW * 0.5f),
+		TerrainLod::DEFAULT_THRESHOLD, TerrainLod::DEFAULT_THRESHOLD * (1.0f - TerrainLod::DEFAULT_HYSTERESIS), TerrainLod::HULL_RANGE, TerrainLod::DEFAULT_HYSTERESIS };
+	printf("TerrainLod: %zu islands and bridges, island error %.3f units, %d patches each\n", objects.size(), islandError, PATCHES);
+
+	// Low over the field in a slow weave, so the camera passes over islands and bridges alike
+	double updateUs = 0.0;
+	long long tessellated = 0, switches = 0;
+	int wrong = 0;
+	const float extent = (GRID - 1) * SPACING;
+	for (int frame = 0; frame < FRAMES; frame++) {
+		const float t = (float)frame / FRAMES;
+		const float x = extent * t, z = extent * (0.5f + 0.45f * sinf(t * 12.0f)), y = 4.0f + 3.0f * sinf(t * 40.0f);
+		const auto start = chrono::high_resolution_clock::now();
+		lod.update(x, y, z);
+		updateUs += microseconds(start);
+		tessellated += lod.getTessellatedCount();
+		switches += lod.getLastSwitches();
+		if (reference.update(objects, x, y, z) != lod.getLastSwitches()) wrong++;
+		for (int i = 0; i < lod.size(); i++) wrong += lod.isTessellated(i) != reference.tessellated[i];
+	}
+	const double average = (double)tessellated / FRAMES;
+	printf("  fly-over      : %.1f us per update (%.1f ns per object), %.2f tessellated on average, %.3f%% of %zu objects' patches through the hull shader, %lld switches, %d wrong\n",
+		updateUs / FRAMES, updateUs * 1000.0 / FRAMES / objects.size(), average, 100.0 * average / objects.size(), objects.size(), switches, wrong);
+
+	const int steady = hover(objects, TerrainLod::DEFAULT_HYSTERESIS, rng), flicker = hover(objects, 0.0f, rng);
+	printf("  hover         : %d frames at the threshold, %d switches with %.0f%% hysteresis, %d without\n",
+		HOVER_FRAMES, steady, TerrainLod::DEFAULT_HYSTERESIS * 100.0f, flicker);
+
+	const bool ok = wrong == 0 && steady <= 1 && flicker > steady;
+	return ok ? 0 : 1;
+}
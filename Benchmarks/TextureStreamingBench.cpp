@@ -0,0 +1,233 @@
+// TextureStreamingBench.cpp
+// The headless half of TextureManager's streaming mode. TextureStreamQueue first: jobs come out highest priority
+// first and in submission order on ties, setPriority reorders what's still queued, and close() discards what's left,
+// refuses new jobs and wakes a worker blocked in pop() until reopen(). Then MipResidencyScheduler on a 256x256 RGBA
+// chain: the mip tail lands together on the first frame, the min LOD then steps down one level at a time under the
+// byte budget, every level is uploaded exactly once, the higher priority texture finishes first, and ids the
+// scheduler doesn't hold read as nothing resident. Then pickEvictionVictim driven the way TextureManager drives it:
+// a working set bigger than the memory budget stays loaded instead of reloading every frame, while what goes undrawn
+// is released, unreferenced before referenced and least recently used first. Last, what a frame's schedule() costs
+// with a scene's worth queued.
+
+#include "TextureStreaming.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+	constexpr size_t BUDGET = 64 * 1024;	// TextureManager's uploadBudget is per frame, as here
+	constexpr int TEXTURES = 200;
+	constexpr int FRAMES = 1000;
+
+	// RGBA8 levels from size x size down to 1x1, level 0 first
+	vector<size_t> chain(int size) {
+		vector<size_t> levels;
+		for (; size >= 1; size /= 2) levels.push_back((size_t)size * size * 4);
+		return levels;
+	}
+
+	bool checkOrdering() {
+		TextureStreamQueue queue;
+		queue.push(1, L"a.dds", 1.0f);
+		queue.push(2, L"b.dds", 3.0f);
+		queue.push(3, L"c.dds", 3.0f);
+		queue.push(4, L"d.dds", 2.0f);
+		queue.setPriority(1, 5.0f);	// Drawn a lot since it was asked for
+
+		const int expected[] = { 1, 2, 3, 4 };
+		TextureStreamJob job;
+		for (int id : expected) {
+			if (!queue.tryPop(job) || job.id != id) return false;
+		}
+		if (queue.tryPop(job)) return false;
+
+		// Taken jobs are out of reach of setPriority
+		queue.push(5, L"e.dds", 1.0f);
+		queue.tryPop(job);
+		queue.setPriority(5, 9.0f);
+		return queue.size() == 0 && job.filename == L"e.dds" && job.priority == 1.0f;
+	}
+
+	bool checkCancellation() {
+		TextureStreamQueue queue;
+		queue.push(1, L"a.dds", 1.0f);
+		queue.push(2, L"b.dds", 2.0f);
+		queue.close();
+		TextureStreamJob job;
+		if (queue.size() != 0 || queue.tryPop(job)) return false;
+		queue.push(3, L"c.dds", 1.0f);	// Refused while closed
+		if (queue.size() != 0) return false;
+
+		// A worker waiting for work is woken by close() and told to stop
+		queue.reopen();
+		atomic<int> popped{ -1 };
+		thread worker([&] {
+			TextureStreamJob taken;
+			popped = queue.pop(taken) ? 1 : 0;
+		});
+		this_thread::sleep_for(chrono::milliseconds(20));
+		queue.close();
+		worker.join();
+		if (popped != 0) return false;
+
+		// Open again, the queue hands out work as before
+		queue.reopen();
+		queue.push(4, L"d.dds", 1.0f);
+		return queue.pop(job) && job.id == 4;
+	}
+
+	struct Residency {
+		bool tailFirst = true;
+		bool stepsByOne = true;
+		bool eachOnce = true;
+		bool withinBudget = true;
+		bool priorityFirst = false;
+		bool unknownNoneResident = false;
+		int frames = 0;
+	};
+
+	Residency checkResidency() {
+		Residency result;
+		const vector<size_t> levels = chain(256);
+		const int count = (int)levels.size();
+		MipResidencyScheduler scheduler;
+		scheduler.add(1, levels);
+		scheduler.add(2, levels);
+		scheduler.setPriority(2, 10.0f);
+		result.unknownNoneResident = scheduler.residentLevel(3) == MipResidencyScheduler::noneResident &&
+			scheduler.residentLevel(1) == count && !scheduler.isComplete(1);
+
+		vector<vector<int>> uploaded(3, vector<int>(count, 0));
+		int lastLevel[3] = { count, count, count };
+		int finished[3] = { -1, -1, -1 };
+		vector<MipResidencyScheduler::Upload> uploads;
+		for (int frame = 0; frame < 100 && !(scheduler.isComplete(1) && scheduler.isComplete(2)); frame++) {
+			uploads.clear();
+			scheduler.schedule(BUDGET, uploads);
+			size_t spent = 0;
+			for (const auto& upload : uploads) {
+				uploaded[upload.id][upload.level]++;
+				spent += levels[upload.level];
+				scheduler.markResident(upload.id, upload.level);
+			}
+			// One upload may go over, so the top level still lands; two may not
+			if (uploads.size() > 1 && spent > BUDGET) result.withinBudget = false;
+
+			for (int id = 1; id <= 2; id++) {
+				// The whole tail on the first frame, then a level at a time
+				const int resident = scheduler.residentLevel(id);
+				if (frame == 0 && (resident == count || levels[resident] > MipResidencyScheduler::tailBytes)) result.tailFirst = false;
+				if (frame > 0 && resident < lastLevel[id] - 1) result.stepsByOne = false;
+				lastLevel[id] = resident;
+				if (resident == 0 && finished[id] < 0) finished[id] = frame;
+			}
+			result.frames = frame + 1;
+		}
+		for (int id = 1; id <= 2; id++) {
+			for (int level = 0; level < count; level++) {
+				if (uploaded[id][level] != 1) result.eachOnce = false;
+			}
+		}
+		result.priorityFirst = finished[2] >= 0 && finished[1] >= 0 && finished[2] < finished[1];
+
+		// Taken out once complete, as TextureManager does; it then reads as never added
+		scheduler.remove(1);
+		result.unknownNoneResident = result.unknownNoneResident && scheduler.isComplete(2) &&
+			scheduler.residentLevel(1) == MipResidencyScheduler::noneResident;
+		return result;
+	}
+
+	// TextureManager's frame: update() evicts over budget and then moves the frame on, then the draws stamp what they
+	// use. With advanceFirst the counter moves before eviction instead, so last frame's draws already read as idle.
+	// Returns how many loads the frames took; the first frame's are all of them when nothing thrashes.
+	int countLoads(int textures, int budgetTextures, int frames, bool advanceFirst) {
+		vector<TextureEvictionCandidate> loaded;
+		vector<bool> resident(textures, false);
+		unsigned int frame = 0;
+		int loads = 0;
+		for (int f = 0; f < frames; f++) {
+			if (advanceFirst) frame++;
+			while ((int)loaded.size() > budgetTextures) {
+				const int victim = pickEvictionVictim(loaded, frame, 60);
+				if (victim < 0) break;
+				resident[loaded[victim].id] = false;
+				loaded[victim] = loaded.back();
+				loaded.pop_back();
+			}
+			if (!advanceFirst) frame++;
+
+			for (int id = 0; id < textures; id++) {
+				if (!resident[id]) {
+					resident[id] = true;
+					loaded.push_back({ id, frame, false });
+					loads++;
+				}
+				for (auto& candidate : loaded) {
+					if (candidate.id == id) candidate.lastUsedFrame = frame;
+				}
+			}
+		}
+		return loads;
+	}
+
+	bool checkEvictionOrder() {
+		// Frame 10 has just been drawn: 0 was drawn in it, 1 and 2 are unreferenced, 3 and 4 referenced
+		const vector<TextureEvictionCandidate> candidates = {
+			{ 0, 10, false }, { 1, 8, false }, { 2, 4, false }, { 3, 2, true }, { 4, 9, true } };
+		vector<TextureEvictionCandidate> left = candidates;
+		vector<int> order;
+		for (int victim; (victim = pickEvictionVictim(left, 10, 5)) >= 0;) {
+			order.push_back(left[victim].id);
+			left.erase(left.begin() + victim);
+		}
+		// 0 was drawn last frame and 4 was drawn within the delay, so neither may go
+		return order == vector<int>{ 2, 1, 3 };
+	}
+}
+
+int main() {
+	const bool ordered = checkOrdering(), cancelled = checkCancellation();
+	const Residency residency = checkResidency();
+	const bool resident = residency.tailFirst && residency.stepsByOne && residency.eachOnce && residency.withinBudget &&
+		residency.priorityFirst && residency.unknownNoneResident;
+	printf("TextureStreaming: queue order %s, cancellation %s\n", ordered ? "ok" : "FAILED", cancelled ? "ok" : "FAILED");
+	printf("  residency: tail first %s, one level a step %s, each level once %s, budget %s, priority %s, "
+		"unknown ids %s; two 256x256 chains in %d frames\n",
+		residency.tailFirst ? "ok" : "FAILED", residency.stepsByOne ? "ok" : "FAILED", residency.eachOnce ? "ok" : "FAILED",
+		residency.withinBudget ? "ok" : "FAILED", residency.priorityFirst ? "ok" : "FAILED",
+		residency.unknownNoneResident ? "ok" : "FAILED", residency.frames);
+
+	const bool evictionOrder = checkEvictionOrder();
+	const int loads = countLoads(12, 8, 100, false), advanceFirstLoads = countLoads(12, 8, 100, true);
+	const bool noThrash = loads == 12;
+	printf("  eviction: order %s; 12 textures drawn every frame over a budget of 8, %d loads in 100 frames %s "
+		"(%d with the frame counted before evicting)\n", evictionOrder ? "ok" : "FAILED", loads, noThrash ? "ok" : "FAILED",
+		advanceFirstLoads);
+
+	// A scene's worth of textures streaming in at once, rescheduled every frame as they refine
+	MipResidencyScheduler scheduler;
+	const vector<size_t> levels = chain(1024);
+	for (int id = 0; id < TEXTURES; id++) {
+		scheduler.add(id, levels);
+		scheduler.setPriority(id, (float)(id % 7));
+	}
+	vector<MipResidencyScheduler::Upload> uploads;
+	size_t issued = 0;
+	const auto start = chrono::high_resolution_clock::now();
+	for (int frame = 0; frame < FRAMES; frame++) {
+		uploads.clear();
+		scheduler.schedule(BUDGET, uploads);
+		for (const auto& upload : uploads) scheduler.markResident(upload.id, upload.level);
+		issued += uploads.size();
+	}
+	const double ms = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+	printf("  schedule, %d textures of 1024x1024: %.2f us a frame, %zu uploads over %d frames\n", TEXTURES,
+		ms * 1000.0 / FRAMES, issued, FRAMES);
+	return ordered && cancelled && resident && evictionOrder && noThrash ? 0 : 1;
+}
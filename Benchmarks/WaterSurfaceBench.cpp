@@ -0,0 +1,152 @@
+// WaterSurfaceBench.cpp
+// WaterSurface against water_vs.hlsl written out again here in double precision. The sine waves are checked at random
+// points, heights against the shader's formula and normals against central differences of it. The ocean is checked
+// the way the shader draws it: random vertices are carried to p + D(p) by bilinear samples of OceanFFT's texture, and
+// the query at where each lands should give back its height. Where the surface folds over, two vertices land on the
+// same point and either answer is drawn, so those are only counted. Then the cost of a query, one at a time and in
+// batches, scalar and SSE2.
+
+#include "OceanFFT.h"
+#include "WaterSurface.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+
+	// App1::renderWater's sine-wave plane and WaterData's defaults
+	constexpr float PLANE_SCALE = 700.0f;
+	constexpr float PLANE_OFFSET = 1.0f;
+	constexpr float LEVEL = -50.0f;
+	constexpr float AMPLITUDE = 0.5f, FREQUENCY = 0.37f, SPEED = 2.0f;
+	constexpr float TIME = 123.4f;
+	constexpr float WORLD_SIZE = 700.0f;
+	constexpr int POINTS = 100000;
+	constexpr float HEIGHT_TOLERANCE = 1e-3f;
+	constexpr float NORMAL_TOLERANCE = 1e-3f;
+
+	double nanoseconds(chrono::high_resolution_clock::time_point start) {
+		return chrono::duration<double, nano>(chrono::high_resolution_clock::now() - start).count();
+	}
+
+	double waveHeight(double x, double z) {
+		const double distance = (double)SPEED * TIME;
+		const double localX = (x - PLANE_OFFSET) / PLANE_SCALE, localZ = (z - PLANE_OFFSET) / PLANE_SCALE;
+		return LEVEL + AMPLITUDE * sin(FREQUENCY * localX + distance) + AMPLITUDE * cos(FREQUENCY * localZ + distance);
+	}
+
+	// SampleLevel, linear and wrapping, at uv = (x, z) / patchLength
+	void sampleOcean(const float* texels, int size, double patchLength, double x, double z, double out[4]) {
+		const double u = x / patchLength * size - 0.5, v = z / patchLength * size - 0.5;
+		const double column = floor(u), row = floor(v), s = u - column, t = v - row;
+		const int c0 = (int)column & (size - 1), c1 = (c0 + 1) & (size - 1);
+		const int r0 = (int)row & (size - 1), r1 = (r0 + 1) & (size - 1);
+		for (int k = 0; k < 4; k++) {
+			const double a = texels[((size_t)r0 * size + c0) * 4 + k], b = texels[((size_t)r0 * size + c1) * 4 + k];
+			const double c = texels[((size_t)r1 * size + c0) * 4 + k], d = texels[((size_t)r1 * size + c1) * 4 + k];
+			out[k] = (a + (b - a) * s) * (1.0 - t) + (c + (d - c) * s) * t;
+		}
+	}
+
+	struct Timing {
+		double single, batch;
+	};
+
+	// Nanoseconds per query
+	Timing time(const WaterSurface& water, const vector<float>& x, const vector<float>& z, vector<float>& heights) {
+		Timing timing;
+		auto start = chrono::high_resolution_clock::now();
+		for (size_t i = 0; i < x.size(); i++) heights[i] = water.getHeight(x[i], z[i]);
+		timing.single = nanoseconds(start) / x.size();
+		start = chrono::high_resolution_clock::now();
+		water.getHeights(x.data(), z.data(), heights.data(), (int)x.size());
+		timing.batch = nanoseconds(start) / x.size();
+		return timing;
+	}
+}
+
+int main() {
+	mt19937 rng(7);
+	uniform_real_distribution<float> across(0.0f, WORLD_SIZE);
+	vector<float> x(POINTS), z(POINTS), heights(POINTS), normalX(POINTS), normalY(POINTS), normalZ(POINTS);
+	for (int i = 0; i < POINTS; i++) {
+		x[i] = across(rng);
+		z[i] = across(rng);
+	}
+
+	WaterSurface water;
+	water.setPlane(PLANE_SCALE, PLANE_SCALE, PLANE_OFFSET, LEVEL, PLANE_OFFSET);
+	water.setWaves(TIME, AMPLITUDE, FREQUENCY, SPEED);
+
+	// Sine waves: one at a time on the scalar path, and batched on SSE2
+	double singleError = 0.0, batchError = 0.0, normalError = 0.0;
+	water.setSimd(false);
+	for (int i = 0; i < POINTS; i += 97) singleError = max(singleError, fabs(water.getHeight(x[i], z[i]) - waveHeight(x[i], z[i])));
+	water.setSimd(true);
+	water.getHeights(x.data(), z.data(), heights.data(), POINTS, normalX.data(), normalY.data(), normalZ.data());
+	for (int i = 0; i < POINTS; i++) {
+		batchError = max(batchError, fabs(heights[i] - waveHeight(x[i], z[i])));
+		const double step = 0.5;
+		const double slopeX = (waveHeight(x[i] + step, z[i]) - waveHeight(x[i] - step, z[i])) / (2.0 * step);
+		const double slopeZ = (waveHeight(x[i], z[i] + step) - waveHeight(x[i], z[i] - step)) / (2.0 * step);
+		const double length = sqrt(slopeX * slopeX + 1.0 + slopeZ * slopeZ);
+		normalError = max(normalError, fabs(normalX[i] + slopeX / length));
+		normalError = max(normalError, fabs(normalY[i] - 1.0 / length));
+		normalError = max(normalError, fabs(normalZ[i] + slopeZ / length));
+	}
+	printf("WaterSurface sine waves, amplitude %.1f: height error %.2e one at a time, %.2e batched; normal error %.2e\n",
+		AMPLITUDE, singleError, batchError, normalError);
+
+	// The ocean, from vertices carried sideways by the displacement texture
+	OceanSettings settings;
+	OceanFFT ocean;
+	ocean.setup(settings);
+	ocean.update(TIME);
+	water.setOcean(&ocean, settings.patchLength);
+	vector<float> landedX(POINTS), landedZ(POINTS);
+	vector<double> expected(POINTS);
+	vector<bool> folded(POINTS);
+	int foldedCount = 0;
+	for (int i = 0; i < POINTS; i++) {
+		double displacement[4], normal[4];
+		sampleOcean(ocean.getDisplacement(), ocean.getSize(), settings.patchLength, x[i], z[i], displacement);
+		sampleOcean(ocean.getNormals(), ocean.getSize(), settings.patchLength, x[i], z[i], normal);
+		landedX[i] = (float)(x[i] + displacement[0]);
+		landedZ[i] = (float)(z[i] + displacement[2]);
+		expected[i] = LEVEL + displacement[1];
+		folded[i] = normal[3] < 0.25;	// Near or past folding over, the steps back need not settle on this vertex
+		foldedCount += folded[i];
+	}
+	WaterSurface scalar = water;
+	scalar.setSimd(false);
+	vector<float> scalarHeights(POINTS);
+	scalar.getHeights(landedX.data(), landedZ.data(), scalarHeights.data(), POINTS);
+	water.getHeights(landedX.data(), landedZ.data(), heights.data(), POINTS);
+	double oceanError = 0.0, simdDifference = 0.0, largest = 0.0;
+	for (int i = 0; i < POINTS; i++) {
+		largest = max(largest, fabs(expected[i] - LEVEL));
+		simdDifference = max(simdDifference, (double)fabsf(heights[i] - scalarHeights[i]));
+		if (!folded[i]) oceanError = max(oceanError, fabs(heights[i] - expected[i]));
+	}
+	printf("  ocean %dx%d over %.0f units, largest height %.2f: height error %.2e (%d of %d near folds left out), SSE2 against scalar %.2e\n",
+		ocean.getSize(), ocean.getSize(), settings.patchLength, largest, oceanError, foldedCount, POINTS, simdDifference);
+
+	printf("  %-12s %12s %12s   (ns per query, %d queries)\n", "", "one at once", "batched", POINTS);
+	water.setOcean(nullptr, 0.0f);
+	scalar.setOcean(nullptr, 0.0f);
+	const Timing sineScalar = time(scalar, x, z, heights), sineSimd = time(water, x, z, heights);
+	water.setOcean(&ocean, settings.patchLength);
+	scalar.setOcean(&ocean, settings.patchLength);
+	const Timing oceanScalar = time(scalar, x, z, heights), oceanSimd = time(water, x, z, heights);
+	printf("  %-12s %12.1f %12.1f\n", "sine scalar", sineScalar.single, sineScalar.batch);
+	printf("  %-12s %12.1f %12.1f\n", "sine sse2", sineSimd.single, sineSimd.batch);
+	printf("  %-12s %12.1f %12.1f\n", "ocean scalar", oceanScalar.single, oceanScalar.batch);
+	printf("  %-12s %12.1f %12.1f\n", "ocean sse2", oceanSimd.single, oceanSimd.batch);
+
+	const bool ok = singleError <= HEIGHT_TOLERANCE && batchError <= HEIGHT_TOLERANCE && normalError <= NORMAL_TOLERANCE &&
+		oceanError <= HEIGHT_TOLERANCE * largest && simdDifference <= HEIGHT_TOLERANCE * largest && foldedCount < POINTS / 100;
+	return ok ? 0 : 1;
+}
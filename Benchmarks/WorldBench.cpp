@@ -0,0 +1,369 @@
+// WorldBench.cpp
+// The game's per-frame systems on stress worlds of 10 to 1,000,000 islands, laid out the way Islands lays them out:
+// one island to each REGION_SIZE square of a near-square grid, jittered and turned, with bridges forming a spanning
+// tree between neighbours and one to four pickups on each. Each system is timed on its own, repeated until a fixed
+// slice of time has passed, so a row's value stays comparable however fast or slow the system is at that size. The
+// rows are printed and, with --json <path>, written out for a dashboard; --max-islands caps the largest world.
+// The player moves through PlayerMotion, the game's own movement. Islands itself, and the Ghost wandering it, run up to
+// ISLANDS_LIMIT, since its spanning tree measures every pair. Once a run, the framework meshes and the game's OBJ
+// models are built on the CPU as the mesh classes build them before uploading. The player has to land, the ghost has to
+// spawn, and the geometry has to come out whole, or the run fails.
+
+#include "BenchReport.h"
+#include "Ghost.h"
+#include "GhostSwarm.h"
+#include "Islands.h"
+#include "JobSystem.h"
+#include "MeshGeometry.h"
+#include "NullAudioBackend.h"
+#include "PlayerCollision.h"
+#include "PlayerMotion.h"
+#include "SonarWave.h"
+#include "SweepAndPrune.h"
+#include "TerrainDisplacement.h"
+#include "TerrainLod.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+	constexpr float REGION = 150.0f;	// Islands.h REGION_SIZE
+	constexpr float ISLAND_HALF = 50.0f;	// Islands.h ISLAND_SIZE, the half size
+	constexpr float PICKUP_REACH = 0.8f * ISLAND_HALF;	// Islands.h PICKUP_OFFSET_RATIO
+	constexpr float BRIDGE_WIDTH = 5.0f;
+	constexpr float PLAYER_RADIUS = 1.8f;
+	constexpr float GROUND = 1.0f;	// Top of an undisplaced island
+	constexpr int TEXTURE_SIZE = 256;
+	constexpr int GHOST_LIMIT = 262144;
+	constexpr int ISLANDS_LIMIT = 1000;
+	constexpr int QUERY_BATCH = 256;
+	constexpr double SLICE_MS = 25.0;
+	const int SIZES[] = { 10, 100, 1000, 10000, 100000, 1000000 };
+	const int MESH_RESOLUTIONS[] = { 20, 100 };	// The meshes' default resolutions
+
+	// The models App1 loads, and the triangles each holds
+	struct ObjModel {
+		const char* file;
+		int triangles;
+	};
+	const ObjModel OBJ_MODELS[] = { { "Sphere.obj", 1104 }, { "teapot.obj", 992 }, { "drone.obj", 7148 } };
+
+	constexpr uint32_t LAYER_PLAYER = 1, LAYER_GHOST = 2, LAYER_PICKUP = 4;
+
+	struct StressWorld {
+		vector<float> x, z, rotation;	// Per island
+		vector<pair<int, int>> bridges;
+		vector<float> pickupX, pickupZ;
+		float size = 0.0f;	// Side of the square the islands fill
+	};
+
+	StressWorld makeWorld(int islands, uint32_t seed) {
+		mt19937 rng(seed);
+		uniform_real_distribution<float> jitter(-(REGION * 0.5f - ISLAND_HALF), REGION * 0.5f - ISLAND_HALF);
+		uniform_real_distribution<float> turn(0.0f, 6.2831853f), reach(-PICKUP_REACH, PICKUP_REACH);
+		uniform_int_distribution<int> pickups(1, 4);
+
+		StressWorld world;
+		const int columns = (int)ceil(sqrt((double)islands));
+		world.size = columns * REGION;
+		for (int i = 0; i < islands; i++) {
+			const int column = i % columns, row = i / columns;
+			world.x.push_back((column + 0.5f) * REGION + jitter(rng));
+			world.z.push_back((row + 0.5f) * REGION + jitter(rng));
+			world.rotation.push_back(turn(rng));
+
+			// A spanning tree of neighbours: along each row, and down the first column
+			if (column > 0) world.bridges.push_back({ i - 1, i });
+			else if (row > 0) world.bridges.push_back({ i - columns, i });
+
+			const float c = cosf(world.rotation[i]), s = sinf(world.rotation[i]);
+			for (int p = pickups(rng); p > 0; p--) {
+				const float localX = reach(rng), localZ = reach(rng);
+				world.pickupX.push_back(world.x[i] + localX * c + localZ * s);
+				world.pickupZ.push_back(world.z[i] - localX * s + localZ * c);
+			}
+		}
+		return world;
+	}
+
+	double milliseconds(chrono::high_resolution_clock::time_point start) {
+		return chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+	}
+
+	// Milliseconds per call, calling until a slice of time has passed
+	template<typename F>
+	double perCall(F&& call) {
+		int calls = 0;
+		const auto start = chrono::high_resolution_clock::now();
+		do {
+			call();
+			calls++;
+		} while (milliseconds(start) < SLICE_MS);
+		return milliseconds(start) / calls;
+	}
+
+	void benchTerrainLod(BenchReport& report, const StressWorld& world, int islands) {
+		vector<LodObject> objects;
+		for (int i = 0; i < islands; i++) objects.push_back({ world.x[i], GROUND, world.z[i], ISLAND_HALF * 1.42f, 0.4f });
+		for (const auto& bridge : world.bridges) {
+			const float ax = world.x[bridge.first], az = world.z[bridge.first], bx = world.x[bridge.second], bz = world.z[bridge.second];
+			objects.push_back({ (ax + bx) * 0.5f, GROUND, (az + bz) * 0.5f, hypotf(bx - ax, bz - az) * 0.5f, 0.2f });
+		}
+		TerrainLod lod;
+		lod.setObjects(objects);
+		lod.setProjection(720.0f, 0.785f);
+
+		// The camera flies a diagonal across the world, a frame's travel at a time
+		float t = 0.0f;
+		report.add("terrain_lod.update", islands, perCall([&] {
+			t = fmodf(t + 0.7f, world.size);
+			lod.update(t, 20.0f, t);
+		}), "ms");
+	}
+
+	void benchTerrainQueries(BenchReport& report, const StressWorld& world, int islands, mt19937& rng) {
+		vector<uint8_t> texels((size_t)TEXTURE_SIZE * TEXTURE_SIZE * 4);
+		for (uint8_t& texel : texels) texel = (uint8_t)(rng() & 0xff);
+		vector<DisplacedIsland> displaced;
+		for (int i = 0; i < islands; i++) displaced.push_back({ world.x[i], world.z[i], world.rotation[i], 0.0f });
+		TerrainDisplacement terrain;
+		terrain.setTexture(TEXTURE_SIZE, TEXTURE_SIZE, texels.data(), TEXTURE_SIZE * 4);
+		terrain.setIslands(displaced, ISLAND_HALF);
+
+		// Half the points on islands, half anywhere
+		uniform_real_distribution<float> across(0.0f, world.size), near(-ISLAND_HALF, ISLAND_HALF);
+		uniform_int_distribution<int> pick(0, islands - 1);
+		vector<float> x(QUERY_BATCH), z(QUERY_BATCH), heights(QUERY_BATCH);
+		for (int i = 0; i < QUERY_BATCH; i++) {
+			const int island = pick(rng);
+			x[i] = i & 1 ? across(rng) : world.x[island] + near(rng) * 0.7f;
+			z[i] = i & 1 ? across(rng) : world.z[island] + near(rng) * 0.7f;
+		}
+		report.add("terrain.heights_at", islands, perCall([&] {
+			terrain.heightsAt(x.data(), z.data(), QUERY_BATCH, heights.data(), -50.0f);
+		}) * 1e6 / QUERY_BATCH, "ns/query");
+	}
+
+	// False if the player didn't land
+	bool benchPlayer(BenchReport& report, const StressWorld& world, int islands, mt19937& rng) {
+		CollisionGeometry geometry;
+		for (int i = 0; i < islands; i++) {
+			CollisionSlab slab;
+			slab.centreX = world.x[i];
+			slab.centreZ = world.z[i];
+			slab.halfSize = ISLAND_HALF;
+			slab.rotationY = world.rotation[i];
+			slab.bottom = GROUND - 2.0f;
+			geometry.slabs.push_back(slab);
+		}
+		for (const auto& bridge : world.bridges) {
+			CollisionCapsule capsule;
+			capsule.radius = BRIDGE_WIDTH * 0.5f;
+			capsule.a = CollisionVector(world.x[bridge.first], GROUND, world.z[bridge.first]);
+			capsule.b = CollisionVector(world.x[bridge.second], GROUND, world.z[bridge.second]);
+			geometry.capsules.push_back(capsule);
+		}
+		geometry.heights.assign(1, GROUND);
+		PlayerCollision collision;
+		collision.setGeometry(geometry);
+
+		// Dropped onto a random island with no keys held, the player comes to rest on it
+		uniform_int_distribution<int> pick(0, islands - 1);
+		const int home = pick(rng);
+		const XMFLOAT3 start(world.x[home], GROUND + 5.0f, world.z[home]);
+		PlayerMotion motion;
+		motion.setCollision(&collision);
+		motion.eyeHeight = PLAYER_RADIUS;
+		motion.position = start;
+		PlayerInput keys;
+		bool landed = true;
+		for (int frame = 0; frame < 120; frame++) landed = !motion.step(1.0f / 60.0f, keys, 0.0f, false) && landed;
+		landed = landed && collision.isGrounded(motion.position, PLAYER_RADIUS);
+
+		// Then running and jumping about it, turning as it goes, a 60 Hz frame at a time
+		keys.forward = true;
+		float yaw = 0.0f;
+		int frame = 0;
+		report.add("player.move", islands, perCall([&] {
+			keys.jump = frame % 90 == 0;
+			yaw += 1.5f;
+			const bool splashed = motion.step(1.0f / 60.0f, keys, yaw, false);
+			if (splashed || ++frame % 120 == 0) {
+				motion.reset();
+				motion.position = start;
+			}
+		}) * 1e3, "us");
+		return landed;
+	}
+
+	void benchGhosts(BenchReport& report, const StressWorld& world, int islands, JobSystem& jobs) {
+		vector<GhostVector> centres;
+		for (int i = 0; i < islands; i++) centres.push_back(GhostVector(world.x[i], GROUND, world.z[i]));
+		const int ghosts = min(islands, GHOST_LIMIT);
+		GhostSwarm swarm;
+		swarm.resize(ghosts);
+		swarm.setIslands(centres);
+		swarm.update(1.0f / 60.0f, &jobs);	// Spawns them
+		report.add("ghosts.update", ghosts, perCall([&] { swarm.update(1.0f / 60.0f, &jobs); }), "ms");
+	}
+
+	void benchBroadphase(BenchReport& report, const StressWorld& world, int islands, mt19937& rng) {
+		SweepAndPrune broadphase;
+		for (size_t i = 0; i < world.pickupX.size(); i++) {
+			broadphase.add(BroadphaseBox(world.pickupX[i], GROUND + 1.0f, world.pickupZ[i], 2.0f), LAYER_PICKUP, 0, (int)i);
+		}
+		const int ghosts = min(islands, GHOST_LIMIT);
+		uniform_real_distribution<float> across(0.0f, world.size), wander(-0.2f, 0.2f);
+		vector<int> handles;
+		vector<float> ghostX, ghostZ;
+		for (int i = 0; i < ghosts; i++) {
+			ghostX.push_back(across(rng));
+			ghostZ.push_back(across(rng));
+			handles.push_back(broadphase.add(BroadphaseBox(ghostX[i], GROUND + 3.0f, ghostZ[i], 1.0f), LAYER_GHOST, 0));
+		}
+		const int player = broadphase.add(BroadphaseBox(world.x[0], GROUND + 2.0f, world.z[0], 3.0f), LAYER_PLAYER, LAYER_GHOST | LAYER_PICKUP);
+		broadphase.update();
+
+		// Every ghost drifts a little each frame, as the swarm's do
+		float playerX = world.x[0];
+		report.add("broadphase.update", ghosts + (long long)world.pickupX.size(), perCall([&] {
+			for (int i = 0; i < ghosts; i++) {
+				ghostX[i] += wander(rng);
+				ghostZ[i] += wander(rng);
+				broadphase.move(handles[i], BroadphaseBox(ghostX[i], GROUND + 3.0f, ghostZ[i], 1.0f));
+			}
+			playerX += 0.5f;
+			broadphase.move(player, BroadphaseBox(playerX, GROUND + 2.0f, world.z[0], 3.0f));
+			broadphase.update();
+		}), "ms");
+	}
+
+	void benchSonar(BenchReport& report, const StressWorld& world, int islands) {
+		vector<SonarPoint> points;
+		for (size_t i = 0; i < world.pickupX.size(); i++) points.push_back({ world.pickupX[i], world.pickupZ[i], (int)i });
+		SonarWave wave;
+		wave.setTargets(SonarTarget::Pickup, points);
+		vector<SonarHit> hits;
+
+		// One whole ping, five seconds at 60 Hz, out to 500 units from the first island
+		constexpr float RADIUS = 500.0f, DURATION = 5.0f;
+		report.add("sonar.ping", islands, perCall([&] {
+			wave.ping(world.x[0], world.z[0], RADIUS / DURATION, RADIUS);
+			for (int frame = 0; frame < 300 && wave.isRunning(); frame++) wave.update(1.0f / 60.0f, hits);
+		}), "ms");
+	}
+
+	// Islands generated as App1 generates them, and the Ghost wandering them, audio through the null backend.
+	// False if the ghost didn't spawn.
+	bool benchIslands(BenchReport& report, int islands) {
+		report.add("islands.generate", islands, perCall([&] {
+			Islands generated(0, islands);
+			generated.GenerateIslands();
+		}), "ms");
+
+		Islands generated(0, islands);
+		generated.GenerateIslands();
+		NullAudioBackend* backend = new NullAudioBackend();
+		backend->setRecording(false);
+		AudioSystem audio;
+		audio.init(backend, false);
+		SceneData sceneData;
+		Ghost ghost;
+		ghost.Initialize(&audio, &sceneData);
+		ghost.SetIslandBounds(&generated);
+		const XMFLOAT3 player = generated.GetRandomIslandPosition();
+		ghost.Update(1.0f / 60.0f, player);	// Spawns it
+		const bool spawned = ghost.IsActive();
+		report.add("ghost.update", islands, perCall([&] { ghost.Update(1.0f / 60.0f, player); }) * 1e3, "us");
+		return spawned;
+	}
+
+	// The sphere's corners all on the unit sphere, the cube's on the unit cube, and every index its own vertex
+	bool checkMesh(const vector<MeshVertex>& vertices, const vector<unsigned long>& indices, bool sphere) {
+		for (size_t i = 0; i < vertices.size(); i++) {
+			const XMFLOAT3& p = vertices[i].position;
+			const float extent = sphere ? sqrtf(p.x * p.x + p.y * p.y + p.z * p.z) : max(fabsf(p.x), max(fabsf(p.y), fabsf(p.z)));
+			if (indices[i] != i || fabsf(extent - 1.0f) > 1e-3f) return false;
+		}
+		return true;
+	}
+
+	// The framework meshes' geometry and the game's OBJ models, built on the CPU as the mesh classes build them before
+	// uploading. False if a mesh comes out misshapen or a model doesn't read whole.
+	bool benchGeometry(BenchReport& report) {
+		bool whole = true;
+		for (int resolution : MESH_RESOLUTIONS) {
+			const int count = MeshGeometry::cubeVertexCount(resolution);
+			vector<MeshVertex> vertices(count);
+			vector<unsigned long> indices(count);
+			report.add("mesh.cube", count, perCall([&] { MeshGeometry::buildCube(resolution, vertices.data(), indices.data()); }), "ms");
+			whole = whole && checkMesh(vertices, indices, false);
+			report.add("mesh.sphere", count, perCall([&] { MeshGeometry::buildSphere(resolution, vertices.data(), indices.data()); }), "ms");
+			whole = whole && checkMesh(vertices, indices, true);
+
+			const int planeCount = MeshGeometry::planeVertexCount(resolution);
+			vertices.resize(planeCount);
+			indices.resize(planeCount);
+			report.add("mesh.plane", planeCount, perCall([&] { MeshGeometry::buildPlane(resolution, vertices.data(), indices.data()); }), "ms");
+			for (int i = 0; i < planeCount; i++) whole = whole && indices[i] == (unsigned long)i && vertices[i].position.y == 0.0f;
+		}
+
+		for (const ObjModel& model : OBJ_MODELS) {
+			const string path = string(WORLD_BENCH_RES) + "/" + model.file;
+			vector<ObjVertex> corners;
+			bool read = false;
+			report.add("obj.load", model.triangles, perCall([&] { read = MeshGeometry::loadObj(path.c_str(), corners); }), "ms");
+			if (!read || (int)corners.size() != model.triangles * 3) {
+				printf("  %s: FAILED, %zu corners read\n", model.file, corners.size());
+				whole = false;
+			}
+		}
+		return whole;
+	}
+}
+
+int main(int argc, char** argv) {
+	BenchReport report("WorldBench", argc, argv);
+	int maxIslands = SIZES[size(SIZES) - 1];
+	for (int i = 1; i + 1 < argc; i++) {
+		if (strcmp(argv[i], "--max-islands") == 0) maxIslands = atoi(argv[i + 1]);
+	}
+
+	JobSystem jobs;
+	report.setInfo("threads", to_string(jobs.getThreadCount()));
+	report.setInfo("simd", GhostSwarm::hasSimd() ? "sse2" : "scalar");
+	printf("WorldBench: stress worlds up to %d islands, %d threads\n", maxIslands, jobs.getThreadCount());
+	printf("  %-32s %9s %14s\n", "", "size", "value");
+
+	mt19937 rng(11);
+	bool checked = true;
+	for (int islands : SIZES) {
+		if (islands > maxIslands) break;
+		StressWorld world;
+		const auto start = chrono::high_resolution_clock::now();
+		world = makeWorld(islands, 1234u + islands);
+		report.add("world.generate", islands, milliseconds(start), "ms");
+
+		benchTerrainLod(report, world, islands);
+		benchTerrainQueries(report, world, islands, rng);
+		if (!benchPlayer(report, world, islands, rng)) {
+			printf("  player: FAILED, didn't land on a %d island world\n", islands);
+			checked = false;
+		}
+		benchGhosts(report, world, islands, jobs);
+		benchBroadphase(report, world, islands, rng);
+		benchSonar(report, world, islands);
+		if (islands <= ISLANDS_LIMIT && !benchIslands(report, islands)) {
+			printf("  ghost: FAILED, didn't spawn on %d islands\n", islands);
+			checked = false;
+		}
+	}
+	if (!benchGeometry(report)) checked = false;
+	return report.write() && checked ? 0 : 1;
+}
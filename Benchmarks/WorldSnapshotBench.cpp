@@ -0,0 +1,256 @@
+// WorldSnapshotBench.cpp
+// WorldSnapshot on a million-island world laid out the way Islands lays it out: one island to each region of a grid,
+// one to four pickups on each, and a bridge from every island to a neighbour. First the round trip: a whole save, then
+// a view that maps it and reads back every record exactly. Then incremental saves: saving the same world again writes
+// only the header, collecting one pickup writes a block or two and keeps every slot where it was, and a pickup that no
+// longer fits its slot rewrites the file whole, which a fresh writer must reproduce byte for byte. Then damaged files,
+// which have to be refused: cut short, another magic, another version, a section pointing past the end. Last, what it
+// all costs: the whole save, opening the view, reading every record, and an incremental save. Islands itself goes
+// through a save and a load too, its XMFLOAT3 positions passing straight in and out.
+
+#include "WorldSnapshot.h"
+#include "Islands.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <vector>
+
+namespace {
+
+	constexpr int ISLANDS = 1000000;
+	constexpr float REGION = 150.0f;	// Islands.h REGION_SIZE
+	constexpr float PICKUP_REACH = 40.0f;	// ISLAND_SIZE * PICKUP_OFFSET_RATIO
+	const char* PATH = "WorldSnapshotBench.snapshot";
+	const char* COPY_PATH = "WorldSnapshotBench.copy.snapshot";
+
+	double milliseconds(chrono::high_resolution_clock::time_point start) {
+		return chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+	}
+
+	struct World {
+		vector<SnapshotVector> positions;
+		vector<float> rotations;
+		vector<vector<SnapshotVector>> pickups;
+		vector<SnapshotBridge> bridges;
+	};
+
+	World makeWorld(int count) {
+		World world;
+		mt19937 rng(7);
+		uniform_real_distribution<float> jitter(-REGION * 0.25f, REGION * 0.25f);
+		uniform_real_distribution<float> turn(0.0f, 6.2831853f);
+		uniform_real_distribution<float> reach(-PICKUP_REACH, PICKUP_REACH);
+		uniform_int_distribution<int> pickupCount(1, 4);
+		const int columns = (int)ceil(sqrt((double)count));
+		for (int i = 0; i < count; i++) {
+			const float x = (i % columns) * REGION + jitter(rng), z = (i / columns) * REGION + jitter(rng);
+			world.positions.push_back(SnapshotVector(x, 0.0f, z));
+			world.rotations.push_back(turn(rng));
+			vector<SnapshotVector> pickups(pickupCount(rng));
+			for (SnapshotVector& pickup : pickups) pickup = SnapshotVector(x + reach(rng), 1.0f, z + reach(rng));
+			world.pickups.push_back(pickups);
+			if (i > 0) {
+				SnapshotBridge bridge;
+				bridge.islandA = (uint32_t)(i % columns ? i - 1 : i - columns);
+				bridge.islandB = (uint32_t)i;
+				world.bridges.push_back(bridge);
+			}
+		}
+		return world;
+	}
+
+	SnapshotScene makeScene(int count) {
+		SnapshotScene scene;
+		scene.gridSize = 700;
+		scene.islandCount = count;
+		scene.ghostCount = 16;
+		scene.islandSize = 50.0f;
+		scene.waterLevel = -50.0f;
+		scene.waterFlags = SnapshotScene::WATER_FFT;
+		scene.moonPosition[0] = 58.611f;
+		scene.moonPosition[1] = 66.0f;
+		scene.moonPosition[2] = 134.0f;
+		return scene;
+	}
+
+	void fill(WorldSnapshotWriter& writer, const World& world, const SnapshotScene& scene) {
+		writer.clear();
+		writer.reserve(world.positions.size(), world.positions.size() * 3, world.bridges.size());
+		writer.setScene(scene);
+		for (size_t i = 0; i < world.positions.size(); i++) {
+			writer.addIsland(world.positions[i], world.rotations[i], SnapshotIsland::INITIALIZED, world.pickups[i].data(),
+				(uint32_t)world.pickups[i].size());
+		}
+		for (const SnapshotBridge& bridge : world.bridges) writer.addBridge(bridge.islandA, bridge.islandB);
+	}
+
+	bool same(const SnapshotVector& a, const SnapshotVector& b) {
+		return a.x == b.x && a.y == b.y && a.z == b.z;
+	}
+
+	// Every record of the view against the world it was saved from
+	bool matches(const WorldSnapshotView& view, const World& world, const SnapshotScene& scene) {
+		if (view.getIslandCount() != world.positions.size() || view.getBridgeCount() != world.bridges.size()) return false;
+		if (memcmp(&view.getScene(), &scene, sizeof(scene)) != 0) return false;
+		const SnapshotIsland* islands = view.getIslands();
+		for (size_t i = 0; i < world.positions.size(); i++) {
+			const SnapshotIsland& island = islands[i];
+			if (!same(island.position, world.positions[i]) || island.rotationY != world.rotations[i]) return false;
+			if (island.pickupCount != world.pickups[i].size()) return false;
+			const SnapshotVector* pickups = view.getPickups(island);
+			if (!pickups) return false;
+			for (uint32_t p = 0; p < island.pickupCount; p++) if (!same(pickups[p], world.pickups[i][p])) return false;
+		}
+		const SnapshotBridge* bridges = view.getBridges();
+		for (size_t i = 0; i < world.bridges.size(); i++) {
+			if (bridges[i].islandA != world.bridges[i].islandA || bridges[i].islandB != world.bridges[i].islandB) return false;
+		}
+		return true;
+	}
+
+	vector<char> readAll(const char* path) {
+		ifstream file(path, ios::binary);
+		return vector<char>(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+	}
+
+	void writeAll(const char* path, const vector<char>& bytes) {
+		ofstream file(path, ios::binary | ios::trunc);
+		file.write(bytes.data(), (streamsize)bytes.size());
+	}
+
+	// The file with a change made to it must be refused
+	bool refused(const vector<char>& original, void (*damage)(vector<char>&)) {
+		vector<char> bytes = original;
+		damage(bytes);
+		writeAll(COPY_PATH, bytes);
+		WorldSnapshotView view;
+		const bool opened = view.open(COPY_PATH);
+		view.close();
+		remove(COPY_PATH);
+		return !opened;
+	}
+
+	// Generated islands with a pickup collected, saved as App1::saveWorld does and loaded into another Islands
+	bool islandsRoundTrip() {
+		Islands generated(0, 500);
+		generated.GenerateIslands();
+		const XMFLOAT3 collected = generated.GetIslands()[7].pickupPositions.front();
+		generated.RemovePickup(7, collected);
+
+		WorldSnapshotWriter writer;
+		writer.setScene(makeScene(500));
+		generated.SaveSnapshot(writer);
+		WorldSnapshotView view;
+		Islands loaded(0, 1);
+		bool ok = writer.save(PATH) && view.open(PATH) && loaded.LoadSnapshot(view);
+		view.close();
+		remove(PATH);
+
+		const IslandList& a = generated.GetIslands();
+		const IslandList& b = loaded.GetIslands();
+		ok = ok && a.size() == b.size() && generated.GetBridges().size() == loaded.GetBridges().size();
+		for (size_t i = 0; ok && i < a.size(); i++) {
+			ok = same(a[i].position, b[i].position) && a[i].rotationY == b[i].rotationY &&
+				a[i].initialized == b[i].initialized && a[i].hasAmbience == b[i].hasAmbience &&
+				a[i].pickupPositions.size() == b[i].pickupPositions.size();
+			for (size_t p = 0; ok && p < a[i].pickupPositions.size(); p++) ok = same(a[i].pickupPositions[p], b[i].pickupPositions[p]);
+		}
+		for (size_t i = 0; ok && i < generated.GetBridges().size(); i++) {
+			ok = generated.GetBridges()[i].islandA == loaded.GetBridges()[i].islandA &&
+				generated.GetBridges()[i].islandB == loaded.GetBridges()[i].islandB;
+		}
+		return ok && !loaded.RemovePickup(7, collected);
+	}
+
+	SnapshotHeader& headerOf(vector<char>& bytes) {
+		return *reinterpret_cast<SnapshotHeader*>(bytes.data());
+	}
+}
+
+int main() {
+	World world = makeWorld(ISLANDS);
+	const SnapshotScene scene = makeScene(ISLANDS);
+	WorldSnapshotWriter writer;
+
+	// Whole save, and back through a mapped view
+	auto start = chrono::high_resolution_clock::now();
+	fill(writer, world, scene);
+	const double fillTime = milliseconds(start);
+	start = chrono::high_resolution_clock::now();
+	bool saved = writer.save(PATH);
+	const double saveTime = milliseconds(start);
+	const WorldSnapshotWriter::SaveStats whole = writer.getLastSave();
+	saved = saved && !whole.incremental;
+
+	WorldSnapshotView view;
+	start = chrono::high_resolution_clock::now();
+	bool roundTrip = view.open(PATH);
+	const double openTime = milliseconds(start);
+	start = chrono::high_resolution_clock::now();
+	roundTrip = roundTrip && matches(view, world, scene);
+	const double readTime = milliseconds(start);
+	view.close();
+
+	// Saved again unchanged: only the header goes down
+	fill(writer, world, scene);
+	bool unchanged = writer.save(PATH) && writer.getLastSave().incremental && writer.getLastSave().blocksWritten == 0 &&
+		writer.getLastSave().bytesWritten == sizeof(SnapshotHeader) && writer.getLastSave().generation == 1;
+
+	// One pickup collected from an island in the middle
+	const int collectedIsland = ISLANDS / 2;
+	world.pickups[collectedIsland].erase(world.pickups[collectedIsland].begin());
+	fill(writer, world, scene);
+	start = chrono::high_resolution_clock::now();
+	bool collected = writer.save(PATH);
+	const double incrementalTime = milliseconds(start);
+	const WorldSnapshotWriter::SaveStats incremental = writer.getLastSave();
+	collected = collected && incremental.incremental && incremental.blocksWritten >= 1 && incremental.blocksWritten <= 4 &&
+		incremental.generation == 2 && view.open(PATH) && matches(view, world, scene);
+	if (view.isOpen()) {
+		const SnapshotIsland& island = view.getIslands()[collectedIsland];
+		collected = collected && island.pickupCapacity == island.pickupCount + 1 && view.getHeader().generation == 2;
+	}
+	view.close();
+
+	// A pickup more than the island started with can't keep its slot, so the whole file goes down again
+	world.pickups[collectedIsland].push_back(SnapshotVector(1.0f, 2.0f, 3.0f));
+	world.pickups[collectedIsland].push_back(SnapshotVector(4.0f, 5.0f, 6.0f));
+	fill(writer, world, scene);
+	bool outgrown = writer.save(PATH) && !writer.getLastSave().incremental && writer.getLastSave().generation == 0 &&
+		view.open(PATH) && matches(view, world, scene);
+	view.close();
+	WorldSnapshotWriter fresh;
+	fill(fresh, world, scene);
+	outgrown = outgrown && fresh.save(COPY_PATH) && readAll(PATH) == readAll(COPY_PATH);
+	remove(COPY_PATH);
+
+	// Damaged files
+	const vector<char> original = readAll(PATH);
+	bool damaged = refused(original, [](vector<char>& bytes) { bytes.resize(bytes.size() - 1); });
+	damaged = damaged && refused(original, [](vector<char>& bytes) { bytes.resize(sizeof(SnapshotHeader) - 1); });
+	damaged = damaged && refused(original, [](vector<char>& bytes) { headerOf(bytes).magic ^= 1; });
+	damaged = damaged && refused(original, [](vector<char>& bytes) { headerOf(bytes).version++; });
+	damaged = damaged && refused(original, [](vector<char>& bytes) {
+		headerOf(bytes).sections[(int)SnapshotSection::Bridges].count += 1;
+	});
+	damaged = damaged && refused(original, [](vector<char>& bytes) {
+		headerOf(bytes).sections[(int)SnapshotSection::Pickups].offset = headerOf(bytes).fileBytes + WorldSnapshot::SECTION_ALIGNMENT;
+	});
+	remove(PATH);
+
+	const bool islands = islandsRoundTrip();
+
+	printf("WorldSnapshot, %d islands: round trip %s, unchanged save %s, collected pickup %s, outgrown slot %s, damaged files %s\n",
+		ISLANDS, roundTrip ? "ok" : "FAILED", unchanged ? "ok" : "FAILED", collected ? "ok" : "FAILED",
+		outgrown ? "ok" : "FAILED", saved && damaged ? "ok" : "FAILED");
+	printf("  whole save: %.2f ms (%.2f ms filling the writer), %.1f MB\n", saveTime, fillTime, whole.fileBytes / (1024.0 * 1024.0));
+	printf("  open: %.3f ms; reading every record: %.2f ms\n", openTime, readTime);
+	printf("  incremental save: %.2f ms, %zu of %zu blocks, %zu bytes written\n", incrementalTime, incremental.blocksWritten,
+		incremental.blocksCompared, incremental.bytesWritten);
+	printf("  Islands, 500 generated: save and load %s\n", islands ? "ok" : "FAILED");
+	return saved && roundTrip && unchanged && collected && outgrown && damaged && islands ? 0 : 1;
+}
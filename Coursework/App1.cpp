@@ -1,13 +1,111 @@
 ﻿#include "App1.h"
 #include <DirectXMath.h>
 #include <windows.h>
+#include <cstdio>
+#include <cstring>
 #include <string>
 using namespace DirectX;
 
 AppMode currentMode = AppMode::FlyCam;
 
-float App1::randomFloat(float min, float max) {
-	return min + static_cast<float>(rand()) / (static_cast<float>(RAND_MAX / (max - min)));
+namespace {
+
+	// renderWater's planes: the sine waves stretch one over everything, and the FFT ocean needs a vertex every few
+	// units to show its waves, so it gets a denser grid over the islands' region
+	constexpr float WATER_SCALE = 700.0f;
+	constexpr float WATER_OFFSET = 1.0f;
+	constexpr int OCEAN_RESOLUTION = 256;
+	constexpr float OCEAN_SPACING = 3.0f;
+	constexpr float OCEAN_OFFSET = -32.0f;
+	constexpr float PICKUP_DRAFT = 0.5f;	// How deep a floating pickup sits
+	const char* WORLD_SNAPSHOT_PATH = "world.snapshot";
+
+	// The settings a saved world keeps, beside its islands
+	SnapshotScene toSnapshot(const SceneData& scene) {
+		SnapshotScene snapshot;
+		snapshot.gridSize = scene.gridSize;
+		snapshot.islandCount = scene.islandCount;
+		snapshot.ghostCount = scene.ghostCount;
+		snapshot.islandSize = scene.islandSize;
+		snapshot.minIslandDistance = scene.minIslandDistance;
+
+		const WaterData& water = scene.waterData;
+		snapshot.waterLevel = water.level;
+		snapshot.amplitude = water.amplitude;
+		snapshot.frequency = water.frequency;
+		snapshot.speed = water.speed;
+		snapshot.oceanPatchLength = water.oceanPatchLength;
+		snapshot.oceanWindSpeed = water.oceanWindSpeed;
+		snapshot.oceanChoppiness = water.oceanChoppiness;
+		snapshot.oceanSize = water.oceanSize;
+		snapshot.waterFlags = (water.visible ? SnapshotScene::WATER_VISIBLE : 0) | (water.fftOcean ? SnapshotScene::WATER_FFT : 0);
+
+		const LightData& light = scene.lightData;
+		memcpy(snapshot.ambientColour, light.ambientColour, sizeof(snapshot.ambientColour));
+		memcpy(snapshot.diffuseColour, light.diffuseColour, sizeof(snapshot.diffuseColour));
+		memcpy(snapshot.specularColour, light.specularColour, sizeof(snapshot.specularColour));
+		snapshot.specularPower = light.spec_pow;
+		memcpy(snapshot.pointLight2Position, light.pointLight_pos2, sizeof(snapshot.pointLight2Position));
+		memcpy(snapshot.pointLight1Colour, light.pointLight1Colour, sizeof(snapshot.pointLight1Colour));
+		memcpy(snapshot.pointLight2Colour, light.pointLight2Colour, sizeof(snapshot.pointLight2Colour));
+		memcpy(snapshot.pointLightRadius, light.pointLightRadius, sizeof(snapshot.pointLightRadius));
+
+		const ShadowLightsData& shadowLights = scene.shadowLightsData;
+		memcpy(snapshot.lightDirections, shadowLights.lightDirections, sizeof(snapshot.lightDirections));
+		memcpy(snapshot.directionalPosition, shadowLights.dir_pos, sizeof(snapshot.directionalPosition));
+		memcpy(snapshot.spotColour, shadowLights.spotColour, sizeof(snapshot.spotColour));
+		snapshot.spotCutoff = shadowLights.spotCutoff;
+		snapshot.spotFalloff = shadowLights.spotFalloff;
+		memcpy(snapshot.moonPosition, scene.moonData.moon_pos, sizeof(snapshot.moonPosition));
+
+		snapshot.blurAmount = scene.bloomData.blurAmount;
+		snapshot.blurIntensity = scene.bloomData.blurIntensity;
+		return snapshot;
+	}
+
+	void fromSnapshot(const SnapshotScene& snapshot, SceneData& scene) {
+		scene.gridSize = snapshot.gridSize;
+		scene.islandCount = snapshot.islandCount;
+		scene.ghostCount = snapshot.ghostCount;
+		scene.islandSize = snapshot.islandSize;
+		scene.minIslandDistance = snapshot.minIslandDistance;
+
+		WaterData& water = scene.waterData;
+		water.level = snapshot.waterLevel;
+		water.amplitude = snapshot.amplitude;
+		water.frequency = snapshot.frequency;
+		water.speed = snapshot.speed;
+		water.oceanPatchLength = snapshot.oceanPatchLength;
+		water.oceanWindSpeed = snapshot.oceanWindSpeed;
+		water.oceanChoppiness = snapshot.oceanChoppiness;
+		water.oceanSize = snapshot.oceanSize;
+		water.visible = (snapshot.waterFlags & SnapshotScene::WATER_VISIBLE) != 0;
+		water.fftOcean = (snapshot.waterFlags & SnapshotScene::WATER_FFT) != 0;
+
+		LightData& light = scene.lightData;
+		memcpy(light.ambientColour, snapshot.ambientColour, sizeof(snapshot.ambientColour));
+		memcpy(light.diffuseColour, snapshot.diffuseColour, sizeof(snapshot.diffuseColour));
+		memcpy(light.specularColour, snapshot.specularColour, sizeof(snapshot.specularColour));
+		light.spec_pow = snapshot.specularPower;
+		memcpy(light.pointLight_pos2, snapshot.pointLight2Position, sizeof(snapshot.pointLight2Position));
+		memcpy(light.pointLight1Colour, snapshot.pointLight1Colour, sizeof(snapshot.pointLight1Colour));
+		memcpy(light.pointLight2Colour, snapshot.pointLight2Colour, sizeof(snapshot.pointLight2Colour));
+		memcpy(light.pointLightRadius, snapshot.pointLightRadius, sizeof(snapshot.pointLightRadius));
+		light.version++;
+
+		ShadowLightsData& shadowLights = scene.shadowLightsData;
+		memcpy(shadowLights.lightDirections, snapshot.lightDirections, sizeof(snapshot.lightDirections));
+		memcpy(shadowLights.dir_pos, snapshot.directionalPosition, sizeof(snapshot.directionalPosition));
+		memcpy(shadowLights.spotColour, snapshot.spotColour, sizeof(snapshot.spotColour));
+		shadowLights.spotCutoff = snapshot.spotCutoff;
+		shadowLights.spotFalloff = snapshot.spotFalloff;
+		shadowLights.version++;
+		memcpy(scene.moonData.moon_pos, snapshot.moonPosition, sizeof(snapshot.moonPosition));
+		scene.moonData.version++;
+
+		scene.bloomData.blurAmount = snapshot.blurAmount;
+		scene.bloomData.blurIntensity = snapshot.blurIntensity;
+	}
 }
 
 App1::App1() {
@@ -45,6 +143,8 @@ void App1::init(HINSTANCE hinstance, HWND hwnd, int screenWidth, int screenHeigh
 	SCREEN_WIDTH = screenWidth;
 	SCREEN_HEIGHT = screenHeight;
 
+	// Decode textures in the background; the scene starts on the default texture and sharpens as mips arrive
+	textureMgr->setStreaming(true);
 	initComponents();
 }
 
@@ -95,6 +195,15 @@ void App1::renderToTexture() {
 
 	sceneData->waterData.timeVal += timer->getTime();
 
+	// The ocean's transforms run on the job system while the shadow maps and terrain are drawn; renderWater waits
+	if (sceneData->waterData.visible && sceneData->waterData.fftOcean) {
+		finishOcean();
+		const float oceanTime = sceneData->waterData.timeVal;
+		oceanJob = jobs.create([this, oceanTime] { ocean.update(oceanTime, &jobs); });
+		jobs.run(oceanJob);
+	}
+	updateWaterSurface();
+
 	camera->update();
 
 	XMMATRIX worldMatrix = renderer->getWorldMatrix();
@@ -105,6 +214,7 @@ void App1::renderToTexture() {
 	renderAudio();
 	getShadowDepthMap(worldMatrix, viewMatrix, projectionMatrix, identity);
 	finalRender(worldMatrix, viewMatrix, projectionMatrix, identity);
+	audioSystem.flush(); // Push this frame's audio changes in one batch
 
 	// Reset to back buffer
 	renderer->setBackBufferRenderTarget();
@@ -163,10 +273,10 @@ void App1::renderPlayer() {
 			return;
 		}
 
-		player->updatePlayer(dt, input, terrainShader, camera, &audioSystem, islandBounds.get());
+		player->updatePlayer(dt, input, terrainShader, camera, &audioSystem);
 		player->handleMouseLook(input, dt, hwnd, sceneWidth, sceneHeight);
-		player->handlePlayModeReset(islandBounds.get(), terrainShader, camera);
-		player->handleSonar(input, &audioSystem);
+		if (player->handlePlayModeReset(islandBounds.get(), terrainShader, camera)) audioSystem.playOneShot("event:/Splash");
+		if (player->handleSonar(input, &audioSystem)) startSonarWave();
 		audioSystem.playGhostWhisper(sceneData->ghostData.position);
 		audioSystem.playBGM1();
 	}
@@ -193,169 +303,215 @@ void App1::renderPlayer() {
 void App1::renderGhost(const XMMATRIX& worldMatrix, const XMMATRIX& viewMatrix, const XMMATRIX& projectionMatrix) {
 	float deltaTime = timer->getTime();
 
-	if (!sceneData->ghostData.respondingToSonar) sceneData->ghostData.aliveTime -= deltaTime;
-
-	if (!sceneData->ghostData.isActive || sceneData->ghostData.maxLifetime <= 0.f) handleGhostRespawn();
-	else {
-		if (sceneData->ghostData.respondingToSonar) updateSonarResponse(deltaTime);
-		else handleNormalWandering(deltaTime);
-
-		updateGhostPosition(deltaTime);
-		updateChromaticAberration();
+	if (ghostSwarm.size() != sceneData->ghostCount) ghostSwarm.resize(sceneData->ghostCount);
+	flowFields.update(&jobs);
+	updateSonarWave(deltaTime);
+	ghostSwarm.update(deltaTime, &jobs);
+	updateBroadphase();
+
+	// The ghost nearest the camera is the one the whisper and chromatic aberration follow
+	const int lead = ghostSwarm.closest(camera->getPosition());
+	GhostData& ghostData = sceneData->ghostData;
+	ghostData.isActive = lead >= 0;
+	if (lead >= 0) {
+		ghostData.position = ghostSwarm.getPosition(lead);
+		ghostData.velocity = ghostSwarm.getVelocity(lead);
+		ghostData.currentIslandIndex = ghostSwarm.getIslandIndex(lead);
+		ghostData.aliveTime = ghostSwarm.getAliveTime(lead);
+		ghostData.respondingToSonar = ghostSwarm.isRespondingToSonar(lead);
+		ghostData.sonarResponseTimer = ghostSwarm.getSonarTimer(lead);
+		ghostData.directionChangeTimer = ghostSwarm.getDirectionTimer(lead);
+		ghostData.nextDirectionChangeTime = ghostSwarm.getNextDirectionTime(lead);
 	}
 
-	if (sceneData->ghostData.isActive) {
+	if (ghostData.isActive) {
 		renderGhostModel(worldMatrix, viewMatrix, projectionMatrix, deltaTime);
 		updateGhostAudio(deltaTime);
 	}
 
-	if (!sceneData->ghostData.isActive && audioSystem.isWhisperPlaying()) audioSystem.stopGhostWhisper();
+	if (!ghostData.isActive && audioSystem.isWhisperPlaying()) audioSystem.stopGhostWhisper();
 }
 
-void App1::handleGhostRespawn() {
-	if (audioSystem.isWhisperPlaying()) {
-		audioSystem.stopGhostWhisper();
-	}
-
-	if (!sceneData->ghostData.respondingToSonar) {
-		const auto& islands = islandBounds->GetIslands();
-		if (!islands.empty()) {
-			sceneData->ghostData.currentIslandIndex = rand() % islands.size();
-			const auto& island = islands[sceneData->ghostData.currentIslandIndex];
+void App1::updateGhostIslands() {
+	constexpr float CELL_SIZE = 2.0f;	// Under half a bridge width, so every bridge has a lane of cells
 
-			sceneData->ghostData.position = XMFLOAT3{ island.position.x + (rand() % 10 - 5),island.position.y + 3.f,island.position.z + (rand() % 10 - 5) };
-			sceneData->ghostData.velocity = XMFLOAT3{ randomFloat(-1.f, 1.f) * 2.f,0.f,randomFloat(-1.f, 1.f) * 2.f };
-			sceneData->ghostData.aliveTime = sceneData->ghostData.maxLifetime;
-			sceneData->ghostData.isActive = true;
-
-			sceneData->ghostData.directionChangeTimer = 0.0f;
-			sceneData->ghostData.nextDirectionChangeTime = randomFloat(1.0f, 2.0f);
+	vector<XMFLOAT3> centres;
+	float minX = FLT_MAX, maxX = -FLT_MAX, minZ = FLT_MAX, maxZ = -FLT_MAX;
+	for (const auto& island : islandBounds->GetIslands()) {
+		centres.push_back(island.position);
+
+		// Rotated islands reach out to the corners of their square
+		const float reach = ISLAND_SIZE * 1.4143f;
+		minX = min(minX, island.position.x - reach);
+		maxX = max(maxX, island.position.x + reach);
+		minZ = min(minZ, island.position.z - reach);
+		maxZ = max(maxZ, island.position.z + reach);
+	}
+	ghostSwarm.setIslands(centres);
+
+	FlowFieldGrid grid;
+	if (!centres.empty()) {
+		grid.originX = minX;
+		grid.originZ = minZ;
+		grid.cellSize = CELL_SIZE;
+		grid.width = (int)ceilf((maxX - minX) / CELL_SIZE);
+		grid.depth = (int)ceilf((maxZ - minZ) / CELL_SIZE);
+		grid.walkable.resize((size_t)grid.width * grid.depth);
+
+		for (int z = 0; z < grid.depth; z++) {
+			for (int x = 0; x < grid.width; x++) {
+				const float worldX = minX + (x + 0.5f) * CELL_SIZE;
+				const float worldZ = minZ + (z + 0.5f) * CELL_SIZE;
+				grid.walkable[(size_t)z * grid.width + x] = terrainShader->isOnTerrain(worldX, worldZ) || terrainShader->onBridge(worldX, worldZ);
+			}
 		}
 	}
-}
+	flowFields.setGrid(grid);
 
-void App1::updateSonarResponse(float deltaTime) {
-	if (!sceneData->ghostData.respondingToSonar) return;
-
-	sceneData->ghostData.sonarResponseTimer += deltaTime;
-
-	XMVECTOR targetPos = XMLoadFloat3(&sceneData->ghostData.sonarTargetPosition);
-	XMVECTOR currentPos = XMLoadFloat3(&sceneData->ghostData.position);
-	XMVECTOR toTarget = XMVectorSubtract(targetPos, currentPos);
-	float distance = XMVectorGetX(XMVector3Length(toTarget));
-
-	// If ghost has reached target or sonar duration expired
-	if (distance < 0.5f || sceneData->ghostData.sonarResponseTimer >= sceneData->sonarData.sonarDuration) {
-		// Store the ghost's state before sonar response
-		static XMFLOAT3 preSonarVelocity;
-		static float preSonarDirectionChangeTimer;
-		static float preSonarNextDirectionChangeTime;
+	// Island emitters only move on regeneration
+	vector<SonarPoint> emitters;
+	for (size_t i = 0; i < centres.size(); i++) emitters.push_back({ centres[i].x, centres[i].z, (int)i });
+	sonarWave.setTargets(SonarTarget::Island, emitters);
+	sonarWave.stop();
+}
 
-		if (distance < 0.5f) { // Only reached target
-			// Save current state before changing
-			preSonarVelocity = sceneData->ghostData.velocity;
-			preSonarDirectionChangeTimer = sceneData->ghostData.directionChangeTimer;
-			preSonarNextDirectionChangeTime = sceneData->ghostData.nextDirectionChangeTime;
-		}
+void App1::startSonarWave() {
+	const SonarData& sonar = sceneData->sonarData;
+	const float maxRadius = sceneData->audioState.sonarMaxRadius;
+	sonarFlowField = flowFields.request(sonar.sonarOrigin.x, sonar.sonarOrigin.z);
 
-		// Reset sonar response state
-		sceneData->ghostData.respondingToSonar = false;
-		sceneData->ghostData.sonarResponseTimer = 0.0f;
-
-		// Respawn ghost to a random island position
-		const auto& islands = islandBounds->GetIslands();
-		if (!islands.empty()) {
-			sceneData->ghostData.currentIslandIndex = rand() % islands.size();
-			const auto& island = islands[sceneData->ghostData.currentIslandIndex];
-
-			// Set new position but restore previous movement behavior
-			sceneData->ghostData.position = XMFLOAT3{
-				island.position.x + (rand() % 10 - 5),
-				island.position.y + 3.f,
-				island.position.z + (rand() % 10 - 5)
-			};
-
-			// Restore previous velocity and wandering settings
-			sceneData->ghostData.velocity = preSonarVelocity;
-			sceneData->ghostData.directionChangeTimer = preSonarDirectionChangeTimer;
-			sceneData->ghostData.nextDirectionChangeTime = preSonarNextDirectionChangeTime;
-
-			// Reset wandering timer to give immediate new direction
-			sceneData->ghostData.directionChangeTimer = 0.0f;
-			sceneData->ghostData.nextDirectionChangeTime = 0.0f;
+	// Pickups disappear as they are collected, so take them as they are now; ids are island * 4 + pickup
+	sonarPoints.clear();
+	const auto& islands = islandBounds->GetIslands();
+	for (size_t i = 0; i < islands.size(); i++) {
+		for (size_t p = 0; p < islands[i].pickupPositions.size(); p++) {
+			const XMFLOAT3& position = islands[i].pickupPositions[p];
+			sonarPoints.push_back({ position.x, position.z, (int)(i * 4 + p) });
 		}
 	}
-	else {
-		// Continue moving toward target
-		float remainingTime = sceneData->sonarData.sonarDuration - sceneData->ghostData.sonarResponseTimer;
-		float requiredSpeed = (remainingTime > 0) ? (distance / remainingTime) : 0.f;
+	sonarWave.setTargets(SonarTarget::Pickup, sonarPoints);
 
-		XMVECTOR direction = XMVector3Normalize(toTarget);
-		XMStoreFloat3(&sceneData->ghostData.velocity, XMVectorScale(direction, requiredSpeed));
-	}
+	// The ring grows at the rate the terrain shader draws it
+	sonarWave.ping(sonar.sonarOrigin.x, sonar.sonarOrigin.z, maxRadius / sonar.sonarDuration, maxRadius);
+	for (int& hits : sonarHitCounts) hits = 0;
 }
 
-void App1::handleNormalWandering(float deltaTime) {
-	const auto& island = islandBounds->GetIslands()[sceneData->ghostData.currentIslandIndex];
-	float halfSize = 25.0f;
-	float minX = island.position.x - halfSize;
-	float maxX = island.position.x + halfSize;
-	float minZ = island.position.z - halfSize;
-	float maxZ = island.position.z + halfSize;
+void App1::updateSonarWave(float deltaTime) {
+	if (!sonarWave.isRunning()) return;
 
-	bool bounced = handleBoundaryBounce(minX, maxX, minZ, maxZ);
-	if (bounced) {
-		sceneData->ghostData.directionChangeTimer = 0.0f;
-		sceneData->ghostData.nextDirectionChangeTime = randomFloat(5.0f, 10.0f);
+	// Ghosts move, so they are regridded every tick the ring runs; the slack covers how far they get in one
+	sonarPoints.clear();
+	for (int i = 0; i < ghostSwarm.size(); i++) {
+		if (!ghostSwarm.isActive(i)) continue;
+		const XMFLOAT3 position = ghostSwarm.getPosition(i);
+		sonarPoints.push_back({ position.x, position.z, i });
 	}
-
-	sceneData->ghostData.directionChangeTimer += deltaTime;
-	if (sceneData->ghostData.directionChangeTimer >= sceneData->ghostData.nextDirectionChangeTime) {
-		updateWanderingDirection();
-		sceneData->ghostData.directionChangeTimer = 0.0f;
-		sceneData->ghostData.nextDirectionChangeTime = randomFloat(5.0f, 10.0f);
+	sonarWave.setTargets(SonarTarget::Ghost, sonarPoints);
+	sonarWave.setSlack(SonarTarget::Ghost, GhostSwarm::WANDER_SPEED_MAX * deltaTime);
+	sonarWave.update(deltaTime, sonarHits);
+
+	sonarGhosts.clear();
+	for (const SonarHit& hit : sonarHits) {
+		sonarHitCounts[(int)hit.target]++;
+		if (hit.target == SonarTarget::Ghost) sonarGhosts.push_back(hit.id);
+	}
+	if (!sonarGhosts.empty()) {
+		const SonarData& sonar = sceneData->sonarData;
+		ghostSwarm.respondToSonar(sonarGhosts, sonar.sonarOrigin, sonar.sonarDuration, sonarWave.getElapsed(), sonarFlowField);
 	}
 }
 
-bool App1::handleBoundaryBounce(float minX, float maxX, float minZ, float maxZ) {
-	bool bounced = false;
-
-	if (sceneData->ghostData.position.x < minX || sceneData->ghostData.position.x > maxX) {
-		sceneData->ghostData.velocity.x *= -1.f;
-		sceneData->ghostData.position.x = max(minX, min(maxX, sceneData->ghostData.position.x));
-		bounced = true;
+void App1::updateChromaticAberration(float ghostDistance) {
+	if (ghostDistance <= 50.0f) {
+		sceneData->chromaticAberrationData.enabled = true;
+		sceneData->chromaticAberrationData.intensity = sceneData->chromaticAberrationData.maxIntensity * (1.0f - (ghostDistance / 50.0f));
 	}
-	if (sceneData->ghostData.position.z < minZ || sceneData->ghostData.position.z > maxZ) {
-		sceneData->ghostData.velocity.z *= -1.f;
-		sceneData->ghostData.position.z = max(minZ, min(maxZ, sceneData->ghostData.position.z));
-		bounced = true;
+	else {
+		sceneData->chromaticAberrationData.enabled = false;
+		sceneData->chromaticAberrationData.intensity = 0.0f;
 	}
-
-	return bounced;
 }
 
-void App1::updateWanderingDirection() {
-	sceneData->ghostData.velocity = XMFLOAT3{ randomFloat(5.f, 8.f), 0.f, randomFloat(5.f, 8.f) };
-}
+// Moves the player's proxies and every ghost's into place, then reads the overlapping pairs: the nearest ghost inside
+// the sensor drives chromatic aberration, and pickups within reach are collected in play mode
+void App1::updateBroadphase() {
+	constexpr float GHOST_SENSOR = 50.0f;	// updateChromaticAberration's falloff distance
+	constexpr float GHOST_HALF_SIZE = 0.5f;
+
+	const XMFLOAT3 playerPos = player->getPosition();
+	const float reach = sqrtf(Player::PICKUP_RADIUS * Player::PICKUP_RADIUS + PICKUP_COLLISION_RADIUS * PICKUP_COLLISION_RADIUS);
+	const BroadphaseBox body(playerPos.x, playerPos.y, playerPos.z, reach - PICKUP_COLLISION_RADIUS);
+	const BroadphaseBox sensor(playerPos.x, playerPos.y, playerPos.z, GHOST_SENSOR);
+	if (playerBody < 0) {
+		playerBody = broadphase.add(body, LAYER_PLAYER, LAYER_PICKUP);
+		playerSensor = broadphase.add(sensor, LAYER_PLAYER, LAYER_GHOST);
+	}
+	else {
+		broadphase.move(playerBody, body);
+		broadphase.move(playerSensor, sensor);
+	}
 
-void App1::updateGhostPosition(float deltaTime) {
-	sceneData->ghostData.position.x += sceneData->ghostData.velocity.x * deltaTime;
-	sceneData->ghostData.position.z += sceneData->ghostData.velocity.z * deltaTime;
+	for (size_t i = ghostSwarm.size(); i < ghostProxies.size(); i++) {
+		if (ghostProxies[i] >= 0) broadphase.remove(ghostProxies[i]);
+	}
+	ghostProxies.resize(ghostSwarm.size(), -1);
+	for (int i = 0; i < ghostSwarm.size(); i++) {
+		int& proxy = ghostProxies[i];
+		if (!ghostSwarm.isActive(i)) {
+			if (proxy >= 0) broadphase.remove(proxy);
+			proxy = -1;
+			continue;
+		}
+		const XMFLOAT3 position = ghostSwarm.getPosition(i);
+		const BroadphaseBox box(position.x, position.y, position.z, GHOST_HALF_SIZE);
+		if (proxy < 0) proxy = broadphase.add(box, LAYER_GHOST, 0, i);
+		else broadphase.move(proxy, box);
+	}
+	broadphase.update();
+
+	float ghostDistanceSq = FLT_MAX;
+	collected.clear();
+	for (const BroadphasePair& pair : broadphase.getPairs()) {
+		const bool playerFirst = pair.a == playerBody || pair.a == playerSensor;
+		const int self = playerFirst ? pair.a : pair.b, other = playerFirst ? pair.b : pair.a;
+		const int user = broadphase.getUser(other);
+
+		if (self == playerSensor && broadphase.getLayer(other) == LAYER_GHOST) {
+			const XMFLOAT3 position = ghostSwarm.getPosition(user);
+			const float dx = position.x - playerPos.x, dy = position.y - playerPos.y, dz = position.z - playerPos.z;
+			ghostDistanceSq = min(ghostDistanceSq, dx * dx + dy * dy + dz * dz);
+		}
+		else if (self == playerBody && broadphase.getLayer(other) == LAYER_PICKUP && currentMode == AppMode::Play) {
+			// The box is only a bound; the reach is a sphere
+			const XMFLOAT3& position = pickupProxies[user].position;
+			const float dx = position.x - playerPos.x, dy = position.y - playerPos.y, dz = position.z - playerPos.z;
+			if (dx * dx + dy * dy + dz * dz <= reach * reach) collected.push_back(user);
+		}
+	}
+	updateChromaticAberration(ghostDistanceSq < FLT_MAX ? sqrtf(ghostDistanceSq) : FLT_MAX);
+
+	for (int pickup : collected) {
+		PickupProxy& proxy = pickupProxies[pickup];
+		islandBounds->RemovePickup(proxy.island, proxy.position);
+		broadphase.remove(proxy.handle);
+		proxy.handle = -1;	// The broadphase hands the handle out again, to a ghost as likely as not
+		audioSystem.playOneShot("event:/Pickup");
+	}
 }
 
-void App1::updateChromaticAberration() {
-	XMFLOAT3 playerPos = player->getPosition();
-	XMVECTOR ghostPos = XMLoadFloat3(&sceneData->ghostData.position);
-	XMVECTOR playerPosVec = XMLoadFloat3(&playerPos);
-	float distance = XMVectorGetX(XMVector3Length(XMVectorSubtract(ghostPos, playerPosVec)));
-
-	if (distance <= 50.0f) {
-		sceneData->chromaticAberrationData.enabled = true;
-		sceneData->chromaticAberrationData.intensity = sceneData->chromaticAberrationData.maxIntensity * (1.0f - (distance / 50.0f));
+// Pickups only change when they are collected or the islands are regenerated
+void App1::updatePickupProxies() {
+	for (const PickupProxy& proxy : pickupProxies) {
+		if (proxy.handle >= 0) broadphase.remove(proxy.handle);
 	}
-	else {
-		sceneData->chromaticAberrationData.enabled = false;
-		sceneData->chromaticAberrationData.intensity = 0.0f;
+	pickupProxies.clear();
+
+	const auto& islands = islandBounds->GetIslands();
+	for (size_t i = 0; i < islands.size(); i++) {
+		for (const XMFLOAT3& position : islands[i].pickupPositions) {
+			const BroadphaseBox box(position.x, position.y, position.z, PICKUP_COLLISION_RADIUS);
+			pickupProxies.push_back({ broadphase.add(box, LAYER_PICKUP, 0, (int)pickupProxies.size()), i, position });
+		}
 	}
 }
 
@@ -383,10 +539,14 @@ void App1::renderGhostModel(const XMMATRIX& worldMatrix, const XMMATRIX& viewMat
 	sceneData->chromaticAberrationData.offsets.x = cos(offsetAngle) * offsetMagnitude;
 	sceneData->chromaticAberrationData.offsets.y = sin(offsetAngle) * offsetMagnitude;
 
-	XMMATRIX ghostWorldMatrix = XMMatrixTranslation(sceneData->ghostData.position.x, sceneData->ghostData.position.y, sceneData->ghostData.position.z) * worldMatrix;
-	ghost->sendData(renderer->getDeviceContext());
-	ghostShader->setShaderParameters(renderer->getDeviceContext(), ghostWorldMatrix, viewMatrix, projectionMatrix, textureMgr->getTexture(L"ghost"), camera, spotLight, directionalLight, sceneData);
-	ghostShader->render(renderer->getDeviceContext(), ghost->getIndexCount());
+	for (int i = 0; i < ghostSwarm.size(); i++) {
+		if (!ghostSwarm.isActive(i)) continue;
+		const XMFLOAT3 position = ghostSwarm.getPosition(i);
+		XMMATRIX ghostWorldMatrix = XMMatrixTranslation(position.x, position.y, position.z) * worldMatrix;
+		ghost->sendData(renderer->getDeviceContext());
+		ghostShader->setShaderParameters(renderer->getDeviceContext(), ghostWorldMatrix, viewMatrix, projectionMatrix, textureMgr->getTexture(ghostTexture), camera, spotLight, directionalLight);
+		ghostShader->render(renderer->getDeviceContext(), ghost->getIndexCount());
+	}
 }
 
 void App1::updateGhostAudio(float deltaTime) {
@@ -455,10 +615,14 @@ void App1::getShadowDepthMap(const XMMATRIX& worldMatrix, const XMMATRIX& viewMa
 		generatePickups(worldMatrix, viewMatrix, projectionMatrix, true, lightViewMatrix, lightProjectionMatrix);
 
 		// Ghost
-		XMMATRIX ghostWorldMatrix = XMMatrixTranslation(sceneData->ghostData.position.x, sceneData->ghostData.position.y, sceneData->ghostData.position.z);
-		ghost->sendData(renderer->getDeviceContext());
-		depthShader->setShaderParameters(renderer->getDeviceContext(), ghostWorldMatrix, lightViewMatrix, lightProjectionMatrix);
-		depthShader->render(renderer->getDeviceContext(), ghost->getIndexCount());
+		for (int g = 0; g < ghostSwarm.size(); g++) {
+			if (!ghostSwarm.isActive(g)) continue;
+			const XMFLOAT3 position = ghostSwarm.getPosition(g);
+			XMMATRIX ghostWorldMatrix = XMMatrixTranslation(position.x, position.y, position.z);
+			ghost->sendData(renderer->getDeviceContext());
+			depthShader->setShaderParameters(renderer->getDeviceContext(), ghostWorldMatrix, lightViewMatrix, lightProjectionMatrix);
+			depthShader->render(renderer->getDeviceContext(), ghost->getIndexCount());
+		}
 
 		// Water - own vertex shader needed to calculate displacements to cast shows correclty on it
 		//XMMATRIX waterWorldMatrix = XMMatrixTranslation(1.f, 0.0f, 1.0f) * worldMatrix;
@@ -475,16 +639,11 @@ void App1::getShadowDepthMap(const XMMATRIX& worldMatrix, const XMMATRIX& viewMa
 // Final Render
 void App1::finalRender(const XMMATRIX& worldMatrix, const XMMATRIX& viewMatrix, const XMMATRIX& projectionMatrix, const XMMATRIX& identityMatrix)
 {
-	if (wireframeToggle && !sceneData->sonarData.isActive) {
-		sceneData->shadowLightsData.dirColour[0] = 1.f;
-		sceneData->shadowLightsData.dirColour[1] = 1.f;
-		sceneData->shadowLightsData.dirColour[2] = 1.f;
-	}
-	else {
-		sceneData->shadowLightsData.dirColour[0] = 0.f;
-		sceneData->shadowLightsData.dirColour[1] = 0.023f;
-		sceneData->shadowLightsData.dirColour[2] = 0.035f;
-	}
+	if (wireframeToggle && !sceneData->sonarData.isActive) sceneData->setDirectionalColour(1.f, 1.f, 1.f);
+	else sceneData->setDirectionalColour(0.f, 0.023f, 0.035f);
+
+	// Everything lit is drawn from here on; the lights are repacked only if something above or in the GUI moved them
+	sceneConstants->update(renderer->getDeviceContext(), *sceneData);
 
 
 	//A conditional check ensures that tessellation is only applied if it has been enabled in the GUI. If enabled, tessellated meshes are loaded for rendering. Also, wireframe is enabled.
@@ -501,7 +660,7 @@ void App1::finalRender(const XMMATRIX& worldMatrix, const XMMATRIX& viewMatrix,
 
 		renderTerrain(worldMatrix, viewMatrix, projectionMatrix);
 		renderDome(worldMatrix, viewMatrix, projectionMatrix);
-		//renderWater(worldMatrix, viewMatrix, projectionMatrix);
+		if (sceneData->waterData.visible) renderWater(worldMatrix, viewMatrix, projectionMatrix);
 		renderMoon(worldMatrix, viewMatrix, projectionMatrix);
 	}
 
@@ -527,7 +686,7 @@ void App1::applyBloom(const XMMATRIX& worldMatrix, const XMMATRIX& viewMatrix, c
 	XMMATRIX skyDomeWorldMatrix = XMMatrixScaling(200.f, 200.f, 200.f) * XMMatrixTranslation(50.f, 30.f, 50.f) * worldMatrix;
 
 	circleDome->sendData(renderer->getDeviceContext());
-	bloomShader->setShaderParameters(renderer->getDeviceContext(), skyDomeWorldMatrix, viewMatrix, projectionMatrix, textureMgr->getTexture(L"dome"), SCREEN_WIDTH, SCREEN_HEIGHT, sceneData);
+	bloomShader->setShaderParameters(renderer->getDeviceContext(), skyDomeWorldMatrix, viewMatrix, projectionMatrix, textureMgr->getTexture(domeTexture), SCREEN_WIDTH, SCREEN_HEIGHT, sceneData);
 	bloomShader->render(renderer->getDeviceContext(), circleDome->getIndexCount());
 
 	renderer->setBackBufferRenderTarget();
@@ -542,6 +701,215 @@ void App1::renderDome(const XMMATRIX& worldMatrix, const XMMATRIX& viewMatrix, c
 	domeShader->render(renderer->getDeviceContext(), circleDome->getIndexCount());
 }
 
+// Hands the island slabs and the terrain height over them to the audio side, which casts occlusion rays against them
+void App1::updateAudioOcclusion() {
+	constexpr float CELL_SIZE = 2.0f;
+	constexpr float ISLAND_HALF_HEIGHT = 1.0f;	// Island meshes are unit cubes scaled by (ISLAND_SIZE, 1, ISLAND_SIZE)
+
+	AudioOcclusionGeometry geometry;
+	float minX = FLT_MAX, maxX = -FLT_MAX, minZ = FLT_MAX, maxZ = -FLT_MAX;
+	for (const auto& island : islandBounds->GetIslands()) {
+		if (!island.initialized) continue;
+
+		AudioOccluderBox box;
+		box.centre = XMFLOAT3(island.position.x, terrainShader->getHeight(island.position.x, island.position.z), island.position.z);
+		box.halfExtents = XMFLOAT3(ISLAND_SIZE, ISLAND_HALF_HEIGHT, ISLAND_SIZE);
+		box.rotationY = island.rotationY;
+		geometry.boxes.push_back(box);
+
+		// Rotated islands reach out to the corners of their square
+		const float reach = ISLAND_SIZE * 1.4143f;
+		minX = min(minX, island.position.x - reach);
+		maxX = max(maxX, island.position.x + reach);
+		minZ = min(minZ, island.position.z - reach);
+		maxZ = max(maxZ, island.position.z + reach);
+	}
+
+	if (!geometry.boxes.empty()) {
+		geometry.originX = minX;
+		geometry.originZ = minZ;
+		geometry.cellSize = CELL_SIZE;
+		geometry.width = (int)ceilf((maxX - minX) / CELL_SIZE);
+		geometry.depth = (int)ceilf((maxZ - minZ) / CELL_SIZE);
+		geometry.heights.resize((size_t)geometry.width * geometry.depth);
+
+		for (int z = 0; z < geometry.depth; z++) {
+			for (int x = 0; x < geometry.width; x++) {
+				const float worldX = minX + (x + 0.5f) * CELL_SIZE;
+				const float worldZ = minZ + (z + 0.5f) * CELL_SIZE;
+				geometry.heights[(size_t)z * geometry.width + x] = terrainShader->isOnTerrain(worldX, worldZ) ?
+					terrainShader->getHeight(worldX, worldZ) : AudioOcclusionGeometry::NO_TERRAIN;
+			}
+		}
+	}
+	audioSystem.setOcclusionGeometry(geometry);
+}
+
+// Island transforms as generateIslands builds them, so the CPU surface sits where the domain shader puts it
+void App1::updateTerrainDisplacement() {
+	vector<DisplacedIsland> displaced;
+	for (const auto& island : islandBounds->GetIslands()) {
+		if (!island.initialized) continue;
+		DisplacedIsland entry;
+		entry.centreX = island.position.x;
+		entry.centreZ = island.position.z;
+		entry.rotationY = island.rotationY;
+		entry.baseHeight = terrainShader->getHeight(island.position.x, island.position.z);
+		displaced.push_back(entry);
+	}
+	terrainDisplacement.setIslands(displaced, ISLAND_SIZE);
+}
+
+// Bounds and flat-mesh error for every island, then every bridge, in the order generateIslands and generateBridges draw
+// them. A bridge is bounded by the segment between its islands' centres, which covers the deck, and its error is the
+// island's scaled by its half-height deck.
+void App1::updateTerrainLod() {
+	constexpr float BRIDGE_WIDTH = 5.0f;	// generateBridges
+	constexpr float BRIDGE_HEIGHT = 0.5f;
+	constexpr int MESH_RESOLUTION = 20;	// topTerrain is a CubeMesh at its default resolution
+	const auto& islands = islandBounds->GetIslands();
+	const float islandError = terrainDisplacement.flatError(MESH_RESOLUTION);
+	const float islandTop = TerrainDisplacement::TOP + TerrainDisplacement::DISPLACEMENT_SCALE;
+	const float islandRadius = sqrtf(2.0f * ISLAND_SIZE * ISLAND_SIZE + islandTop * islandTop);
+
+	vector<LodObject> objects;
+	for (const auto& island : islands) {
+		LodObject object;
+		object.centreX = island.position.x;
+		object.centreY = terrainShader->getHeight(island.position.x, island.position.z) + TerrainDisplacement::TOP;
+		object.centreZ = island.position.z;
+		object.radius = islandRadius;
+		object.error = islandError;
+		objects.push_back(object);
+	}
+	for (const auto& bridge : islandBounds->GetBridges()) {
+		const auto& islandA = islands[bridge.islandA];
+		const auto& islandB = islands[bridge.islandB];
+		const float dx = islandB.position.x - islandA.position.x, dz = islandB.position.z - islandA.position.z;
+		const float heightA = terrainShader->getHeight(islandA.position.x, islandA.position.z);
+		const float heightB = terrainShader->getHeight(islandB.position.x, islandB.position.z);
+		LodObject object;
+		object.centreX = (islandA.position.x + islandB.position.x) * 0.5f;
+		object.centreY = (heightA + heightB) * 0.5f + BRIDGE_HEIGHT * 2.0f;
+		object.centreZ = (islandA.position.z + islandB.position.z) * 0.5f;
+		object.radius = sqrtf(dx * dx + dz * dz) * 0.5f + BRIDGE_WIDTH;
+		object.error = islandError * BRIDGE_HEIGHT;
+		objects.push_back(object);
+	}
+	terrainLod.setObjects(objects);
+	terrainLod.setProjection(SCREEN_HEIGHT, XM_PI / 4.0f);
+}
+
+// Hands the island slabs, bridge decks and terrain height to the player's swept collision. Bridges run between the
+// same exit and entry points generateBridges draws them at, as capsules whose top is the deck.
+void App1::updatePlayerCollision() {
+	constexpr float CELL_SIZE = 2.0f;
+	constexpr float ISLAND_DEPTH = 1.0f;	// Island meshes are unit cubes scaled by (ISLAND_SIZE, 1, ISLAND_SIZE)
+	constexpr float BRIDGE_WIDTH = 5.0f;	// generateBridges
+	constexpr float BRIDGE_HEIGHT = 0.5f;
+	constexpr float HALF_REGION_SIZE = 75.0f;
+	const auto& islands = islandBounds->GetIslands();
+
+	CollisionGeometry geometry;
+	float minX = FLT_MAX, maxX = -FLT_MAX, minZ = FLT_MAX, maxZ = -FLT_MAX;
+	for (const auto& island : islands) {
+		if (!island.initialized) continue;
+
+		CollisionSlab slab;
+		slab.centreX = island.position.x;
+		slab.centreZ = island.position.z;
+		slab.halfSize = ISLAND_SIZE;
+		slab.rotationY = island.rotationY;
+		slab.bottom = terrainShader->getHeight(island.position.x, island.position.z) - ISLAND_DEPTH;
+		geometry.slabs.push_back(slab);
+
+		const float reach = ISLAND_SIZE * 1.4143f;
+		minX = min(minX, island.position.x - reach);
+		maxX = max(maxX, island.position.x + reach);
+		minZ = min(minZ, island.position.z - reach);
+		maxZ = max(maxZ, island.position.z + reach);
+	}
+
+	for (const auto& bridge : islandBounds->GetBridges()) {
+		const auto& islandA = islands[bridge.islandA];
+		const auto& islandB = islands[bridge.islandB];
+		const float deck = (terrainShader->getHeight(islandA.position.x, islandA.position.z) +
+			terrainShader->getHeight(islandB.position.x, islandB.position.z)) * 0.5f + BRIDGE_HEIGHT;
+
+		const float dirX = islandB.position.x - islandA.position.x, dirZ = islandB.position.z - islandA.position.z;
+		const float angle = atan2f(dirZ, dirX);
+		XMFLOAT3 exitPointA = islandA.position, entryPointB = islandB.position;
+		if (fabsf(dirX) > fabsf(dirZ)) {
+			exitPointA.x += dirX > 0.0f ? HALF_REGION_SIZE : -HALF_REGION_SIZE;
+			exitPointA.z += tanf(angle) * HALF_REGION_SIZE;
+			entryPointB.x += dirX > 0.0f ? -HALF_REGION_SIZE : HALF_REGION_SIZE;
+			entryPointB.z -= tanf(angle) * HALF_REGION_SIZE;
+		}
+		else {
+			exitPointA.z += dirZ > 0.0f ? HALF_REGION_SIZE : -HALF_REGION_SIZE;
+			exitPointA.x += 1.0f / tanf(angle) * HALF_REGION_SIZE;
+			entryPointB.z += dirZ > 0.0f ? -HALF_REGION_SIZE : HALF_REGION_SIZE;
+			entryPointB.x -= 1.0f / tanf(angle) * HALF_REGION_SIZE;
+		}
+
+		CollisionCapsule capsule;
+		capsule.radius = BRIDGE_WIDTH * 0.5f;
+		capsule.a = XMFLOAT3(exitPointA.x, deck - capsule.radius, exitPointA.z);
+		capsule.b = XMFLOAT3(entryPointB.x, deck - capsule.radius, entryPointB.z);
+		geometry.capsules.push_back(capsule);
+	}
+
+	// Heights of the drawn surface at the grid's vertices; PlayerCollision only reads them inside an island's footprint
+	if (!geometry.slabs.empty()) {
+		geometry.originX = minX;
+		geometry.originZ = minZ;
+		geometry.cellSize = CELL_SIZE;
+		geometry.width = (int)ceilf((maxX - minX) / CELL_SIZE) + 1;
+		geometry.depth = (int)ceilf((maxZ - minZ) / CELL_SIZE) + 1;
+		geometry.heights.resize((size_t)geometry.width * geometry.depth);
+		ScratchScope scratch;
+		ArenaVector<float> rowX(geometry.width, 0.0f, scratch), rowZ(geometry.width, 0.0f, scratch);
+		for (int x = 0; x < geometry.width; x++) rowX[x] = minX + x * CELL_SIZE;
+		for (int z = 0; z < geometry.depth; z++) {
+			fill(rowZ.begin(), rowZ.end(), minZ + z * CELL_SIZE);
+			terrainDisplacement.heightsAt(rowX.data(), rowZ.data(), geometry.width, &geometry.heights[(size_t)z * geometry.width], 0.0f);
+		}
+	}
+	playerCollision.setGeometry(geometry);
+}
+
+// The drawn island surfaces on a vertex grid, open water wherever a vertex is off every island
+void App1::updateHeightPyramid() {
+	constexpr float CELL_SIZE = 2.0f;
+	const float reach = ISLAND_SIZE * 1.4143f;
+	HeightPyramidGrid grid;
+	float minX = FLT_MAX, maxX = -FLT_MAX, minZ = FLT_MAX, maxZ = -FLT_MAX;
+	for (const auto& island : islandBounds->GetIslands()) {
+		if (!island.initialized) continue;
+		minX = min(minX, island.position.x - reach);
+		maxX = max(maxX, island.position.x + reach);
+		minZ = min(minZ, island.position.z - reach);
+		maxZ = max(maxZ, island.position.z + reach);
+	}
+
+	if (minX <= maxX) {
+		grid.originX = minX;
+		grid.originZ = minZ;
+		grid.cellSize = CELL_SIZE;
+		grid.width = (int)ceilf((maxX - minX) / CELL_SIZE) + 1;
+		grid.depth = (int)ceilf((maxZ - minZ) / CELL_SIZE) + 1;
+		grid.heights.resize((size_t)grid.width * grid.depth);
+		ScratchScope scratch;
+		ArenaVector<float> rowX(grid.width, 0.0f, scratch), rowZ(grid.width, 0.0f, scratch);
+		for (int x = 0; x < grid.width; x++) rowX[x] = minX + x * CELL_SIZE;
+		for (int z = 0; z < grid.depth; z++) {
+			fill(rowZ.begin(), rowZ.end(), minZ + z * CELL_SIZE);
+			terrainDisplacement.heightsAt(rowX.data(), rowZ.data(), grid.width, &grid.heights[(size_t)z * grid.width], HeightPyramidGrid::NO_HEIGHT);
+		}
+	}
+	heightPyramid.build(grid);
+}
+
 // Procedural Generation of Island Bounds
 // Based on the number of islands, that many island bounds are created. Then, inside each island bound, an island is spawn with a random position and rotation. After that, each island connects to one other island with a bridge. The islands have collision detection with the Player (Play Mode) or the Camera (Fly Mode).
 
@@ -562,7 +930,8 @@ void App1::generateIslands(const XMMATRIX& worldMatrix, const XMMATRIX& viewMatr
 		}
 	}
 
-	for (auto& island : islands) {
+	for (size_t i = 0; i < islands.size(); i++) {
+		const auto& island = islands[i];
 		if (!island.initialized) continue;
 
 		float height = terrainShader->getHeight(island.position.x, island.position.z);
@@ -570,32 +939,41 @@ void App1::generateIslands(const XMMATRIX& worldMatrix, const XMMATRIX& viewMatr
 
 		if (depth) {
 			topTerrain->sendData(renderer->getDeviceContext(), D3D_PRIMITIVE_TOPOLOGY_3_CONTROL_POINT_PATCHLIST);
-			terrainDepthShader->setShaderParameters(renderer->getDeviceContext(), islandWorld, lightViewMatrix, lightProjectionMatrix, textureMgr->getTexture(L"island_floor"), textureMgr->getTexture(L""), camera);
+			terrainDepthShader->setShaderParameters(renderer->getDeviceContext(), islandWorld, lightViewMatrix, lightProjectionMatrix, textureMgr->getTexture(islandFloorTexture), textureMgr->getTexture(TextureManager::defaultTexture), camera);
 			terrainDepthShader->render(renderer->getDeviceContext(), topTerrain->getIndexCount());
 		}
 		else {
-			topTerrain->sendData(renderer->getDeviceContext(), D3D_PRIMITIVE_TOPOLOGY_3_CONTROL_POINT_PATCHLIST);
+			// Islands too far off for tessellation to show take the plain mesh, displaced in the vertex shader
+			const bool tessellated = terrainLod.isTessellated((int)i);
+			if (tessellated) topTerrain->sendData(renderer->getDeviceContext(), D3D_PRIMITIVE_TOPOLOGY_3_CONTROL_POINT_PATCHLIST);
+			else topTerrain->sendData(renderer->getDeviceContext());
 			terrainShader->setShaderParameters(renderer->getDeviceContext(), islandWorld, viewMatrix, projectionMatrix,
 				sceneData->audioState.sonarMaxRadius * (sceneData->sonarData.sonarTime / sceneData->sonarData.sonarDuration),
-				textureMgr->getTexture(L"island_floor"),
+				textureMgr->getTexture(islandFloorTexture),
 				sceneData->shadowLightsData.enableSpotShadow ? shadowMap[0]->getDepthMapSRV() : nullptr,
 				sceneData->shadowLightsData.enableDirShadow ? shadowMap[1]->getDepthMapSRV() : nullptr,
 				camera, spotLight, directionalLight, sceneData
 			);
-			terrainShader->render(renderer->getDeviceContext(), topTerrain->getIndexCount());
+			if (tessellated) terrainShader->render(renderer->getDeviceContext(), topTerrain->getIndexCount());
+			else terrainShader->renderStatic(renderer->getDeviceContext(), topTerrain->getIndexCount());
 		}
 	}
 }
 
 void App1::generatePickups(const XMMATRIX& worldMatrix, const XMMATRIX& viewMatrix, const XMMATRIX& projectionMatrix, bool depth, const XMMATRIX& lightViewMatrix, const XMMATRIX& lightProjectionMatrix) {
 	const float scaleTeapot = 0.2f;
+	size_t pickup = 0;
 
 	for (const auto& island : islandBounds->GetIslands()) {
-		if (!island.initialized) continue;
+		if (!island.initialized) {
+			pickup += island.pickupPositions.size();
+			continue;
+		}
 
 		for (const auto& position : island.pickupPositions) {
-			XMVECTOR spawnPos = XMLoadFloat3(&position);
-			XMMATRIX teapotWorld = XMMatrixScaling(scaleTeapot, scaleTeapot, scaleTeapot) * XMMatrixTranslation(XMVectorGetX(spawnPos), XMVectorGetY(spawnPos) + 1.f, XMVectorGetZ(spawnPos)) * worldMatrix;
+			// Pickups the water has risen over float on it
+			const float height = max(position.y, pickupWaterHeights[pickup++] - PICKUP_DRAFT);
+			XMMATRIX teapotWorld = XMMatrixScaling(scaleTeapot, scaleTeapot, scaleTeapot) * XMMatrixTranslation(position.x, height + 1.f, position.z) * worldMatrix;
 
 			if (depth) {
 				teapot->sendData(renderer->getDeviceContext());
@@ -604,7 +982,7 @@ void App1::generatePickups(const XMMATRIX& worldMatrix, const XMMATRIX& viewMatr
 			}
 			else {
 				teapot->sendData(renderer->getDeviceContext());
-				ghostShader->setShaderParameters(renderer->getDeviceContext(), teapotWorld, viewMatrix, projectionMatrix, textureMgr->getTexture(L"teapot"), camera, spotLight, directionalLight, sceneData);
+				ghostShader->setShaderParameters(renderer->getDeviceContext(), teapotWorld, viewMatrix, projectionMatrix, textureMgr->getTexture(teapotTexture), camera, spotLight, directionalLight);
 				ghostShader->render(renderer->getDeviceContext(), teapot->getIndexCount());
 			}
 		}
@@ -617,9 +995,11 @@ void App1::generateBridges(const XMMATRIX& worldMatrix, const XMMATRIX& viewMatr
 	constexpr float BRIDGE_HEIGHT = 0.5f;
 	constexpr float HALF_REGION_SIZE = 75.0f;
 	const auto& islands = islandBounds->GetIslands();
+	int lodIndex = (int)islands.size();	// updateTerrainLod puts the bridges after the islands
 
 	for (const auto& bridge : islandBounds->GetBridges())
 	{
+		const bool tessellated = terrainLod.isTessellated(lodIndex++);
 		const auto& islandA = islands[bridge.islandA];
 		const auto& islandB = islands[bridge.islandB];
 
@@ -664,22 +1044,27 @@ void App1::generateBridges(const XMMATRIX& worldMatrix, const XMMATRIX& viewMatr
 
 		if (depth) {
 			topTerrain->sendData(renderer->getDeviceContext(), D3D_PRIMITIVE_TOPOLOGY_3_CONTROL_POINT_PATCHLIST);
-			terrainDepthShader->setShaderParameters(renderer->getDeviceContext(), bridgeWorld, lightViewMatrix, lightProjectionMatrix, textureMgr->getTexture(L"island_floor"), textureMgr->getTexture(L""), camera);
+			terrainDepthShader->setShaderParameters(renderer->getDeviceContext(), bridgeWorld, lightViewMatrix, lightProjectionMatrix, textureMgr->getTexture(islandFloorTexture), textureMgr->getTexture(TextureManager::defaultTexture), camera);
 			terrainDepthShader->render(renderer->getDeviceContext(), topTerrain->getIndexCount());
 		}
-		topTerrain->sendData(renderer->getDeviceContext(), D3D_PRIMITIVE_TOPOLOGY_3_CONTROL_POINT_PATCHLIST);
-		terrainShader->setShaderParameters(renderer->getDeviceContext(), bridgeWorld, viewMatrix, projectionMatrix, sonarRadius, textureMgr->getTexture(L"island_floor"),
+		if (tessellated) topTerrain->sendData(renderer->getDeviceContext(), D3D_PRIMITIVE_TOPOLOGY_3_CONTROL_POINT_PATCHLIST);
+		else topTerrain->sendData(renderer->getDeviceContext());
+		terrainShader->setShaderParameters(renderer->getDeviceContext(), bridgeWorld, viewMatrix, projectionMatrix, sonarRadius, textureMgr->getTexture(islandFloorTexture),
 			sceneData->shadowLightsData.enableSpotShadow ? shadowMap[0]->getDepthMapSRV() : nullptr,
 			sceneData->shadowLightsData.enableDirShadow ? shadowMap[1]->getDepthMapSRV() : nullptr,
 			camera, spotLight, directionalLight, sceneData
 		);
-		terrainShader->render(renderer->getDeviceContext(), topTerrain->getIndexCount());
+		if (tessellated) terrainShader->render(renderer->getDeviceContext(), topTerrain->getIndexCount());
+		else terrainShader->renderStatic(renderer->getDeviceContext(), topTerrain->getIndexCount());
 	}
 }
 
 void App1::renderTerrain(const XMMATRIX& worldMatrix, const XMMATRIX& viewMatrix, const XMMATRIX& projectionMatrix) {
 	if (!wireframeToggle) renderer->setCullOn(false);
 
+	const XMFLOAT3 eye = camera->getPosition();
+	terrainLod.update(eye.x, eye.y, eye.z);
+
 	generateIslands(worldMatrix, viewMatrix, projectionMatrix, false, viewMatrix, viewMatrix);
 	generateBridges(worldMatrix, viewMatrix, projectionMatrix, false, viewMatrix, viewMatrix);
 	generatePickups(worldMatrix, viewMatrix, projectionMatrix, false, viewMatrix, viewMatrix);
@@ -688,23 +1073,134 @@ void App1::renderTerrain(const XMMATRIX& worldMatrix, const XMMATRIX& viewMatrix
 }
 
 void App1::renderWater(const XMMATRIX& worldMatrix, const XMMATRIX& viewMatrix, const XMMATRIX& projectionMatrix) {
-	XMMATRIX waterWorldMatrix = XMMatrixScaling(700.f, 1.0f, 700.f) * XMMatrixTranslation(1.f, -50.f, 1.0f) * worldMatrix;
+	const float level = sceneData->waterData.level;
+	XMMATRIX waterWorldMatrix = XMMatrixScaling(WATER_SCALE, 1.0f, WATER_SCALE) * XMMatrixTranslation(WATER_OFFSET, level, WATER_OFFSET) * worldMatrix;
+	PlaneMesh* mesh = water;
 
 	if (!wireframeToggle) renderer->setCullBack(true);
 
+	if (sceneData->waterData.fftOcean) {
+		finishOcean();
+		waterShader->updateOcean(renderer->getDeviceContext(), ocean);
+		waterSurface.setOcean(&ocean, sceneData->waterData.oceanPatchLength);	// Next frame's queries see what is drawn now
+		waterWorldMatrix = XMMatrixScaling(OCEAN_SPACING, 1.0f, OCEAN_SPACING) * XMMatrixTranslation(OCEAN_OFFSET, level, OCEAN_OFFSET) * worldMatrix;
+		mesh = oceanMesh;
+	}
+
 	// GUI conditional statement - Toggle shadows
-	water->sendData(renderer->getDeviceContext());
-	waterShader->setShaderParameters(renderer->getDeviceContext(), waterWorldMatrix, viewMatrix, projectionMatrix, textureMgr->getTexture(L"water"), sceneData->shadowLightsData.enableSpotShadow ? shadowMap[0]->getDepthMapSRV() : nullptr, sceneData->shadowLightsData.enableDirShadow ? shadowMap[1]->getDepthMapSRV() : nullptr, camera, spotLight, directionalLight, sceneData);
-	waterShader->render(renderer->getDeviceContext(), water->getIndexCount());
+	mesh->sendData(renderer->getDeviceContext());
+	waterShader->setShaderParameters(renderer->getDeviceContext(), waterWorldMatrix, viewMatrix, projectionMatrix, textureMgr->getTexture(waterTexture), sceneData->shadowLightsData.enableSpotShadow ? shadowMap[0]->getDepthMapSRV() : nullptr, sceneData->shadowLightsData.enableDirShadow ? shadowMap[1]->getDepthMapSRV() : nullptr, camera, spotLight, directionalLight, sceneData);
+	waterShader->render(renderer->getDeviceContext(), mesh->getIndexCount());
 
 	if (!wireframeToggle) renderer->setCullBack(false);
 }
 
+void App1::updateOcean() {
+	finishOcean();
+	const WaterData& waterData = sceneData->waterData;
+	OceanSettings settings;
+	settings.size = waterData.oceanSize;
+	settings.patchLength = waterData.oceanPatchLength;
+	settings.windSpeed = waterData.oceanWindSpeed;
+	settings.choppiness = waterData.oceanChoppiness;
+	ocean.setup(settings);
+	ocean.update(waterData.timeVal, &jobs);
+}
+
+// The sine waves follow the clock; the ocean is copied in once renderWater has it. Floating pickups are placed on
+// the result in one batch, since the shadow and main passes both draw them. The player only falls into water that is
+// drawn; hidden, it falls back to the flat sea below the islands.
+void App1::updateWaterSurface() {
+	const WaterData& waterData = sceneData->waterData;
+	waterSurface.setPlane(WATER_SCALE, WATER_SCALE, WATER_OFFSET, waterData.level, WATER_OFFSET);
+	waterSurface.setWaves(waterData.timeVal, waterData.amplitude, waterData.frequency, waterData.speed);
+	if (!waterData.visible || !waterData.fftOcean) waterSurface.setOcean(nullptr, 0.0f);
+	player->setWater(waterData.visible ? &waterSurface : nullptr);
+
+	size_t count = 0;
+	for (const Island& island : islandBounds->GetIslands()) count += island.pickupPositions.size();
+	pickupWaterHeights = frameArena.allocate<float>(count);
+
+	// The positions are only needed for the query
+	ScratchScope scratch(frameArena);
+	float* pickupX = scratch.allocate<float>(count);
+	float* pickupZ = scratch.allocate<float>(count);
+	size_t pickup = 0;
+	for (const Island& island : islandBounds->GetIslands()) {
+		for (const XMFLOAT3& position : island.pickupPositions) {
+			pickupX[pickup] = position.x;
+			pickupZ[pickup++] = position.z;
+		}
+	}
+	waterSurface.getHeights(pickupX, pickupZ, pickupWaterHeights, (int)count);
+}
+
+void App1::finishOcean() {
+	if (oceanJob) {
+		jobs.wait(oceanJob);
+		oceanJob = nullptr;
+	}
+}
+
+void App1::rebuildIslands() {
+	terrainShader->setIslands(islandBounds->GetIslands(), sceneData->islandSize);
+	terrainShader->setBridges(islandBounds->GetBridges(), islandBounds->GetIslands());
+	audioSystem.stopAllIslandAmbience();
+	for (auto& island : islandBounds->GetIslands()) {
+		float height = terrainShader->getHeight(island.position.x, island.position.z);
+		XMFLOAT3 pos = XMFLOAT3(island.position.x, height, island.position.z);
+		audioSystem.createIslandAmbience(pos);
+	}
+	updateAudioOcclusion();
+	updateTerrainDisplacement();
+	updateTerrainLod();
+	updatePlayerCollision();
+	updateHeightPyramid();
+	updatePickupProxies();
+	updateGhostIslands();
+}
+
+// Overwrites only what changed since the last save to the same file, such as the slots of collected pickups
+void App1::saveWorld() {
+	worldSnapshot.clear();
+	worldSnapshot.setScene(toSnapshot(*sceneData));
+	islandBounds->SaveSnapshot(worldSnapshot);
+	if (!worldSnapshot.save(WORLD_SNAPSHOT_PATH)) {
+		worldSnapshotStatus = string("Could not write ") + WORLD_SNAPSHOT_PATH;
+		return;
+	}
+	const WorldSnapshotWriter::SaveStats& save = worldSnapshot.getLastSave();
+	char status[256];
+	snprintf(status, sizeof(status), "Saved %zu islands: %.1f of %.1f KB written (%s)", worldSnapshot.getIslandCount(),
+		save.bytesWritten / 1024.0f, save.fileBytes / 1024.0f, save.incremental ? "incremental" : "whole file");
+	worldSnapshotStatus = status;
+}
+
+// The file is mapped, not parsed; the islands are copied out of it and the view closed again
+bool App1::loadWorld() {
+	WorldSnapshotView view;
+	if (!view.open(WORLD_SNAPSHOT_PATH)) {
+		worldSnapshotStatus = string("Could not load ") + WORLD_SNAPSHOT_PATH + ": " + view.getError();
+		return false;
+	}
+	const SnapshotScene& scene = view.getScene();
+	unique_ptr<Islands> loaded = make_unique<Islands>(scene.gridSize, (int)view.getIslandCount());
+	if (!loaded->LoadSnapshot(view)) {
+		worldSnapshotStatus = string("Could not load ") + WORLD_SNAPSHOT_PATH + ": a record points outside the file";
+		return false;
+	}
+	fromSnapshot(scene, *sceneData);
+	islandBounds = move(loaded);
+	rebuildIslands();
+	worldSnapshotStatus = "Loaded " + to_string(view.getIslandCount()) + " islands";
+	return true;
+}
+
 void App1::renderMoon(const XMMATRIX& worldMatrix, const XMMATRIX& viewMatrix, const XMMATRIX& projectionMatrix) {
 	XMMATRIX moonWorldMatrix = XMMatrixScaling(10.0f, 10.0f, 10.0f) * XMMatrixTranslation(sceneData->moonData.moon_pos[0], sceneData->moonData.moon_pos[1], sceneData->moonData.moon_pos[2]) * worldMatrix;
 
 	moon->sendData(renderer->getDeviceContext());
-	moonShader->setShaderParameters(renderer->getDeviceContext(), moonWorldMatrix, viewMatrix, projectionMatrix, textureMgr->getTexture(L"moon"), spotLight, sceneData);
+	moonShader->setShaderParameters(renderer->getDeviceContext(), moonWorldMatrix, viewMatrix, projectionMatrix, textureMgr->getTexture(moonTexture));
 	moonShader->render(renderer->getDeviceContext(), moon->getIndexCount());
 }
 
@@ -736,37 +1232,107 @@ void App1::gui()
 			camera->getRotation().x, camera->getRotation().y, camera->getRotation().z);
 		ImGui::Text("Player Position: X = %.3f, Y = %.3f, Z = %.3f",
 			player->getPosition().x, player->getPosition().y, player->getPosition().z);
+		HeightRay look;
+		look.origin = camera->getPosition();
+		look.direction = camera->getForward();
+		HeightHit hit;
+		if (heightPyramid.raycast(look, hit))
+			ImGui::Text("Looking At: X = %.3f, Y = %.3f, Z = %.3f (%.1f away)", hit.point.x, hit.point.y, hit.point.z, hit.distance);
+		else
+			ImGui::Text("Looking At: open water");
+		ImGui::Text("Tessellated Terrain: %d of %d", terrainLod.getTessellatedCount(), terrainLod.size());
+		const FrameArena::Stats& arena = frameArena.getStats();
+		const FrameArena::Stats& scratch = FrameArena::scratch().getStats();
+		ImGui::Text("Frame Arena: %zu allocations last frame, %.1f of %.1f KB peak, %zu heap blocks ever",
+			arena.lastAllocations, arena.peakBytes / 1024.0f, arena.capacity / 1024.0f, arena.blockAllocations);
+		ImGui::Text("Scratch: %zu allocations, %.1f of %.1f KB peak, %zu heap blocks ever",
+			scratch.totalAllocations, scratch.peakBytes / 1024.0f, scratch.capacity / 1024.0f, scratch.blockAllocations);
+		ImGui::Text("Light Uploads: %u", sceneConstants->getLightUploads());
+	}
+	if (ImGui::CollapsingHeader("Memory"))
+	{
+		// CPU counts what each subsystem reported, FMOD's own books included; GPU is sized from resource descriptions
+		ImGui::Columns(6, "memory");
+		ImGui::Text("Tag"); ImGui::NextColumn();
+		ImGui::Text("CPU KB"); ImGui::NextColumn();
+		ImGui::Text("Peak"); ImGui::NextColumn();
+		ImGui::Text("Live"); ImGui::NextColumn();
+		ImGui::Text("GPU KB"); ImGui::NextColumn();
+		ImGui::Text("Peak"); ImGui::NextColumn();
+		ImGui::Separator();
+		for (int tag = 0; tag <= (int)MemoryTag::Count; tag++) {
+			const bool isTotal = tag == (int)MemoryTag::Count;
+			const MemoryTracker::TagStats stats = isTotal ? MemoryTracker::getTotal() : MemoryTracker::getStats((MemoryTag)tag);
+			if (isTotal) ImGui::Separator();
+			ImGui::Text("%s", isTotal ? "Total" : MemoryTracker::getName((MemoryTag)tag)); ImGui::NextColumn();
+			ImGui::Text("%.1f", stats.getCpuBytes() / 1024.0f); ImGui::NextColumn();
+			ImGui::Text("%.1f", (stats.peakBytes + stats.externalPeakBytes) / 1024.0f); ImGui::NextColumn();
+			ImGui::Text("%zu", stats.allocations - stats.frees); ImGui::NextColumn();
+			ImGui::Text("%.1f", stats.getGpuBytes() / 1024.0f); ImGui::NextColumn();
+			ImGui::Text("%.1f", stats.gpuPeakBytes / 1024.0f); ImGui::NextColumn();
+		}
+		ImGui::Columns(1);
+
+		const MemoryTracker::TagStats total = MemoryTracker::getTotal();
+		ImGui::Text("GPU: %.1f MB buffers, %.1f MB textures, %.1f MB render targets",
+			total.gpuBytes[(int)GpuMemory::Buffer] / (1024.0f * 1024.0f),
+			total.gpuBytes[(int)GpuMemory::Texture] / (1024.0f * 1024.0f),
+			total.gpuBytes[(int)GpuMemory::RenderTarget] / (1024.0f * 1024.0f));
+		if (ImGui::Button("Write memory.json")) MemoryTracker::writeJson("memory.json");
 	}
 	if (ImGui::CollapsingHeader("Lighting Settings"))
 	{
-		ImGui::ColorEdit4("Ambient Colour", sceneData->lightData.ambientColour);
-		ImGui::ColorEdit4("Diffuse Colour", sceneData->lightData.diffuseColour);
-		ImGui::SliderFloat("Specular Power", &sceneData->lightData.spec_pow, 0.1f, 1000.f);
-		ImGui::ColorEdit4("Specular Colour", sceneData->lightData.specularColour);
+		// Any edit bumps the block it touched, so SceneConstants repacks the lights that frame
+		bool lightEdited = ImGui::ColorEdit4("Ambient Colour", sceneData->lightData.ambientColour);
+		lightEdited |= ImGui::ColorEdit4("Diffuse Colour", sceneData->lightData.diffuseColour);
+		lightEdited |= ImGui::SliderFloat("Specular Power", &sceneData->lightData.spec_pow, 0.1f, 1000.f);
+		lightEdited |= ImGui::ColorEdit4("Specular Colour", sceneData->lightData.specularColour);
+		if (lightEdited) sceneData->lightData.version++;
 
 		ImGui::Separator();
 
 		ImGui::Text("Moonlight (Spotlight)");
 
-		ImGui::SliderFloat3("Position 3", sceneData->moonData.moon_pos, -15.f, 250.0f);
-		ImGui::SliderFloat3("Spot Direction", sceneData->shadowLightsData.lightDirections[0], -1.0f, 1.0f);
-		ImGui::ColorEdit4("Colour 3", sceneData->shadowLightsData.spotColour);
-		ImGui::SliderFloat("Cutoff", &sceneData->shadowLightsData.spotCutoff, 0.f, 10.f);
-		ImGui::SliderFloat("Falloff", &sceneData->shadowLightsData.spotFalloff, 0.f, 10.f);
+		if (ImGui::SliderFloat3("Position 3", sceneData->moonData.moon_pos, -15.f, 250.0f)) sceneData->moonData.version++;
+		bool shadowLightEdited = ImGui::SliderFloat3("Spot Direction", sceneData->shadowLightsData.lightDirections[0], -1.0f, 1.0f);
+		shadowLightEdited |= ImGui::ColorEdit4("Colour 3", sceneData->shadowLightsData.spotColour);
+		shadowLightEdited |= ImGui::SliderFloat("Cutoff", &sceneData->shadowLightsData.spotCutoff, 0.f, 10.f);
+		shadowLightEdited |= ImGui::SliderFloat("Falloff", &sceneData->shadowLightsData.spotFalloff, 0.f, 10.f);
 
 		ImGui::Separator();
 
 		ImGui::Text("Directional Light");
 
-		ImGui::SliderFloat3("Direction", sceneData->shadowLightsData.lightDirections[1], -1.0f, 1.0f);
-		ImGui::ColorEdit4("Colour 4", sceneData->shadowLightsData.dirColour);
-		ImGui::SliderFloat3("Position 4", sceneData->shadowLightsData.dir_pos, -15.f, 250.0f);
+		shadowLightEdited |= ImGui::SliderFloat3("Direction", sceneData->shadowLightsData.lightDirections[1], -1.0f, 1.0f);
+		shadowLightEdited |= ImGui::ColorEdit4("Colour 4", sceneData->shadowLightsData.dirColour);
+		shadowLightEdited |= ImGui::SliderFloat3("Position 4", sceneData->shadowLightsData.dir_pos, -15.f, 250.0f);
+		if (shadowLightEdited) sceneData->shadowLightsData.version++;
 	}
 	if (ImGui::CollapsingHeader("Bloom Effect Settings"))
 	{
 		ImGui::SliderFloat("Pollution Amount", &sceneData->bloomData.blurAmount, 0.f, 2.f);
 		ImGui::SliderFloat("Bloom Intensity", &sceneData->bloomData.blurIntensity, 0.f, 2.f);
 	}
+	if (ImGui::CollapsingHeader("Water Settings"))
+	{
+		ImGui::Checkbox("Show Water", &sceneData->waterData.visible);
+		ImGui::Checkbox("FFT Ocean", &sceneData->waterData.fftOcean);
+		ImGui::SliderFloat("Water Level", &sceneData->waterData.level, -60.f, 20.f);
+		if (sceneData->waterData.fftOcean)
+		{
+			bool changed = ImGui::SliderFloat("Wind Speed", &sceneData->waterData.oceanWindSpeed, 1.f, 30.f);
+			changed |= ImGui::SliderFloat("Choppiness", &sceneData->waterData.oceanChoppiness, 0.f, 2.5f);
+			changed |= ImGui::SliderFloat("Patch Length", &sceneData->waterData.oceanPatchLength, 16.f, 256.f);
+			changed |= ImGui::SliderInt("Ocean Resolution", &sceneData->waterData.oceanSize, 32, 256);
+			if (changed) updateOcean();
+		}
+		else
+		{
+			ImGui::SliderFloat("Wave Amplitude", &sceneData->waterData.amplitude, 0.f, 5.f);
+			ImGui::SliderFloat("Wave Frequency", &sceneData->waterData.frequency, 0.f, 2.f);
+			ImGui::SliderFloat("Wave Speed", &sceneData->waterData.speed, 0.f, 10.f);
+		}
+	}
 
 	ImGui::End();
 
@@ -796,16 +1362,21 @@ void App1::gui()
 		sceneData->gridSize = max(sceneData->gridSize, static_cast<int>(sceneData->islandSize * 2));
 		islandBounds = make_unique<Islands>(sceneData->gridSize, sceneData->islandCount);
 		islandBounds->GenerateIslands();
-		terrainShader->setIslands(islandBounds->GetIslands(), sceneData->islandSize);
-		terrainShader->setBridges(islandBounds->GetBridges(), islandBounds->GetIslands());
-		audioSystem.stopAllIslandAmbience();
-		for (auto& island : islandBounds->GetIslands()) {
-			float height = terrainShader->getHeight(island.position.x, island.position.z);
-			XMFLOAT3 pos = XMFLOAT3(island.position.x, height, island.position.z);
-			audioSystem.createIslandAmbience(pos);
-		}
+		rebuildIslands();
 	}
 
+	if (ImGui::Button("Save World")) saveWorld();
+	ImGui::SameLine();
+	if (ImGui::Button("Load World")) loadWorld();
+	if (!worldSnapshotStatus.empty()) ImGui::Text("%s", worldSnapshotStatus.c_str());
+
+	ImGui::Separator();
+
+	ImGui::Text("Ghosts");
+	ImGui::SliderInt("Ghost Count", &sceneData->ghostCount, 1, 64);
+	ImGui::Text("Sonar reached %d ghosts, %d pickups, %d islands", sonarHitCounts[(int)SonarTarget::Ghost],
+		sonarHitCounts[(int)SonarTarget::Pickup], sonarHitCounts[(int)SonarTarget::Island]);
+
 	ImGui::Separator();
 
 	if (ImGui::Button("Reset Entire View")) sceneData->resetView();
@@ -870,6 +1441,8 @@ bool App1::frame()
 {
 	bool result;
 
+	frameArena.reset();
+	FrameArena::scratch().reset();	// No scope is open between frames, so its blocks merge here
 	result = BaseApplication::frame();
 	if (!result)
 	{
@@ -896,6 +1469,7 @@ void App1::initComponents() {
 
 	// Scene Data capsule setup (contains all data values)
 	sceneData = new SceneData();
+	sceneConstants = new SceneConstants(renderer->getDevice());
 
 	// Lights setup
 	spotLight = new Light();
@@ -910,40 +1484,59 @@ void App1::initComponents() {
 	pointLight2->generateOrthoMatrix((float)sceneWidth, (float)sceneHeight, 0.1f, 500);
 
 	// Audio
-	if (!audioSystem.init()) MessageBox(hwnd, L"Failed to initialize audio system", L"Audio Error", MB_OK | MB_ICONERROR);
+	if (!audioSystem.init(new FMODAudioBackend())) MessageBox(hwnd, L"Failed to initialize audio system", L"Audio Error", MB_OK | MB_ICONERROR);
 
 	/*****************************    Initialize individual components    ************************************/
 
 	// Circle Dome
 	circleDome = new SphereMesh(renderer->getDevice(), renderer->getDeviceContext());
 	domeShader = new DomeShader(renderer->getDevice(), hwnd);
-	textureMgr->loadTexture(L"dome", L"res/sky/brandon-griggs-PcAxQ_BMjnk-unsplash.jpg"); // Griggs, Brandon (2024). Unsplash. Available at: https://unsplash.com/photos/a-black-background-with-a-small-amount-of-snow-PcAxQ_BMjnk (Accessed: November 17, 2024).
+	domeTexture = textureMgr->loadTexture(L"dome", L"res/sky/brandon-griggs-PcAxQ_BMjnk-unsplash.jpg"); // Griggs, Brandon (2024). Unsplash. Available at: https://unsplash.com/photos/a-black-background-with-a-small-amount-of-snow-PcAxQ_BMjnk (Accessed: November 17, 2024).
 
 	// Terrain
 	topTerrain = new CubeMesh(renderer->getDevice(), renderer->getDeviceContext());
-	terrainShader = new TerrainManipulation(renderer->getDevice(), hwnd);
+	terrainShader = new TerrainManipulation(renderer->getDevice(), hwnd, sceneConstants);
 
 	// Islands
-	textureMgr->loadTexture(L"island_floor", L"res/Floor_Black.jpg");
+	islandFloorTexture = textureMgr->loadTexture(L"island_floor", L"res/Floor_Black.jpg");
+	UINT floorWidth, floorHeight;
+	vector<uint8_t> floorPixels;
+	// The same file the texture above is drawn from, the baked res/Floor_Black.dds when there is one, so collision
+	// meets the displaced surface rather than the source image the bake compressed
+	if (textureMgr->decodePixels(L"res/Floor_Black.jpg", floorWidth, floorHeight, floorPixels))
+		terrainDisplacement.setTexture((int)floorWidth, (int)floorHeight, floorPixels.data(), (int)floorWidth * 4);
+	else
+		MessageBox(hwnd, L"Failed to read the island floor heights", L"Terrain Error", MB_OK | MB_ICONERROR);
 	islandBounds = make_unique<Islands>(sceneData->gridSize, sceneData->islandCount);
 	islandBounds->GenerateIslands();
 	terrainShader->setIslands(islandBounds->GetIslands(), sceneData->islandSize);
 	terrainShader->setBridges(islandBounds->GetBridges(), islandBounds->GetIslands());
+	updateAudioOcclusion();
+	updateTerrainDisplacement();
+	updateTerrainLod();
+	updateOcean();
+	updatePlayerCollision();
+	updateHeightPyramid();
+	updatePickupProxies();
+	ghostSwarm.setFlowFields(&flowFields);
+	ghostSwarm.setWater(&waterSurface);
+	updateGhostIslands();
 
 	// Water
 	water = new PlaneMesh(renderer->getDevice(), renderer->getDeviceContext());
-	waterShader = new WaterShader(renderer->getDevice(), hwnd);
-	textureMgr->loadTexture(L"water", L"res/blue_water.jpg"); // RoStRecords. Envato. Available at: https://elements.envato.com/pool-with-blue-water-water-surface-texture-top-vie-SXS2RKD (Accessed: November 17, 2024).
+	oceanMesh = new PlaneMesh(renderer->getDevice(), renderer->getDeviceContext(), OCEAN_RESOLUTION);
+	waterShader = new WaterShader(renderer->getDevice(), hwnd, sceneConstants);
+	waterTexture = textureMgr->loadTexture(L"water", L"res/blue_water.jpg"); // RoStRecords. Envato. Available at: https://elements.envato.com/pool-with-blue-water-water-surface-texture-top-vie-SXS2RKD (Accessed: November 17, 2024).
 
 	// Moon
 	moon = new SphereMesh(renderer->getDevice(), renderer->getDeviceContext());
-	moonShader = new MoonShader(renderer->getDevice(), hwnd);
-	textureMgr->loadTexture(L"moon", L"res/moon.jpg"); // Solar System Scope. Solar System. Available at: https://www.solarsystemscope.com/textures/ (Accessed: November 27, 2024).
+	moonShader = new MoonShader(renderer->getDevice(), hwnd, sceneConstants);
+	moonTexture = textureMgr->loadTexture(L"moon", L"res/moon.jpg"); // Solar System Scope. Solar System. Available at: https://www.solarsystemscope.com/textures/ (Accessed: November 27, 2024).
 
 	// Ghost
-	ghostShader = new GhostShader(renderer->getDevice(), hwnd);
+	ghostShader = new GhostShader(renderer->getDevice(), hwnd, sceneConstants);
 	ghost = new AModel(renderer->getDevice(), "res/Sphere.obj"); // Falconer, Ruth (2024) ‘DX Framework for CMP301’ [My Learning Space]. Abertay University. 25 September.
-	textureMgr->loadTexture(L"ghost", L"res/yellow.jpg"); // Dent, Jason (2020) Unsplash. Available at: https://unsplash.com/photos/yellow-and-white-color-illustration-S53ekmu8KkE (Accessed: December 8, 2024).
+	ghostTexture = textureMgr->loadTexture(L"ghost", L"res/yellow.jpg"); // Dent, Jason (2020) Unsplash. Available at: https://unsplash.com/photos/yellow-and-white-color-illustration-S53ekmu8KkE (Accessed: December 8, 2024).
 
 	// Chromatic Aberration
 	chromaticAberration = new ChromaticAberration(renderer->getDevice(), hwnd);
@@ -966,12 +1559,13 @@ void App1::initComponents() {
 
 	// Teapots
 	teapot = new AModel(renderer->getDevice(), "res/teapot.obj"); // Falconer, Ruth (2024) ‘DX Framework for CMP301’ [My Learning Space]. Abertay University. 03 May.
-	textureMgr->loadTexture(L"teapot", L"res/snow2/snow.jpg"); // wirestock. Freepik. Available at: https://www.freepik.com/free-photo/closeup-texture-fresh-white-snow-surface_23836198.htm#fromView=search&page=1&position=1&uuid=89966487-bab0-4307-a96b-a316a9055e31 (Accessed: November 27, 2024).
+	teapotTexture = textureMgr->loadTexture(L"teapot", L"res/snow2/snow.jpg"); // wirestock. Freepik. Available at: https://www.freepik.com/free-photo/closeup-texture-fresh-white-snow-surface_23836198.htm#fromView=search&page=1&position=1&uuid=89966487-bab0-4307-a96b-a316a9055e31 (Accessed: November 27, 2024).
 
 	// Player, Ghost
 	ghostActor = new Ghost();
 	player = new Player();
 	player->initialize(sceneData);
+	player->setCollision(&playerCollision);
 
 	testTess = new PlaneMesh(renderer->getDevice(), renderer->getDeviceContext());
 }
@@ -979,11 +1573,13 @@ void App1::initComponents() {
 /*****************************    Cleanup    ************************************/
 
 void App1::cleanup() {
+	finishOcean();
 	if (circleDome) { delete circleDome; circleDome = nullptr; }
 	if (domeShader) { delete domeShader; domeShader = nullptr; }
 	if (renderBloom) { delete renderBloom; renderBloom = nullptr; }
 	if (bloomShader) { delete bloomShader; bloomShader = nullptr; }
 	if (water) { delete water; water = nullptr; }
+	if (oceanMesh) { delete oceanMesh; oceanMesh = nullptr; }
 	if (waterShader) { delete waterShader; waterShader = nullptr; }
 	if (topTerrain) { delete topTerrain; topTerrain = nullptr; }
 	if (terrainShader) { delete terrainShader; terrainShader = nullptr; }
@@ -997,6 +1593,7 @@ void App1::cleanup() {
 	if (waterDepthShader) { delete waterDepthShader; waterDepthShader = nullptr; }
 	if (terrainDepthShader) { delete terrainDepthShader; terrainDepthShader = nullptr; }
 	if (ghostShader) { delete ghostShader; ghostShader = nullptr; }
+	if (sceneConstants) { delete sceneConstants; sceneConstants = nullptr; }
 	if (sceneData) { delete sceneData; sceneData = nullptr; }
 	if (player) { delete player; player = nullptr; }
 
@@ -1,9 +1,11 @@
-// Application.h
+﻿// Application.h
 #ifndef _APP1_H
 #define _APP1_H
 
 // Includes
 #include "DXF.h"
+#include "FrameArena.h"
+#include "MemoryTracker.h"
 #include "WaterShader.h"
 #include "TerrainManipulation.h"
 #include "MoonShader.h"
@@ -16,13 +18,24 @@
 #include "TerrainDepthShader.h"
 #include "SimpleTexture.h"
 #include "SceneData.h"
+#include "SceneConstants.h"
 #include "Player.h"
 #include "Islands.h"
-#include "FMODAudioSystem.h"
+#include "AudioSystem.h"
+#include "FMODAudioBackend.h"
 #include "Ghost.h"
+#include "GhostSwarm.h"
+#include "SonarWave.h"
+#include "SweepAndPrune.h"
+#include "HeightPyramid.h"
+#include "TerrainDisplacement.h"
+#include "TerrainLod.h"
+#include "OceanFFT.h"
+#include "WaterSurface.h"
 #include "TeapotSpotlight.h"
 
 enum class AppMode { FlyCam, Play };
+enum BroadphaseLayer : uint32_t { LAYER_PLAYER = 1, LAYER_GHOST = 2, LAYER_PICKUP = 4 };
 extern AppMode currentMode;
 
 class App1 : public BaseApplication
@@ -41,7 +54,6 @@ protected:
 private:
 	// Initialization method
 	void initComponents();
-	float randomFloat(float min, float max);
 
 	// Rendering pipeline methods
 	void renderToTexture();
@@ -58,27 +70,39 @@ private:
 	void renderMoon(const XMMATRIX& worldMatrix, const XMMATRIX& viewMatrix, const XMMATRIX& projectionMatrix);
 
 	// Ghost behavior methods
-	void handleGhostRespawn();
-	void updateSonarResponse(float deltaTime);
-	void handleNormalWandering(float deltaTime);
-	bool handleBoundaryBounce(float minX, float maxX, float minZ, float maxZ);
-	void updateWanderingDirection();
-	void updateGhostPosition(float deltaTime);
+	void updateGhostIslands();
+	void startSonarWave();
+	void updateSonarWave(float deltaTime);
 	void renderGhostModel(const XMMATRIX& worldMatrix, const XMMATRIX& viewMatrix, const XMMATRIX& projectionMatrix, float deltaTime);
 
 	// Post-processing methods
 	void applyBloom(const XMMATRIX& worldMatrix, const XMMATRIX& viewMatrix, const XMMATRIX& projectionMatrix);
 	void applyChromaticAberration(const XMMATRIX& worldMatrix, const XMMATRIX& orthoViewMatrix, const XMMATRIX& orthoMatrix);
-	void updateChromaticAberration();
+	void updateChromaticAberration(float ghostDistance);
 
 	// Audio methods
 	void renderAudio();
 	void updateGhostAudio(float deltaTime);
+	void updateAudioOcclusion();
+
+	// Collision methods
+	void updateTerrainDisplacement();
+	void updatePlayerCollision();
+	void updateHeightPyramid();
+	void updatePickupProxies();
+	void updateBroadphase();
 
 	// World generation methods
 	void generateIslands(const XMMATRIX& worldMatrix, const XMMATRIX& viewMatrix, const XMMATRIX& projectionMatrix, bool depth, const XMMATRIX& lightViewMatrix, const XMMATRIX& lightProjectionMatrix);
 	void generateBridges(const XMMATRIX& worldMatrix, const XMMATRIX& viewMatrix, const XMMATRIX& projectionMatrix, bool depth, const XMMATRIX& lightViewMatrix, const XMMATRIX& lightProjectionMatrix);
 	void generatePickups(const XMMATRIX& worldMatrix, const XMMATRIX& viewMatrix, const XMMATRIX& projectionMatrix, bool depth, const XMMATRIX& lightViewMatrix, const XMMATRIX& lightProjectionMatrix);
+	void updateTerrainLod();
+	void rebuildIslands();	// Everything built from the islands, after they're generated or loaded
+	void saveWorld();
+	bool loadWorld();
+	void updateOcean();
+	void updateWaterSurface();
+	void finishOcean();
 
 	// Cleanup
 	void cleanup();
@@ -104,15 +128,25 @@ private:
 	TerrainManipulation* terrainShader;
 	MoonShader* moonShader;
 	GhostShader* ghostShader;
+	SceneConstants* sceneConstants = nullptr;	// The lights every lit shader binds, packed when they change
 
 	// Geometry
 	SphereMesh* circleDome;
 	PlaneMesh* water;
+	PlaneMesh* oceanMesh = nullptr;	// Denser than water, for the FFT ocean
 	CubeMesh* topTerrain;
 	SphereMesh* moon;
 	AModel* ghost;
 	AModel* teapot;
 
+	// Textures, resolved once at load
+	TextureHandle domeTexture;
+	TextureHandle islandFloorTexture;
+	TextureHandle waterTexture;
+	TextureHandle moonTexture;
+	TextureHandle ghostTexture;
+	TextureHandle teapotTexture;
+
 	// Lighting
 	Light* spotLight;
 	Light* directionalLight;
@@ -122,16 +156,48 @@ private:
 
 	// Game entities
 	Player* player;
+	PlayerCollision playerCollision;	// Island slabs and bridge decks the player is swept against
+	TerrainDisplacement terrainDisplacement;	// The island surfaces as terrain_ds.hlsl draws them
+	HeightPyramid heightPyramid;	// Island surfaces for ray casts
+	TerrainLod terrainLod;	// Islands, then bridges: which take the tessellated path this frame
 	Ghost* ghostActor;
+	GhostSwarm ghostSwarm;
+	FlowFields flowFields;	// Shared paths to sonar pings
+	SonarWave sonarWave;	// The ping's ring, reaching ghosts, pickups and island emitters as it passes them
+	int sonarFlowField = -1;
+	vector<SonarPoint> sonarPoints;	// Scratch for the ghost positions handed to the wave
+	vector<SonarHit> sonarHits;
+	vector<int> sonarGhosts;
+	int sonarHitCounts[(int)SonarTarget::Count] = {};	// This ping so far
+
+	// Broadphase: the player's pickup reach and ghost sensor against every ghost and pickup
+	struct PickupProxy {
+		int handle;	// -1 once collected
+		size_t island;
+		XMFLOAT3 position;
+	};
+	SweepAndPrune broadphase;
+	int playerBody = -1, playerSensor = -1;
+	vector<int> ghostProxies;	// Per swarm ghost, -1 while inactive
+	vector<PickupProxy> pickupProxies;	// Proxy user is the index here
+	vector<int> collected;
 
 	// Systems
-	FMODAudioSystem audioSystem;
+	AudioSystem audioSystem;
+	JobSystem jobs;	// One worker per core beside the main thread
+	OceanFFT ocean;
+	JobSystem::Job* oceanJob = nullptr;	// This frame's ocean update, running beside the rest of the frame
+	WaterSurface waterSurface;	// What renderWater draws, for the player, ghosts and pickups to meet
+	float* pickupWaterHeights = nullptr;	// Per pickup in island order, this frame, in frameArena
+	FrameArena frameArena;	// This frame's transient data, given back as the next frame starts
 	SceneData* sceneData;
 
 	PlaneMesh* testTess;
 
 	// Islands
 	unique_ptr<Islands> islandBounds;
+	WorldSnapshotWriter worldSnapshot;	// Kept between saves for its buffers
+	string worldSnapshotStatus;	// What the last save or load did, for the GUI
 
 	float SCREEN_WIDTH = 0.f;
 	float SCREEN_HEIGHT = 0.f;
@@ -0,0 +1,43 @@
+#pragma once
+#include "AudioTypes.h"
+#include <string>
+
+using namespace std;
+
+// Handle to a playing (or created) event instance. 0 is never a valid voice.
+typedef unsigned int AudioVoice;
+
+// Everything AudioSystem needs from a sound engine. Calls are write-only; the game keeps its own copy of voice
+// state in AudioEmitterTable. FMODAudioBackend plays through FMOD Studio;
+// NullAudioBackend plays nothing and records the calls so the game-side logic can run headless.
+class AudioBackend {
+public:
+	virtual ~AudioBackend() = default;
+
+	virtual bool init() = 0;
+	virtual void release() = 0;
+	virtual void update() = 0;	// Once per frame, after all voice changes
+
+	// Voices
+	virtual AudioVoice createVoice(const string& eventPath) = 0;	// 0 if the event does not exist
+	virtual void startVoice(AudioVoice voice) = 0;
+	virtual void stopVoice(AudioVoice voice, bool allowFadeOut) = 0;
+	virtual void releaseVoice(AudioVoice voice) = 0;	// Handle is invalid afterwards
+	virtual void playOneShot(const char* eventPath) = 0;	// Fire and forget
+
+	virtual void setVolume(AudioVoice voice, float volume) = 0;
+	virtual void setPitch(AudioVoice voice, float pitch) = 0;
+	virtual void set3DAttributes(AudioVoice voice, const AudioAttributes3D& attributes) = 0;
+
+	// Per-voice spatial shaping
+	virtual void setCone(AudioVoice voice, const AudioVector& direction, float insideAngle, float outsideAngle, float outsideVolume) = 0;
+	virtual void setDopplerLevel(AudioVoice voice, float level) = 0;
+	virtual void setSpread(AudioVoice voice, float degrees) = 0;
+
+	// Effects
+	virtual void setDuckingFilter(AudioVoice voice, bool enabled) = 0;	// Muffling EQ plus compressor
+	virtual void addTransient(AudioVoice voice, float gain) = 0;	// Short gain boost
+	virtual void setLowpass(AudioVoice voice, float cutoffHz) = 0;	// Occlusion filter; 22 kHz and above is open
+
+	virtual void setListener(const AudioAttributes3D& attributes) = 0;
+};
@@ -0,0 +1,408 @@
+#include "AudioController.h"
+#include <cstdio>
+#include <cstdlib>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+// Clamps a value between min and max
+static float clampf(float value, float minValue, float maxValue) {
+	return (value < minValue) ? minValue : (value > maxValue) ? maxValue : value;
+}
+
+// Smoothly transitions between values (used for volume fading)
+inline float smoothstep(float edge0, float edge1, float x) {
+	x = clampf((x - edge0) / (edge1 - edge0), 0.0f, 1.0f);
+	return x * x * (3.0f - 2.0f * x);
+}
+
+static void debugLog(const char* message) {
+#ifdef _WIN32
+	OutputDebugStringA(message);
+#else
+	fputs(message, stderr);
+#endif
+}
+
+// Initializes the backend; the system stays silent if it fails
+bool AudioController::init(AudioBackend* audioBackend) {
+	// First check if already initialized
+	if (backend) {
+		delete audioBackend;
+		return true;
+	}
+	if (!audioBackend) return false;
+
+	if (!audioBackend->init()) {
+		delete audioBackend;
+		return false;
+	}
+
+	backend = audioBackend;
+	ambienceVoices.setMaxVoices(MAX_AMBIENCE_VOICES);
+	return true;
+}
+
+// Creates an event instance and its emitter table entry
+int AudioController::createVoice(const string& eventPath) {
+	if (!backend) return -1;
+
+	AudioVoice voice = backend->createVoice(eventPath);
+	return voice ? emitters.add(voice) : -1;
+}
+
+// Stops and releases a voice, leaving the id at -1
+void AudioController::releaseVoice(int& id, bool allowFadeOut) {
+	if (!backend || id < 0) return;
+
+	AudioVoice voice = emitters.getVoice(id);
+	backend->stopVoice(voice, allowFadeOut);
+	backend->releaseVoice(voice);
+	emitters.remove(id);
+	id = -1;
+}
+
+// Plays background music (BGM1 event)
+void AudioController::playBGM1() {
+	if (!backend || events.bgm1 >= 0) return; // Already playing
+
+	// Create and start the music instance
+	events.bgm1 = createVoice("event:/BGM1");
+	if (events.bgm1 >= 0) {
+		bgm.started = true;
+		bgm.targetVolume = 0.6f; // Start at 60% volume
+	}
+}
+
+// Stops background music with fade-out
+void AudioController::stopBGM1() {
+	if (events.bgm1 >= 0) {
+		releaseVoice(events.bgm1, true); // Smooth fade
+		bgm.started = false;
+		bgm.filtered = false;
+	}
+}
+
+// Updates audio system every frame
+void AudioController::update(float deltaTime) {
+	if (!backend) return;
+
+	// Velocities are measured against the real frame time
+	emitters.advance(deltaTime);
+	frameDeltaTime = deltaTime;
+
+	// BGM volume control (smooth transitions)
+	if (bgm.started && events.bgm1 >= 0) {
+		float currentVolume = emitters.getVolume(events.bgm1);
+
+		// Smoothly adjust volume toward target
+		const float fadeSpeed = 0.2f; // How fast volume changes
+		const float volumeDelta = fadeSpeed * deltaTime;
+
+		if (currentVolume < bgm.targetVolume) {
+			currentVolume = min(currentVolume + volumeDelta, bgm.targetVolume);
+		}
+		else if (currentVolume > bgm.targetVolume) {
+			currentVolume = max(currentVolume - volumeDelta, bgm.targetVolume);
+		}
+
+		emitters.setVolume(events.bgm1, currentVolume);
+	}
+
+	// Restore BGM after dimming
+	if (bgm.dimmed) {
+		bgm.restoreTimer -= deltaTime;
+		if (bgm.restoreTimer <= 0.0f && bgm.targetVolume < 1.0f) {
+			bgm.targetVolume = 0.6f; // Return to normal volume
+
+			// Remove lowpass filter effect
+			if (bgm.filtered) {
+				backend->setDuckingFilter(emitters.getVoice(events.bgm1), false);
+				bgm.filtered = false;
+			}
+			bgm.dimmed = false;
+		}
+	}
+
+}
+
+// Pushes everything that changed this frame in one batch
+void AudioController::flush() {
+	if (!backend) return;
+
+	occlusion.update(emitters, frameDeltaTime);
+	emitters.flush(backend);
+	backend->update(); // Must be called every frame
+}
+
+// Plays a one-time sound effect
+void AudioController::playOneShot(const char* eventPath) {
+	if (backend) backend->playOneShot(eventPath);
+}
+
+// Temporarily lowers BGM volume (e.g., for dialogue)
+void AudioController::dimBGM(float duration, float targetVolume) {
+	if (!bgm.started || events.bgm1 < 0) return;
+
+	// Logarithmic scaling matches human hearing perception
+	bgm.targetVolume = log10(1 + 9 * targetVolume);
+	bgm.restoreTimer = duration;
+	bgm.dimmed = true;
+
+	// Make music sound "muffled"
+	if (!bgm.filtered) {
+		backend->setDuckingFilter(emitters.getVoice(events.bgm1), true);
+		bgm.filtered = true;
+	}
+}
+
+// Clean up all audio resources
+void AudioController::release() {
+	if (!backend) return;
+
+	// Release all sound events
+	releaseVoice(events.bgm1, false);
+	releaseVoice(events.heavyWhisper, false);
+	releaseVoice(events.girlWhisper, false);
+	stopAllIslandAmbience();
+	emitters.clear();
+	occlusion.clear();
+	bgm = BGM();
+
+	backend->release();
+	delete backend;
+	backend = nullptr;
+}
+
+// Plays a ghost whisper sound at 3D position
+void AudioController::playGhostWhisper(const AudioVector& position) {
+	if (!backend || events.girlWhisper >= 0) return; // Already playing
+
+	// Create 3D sound instance, facing forward
+	events.girlWhisper = createVoice("event:/GirlWhisper");
+	if (events.girlWhisper >= 0) {
+		emitters.setPosition(events.girlWhisper, position);
+		emitters.setVolume(events.girlWhisper, 0.3f); // Start volume
+
+		// Initialize ghost effect variables
+		ghostEffectIntensity = 0.0f;
+		ghostEffectTimer = 0.0f;
+		whisperRelativeVelocity = 0.0f;
+	}
+}
+
+// Stops ghost whisper with fade-out
+void AudioController::stopGhostWhisper() {
+	releaseVoice(events.girlWhisper, true);
+}
+
+// Updates ghost's 3D position; the table derives the Doppler velocity from the previous frame's position
+void AudioController::updateGhostPosition(const AudioVector& position) {
+	if (events.girlWhisper >= 0) emitters.setPosition(events.girlWhisper, position);
+}
+
+// Updates listener (player) position/orientation
+void AudioController::updateListenerPosition(const AudioVector& position, const AudioVector& forward, const AudioVector& up) {
+	if (!backend) return;
+
+	emitters.setListener(position, forward, up);
+}
+
+// Adjusts ghost whisper volume based on distance to listener
+void AudioController::updateGhostWhisperVolume(const AudioVector& listenerPosition) {
+	if (events.girlWhisper < 0) return;
+
+	// Calculate distance between ghost and listener
+	const AudioVector& ghostPosition = emitters.getPosition(events.girlWhisper);
+	AudioVector toListener(listenerPosition.x - ghostPosition.x,
+		listenerPosition.y - ghostPosition.y,
+		listenerPosition.z - ghostPosition.z);
+	float distance = audioDistance(listenerPosition, ghostPosition);
+	AudioVector direction = distance > 0.0f ?
+		AudioVector(toListener.x / distance, toListener.y / distance, toListener.z / distance) : AudioVector();
+
+	// Logarithmic volume fade (matches human hearing)
+	float volume = 1.0f - (log10(1 + distance) / log10(1 + WHISPER_FADE_RANGE));
+	volume = clampf(volume * (1.0f + ghostEffectIntensity * 0.3f), WHISPER_MIN_VOLUME, 1.2f);
+
+	// Adjust sound cone based on distance (narrower when close)
+	float coneInside, coneOutside;
+	if (distance < WHISPER_CLOSE_RANGE) {
+		coneInside = 30.0f;  // Narrow cone
+		coneOutside = 90.0f;
+	}
+	else if (distance < WHISPER_MID_RANGE) {
+		coneInside = 60.0f;
+		coneOutside = 150.0f;
+	}
+	else {
+		coneInside = 90.0f;  // Wide cone
+		coneOutside = 180.0f;
+	}
+	emitters.setCone(events.girlWhisper, direction, coneInside, coneOutside, 0.3f);
+
+	// Smooth Doppler effect (pitch change when moving)
+	const AudioVector& ghostVel = emitters.getVelocity(events.girlWhisper);
+	float relativeVelocity = ghostVel.x * direction.x + ghostVel.y * direction.y + ghostVel.z * direction.z;
+
+	// Low-pass filter for smoother changes
+	whisperRelativeVelocity = 0.8f * whisperRelativeVelocity + 0.2f * relativeVelocity;
+
+	// Adjust Doppler intensity (non-linear)
+	float dopplerLevel = 1.0f + 0.3f * tanh(whisperRelativeVelocity / 5.0f);
+	emitters.setDopplerLevel(events.girlWhisper, clampf(dopplerLevel, 0.8f, 1.2f));
+
+	// Wider sound spread when quieter
+	emitters.setSpread(events.girlWhisper, 180.0f * (1.0f - volume));
+
+	// Apply volume with perceptual correction
+	emitters.setVolume(events.girlWhisper, powf(volume, 0.6f));
+}
+
+// Updates ghost sound effects (pitch variations, etc.)
+void AudioController::updateGhostEffects(float deltaTime, const AudioVector& listenerPosition) {
+	if (events.girlWhisper < 0) return;
+
+	ghostEffectTimer += deltaTime;
+	if (ghostEffectTimer >= GHOST_EFFECT_INTERVAL) {
+		ghostEffectTimer = 0.0f;
+
+		// Get ghost position and distance to listener
+		float distance = audioDistance(listenerPosition, emitters.getPosition(events.girlWhisper));
+
+		// Adjust effects based on proximity
+		float proximityFactor = 1.0f - min(powf(distance / WHISPER_FADE_RANGE, 0.3f), 1.0f);
+
+		// Randomly apply effects (1 in 3 chance)
+		if (rand() % 3 == 0) {
+			// Small pitch variation (creates unnatural feel)
+			float pitch = 1.0f + ((rand() % 11) - 5) * 0.005f * proximityFactor;
+			emitters.setPitch(events.girlWhisper, pitch);
+
+			// Add temporary volume boost effect when very close
+			if (distance < WHISPER_CLOSE_RANGE * 1.5f) backend->addTransient(emitters.getVoice(events.girlWhisper), 2.0f);
+		}
+	}
+}
+
+// Sets intensity of ghost sound effects (0-1)
+void AudioController::setGhostEffectIntensity(float intensity) {
+	ghostEffectIntensity = clampf(intensity, 0.0f, 1.0f);
+}
+
+// Registers a virtual ambience emitter at island position; the event starts once it is promoted
+void AudioController::createIslandAmbience(const AudioVector& position) {
+	if (!backend) return;
+
+	IslandAmbience ambience;
+	ambience.position = position;
+	ambience.emitter = ambienceVoices.addEmitter(position, AMBIENCE_MAX_DISTANCE);
+	islandAmbiences.push_back(ambience);
+}
+
+// Creates and starts the real event instance for a promoted ambience
+void AudioController::startAmbienceVoice(IslandAmbience& ambience) {
+	if (ambience.voice >= 0) return;
+
+	ambience.voice = createVoice("event:/Ambience");
+	if (ambience.voice < 0) return;
+
+	// Position only needs setting once, islands do not move
+	emitters.setPosition(ambience.voice, ambience.position);
+	emitters.setVolume(ambience.voice, 0.0f); // Faded in by updateIslandAmbiences
+}
+
+// Re-ranks island ambiences around the listener and only touches the real voices
+void AudioController::updateIslandAmbiences(const AudioVector& listenerPos, int activeIslandIndex) {
+	if (!backend || islandAmbiences.empty()) return;
+
+	// Emitter ids match island indices since ambiences are only ever added in order and cleared together
+	ambienceVoices.update(listenerPos, promotedVoices, demotedVoices);
+
+	char buffer[64];
+	for (int id : demotedVoices) {
+		releaseVoice(islandAmbiences[id].voice, true);
+		snprintf(buffer, sizeof(buffer), "Island %d ambience: virtual\n", id);
+		debugLog(buffer);
+	}
+
+	for (int id : promotedVoices) {
+		startAmbienceVoice(islandAmbiences[id]);
+		snprintf(buffer, sizeof(buffer), "Island %d ambience: real\n", id);
+		debugLog(buffer);
+	}
+
+	for (int id : ambienceVoices.getRealVoices()) {
+		auto& ambience = islandAmbiences[id];
+		if (ambience.voice < 0) continue;
+
+		// Calculate horizontal distance (ignore height)
+		float distance = audioDistanceXZ(ambience.position, listenerPos);
+
+		// Calculate volume: full when close, fading with distance
+		float volume = 0.0f;
+		if (id == activeIslandIndex) {
+			if (distance < AMBIENCE_MIN_DISTANCE) {
+				volume = 1.0f; // Full volume
+			}
+			else if (distance < AMBIENCE_MAX_DISTANCE) {
+				// Linear fade between min and max distance
+				volume = 1.0f - ((distance - AMBIENCE_MIN_DISTANCE) /
+					(AMBIENCE_MAX_DISTANCE - AMBIENCE_MIN_DISTANCE));
+			}
+		}
+
+		emitters.setVolume(ambience.voice, volume);
+	}
+}
+
+// Stops all island ambience sounds
+void AudioController::stopAllIslandAmbience() {
+	for (auto& ambience : islandAmbiences) {
+		releaseVoice(ambience.voice, true);
+	}
+	islandAmbiences.clear();
+	ambienceVoices.clear();
+}
+
+// Islands and terrain that block sound between the listener and emitters
+void AudioController::setOcclusionGeometry(const AudioOcclusionGeometry& geometry) {
+	occlusion.setGeometry(geometry);
+}
+
+// Runs one queued AudioSystem call
+void AudioController::execute(const AudioCommand& command) {
+	typedef AudioCommand::Type Type;
+	switch (command.type) {
+	case Type::Update: update(command.values[0]); break;
+	case Type::Flush: flush(); break;
+	case Type::PlayBGM1: playBGM1(); break;
+	case Type::StopBGM1: stopBGM1(); break;
+	case Type::PlayOneShot: playOneShot(command.eventPath); break;
+	case Type::DimBGM: dimBGM(command.values[0], command.values[1]); break;
+	case Type::PlayGhostWhisper: playGhostWhisper(command.vectors[0]); break;
+	case Type::StopGhostWhisper: stopGhostWhisper(); break;
+	case Type::UpdateGhostPosition: updateGhostPosition(command.vectors[0]); break;
+	case Type::UpdateGhostWhisperVolume: updateGhostWhisperVolume(command.vectors[0]); break;
+	case Type::UpdateGhostEffects: updateGhostEffects(command.values[0], command.vectors[0]); break;
+	case Type::SetGhostEffectIntensity: setGhostEffectIntensity(command.values[0]); break;
+	case Type::UpdateListener: updateListenerPosition(command.vectors[0], command.vectors[1], command.vectors[2]); break;
+	case Type::CreateIslandAmbience: createIslandAmbience(command.vectors[0]); break;
+	case Type::UpdateIslandAmbiences: updateIslandAmbiences(command.vectors[0], command.index); break;
+	case Type::StopAllIslandAmbience: stopAllIslandAmbience(); break;
+	case Type::SetOcclusionGeometry:
+		if (command.geometry) setOcclusionGeometry(*command.geometry);
+		delete command.geometry;
+		break;
+	}
+}
+
+void AudioController::fillSnapshot(AudioSnapshot& snapshot) const {
+	snapshot.whisperPlaying = isWhisperPlaying();
+	snapshot.bgmPlaying = bgm.started;
+	snapshot.bgmDimmed = bgm.dimmed;
+	snapshot.bgmVolume = events.bgm1 >= 0 ? emitters.getVolume(events.bgm1) : 0.0f;
+	snapshot.realAmbienceVoices = (int)ambienceVoices.getRealVoices().size();
+	snapshot.activeEmitters = emitters.size();
+	snapshot.occlusionRays = occlusion.getLastRayCount();
+}
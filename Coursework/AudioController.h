@@ -0,0 +1,156 @@
+#pragma once
+#include "AudioBackend.h"
+#include "AudioEmitterTable.h"
+#include "AudioOcclusion.h"
+#include "AudioVoiceManager.h"
+#include <algorithm>
+#include <random>
+
+using namespace std;
+
+// One game-side AudioSystem call, queued for the audio thread
+struct AudioCommand {
+	enum class Type : uint8_t {
+		Update, Flush,
+		PlayBGM1, StopBGM1, PlayOneShot, DimBGM,
+		PlayGhostWhisper, StopGhostWhisper, UpdateGhostPosition, UpdateGhostWhisperVolume, UpdateGhostEffects, SetGhostEffectIntensity,
+		UpdateListener,
+		CreateIslandAmbience, UpdateIslandAmbiences, StopAllIslandAmbience,
+		SetOcclusionGeometry
+	};
+
+	static constexpr size_t MAX_EVENT_PATH = 48;
+
+	Type type;
+	int index = 0;
+	float values[2] = {};
+	AudioVector vectors[3];
+	char eventPath[MAX_EVENT_PATH] = {};	// Fixed size so queueing never allocates
+	AudioOcclusionGeometry* geometry = nullptr;	// SetOcclusionGeometry only; the controller deletes it
+};
+
+// State published back to the game after each flush
+struct AudioSnapshot {
+	unsigned int frame = 0;	// Flushes completed
+	bool whisperPlaying = false;
+	bool bgmPlaying = false;
+	bool bgmDimmed = false;
+	float bgmVolume = 0.0f;
+	int realAmbienceVoices = 0;
+	size_t activeEmitters = 0;
+	int occlusionRays = 0;	// Cast during the last flush
+	float frameTime = 0.0f;	// Seconds the audio thread spent on the last frame's commands (0 inline)
+};
+
+// BGM and ducking, the ghost whisper, island ambiences and the listener. Runs on the audio thread behind AudioSystem
+// (or inline). All sound engine calls go through an AudioBackend, so this builds and runs without FMOD. Voice state
+// is kept in an AudioEmitterTable and pushed once per frame by flush().
+class AudioController {
+public:
+	AudioController() = default;
+	~AudioController() { release(); }
+
+	// BGM management
+	struct BGM {
+		bool started = false;
+		bool dimmed = false;
+		bool filtered = false;	// Ducking filter applied to the BGM voice
+		float targetVolume = 1.0f;
+		float restoreTimer = 0.0f;
+	} bgm;
+
+	// Event instances, as emitter table ids (-1 when not playing)
+	struct EventInstances {
+		int bgm1 = -1;
+		int heavyWhisper = -1;
+		int girlWhisper = -1;
+	} events;
+
+	// Every island keeps a virtual emitter; only the closest few hold a real event instance
+	struct IslandAmbience {
+		int voice = -1;	// Emitter table id while real, -1 while virtual
+		AudioVector position;
+		int emitter = -1;	// AudioVoiceManager id
+	};
+
+	vector<IslandAmbience> islandAmbiences;
+	AudioVoiceManager ambienceVoices;
+
+	// Check
+	bool ghostAudioPlaying = false;
+	bool isWhisperPlaying() const { return events.girlWhisper >= 0; }
+	AudioBackend* getBackend() const { return backend; }
+	const AudioEmitterTable& getEmitters() const { return emitters; }
+	AudioOcclusion& getOcclusion() { return occlusion; }
+
+	void execute(const AudioCommand& command);
+	void fillSnapshot(AudioSnapshot& snapshot) const;
+
+	// Methods
+	bool init(AudioBackend* audioBackend);	// Takes ownership of the backend, even on failure
+	void release();
+	void playBGM1();
+	void stopBGM1();
+	void update(float deltaTime);	// Start of frame
+	void flush();	// End of frame: pushes the frame's changes to the backend
+	void playOneShot(const char* eventPath);
+	void dimBGM(float duration, float targetVolume = 0.3f);
+
+	void playGhostWhisper(const AudioVector& position);
+	void stopGhostWhisper();
+	void updateGhostPosition(const AudioVector& position);
+
+	void updateListenerPosition(const AudioVector& position, const AudioVector& forward, const AudioVector& up);
+	void updateGhostWhisperVolume(const AudioVector& listenerPosition);
+
+	void updateGhostEffects(float deltaTime, const AudioVector& listenerPosition);
+	void setGhostEffectIntensity(float intensity);  // 0.0f to 1.0f
+
+	void createIslandAmbience(const AudioVector& position);
+	void updateIslandAmbiences(const AudioVector& listenerPos, int activeIslandIndex);
+	void stopAllIslandAmbience();
+
+	void setOcclusionGeometry(const AudioOcclusionGeometry& geometry);
+
+private:
+	AudioBackend* backend = nullptr;
+	AudioEmitterTable emitters;
+	AudioOcclusion occlusion;	// Drives each emitter's low-pass from the island and terrain geometry
+	float frameDeltaTime = 0.0f;
+
+	// Ghost effect parameters
+	float ghostEffectIntensity = 0.0f;
+	float ghostEffectTimer = 0.0f;
+	float whisperRelativeVelocity = 0.0f;	// Smoothed, for the Doppler level
+
+	static constexpr float BGM_DIM_VOLUME = 0.3f;
+
+	static constexpr float MIN_WHISPER_VOLUME = 0.1f;
+	static constexpr float MAX_WHISPER_VOLUME = 1.f;
+
+	static constexpr float WHISPER_CLOSE_RANGE = 20.0f;  // Very close range (intimate)
+	static constexpr float WHISPER_MID_RANGE = 35.0f;    // Medium range
+	static constexpr float WHISPER_FAR_RANGE = 45.0f;    // Far range
+	static constexpr float WHISPER_FADE_RANGE = 50.0f;   // Complete fade-out beyond this
+
+	static constexpr float WHISPER_CLOSE_VOLUME = 1.0f;  // Full volume when very close
+	static constexpr float WHISPER_MID_VOLUME = 0.6f;    // Medium volume
+	static constexpr float WHISPER_FAR_VOLUME = 0.2f;    // Quiet when far
+	static constexpr float WHISPER_MIN_VOLUME = 0.0f;    // Minimum volume before mute
+
+	static constexpr float AMBIENCE_MIN_DISTANCE = 55.0f;
+	static constexpr float AMBIENCE_MAX_DISTANCE = 70.0f;
+	static constexpr float AMBIENCE_CUTOFF_DISTANCE = 60.0f;
+	static constexpr int MAX_AMBIENCE_VOICES = 4;
+
+	static constexpr float BGM_DUCKING_RATIO = 0.7f; // 30% volume reduction when ducking
+	static constexpr float AMBIENCE_LFO_RATE = 0.2f; // Slow modulation for natural feel
+	static constexpr float SPATIAL_BLEND_FACTOR = 0.9f; // Emphasize 3D positioning
+
+	static constexpr float GHOST_EFFECT_INTERVAL = 1.5f;
+
+	int createVoice(const string& eventPath);	// Emitter id, or -1; starts on the next flush
+	void releaseVoice(int& id, bool allowFadeOut);
+	void startAmbienceVoice(IslandAmbience& ambience);
+	vector<int> promotedVoices, demotedVoices;	// Reused every update
+};
@@ -0,0 +1,293 @@
+#include "AudioDSP.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace AudioDSP {
+
+	static constexpr float PI = 3.14159265358979f;
+
+	float coefficientForCutoff(float cutoffHz, float sampleRate) {
+		if (cutoffHz >= sampleRate * 0.5f) return 0.0f;	// Fully open
+		return expf(-2.0f * PI * cutoffHz / sampleRate);
+	}
+
+	float coefficientForTime(float seconds, float sampleRate) {
+		if (seconds <= 0.0f) return 0.0f;
+		return expf(-1.0f / (seconds * sampleRate));
+	}
+
+	bool hasSimd() {
+#ifdef SIMD_MATH_SSE
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	// Polynomial log2/exp2 good to about 1e-4, shared by both paths so they agree to rounding
+	static inline float fastLog2(float x) {
+		uint32_t bits;
+		memcpy(&bits, &x, sizeof(bits));
+		const float exponent = (float)((int)((bits >> 23) & 255) - 127);
+		bits = (bits & 0x007FFFFF) | 0x3F800000;
+		float m;
+		memcpy(&m, &bits, sizeof(m));
+		return exponent + (-1.7417939f + (2.8212026f + (-1.4699568f + (0.44717955f - 0.056570851f * m) * m) * m) * m);
+	}
+
+	static inline float fastExp2(float x) {
+		x = x < -126.0f ? -126.0f : (x > 126.0f ? 126.0f : x);
+		const float whole = floorf(x);
+		const float f = x - whole;
+		const float poly = 1.0f + f * (0.6931472f + f * (0.2402265f + f * (0.0555041f + f * 0.0096181f)));
+		const uint32_t bits = (uint32_t)((int)whole + 127) << 23;
+		float scale;
+		memcpy(&scale, &bits, sizeof(scale));
+		return scale * poly;
+	}
+
+#ifdef SIMD_MATH_SSE
+	static inline __m128 fastLog2(__m128 x) {
+		const __m128i bits = _mm_castps_si128(x);
+		const __m128 exponent = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_and_si128(_mm_srli_epi32(bits, 23), _mm_set1_epi32(255)), _mm_set1_epi32(127)));
+		const __m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF)), _mm_set1_epi32(0x3F800000)));
+
+		__m128 p = _mm_sub_ps(_mm_set1_ps(0.44717955f), _mm_mul_ps(_mm_set1_ps(0.056570851f), m));
+		p = _mm_add_ps(_mm_set1_ps(-1.4699568f), _mm_mul_ps(p, m));
+		p = _mm_add_ps(_mm_set1_ps(2.8212026f), _mm_mul_ps(p, m));
+		p = _mm_add_ps(_mm_set1_ps(-1.7417939f), _mm_mul_ps(p, m));
+		return _mm_add_ps(exponent, p);
+	}
+
+	static inline __m128 fastExp2(__m128 x) {
+		x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-126.0f)), _mm_set1_ps(126.0f));
+
+		// Floor: truncate, then step down where truncation rounded a negative value up
+		__m128i whole = _mm_cvttps_epi32(x);
+		__m128 wholeF = _mm_cvtepi32_ps(whole);
+		const __m128 roundedUp = _mm_cmpgt_ps(wholeF, x);
+		whole = _mm_add_epi32(whole, _mm_castps_si128(roundedUp));	// Mask is -1 where set
+		wholeF = _mm_sub_ps(wholeF, _mm_and_ps(roundedUp, _mm_set1_ps(1.0f)));
+
+		const __m128 f = _mm_sub_ps(x, wholeF);
+		__m128 p = _mm_add_ps(_mm_set1_ps(0.0555041f), _mm_mul_ps(f, _mm_set1_ps(0.0096181f)));
+		p = _mm_add_ps(_mm_set1_ps(0.2402265f), _mm_mul_ps(f, p));
+		p = _mm_add_ps(_mm_set1_ps(0.6931472f), _mm_mul_ps(f, p));
+		p = _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(f, p));
+
+		const __m128 scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(whole, _mm_set1_epi32(127)), 23));
+		return _mm_mul_ps(scale, p);
+	}
+
+	static inline __m128 load(const float* lanes) { return _mm_loadu_ps(lanes); }
+	static inline void store(float* lanes, __m128 v) { _mm_storeu_ps(lanes, v); }
+#endif
+
+	void lowpass(float* lanes, size_t frames, LowpassLanes& filter, bool simd) {
+#ifdef SIMD_MATH_SSE
+		if (simd) {
+			const __m128 blend = _mm_sub_ps(_mm_set1_ps(1.0f), load(filter.coefficient));
+			__m128 y = load(filter.state);
+			for (size_t f = 0; f < frames; f++) {
+				const __m128 x = _mm_load_ps(lanes + f * LANES);
+				y = _mm_add_ps(y, _mm_mul_ps(blend, _mm_sub_ps(x, y)));
+				_mm_store_ps(lanes + f * LANES, y);
+			}
+			store(filter.state, y);
+			return;
+		}
+#endif
+		for (int l = 0; l < LANES; l++) {
+			const float blend = 1.0f - filter.coefficient[l];
+			float y = filter.state[l];
+			for (size_t f = 0; f < frames; f++) {
+				float& x = lanes[f * LANES + l];
+				y += blend * (x - y);
+				x = y;
+			}
+			filter.state[l] = y;
+		}
+	}
+
+	void equalise(float* lanes, size_t frames, EQLanes& eq, bool simd) {
+#ifdef SIMD_MATH_SSE
+		if (simd) {
+			const __m128 one = _mm_set1_ps(1.0f);
+			const __m128 lowBlend = _mm_sub_ps(one, load(eq.lowCoefficient));
+			const __m128 highBlend = _mm_sub_ps(one, load(eq.highCoefficient));
+			const __m128 lowGain = load(eq.lowGain), midGain = load(eq.midGain), highGain = load(eq.highGain);
+			__m128 low = load(eq.lowState), belowHigh = load(eq.highState);
+
+			for (size_t f = 0; f < frames; f++) {
+				const __m128 x = _mm_load_ps(lanes + f * LANES);
+				low = _mm_add_ps(low, _mm_mul_ps(lowBlend, _mm_sub_ps(x, low)));
+				belowHigh = _mm_add_ps(belowHigh, _mm_mul_ps(highBlend, _mm_sub_ps(x, belowHigh)));
+
+				const __m128 mid = _mm_sub_ps(belowHigh, low);
+				const __m128 high = _mm_sub_ps(x, belowHigh);
+				const __m128 y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(lowGain, low), _mm_mul_ps(midGain, mid)), _mm_mul_ps(highGain, high));
+				_mm_store_ps(lanes + f * LANES, y);
+			}
+			store(eq.lowState, low);
+			store(eq.highState, belowHigh);
+			return;
+		}
+#endif
+		for (int l = 0; l < LANES; l++) {
+			const float lowBlend = 1.0f - eq.lowCoefficient[l];
+			const float highBlend = 1.0f - eq.highCoefficient[l];
+			float low = eq.lowState[l], belowHigh = eq.highState[l];
+			for (size_t f = 0; f < frames; f++) {
+				float& x = lanes[f * LANES + l];
+				low += lowBlend * (x - low);
+				belowHigh += highBlend * (x - belowHigh);
+				x = eq.lowGain[l] * low + eq.midGain[l] * (belowHigh - low) + eq.highGain[l] * (x - belowHigh);
+			}
+			eq.lowState[l] = low;
+			eq.highState[l] = belowHigh;
+		}
+	}
+
+	void compress(float* lanes, size_t frames, CompressorLanes& compressor, bool simd) {
+		static const float MIN_LEVEL = 1e-9f;	// Keeps log2 finite on silence
+
+#ifdef SIMD_MATH_SSE
+		if (simd) {
+			const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+			const __m128 threshold = load(compressor.thresholdLog2);
+			const __m128 slope = load(compressor.slope);
+			const __m128 attack = load(compressor.attack), release = load(compressor.release);
+			const __m128 makeup = load(compressor.makeup);
+			const __m128 minLevel = _mm_set1_ps(MIN_LEVEL);
+			__m128 envelope = load(compressor.envelope);
+
+			for (size_t f = 0; f < frames; f++) {
+				const __m128 x = _mm_load_ps(lanes + f * LANES);
+				const __m128 level = _mm_and_ps(x, absMask);
+
+				// Attack while rising, release while falling
+				const __m128 rising = _mm_cmpgt_ps(level, envelope);
+				const __m128 coefficient = _mm_or_ps(_mm_and_ps(rising, attack), _mm_andnot_ps(rising, release));
+				envelope = _mm_add_ps(level, _mm_mul_ps(coefficient, _mm_sub_ps(envelope, level)));
+
+				// Gain reduction in the log domain; below threshold the min clamps it to 0 dB
+				const __m128 over = _mm_sub_ps(fastLog2(_mm_max_ps(envelope, minLevel)), threshold);
+				const __m128 reduction = _mm_min_ps(_mm_setzero_ps(), _mm_mul_ps(_mm_sub_ps(_mm_setzero_ps(), over), slope));
+				_mm_store_ps(lanes + f * LANES, _mm_mul_ps(x, _mm_mul_ps(fastExp2(reduction), makeup)));
+			}
+			store(compressor.envelope, envelope);
+			return;
+		}
+#endif
+		for (int l = 0; l < LANES; l++) {
+			float envelope = compressor.envelope[l];
+			for (size_t f = 0; f < frames; f++) {
+				float& x = lanes[f * LANES + l];
+				const float level = fabsf(x);
+				const float coefficient = level > envelope ? compressor.attack[l] : compressor.release[l];
+				envelope = level + coefficient * (envelope - level);
+
+				const float over = fastLog2(envelope > MIN_LEVEL ? envelope : MIN_LEVEL) - compressor.thresholdLog2[l];
+				const float reduction = -over * compressor.slope[l];
+				x *= fastExp2(reduction < 0.0f ? reduction : 0.0f) * compressor.makeup[l];
+			}
+			compressor.envelope[l] = envelope;
+		}
+	}
+
+	void applyGain(float* lanes, size_t frames, const GainLanes& gain, bool simd) {
+		if (frames == 0) return;
+		const float inverse = 1.0f / (float)frames;
+
+#ifdef SIMD_MATH_SSE
+		if (simd) {
+			const __m128 start = load(gain.start);
+			const __m128 step = _mm_mul_ps(_mm_sub_ps(load(gain.end), start), _mm_set1_ps(inverse));
+			__m128 g = start;
+			for (size_t f = 0; f < frames; f++) {
+				g = _mm_add_ps(g, step);
+				_mm_store_ps(lanes + f * LANES, _mm_mul_ps(_mm_load_ps(lanes + f * LANES), g));
+			}
+			return;
+		}
+#endif
+		for (int l = 0; l < LANES; l++) {
+			const float step = (gain.end[l] - gain.start[l]) * inverse;
+			float g = gain.start[l];
+			for (size_t f = 0; f < frames; f++) {
+				g += step;
+				lanes[f * LANES + l] *= g;
+			}
+		}
+	}
+
+	void mixToStereo(const float* lanes, size_t frames, const GainLanes& left, const GainLanes& right, float* stereo, bool simd) {
+		if (frames == 0) return;
+		const float inverse = 1.0f / (float)frames;
+		size_t f = 0;
+
+#ifdef SIMD_MATH_SSE
+		if (simd) {
+			const __m128 stepL = _mm_mul_ps(_mm_sub_ps(load(left.end), load(left.start)), _mm_set1_ps(inverse));
+			const __m128 stepR = _mm_mul_ps(_mm_sub_ps(load(right.end), load(right.start)), _mm_set1_ps(inverse));
+			__m128 gL = load(left.start), gR = load(right.start);
+
+			// Four frames at a time: scale each frame's lanes, transpose so each register holds one lane across
+			// the four frames, then a vertical add gives four summed output frames
+			for (; f + 4 <= frames; f += 4) {
+				__m128 l0, l1, l2, l3, r0, r1, r2, r3;
+				__m128 x;
+				x = _mm_load_ps(lanes + (f + 0) * LANES); gL = _mm_add_ps(gL, stepL); gR = _mm_add_ps(gR, stepR); l0 = _mm_mul_ps(x, gL); r0 = _mm_mul_ps(x, gR);
+				x = _mm_load_ps(lanes + (f + 1) * LANES); gL = _mm_add_ps(gL, stepL); gR = _mm_add_ps(gR, stepR); l1 = _mm_mul_ps(x, gL); r1 = _mm_mul_ps(x, gR);
+				x = _mm_load_ps(lanes + (f + 2) * LANES); gL = _mm_add_ps(gL, stepL); gR = _mm_add_ps(gR, stepR); l2 = _mm_mul_ps(x, gL); r2 = _mm_mul_ps(x, gR);
+				x = _mm_load_ps(lanes + (f + 3) * LANES); gL = _mm_add_ps(gL, stepL); gR = _mm_add_ps(gR, stepR); l3 = _mm_mul_ps(x, gL); r3 = _mm_mul_ps(x, gR);
+
+				_MM_TRANSPOSE4_PS(l0, l1, l2, l3);
+				_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+				const __m128 sumL = _mm_add_ps(_mm_add_ps(l0, l1), _mm_add_ps(l2, l3));
+				const __m128 sumR = _mm_add_ps(_mm_add_ps(r0, r1), _mm_add_ps(r2, r3));
+
+				float* out = stereo + f * 2;
+				_mm_storeu_ps(out, _mm_add_ps(_mm_loadu_ps(out), _mm_unpacklo_ps(sumL, sumR)));
+				_mm_storeu_ps(out + 4, _mm_add_ps(_mm_loadu_ps(out + 4), _mm_unpackhi_ps(sumL, sumR)));
+			}
+
+			// Tail frames continue the same ramp
+			float gainL[LANES], gainR[LANES];
+			store(gainL, gL);
+			store(gainR, gR);
+			for (; f < frames; f++) {
+				for (int l = 0; l < LANES; l++) {
+					gainL[l] += (left.end[l] - left.start[l]) * inverse;
+					gainR[l] += (right.end[l] - right.start[l]) * inverse;
+					stereo[f * 2] += lanes[f * LANES + l] * gainL[l];
+					stereo[f * 2 + 1] += lanes[f * LANES + l] * gainR[l];
+				}
+			}
+			return;
+		}
+#endif
+		for (; f < frames; f++) {
+			const float t = (float)(f + 1) * inverse;
+			for (int l = 0; l < LANES; l++) {
+				const float x = lanes[f * LANES + l];
+				stereo[f * 2] += x * (left.start[l] + (left.end[l] - left.start[l]) * t);
+				stereo[f * 2 + 1] += x * (right.start[l] + (right.end[l] - right.start[l]) * t);
+			}
+		}
+	}
+
+	void interpolate(const float* a, const float* b, const float* t, float* out, size_t count, bool simd) {
+		size_t i = 0;
+#ifdef SIMD_MATH_SSE
+		if (simd) {
+			for (; i + 4 <= count; i += 4) {
+				const __m128 va = _mm_loadu_ps(a + i);
+				_mm_storeu_ps(out + i, _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(b + i), va), _mm_loadu_ps(t + i))));
+			}
+		}
+#endif
+		for (; i < count; i++) out[i] = a[i] + (b[i] - a[i]) * t[i];
+	}
+}
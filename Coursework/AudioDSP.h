@@ -0,0 +1,56 @@
+#pragma once
+// Block DSP for SoftwareMixerBackend. Voices are processed four at a time, one per SIMD lane, with samples
+// interleaved by lane (frame f of lane l lives at lanes[f * 4 + l]). Recursive filters cannot be vectorised
+// over time, but across voices every lane runs the same instruction stream. Each stage has an SSE path and a
+// scalar reference; the scalar one is used when SSE is unavailable or when asked for, to check the SSE output.
+
+#include "SimdMath.h"
+#include <cstddef>
+
+namespace AudioDSP {
+
+	static constexpr int LANES = 4;
+
+	// One-pole low-pass: y += (1 - a) * (x - y)
+	struct LowpassLanes {
+		float coefficient[LANES];	// a = exp(-2 pi fc / fs)
+		float state[LANES];
+	};
+
+	// Low band below the low crossover, high band above the high crossover, mid is what is left
+	struct EQLanes {
+		float lowCoefficient[LANES], highCoefficient[LANES];
+		float lowGain[LANES], midGain[LANES], highGain[LANES];
+		float lowState[LANES], highState[LANES];
+	};
+
+	// Feed-forward peak compressor; ratio 1 leaves a lane untouched
+	struct CompressorLanes {
+		float thresholdLog2[LANES];	// log2 of the linear threshold
+		float slope[LANES];	// 1 - 1 / ratio
+		float attack[LANES], release[LANES];	// Envelope coefficients
+		float makeup[LANES];
+		float envelope[LANES];
+	};
+
+	// Linear ramps from start to end over the block, which keeps block-rate changes free of zipper noise
+	struct GainLanes {
+		float start[LANES], end[LANES];
+	};
+
+	float coefficientForCutoff(float cutoffHz, float sampleRate);
+	float coefficientForTime(float seconds, float sampleRate);	// Envelope follower, reaching ~63% in `seconds`
+
+	void lowpass(float* lanes, size_t frames, LowpassLanes& filter, bool simd);
+	void equalise(float* lanes, size_t frames, EQLanes& eq, bool simd);
+	void compress(float* lanes, size_t frames, CompressorLanes& compressor, bool simd);
+	void applyGain(float* lanes, size_t frames, const GainLanes& gain, bool simd);
+
+	// Sums the four lanes into interleaved stereo, each lane with its own ramped left/right gain
+	void mixToStereo(const float* lanes, size_t frames, const GainLanes& left, const GainLanes& right, float* stereo, bool simd);
+
+	// Linear-interpolation lerp of gathered sample pairs: out = a + (b - a) * t, for frames * LANES values
+	void interpolate(const float* a, const float* b, const float* t, float* out, size_t count, bool simd);
+
+	bool hasSimd();
+}
@@ -0,0 +1,188 @@
+#include "AudioEmitterTable.h"
+#include <cmath>
+
+static bool sameVector(const AudioVector& a, const AudioVector& b) {
+	return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+// Cone directions within about a degree are treated as unchanged
+static bool sameDirection(const AudioVector& a, const AudioVector& b) {
+	return a.x * b.x + a.y * b.y + a.z * b.z > 0.99985f;
+}
+
+// Volume-like values closer than this are not worth a backend call
+static bool changed(float current, float next) {
+	return fabsf(current - next) > 1e-4f;
+}
+
+int AudioEmitterTable::add(AudioVoice voice) {
+	int id;
+	if (!freeIds.empty()) {
+		id = freeIds.back();
+		freeIds.pop_back();
+	}
+	else {
+		id = (int)emitters.size();
+		emitters.emplace_back();
+	}
+
+	Emitter& emitter = emitters[id];
+	emitter = Emitter();
+	emitter.voice = voice;
+	emitter.alive = true;
+	emitter.dirty = PendingStart;
+	liveCount++;
+	return id;
+}
+
+void AudioEmitterTable::remove(int id) {
+	if (!isValid(id)) return;
+
+	emitters[id].alive = false;
+	emitters[id].voice = 0;
+	freeIds.push_back(id);
+	liveCount--;
+}
+
+void AudioEmitterTable::clear() {
+	emitters.clear();
+	freeIds.clear();
+	liveCount = 0;
+}
+
+bool AudioEmitterTable::track(Tracked& tracked, const AudioVector& position) {
+	AudioAttributes3D& attributes = tracked.attributes;
+	const AudioVector oldPosition = attributes.position;
+	const AudioVector oldVelocity = attributes.velocity;
+	const double elapsed = time - tracked.sampleTime;
+
+	if (!tracked.sampled) {
+		tracked.previousPosition = position;
+		attributes.velocity = AudioVector();
+	}
+	else if (elapsed > 0.0) {
+		const float inverse = (float)(1.0 / elapsed);
+		tracked.previousPosition = oldPosition;
+		attributes.velocity = AudioVector((position.x - oldPosition.x) * inverse,
+			(position.y - oldPosition.y) * inverse,
+			(position.z - oldPosition.z) * inverse);
+	}
+	// A second sample within the same frame only moves the position; velocity needs elapsed time
+
+	const bool moved = !tracked.sampled || !sameVector(position, oldPosition) || !sameVector(oldVelocity, attributes.velocity);
+	attributes.position = position;
+	tracked.sampleTime = time;
+	tracked.sampled = true;
+	return moved;
+}
+
+void AudioEmitterTable::setPosition(int id, const AudioVector& position) {
+	if (!isValid(id)) return;
+	if (track(emitters[id], position)) emitters[id].dirty |= DirtyAttributes;
+}
+
+void AudioEmitterTable::setOrientation(int id, const AudioVector& forward, const AudioVector& up) {
+	if (!isValid(id)) return;
+
+	AudioAttributes3D& attributes = emitters[id].attributes;
+	if (sameVector(attributes.forward, forward) && sameVector(attributes.up, up)) return;
+	attributes.forward = forward;
+	attributes.up = up;
+	emitters[id].dirty |= DirtyAttributes;
+}
+
+void AudioEmitterTable::setVolume(int id, float volume) {
+	if (!isValid(id) || !changed(emitters[id].volume, volume)) return;
+	emitters[id].volume = volume;
+	emitters[id].dirty |= DirtyVolume;
+}
+
+void AudioEmitterTable::setPitch(int id, float pitch) {
+	if (!isValid(id) || !changed(emitters[id].pitch, pitch)) return;
+	emitters[id].pitch = pitch;
+	emitters[id].dirty |= DirtyPitch;
+}
+
+void AudioEmitterTable::setDopplerLevel(int id, float level) {
+	if (!isValid(id) || !changed(emitters[id].dopplerLevel, level)) return;
+	emitters[id].dopplerLevel = level;
+	emitters[id].dirty |= DirtyDoppler;
+}
+
+// Spread is in degrees, so a coarser threshold
+void AudioEmitterTable::setSpread(int id, float degrees) {
+	if (!isValid(id) || fabsf(emitters[id].spread - degrees) <= 0.05f) return;
+	emitters[id].spread = degrees;
+	emitters[id].dirty |= DirtySpread;
+}
+
+void AudioEmitterTable::setCone(int id, const AudioVector& direction, float insideAngle, float outsideAngle, float outsideVolume) {
+	if (!isValid(id)) return;
+
+	Emitter& emitter = emitters[id];
+	if (sameDirection(emitter.coneDirection, direction) && emitter.coneInside == insideAngle &&
+		emitter.coneOutside == outsideAngle && emitter.coneOutsideVolume == outsideVolume) return;
+
+	emitter.coneDirection = direction;
+	emitter.coneInside = insideAngle;
+	emitter.coneOutside = outsideAngle;
+	emitter.coneOutsideVolume = outsideVolume;
+	emitter.dirty |= DirtyCone;
+}
+
+// Cutoffs within 1% sound the same
+void AudioEmitterTable::setLowpass(int id, float cutoffHz) {
+	if (!isValid(id) || fabsf(emitters[id].lowpass - cutoffHz) <= emitters[id].lowpass * 0.01f) return;
+	emitters[id].lowpass = cutoffHz;
+	emitters[id].dirty |= DirtyLowpass;
+}
+
+void AudioEmitterTable::setListener(const AudioVector& position, const AudioVector& forward, const AudioVector& up) {
+	if (track(listener, position)) listenerDirty = true;
+
+	AudioAttributes3D& attributes = listener.attributes;
+	if (!sameVector(attributes.forward, forward) || !sameVector(attributes.up, up)) {
+		attributes.forward = forward;
+		attributes.up = up;
+		listenerDirty = true;
+	}
+}
+
+size_t AudioEmitterTable::flush(AudioBackend* backend) {
+	if (!backend) return 0;
+
+	size_t calls = 0;
+	if (listenerDirty) {
+		backend->setListener(listener.attributes);
+		listenerDirty = false;
+		calls++;
+	}
+
+	for (Emitter& emitter : emitters) {
+		if (!emitter.alive || !emitter.dirty) continue;
+
+		const uint8_t dirty = emitter.dirty;
+		emitter.dirty = 0;
+
+		// New voices get their full state before they start, so they never play a frame at the origin
+		if (dirty & PendingStart) {
+			if (emitter.sampled) backend->set3DAttributes(emitter.voice, emitter.attributes);
+			backend->setVolume(emitter.voice, emitter.volume);
+			calls += 2;
+		}
+		else {
+			if (dirty & DirtyAttributes) { backend->set3DAttributes(emitter.voice, emitter.attributes); calls++; }
+			if (dirty & DirtyVolume) { backend->setVolume(emitter.voice, emitter.volume); calls++; }
+		}
+		if (dirty & DirtyPitch) { backend->setPitch(emitter.voice, emitter.pitch); calls++; }
+		if (dirty & DirtyDoppler) { backend->setDopplerLevel(emitter.voice, emitter.dopplerLevel); calls++; }
+		if (dirty & DirtySpread) { backend->setSpread(emitter.voice, emitter.spread); calls++; }
+		if (dirty & DirtyCone) {
+			backend->setCone(emitter.voice, emitter.coneDirection, emitter.coneInside, emitter.coneOutside, emitter.coneOutsideVolume);
+			calls++;
+		}
+		if (dirty & DirtyLowpass) { backend->setLowpass(emitter.voice, emitter.lowpass); calls++; }
+		if (dirty & PendingStart) { backend->startVoice(emitter.voice); calls++; }
+	}
+	return calls;
+}
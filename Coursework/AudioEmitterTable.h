@@ -0,0 +1,89 @@
+#pragma once
+#include "AudioBackend.h"
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// CPU-side copy of every voice's 3D and mix state. Game code writes here during the frame; flush() then pushes
+// only what changed to the backend in one pass, so nothing is read back from the sound engine.
+// Velocities come from the previous position and the real time between samples, not an assumed frame rate.
+class AudioEmitterTable {
+public:
+	int add(AudioVoice voice);	// New emitter starts its voice on the next flush, after its state is pushed
+	void remove(int id);
+	void clear();
+
+	void advance(float deltaTime) { time += deltaTime; }	// Once per frame, before any positions are set
+
+	void setPosition(int id, const AudioVector& position);
+	void setOrientation(int id, const AudioVector& forward, const AudioVector& up);
+	void setVolume(int id, float volume);
+	void setPitch(int id, float pitch);
+	void setDopplerLevel(int id, float level);
+	void setSpread(int id, float degrees);
+	void setCone(int id, const AudioVector& direction, float insideAngle, float outsideAngle, float outsideVolume);
+	void setLowpass(int id, float cutoffHz);
+
+	void setListener(const AudioVector& position, const AudioVector& forward, const AudioVector& up);
+
+	AudioVoice getVoice(int id) const { return isValid(id) ? emitters[id].voice : 0; }
+	const AudioVector& getPosition(int id) const { return emitters[id].attributes.position; }
+	const AudioVector& getPreviousPosition(int id) const { return emitters[id].previousPosition; }
+	const AudioVector& getVelocity(int id) const { return emitters[id].attributes.velocity; }
+	float getVolume(int id) const { return isValid(id) ? emitters[id].volume : 0.0f; }
+	float getLowpass(int id) const { return isValid(id) ? emitters[id].lowpass : 0.0f; }
+	bool isAudible(int id) const { return isValid(id) && emitters[id].sampled && emitters[id].volume > 0.0f; }	// Positioned and not silent
+	const AudioAttributes3D& getListener() const { return listener.attributes; }
+
+	// Pushes changed state for every emitter and the listener. Returns the number of backend calls made.
+	size_t flush(AudioBackend* backend);
+
+	size_t size() const { return liveCount; }
+	size_t capacity() const { return emitters.size(); }	// One past the highest id
+
+private:
+	enum Dirty : uint8_t {
+		DirtyAttributes = 1 << 0,
+		DirtyVolume = 1 << 1,
+		DirtyPitch = 1 << 2,
+		DirtyDoppler = 1 << 3,
+		DirtySpread = 1 << 4,
+		DirtyCone = 1 << 5,
+		PendingStart = 1 << 6,
+		DirtyLowpass = 1 << 7
+	};
+
+	// Position plus velocity derived from the last sample
+	struct Tracked {
+		AudioAttributes3D attributes;
+		AudioVector previousPosition;
+		double sampleTime = 0.0;
+		bool sampled = false;
+	};
+
+	struct Emitter : Tracked {
+		AudioVoice voice = 0;
+		float volume = 1.0f;
+		float pitch = 1.0f;
+		float dopplerLevel = 1.0f;
+		float spread = 0.0f;
+		AudioVector coneDirection = AudioVector(0.0f, 0.0f, 1.0f);
+		float coneInside = 360.0f, coneOutside = 360.0f, coneOutsideVolume = 1.0f;
+		float lowpass = 22000.0f;	// Cutoff in Hz, open by default
+		uint8_t dirty = 0;
+		bool alive = false;
+	};
+
+	bool isValid(int id) const { return id >= 0 && id < (int)emitters.size() && emitters[id].alive; }
+	bool track(Tracked& tracked, const AudioVector& position);	// True if position or velocity changed
+
+	vector<Emitter> emitters;
+	vector<int> freeIds;
+	size_t liveCount = 0;
+
+	Tracked listener;
+	bool listenerDirty = false;
+
+	double time = 0.0;
+};
@@ -0,0 +1,251 @@
+#include "AudioOcclusion.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+	constexpr float MIN_DIRECTION = 1e-6f;	// Direction components closer to 0 than this are nudged off it
+
+	float safeInverse(float d) {
+		return 1.0f / (fabsf(d) < MIN_DIRECTION ? MIN_DIRECTION : d);
+	}
+
+	float combine(float crossings, float blockedSamples) {
+		const float boxes = crossings * AudioOcclusion::BOX_OCCLUSION;
+		const float terrain = blockedSamples / (float)AudioOcclusion::TERRAIN_FULL_SAMPLES;
+		return min(max(boxes, terrain), 1.0f);
+	}
+}
+
+void AudioOcclusion::setGeometry(const AudioOcclusionGeometry& geometry) {
+	const size_t count = geometry.boxes.size();
+	for (vector<float>* column : { &boxX, &boxY, &boxZ, &boxHalfX, &boxHalfY, &boxHalfZ, &boxCos, &boxSin }) column->resize(count);
+
+	for (size_t i = 0; i < count; i++) {
+		const AudioOccluderBox& box = geometry.boxes[i];
+		boxX[i] = box.centre.x;
+		boxY[i] = box.centre.y;
+		boxZ[i] = box.centre.z;
+		boxHalfX[i] = box.halfExtents.x;
+		boxHalfY[i] = box.halfExtents.y;
+		boxHalfZ[i] = box.halfExtents.z;
+		boxCos[i] = cosf(box.rotationY);
+		boxSin[i] = sinf(box.rotationY);
+	}
+
+	const bool validGrid = geometry.width > 0 && geometry.depth > 0 && geometry.cellSize > 0.0f &&
+		geometry.heights.size() == (size_t)geometry.width * geometry.depth;
+	gridOriginX = geometry.originX;
+	gridOriginZ = geometry.originZ;
+	gridInverseCell = validGrid ? 1.0f / geometry.cellSize : 1.0f;
+	gridWidth = validGrid ? geometry.width : 0;
+	gridDepth = validGrid ? geometry.depth : 0;
+	heights = validGrid ? geometry.heights : vector<float>();
+
+	// Everything is re-cast against the new geometry
+	for (Slot& slot : slots) slot.cast = false;
+}
+
+void AudioOcclusion::clear() {
+	slots.clear();
+	cursor = 0;
+}
+
+float AudioOcclusion::heightAt(float x, float z) const {
+	const float fx = (x - gridOriginX) * gridInverseCell;
+	const float fz = (z - gridOriginZ) * gridInverseCell;
+	if (!(fx >= 0.0f && fx < (float)gridWidth && fz >= 0.0f && fz < (float)gridDepth)) return AudioOcclusionGeometry::NO_TERRAIN;
+	return heights[(size_t)fz * gridWidth + (size_t)fx];
+}
+
+// Reference path; the SSE one below does the same arithmetic four rays at a time
+void AudioOcclusion::castPacketScalar(const AudioVector& origin, const AudioVector* targets, int count, float* occlusion) const {
+	for (int lane = 0; lane < count; lane++) {
+		const float dx = targets[lane].x - origin.x, dy = targets[lane].y - origin.y, dz = targets[lane].z - origin.z;
+		const float length = sqrtf(dx * dx + dy * dy + dz * dz);
+		const float inverseY = safeInverse(dy);
+
+		// Islands the segment passes right through; one that holds either end is the emitter's own, or the ground
+		float crossings = 0.0f;
+		for (size_t b = 0; b < boxX.size(); b++) {
+			const float rx = origin.x - boxX[b], rz = origin.z - boxZ[b];
+			const float localX = rx * boxCos[b] - rz * boxSin[b];
+			const float localZ = rx * boxSin[b] + rz * boxCos[b];
+			const float localY = origin.y - boxY[b];
+			const float inverseX = safeInverse(dx * boxCos[b] - dz * boxSin[b]);
+			const float inverseZ = safeInverse(dx * boxSin[b] + dz * boxCos[b]);
+
+			const float x1 = (-boxHalfX[b] - localX) * inverseX, x2 = (boxHalfX[b] - localX) * inverseX;
+			const float y1 = (-boxHalfY[b] - localY) * inverseY, y2 = (boxHalfY[b] - localY) * inverseY;
+			const float z1 = (-boxHalfZ[b] - localZ) * inverseZ, z2 = (boxHalfZ[b] - localZ) * inverseZ;
+			const float tNear = max(max(min(x1, x2), min(y1, y2)), min(z1, z2));
+			const float tFar = min(min(max(x1, x2), max(y1, y2)), max(z1, z2));
+			if (tNear > 0.0f && tFar < 1.0f && tNear <= tFar) crossings += 1.0f;
+		}
+
+		float blocked = 0.0f;
+		if (gridWidth > 0) {
+			const float start = length > 0.0f ? min(END_CLEARANCE / length, 0.5f) : 0.5f;
+			const float step = (1.0f - (start + start)) * (1.0f / (float)HEIGHT_SAMPLES);
+			for (int s = 0; s < HEIGHT_SAMPLES; s++) {
+				const float t = start + step * ((float)s + 0.5f);
+				if (origin.y + dy * t < heightAt(origin.x + dx * t, origin.z + dz * t)) blocked += 1.0f;
+			}
+		}
+		occlusion[lane] = combine(crossings, blocked);
+	}
+}
+
+void AudioOcclusion::castPacket(const AudioVector& origin, const AudioVector* targets, int count, float* occlusion) const {
+#ifdef SIMD_MATH_SSE
+	// Unused lanes aim at the origin; a zero-length segment crosses nothing
+	alignas(16) float tx[4], ty[4], tz[4];
+	for (int lane = 0; lane < 4; lane++) {
+		const AudioVector& target = lane < count ? targets[lane] : origin;
+		tx[lane] = target.x;
+		ty[lane] = target.y;
+		tz[lane] = target.z;
+	}
+
+	const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+	const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+	const __m128 minDirection = _mm_set1_ps(MIN_DIRECTION);
+	auto safeInverse4 = [&](__m128 d) {
+		const __m128 tiny = _mm_cmplt_ps(_mm_and_ps(d, absMask), minDirection);
+		return _mm_div_ps(one, _mm_or_ps(_mm_and_ps(tiny, minDirection), _mm_andnot_ps(tiny, d)));
+	};
+
+	const __m128 dx = _mm_sub_ps(_mm_load_ps(tx), _mm_set1_ps(origin.x));
+	const __m128 dy = _mm_sub_ps(_mm_load_ps(ty), _mm_set1_ps(origin.y));
+	const __m128 dz = _mm_sub_ps(_mm_load_ps(tz), _mm_set1_ps(origin.z));
+	const __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)));
+	const __m128 inverseY = safeInverse4(dy);
+
+	__m128 crossings = zero;
+	for (size_t b = 0; b < boxX.size(); b++) {
+		// The origin is shared, so its box-local position is worked out once per box
+		const float rx = origin.x - boxX[b], rz = origin.z - boxZ[b];
+		const __m128 localX = _mm_set1_ps(rx * boxCos[b] - rz * boxSin[b]);
+		const __m128 localZ = _mm_set1_ps(rx * boxSin[b] + rz * boxCos[b]);
+		const __m128 localY = _mm_set1_ps(origin.y - boxY[b]);
+		const __m128 c = _mm_set1_ps(boxCos[b]), s = _mm_set1_ps(boxSin[b]);
+		const __m128 inverseX = safeInverse4(_mm_sub_ps(_mm_mul_ps(dx, c), _mm_mul_ps(dz, s)));
+		const __m128 inverseZ = safeInverse4(_mm_add_ps(_mm_mul_ps(dx, s), _mm_mul_ps(dz, c)));
+		const __m128 halfX = _mm_set1_ps(boxHalfX[b]), halfY = _mm_set1_ps(boxHalfY[b]), halfZ = _mm_set1_ps(boxHalfZ[b]);
+
+		const __m128 x1 = _mm_mul_ps(_mm_sub_ps(_mm_sub_ps(zero, halfX), localX), inverseX), x2 = _mm_mul_ps(_mm_sub_ps(halfX, localX), inverseX);
+		const __m128 y1 = _mm_mul_ps(_mm_sub_ps(_mm_sub_ps(zero, halfY), localY), inverseY), y2 = _mm_mul_ps(_mm_sub_ps(halfY, localY), inverseY);
+		const __m128 z1 = _mm_mul_ps(_mm_sub_ps(_mm_sub_ps(zero, halfZ), localZ), inverseZ), z2 = _mm_mul_ps(_mm_sub_ps(halfZ, localZ), inverseZ);
+		const __m128 tNear = _mm_max_ps(_mm_max_ps(_mm_min_ps(x1, x2), _mm_min_ps(y1, y2)), _mm_min_ps(z1, z2));
+		const __m128 tFar = _mm_min_ps(_mm_min_ps(_mm_max_ps(x1, x2), _mm_max_ps(y1, y2)), _mm_max_ps(z1, z2));
+
+		const __m128 hit = _mm_and_ps(_mm_and_ps(_mm_cmpgt_ps(tNear, zero), _mm_cmplt_ps(tFar, one)), _mm_cmple_ps(tNear, tFar));
+		crossings = _mm_add_ps(crossings, _mm_and_ps(hit, one));
+	}
+
+	__m128 blocked = zero;
+	if (gridWidth > 0) {
+		const __m128 half = _mm_set1_ps(0.5f);
+		const __m128 clearance = _mm_div_ps(_mm_set1_ps(END_CLEARANCE), _mm_max_ps(length, minDirection));
+		const __m128 start = _mm_min_ps(clearance, half);
+		const __m128 step = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(start, start)), _mm_set1_ps(1.0f / (float)HEIGHT_SAMPLES));
+		const __m128 originX = _mm_set1_ps(origin.x), originY = _mm_set1_ps(origin.y), originZ = _mm_set1_ps(origin.z);
+		const __m128 gridX = _mm_set1_ps(gridOriginX), gridZ = _mm_set1_ps(gridOriginZ), inverseCell = _mm_set1_ps(gridInverseCell);
+		const __m128 width = _mm_set1_ps((float)gridWidth), depth = _mm_set1_ps((float)gridDepth);
+		const __m128i widthI = _mm_set1_epi32(gridWidth);
+
+		for (int sample = 0; sample < HEIGHT_SAMPLES; sample++) {
+			const __m128 t = _mm_add_ps(start, _mm_mul_ps(step, _mm_set1_ps((float)sample + 0.5f)));
+			const __m128 fx = _mm_mul_ps(_mm_sub_ps(_mm_add_ps(originX, _mm_mul_ps(dx, t)), gridX), inverseCell);
+			const __m128 fz = _mm_mul_ps(_mm_sub_ps(_mm_add_ps(originZ, _mm_mul_ps(dz, t)), gridZ), inverseCell);
+			const __m128 y = _mm_add_ps(originY, _mm_mul_ps(dy, t));
+
+			const __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(fx, zero), _mm_cmplt_ps(fx, width)),
+				_mm_and_ps(_mm_cmpge_ps(fz, zero), _mm_cmplt_ps(fz, depth)));
+
+			// Cell indices, gathered one lane at a time; lanes off the grid read cell 0 and are masked out
+			alignas(16) int32_t index[4];
+			const __m128i cellX = _mm_cvttps_epi32(_mm_and_ps(inside, fx));
+			const __m128i cellZ = _mm_cvttps_epi32(_mm_and_ps(inside, fz));
+			// SSE2 has no 32-bit multiply-low, so the row offset is done in float; exact below 2^24 cells
+			const __m128i row = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(cellZ), _mm_cvtepi32_ps(widthI)));
+			_mm_store_si128((__m128i*)index, _mm_add_epi32(row, cellX));
+			const __m128 height = _mm_setr_ps(heights[index[0]], heights[index[1]], heights[index[2]], heights[index[3]]);
+
+			const __m128 below = _mm_and_ps(inside, _mm_cmplt_ps(y, height));
+			blocked = _mm_add_ps(blocked, _mm_and_ps(below, one));
+		}
+	}
+
+	alignas(16) float crossingLanes[4], blockedLanes[4];
+	_mm_store_ps(crossingLanes, crossings);
+	_mm_store_ps(blockedLanes, blocked);
+	for (int lane = 0; lane < count; lane++) occlusion[lane] = combine(crossingLanes[lane], blockedLanes[lane]);
+#else
+	castPacketScalar(origin, targets, count, occlusion);
+#endif
+}
+
+void AudioOcclusion::castRays(const AudioVector& origin, const AudioVector* targets, size_t count, float* occlusion) const {
+	for (size_t first = 0; first < count; first += 4) {
+		const int packet = (int)min((size_t)4, count - first);
+		if (simd) castPacket(origin, targets + first, packet, occlusion + first);
+		else castPacketScalar(origin, targets + first, packet, occlusion + first);
+	}
+}
+
+void AudioOcclusion::update(AudioEmitterTable& emitters, float deltaTime) {
+	lastRays = 0;
+	if (boxX.empty() && gridWidth == 0) return;	// No geometry yet, everything stays open
+
+	const int capacity = (int)emitters.capacity();
+	if ((int)slots.size() < capacity) slots.resize(capacity);
+
+	// Reused ids start over; emitters that have never been cast go first so they are never heard unoccluded
+	due.clear();
+	for (int id = 0; id < capacity; id++) {
+		Slot& slot = slots[id];
+		const AudioVoice voice = emitters.getVoice(id);
+		if (slot.voice != voice) {
+			slot = Slot();
+			slot.voice = voice;
+		}
+		if (!slot.cast && (int)due.size() < rayBudget && emitters.isAudible(id)) due.push_back(id);
+	}
+	const size_t fresh = due.size();
+
+	// The rest take turns, carrying on from where the last frame stopped
+	if (capacity > 0) {
+		cursor %= capacity;
+		for (int visited = 0; visited < capacity && (int)due.size() < rayBudget; visited++) {
+			const int id = (cursor + visited) % capacity;
+			if (slots[id].cast && emitters.isAudible(id)) {
+				due.push_back(id);
+				if ((int)due.size() == rayBudget) cursor = id + 1;
+			}
+		}
+	}
+
+	dueTargets.resize(due.size());
+	dueResults.resize(due.size());
+	for (size_t i = 0; i < due.size(); i++) dueTargets[i] = emitters.getPosition(due[i]);
+	castRays(emitters.getListener().position, dueTargets.data(), due.size(), dueResults.data());
+	lastRays = (int)due.size();
+
+	for (size_t i = 0; i < due.size(); i++) {
+		Slot& slot = slots[due[i]];
+		slot.target = dueResults[i];
+		if (i < fresh) slot.current = slot.target;
+		slot.cast = true;
+	}
+
+	// Ease towards the latest result and map it to a cutoff, log-spaced so each step sounds even
+	const float blend = 1.0f - expf(-max(deltaTime, 0.0f) / OCCLUSION_SMOOTH_TIME);
+	for (int id = 0; id < capacity; id++) {
+		Slot& slot = slots[id];
+		if (!slot.cast || !emitters.isAudible(id)) continue;
+
+		slot.current += (slot.target - slot.current) * blend;
+		emitters.setLowpass(id, OPEN_CUTOFF * powf(OCCLUDED_CUTOFF / OPEN_CUTOFF, slot.current));
+	}
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include "AudioDSP.h"
+#include "AudioEmitterTable.h"
+#include <vector>
+
+using namespace std;
+
+// An island slab, rotated about Y like the island meshes
+struct AudioOccluderBox {
+	AudioVector centre;
+	AudioVector halfExtents;
+	float rotationY = 0.0f;
+};
+
+// Everything sound can be blocked by: island boxes and the terrain height grid over them
+struct AudioOcclusionGeometry {
+	static constexpr float NO_TERRAIN = -1e30f;
+
+	vector<AudioOccluderBox> boxes;
+
+	// Row-major height grid (x fastest) with cell (0, 0) at origin; NO_TERRAIN where there is open water
+	float originX = 0.0f, originZ = 0.0f;
+	float cellSize = 1.0f;
+	int width = 0, depth = 0;
+	vector<float> heights;
+};
+
+// Occlusion between the listener and every audible emitter. Rays are cast four at a time, one per SSE lane, against
+// every island box and a fixed number of height grid samples, so each ray costs the same and the per-frame ray budget
+// is a fixed cost. Emitters take turns when there are more than the budget; the result each one last got is eased
+// towards over OCCLUSION_SMOOTH_TIME so a late re-cast never pops, and is written to its low-pass cutoff.
+class AudioOcclusion {
+public:
+	AudioOcclusion() : simd(AudioDSP::hasSimd()) {}
+
+	void setGeometry(const AudioOcclusionGeometry& geometry);
+	void setRayBudget(int raysPerFrame) { rayBudget = raysPerFrame < 1 ? 1 : raysPerFrame; }
+	void setSimd(bool enabled) { simd = enabled && AudioDSP::hasSimd(); }
+	void clear();	// Drops per-emitter state, e.g. when the emitter table is cleared
+
+	// Casts this frame's rays from the table's listener and sets every audible emitter's low-pass cutoff
+	void update(AudioEmitterTable& emitters, float deltaTime);
+
+	// 0 (clear) to 1 (fully blocked) for each segment from origin to a target
+	void castRays(const AudioVector& origin, const AudioVector* targets, size_t count, float* occlusion) const;
+
+	float getOcclusion(int id) const { return id >= 0 && id < (int)slots.size() ? slots[id].current : 0.0f; }
+	int getLastRayCount() const { return lastRays; }
+
+	static constexpr int DEFAULT_RAY_BUDGET = 16;
+	static constexpr int HEIGHT_SAMPLES = 32;	// Per ray
+	static constexpr float END_CLEARANCE = 3.0f;	// Terrain this close to either end is ignored, emitters sit on it
+	static constexpr float BOX_OCCLUSION = 0.7f;	// Per island the ray passes right through
+	static constexpr int TERRAIN_FULL_SAMPLES = 4;	// Samples under the terrain that count as fully blocked
+	static constexpr float OCCLUSION_SMOOTH_TIME = 0.15f;
+	static constexpr float OPEN_CUTOFF = 22000.0f;
+	static constexpr float OCCLUDED_CUTOFF = 600.0f;
+
+private:
+	struct Slot {
+		AudioVoice voice = 0;	// Detects a reused emitter id
+		float target = 0.0f;
+		float current = 0.0f;
+		bool cast = false;
+	};
+
+	void castPacket(const AudioVector& origin, const AudioVector* targets, int count, float* occlusion) const;
+	void castPacketScalar(const AudioVector& origin, const AudioVector* targets, int count, float* occlusion) const;
+	float heightAt(float x, float z) const;
+
+	// Boxes as structure of arrays, with the inverse rotation precomputed
+	vector<float> boxX, boxY, boxZ, boxHalfX, boxHalfY, boxHalfZ, boxCos, boxSin;
+
+	float gridOriginX = 0.0f, gridOriginZ = 0.0f, gridInverseCell = 1.0f;
+	int gridWidth = 0, gridDepth = 0;
+	vector<float> heights;
+
+	vector<Slot> slots;	// Indexed by emitter table id
+	vector<int> due;	// Reused every update
+	vector<AudioVector> dueTargets;
+	vector<float> dueResults;
+	int cursor = 0;	// Round-robin position for emitters that have been cast before
+	int rayBudget = DEFAULT_RAY_BUDGET;
+	int lastRays = 0;
+	bool simd;
+};
@@ -0,0 +1,235 @@
+#include "AudioSystem.h"
+#include <chrono>
+#include <cstring>
+
+bool AudioSystem::init(AudioBackend* audioBackend, bool threaded) {
+	// First check if already initialized
+	if (initialised) {
+		delete audioBackend;
+		return true;
+	}
+
+	if (!controller.init(audioBackend)) return false;
+	initialised = true;
+
+	// Publish the initial state so the first frame reads something sensible
+	AudioSnapshot initial;
+	controller.fillSnapshot(initial);
+	publishSnapshot(initial);
+	snapshot = initial;
+
+	if (threaded) {
+		stopping = false;
+		audioThread = thread(&AudioSystem::threadLoop, this);
+	}
+	return true;
+}
+
+void AudioSystem::release() {
+	if (audioThread.joinable()) {
+		{
+			lock_guard<mutex> lock(wakeMutex);
+			stopping = true;
+		}
+		wakeCondition.notify_one();
+		audioThread.join();
+	}
+
+	controller.release();
+	initialised = false;
+}
+
+void AudioSystem::submit(const AudioCommand& command) {
+	if (!initialised) return;
+
+	if (!audioThread.joinable()) {
+		controller.execute(command);
+		if (command.type == AudioCommand::Type::Flush) runFlush();
+		return;
+	}
+
+	// A full ring means the audio thread is far behind; wait rather than drop state changes
+	while (!commands.push(command)) {
+		queueStalls++;
+		wakeCondition.notify_one();
+		this_thread::yield();
+	}
+
+	// Frame boundaries wake the audio thread; everything else is picked up with them
+	if (command.type == AudioCommand::Type::Flush) {
+		atomic_thread_fence(memory_order_seq_cst);	// Pairs with the fence in threadLoop so a wake-up is never missed
+		if (audioSleeping.load(memory_order_relaxed)) wakeCondition.notify_one();
+	}
+}
+
+void AudioSystem::submit(AudioCommand::Type type) {
+	AudioCommand command;
+	command.type = type;
+	submit(command);
+}
+
+void AudioSystem::threadLoop() {
+	AudioCommand command;
+	for (;;) {
+		bool didWork = false;
+		const auto start = chrono::high_resolution_clock::now();
+		while (commands.pop(command)) {
+			controller.execute(command);
+			didWork = true;
+
+			if (command.type == AudioCommand::Type::Flush) {
+				frameCommandTime += chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+				runFlush();
+				break;
+			}
+		}
+		if (didWork) continue;
+
+		if (stopping) return;
+
+		// Idle until the game finishes its next frame; the timeout is only a safety net
+		unique_lock<mutex> lock(wakeMutex);
+		audioSleeping.store(true, memory_order_relaxed);
+		atomic_thread_fence(memory_order_seq_cst);
+		wakeCondition.wait_for(lock, chrono::milliseconds(5), [this] { return stopping.load() || !commands.empty(); });
+		audioSleeping.store(false, memory_order_relaxed);
+	}
+}
+
+void AudioSystem::runFlush() {
+	AudioSnapshot published;
+	controller.fillSnapshot(published);
+	published.frame = ++flushCount;
+	published.frameTime = (float)frameCommandTime;
+	frameCommandTime = 0.0;
+	publishSnapshot(published);
+}
+
+void AudioSystem::publishSnapshot(const AudioSnapshot& published) {
+	// Only this side ever writes the back slot, so filling it needs no lock
+	const int back = 1 - frontSnapshot;
+	snapshots[back] = published;
+
+	lock_guard<mutex> lock(snapshotMutex);
+	frontSnapshot = back;
+}
+
+// Start of frame: read back the latest state, then queue the frame's time step
+void AudioSystem::update(float deltaTime) {
+	{
+		lock_guard<mutex> lock(snapshotMutex);
+		snapshot = snapshots[frontSnapshot];
+	}
+
+	AudioCommand command;
+	command.type = AudioCommand::Type::Update;
+	command.values[0] = deltaTime;
+	submit(command);
+}
+
+void AudioSystem::flush() {
+	submit(AudioCommand::Type::Flush);
+}
+
+void AudioSystem::playBGM1() {
+	if (!snapshot.bgmPlaying) submit(AudioCommand::Type::PlayBGM1);
+}
+
+void AudioSystem::stopBGM1() {
+	submit(AudioCommand::Type::StopBGM1);
+}
+
+void AudioSystem::playOneShot(const char* eventPath) {
+	AudioCommand command;
+	command.type = AudioCommand::Type::PlayOneShot;
+	strncpy(command.eventPath, eventPath, AudioCommand::MAX_EVENT_PATH - 1);
+	submit(command);
+}
+
+void AudioSystem::dimBGM(float duration, float targetVolume) {
+	AudioCommand command;
+	command.type = AudioCommand::Type::DimBGM;
+	command.values[0] = duration;
+	command.values[1] = targetVolume;
+	submit(command);
+}
+
+void AudioSystem::playGhostWhisper(const AudioVector& position) {
+	if (snapshot.whisperPlaying) return;
+
+	AudioCommand command;
+	command.type = AudioCommand::Type::PlayGhostWhisper;
+	command.vectors[0] = position;
+	submit(command);
+}
+
+void AudioSystem::stopGhostWhisper() {
+	submit(AudioCommand::Type::StopGhostWhisper);
+}
+
+void AudioSystem::updateGhostPosition(const AudioVector& position) {
+	AudioCommand command;
+	command.type = AudioCommand::Type::UpdateGhostPosition;
+	command.vectors[0] = position;
+	submit(command);
+}
+
+void AudioSystem::updateListenerPosition(const AudioVector& position, const AudioVector& forward, const AudioVector& up) {
+	AudioCommand command;
+	command.type = AudioCommand::Type::UpdateListener;
+	command.vectors[0] = position;
+	command.vectors[1] = forward;
+	command.vectors[2] = up;
+	submit(command);
+}
+
+void AudioSystem::updateGhostWhisperVolume(const AudioVector& listenerPosition) {
+	AudioCommand command;
+	command.type = AudioCommand::Type::UpdateGhostWhisperVolume;
+	command.vectors[0] = listenerPosition;
+	submit(command);
+}
+
+void AudioSystem::updateGhostEffects(float deltaTime, const AudioVector& listenerPosition) {
+	AudioCommand command;
+	command.type = AudioCommand::Type::UpdateGhostEffects;
+	command.values[0] = deltaTime;
+	command.vectors[0] = listenerPosition;
+	submit(command);
+}
+
+void AudioSystem::setGhostEffectIntensity(float intensity) {
+	AudioCommand command;
+	command.type = AudioCommand::Type::SetGhostEffectIntensity;
+	command.values[0] = intensity;
+	submit(command);
+}
+
+void AudioSystem::createIslandAmbience(const AudioVector& position) {
+	AudioCommand command;
+	command.type = AudioCommand::Type::CreateIslandAmbience;
+	command.vectors[0] = position;
+	submit(command);
+}
+
+void AudioSystem::updateIslandAmbiences(const AudioVector& listenerPos, int activeIslandIndex) {
+	AudioCommand command;
+	command.type = AudioCommand::Type::UpdateIslandAmbiences;
+	command.index = activeIslandIndex;
+	command.vectors[0] = listenerPos;
+	submit(command);
+}
+
+void AudioSystem::stopAllIslandAmbience() {
+	submit(AudioCommand::Type::StopAllIslandAmbience);
+}
+
+void AudioSystem::setOcclusionGeometry(const AudioOcclusionGeometry& geometry) {
+	if (!initialised) return;
+
+	// Too big for a command, so it travels as a heap copy the audio side deletes
+	AudioCommand command;
+	command.type = AudioCommand::Type::SetOcclusionGeometry;
+	command.geometry = new AudioOcclusionGeometry(geometry);
+	submit(command);
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include "AudioController.h"
+#include "SPSCQueue.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+using namespace std;
+
+// Game-facing audio API. Each call becomes an AudioCommand on a lock-free ring that a dedicated audio thread drains
+// into an AudioController, so the render thread only pays for queue pushes and a frame spike never stalls audio.
+// State comes back through a double-buffered AudioSnapshot, refreshed at the start of every frame.
+// With threading off the commands run inline on the calling thread, which keeps offline runs deterministic.
+class AudioSystem {
+public:
+	AudioSystem() : commands(COMMAND_CAPACITY) {}
+	~AudioSystem() { release(); }
+
+	// Constants
+	static constexpr float ECHO_EFFECT_DURATION = 3.0f;
+	static constexpr size_t COMMAND_CAPACITY = 4096;
+
+	bool init(AudioBackend* audioBackend, bool threaded = true);	// Takes ownership of the backend, even on failure
+	void release();
+
+	// Check (as of the last published snapshot)
+	bool isWhisperPlaying() const { return snapshot.whisperPlaying; }
+	const AudioSnapshot& getSnapshot() const { return snapshot; }
+	bool isThreaded() const { return audioThread.joinable(); }
+	size_t getQueueStalls() const { return queueStalls; }	// Pushes that had to wait for a full ring
+
+	// Only safe to touch when not threaded, or after release()
+	AudioController& getController() { return controller; }
+
+	// Methods
+	void playBGM1();
+	void stopBGM1();
+	void update(float deltaTime);	// Start of frame
+	void flush();	// End of frame: the audio side pushes the frame's changes to the backend
+	void playOneShot(const char* eventPath);	// Copied into the command, so a literal costs no allocation
+	void dimBGM(float duration, float targetVolume = 0.3f);
+
+	void playGhostWhisper(const AudioVector& position);
+	void stopGhostWhisper();
+	void updateGhostPosition(const AudioVector& position);
+
+	void updateListenerPosition(const AudioVector& position, const AudioVector& forward, const AudioVector& up);
+	void updateGhostWhisperVolume(const AudioVector& listenerPosition);
+
+	void updateGhostEffects(float deltaTime, const AudioVector& listenerPosition);
+	void setGhostEffectIntensity(float intensity);  // 0.0f to 1.0f
+
+	void createIslandAmbience(const AudioVector& position);
+	void updateIslandAmbiences(const AudioVector& listenerPos, int activeIslandIndex);
+	void stopAllIslandAmbience();
+
+	void setOcclusionGeometry(const AudioOcclusionGeometry& geometry);	// Copied; call again after regenerating islands
+
+private:
+	void submit(const AudioCommand& command);
+	void submit(AudioCommand::Type type);
+	void threadLoop();
+	void runFlush();	// Audio side: flush the controller and publish a snapshot
+	void publishSnapshot(const AudioSnapshot& published);
+
+	AudioController controller;	// Audio thread only while threaded
+	bool initialised = false;
+
+	SPSCQueue<AudioCommand> commands;
+	thread audioThread;
+	atomic<bool> stopping{ false };
+	atomic<bool> audioSleeping{ false };	// Wake-ups are skipped while the audio thread is already running
+	mutex wakeMutex;
+	condition_variable wakeCondition;
+	size_t queueStalls = 0;
+
+	// Double buffer: the audio side fills the back slot unlocked, then swaps under the lock; readers copy the front
+	AudioSnapshot snapshots[2];
+	int frontSnapshot = 0;
+	mutable mutex snapshotMutex;
+	AudioSnapshot snapshot;	// Game side copy for the current frame
+	unsigned int flushCount = 0;	// Audio side
+	double frameCommandTime = 0.0;	// Audio side, seconds spent on commands since the last flush
+};
@@ -0,0 +1,31 @@
+#pragma once
+// Plain types shared by the audio code. Nothing here depends on FMOD or D3D so the selection and mixing
+// logic also builds on non-Windows machines.
+
+#include "Vector3.h"
+#include <cmath>
+
+typedef Vector3 AudioVector;
+
+inline float audioDistanceSq(const AudioVector& a, const AudioVector& b) {
+	const float dx = a.x - b.x, dy = a.y - b.y, dz = a.z - b.z;
+	return dx * dx + dy * dy + dz * dz;
+}
+
+inline float audioDistance(const AudioVector& a, const AudioVector& b) {
+	return sqrtf(audioDistanceSq(a, b));
+}
+
+// Island ambiences ignore height, matching Islands::GetClosestIslandIndex
+inline float audioDistanceXZ(const AudioVector& a, const AudioVector& b) {
+	const float dx = a.x - b.x, dz = a.z - b.z;
+	return sqrtf(dx * dx + dz * dz);
+}
+
+// Position, velocity and orientation of an emitter or the listener
+struct AudioAttributes3D {
+	AudioVector position;
+	AudioVector velocity;
+	AudioVector forward = AudioVector(0.0f, 0.0f, 1.0f);
+	AudioVector up = AudioVector(0.0f, 1.0f, 0.0f);
+};
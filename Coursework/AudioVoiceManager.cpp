@@ -0,0 +1,175 @@
+#include "AudioVoiceManager.h"
+#include <algorithm>
+
+AudioVoiceManager::AudioVoiceManager(float cellSize) : cellSize(cellSize > 1.0f ? cellSize : 1.0f) {}
+
+int AudioVoiceManager::addEmitter(const AudioVector& position, float maxDistance, float volume) {
+	int id;
+	if (!freeIds.empty()) {
+		id = freeIds.back();
+		freeIds.pop_back();
+	}
+	else {
+		id = (int)emitters.size();
+		emitters.emplace_back();
+	}
+
+	Emitter& emitter = emitters[id];
+	emitter = Emitter();
+	emitter.position = position;
+	emitter.maxDistance = maxDistance;
+	emitter.volume = volume;
+	emitter.alive = true;
+	insertIntoCell(id);
+
+	// Only ever grows; a stale larger radius just visits a few extra cells
+	maxEmitterDistance = max(maxEmitterDistance, maxDistance);
+	liveCount++;
+	return id;
+}
+
+void AudioVoiceManager::removeEmitter(int id) {
+	if (!isValid(id)) return;
+
+	removeFromCell(id);
+	if (emitters[id].real) realVoices.erase(std::remove(realVoices.begin(), realVoices.end(), id), realVoices.end());
+	emitters[id].alive = false;
+	emitters[id].real = false;
+	freeIds.push_back(id);
+	liveCount--;
+}
+
+void AudioVoiceManager::setEmitterPosition(int id, const AudioVector& position) {
+	if (!isValid(id)) return;
+
+	const int64_t cell = cellOf(position);
+	if (cell != emitters[id].cell) {
+		removeFromCell(id);
+		emitters[id].position = position;
+		insertIntoCell(id);
+	}
+	else {
+		emitters[id].position = position;
+	}
+}
+
+void AudioVoiceManager::setEmitterVolume(int id, float volume) {
+	if (isValid(id)) emitters[id].volume = volume;
+}
+
+void AudioVoiceManager::clear() {
+	emitters.clear();
+	freeIds.clear();
+	cells.clear();
+	realVoices.clear();
+	liveCount = 0;
+	maxEmitterDistance = 0.0f;
+}
+
+int64_t AudioVoiceManager::cellOf(const AudioVector& position) const {
+	return cellKey((int)floorf(position.x / cellSize), (int)floorf(position.z / cellSize));
+}
+
+void AudioVoiceManager::insertIntoCell(int id) {
+	Emitter& emitter = emitters[id];
+	emitter.cell = cellOf(emitter.position);
+	vector<int>& bucket = cells[emitter.cell];
+	emitter.indexInCell = (uint32_t)bucket.size();
+	bucket.push_back(id);
+}
+
+// Swap-remove keeps cell buckets dense without searching them
+void AudioVoiceManager::removeFromCell(int id) {
+	Emitter& emitter = emitters[id];
+	auto found = cells.find(emitter.cell);
+	if (found == cells.end()) return;
+
+	vector<int>& bucket = found->second;
+	const int moved = bucket.back();
+	bucket[emitter.indexInCell] = moved;
+	emitters[moved].indexInCell = emitter.indexInCell;
+	bucket.pop_back();
+	if (bucket.empty()) cells.erase(found);
+}
+
+// Linear roll-off to zero at maxDistance, scaled by the emitter's own volume. Distance is measured in XZ, as the
+// controller measures island ambiences, so an emitter's height never costs it its voice
+void AudioVoiceManager::scoreEmitter(int id, const AudioVector& listener) {
+	Emitter& emitter = emitters[id];
+	emitter.visitStamp = stamp;
+	lastVisited++;
+
+	const float distance = audioDistanceXZ(emitter.position, listener);
+	if (distance >= emitter.maxDistance) {
+		emitter.audibility = 0.0f;
+		return;
+	}
+
+	emitter.audibility = emitter.volume * (1.0f - distance / emitter.maxDistance);
+	if (emitter.audibility < MIN_AUDIBILITY) return;
+
+	const float score = emitter.real ? emitter.audibility * (1.0f + hysteresis) : emitter.audibility;
+	candidates.push_back({ score, id });
+}
+
+void AudioVoiceManager::update(const AudioVector& listener, vector<int>& promoted, vector<int>& demoted) {
+	promoted.clear();
+	demoted.clear();
+	candidates.clear();
+	lastVisited = 0;
+	stamp++;
+
+	// Cells overlapping the audible radius; when that covers more cells than exist, walk the map instead
+	const int minX = (int)floorf((listener.x - maxEmitterDistance) / cellSize);
+	const int maxX = (int)floorf((listener.x + maxEmitterDistance) / cellSize);
+	const int minZ = (int)floorf((listener.z - maxEmitterDistance) / cellSize);
+	const int maxZ = (int)floorf((listener.z + maxEmitterDistance) / cellSize);
+	const size_t cellsInRange = (size_t)(maxX - minX + 1) * (size_t)(maxZ - minZ + 1);
+
+	if (cellsInRange > cells.size()) {
+		for (const auto& cell : cells) {
+			for (int id : cell.second) scoreEmitter(id, listener);
+		}
+	}
+	else {
+		for (int cx = minX; cx <= maxX; cx++) {
+			for (int cz = minZ; cz <= maxZ; cz++) {
+				auto found = cells.find(cellKey(cx, cz));
+				if (found == cells.end()) continue;
+				for (int id : found->second) scoreEmitter(id, listener);
+			}
+		}
+	}
+
+	// Real voices that fell outside every visited cell are silent
+	for (int id : realVoices) {
+		if (emitters[id].visitStamp != stamp) emitters[id].audibility = 0.0f;
+	}
+
+	// Keep the N best scores; ties favour the current real voice through the hysteresis bonus
+	const size_t keep = min(candidates.size(), (size_t)maxVoices);
+	if (candidates.size() > keep) {
+		nth_element(candidates.begin(), candidates.begin() + keep, candidates.end(),
+			[](const Candidate& a, const Candidate& b) { return a.score > b.score; });
+	}
+
+	++stamp;	// Reused below to mark the selected set
+	for (size_t i = 0; i < keep; i++) emitters[candidates[i].id].visitStamp = stamp;
+
+	for (int id : realVoices) {
+		if (emitters[id].visitStamp != stamp) {
+			emitters[id].real = false;
+			demoted.push_back(id);
+		}
+	}
+
+	realVoices.clear();
+	for (size_t i = 0; i < keep; i++) {
+		const int id = candidates[i].id;
+		if (!emitters[id].real) {
+			emitters[id].real = true;
+			promoted.push_back(id);
+		}
+		realVoices.push_back(id);
+	}
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include "AudioTypes.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+// Voice virtualisation for positional emitters (island ambiences). Every emitter is a cheap virtual record in a
+// uniform XZ grid; each update only the emitters in cells around the listener are scored, by XZ distance as
+// AudioController measures ambiences, and the N most audible hold real event instances. A real voice keeps its
+// slot until a virtual one beats it by the hysteresis margin, so emitters near the cut-off do not restart every frame.
+class AudioVoiceManager {
+public:
+	explicit AudioVoiceManager(float cellSize = 100.0f);
+
+	int addEmitter(const AudioVector& position, float maxDistance, float volume = 1.0f);
+	void removeEmitter(int id);
+	void setEmitterPosition(int id, const AudioVector& position);
+	void setEmitterVolume(int id, float volume);
+	void clear();
+
+	void setMaxVoices(int count) { maxVoices = count < 0 ? 0 : count; }
+	int getMaxVoices() const { return maxVoices; }
+	void setHysteresis(float ratio) { hysteresis = ratio < 0.0f ? 0.0f : ratio; }
+
+	// Re-ranks the emitters around the listener. `promoted` receives emitters that now need a real instance and
+	// `demoted` the ones whose instance should be released; both are cleared first.
+	void update(const AudioVector& listener, vector<int>& promoted, vector<int>& demoted);
+
+	bool isReal(int id) const { return isValid(id) && emitters[id].real; }
+	float getAudibility(int id) const { return isValid(id) ? emitters[id].audibility : 0.0f; }	// From the last update
+	const AudioVector& getPosition(int id) const { return emitters[id].position; }
+	const vector<int>& getRealVoices() const { return realVoices; }
+	size_t getEmitterCount() const { return liveCount; }
+	size_t getLastVisited() const { return lastVisited; }	// Emitters scored in the last update
+
+	static constexpr float MIN_AUDIBILITY = 0.001f;
+
+private:
+	struct Emitter {
+		AudioVector position;
+		float maxDistance = 0.0f;
+		float volume = 0.0f;
+		float audibility = 0.0f;
+		int64_t cell = 0;
+		uint32_t indexInCell = 0;
+		uint32_t visitStamp = 0;
+		bool alive = false;
+		bool real = false;
+	};
+
+	struct Candidate {
+		float score;
+		int id;
+	};
+
+	bool isValid(int id) const { return id >= 0 && id < (int)emitters.size() && emitters[id].alive; }
+	int64_t cellKey(int cx, int cz) const { return ((int64_t)cx << 32) ^ (int64_t)(uint32_t)cz; }
+	int64_t cellOf(const AudioVector& position) const;
+	void insertIntoCell(int id);
+	void removeFromCell(int id);
+	void scoreEmitter(int id, const AudioVector& listener);
+
+	float cellSize;
+	float maxEmitterDistance = 0.0f;
+	int maxVoices = 4;
+	float hysteresis = 0.25f;
+
+	vector<Emitter> emitters;
+	vector<int> freeIds;
+	unordered_map<int64_t, vector<int>> cells;
+	vector<int> realVoices;
+	vector<Candidate> candidates;
+	size_t liveCount = 0;
+	size_t lastVisited = 0;
+	uint32_t stamp = 0;
+};
@@ -0,0 +1,336 @@
+#include "FMODAudioBackend.h"
+#include <windows.h>
+#include "MemoryTracker.h"
+
+static FMOD_VECTOR toFMOD(const AudioVector& v) {
+	return { v.x, v.y, v.z };
+}
+
+// Initializes FMOD audio system
+bool FMODAudioBackend::init() {
+	// First check if already initialized
+	if (studioSystem) {
+		return true;
+	}
+
+	FMOD_RESULT result;
+
+	// 1. Create the main FMOD Studio system
+	result = FMOD::Studio::System::create(&studioSystem);
+	if (result != FMOD_OK || !studioSystem) {
+		OutputDebugStringA("FMOD: Failed to create studio system");
+		OutputDebugStringA(FMOD_ErrorString(result));
+		OutputDebugStringA("\n");
+		return false;
+	}
+
+	// 2. Initialize system with 64 channels (audio streams)
+	result = studioSystem->initialize(
+		64,
+		FMOD_STUDIO_INIT_NORMAL,
+		FMOD_INIT_NORMAL,
+		nullptr
+	);
+	if (result != FMOD_OK) {
+		OutputDebugStringA("FMOD: Failed to initialize system - ");
+		OutputDebugStringA(FMOD_ErrorString(result));
+		OutputDebugStringA("\n");
+		release();
+		return false;
+	}
+	studioSystem->getCoreSystem(&coreSystem);
+
+	// 3. Load sound banks (containing all audio events)
+	const vector<string> bankPaths = {
+		//"CMP505.bank", // For Release
+		//"CMP505.strings.bank" // For Release
+		"../FMOD Project/CMP505_Audio/Build/Desktop/CMP505.bank", // For Debug
+		"../FMOD Project/CMP505_Audio/Build/Desktop/CMP505.strings.bank" // For Debug
+	};
+
+	bool allBanksLoaded = true;
+	for (const auto& path : bankPaths) {
+		FMOD::Studio::Bank* bank = nullptr;
+		result = studioSystem->loadBankFile(
+			path.c_str(),
+			FMOD_STUDIO_LOAD_BANK_NORMAL,
+			&bank
+		);
+
+		if (result != FMOD_OK) {
+			OutputDebugStringA(("FMOD: Failed to load bank " + path + " - ").c_str());
+			OutputDebugStringA(FMOD_ErrorString(result));
+			OutputDebugStringA("\n");
+			allBanksLoaded = false;
+		}
+	}
+
+	if (!allBanksLoaded) {
+		OutputDebugStringA("FMOD: Some banks failed to load\n");
+	}
+
+	// Wait for banks to fully load before continuing
+	studioSystem->flushCommands();
+	return true;
+}
+
+// Clean up all FMOD resources
+void FMODAudioBackend::release() {
+	for (size_t i = 0; i < voices.size(); i++) {
+		if (voices[i].instance) {
+			voices[i].instance->stop(FMOD_STUDIO_STOP_IMMEDIATE);
+			releaseVoice((AudioVoice)(i + 1));
+		}
+	}
+	voices.clear();
+	freeVoices.clear();
+
+	// Release main system
+	if (studioSystem) {
+		studioSystem->release();
+		studioSystem = nullptr;
+		coreSystem = nullptr;
+	}
+}
+
+void FMODAudioBackend::update() {
+	if (!studioSystem) return;
+	studioSystem->update(); // Must be called every frame
+
+	// FMOD keeps its own books; banks, sample data and event instances all come out of them
+	int current = 0, peak = 0;
+	if (FMOD::Memory_GetStats(&current, &peak, false) == FMOD_OK) {
+		MemoryTracker::setExternal(MemoryTag::Audio, (size_t)current, (size_t)peak);
+	}
+
+	for (size_t i = 0; i < voices.size(); i++) {
+		if (voices[i].pendingChannel) applyChannelSettings((AudioVoice)(i + 1));
+	}
+}
+
+FMODAudioBackend::Voice* FMODAudioBackend::getVoice(AudioVoice voice) {
+	if (voice == 0 || voice > voices.size() || !voices[voice - 1].instance) return nullptr;
+	return &voices[voice - 1];
+}
+
+FMOD::ChannelGroup* FMODAudioBackend::getChannelGroup(AudioVoice voice) {
+	Voice* v = getVoice(voice);
+	if (!v) return nullptr;
+
+	FMOD::ChannelGroup* channelGroup = nullptr;
+	v->instance->getChannelGroup(&channelGroup);
+	return channelGroup;
+}
+
+AudioVoice FMODAudioBackend::createVoice(const string& eventPath) {
+	if (!studioSystem) return 0;
+
+	// Get event description from FMOD project
+	FMOD::Studio::EventDescription* desc = nullptr;
+	FMOD_RESULT result = studioSystem->getEvent(eventPath.c_str(), &desc);
+	if (result != FMOD_OK || !desc) return 0;
+
+	FMOD::Studio::EventInstance* instance = nullptr;
+	result = desc->createInstance(&instance);
+	if (result != FMOD_OK || !instance) return 0;
+
+	AudioVoice handle;
+	if (!freeVoices.empty()) {
+		handle = freeVoices.back();
+		freeVoices.pop_back();
+	}
+	else {
+		voices.emplace_back();
+		handle = (AudioVoice)voices.size();
+	}
+
+	voices[handle - 1] = Voice();
+	voices[handle - 1].instance = instance;
+	return handle;
+}
+
+void FMODAudioBackend::startVoice(AudioVoice voice) {
+	if (Voice* v = getVoice(voice)) v->instance->start();
+}
+
+void FMODAudioBackend::stopVoice(AudioVoice voice, bool allowFadeOut) {
+	if (Voice* v = getVoice(voice)) v->instance->stop(allowFadeOut ? FMOD_STUDIO_STOP_ALLOWFADEOUT : FMOD_STUDIO_STOP_IMMEDIATE);
+}
+
+// The instance is destroyed by FMOD once it has finished stopping
+void FMODAudioBackend::releaseVoice(AudioVoice voice) {
+	Voice* v = getVoice(voice);
+	if (!v) return;
+
+	removeDSP(*v, v->equaliser);
+	removeDSP(*v, v->compressor);
+	removeDSP(*v, v->lowpass);
+	for (FMOD::DSP*& transient : v->transients) removeDSP(*v, transient);
+
+	v->instance->release();
+	*v = Voice();
+	freeVoices.push_back(voice);
+}
+
+// Plays a one-time sound effect
+void FMODAudioBackend::playOneShot(const char* eventPath) {
+	if (!studioSystem) return;
+
+	// Find and play the sound event
+	FMOD::Studio::EventDescription* desc = nullptr;
+	FMOD_RESULT result = studioSystem->getEvent(eventPath, &desc);
+	if (result != FMOD_OK || !desc) return;
+
+	FMOD::Studio::EventInstance* instance = nullptr;
+	result = desc->createInstance(&instance);
+	if (result == FMOD_OK && instance) {
+		instance->start();
+		instance->release(); // Automatically cleans up after playing
+	}
+}
+
+void FMODAudioBackend::setVolume(AudioVoice voice, float volume) {
+	if (Voice* v = getVoice(voice)) v->instance->setVolume(volume);
+}
+
+void FMODAudioBackend::setPitch(AudioVoice voice, float pitch) {
+	if (Voice* v = getVoice(voice)) v->instance->setPitch(pitch);
+}
+
+void FMODAudioBackend::set3DAttributes(AudioVoice voice, const AudioAttributes3D& attributes) {
+	Voice* v = getVoice(voice);
+	if (!v) return;
+
+	FMOD_3D_ATTRIBUTES fmodAttributes = { { 0 } };
+	fmodAttributes.position = toFMOD(attributes.position);
+	fmodAttributes.velocity = toFMOD(attributes.velocity);
+	fmodAttributes.forward = toFMOD(attributes.forward);
+	fmodAttributes.up = toFMOD(attributes.up);
+	v->instance->set3DAttributes(&fmodAttributes);
+}
+
+void FMODAudioBackend::setCone(AudioVoice voice, const AudioVector& direction, float insideAngle, float outsideAngle, float outsideVolume) {
+	Voice* v = getVoice(voice);
+	if (!v) return;
+
+	v->coneDirection = toFMOD(direction);
+	v->coneInside = insideAngle;
+	v->coneOutside = outsideAngle;
+	v->coneOutsideVolume = outsideVolume;
+	v->pendingChannel |= PendingCone;
+	applyChannelSettings(voice);
+}
+
+void FMODAudioBackend::setDopplerLevel(AudioVoice voice, float level) {
+	Voice* v = getVoice(voice);
+	if (!v) return;
+
+	v->dopplerLevel = level;
+	v->pendingChannel |= PendingDoppler;
+	applyChannelSettings(voice);
+}
+
+void FMODAudioBackend::setSpread(AudioVoice voice, float degrees) {
+	Voice* v = getVoice(voice);
+	if (!v) return;
+
+	v->spread = degrees;
+	v->pendingChannel |= PendingSpread;
+	applyChannelSettings(voice);
+}
+
+void FMODAudioBackend::setLowpass(AudioVoice voice, float cutoffHz) {
+	Voice* v = getVoice(voice);
+	if (!v) return;
+
+	v->lowpassCutoff = cutoffHz;
+	v->pendingChannel |= PendingLowpass;
+	applyChannelSettings(voice);
+}
+
+// Settings sent before the event started playing are retried from update()
+void FMODAudioBackend::applyChannelSettings(AudioVoice voice) {
+	Voice* v = getVoice(voice);
+	FMOD::ChannelGroup* channelGroup = getChannelGroup(voice);
+	if (!v || !channelGroup) return;
+
+	if (v->pendingChannel & PendingCone) {
+		channelGroup->set3DConeOrientation(&v->coneDirection);
+		channelGroup->set3DConeSettings(v->coneInside, v->coneOutside, v->coneOutsideVolume);
+	}
+	if (v->pendingChannel & PendingDoppler) channelGroup->set3DDopplerLevel(v->dopplerLevel);
+	if (v->pendingChannel & PendingSpread) channelGroup->set3DSpread(v->spread);
+	if (v->pendingChannel & PendingLowpass) {
+		if (!v->lowpass && v->lowpassCutoff < 22000.0f && coreSystem) {
+			coreSystem->createDSPByType(FMOD_DSP_TYPE_LOWPASS_SIMPLE, &v->lowpass);
+			if (v->lowpass) channelGroup->addDSP(0, v->lowpass);
+		}
+		if (v->lowpass) v->lowpass->setParameterFloat(FMOD_DSP_LOWPASS_SIMPLE_CUTOFF, v->lowpassCutoff);
+	}
+	v->pendingChannel = 0;
+}
+
+void FMODAudioBackend::removeDSP(Voice& voice, FMOD::DSP*& dsp) {
+	if (!dsp) return;
+
+	FMOD::ChannelGroup* channelGroup = nullptr;
+	voice.instance->getChannelGroup(&channelGroup);
+	if (channelGroup) channelGroup->removeDSP(dsp);
+	dsp->release();
+	dsp = nullptr;
+}
+
+// EQ to make the voice sound "muffled", with a compressor to keep its perceived loudness
+void FMODAudioBackend::setDuckingFilter(AudioVoice voice, bool enabled) {
+	Voice* v = getVoice(voice);
+	if (!v || !coreSystem) return;
+
+	if (!enabled) {
+		removeDSP(*v, v->equaliser);
+		removeDSP(*v, v->compressor);
+		return;
+	}
+	if (v->equaliser) return;
+
+	FMOD::ChannelGroup* channelGroup = getChannelGroup(voice);
+	if (!channelGroup) return;
+
+	// Create EQ filter to reduce mid/high frequencies
+	coreSystem->createDSPByType(FMOD_DSP_TYPE_THREE_EQ, &v->equaliser);
+	if (!v->equaliser) return;
+	v->equaliser->setParameterFloat(FMOD_DSP_THREE_EQ_MIDGAIN, -6.0f); // Reduce mids
+	v->equaliser->setParameterFloat(FMOD_DSP_THREE_EQ_HIGHGAIN, -3.0f); // Reduce highs
+	channelGroup->addDSP(0, v->equaliser);
+
+	coreSystem->createDSPByType(FMOD_DSP_TYPE_COMPRESSOR, &v->compressor);
+	if (v->compressor) {
+		v->compressor->setParameterFloat(FMOD_DSP_COMPRESSOR_THRESHOLD, -15.0f);
+		channelGroup->addDSP(1, v->compressor);
+	}
+}
+
+void FMODAudioBackend::addTransient(AudioVoice voice, float gain) {
+	Voice* v = getVoice(voice);
+	FMOD::ChannelGroup* channelGroup = getChannelGroup(voice);
+	if (!v || !channelGroup || !coreSystem) return;
+
+	FMOD::DSP* transient = nullptr;
+	coreSystem->createDSPByType(FMOD_DSP_TYPE_TRANSCEIVER, &transient);
+	if (!transient) return;
+
+	transient->setParameterFloat(FMOD_DSP_TRANSCEIVER_GAIN, gain);
+	channelGroup->addDSP(1, transient);
+	v->transients.push_back(transient);
+}
+
+// Updates listener (player) position/orientation
+void FMODAudioBackend::setListener(const AudioAttributes3D& attributes) {
+	if (!studioSystem) return;
+
+	FMOD_3D_ATTRIBUTES fmodAttributes = { { 0 } };
+	fmodAttributes.position = toFMOD(attributes.position);
+	fmodAttributes.velocity = toFMOD(attributes.velocity);
+	fmodAttributes.forward = toFMOD(attributes.forward); // Where listener is facing
+	fmodAttributes.up = toFMOD(attributes.up); // Up direction
+	studioSystem->setListenerAttributes(0, &fmodAttributes);
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include "AudioBackend.h"
+#include <vector>
+
+#include "fmod_studio.hpp"
+#include "fmod.hpp"
+#include "fmod_errors.h"
+#pragma comment(lib, "fmod_vc.lib") // Core FMOD library
+#pragma comment(lib, "fmodstudio_vc.lib") // FMOD Studio library
+
+// Plays voices as FMOD Studio event instances
+class FMODAudioBackend : public AudioBackend {
+public:
+	FMODAudioBackend() = default;
+	~FMODAudioBackend() { release(); }
+
+	bool init() override;
+	void release() override;
+	void update() override;
+
+	AudioVoice createVoice(const string& eventPath) override;
+	void startVoice(AudioVoice voice) override;
+	void stopVoice(AudioVoice voice, bool allowFadeOut) override;
+	void releaseVoice(AudioVoice voice) override;
+	void playOneShot(const char* eventPath) override;
+
+	void setVolume(AudioVoice voice, float volume) override;
+	void setPitch(AudioVoice voice, float pitch) override;
+	void set3DAttributes(AudioVoice voice, const AudioAttributes3D& attributes) override;
+
+	void setCone(AudioVoice voice, const AudioVector& direction, float insideAngle, float outsideAngle, float outsideVolume) override;
+	void setDopplerLevel(AudioVoice voice, float level) override;
+	void setSpread(AudioVoice voice, float degrees) override;
+
+	void setDuckingFilter(AudioVoice voice, bool enabled) override;
+	void addTransient(AudioVoice voice, float gain) override;
+	void setLowpass(AudioVoice voice, float cutoffHz) override;
+
+	void setListener(const AudioAttributes3D& attributes) override;
+
+private:
+	struct Voice {
+		FMOD::Studio::EventInstance* instance = nullptr;
+		FMOD::DSP* equaliser = nullptr;
+		FMOD::DSP* compressor = nullptr;
+		FMOD::DSP* lowpass = nullptr;	// Occlusion, added the first time the cutoff drops below open
+		vector<FMOD::DSP*> transients;
+
+		// Channel group settings, kept until the event has a channel group to apply them to
+		FMOD_VECTOR coneDirection = { 0.0f, 0.0f, 1.0f };
+		float coneInside = 360.0f, coneOutside = 360.0f, coneOutsideVolume = 1.0f;
+		float dopplerLevel = 1.0f;
+		float spread = 0.0f;
+		float lowpassCutoff = 22000.0f;
+		unsigned int pendingChannel = 0;
+	};
+
+	enum PendingChannel { PendingCone = 1, PendingDoppler = 2, PendingSpread = 4, PendingLowpass = 8 };
+
+	Voice* getVoice(AudioVoice voice);
+	FMOD::ChannelGroup* getChannelGroup(AudioVoice voice);	// Null until the event has started playing
+	void removeDSP(Voice& voice, FMOD::DSP*& dsp);
+	void applyChannelSettings(AudioVoice voice);
+
+	FMOD::Studio::System* studioSystem = nullptr;
+	FMOD::System* coreSystem = nullptr;
+	vector<Voice> voices;	// Indexed by handle - 1
+	vector<AudioVoice> freeVoices;
+};
@@ -0,0 +1,180 @@
+#include "FlowFields.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+
+namespace {
+
+	// Counter-clockwise from +x, so the step back is always (k + 4) & 7
+	constexpr int STEP_X[8] = { 1, 1, 0, -1, -1, -1, 0, 1 };
+	constexpr int STEP_Z[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+	constexpr float DIAGONAL = 1.41421356f;
+	constexpr float STEP_COST[8] = { 1.0f, DIAGONAL, 1.0f, DIAGONAL, 1.0f, DIAGONAL, 1.0f, DIAGONAL };
+	constexpr float UNIT = 0.70710678f;
+	constexpr float DIRECTION_X[8] = { 1.0f, UNIT, 0.0f, -UNIT, -1.0f, -UNIT, 0.0f, UNIT };
+	constexpr float DIRECTION_Z[8] = { 0.0f, UNIT, 1.0f, UNIT, 0.0f, -UNIT, -1.0f, -UNIT };
+}
+
+void FlowFields::setGrid(const FlowFieldGrid& grid) {
+	const bool valid = grid.width > 0 && grid.depth > 0 && grid.cellSize > 0.0f &&
+		grid.walkable.size() == (size_t)grid.width * grid.depth;
+	originX = grid.originX;
+	originZ = grid.originZ;
+	cellSize = valid ? grid.cellSize : 1.0f;
+	inverseCell = 1.0f / cellSize;
+	width = valid ? grid.width : 0;
+	depth = valid ? grid.depth : 0;
+	walkable = valid ? grid.walkable : vector<uint8_t>();
+
+	for (Field& field : fields) {
+		field.inUse = false;
+		field.open.clear();
+	}
+}
+
+int FlowFields::nearestWalkable(int cellX, int cellZ) const {
+	int best = -1, bestSq = 0;
+	for (int dz = -SEED_SEARCH_RADIUS; dz <= SEED_SEARCH_RADIUS; dz++) {
+		for (int dx = -SEED_SEARCH_RADIUS; dx <= SEED_SEARCH_RADIUS; dx++) {
+			const int x = cellX + dx, z = cellZ + dz;
+			if (x < 0 || x >= width || z < 0 || z >= depth || !walkable[(size_t)z * width + x]) continue;
+			const int distanceSq = dx * dx + dz * dz;
+			if (best < 0 || distanceSq < bestSq) {
+				best = z * width + x;
+				bestSq = distanceSq;
+			}
+		}
+	}
+	return best;
+}
+
+int FlowFields::request(float x, float z) {
+	const int cellX = (int)floorf((x - originX) * inverseCell), cellZ = (int)floorf((z - originZ) * inverseCell);
+	if (cellX < 0 || cellX >= width || cellZ < 0 || cellZ >= depth) return -1;
+	const int land = nearestWalkable(cellX, cellZ);
+	const int target = land >= 0 ? land : cellZ * width + cellX;
+
+	requests++;
+	for (int i = 0; i < MAX_FIELDS; i++) {
+		if (fields[i].inUse && fields[i].targetCell == target) {
+			fields[i].lastRequest = requests;
+			return (int)(fields[i].generation << SLOT_BITS) | i;
+		}
+	}
+
+	// A free slot, otherwise the least recently requested field
+	int slot = 0;
+	for (int i = 1; i < MAX_FIELDS && fields[slot].inUse; i++) {
+		if (!fields[i].inUse || fields[i].lastRequest < fields[slot].lastRequest) slot = i;
+	}
+
+	Field& field = fields[slot];
+	field.generation = (field.generation + 1) & 0x0FFFFFFF;
+	field.inUse = true;
+	field.targetCell = target;
+	field.lastRequest = requests;
+
+	const size_t cells = (size_t)width * depth;
+	field.cost.assign(cells, numeric_limits<float>::infinity());
+	field.length.assign(cells, 0.0f);
+	field.direction.assign(cells, NO_DIRECTION);
+	field.settled.assign(cells, 0);
+	field.open.clear();
+	field.cost[target] = 0.0f;
+	field.open.push_back({ 0.0f, target });
+	return (int)(field.generation << SLOT_BITS) | slot;
+}
+
+int FlowFields::settle(Field& field, int budget) {
+	const auto closer = greater<pair<float, int>>();
+	int count = 0;
+	while (count < budget && !field.open.empty()) {
+		pop_heap(field.open.begin(), field.open.end(), closer);
+		const pair<float, int> next = field.open.back();
+		field.open.pop_back();
+		const int cell = next.second;
+		if (field.settled[cell] || next.first > field.cost[cell]) continue;	// Superseded entry
+		field.settled[cell] = 1;
+		count++;
+
+		const int cellX = cell % width, cellZ = cell / width;
+		for (int k = 0; k < 8; k++) {
+			const int x = cellX + STEP_X[k], z = cellZ + STEP_Z[k];
+			if (x < 0 || x >= width || z < 0 || z >= depth) continue;
+			const int neighbour = z * width + x;
+			if (field.settled[neighbour]) continue;
+
+			// A diagonal past water counts as over water, so paths never clip a shoreline
+			const bool onLand = walkable[neighbour] && (!(k & 1) || (walkable[cellZ * width + x] && walkable[z * width + cellX]));
+			const float cost = next.first + (onLand ? STEP_COST[k] : STEP_COST[k] * WATER_COST);
+			if (cost < field.cost[neighbour]) {
+				field.cost[neighbour] = cost;
+				field.length[neighbour] = field.length[cell] + STEP_COST[k];
+				field.direction[neighbour] = (uint8_t)((k + 4) & 7);
+				field.open.push_back({ cost, neighbour });
+				push_heap(field.open.begin(), field.open.end(), closer);
+			}
+		}
+	}
+	return count;
+}
+
+void FlowFields::update(JobSystem* jobs) {
+	lastSettled = 0;
+	Field* building[MAX_FIELDS];
+	int count = 0;
+	for (Field& field : fields) {
+		if (field.inUse && !field.open.empty()) building[count++] = &field;
+	}
+	if (count == 0) return;
+
+	// Fields share nothing but the read-only grid, so each can grow on its own thread
+	const int share = max(cellBudget / count, 1);
+	atomic<int> settled{ 0 };
+	auto grow = [&](int begin, int end) {
+		for (int i = begin; i < end; i++) settled.fetch_add(settle(*building[i], share), memory_order_relaxed);
+	};
+	if (jobs) jobs->parallelFor(count, 1, grow);
+	else grow(0, count);
+	lastSettled = settled.load(memory_order_relaxed);
+}
+
+const FlowFields::Field* FlowFields::find(int handle) const {
+	if (handle < 0) return nullptr;
+	const Field& field = fields[handle & (MAX_FIELDS - 1)];
+	return field.inUse && (uint32_t)(handle >> SLOT_BITS) == field.generation ? &field : nullptr;
+}
+
+bool FlowFields::sample(int handle, float x, float z, FlowFieldSample& out) const {
+	const Field* field = find(handle);
+	if (!field) return false;
+
+	const float fx = (x - originX) * inverseCell, fz = (z - originZ) * inverseCell;
+	if (!(fx >= 0.0f && fx < (float)width && fz >= 0.0f && fz < (float)depth)) return false;
+	const size_t cell = (size_t)fz * width + (size_t)fx;
+	if (!field->settled[cell]) {
+		out = FlowFieldSample();
+		return true;
+	}
+	if (field->direction[cell] == NO_DIRECTION) return false;
+
+	const uint8_t k = field->direction[cell];
+	out.directionX = DIRECTION_X[k];
+	out.directionZ = DIRECTION_Z[k];
+	out.distance = field->length[cell] * cellSize;
+	return true;
+}
+
+bool FlowFields::isComplete(int handle) const {
+	const Field* field = find(handle);
+	return field && field->open.empty();
+}
+
+int FlowFields::getBuildingCount() const {
+	int count = 0;
+	for (const Field& field : fields) {
+		if (field.inUse && !field.open.empty()) count++;
+	}
+	return count;
+}
@@ -0,0 +1,82 @@
+#pragma once
+// Shared navigation towards sonar pings. A field covers a grid over the islands and bridges and stores, for every
+// cell, the path cost to its target and which neighbour to step to next, so any number of agents steer towards the
+// same ping by sampling their own cell in O(1). Fields grow outwards from the target with Dijkstra over 8-connected
+// cells (octile step costs), a close stand-in for an eikonal solve. Steps over water cost WATER_COST times as much,
+// so paths keep to islands and bridges and an agent caught over water heads for the land that leads on. Each update
+// settles a fixed budget of cells shared between every field still building, so a ping never costs a frame spike;
+// settled cells can be sampled straight away, the rest sample as a standstill until the field reaches them.
+
+#include "JobSystem.h"
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// Row-major walkability grid (x fastest) with cell (0, 0) at origin
+struct FlowFieldGrid {
+	float originX = 0.0f, originZ = 0.0f;
+	float cellSize = 1.0f;
+	int width = 0, depth = 0;
+	vector<uint8_t> walkable;	// Non-zero on islands and bridges
+};
+
+struct FlowFieldSample {
+	float directionX = 0.0f, directionZ = 0.0f;	// Unit step towards the target; zero until the field reaches here
+	float distance = 0.0f;	// Along the path, in world units
+};
+
+class FlowFields {
+public:
+	void setGrid(const FlowFieldGrid& grid);	// Drops every field
+	void setCellBudget(int cellsPerUpdate) { cellBudget = cellsPerUpdate < 1 ? 1 : cellsPerUpdate; }
+
+	// Handle of a field leading to (x, z), shared with any field already heading for the same cell. Targets over
+	// water use the nearest walkable cell within SEED_SEARCH_RADIUS, if any; -1 when (x, z) is off the grid.
+	int request(float x, float z);
+
+	// Settles up to the cell budget, split evenly between fields still building, one job per field when given jobs
+	void update(JobSystem* jobs = nullptr);
+
+	// False when the handle is stale, the point is off the grid, or it is in the target cell
+	bool sample(int field, float x, float z, FlowFieldSample& out) const;
+
+	bool isComplete(int field) const;
+	int getBuildingCount() const;
+	int getLastSettledCount() const { return lastSettled; }
+	int getCellCount() const { return width * depth; }
+
+	static constexpr int MAX_FIELDS = 8;	// Least recently requested is recycled; its handles go stale
+	static constexpr int DEFAULT_CELL_BUDGET = 4096;
+	static constexpr float WATER_COST = 8.0f;
+	static constexpr int SEED_SEARCH_RADIUS = 4;
+
+private:
+	static constexpr uint8_t NO_DIRECTION = 0xFF;
+	static constexpr int SLOT_BITS = 3;	// Handles are generation << SLOT_BITS | slot
+
+	struct Field {
+		uint32_t generation = 0;
+		bool inUse = false;
+		int targetCell = -1;
+		uint64_t lastRequest = 0;
+		vector<float> cost;	// Path cost in cells, water weighted; tentative until settled
+		vector<float> length;	// Unweighted length of the same path
+		vector<uint8_t> direction;	// Neighbour towards the target
+		vector<uint8_t> settled;
+		vector<pair<float, int>> open;	// Min-heap on cost
+	};
+
+	const Field* find(int handle) const;
+	int settle(Field& field, int budget);
+	int nearestWalkable(int cellX, int cellZ) const;
+
+	float originX = 0.0f, originZ = 0.0f, cellSize = 1.0f, inverseCell = 1.0f;
+	int width = 0, depth = 0;
+	vector<uint8_t> walkable;
+
+	Field fields[MAX_FIELDS];
+	uint64_t requests = 0;
+	int cellBudget = DEFAULT_CELL_BUDGET;
+	int lastSettled = 0;
+};
@@ -5,7 +5,7 @@ Ghost::Ghost() :sceneData(nullptr), audioSystem(nullptr), islandBounds(nullptr)
 {
 }
 
-void Ghost::Initialize(FMODAudioSystem* audioSys, SceneData* sceneData) {
+void Ghost::Initialize(AudioSystem* audioSys, SceneData* sceneData) {
 	audioSystem = audioSys;
 	this->sceneData = sceneData;
 }
@@ -49,7 +49,7 @@ void Ghost::Respawn() {
 		islandBounds &&
 		!islandBounds->GetIslands().empty()) {
 
-		const std::vector<Island>& islands = islandBounds->GetIslands();
+		const IslandList& islands = islandBounds->GetIslands();
 		sceneData->ghostData.currentIslandIndex = rand() % islands.size();
 		const Island& island = islands[sceneData->ghostData.currentIslandIndex];
 
@@ -1,6 +1,6 @@
 #pragma once
 #include <DirectXMath.h>
-#include "FMODAudioSystem.h"
+#include "AudioSystem.h"
 #include "Islands.h"
 #include "SceneData.h"
 
@@ -13,7 +13,7 @@ public:
 	Ghost();
 	~Ghost() = default;
 
-	void Initialize(FMODAudioSystem* audioSystem, SceneData* sceneData);
+	void Initialize(AudioSystem* audioSystem, SceneData* sceneData);
 	void Update(float deltaTime, const XMFLOAT3& playerPosition);
 	void Render(const XMMATRIX& worldMatrix, const XMMATRIX& viewMatrix, const XMMATRIX& projectionMatrix, int sceneWidth, int sceneHeight, const XMFLOAT3& cameraPosition);
 	void HandleSonar(const XMFLOAT3& sonarPosition, float sonarDuration);
@@ -33,7 +33,7 @@ private:
 	void UpdateAudio(float deltaTime, const XMFLOAT3& listenerPosition);
 
 	SceneData* sceneData;
-	FMODAudioSystem* audioSystem;
+	AudioSystem* audioSystem;
 	Islands* islandBounds;
 	float chromaticTimeAccumulator = 0.0f;
 };
@@ -1,6 +1,6 @@
 #include "GhostShader.h"
 
-GhostShader::GhostShader(ID3D11Device* device, HWND hwnd) : BaseShader(device, hwnd)
+GhostShader::GhostShader(ID3D11Device* device, HWND hwnd, SceneConstants* sceneConstants) : BaseShader(device, hwnd), sceneConstants(sceneConstants)
 {
 	initShader(L"firefly_vs.cso", L"firefly_ps.cso");
 }
@@ -27,12 +27,6 @@ GhostShader::~GhostShader()
 		sampleStateShadow->Release();
 		sampleStateShadow = 0;
 	}
-	if (lightBuffer)
-	{
-		lightBuffer->Release();
-		lightBuffer = 0;
-	}
-
 	// Release the camera constant buffer.
 	if (cameraBuffer)
 	{
@@ -63,15 +57,6 @@ void GhostShader::initShader(const wchar_t* vsFilename, const wchar_t* psFilenam
 	bufferDesc.StructureByteStride = 0;
 	renderer->CreateBuffer(&bufferDesc, NULL, &matrixBuffer);
 
-	// Setup light buffer
-	bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-	bufferDesc.ByteWidth = sizeof(LightBufferType);
-	bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-	bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-	bufferDesc.MiscFlags = 0;
-	bufferDesc.StructureByteStride = 0;
-	renderer->CreateBuffer(&bufferDesc, NULL, &lightBuffer);
-
 	// Setup the description of the camera dynamic constant buffer that is in the vertex shader.
 	bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
 	bufferDesc.ByteWidth = sizeof(CameraBufferType);
@@ -109,11 +94,10 @@ void GhostShader::initShader(const wchar_t* vsFilename, const wchar_t* psFilenam
 	renderer->CreateSamplerState(&shadowSamplerDesc, &sampleStateShadow);
 }
 
-void GhostShader::setShaderParameters(ID3D11DeviceContext* deviceContext, const XMMATRIX& worldMatrix, const XMMATRIX& viewMatrix, const XMMATRIX& projectionMatrix, ID3D11ShaderResourceView* texture, Camera* camera, Light* light, Light* directionalLight, SceneData* sceneData)
+void GhostShader::setShaderParameters(ID3D11DeviceContext* deviceContext, const XMMATRIX& worldMatrix, const XMMATRIX& viewMatrix, const XMMATRIX& projectionMatrix, ID3D11ShaderResourceView* texture, Camera* camera, Light* light, Light* directionalLight)
 {
 	D3D11_MAPPED_SUBRESOURCE mappedResource;
 	MatrixBufferType* dataPtr;
-	LightBufferType* lightPtr;
 
 	// Transpose the matrices to prepare them for the shader.
 	XMMATRIX tworld = XMMatrixTranspose(worldMatrix);
@@ -137,41 +121,9 @@ void GhostShader::setShaderParameters(ID3D11DeviceContext* deviceContext, const
 	deviceContext->Unmap(cameraBuffer, 0);
 	deviceContext->VSSetConstantBuffers(1, 1, &cameraBuffer);
 
-	//Additional
-	// Send light data to pixel shader
-	deviceContext->Map(lightBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
-	lightPtr = (LightBufferType*)mappedResource.pData;
-
-	lightPtr->ambientColour = XMFLOAT4(sceneData->lightData.ambientColour);
-	lightPtr->diffuseColour = XMFLOAT4(sceneData->lightData.diffuseColour);
-
-	lightPtr->pointLight1Position = XMFLOAT3(sceneData->lightData.pointLight_pos1);
-	lightPtr->pointLight1Radius = sceneData->lightData.pointLightRadius[0];
-	lightPtr->pointLight1Colour = XMFLOAT4(sceneData->lightData.pointLight1Colour);
-
-	lightPtr->pointLight2Position = XMFLOAT3(sceneData->lightData.pointLight_pos2);
-	lightPtr->pointLight2Radius = sceneData->lightData.pointLightRadius[1];
-	lightPtr->pointLight2Colour = XMFLOAT4(sceneData->lightData.pointLight2Colour);
-
-	lightPtr->spotlightColour = XMFLOAT4(sceneData->shadowLightsData.spotColour);
-	lightPtr->spotlightCutoff = sceneData->shadowLightsData.spotCutoff;
-	lightPtr->spotlightDirection = XMFLOAT3(sceneData->shadowLightsData.lightDirections[0]);
-	lightPtr->spotlightFalloff = sceneData->shadowLightsData.spotFalloff;
-
-	lightPtr->moonPos = XMFLOAT3(sceneData->moonData.moon_pos);
-	lightPtr->specularColour = XMFLOAT4(sceneData->lightData.specularColour);
-	lightPtr->specularPower = sceneData->lightData.spec_pow;
-
-	lightPtr->timeVal = sceneData->waterData.timeVal;
-
-	lightPtr->padding = XMFLOAT2(0.f, 0.f);
-	lightPtr->padding2 = 1.f;
-
-	lightPtr->directionalLightDirection = XMFLOAT3(sceneData->shadowLightsData.lightDirections[1]);
-	lightPtr->directionalColour = XMFLOAT4(sceneData->shadowLightsData.dirColour);
-
-	deviceContext->Unmap(lightBuffer, 0);
-	deviceContext->PSSetConstantBuffers(0, 1, &lightBuffer);
+	// Lights and time, packed once a frame by SceneConstants; b1 is rebound each draw, the terrain's sonar sharing it
+	sceneConstants->bindLights(deviceContext);
+	sceneConstants->bindFrame(deviceContext);
 
 	// Pixel shader
 	deviceContext->PSSetShaderResources(0, 1, &texture);
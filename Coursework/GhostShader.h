@@ -3,6 +3,7 @@
 
 #include "DXF.h"
 #include "TeapotSpotlight.h"
+#include "SceneConstants.h"
 
 using namespace std;
 using namespace DirectX;
@@ -23,55 +24,20 @@ private:
 		float padding;
 	};
 
-	struct LightBufferType
-	{
-		XMFLOAT4 ambientColour;
-		XMFLOAT4 diffuseColour;
-
-		XMFLOAT3 pointLight1Position;
-		float pointLight1Radius;
-		XMFLOAT4 pointLight1Colour;
-
-		XMFLOAT3 pointLight2Position;
-		float pointLight2Radius;
-		XMFLOAT4 pointLight2Colour;
-
-		XMFLOAT4 spotlightColour;
-
-		float spotlightCutoff;
-		XMFLOAT3 spotlightDirection;
-
-		float spotlightFalloff;
-		XMFLOAT3 moonPos;
-
-		XMFLOAT4 specularColour;
-		float specularPower;
-
-		float timeVal;
-
-		XMFLOAT2 padding;
-
-		float padding2;
-		XMFLOAT3 directionalLightDirection;
-
-		XMFLOAT4 directionalColour;
-
-	};
-
 public:
 
-	GhostShader(ID3D11Device* device, HWND hwnd);
+	GhostShader(ID3D11Device* device, HWND hwnd, SceneConstants* sceneConstants);
 	~GhostShader();
 
-	void setShaderParameters(ID3D11DeviceContext* deviceContext, const XMMATRIX& worldMatrix, const XMMATRIX& viewMatrix, const XMMATRIX& projectionMatrix, ID3D11ShaderResourceView* texture, Camera* camera, Light* light, Light* directionalLight, SceneData* sceneData);
+	void setShaderParameters(ID3D11DeviceContext* deviceContext, const XMMATRIX& worldMatrix, const XMMATRIX& viewMatrix, const XMMATRIX& projectionMatrix, ID3D11ShaderResourceView* texture, Camera* camera, Light* light, Light* directionalLight);
 
 private:
 	void initShader(const wchar_t* vs, const wchar_t* ps);
 
 private:
 	ID3D11Buffer* matrixBuffer;
-	ID3D11Buffer* lightBuffer;
 	ID3D11Buffer* cameraBuffer;
+	SceneConstants* sceneConstants;	// The lights, and the time the fireflies pulse to
 
 	ID3D11SamplerState* sampleState;
 	ID3D11SamplerState* sampleStateShadow;
@@ -0,0 +1,388 @@
+#include "GhostSwarm.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+	// xorshift32; never reaches 0 from a non-zero state
+	uint32_t nextState(uint32_t state) {
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return state;
+	}
+
+	// Top 23 bits as a float in [0, 1)
+	float unitFloat(uint32_t state) {
+		const uint32_t bits = (state >> 9) | 0x3F800000u;
+		float value;
+		memcpy(&value, &bits, sizeof(value));
+		return value - 1.0f;
+	}
+
+	// Decorrelates neighbouring ghosts' streams
+	uint32_t streamSeed(uint32_t seed, uint32_t index) {
+		uint32_t h = seed * 0x9E3779B9u + index * 0x85EBCA6Bu + 1u;
+		h ^= h >> 16;
+		h *= 0x7FEB352Du;
+		h ^= h >> 15;
+		h *= 0x846CA68Bu;
+		h ^= h >> 16;
+		return h ? h : 0x6D2B79F5u;
+	}
+}
+
+bool GhostSwarm::hasSimd() {
+#ifdef SIMD_MATH_SSE
+	return true;
+#else
+	return false;
+#endif
+}
+
+void GhostSwarm::resize(int newCount, uint32_t seed) {
+	newCount = max(newCount, 0);
+	for (vector<float>* column : { &positionX, &positionY, &positionZ, &velocityX, &velocityY, &velocityZ, &anchorX, &anchorZ,
+		&directionTimer, &nextDirectionTime, &aliveTime, &sonarTimer, &targetX, &targetY, &targetZ, &waterHeight }) column->resize(newCount, 0.0f);
+	active.resize(newCount, 0);
+	responding.resize(newCount, 0);
+	island.resize(newCount, -1);
+	field.resize(newCount, -1);
+
+	rng.resize(newCount);
+	for (int i = count; i < newCount; i++) rng[i] = streamSeed(seed, (uint32_t)i);
+	count = newCount;
+}
+
+void GhostSwarm::setIslands(const vector<GhostVector>& centres) {
+	islands = centres;
+	fill(active.begin(), active.end(), 0);
+	fill(responding.begin(), responding.end(), 0);
+}
+
+void GhostSwarm::respondToSonar(const GhostVector& target, float duration, int flowField, float radius) {
+	sonarDuration = duration;
+	const float radiusSq = radius * radius;
+	for (int i = 0; i < count; i++) {
+		if (!active[i]) continue;
+		const float dx = target.x - positionX[i], dy = target.y - positionY[i], dz = target.z - positionZ[i];
+		if (dx * dx + dy * dy + dz * dz > radiusSq) continue;
+		startResponse(i, target, 0.0f, flowField);
+	}
+}
+
+void GhostSwarm::respondToSonar(const vector<int>& ghosts, const GhostVector& target, float duration, float elapsed, int flowField) {
+	sonarDuration = duration;
+	for (int i : ghosts) {
+		if (i >= 0 && i < count && active[i] && elapsed < duration) startResponse(i, target, elapsed, flowField);
+	}
+}
+
+void GhostSwarm::startResponse(int i, const GhostVector& target, float elapsed, int flowField) {
+	responding[i] = -1;
+	sonarTimer[i] = elapsed;
+	targetX[i] = target.x;
+	targetY[i] = target.y;
+	targetZ[i] = target.z;
+	field[i] = flowField;
+}
+
+int GhostSwarm::closest(const GhostVector& point) const {
+	int best = -1;
+	float bestSq = 0.0f;
+	for (int i = 0; i < count; i++) {
+		if (!active[i]) continue;
+		const float dx = positionX[i] - point.x, dy = positionY[i] - point.y, dz = positionZ[i] - point.z;
+		const float distanceSq = dx * dx + dy * dy + dz * dz;
+		if (best < 0 || distanceSq < bestSq) {
+			best = i;
+			bestSq = distanceSq;
+		}
+	}
+	return best;
+}
+
+float GhostSwarm::random(int i, float min, float max) {
+	rng[i] = nextState(rng[i]);
+	return min + (max - min) * unitFloat(rng[i]);
+}
+
+void GhostSwarm::relocate(int i) {
+	if (islands.empty()) return;
+	rng[i] = nextState(rng[i]);
+	island[i] = (int32_t)(rng[i] % (uint32_t)islands.size());
+	const GhostVector& centre = islands[island[i]];
+
+	anchorX[i] = centre.x;
+	anchorZ[i] = centre.z;
+	positionX[i] = centre.x + random(i, -SPAWN_SCATTER, SPAWN_SCATTER);
+	positionY[i] = centre.y + SPAWN_HEIGHT;
+	positionZ[i] = centre.z + random(i, -SPAWN_SCATTER, SPAWN_SCATTER);
+}
+
+bool GhostSwarm::respawn(int i) {
+	if (islands.empty()) {
+		active[i] = 0;
+		return false;
+	}
+
+	relocate(i);
+	velocityX[i] = random(i, -1.0f, 1.0f) * SPAWN_SPEED;
+	velocityY[i] = 0.0f;
+	velocityZ[i] = random(i, -1.0f, 1.0f) * SPAWN_SPEED;
+	aliveTime[i] = MAX_LIFETIME;
+	directionTimer[i] = 0.0f;
+	nextDirectionTime[i] = random(i, FIRST_DIRECTION_TIME_MIN, FIRST_DIRECTION_TIME_MAX);
+	sonarTimer[i] = 0.0f;
+	active[i] = -1;
+	responding[i] = 0;
+	return true;
+}
+
+// Reference path; the SSE one below does the same arithmetic and the same draws four ghosts at a time
+void GhostSwarm::updateScalar(int i, float deltaTime, bool& respawnGhost, bool& relocateGhost) {
+	respawnGhost = relocateGhost = false;
+	if (!active[i]) {
+		respawnGhost = true;
+		return;
+	}
+
+	if (responding[i]) {
+		sonarTimer[i] += deltaTime;
+		const float dx = targetX[i] - positionX[i], dy = targetY[i] - positionY[i], dz = targetZ[i] - positionZ[i];
+		const float distanceSq = dx * dx + dy * dy + dz * dz;
+
+		if (distanceSq < ARRIVAL_DISTANCE * ARRIVAL_DISTANCE || sonarTimer[i] >= sonarDuration) {
+			// Back to wandering somewhere else, picking a new direction straight away
+			responding[i] = 0;
+			sonarTimer[i] = 0.0f;
+			directionTimer[i] = 0.0f;
+			nextDirectionTime[i] = 0.0f;
+			relocateGhost = true;
+		}
+		else {
+			// Whatever speed lands on the target as the ping ends, along the flow field's path when it has one here
+			const float inverseRemaining = 1.0f / (sonarDuration - sonarTimer[i]);
+			float stepX = dx, stepZ = dz;
+			FlowFieldSample sample;
+			if (flowFields && flowFields->sample(field[i], positionX[i], positionZ[i], sample)) {
+				stepX = sample.directionX * sample.distance;
+				stepZ = sample.directionZ * sample.distance;
+			}
+			velocityX[i] = stepX * inverseRemaining;
+			velocityY[i] = dy * inverseRemaining;
+			velocityZ[i] = stepZ * inverseRemaining;
+		}
+	}
+	else {
+		aliveTime[i] -= deltaTime;
+		respawnGhost = aliveTime[i] <= 0.0f;
+
+		const float minX = anchorX[i] - WANDER_HALF_SIZE, maxX = anchorX[i] + WANDER_HALF_SIZE;
+		const float minZ = anchorZ[i] - WANDER_HALF_SIZE, maxZ = anchorZ[i] + WANDER_HALF_SIZE;
+		bool bounced = false;
+		if (positionX[i] < minX || positionX[i] > maxX) {
+			velocityX[i] = -velocityX[i];
+			bounced = true;
+		}
+		if (positionZ[i] < minZ || positionZ[i] > maxZ) {
+			velocityZ[i] = -velocityZ[i];
+			bounced = true;
+		}
+		positionX[i] = max(minX, min(maxX, positionX[i]));
+		positionZ[i] = max(minZ, min(maxZ, positionZ[i]));
+
+		if (bounced) {
+			directionTimer[i] = 0.0f;
+			nextDirectionTime[i] = random(i, DIRECTION_TIME_MIN, DIRECTION_TIME_MAX);
+		}
+
+		directionTimer[i] += deltaTime;
+		if (directionTimer[i] >= nextDirectionTime[i]) {
+			velocityX[i] = random(i, WANDER_SPEED_MIN, WANDER_SPEED_MAX);
+			velocityY[i] = 0.0f;
+			velocityZ[i] = random(i, WANDER_SPEED_MIN, WANDER_SPEED_MAX);
+			directionTimer[i] = 0.0f;
+			nextDirectionTime[i] = random(i, DIRECTION_TIME_MIN, DIRECTION_TIME_MAX);
+		}
+	}
+
+	positionX[i] += velocityX[i] * deltaTime;
+	positionY[i] += velocityY[i] * deltaTime;
+	positionZ[i] += velocityZ[i] * deltaTime;
+}
+
+int GhostSwarm::updateBatch(int first, float deltaTime) {
+#ifdef SIMD_MATH_SSE
+	const __m128 zero = _mm_setzero_ps(), dt = _mm_set1_ps(deltaTime);
+	const __m128 signBit = _mm_castsi128_ps(_mm_set1_epi32((int)0x80000000));
+	auto select = [](__m128 mask, __m128 a, __m128 b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); };
+
+	// One draw on the lanes in mask; the others keep their state, exactly as if they had not drawn
+	__m128i state = _mm_loadu_si128((const __m128i*)&rng[first]);
+	auto draw = [&](__m128 mask, float min, float max) {
+		__m128i next = _mm_xor_si128(state, _mm_slli_epi32(state, 13));
+		next = _mm_xor_si128(next, _mm_srli_epi32(next, 17));
+		next = _mm_xor_si128(next, _mm_slli_epi32(next, 5));
+		const __m128i laneMask = _mm_castps_si128(mask);
+		state = _mm_or_si128(_mm_and_si128(laneMask, next), _mm_andnot_si128(laneMask, state));
+		const __m128 unit = _mm_sub_ps(_mm_castsi128_ps(_mm_or_si128(_mm_srli_epi32(next, 9), _mm_set1_epi32(0x3F800000))), _mm_set1_ps(1.0f));
+		return _mm_add_ps(_mm_set1_ps(min), _mm_mul_ps(_mm_set1_ps(max - min), unit));
+	};
+
+	const __m128 isActive = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)&active[first]));
+	const __m128 isResponding = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)&responding[first]));
+	const __m128 sonar = _mm_and_ps(isActive, isResponding);
+	const __m128 wander = _mm_andnot_ps(isResponding, isActive);
+
+	__m128 px = _mm_loadu_ps(&positionX[first]), py = _mm_loadu_ps(&positionY[first]), pz = _mm_loadu_ps(&positionZ[first]);
+	__m128 vx = _mm_loadu_ps(&velocityX[first]), vy = _mm_loadu_ps(&velocityY[first]), vz = _mm_loadu_ps(&velocityZ[first]);
+	__m128 timer = _mm_loadu_ps(&directionTimer[first]), nextTime = _mm_loadu_ps(&nextDirectionTime[first]);
+	__m128 alive = _mm_loadu_ps(&aliveTime[first]), sonarTime = _mm_loadu_ps(&sonarTimer[first]);
+
+	// Sonar response
+	sonarTime = select(sonar, _mm_add_ps(sonarTime, dt), sonarTime);
+	const __m128 dx = _mm_sub_ps(_mm_loadu_ps(&targetX[first]), px);
+	const __m128 dy = _mm_sub_ps(_mm_loadu_ps(&targetY[first]), py);
+	const __m128 dz = _mm_sub_ps(_mm_loadu_ps(&targetZ[first]), pz);
+	const __m128 distanceSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+	const __m128 duration = _mm_set1_ps(sonarDuration);
+	const __m128 arrived = _mm_and_ps(sonar, _mm_or_ps(_mm_cmplt_ps(distanceSq, _mm_set1_ps(ARRIVAL_DISTANCE * ARRIVAL_DISTANCE)),
+		_mm_cmpge_ps(sonarTime, duration)));
+	const __m128 steer = _mm_andnot_ps(arrived, sonar);
+
+	const __m128 inverseRemaining = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sub_ps(duration, sonarTime));
+	__m128 stepX = dx, stepZ = dz;
+	const int steering = _mm_movemask_ps(steer);
+	if (steering && flowFields) {
+		// Flow field samples are gathered a lane at a time; lanes without one keep the straight line
+		alignas(16) float fieldX[4], fieldZ[4];
+		alignas(16) float positionLanesX[4], positionLanesZ[4], dxLanes[4], dzLanes[4];
+		_mm_store_ps(positionLanesX, px);
+		_mm_store_ps(positionLanesZ, pz);
+		_mm_store_ps(dxLanes, dx);
+		_mm_store_ps(dzLanes, dz);
+		for (int lane = 0; lane < 4; lane++) {
+			FlowFieldSample sample;
+			if ((steering & (1 << lane)) && flowFields->sample(field[first + lane], positionLanesX[lane], positionLanesZ[lane], sample)) {
+				fieldX[lane] = sample.directionX * sample.distance;
+				fieldZ[lane] = sample.directionZ * sample.distance;
+			}
+			else {
+				fieldX[lane] = dxLanes[lane];
+				fieldZ[lane] = dzLanes[lane];
+			}
+		}
+		stepX = _mm_load_ps(fieldX);
+		stepZ = _mm_load_ps(fieldZ);
+	}
+	vx = select(steer, _mm_mul_ps(stepX, inverseRemaining), vx);
+	vy = select(steer, _mm_mul_ps(dy, inverseRemaining), vy);
+	vz = select(steer, _mm_mul_ps(stepZ, inverseRemaining), vz);
+	sonarTime = _mm_andnot_ps(arrived, sonarTime);
+	timer = _mm_andnot_ps(arrived, timer);
+	nextTime = _mm_andnot_ps(arrived, nextTime);
+
+	// Wandering
+	alive = select(wander, _mm_sub_ps(alive, dt), alive);
+	const __m128 expired = _mm_and_ps(wander, _mm_cmple_ps(alive, zero));
+
+	const __m128 half = _mm_set1_ps(WANDER_HALF_SIZE);
+	const __m128 ax = _mm_loadu_ps(&anchorX[first]), az = _mm_loadu_ps(&anchorZ[first]);
+	const __m128 minX = _mm_sub_ps(ax, half), maxX = _mm_add_ps(ax, half);
+	const __m128 minZ = _mm_sub_ps(az, half), maxZ = _mm_add_ps(az, half);
+	const __m128 outX = _mm_and_ps(wander, _mm_or_ps(_mm_cmplt_ps(px, minX), _mm_cmpgt_ps(px, maxX)));
+	const __m128 outZ = _mm_and_ps(wander, _mm_or_ps(_mm_cmplt_ps(pz, minZ), _mm_cmpgt_ps(pz, maxZ)));
+	vx = _mm_xor_ps(vx, _mm_and_ps(outX, signBit));
+	vz = _mm_xor_ps(vz, _mm_and_ps(outZ, signBit));
+	px = select(wander, _mm_max_ps(minX, _mm_min_ps(maxX, px)), px);
+	pz = select(wander, _mm_max_ps(minZ, _mm_min_ps(maxZ, pz)), pz);
+
+	// Bounces and direction changes are rare, so batches with neither skip the draws
+	const __m128 bounced = _mm_or_ps(outX, outZ);
+	if (_mm_movemask_ps(bounced)) {
+		timer = _mm_andnot_ps(bounced, timer);
+		nextTime = select(bounced, draw(bounced, DIRECTION_TIME_MIN, DIRECTION_TIME_MAX), nextTime);
+	}
+
+	timer = select(wander, _mm_add_ps(timer, dt), timer);
+	const __m128 change = _mm_and_ps(wander, _mm_cmpge_ps(timer, nextTime));
+	if (_mm_movemask_ps(change)) {
+		vx = select(change, draw(change, WANDER_SPEED_MIN, WANDER_SPEED_MAX), vx);
+		vy = _mm_andnot_ps(change, vy);
+		vz = select(change, draw(change, WANDER_SPEED_MIN, WANDER_SPEED_MAX), vz);
+		timer = _mm_andnot_ps(change, timer);
+		nextTime = select(change, draw(change, DIRECTION_TIME_MIN, DIRECTION_TIME_MAX), nextTime);
+	}
+
+	px = select(isActive, _mm_add_ps(px, _mm_mul_ps(vx, dt)), px);
+	py = select(isActive, _mm_add_ps(py, _mm_mul_ps(vy, dt)), py);
+	pz = select(isActive, _mm_add_ps(pz, _mm_mul_ps(vz, dt)), pz);
+
+	_mm_storeu_ps(&positionX[first], px);
+	_mm_storeu_ps(&positionY[first], py);
+	_mm_storeu_ps(&positionZ[first], pz);
+	_mm_storeu_ps(&velocityX[first], vx);
+	_mm_storeu_ps(&velocityY[first], vy);
+	_mm_storeu_ps(&velocityZ[first], vz);
+	_mm_storeu_ps(&directionTimer[first], timer);
+	_mm_storeu_ps(&nextDirectionTime[first], nextTime);
+	_mm_storeu_ps(&aliveTime[first], alive);
+	_mm_storeu_ps(&sonarTimer[first], sonarTime);
+	_mm_storeu_si128((__m128i*)&responding[first], _mm_castps_si128(_mm_andnot_ps(arrived, isResponding)));
+	_mm_storeu_si128((__m128i*)&rng[first], state);
+
+	const int respawnLanes = _mm_movemask_ps(_mm_or_ps(expired, _mm_cmpeq_ps(isActive, zero)));
+	return respawnLanes | (_mm_movemask_ps(arrived) << 4);
+#else
+	int lanes = 0;
+	for (int lane = 0; lane < 4; lane++) {
+		bool respawnGhost, relocateGhost;
+		updateScalar(first + lane, deltaTime, respawnGhost, relocateGhost);
+		if (respawnGhost) lanes |= 1 << lane;
+		if (relocateGhost) lanes |= 16 << lane;
+	}
+	return lanes;
+#endif
+}
+
+int GhostSwarm::updateRange(int first, int end, float deltaTime) {
+	int respawns = 0;
+	const int batched = simd ? first + ((end - first) & ~3) : first;
+	for (int batch = first; batch < batched; batch += 4) {
+		const int lanes = updateBatch(batch, deltaTime);
+		if (!lanes) continue;
+		for (int lane = 0; lane < 4; lane++) {
+			if (lanes & (1 << lane)) respawns += respawn(batch + lane) ? 1 : 0;
+			else if (lanes & (16 << lane)) relocate(batch + lane);
+		}
+	}
+
+	for (int i = batched; i < end; i++) {
+		bool respawnGhost, relocateGhost;
+		updateScalar(i, deltaTime, respawnGhost, relocateGhost);
+		if (respawnGhost) respawns += respawn(i) ? 1 : 0;
+		else if (relocateGhost) relocate(i);
+	}
+	if (water) hoverAboveWater(first, end);
+	return respawns;
+}
+
+void GhostSwarm::hoverAboveWater(int first, int end) {
+	water->getHeights(&positionX[first], &positionZ[first], &waterHeight[first], end - first);
+	for (int i = first; i < end; i++) positionY[i] = max(positionY[i], waterHeight[i] + WATER_CLEARANCE);
+}
+
+void GhostSwarm::update(float deltaTime, JobSystem* jobs) {
+	if (!jobs || count < 2 * GHOSTS_PER_JOB) {
+		lastRespawns = updateRange(0, count, deltaTime);
+		return;
+	}
+
+	// Every ghost only touches its own slots, so ranges of whole batches run on any thread in any order
+	atomic<int> respawns{ 0 };
+	jobs->parallelFor((count + 3) / 4, GHOSTS_PER_JOB / 4, [&](int begin, int end) {
+		respawns.fetch_add(updateRange(begin * 4, min(end * 4, count), deltaTime), memory_order_relaxed);
+	});
+	lastRespawns = respawns.load(memory_order_relaxed);
+}
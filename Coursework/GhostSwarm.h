@@ -0,0 +1,99 @@
+#pragma once
+// Every ghost in the world, stored as structure of arrays so wandering, boundary bounce and sonar response run four
+// ghosts at a time, one per SSE lane. Each ghost draws from its own xorshift stream instead of the global rand(), so
+// a lane takes exactly the draws it would take on its own and the SSE path matches the scalar reference bit for bit.
+
+#include "FlowFields.h"
+#include "JobSystem.h"
+#include "SimdMath.h"
+#include "Vector3.h"
+#include "WaterSurface.h"
+#include <cstdint>
+#include <vector>
+
+typedef Vector3 GhostVector;
+
+using namespace std;
+
+class GhostSwarm {
+public:
+	GhostSwarm() : simd(hasSimd()) {}
+
+	// New ghosts start inactive and spawn on a random island on the next update
+	void resize(int count, uint32_t seed = 1);
+	// Island centres ghosts spawn on and wander around; every ghost respawns since its island may have moved
+	void setIslands(const vector<GhostVector>& centres);
+	void setSimd(bool enabled) { simd = enabled && hasSimd(); }
+	void setFlowFields(const FlowFields* fields) { flowFields = fields; }
+	void setWater(const WaterSurface* surface) { water = surface; }	// Ghosts hover at least WATER_CLEARANCE above it
+
+	// Active ghosts within radius of the ping head for it, arriving as it ends. With a flow field handle they follow
+	// its path over islands and bridges wherever it has one, and fly straight at the target elsewhere.
+	void respondToSonar(const GhostVector& target, float duration, int flowField = -1, float radius = 1e30f);
+	// Only the listed ghosts respond, joining elapsed seconds into the ping, so they still arrive as it ends
+	void respondToSonar(const vector<int>& ghosts, const GhostVector& target, float duration, float elapsed, int flowField = -1);
+	void update(float deltaTime, JobSystem* jobs = nullptr);	// Spread over the job system when there are enough ghosts
+
+	int size() const { return count; }
+	bool isActive(int i) const { return active[i] != 0; }
+	bool isRespondingToSonar(int i) const { return responding[i] != 0; }
+	GhostVector getPosition(int i) const { return GhostVector(positionX[i], positionY[i], positionZ[i]); }
+	GhostVector getVelocity(int i) const { return GhostVector(velocityX[i], velocityY[i], velocityZ[i]); }
+	int getIslandIndex(int i) const { return island[i]; }
+	float getAliveTime(int i) const { return aliveTime[i]; }
+	float getSonarTimer(int i) const { return sonarTimer[i]; }
+	float getDirectionTimer(int i) const { return directionTimer[i]; }
+	float getNextDirectionTime(int i) const { return nextDirectionTime[i]; }
+	int getLastRespawnCount() const { return lastRespawns; }
+
+	int closest(const GhostVector& point) const;	// Nearest active ghost, -1 when there is none
+
+	static bool hasSimd();
+
+	static constexpr float WANDER_HALF_SIZE = 25.0f;	// Bounce off a square this far either side of the island centre
+	static constexpr float WANDER_SPEED_MIN = 5.0f;
+	static constexpr float WANDER_SPEED_MAX = 8.0f;
+	static constexpr float DIRECTION_TIME_MIN = 5.0f;
+	static constexpr float DIRECTION_TIME_MAX = 10.0f;
+	static constexpr float FIRST_DIRECTION_TIME_MIN = 1.0f;
+	static constexpr float FIRST_DIRECTION_TIME_MAX = 2.0f;
+	static constexpr float SPAWN_HEIGHT = 3.0f;
+	static constexpr float SPAWN_SCATTER = 5.0f;
+	static constexpr float SPAWN_SPEED = 2.0f;
+	static constexpr float MAX_LIFETIME = 30.0f;
+	static constexpr float ARRIVAL_DISTANCE = 0.5f;
+	static constexpr float WATER_CLEARANCE = 1.5f;
+	static constexpr int GHOSTS_PER_JOB = 2048;
+
+private:
+	int updateRange(int first, int end, float deltaTime);	// Returns the respawn count
+	int updateBatch(int first, float deltaTime);	// Lanes to respawn in bits 0-3, to relocate in bits 4-7
+	void updateScalar(int i, float deltaTime, bool& respawn, bool& relocate);
+	void startResponse(int i, const GhostVector& target, float elapsed, int flowField);
+	bool respawn(int i);	// False when there is no island to spawn on
+	void relocate(int i);	// Onto a random island, keeping velocity and timers
+	void hoverAboveWater(int first, int end);
+	float random(int i, float min, float max);
+
+	int count = 0;
+
+	vector<float> positionX, positionY, positionZ;
+	vector<float> velocityX, velocityY, velocityZ;
+	vector<float> anchorX, anchorZ;	// Centre of the island being wandered
+	vector<float> directionTimer, nextDirectionTime;
+	vector<float> aliveTime;
+	vector<float> sonarTimer;
+	vector<float> targetX, targetY, targetZ;
+	vector<int32_t> active, responding;	// 0 or -1, so they load straight into SSE masks
+	vector<int32_t> island;
+	vector<int32_t> field;	// Flow field handle for the current sonar response
+	vector<uint32_t> rng;
+	vector<float> waterHeight;	// Scratch for the batched water queries
+
+	vector<GhostVector> islands;
+	const FlowFields* flowFields = nullptr;
+	const WaterSurface* water = nullptr;
+	float sonarDuration = 5.0f;
+	int lastRespawns = 0;
+	bool simd;
+};
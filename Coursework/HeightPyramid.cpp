@@ -0,0 +1,277 @@
+#include "HeightPyramid.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+	constexpr float HUGE_INVERSE = 1e30f;	// Reciprocal for a ray with no x or z movement; finite so 0 * it stays 0
+	constexpr float EPSILON = 1e-9f;
+	constexpr int MAX_LEVELS = 32;
+
+	bool solid(float height) {
+		return height > HeightPyramidGrid::NO_HEIGHT * 0.5f;
+	}
+
+	struct Node {
+		int level, x, z;
+		unsigned mask;	// Packet lanes still walking this node
+	};
+}
+
+void HeightPyramid::build(const HeightPyramidGrid& grid) {
+	levels.clear();
+	heights.clear();
+	width = depth = 0;
+	if (grid.width < 2 || grid.depth < 2 || grid.heights.size() < (size_t)grid.width * grid.depth || grid.cellSize <= 0.0f) return;
+
+	originX = grid.originX;
+	originZ = grid.originZ;
+	cellSize = grid.cellSize;
+	inverseCell = 1.0f / cellSize;
+	width = grid.width;
+	depth = grid.depth;
+	heights.assign(grid.heights.begin(), grid.heights.begin() + (size_t)width * depth);
+
+	// Cells: their corners bound the bilinear patch between them
+	Level cells;
+	cells.width = width - 1;
+	cells.depth = depth - 1;
+	cells.size = cellSize;
+	cells.ranges.resize((size_t)cells.width * cells.depth);
+	for (int z = 0; z < cells.depth; z++) {
+		for (int x = 0; x < cells.width; x++) {
+			const float* row = &heights[(size_t)z * width + x];
+			const float corners[4] = { row[0], row[1], row[width], row[width + 1] };
+			Range range = { 1e30f, -1e30f };
+			if (solid(corners[0]) && solid(corners[1]) && solid(corners[2]) && solid(corners[3])) {
+				range.low = min(min(corners[0], corners[1]), min(corners[2], corners[3]));
+				range.high = max(max(corners[0], corners[1]), max(corners[2], corners[3]));
+			}
+			cells.ranges[(size_t)z * cells.width + x] = range;
+		}
+	}
+	levels.push_back(move(cells));
+
+	// Each level up keeps the extremes of the 2x2 nodes under it, until one node covers everything
+	while ((levels.back().width > 1 || levels.back().depth > 1) && (int)levels.size() < MAX_LEVELS) {
+		const Level& below = levels.back();
+		Level level;
+		level.width = (below.width + 1) / 2;
+		level.depth = (below.depth + 1) / 2;
+		level.size = below.size * 2.0f;
+		level.ranges.assign((size_t)level.width * level.depth, { 1e30f, -1e30f });
+		for (int z = 0; z < below.depth; z++) {
+			for (int x = 0; x < below.width; x++) {
+				const Range& child = below.ranges[(size_t)z * below.width + x];
+				Range& parent = level.ranges[(size_t)(z / 2) * level.width + x / 2];
+				parent.low = min(parent.low, child.low);
+				parent.high = max(parent.high, child.high);
+			}
+		}
+		levels.push_back(move(level));
+	}
+}
+
+bool HeightPyramid::heightAt(float x, float z, float& height) const {
+	if (levels.empty()) return false;
+	const float gx = (x - originX) * inverseCell, gz = (z - originZ) * inverseCell;
+	if (gx < 0.0f || gz < 0.0f || gx > (float)(width - 1) || gz > (float)(depth - 1)) return false;
+
+	const int ix = min((int)gx, width - 2), iz = min((int)gz, depth - 2);
+	const float* row = &heights[(size_t)iz * width + ix];
+	if (!solid(row[0]) || !solid(row[1]) || !solid(row[width]) || !solid(row[width + 1])) return false;
+	const float fx = gx - ix, fz = gz - iz;
+	const float front = row[0] + (row[1] - row[0]) * fx;
+	const float back = row[width] + (row[width + 1] - row[width]) * fx;
+	height = front + (back - front) * fz;
+	return true;
+}
+
+HeightPyramid::Prepared HeightPyramid::prepare(const HeightRay& ray) const {
+	Prepared prepared;
+	const float length = sqrtf(ray.direction.x * ray.direction.x + ray.direction.y * ray.direction.y + ray.direction.z * ray.direction.z);
+	const float scale = length > EPSILON ? 1.0f / length : 0.0f;
+	prepared.originX = ray.origin.x;
+	prepared.originY = ray.origin.y;
+	prepared.originZ = ray.origin.z;
+	prepared.dirX = ray.direction.x * scale;
+	prepared.dirY = length > EPSILON ? ray.direction.y * scale : -1.0f;
+	prepared.dirZ = ray.direction.z * scale;
+	prepared.inverseX = fabsf(prepared.dirX) > EPSILON ? 1.0f / prepared.dirX : HUGE_INVERSE;
+	prepared.inverseZ = fabsf(prepared.dirZ) > EPSILON ? 1.0f / prepared.dirZ : HUGE_INVERSE;
+	prepared.start = 0.0f;
+	prepared.end = max(ray.length, 0.0f);
+	return prepared;
+}
+
+// The span of the ray over the node's square, or false when that misses the square, the node has no solid cell, or
+// the ray stays above the node's highest point all the way across
+bool HeightPyramid::enterNode(const Prepared& ray, int level, int x, int z, float& enter, float& exit) const {
+	const Level& node = levels[level];
+	const Range& range = node.ranges[(size_t)z * node.width + x];
+	if (range.low > range.high) return false;
+
+	const float x0 = originX + x * node.size, z0 = originZ + z * node.size;
+	float enterX = (x0 - ray.originX) * ray.inverseX, exitX = (x0 + node.size - ray.originX) * ray.inverseX;
+	float enterZ = (z0 - ray.originZ) * ray.inverseZ, exitZ = (z0 + node.size - ray.originZ) * ray.inverseZ;
+	if (enterX > exitX) swap(enterX, exitX);
+	if (enterZ > exitZ) swap(enterZ, exitZ);
+	enter = max(ray.start, max(enterX, enterZ));
+	exit = min(ray.end, min(exitX, exitZ));
+	if (enter > exit) return false;
+
+	const float lowest = ray.originY + ray.dirY * (ray.dirY < 0.0f ? exit : enter);
+	return lowest <= range.high;
+}
+
+// Exact crossing with the cell's bilinear patch. Measured from where the ray enters the cell, the patch's height along
+// the ray is quadratic, so the ray's height above it is too; the first point where that is no longer positive is the hit.
+bool HeightPyramid::hitCell(const Prepared& ray, int x, int z, float enter, float exit, HeightHit& hit) const {
+	const float* row = &heights[(size_t)z * width + x];
+	const float h00 = row[0], h10 = row[1], h01 = row[width], h11 = row[width + 1];
+	const float slopeU = h10 - h00, slopeV = h01 - h00, twist = h00 - h10 - h01 + h11;
+
+	const float startX = ray.originX + ray.dirX * enter, startZ = ray.originZ + ray.dirZ * enter;
+	const float startY = ray.originY + ray.dirY * enter;
+	const float u = (startX - (originX + x * cellSize)) * inverseCell, v = (startZ - (originZ + z * cellSize)) * inverseCell;
+	const float du = ray.dirX * inverseCell, dv = ray.dirZ * inverseCell;
+
+	const float a = startY - (h00 + slopeU * u + slopeV * v + twist * u * v);
+	const float b = ray.dirY - (slopeU * du + slopeV * dv + twist * (u * dv + v * du));
+	const float c = -twist * du * dv;
+	const float span = exit - enter;
+
+	float s = -1.0f;
+	if (a <= 0.0f) s = 0.0f;
+	else if (fabsf(c) < EPSILON) {
+		if (b < 0.0f) s = -a / b;
+	}
+	else {
+		const float discriminant = b * b - 4.0f * a * c;
+		if (discriminant >= 0.0f) {
+			const float q = -0.5f * (b + (b < 0.0f ? -sqrtf(discriminant) : sqrtf(discriminant)));
+			float first = q / c, second = fabsf(q) > EPSILON ? a / q : first;
+			if (first > second) swap(first, second);
+			s = first >= 0.0f ? first : second;
+		}
+	}
+	if (s < 0.0f || s > span) return false;
+
+	const float distance = enter + s;
+	hit.hit = true;
+	hit.distance = distance;
+	hit.point = HeightVector(ray.originX + ray.dirX * distance, ray.originY + ray.dirY * distance, ray.originZ + ray.dirZ * distance);
+
+	const float hitU = min(max(u + du * s, 0.0f), 1.0f), hitV = min(max(v + dv * s, 0.0f), 1.0f);
+	const float gradientX = (slopeU + twist * hitV) * inverseCell, gradientZ = (slopeV + twist * hitU) * inverseCell;
+	const float normalScale = 1.0f / sqrtf(gradientX * gradientX + 1.0f + gradientZ * gradientZ);
+	hit.normal = HeightVector(-gradientX * normalScale, normalScale, -gradientZ * normalScale);
+	return true;
+}
+
+bool HeightPyramid::raycast(const HeightRay& ray, HeightHit& hit, HeightRayStats* stats) const {
+	hit = HeightHit();
+	if (levels.empty()) return false;
+
+	const Prepared prepared = prepare(ray);
+	const int nearX = prepared.dirX < 0.0f, nearZ = prepared.dirZ < 0.0f;
+	HeightRayStats counts;
+
+	// Children are pushed far first, so the near one is walked first and the first hit is the nearest
+	Node stack[MAX_LEVELS * 3 + 1];
+	int top = 0;
+	stack[top++] = { (int)levels.size() - 1, 0, 0, 1u };
+	bool found = false;
+	while (top > 0 && !found) {
+		const Node node = stack[--top];
+		counts.nodes++;
+		float enter, exit;
+		if (!enterNode(prepared, node.level, node.x, node.z, enter, exit)) continue;
+
+		if (node.level == 0) {
+			counts.cells++;
+			found = hitCell(prepared, node.x, node.z, enter, exit, hit);
+			continue;
+		}
+		const Level& below = levels[node.level - 1];
+		for (int child = 3; child >= 0; child--) {
+			const int x = node.x * 2 + ((child & 1) ^ nearX), z = node.z * 2 + ((child >> 1) ^ nearZ);
+			if (x < below.width && z < below.depth) stack[top++] = { node.level - 1, x, z, 1u };
+		}
+	}
+
+	if (stats) {
+		stats->nodes += counts.nodes;
+		stats->cells += counts.cells;
+	}
+	return found;
+}
+
+void HeightPyramid::raycast(const HeightRay* rays, size_t count, HeightHit* hits, HeightRayStats* stats) const {
+	if (!packets || levels.empty()) {
+		for (size_t i = 0; i < count; i++) raycast(rays[i], hits[i], stats);
+		return;
+	}
+
+	// Grouped by heading, so every ray in a packet walks each node's children in the same near-to-far order. Order
+	// within a group is kept, so neighbouring rays from a camera stay together.
+	vector<int> headings[4];
+	for (size_t i = 0; i < count; i++) {
+		const int heading = (rays[i].direction.x < 0.0f ? 1 : 0) | (rays[i].direction.z < 0.0f ? 2 : 0);
+		headings[heading].push_back((int)i);
+	}
+
+	HeightRayStats counts;
+	for (const vector<int>& group : headings) {
+		for (size_t first = 0; first < group.size(); first += PACKET_SIZE) {
+			castPacket(rays, &group[first], (int)min((size_t)PACKET_SIZE, group.size() - first), hits, counts);
+		}
+	}
+	if (stats) {
+		stats->nodes += counts.nodes;
+		stats->cells += counts.cells;
+	}
+}
+
+// One walk for the whole packet: a node is entered when any lane still looking crosses it, and lanes drop out of the
+// walk as they hit. Each lane sees its nodes in the same order it would alone, so its first hit is its nearest.
+void HeightPyramid::castPacket(const HeightRay* rays, const int* indices, int count, HeightHit* hits, HeightRayStats& stats) const {
+	Prepared lanes[PACKET_SIZE];
+	for (int lane = 0; lane < count; lane++) {
+		lanes[lane] = prepare(rays[indices[lane]]);
+		hits[indices[lane]] = HeightHit();
+	}
+	const int nearX = rays[indices[0]].direction.x < 0.0f, nearZ = rays[indices[0]].direction.z < 0.0f;
+
+	unsigned looking = (1u << count) - 1u;
+	Node stack[MAX_LEVELS * 3 + 1];
+	int top = 0;
+	stack[top++] = { (int)levels.size() - 1, 0, 0, looking };
+	while (top > 0 && looking) {
+		const Node node = stack[--top];
+		const unsigned mask = node.mask & looking;
+		if (!mask) continue;
+		stats.nodes++;
+
+		unsigned inside = 0;
+		float enter[PACKET_SIZE], exit[PACKET_SIZE];
+		for (int lane = 0; lane < count; lane++) {
+			if ((mask >> lane & 1u) && enterNode(lanes[lane], node.level, node.x, node.z, enter[lane], exit[lane])) inside |= 1u << lane;
+		}
+		if (!inside) continue;
+
+		if (node.level == 0) {
+			for (int lane = 0; lane < count; lane++) {
+				if (!(inside >> lane & 1u)) continue;
+				stats.cells++;
+				if (hitCell(lanes[lane], node.x, node.z, enter[lane], exit[lane], hits[indices[lane]])) looking &= ~(1u << lane);
+			}
+			continue;
+		}
+		const Level& below = levels[node.level - 1];
+		for (int child = 3; child >= 0; child--) {
+			const int x = node.x * 2 + ((child & 1) ^ nearX), z = node.z * 2 + ((child >> 1) ^ nearZ);
+			if (x < below.width && z < below.depth) stack[top++] = { node.level - 1, x, z, inside };
+		}
+	}
+}
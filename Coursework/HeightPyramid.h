@@ -0,0 +1,92 @@
+#pragma once
+// Ray casts against the island heightfield through a min/max pyramid: level 0 holds each grid cell's lowest and
+// highest corner, and every level above halves the resolution, keeping the min and max of the four cells below. A ray
+// walks the pyramid front to back from the top, dropping any node it passes wholly above or that is all open water,
+// so it only reaches the cells right around where it meets the surface; those are solved exactly against the cell's
+// bilinear patch. Batches of rays heading the same way share one walk in packets, since they visit the same nodes.
+
+#include "Vector3.h"
+#include <cstddef>
+#include <vector>
+
+typedef Vector3 HeightVector;
+
+using namespace std;
+
+struct HeightPyramidGrid {
+	static constexpr float NO_HEIGHT = -1e30f;
+
+	// Row-major height at each vertex (x fastest) with vertex (0, 0) at origin; NO_HEIGHT where there is open water.
+	// A cell is solid when all four of its corners have a height.
+	float originX = 0.0f, originZ = 0.0f;
+	float cellSize = 1.0f;
+	int width = 0, depth = 0;
+	vector<float> heights;
+};
+
+struct HeightRay {
+	HeightVector origin;
+	HeightVector direction;	// Need not be unit length; distances are along it normalised
+	float length = 1e30f;
+};
+
+struct HeightHit {
+	bool hit = false;
+	float distance = 0.0f;
+	HeightVector point;
+	HeightVector normal;
+};
+
+// Work done by a batch of casts, for the debug UI and the benchmark
+struct HeightRayStats {
+	long long nodes = 0;	// Pyramid nodes tested against a ray or a packet
+	long long cells = 0;	// Exact cell tests
+};
+
+class HeightPyramid {
+public:
+	void build(const HeightPyramidGrid& grid);
+
+	// Nearest point along the ray at or under the surface; a ray starting under the surface hits where it starts
+	bool raycast(const HeightRay& ray, HeightHit& hit, HeightRayStats* stats = nullptr) const;
+	// Batched: rays are grouped by heading and walked in packets of PACKET_SIZE. Hits match raycast() ray for ray.
+	void raycast(const HeightRay* rays, size_t count, HeightHit* hits, HeightRayStats* stats = nullptr) const;
+
+	bool heightAt(float x, float z, float& height) const;	// False over open water or off the grid
+	bool isEmpty() const { return levels.empty(); }
+	int getLevelCount() const { return (int)levels.size(); }
+
+	void setPackets(bool enabled) { packets = enabled; }	// Off: the batched cast runs each ray on its own
+
+	static constexpr int PACKET_SIZE = 8;
+
+private:
+	struct Range {
+		float low, high;	// low > high for a node with no solid cell
+	};
+
+	struct Level {
+		int width, depth;
+		float size;	// Of a node, in world units
+		vector<Range> ranges;
+	};
+
+	// A ray in the form the walk uses: unit direction, its reciprocal on x and z, and the span still to search
+	struct Prepared {
+		float originX, originY, originZ;
+		float dirX, dirY, dirZ;
+		float inverseX, inverseZ;
+		float start, end;
+	};
+
+	Prepared prepare(const HeightRay& ray) const;
+	bool enterNode(const Prepared& ray, int level, int x, int z, float& enter, float& exit) const;
+	bool hitCell(const Prepared& ray, int x, int z, float enter, float exit, HeightHit& hit) const;
+	void castPacket(const HeightRay* rays, const int* indices, int count, HeightHit* hits, HeightRayStats& stats) const;
+
+	vector<Level> levels;	// levels[0] is the cells
+	vector<float> heights;
+	float originX = 0.0f, originZ = 0.0f, cellSize = 1.0f, inverseCell = 1.0f;
+	int width = 0, depth = 0;
+	bool packets = true;
+};
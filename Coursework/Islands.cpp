@@ -1,4 +1,6 @@
 #include "Islands.h"
+#include "FrameArena.h"
+#include <cmath>
 
 // Initialize island system with procedural generation parameters
 Islands::Islands(int cellSize, int islandCount)
@@ -104,40 +106,39 @@ void Islands::CalculateGridDimensions(int& cols, int& rows) const {
 void Islands::GenerateMinimumSpanningTree() {
 	bridges_.clear();
 	if (islands_.size() < 2) return;
+	const size_t count = islands_.size();
 
-	// Build distance matrix between all islands
-	vector<vector<float>> distanceMatrix(islands_.size(), vector<float>(islands_.size()));
-	for (size_t i = 0; i < islands_.size(); ++i) {
-		for (size_t j = i + 1; j < islands_.size(); ++j) {
-			const XMVECTOR diff = XMLoadFloat3(&islands_[j].position) - XMLoadFloat3(&islands_[i].position);
-			distanceMatrix[i][j] = distanceMatrix[j][i] = XMVectorGetX(XMVector3Length(diff));
-		}
-	}
-
-	// Prim's algorithm implementation
-	vector<bool> inMST(islands_.size(), false);
-	vector<size_t> parent(islands_.size(), 0);
-	vector<float> key(islands_.size(), FLT_MAX);
+	// Prim's algorithm, measuring each distance as it relaxes rather than keeping a matrix of every pair
+	ScratchScope scratch;
+	bool* inMST = scratch.allocate<bool>(count);
+	size_t* parent = scratch.allocate<size_t>(count);
+	float* key = scratch.allocate<float>(count);
+	fill(inMST, inMST + count, false);
+	fill(parent, parent + count, 0);
+	fill(key, key + count, FLT_MAX);
 
 	key[0] = 0;
 	parent[0] = -1;
 
-	for (size_t count = 0; count < islands_.size() - 1; ++count) {
-		const size_t u = min_element(key.begin(), key.end()) - key.begin();
+	for (size_t added = 0; added < count - 1; ++added) {
+		const size_t u = min_element(key, key + count) - key;
 		inMST[u] = true;
 		key[u] = FLT_MAX;
 
-		for (size_t v = 0; v < islands_.size(); ++v) {
-			if (!inMST[v] && distanceMatrix[u][v] < key[v]) {
+		const XMVECTOR from = XMLoadFloat3(&islands_[u].position);
+		for (size_t v = 0; v < count; ++v) {
+			if (inMST[v]) continue;
+			const float distance = XMVectorGetX(XMVector3Length(XMLoadFloat3(&islands_[v].position) - from));
+			if (distance < key[v]) {
 				parent[v] = u;
-				key[v] = distanceMatrix[u][v];
+				key[v] = distance;
 			}
 		}
 	}
 
 	// Store bridge connections
-	bridges_.reserve(islands_.size() - 1);
-	for (size_t i = 1; i < islands_.size(); ++i) {
+	bridges_.reserve(count - 1);
+	for (size_t i = 1; i < count; ++i) {
 		bridges_.emplace_back(Bridge{ parent[i], i });
 	}
 }
@@ -169,35 +170,65 @@ void Islands::GeneratePickups(Island& island) {
 	}
 }
 
-// Checks sphere-sphere collision between player and pickups - Eberly "Game Physics" 2nd Ed.
-bool Islands::CheckPickupCollision(const XMFLOAT3& playerPosition, float playerRadius, XMFLOAT3& outPickupPosition) {
-	const float PICKUP_COLLISION_RADIUS = 2.0f;
+// Erases the island's pickup at exactly this position; false if it has none there
+bool Islands::RemovePickup(size_t island, const XMFLOAT3& position) {
+	if (island >= islands_.size()) return false;
 
-	for (auto& island : islands_) {
-		for (auto it = island.pickupPositions.begin(); it != island.pickupPositions.end(); ) {
-			XMVECTOR playerVec = XMLoadFloat3(&playerPosition);
-			XMVECTOR pickupVec = XMLoadFloat3(&(*it));
+	PickupList& pickups = islands_[island].pickupPositions;
+	for (auto it = pickups.begin(); it != pickups.end(); ++it) {
+		if (it->x == position.x && it->y == position.y && it->z == position.z) {
+			pickups.erase(it);
+			return true;
+		}
+	}
+	return false;
+}
 
-			// Squared distance check for efficiency - Goldberg "What Every Computer Scientist Should Know About Floating-Point" ACM 1991
-			XMVECTOR difference = XMVectorSubtract(playerVec, pickupVec);
-			XMVECTOR lengthSq = XMVector3LengthSq(difference);
+// Adds every island with its remaining pickups, then the bridges between them
+void Islands::SaveSnapshot(WorldSnapshotWriter& writer) const {
+	size_t pickupCount = 0;
+	for (const Island& island : islands_) pickupCount += island.pickupPositions.size();
+	writer.reserve(islands_.size(), pickupCount, bridges_.size());
 
-			float distanceSq;
-			XMStoreFloat(&distanceSq, lengthSq);
+	for (const Island& island : islands_) {
+		const uint32_t flags = (island.initialized ? SnapshotIsland::INITIALIZED : 0) | (island.hasAmbience ? SnapshotIsland::HAS_AMBIENCE : 0);
+		writer.addIsland(island.position, island.rotationY, flags, island.pickupPositions.data(), static_cast<uint32_t>(island.pickupPositions.size()));
+	}
+	for (const Bridge& bridge : bridges_) writer.addBridge(static_cast<uint32_t>(bridge.islandA), static_cast<uint32_t>(bridge.islandB));
+}
 
-			float collisionDistanceSq = playerRadius * playerRadius + PICKUP_COLLISION_RADIUS * PICKUP_COLLISION_RADIUS;
+// Copies the mapped records in place of the generated ones; the regions follow the island count
+bool Islands::LoadSnapshot(const WorldSnapshotView& view) {
+	const size_t count = view.getIslandCount();
+	const SnapshotIsland* sourceIslands = view.getIslands();
+	const SnapshotBridge* sourceBridges = view.getBridges();
+
+	BridgeList bridges;
+	bridges.reserve(view.getBridgeCount());
+	for (size_t i = 0; i < view.getBridgeCount(); ++i) {
+		if (sourceBridges[i].islandA >= count || sourceBridges[i].islandB >= count) return false;
+		bridges.push_back(Bridge{ sourceBridges[i].islandA, sourceBridges[i].islandB });
+	}
 
-			if (distanceSq <= collisionDistanceSq) {
-				outPickupPosition = *it;
-				it = island.pickupPositions.erase(it);
-				return true;
-			}
-			else {
-				++it;
-			}
-		}
+	IslandList islands(count);
+	for (size_t i = 0; i < count; ++i) {
+		const SnapshotIsland& source = sourceIslands[i];
+		const SnapshotVector* pickups = view.getPickups(source);
+		if (!pickups) return false;
+
+		Island& island = islands[i];
+		island.position = source.position;
+		island.rotationY = source.rotationY;
+		island.initialized = (source.flags & SnapshotIsland::INITIALIZED) != 0;
+		island.hasAmbience = (source.flags & SnapshotIsland::HAS_AMBIENCE) != 0;
+		island.pickupPositions.assign(pickups, pickups + source.pickupCount);
 	}
-	return false;
+
+	islands_.swap(islands);
+	bridges_.swap(bridges);
+	islandRegions_.clear();
+	GenerateIslandBounds();
+	return true;
 }
 
 // Returns random island position for gameplay purposes
@@ -1,21 +1,29 @@
 #pragma once
-#include "DXF.h"
 #include <vector>
 #include <DirectXMath.h>
 #include <random>
 #include <memory>
 #include <algorithm>
+#include <cfloat>
+#include "MemoryTracker.h"
+#include "WorldSnapshot.h"
+
+using namespace std;
+using namespace DirectX;
 
 // Constants
 constexpr float REGION_SIZE = 150.f;
 constexpr float ISLAND_SIZE = 50.f;
 constexpr float PICKUP_OFFSET_RATIO = 0.8f;
+constexpr float PICKUP_COLLISION_RADIUS = 2.0f;
+
+typedef TrackedVector<XMFLOAT3, MemoryTag::Islands> PickupList;
 
 struct Island {
 	XMFLOAT3 position = { 0.f, 0.f, 0.f };
 	float rotationY = 0.f;
 	bool initialized = false;
-	vector<XMFLOAT3> pickupPositions;
+	PickupList pickupPositions;
 	bool hasAmbience = false;
 };
 
@@ -24,6 +32,9 @@ struct Bridge {
 	size_t islandB;
 };
 
+typedef TrackedVector<Island, MemoryTag::Islands> IslandList;
+typedef TrackedVector<Bridge, MemoryTag::Islands> BridgeList;
+
 class Islands {
 public:
 	Islands(int cellSize, int islandCount);
@@ -31,12 +42,16 @@ public:
 	// Generation
 	void GenerateIslands();
 
+	// Snapshots: the islands, their pickups and the bridges; the scene settings are the caller's
+	void SaveSnapshot(WorldSnapshotWriter& writer) const;
+	bool LoadSnapshot(const WorldSnapshotView& view);	// False, leaving the islands as they were, when a record points outside the file
+
 	// Getters
-	const vector<Island>& GetIslands() const { return islands_; }
-	vector<Island>& GetIslands() { return islands_; }
-	const vector<Bridge>& GetBridges() const { return bridges_; }
+	const IslandList& GetIslands() const { return islands_; }
+	IslandList& GetIslands() { return islands_; }
+	const BridgeList& GetBridges() const { return bridges_; }
 	XMFLOAT3 GetRandomIslandPosition() const;
-	bool CheckPickupCollision(const XMFLOAT3& playerPosition, float playerRadius, XMFLOAT3& outPickupPosition);
+	bool RemovePickup(size_t island, const XMFLOAT3& position);	// False when it was already collected
 	int GetClosestIslandIndex(const XMFLOAT3& position) const {
 		int closestIndex = -1;
 		float minDistance = FLT_MAX;
@@ -69,9 +84,9 @@ private:
 	void RotateIslandCorners(const Island& island, XMFLOAT3(&corners)[4]) const;
 
 	// Data
-	vector<Island> islands_;
-	vector<Bridge> bridges_;
-	vector<XMFLOAT3> islandRegions_;
+	IslandList islands_;
+	BridgeList bridges_;
+	TrackedVector<XMFLOAT3, MemoryTag::Islands> islandRegions_;
 	int gridSize_;
 	unique_ptr<mt19937> randomEngine_;
 };
@@ -0,0 +1,188 @@
+#include "JobSystem.h"
+#include <chrono>
+
+struct JobSystem::ThreadState {
+	WorkStealingQueue<Job> queue{ JOBS_PER_THREAD };
+	unique_ptr<Job[]> jobs{ new Job[JOBS_PER_THREAD] };
+	uint32_t nextJob = 0;
+	uint32_t random = 0;	// xorshift state for picking steal victims
+
+	atomic<uint64_t> executed{ 0 };
+	atomic<uint64_t> stolen{ 0 };
+	atomic<uint64_t> stealAttempts{ 0 };
+};
+
+namespace {
+
+	constexpr int SPINS_BEFORE_SLEEP = 64;
+	constexpr auto SLEEP_TIMEOUT = chrono::milliseconds(2);	// Upper bound on a missed wake-up
+
+	// The system and state of the current thread; null on threads that do not belong to a job system
+	thread_local JobSystem* currentSystem = nullptr;
+	thread_local void* currentState = nullptr;
+}
+
+int JobSystem::defaultWorkerCount() {
+	const unsigned cores = thread::hardware_concurrency();
+	return cores > 1 ? (int)cores - 1 : 0;
+}
+
+JobSystem::JobSystem(int workerCount) {
+	if (workerCount < 0) workerCount = defaultWorkerCount();
+	for (int i = 0; i <= workerCount; i++) {
+		threads.push_back(unique_ptr<ThreadState>(new ThreadState()));
+		threads.back()->random = 0x9E3779B9u * (uint32_t)(i + 1);
+	}
+
+	currentSystem = this;
+	currentState = threads[0].get();
+	for (int i = 1; i <= workerCount; i++) workers.emplace_back(&JobSystem::workerLoop, this, i);
+}
+
+JobSystem::~JobSystem() {
+	{
+		lock_guard<mutex> lock(sleepMutex);
+		stopping.store(true);
+	}
+	wake.notify_all();
+	for (thread& worker : workers) worker.join();
+
+	if (currentSystem == this) {
+		currentSystem = nullptr;
+		currentState = nullptr;
+	}
+}
+
+JobSystem::Job* JobSystem::allocate(Job* parent) {
+	ThreadState& self = *static_cast<ThreadState*>(currentState);
+	Job* job = &self.jobs[self.nextJob++ & (JOBS_PER_THREAD - 1)];
+	job->parent = parent;
+	job->unfinished.store(1, memory_order_relaxed);
+	job->blockers.store(1, memory_order_relaxed);
+	job->continuationCount.store(0, memory_order_relaxed);
+	if (parent) parent->unfinished.fetch_add(1, memory_order_relaxed);
+	return job;
+}
+
+void JobSystem::addContinuation(Job* before, Job* after) {
+	const int index = before->continuationCount.fetch_add(1, memory_order_relaxed);
+	before->continuations[index] = after;
+	after->blockers.fetch_add(1, memory_order_relaxed);
+}
+
+void JobSystem::run(Job* job) {
+	release(job);
+}
+
+void JobSystem::release(Job* job) {
+	if (job->blockers.fetch_sub(1, memory_order_acq_rel) == 1) push(job);
+}
+
+void JobSystem::push(Job* job) {
+	ThreadState& self = *static_cast<ThreadState*>(currentState);
+	if (!self.queue.push(job)) {
+		execute(job);	// Deque full; run it here rather than drop it
+		return;
+	}
+
+	// Pairs with the fence in workerLoop so either the sleeper sees this job or we see the sleeper
+	atomic_thread_fence(memory_order_seq_cst);
+	if (sleepers.load(memory_order_relaxed) > 0) {
+		lock_guard<mutex> lock(sleepMutex);
+		wake.notify_one();
+	}
+}
+
+void JobSystem::execute(Job* job) {
+	job->invoke(job);
+	job->destroy(job);
+	static_cast<ThreadState*>(currentState)->executed.fetch_add(1, memory_order_relaxed);
+	finish(job);
+}
+
+void JobSystem::finish(Job* job) {
+	if (job->unfinished.fetch_sub(1, memory_order_acq_rel) != 1) return;
+
+	// Read everything needed before anyone waiting on the job can see it finished and let its slot be reused
+	Job* parent = job->parent;
+	const int continuationCount = job->continuationCount.load(memory_order_relaxed);
+	for (int i = 0; i < continuationCount; i++) release(job->continuations[i]);
+	if (parent) finish(parent);
+}
+
+JobSystem::Job* JobSystem::findJob(ThreadState& self) {
+	if (Job* job = self.queue.pop()) return job;
+
+	const uint32_t count = (uint32_t)threads.size();
+	if (count < 2) return nullptr;
+
+	// Try every other thread once, starting from a random one
+	self.random ^= self.random << 13;
+	self.random ^= self.random >> 17;
+	self.random ^= self.random << 5;
+	const uint32_t start = self.random % count;
+	for (uint32_t i = 0; i < count; i++) {
+		ThreadState& victim = *threads[(start + i) % count];
+		if (&victim == &self) continue;
+		self.stealAttempts.fetch_add(1, memory_order_relaxed);
+		if (Job* job = victim.queue.steal()) {
+			self.stolen.fetch_add(1, memory_order_relaxed);
+			return job;
+		}
+	}
+	return nullptr;
+}
+
+void JobSystem::wait(const Job* job) {
+	ThreadState& self = *static_cast<ThreadState*>(currentState);
+	while (!isFinished(job)) {
+		if (Job* next = findJob(self)) execute(next);
+		else this_thread::yield();
+	}
+}
+
+void JobSystem::workerLoop(int index) {
+	ThreadState& self = *threads[index];
+	currentSystem = this;
+	currentState = &self;
+
+	int idle = 0;
+	while (!stopping.load(memory_order_relaxed)) {
+		if (Job* job = findJob(self)) {
+			execute(job);
+			idle = 0;
+			continue;
+		}
+		if (++idle < SPINS_BEFORE_SLEEP) {
+			this_thread::yield();
+			continue;
+		}
+
+		unique_lock<mutex> lock(sleepMutex);
+		sleepers.fetch_add(1, memory_order_relaxed);
+		atomic_thread_fence(memory_order_seq_cst);
+		bool anyQueued = false;
+		for (const unique_ptr<ThreadState>& thread : threads) anyQueued = anyQueued || !thread->queue.empty();
+		if (!anyQueued && !stopping.load(memory_order_relaxed)) wake.wait_for(lock, SLEEP_TIMEOUT);
+		sleepers.fetch_sub(1, memory_order_relaxed);
+		idle = 0;
+	}
+}
+
+JobSystem::Stats JobSystem::getStats() const {
+	Stats stats;
+	for (const unique_ptr<ThreadState>& thread : threads) {
+		stats.executed += thread->executed.load(memory_order_relaxed);
+		stats.stolen += thread->stolen.load(memory_order_relaxed);
+		stats.stealAttempts += thread->stealAttempts.load(memory_order_relaxed);
+	}
+	return stats;
+}
+
+void JobSystem::resetStats() {
+	for (const unique_ptr<ThreadState>& thread : threads) {
+		thread->executed.store(0, memory_order_relaxed);
+		thread->stolen.store(0, memory_order_relaxed);
+		thread->stealAttempts.store(0, memory_order_relaxed);
+	}
+}
@@ -0,0 +1,136 @@
+#pragma once
+// Work-stealing job system. One worker per core beside the thread that creates it; every thread keeps its own
+// Chase-Lev deque, works through its own jobs newest first and steals the oldest from a random other thread when
+// it runs dry. Jobs form graphs two ways: a child keeps its parent unfinished until it is done, and a continuation
+// only starts once everything it was added to has finished. Waiting never blocks; the waiting thread runs jobs
+// until the one it waits on is done, so waits can nest inside jobs.
+//
+// Only the creating thread and the workers may create, run or wait on jobs. Each thread allocates jobs from its own
+// ring of JOBS_PER_THREAD, so no more than that many jobs created by one thread may be in flight at once.
+
+#include "WorkStealingQueue.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+class JobSystem {
+public:
+	static constexpr int JOBS_PER_THREAD = 4096;
+	static constexpr int MAX_CONTINUATIONS = 8;
+	static constexpr size_t JOB_STORAGE = 64;	// Bytes of captures a job holds; capture pointers to anything bigger
+
+	struct Job {
+		void (*invoke)(Job*) = nullptr;
+		void (*destroy)(Job*) = nullptr;
+		Job* parent = nullptr;
+		atomic<int> unfinished{ 0 };	// The job itself plus children not done yet
+		atomic<int> blockers{ 0 };	// 1 until run() plus one per predecessor still going
+		atomic<int> continuationCount{ 0 };
+		Job* continuations[MAX_CONTINUATIONS];
+		alignas(16) unsigned char storage[JOB_STORAGE];
+	};
+
+	struct Stats {
+		uint64_t executed = 0;
+		uint64_t stolen = 0;	// Executed jobs taken from another thread's deque
+		uint64_t stealAttempts = 0;
+	};
+
+	// workerCount < 0 starts one worker per core beside the calling thread
+	explicit JobSystem(int workerCount = -1);
+	~JobSystem();
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	// The job calls function() once. With a parent, the parent is unfinished until this job is.
+	template<typename F>
+	Job* create(F&& function, Job* parent = nullptr) {
+		typedef typename decay<F>::type Callable;
+		static_assert(sizeof(Callable) <= JOB_STORAGE, "Job captures too large; capture a pointer instead");
+		static_assert(alignof(Callable) <= 16, "Job captures over-aligned");
+
+		Job* job = allocate(parent);
+		new (job->storage) Callable(forward<F>(function));
+		job->invoke = [](Job* self) { (*reinterpret_cast<Callable*>(self->storage))(); };
+		job->destroy = [](Job* self) { reinterpret_cast<Callable*>(self->storage)->~Callable(); };
+		return job;
+	}
+
+	// `after` starts once `before` and its children have finished. Both must be created and not yet run.
+	void addContinuation(Job* before, Job* after);
+
+	void run(Job* job);
+	void wait(const Job* job);	// Runs other jobs here until job and its children have finished
+	bool isFinished(const Job* job) const { return job->unfinished.load(memory_order_acquire) == 0; }
+
+	// function(begin, end) over [0, count) in ranges of at most grain items. Ranges are split in halves as they are
+	// taken, so a thief always steals the largest piece left.
+	template<typename F>
+	void parallelFor(int count, int grain, F&& function) {
+		if (count <= 0) return;
+		grain = max(grain, 1);
+		if (count <= grain || threads.size() == 1) {
+			function(0, count);
+			return;
+		}
+
+		// Leaves stay well inside any one thread's job ring
+		grain = max(grain, count / (JOBS_PER_THREAD / 4) + 1);
+
+		Job* root = create([] {});
+		spawnRange(root, 0, count, grain, &function);
+		run(root);
+		wait(root);
+	}
+
+	int getThreadCount() const { return (int)threads.size(); }	// Workers plus the creating thread
+	Stats getStats() const;
+	void resetStats();
+
+	static int defaultWorkerCount();
+
+private:
+	struct ThreadState;
+
+	template<typename F>
+	void spawnRange(Job* parent, int begin, int end, int grain, F* function) {
+		run(create([this, parent, begin, end, grain, function] {
+			// Hand the upper half to a new job and carry on with the lower until a leaf is left
+			int last = end;
+			while (last - begin > grain) {
+				const int middle = begin + (last - begin) / 2;
+				spawnRange(parent, middle, last, grain, function);
+				last = middle;
+			}
+			(*function)(begin, last);
+		}, parent));
+	}
+
+	Job* allocate(Job* parent);
+	void push(Job* job);
+	void release(Job* job);	// Drops one blocker, queueing the job when none are left
+	void execute(Job* job);
+	void finish(Job* job);
+	Job* findJob(ThreadState& self);
+	void workerLoop(int index);
+
+	vector<unique_ptr<ThreadState>> threads;	// [0] is the creating thread
+	vector<thread> workers;
+
+	mutex sleepMutex;
+	condition_variable wake;
+	atomic<int> sleepers{ 0 };
+	atomic<bool> stopping{ false };
+};
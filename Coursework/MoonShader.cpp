@@ -1,6 +1,6 @@
 #include "MoonShader.h"
 
-MoonShader::MoonShader(ID3D11Device* device, HWND hwnd) : BaseShader(device, hwnd)
+MoonShader::MoonShader(ID3D11Device* device, HWND hwnd, SceneConstants* sceneConstants) : BaseShader(device, hwnd), sceneConstants(sceneConstants)
 {
 	initShader(L"moon_vs.cso", L"moon_ps.cso");
 }
@@ -28,13 +28,6 @@ MoonShader::~MoonShader()
 		layout = 0;
 	}
 
-	// Release the light constant buffer.
-	if (lightBuffer)
-	{
-		lightBuffer->Release();
-		lightBuffer = 0;
-	}
-
 	//Release base shader components
 	BaseShader::~BaseShader();
 }
@@ -57,17 +50,6 @@ void MoonShader::initShader(const wchar_t* vsFilename, const wchar_t* psFilename
 	bufferDesc.StructureByteStride = 0;
 	renderer->CreateBuffer(&bufferDesc, NULL, &matrixBuffer);
 
-	// Setup light buffer
-	// Setup the description of the light dynamic constant buffer that is in the pixel shader.
-	// Note that ByteWidth always needs to be a multiple of 16 if using D3D11_BIND_CONSTANT_BUFFER or CreateBuffer will fail.
-	bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-	bufferDesc.ByteWidth = sizeof(LightBufferType);
-	bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-	bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-	bufferDesc.MiscFlags = 0;
-	bufferDesc.StructureByteStride = 0;
-	renderer->CreateBuffer(&bufferDesc, NULL, &lightBuffer);
-
 	// Create a texture sampler state description for the moon.
 	samplerDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
 	samplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_WRAP;
@@ -85,7 +67,7 @@ void MoonShader::initShader(const wchar_t* vsFilename, const wchar_t* psFilename
 	renderer->CreateSamplerState(&samplerDesc, &sampleState);
 }
 
-void MoonShader::setShaderParameters(ID3D11DeviceContext* deviceContext, const XMMATRIX& worldMatrix, const XMMATRIX& viewMatrix, const XMMATRIX& projectionMatrix, ID3D11ShaderResourceView* texture, Light* light, SceneData* sceneData)
+void MoonShader::setShaderParameters(ID3D11DeviceContext* deviceContext, const XMMATRIX& worldMatrix, const XMMATRIX& viewMatrix, const XMMATRIX& projectionMatrix, ID3D11ShaderResourceView* texture)
 {
 	HRESULT result;
 	D3D11_MAPPED_SUBRESOURCE mappedResource;
@@ -105,17 +87,8 @@ void MoonShader::setShaderParameters(ID3D11DeviceContext* deviceContext, const X
 	deviceContext->Unmap(matrixBuffer, 0);
 	deviceContext->VSSetConstantBuffers(0, 1, &matrixBuffer);
 
-	// Moon directional light
-	LightBufferType* lightPtr;
-	deviceContext->Map(lightBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
-	lightPtr = (LightBufferType*)mappedResource.pData;
-	lightPtr->ambientColour = light->getAmbientColour();
-	lightPtr->diffuseColour = light->getDiffuseColour();
-	lightPtr->moonPos = XMFLOAT3(sceneData->moonData.moon_pos);
-	lightPtr->padding = 0.f;
-	lightPtr->spotlightColour = XMFLOAT4(sceneData->shadowLightsData.spotColour);
-	deviceContext->Unmap(lightBuffer, 0);
-	deviceContext->PSSetConstantBuffers(0, 1, &lightBuffer);
+	// Moon light: the scene's diffuse colour and the moonlight, packed once a frame by SceneConstants
+	sceneConstants->bindLights(deviceContext);
 
 	// Pixle Shader
 	deviceContext->PSSetShaderResources(0, 1, &texture);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "DXF.h"
+#include "SceneConstants.h"
 
 using namespace std;
 using namespace DirectX;
@@ -15,20 +16,11 @@ private:
 		XMMATRIX projection;
 	};
 
-	struct LightBufferType
-	{
-		XMFLOAT4 ambientColour;
-		XMFLOAT4 diffuseColour;
-		XMFLOAT3 moonPos;
-		float padding;
-		XMFLOAT4 spotlightColour;
-	};
-
 public:
-	MoonShader(ID3D11Device* device, HWND hwnd);
+	MoonShader(ID3D11Device* device, HWND hwnd, SceneConstants* sceneConstants);
 	~MoonShader();
 
-	void setShaderParameters(ID3D11DeviceContext* deviceContext, const XMMATRIX& world, const XMMATRIX& view, const XMMATRIX& projection, ID3D11ShaderResourceView* texture, Light* light, SceneData* sceneData);
+	void setShaderParameters(ID3D11DeviceContext* deviceContext, const XMMATRIX& world, const XMMATRIX& view, const XMMATRIX& projection, ID3D11ShaderResourceView* texture);
 
 private:
 	void initShader(const wchar_t* vs, const wchar_t* ps);
@@ -36,6 +28,6 @@ private:
 private:
 	ID3D11Buffer* matrixBuffer;
 	ID3D11SamplerState* sampleState;
-	ID3D11Buffer* lightBuffer;
+	SceneConstants* sceneConstants;	// The lights, shared with the other lit shaders
 };
 
@@ -0,0 +1,189 @@
+#include "NullAudioBackend.h"
+
+NullAudioBackend::NullAudioBackend() : startTime(chrono::steady_clock::now()) {}
+
+double NullAudioBackend::getTime() const {
+	if (useManualTime) return manualTime;
+	return chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+}
+
+void NullAudioBackend::record(Call call, AudioVoice voice, float a, float b, float c, const string& text) {
+	callCounts[(int)call]++;
+
+	if (callCost > 0.0) {
+		const auto until = chrono::steady_clock::now() + chrono::duration<double>(callCost);
+		while (chrono::steady_clock::now() < until) {}
+	}
+	if (!recording) return;
+
+	Record entry;
+	entry.time = getTime();
+	entry.call = call;
+	entry.voice = voice;
+	entry.values[0] = a;
+	entry.values[1] = b;
+	entry.values[2] = c;
+	entry.text = text;
+	log.push_back(entry);
+}
+
+NullAudioBackend::Voice* NullAudioBackend::getVoice(AudioVoice voice) {
+	if (voice == 0 || voice > voices.size() || !voices[voice - 1].alive) return nullptr;
+	return &voices[voice - 1];
+}
+
+bool NullAudioBackend::init() {
+	record(Call::Init, 0);
+	return true;
+}
+
+void NullAudioBackend::release() {
+	record(Call::Release, 0);
+	voices.clear();
+	freeVoices.clear();
+	activeVoices = 0;
+}
+
+void NullAudioBackend::update() {
+	record(Call::Update, 0);
+}
+
+AudioVoice NullAudioBackend::createVoice(const string& eventPath) {
+	AudioVoice handle;
+	if (!freeVoices.empty()) {
+		handle = freeVoices.back();
+		freeVoices.pop_back();
+	}
+	else {
+		voices.emplace_back();
+		handle = (AudioVoice)voices.size();
+	}
+
+	Voice& voice = voices[handle - 1];
+	voice = Voice();
+	voice.eventPath = eventPath;
+	voice.alive = true;
+	activeVoices++;
+
+	record(Call::CreateVoice, handle, 0.0f, 0.0f, 0.0f, eventPath);
+	return handle;
+}
+
+void NullAudioBackend::startVoice(AudioVoice voice) {
+	record(Call::StartVoice, voice);
+	if (Voice* v = getVoice(voice)) v->playing = true;
+}
+
+void NullAudioBackend::stopVoice(AudioVoice voice, bool allowFadeOut) {
+	record(Call::StopVoice, voice, allowFadeOut ? 1.0f : 0.0f);
+	if (Voice* v = getVoice(voice)) v->playing = false;
+}
+
+void NullAudioBackend::releaseVoice(AudioVoice voice) {
+	record(Call::ReleaseVoice, voice);
+	Voice* v = getVoice(voice);
+	if (!v) return;
+
+	v->alive = false;
+	v->playing = false;
+	freeVoices.push_back(voice);
+	activeVoices--;
+}
+
+void NullAudioBackend::playOneShot(const char* eventPath) {
+	record(Call::PlayOneShot, 0, 0.0f, 0.0f, 0.0f, eventPath);
+}
+
+void NullAudioBackend::setVolume(AudioVoice voice, float volume) {
+	record(Call::SetVolume, voice, volume);
+	if (Voice* v = getVoice(voice)) v->volume = volume;
+}
+
+void NullAudioBackend::setPitch(AudioVoice voice, float pitch) {
+	record(Call::SetPitch, voice, pitch);
+	if (Voice* v = getVoice(voice)) v->pitch = pitch;
+}
+
+void NullAudioBackend::set3DAttributes(AudioVoice voice, const AudioAttributes3D& attributes) {
+	record(Call::Set3DAttributes, voice, attributes.position.x, attributes.position.y, attributes.position.z);
+	if (Voice* v = getVoice(voice)) v->attributes = attributes;
+}
+
+void NullAudioBackend::setCone(AudioVoice voice, const AudioVector&, float insideAngle, float outsideAngle, float outsideVolume) {
+	record(Call::SetCone, voice, insideAngle, outsideAngle, outsideVolume);
+}
+
+void NullAudioBackend::setDopplerLevel(AudioVoice voice, float level) {
+	record(Call::SetDopplerLevel, voice, level);
+}
+
+void NullAudioBackend::setSpread(AudioVoice voice, float degrees) {
+	record(Call::SetSpread, voice, degrees);
+}
+
+void NullAudioBackend::setDuckingFilter(AudioVoice voice, bool enabled) {
+	record(Call::SetDuckingFilter, voice, enabled ? 1.0f : 0.0f);
+	if (Voice* v = getVoice(voice)) v->ducked = enabled;
+}
+
+void NullAudioBackend::addTransient(AudioVoice voice, float gain) {
+	record(Call::AddTransient, voice, gain);
+}
+
+void NullAudioBackend::setLowpass(AudioVoice voice, float cutoffHz) {
+	record(Call::SetLowpass, voice, cutoffHz);
+}
+
+void NullAudioBackend::setListener(const AudioAttributes3D& attributes) {
+	record(Call::SetListener, 0, attributes.position.x, attributes.position.y, attributes.position.z);
+}
+
+void NullAudioBackend::clearLog() {
+	log.clear();
+	for (size_t& count : callCounts) count = 0;
+}
+
+size_t NullAudioBackend::getTotalCalls() const {
+	size_t total = 0;
+	for (size_t count : callCounts) total += count;
+	return total;
+}
+
+vector<NullAudioBackend::VolumePoint> NullAudioBackend::getVolumeCurve(AudioVoice voice) const {
+	vector<VolumePoint> curve;
+	for (const Record& entry : log) {
+		if (entry.call == Call::SetVolume && entry.voice == voice) curve.push_back({ entry.time, entry.values[0] });
+	}
+	return curve;
+}
+
+const string& NullAudioBackend::getEventPath(AudioVoice voice) const {
+	static const string none;
+	if (voice == 0 || voice > voices.size()) return none;
+	return voices[voice - 1].eventPath;
+}
+
+bool NullAudioBackend::isPlaying(AudioVoice voice) const {
+	return voice != 0 && voice <= voices.size() && voices[voice - 1].alive && voices[voice - 1].playing;
+}
+
+void NullAudioBackend::writeLog(FILE* file) const {
+	fprintf(file, "time,call,voice,a,b,c,text\n");
+	for (const Record& entry : log) {
+		fprintf(file, "%.6f,%s,%u,%g,%g,%g,%s\n", entry.time, getCallName(entry.call), entry.voice,
+			entry.values[0], entry.values[1], entry.values[2], entry.text.c_str());
+	}
+}
+
+const char* NullAudioBackend::getCallName(Call call) {
+	static const char* names[] = {
+		"Init", "Release", "Update",
+		"CreateVoice", "StartVoice", "StopVoice", "ReleaseVoice", "PlayOneShot",
+		"SetVolume", "SetPitch", "Set3DAttributes",
+		"SetCone", "SetDopplerLevel", "SetSpread",
+		"SetDuckingFilter", "AddTransient", "SetLowpass",
+		"SetListener"
+	};
+	static_assert(sizeof(names) / sizeof(names[0]) == (size_t)Call::Count, "Call name table out of date");
+	return names[(int)call];
+}
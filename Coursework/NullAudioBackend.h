@@ -0,0 +1,109 @@
+#pragma once
+#include "AudioBackend.h"
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+// Plays nothing. Keeps the state each voice would have and logs every call with a timestamp, so the
+// per-frame cost, call counts and volume curves of AudioSystem can be measured without a sound card.
+class NullAudioBackend : public AudioBackend {
+public:
+	enum class Call {
+		Init, Release, Update,
+		CreateVoice, StartVoice, StopVoice, ReleaseVoice, PlayOneShot,
+		SetVolume, SetPitch, Set3DAttributes,
+		SetCone, SetDopplerLevel, SetSpread,
+		SetDuckingFilter, AddTransient, SetLowpass,
+		SetListener,
+		Count
+	};
+
+	struct Record {
+		double time;	// Seconds, see setTime
+		Call call;
+		AudioVoice voice;
+		float values[3];	// Call specific, e.g. volume or position
+		string text;	// Event path for CreateVoice/PlayOneShot
+	};
+
+	struct VolumePoint {
+		double time;
+		float volume;
+	};
+
+	NullAudioBackend();
+
+	bool init() override;
+	void release() override;
+	void update() override;
+
+	AudioVoice createVoice(const string& eventPath) override;
+	void startVoice(AudioVoice voice) override;
+	void stopVoice(AudioVoice voice, bool allowFadeOut) override;
+	void releaseVoice(AudioVoice voice) override;
+	void playOneShot(const char* eventPath) override;
+
+	void setVolume(AudioVoice voice, float volume) override;
+	void setPitch(AudioVoice voice, float pitch) override;
+	void set3DAttributes(AudioVoice voice, const AudioAttributes3D& attributes) override;
+
+	void setCone(AudioVoice voice, const AudioVector& direction, float insideAngle, float outsideAngle, float outsideVolume) override;
+	void setDopplerLevel(AudioVoice voice, float level) override;
+	void setSpread(AudioVoice voice, float degrees) override;
+
+	void setDuckingFilter(AudioVoice voice, bool enabled) override;
+	void addTransient(AudioVoice voice, float gain) override;
+	void setLowpass(AudioVoice voice, float cutoffHz) override;
+
+	void setListener(const AudioAttributes3D& attributes) override;
+
+	// Timestamps come from a steady clock unless a time has been set, after which the caller drives the clock
+	// (simulated time makes offline runs reproducible).
+	void setTime(double seconds) { manualTime = seconds; useManualTime = true; }
+	double getTime() const;
+
+	// Busy-waits this long in every call, standing in for a real engine's per-call cost
+	void setSimulatedCallCost(double seconds) { callCost = seconds; }
+
+	// With recording off only the counters are kept, which keeps long benchmark runs flat in memory
+	void setRecording(bool enabled) { recording = enabled; }
+	void clearLog();
+
+	const vector<Record>& getLog() const { return log; }
+	size_t getCallCount(Call call) const { return callCounts[(int)call]; }
+	size_t getTotalCalls() const;
+	size_t getActiveVoices() const { return activeVoices; }
+	vector<VolumePoint> getVolumeCurve(AudioVoice voice) const;	// Every SetVolume on the voice, in order
+	const string& getEventPath(AudioVoice voice) const;
+	bool isPlaying(AudioVoice voice) const;
+
+	void writeLog(FILE* file) const;	// CSV: time,call,voice,a,b,c,text
+	static const char* getCallName(Call call);
+
+private:
+	struct Voice {
+		string eventPath;
+		AudioAttributes3D attributes;
+		float volume = 1.0f;
+		float pitch = 1.0f;
+		bool alive = false;
+		bool playing = false;
+		bool ducked = false;
+	};
+
+	Voice* getVoice(AudioVoice voice);
+	void record(Call call, AudioVoice voice, float a = 0.0f, float b = 0.0f, float c = 0.0f, const string& text = string());
+
+	vector<Voice> voices;	// Indexed by handle - 1
+	vector<AudioVoice> freeVoices;
+	size_t activeVoices = 0;
+
+	vector<Record> log;
+	size_t callCounts[(int)Call::Count] = {};
+	bool recording = true;
+	double callCost = 0.0;
+
+	chrono::steady_clock::time_point startTime;
+	double manualTime = 0.0;
+	bool useManualTime = false;
+};
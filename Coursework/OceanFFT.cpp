@@ -0,0 +1,338 @@
+#include "OceanFFT.h"
+#include "JobSystem.h"
+#include "SimdMath.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace {
+
+	constexpr double TWO_PI = 6.283185307179586;
+	constexpr int BATCH = 4;
+	constexpr int ROW_PADDING = 16;	// A cache line of floats
+	constexpr int COLUMN_BLOCK = 32;	// Columns carried through every stage together, so they stay in cache
+	constexpr int COLUMNS_PER_JOB = 32;
+	constexpr int ROWS_PER_JOB = 16;
+
+	// Box-Muller on mt19937's own output, so a seed draws the same ocean with every standard library
+	void gaussianPair(mt19937& rng, float& first, float& second) {
+		const double u1 = (rng() + 1.0) / 4294967297.0, u2 = rng() / 4294967296.0;
+		const double radius = sqrt(-2.0 * log(u1));
+		first = (float)(radius * cos(TWO_PI * u2));
+		second = (float)(radius * sin(TWO_PI * u2));
+	}
+}
+
+bool OceanFFT::hasSimd() {
+#ifdef SIMD_MATH_SSE
+	return true;
+#else
+	return false;
+#endif
+}
+
+void OceanFFT::setup(const OceanSettings& source) {
+	settings = source;
+	logSize = 2;
+	while ((1 << logSize) < settings.size) logSize++;
+	size = 1 << logSize;
+	stride = size + ROW_PADDING;
+	settings.size = size;
+	const size_t count = (size_t)size * size;
+
+	for (vector<float>* column : { &h0Re, &h0Im, &h0MinusRe, &h0MinusIm, &omega, &kX, &kZ, &kUnitX, &kUnitZ }) column->assign(count, 0.0f);
+	for (int f = 0; f < 3; f++) {
+		fieldRe[f].assign((size_t)size * stride, 0.0f);
+		fieldIm[f].assign((size_t)size * stride, 0.0f);
+	}
+	displacement.assign(count * 4, 0.0f);
+	normals.assign(count * 4, 0.0f);
+
+	// Phillips spectrum, with waves shorter than SMALL_WAVE_FRACTION of the largest damped away
+	const float windLength = sqrtf(settings.windDirectionX * settings.windDirectionX + settings.windDirectionZ * settings.windDirectionZ);
+	const float windX = windLength > 0.0f ? settings.windDirectionX / windLength : 1.0f;
+	const float windZ = windLength > 0.0f ? settings.windDirectionZ / windLength : 0.0f;
+	const double largest = (double)settings.windSpeed * settings.windSpeed / GRAVITY;
+	const double smallest = largest * SMALL_WAVE_FRACTION;
+	const double baseFrequency = TWO_PI / settings.period;
+	mt19937 rng(settings.seed);
+	for (int row = 0; row < size; row++) {
+		// FFT order: the upper half of the indices are the negative wave numbers
+		const int n = row < size / 2 ? row : row - size;
+		for (int column = 0; column < size; column++) {
+			const int m = column < size / 2 ? column : column - size;
+			const size_t i = (size_t)row * size + column;
+			const double kx = TWO_PI * m / settings.patchLength, kz = TWO_PI * n / settings.patchLength;
+			const double k2 = kx * kx + kz * kz, k = sqrt(k2);
+			kX[i] = (float)kx;
+			kZ[i] = (float)kz;
+			float xi1, xi2;
+			gaussianPair(rng, xi1, xi2);
+			// No mean height, and nothing on the Nyquist row or column, whose partner wave is itself
+			if (k == 0.0 || row == size / 2 || column == size / 2) continue;
+			kUnitX[i] = (float)(kx / k);
+			kUnitZ[i] = (float)(kz / k);
+			// Rounded down to a whole number of cycles per period, so the motion loops
+			omega[i] = (float)(floor(sqrt(GRAVITY * k) / baseFrequency) * baseFrequency);
+
+			const double alignment = (kx * windX + kz * windZ) / k;
+			double phillips = settings.amplitude * exp(-1.0 / (k2 * largest * largest)) / (k2 * k2) * alignment * alignment;
+			phillips *= exp(-k2 * smallest * smallest);
+			if (alignment < 0.0) phillips *= SUPPRESS_AGAINST_WIND;
+			const float scale = (float)sqrt(phillips * 0.5);
+			h0Re[i] = xi1 * scale;
+			h0Im[i] = xi2 * scale;
+		}
+	}
+	for (int row = 0; row < size; row++) {
+		for (int column = 0; column < size; column++) {
+			const size_t i = (size_t)row * size + column;
+			const size_t mirror = (size_t)((size - row) & (size - 1)) * size + ((size - column) & (size - 1));
+			h0MinusRe[i] = h0Re[mirror];
+			h0MinusIm[i] = -h0Im[mirror];
+		}
+	}
+
+	twiddleRe.assign(size, 0.0f);
+	twiddleIm.assign(size, 0.0f);
+	for (int span = 2; span <= size; span *= 2) {
+		for (int j = 0; j < span / 2; j++) {
+			twiddleRe[span / 2 - 1 + j] = (float)cos(TWO_PI * j / span);
+			twiddleIm[span / 2 - 1 + j] = (float)sin(TWO_PI * j / span);
+		}
+	}
+	bitReverse.assign(size, 0);
+	for (int i = 0; i < size; i++) {
+		int reversed = 0;
+		for (int bit = 0; bit < logSize; bit++) reversed |= ((i >> bit) & 1) << (logSize - 1 - bit);
+		bitReverse[i] = reversed;
+	}
+}
+
+template<typename F>
+void OceanFFT::forRows(JobSystem* jobs, int grain, F&& function) {
+	if (jobs) jobs->parallelFor(size, grain, function);
+	else function(0, size);
+}
+
+void OceanFFT::update(float time, JobSystem* jobs) {
+	if (size == 0) return;
+	const float phaseTime = fmodf(time, settings.period);
+
+	forRows(jobs, ROWS_PER_JOB, [&](int begin, int end) { evolve(begin, end, phaseTime); });
+	forRows(jobs, COLUMNS_PER_JOB, [&](int begin, int end) {
+		for (int f = 0; f < 3; f++) transformColumns(fieldRe[f].data(), fieldIm[f].data(), begin, end);
+	});
+	// Each row's transform, then its texels, while the row is still in cache
+	forRows(jobs, ROWS_PER_JOB, [&](int begin, int end) {
+		for (int f = 0; f < 3; f++) transformRows(fieldRe[f].data(), fieldIm[f].data(), begin, end);
+		pack(begin, end);
+	});
+}
+
+// h(k, t) = h0(k) e^(i w t) + conj(h0(-k)) e^(-i w t), and from it the spectra of the choppy offsets -i k/|k| h, the
+// slopes i k h and the divergence |k| h, paired up so each pair comes back as the real and imaginary parts of one
+// transform
+void OceanFFT::evolve(int beginRow, int endRow, float time) {
+	for (int row = beginRow; row < endRow; row++) {
+		const size_t first = (size_t)row * size, end = first + size;
+		float* re0 = &fieldRe[0][(size_t)row * stride] - first, * im0 = &fieldIm[0][(size_t)row * stride] - first;
+		float* re1 = &fieldRe[1][(size_t)row * stride] - first, * im1 = &fieldIm[1][(size_t)row * stride] - first;
+		float* re2 = &fieldRe[2][(size_t)row * stride] - first, * im2 = &fieldIm[2][(size_t)row * stride] - first;
+		size_t i = first;
+#ifdef SIMD_MATH_SSE
+		if (simd) {
+			const __m128 t = _mm_set1_ps(time), one = _mm_set1_ps(1.0f), zero = _mm_setzero_ps();
+			for (; i + BATCH <= end; i += BATCH) {
+				__m128 sine, cosine;
+				sinCos(_mm_mul_ps(_mm_loadu_ps(&omega[i]), t), sine, cosine);
+				const __m128 re = _mm_loadu_ps(&h0Re[i]), im = _mm_loadu_ps(&h0Im[i]);
+				const __m128 minusRe = _mm_loadu_ps(&h0MinusRe[i]), minusIm = _mm_loadu_ps(&h0MinusIm[i]);
+				const __m128 hRe = _mm_add_ps(_mm_mul_ps(_mm_add_ps(re, minusRe), cosine), _mm_mul_ps(_mm_sub_ps(minusIm, im), sine));
+				const __m128 hIm = _mm_add_ps(_mm_mul_ps(_mm_add_ps(im, minusIm), cosine), _mm_mul_ps(_mm_sub_ps(re, minusRe), sine));
+
+				const __m128 kx = _mm_loadu_ps(&kX[i]), kz = _mm_loadu_ps(&kZ[i]);
+				const __m128 ux = _mm_loadu_ps(&kUnitX[i]), uz = _mm_loadu_ps(&kUnitZ[i]);
+				const __m128 k = _mm_add_ps(_mm_mul_ps(kx, ux), _mm_mul_ps(kz, uz));
+				const __m128 alongX = _mm_add_ps(one, ux), alongZ = _mm_add_ps(kz, k);
+				_mm_storeu_ps(re0 + i, _mm_mul_ps(alongX, hRe));
+				_mm_storeu_ps(im0 + i, _mm_mul_ps(alongX, hIm));
+				_mm_storeu_ps(re1 + i, _mm_sub_ps(_mm_mul_ps(uz, hIm), _mm_mul_ps(kx, hRe)));
+				_mm_storeu_ps(im1 + i, _mm_sub_ps(zero, _mm_add_ps(_mm_mul_ps(uz, hRe), _mm_mul_ps(kx, hIm))));
+				_mm_storeu_ps(re2 + i, _mm_sub_ps(zero, _mm_mul_ps(alongZ, hIm)));
+				_mm_storeu_ps(im2 + i, _mm_mul_ps(alongZ, hRe));
+			}
+		}
+#endif
+		for (; i < end; i++) {
+			const float phase = omega[i] * time, cosine = cosf(phase), sine = sinf(phase);
+			const float hRe = (h0Re[i] + h0MinusRe[i]) * cosine + (h0MinusIm[i] - h0Im[i]) * sine;
+			const float hIm = (h0Im[i] + h0MinusIm[i]) * cosine + (h0Re[i] - h0MinusRe[i]) * sine;
+			const float k = kX[i] * kUnitX[i] + kZ[i] * kUnitZ[i];
+			// h + i(-i ux h) = (1 + ux) h
+			re0[i] = (1.0f + kUnitX[i]) * hRe;
+			im0[i] = (1.0f + kUnitX[i]) * hIm;
+			// -i uz h + i(i kx h)
+			re1[i] = kUnitZ[i] * hIm - kX[i] * hRe;
+			im1[i] = -(kUnitZ[i] * hRe + kX[i] * hIm);
+			// i kz h + i(|k| h)
+			re2[i] = -(kZ[i] + k) * hIm;
+			im2[i] = (kZ[i] + k) * hRe;
+		}
+	}
+}
+
+// Unnormalised inverse radix-2 transforms down columns [beginColumn, endColumn), COLUMN_BLOCK of them at a time: rows
+// are swapped into bit-reversed order, then each butterfly combines two whole rows, so the lanes run along the columns
+void OceanFFT::transformColumns(float* re, float* im, int beginColumn, int endColumn) const {
+	for (int blockBegin = beginColumn; blockBegin < endColumn; blockBegin += COLUMN_BLOCK) {
+		const int blockEnd = min(blockBegin + COLUMN_BLOCK, endColumn);
+		for (int row = 0; row < size; row++) {
+			const int other = bitReverse[row];
+			if (other <= row) continue;
+			float* aRe = re + (size_t)row * stride, * aIm = im + (size_t)row * stride;
+			float* bRe = re + (size_t)other * stride, * bIm = im + (size_t)other * stride;
+			for (int c = blockBegin; c < blockEnd; c++) {
+				swap(aRe[c], bRe[c]);
+				swap(aIm[c], bIm[c]);
+			}
+		}
+
+		for (int half = 1; half < size; half *= 2) {
+			for (int start = 0; start < size; start += half * 2) {
+				for (int j = 0; j < half; j++) {
+					const float wRe = twiddleRe[half - 1 + j], wIm = twiddleIm[half - 1 + j];
+					float* aRe = re + (size_t)(start + j) * stride, * aIm = im + (size_t)(start + j) * stride;
+					float* bRe = aRe + (size_t)half * stride, * bIm = aIm + (size_t)half * stride;
+					int c = blockBegin;
+#ifdef SIMD_MATH_SSE
+					if (simd) {
+						const __m128 twRe = _mm_set1_ps(wRe), twIm = _mm_set1_ps(wIm);
+						for (; c + BATCH <= blockEnd; c += BATCH) {
+							const __m128 xRe = _mm_loadu_ps(bRe + c), xIm = _mm_loadu_ps(bIm + c);
+							const __m128 tRe = _mm_sub_ps(_mm_mul_ps(twRe, xRe), _mm_mul_ps(twIm, xIm));
+							const __m128 tIm = _mm_add_ps(_mm_mul_ps(twRe, xIm), _mm_mul_ps(twIm, xRe));
+							const __m128 yRe = _mm_loadu_ps(aRe + c), yIm = _mm_loadu_ps(aIm + c);
+							_mm_storeu_ps(bRe + c, _mm_sub_ps(yRe, tRe));
+							_mm_storeu_ps(bIm + c, _mm_sub_ps(yIm, tIm));
+							_mm_storeu_ps(aRe + c, _mm_add_ps(yRe, tRe));
+							_mm_storeu_ps(aIm + c, _mm_add_ps(yIm, tIm));
+						}
+					}
+#endif
+					for (; c < blockEnd; c++) {
+						const float tRe = wRe * bRe[c] - wIm * bIm[c];
+						const float tIm = wRe * bIm[c] + wIm * bRe[c];
+						bRe[c] = aRe[c] - tRe;
+						bIm[c] = aIm[c] - tIm;
+						aRe[c] += tRe;
+						aIm[c] += tIm;
+					}
+				}
+			}
+		}
+	}
+}
+
+// The same transforms along rows [beginRow, endRow). Within a row the lanes take four neighbouring butterflies of a
+// stage, with their own twiddles. The first two stages, whose butterflies are closer than four apart, are done
+// together in one scalar pass; their twiddles are 1 and i, so they need no multiplies.
+void OceanFFT::transformRows(float* re, float* im, int beginRow, int endRow) const {
+	for (int row = beginRow; row < endRow; row++) {
+		float* rowRe = re + (size_t)row * stride, * rowIm = im + (size_t)row * stride;
+		for (int i = 0; i < size; i++) {
+			const int other = bitReverse[i];
+			if (other <= i) continue;
+			swap(rowRe[i], rowRe[other]);
+			swap(rowIm[i], rowIm[other]);
+		}
+
+		for (int i = 0; i < size; i += 4) {
+			float* xRe = rowRe + i, * xIm = rowIm + i;
+			const float sum01Re = xRe[0] + xRe[1], sum01Im = xIm[0] + xIm[1], difference01Re = xRe[0] - xRe[1], difference01Im = xIm[0] - xIm[1];
+			const float sum23Re = xRe[2] + xRe[3], sum23Im = xIm[2] + xIm[3], difference23Re = xRe[2] - xRe[3], difference23Im = xIm[2] - xIm[3];
+			xRe[0] = sum01Re + sum23Re;
+			xIm[0] = sum01Im + sum23Im;
+			xRe[2] = sum01Re - sum23Re;
+			xIm[2] = sum01Im - sum23Im;
+			// i times the second difference
+			xRe[1] = difference01Re - difference23Im;
+			xIm[1] = difference01Im + difference23Re;
+			xRe[3] = difference01Re + difference23Im;
+			xIm[3] = difference01Im - difference23Re;
+		}
+
+		for (int half = 4; half < size; half *= 2) {
+			const float* wRe = &twiddleRe[half - 1], * wIm = &twiddleIm[half - 1];
+			for (int start = 0; start < size; start += half * 2) {
+				float* aRe = rowRe + start, * aIm = rowIm + start;
+				float* bRe = aRe + half, * bIm = aIm + half;
+				int j = 0;
+#ifdef SIMD_MATH_SSE
+				if (simd) {
+					for (; j + BATCH <= half; j += BATCH) {
+						const __m128 twRe = _mm_loadu_ps(wRe + j), twIm = _mm_loadu_ps(wIm + j);
+						const __m128 xRe = _mm_loadu_ps(bRe + j), xIm = _mm_loadu_ps(bIm + j);
+						const __m128 tRe = _mm_sub_ps(_mm_mul_ps(twRe, xRe), _mm_mul_ps(twIm, xIm));
+						const __m128 tIm = _mm_add_ps(_mm_mul_ps(twRe, xIm), _mm_mul_ps(twIm, xRe));
+						const __m128 yRe = _mm_loadu_ps(aRe + j), yIm = _mm_loadu_ps(aIm + j);
+						_mm_storeu_ps(bRe + j, _mm_sub_ps(yRe, tRe));
+						_mm_storeu_ps(bIm + j, _mm_sub_ps(yIm, tIm));
+						_mm_storeu_ps(aRe + j, _mm_add_ps(yRe, tRe));
+						_mm_storeu_ps(aIm + j, _mm_add_ps(yIm, tIm));
+					}
+				}
+#endif
+				for (; j < half; j++) {
+					const float tRe = wRe[j] * bRe[j] - wIm[j] * bIm[j];
+					const float tIm = wRe[j] * bIm[j] + wIm[j] * bRe[j];
+					bRe[j] = aRe[j] - tRe;
+					bIm[j] = aIm[j] - tIm;
+					aRe[j] += tRe;
+					aIm[j] += tIm;
+				}
+			}
+		}
+	}
+}
+
+void OceanFFT::pack(int beginRow, int endRow) {
+	const float choppiness = settings.choppiness;
+	for (int row = beginRow; row < endRow; row++) {
+		const size_t field = (size_t)row * stride;
+		float* texel = &displacement[(size_t)row * size * 4];
+		float* normal = &normals[(size_t)row * size * 4];
+		for (int column = 0; column < size; column++, texel += 4, normal += 4) {
+			const size_t i = field + column;
+			texel[0] = choppiness * fieldIm[0][i];
+			texel[1] = fieldRe[0][i];
+			texel[2] = choppiness * fieldRe[1][i];
+			texel[3] = 0.0f;
+
+			const float slopeX = fieldIm[1][i], slopeZ = fieldRe[2][i];
+			const float inverseLength = 1.0f / sqrtf(slopeX * slopeX + slopeZ * slopeZ + 1.0f);
+			normal[0] = -slopeX * inverseLength;
+			normal[1] = inverseLength;
+			normal[2] = -slopeZ * inverseLength;
+			normal[3] = 1.0f + choppiness * fieldIm[2][i];
+		}
+	}
+}
+
+void OceanFFT::sumWaves(float time, float x, float z, double result[3]) const {
+	result[0] = result[1] = result[2] = 0.0;
+	const double phaseTime = fmod((double)time, (double)settings.period);
+	for (size_t i = 0; i < (size_t)size * size; i++) {
+		const double phase = omega[i] * phaseTime, cosine = cos(phase), sine = sin(phase);
+		const double hRe = ((double)h0Re[i] + h0MinusRe[i]) * cosine + ((double)h0MinusIm[i] - h0Im[i]) * sine;
+		const double hIm = ((double)h0Im[i] + h0MinusIm[i]) * cosine + ((double)h0Re[i] - h0MinusRe[i]) * sine;
+		// Real part of h e^(i k.x), and of -i k/|k| h e^(i k.x)
+		const double wave = (double)kX[i] * x + (double)kZ[i] * z, c = cos(wave), s = sin(wave);
+		const double real = hRe * c - hIm * s, imaginary = hRe * s + hIm * c;
+		result[0] += kUnitX[i] * imaginary;
+		result[1] += real;
+		result[2] += kUnitZ[i] * imaginary;
+	}
+	result[0] *= settings.choppiness;
+	result[2] *= settings.choppiness;
+}
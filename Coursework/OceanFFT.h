@@ -0,0 +1,86 @@
+#pragma once
+// Tessendorf ocean on the CPU. A Phillips spectrum is drawn once per settings change; each update turns it forward
+// to the given time and takes it back to the surface with inverse FFTs, giving a tileable patch of displacement
+// (choppy x, height, choppy z) and normals for water_vs.hlsl to sample. The five real fields go through three complex
+// transforms, two to a transform, since each one's spectrum is Hermitian. The first pass runs down the columns, four
+// columns to an SSE2 register, and the second along each row, four butterflies at a time once they are far enough
+// apart; rows are padded so the column pass does not keep landing in the same cache sets. The spectrum's sines and
+// cosines are evaluated four at a time as well. Rows and columns are spread over the job system when one is given.
+
+#include "SimdMath.h"
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+class JobSystem;
+
+struct OceanSettings {
+	int size = 128;	// Samples along each side of the patch; a power of two
+	float patchLength = 64.0f;	// World units the patch covers before it repeats
+	float windSpeed = 12.0f;
+	float windDirectionX = 1.0f, windDirectionZ = 0.0f;
+	float amplitude = 0.00001f;	// Phillips constant
+	float choppiness = 1.2f;	// Horizontal displacement scale; 0 for a heightfield
+	float period = 200.0f;	// Seconds before the motion repeats; frequencies are rounded to fit
+	uint32_t seed = 1;
+};
+
+class OceanFFT {
+public:
+	OceanFFT() : simd(hasSimd()) {}
+
+	// Draws the spectrum. Sizes are rounded up to a power of two, at least 4.
+	void setup(const OceanSettings& settings);
+	void update(float time, JobSystem* jobs = nullptr);
+
+	// size x size texels, rows along z, four floats each: x, height, z, 0
+	const float* getDisplacement() const { return displacement.data(); }
+	// size x size texels: the normal, then 1 plus the choppiness times the horizontal displacement's divergence, a
+	// first-order Jacobian that drops below 0 where the surface folds over
+	const float* getNormals() const { return normals.data(); }
+	int getSize() const { return size; }
+	const OceanSettings& getSettings() const { return settings; }
+
+	// Every wave summed directly at a point, in double precision: what the transforms stand in for
+	void sumWaves(float time, float x, float z, double displacement[3]) const;
+
+	void setSimd(bool enabled) { simd = enabled && hasSimd(); }
+	static bool hasSimd();
+
+	static constexpr float GRAVITY = 9.81f;
+	static constexpr float SUPPRESS_AGAINST_WIND = 0.07f;	// Waves running into the wind keep this share of their energy
+	static constexpr float SMALL_WAVE_FRACTION = 0.001f;	// Waves shorter than this share of the largest are damped
+
+private:
+	void evolve(int beginRow, int endRow, float time);
+	void transformColumns(float* re, float* im, int beginColumn, int endColumn) const;
+	void transformRows(float* re, float* im, int beginRow, int endRow) const;
+	void pack(int beginRow, int endRow);
+	template<typename F>
+	void forRows(JobSystem* jobs, int grain, F&& function);
+
+	OceanSettings settings;
+	int size = 0;
+	int logSize = 0;
+	int stride = 0;	// Floats from one row of a field to the next
+
+	// Per wave vector, row-major with rows along kz
+	vector<float> h0Re, h0Im;	// h0(k)
+	vector<float> h0MinusRe, h0MinusIm;	// conj(h0(-k))
+	vector<float> omega;
+	vector<float> kX, kZ;	// Wave vector
+	vector<float> kUnitX, kUnitZ;	// Normalised, 0 at k = 0
+
+	// Twiddles exp(+2pi i j / span), span after span, starting at span / 2 - 1
+	vector<float> twiddleRe, twiddleIm;
+	vector<int> bitReverse;
+
+	// Three complex fields: height + i choppy x, choppy z + i slope x, slope z + i divergence
+	vector<float> fieldRe[3], fieldIm[3];
+
+	vector<float> displacement;
+	vector<float> normals;
+
+	bool simd;
+};
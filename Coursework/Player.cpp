@@ -20,14 +20,8 @@ T clamp(T v, T lo, T hi) {
 }
 
 Player::Player() :
-	position({ 58.881f, 8.507f, 68.2f }),
-	velocity({ 0.f, 0.f, 0.f }),
 	rotation({ 0.f, 0.0f, 0.f }),
-	speed(40.0f),
-	camEyeHeight(3.f),
-	jumpForce(7.0f),
 	mouseSensitivity(0.4f),
-	isJumping(false),
 	sceneData(nullptr)
 {
 }
@@ -36,7 +30,7 @@ void Player::initialize(SceneData* sceneData) {
 	this->sceneData = sceneData;
 	if (sceneData) {
 		sceneData->playerData.firstTimeInPlayMode = true;
-		camEyeHeight = sceneData->playerData.cameraEyeHeight;
+		motion.eyeHeight = sceneData->playerData.cameraEyeHeight;
 	}
 }
 
@@ -53,82 +47,38 @@ XMFLOAT3 Player::getCameraTarget() const {
 }
 
 bool Player::isGrounded(TerrainManipulation* terrain) const {
+	const XMFLOAT3& position = motion.position;
 	const bool isOnTerrain = terrain->isOnTerrain(position.x, position.z);
 	const float terrainHeight = isOnTerrain ? terrain->getHeight(position.x, position.z) : -50.f;
-	const bool terrainGrounded = isOnTerrain && (position.y <= (terrainHeight + camEyeHeight + 0.1f));
+	const bool terrainGrounded = isOnTerrain && (position.y <= (terrainHeight + motion.eyeHeight + 0.1f));
 
 	const bool isOnBridge = terrain->onBridge(position.x, position.z);
 	const float bridgeHeight = isOnBridge ? terrain->getHeight(position.x, position.z) : -50.f;
-	const bool bridgeGrounded = isOnBridge && (position.y <= (bridgeHeight + camEyeHeight + 0.1f));
+	const bool bridgeGrounded = isOnBridge && (position.y <= (bridgeHeight + motion.eyeHeight + 0.1f));
 
 	return terrainGrounded || bridgeGrounded;
 }
 
 void Player::update(float deltaTime, Input* input, TerrainManipulation* terrain) {
-	// Process movement input
-	XMFLOAT3 moveInput = {};
-	if (input->isKeyDown('W')) moveInput.z += 1.0f;
-	if (input->isKeyDown('S')) moveInput.z -= 1.0f;
-	if (input->isKeyDown('A')) moveInput.x -= 1.0f;
-	if (input->isKeyDown('D')) moveInput.x += 1.0f;
-	if (input->isKeyDown(VK_SPACE) && !isJumping) {
-		velocity.y = jumpForce;
-		isJumping = true;
-	}
-
-	// Normalize and rotate movement vector
-	XMVECTOR moveVec = XMLoadFloat3(&moveInput);
-	if (!XMVector3Equal(moveVec, XMVectorZero())) {
-		moveVec = XMVector3Normalize(XMVector3Transform(
-			moveVec,
-			XMMatrixRotationY(XMConvertToRadians(rotation.y))
-		));
-		XMStoreFloat3(&moveInput, moveVec);
-	}
-
-	// Physics update
-	const bool grounded = isGrounded(terrain);
-	if (!grounded) {
-		// Airborne physics
-		velocity.y -= 15.8f * deltaTime;
-		constexpr float airControlFactor = 0.5f;
-		velocity.x += moveInput.x * speed * airControlFactor * deltaTime;
-		velocity.z += moveInput.z * speed * airControlFactor * deltaTime;
-		velocity.x *= 0.92f; // Air resistance
-		velocity.z *= 0.92f;
-	}
-	else {
-		// Grounded physics
-		if (velocity.y < 0.0f) {
-			velocity.y = 0.0f;
-			isJumping = false;
-		}
-
-		if (moveInput.x != 0.0f || moveInput.z != 0.0f) {
-			velocity.x = moveInput.x * speed;
-			velocity.z = moveInput.z * speed;
-		}
-		else {
-			velocity.x *= 0.8f; // Ground friction
-			velocity.z *= 0.8f;
-		}
-	}
-
-	// Update position
-	position.x += velocity.x * deltaTime;
-	position.y += velocity.y * deltaTime;
-	position.z += velocity.z * deltaTime;
-
-	if (position.y < -50.0f) {
+	PlayerInput keys;
+	keys.forward = input->isKeyDown('W');
+	keys.back = input->isKeyDown('S');
+	keys.left = input->isKeyDown('A');
+	keys.right = input->isKeyDown('D');
+	keys.jump = input->isKeyDown(VK_SPACE);
+
+	// The terrain is only asked while there's no collision geometry to sweep against
+	const bool terrainGrounded = !motion.usesCollision() && isGrounded(terrain);
+	if (motion.step(deltaTime, keys, rotation.y, terrainGrounded)) {
+		splashed = true;
 		resetParams();
 	}
 }
-void Player::updatePlayer(float deltaTime, Input* input, TerrainManipulation* terrain, Camera* camera, FMODAudioSystem* audioSystem, Islands* islands)
+void Player::updatePlayer(float deltaTime, Input* input, TerrainManipulation* terrain, Camera* camera, AudioSystem* audioSystem)
 {
 	update(deltaTime, input, terrain);
 	updateCameraPosition(camera);
 	handleTerrainCollision(deltaTime, terrain, camera);
-	HandlePickupCollisions(islands, audioSystem);
 
 	// Update audio listener
 	const XMFLOAT3 camPos = camera->getPosition();
@@ -161,9 +111,10 @@ void Player::handleTerrainCollision(float deltaTime, TerrainManipulation* terrai
 {
 	XMFLOAT3 camPos = camera->getPosition();
 
-	if (terrain->isOnTerrain(camPos.x, camPos.z)) {
+	// The swept move has already kept the player out of the ground
+	if (!motion.usesCollision() && terrain->isOnTerrain(camPos.x, camPos.z)) {
 		const float terrainY = terrain->getHeight(camPos.x, camPos.z);
-		const float minY = terrainY + camEyeHeight;
+		const float minY = terrainY + motion.eyeHeight;
 
 		if (camPos.y < minY) {
 			camPos.y = minY;
@@ -196,67 +147,59 @@ void Player::handleTerrainCollision(float deltaTime, TerrainManipulation* terrai
 	sceneData->playerData.lastCameraPosition = camPos;
 }
 
-void Player::HandlePickupCollisions(Islands* islands, FMODAudioSystem* audioSystem) {
-	if (!islands) return;
-
-	XMFLOAT3 pickupPosition;
-	const float playerCollisionRadius = 3.0f;
-
-	if (islands->CheckPickupCollision(position, playerCollisionRadius, pickupPosition)) audioSystem->playOneShot("event:/Pickup");
-}
-
-void Player::handlePlayModeReset(Islands* islands, TerrainManipulation* terrain, Camera* camera)
+bool Player::handlePlayModeReset(Islands* islands, TerrainManipulation* terrain, Camera* camera)
 {
-	if (!sceneData) return;
+	if (!sceneData) return false;
 
-	if (sceneData->playerData.firstTimeInPlayMode || position.y < -50.0f) {
+	const bool fromWater = splashed;
+	splashed = false;
+	if (sceneData->playerData.firstTimeInPlayMode || fromWater) {
 		const XMFLOAT3 islandPos = islands->GetRandomIslandPosition();
 		const float terrainHeight = terrain->getHeight(islandPos.x, islandPos.z);
 
 		setPosition(islandPos.x, terrainHeight + 2.0f, islandPos.z);
 
 		const XMFLOAT3 camPos = getCameraPosition();
-		camera->setPosition(camPos.x, camPos.y + camEyeHeight, camPos.z);
+		camera->setPosition(camPos.x, camPos.y + motion.eyeHeight, camPos.z);
 		camera->setRotation(0.0f, 0.0f, 0.0f);
 
 		if (sceneData->playerData.firstTimeInPlayMode) {
 			sceneData->playerData.firstTimeInPlayMode = false;
 		}
 	}
+	return fromWater;
 }
 
-void Player::handleSonar(Input* input, FMODAudioSystem* audioSystem)
+bool Player::handleSonar(Input* input, AudioSystem* audioSystem)
 {
 	if (!sceneData || !input->isKeyDown('C') || sceneData->sonarData.isActive) {
-		return;
+		return false;
 	}
 
-	sceneData->sonarData = { true,0.0f,sceneData->sonarData.sonarDuration,position };
+	sceneData->sonarData = { true,0.0f,sceneData->sonarData.sonarDuration,motion.position };
 	sceneData->ghostData.sonarTargetPosition = sceneData->sonarData.sonarOrigin;
-	sceneData->ghostData.respondingToSonar = true;
-	sceneData->ghostData.sonarResponseTimer = 0.0f;
 	sceneData->tessMesh = true;
 
 	audioSystem->playOneShot("event:/EchoPulse");
-	audioSystem->dimBGM(FMODAudioSystem::ECHO_EFFECT_DURATION);
+	audioSystem->dimBGM(AudioSystem::ECHO_EFFECT_DURATION);
+	return true;
 }
 
 void Player::updateCameraPosition(Camera* camera)
 {
 	const XMFLOAT3 camPos = getCameraPosition();
-	camera->setPosition(camPos.x, camPos.y + camEyeHeight, camPos.z);
+	camera->setPosition(camPos.x, camPos.y + motion.eyeHeight, camPos.z);
 	camera->setRotation(rotation.x, rotation.y, 0.0f);
 	camera->update();
 }
 
 void Player::resetParams()
 {
-	velocity = { 0.f, 0.f, 0.f };
+	motion.reset();
 	rotation = { 0.f, 0.0f, 0.f };
-	isJumping = false;
 }
 
 void Player::setPosition(float x, float y, float z)
 {
-	position = { x, y, z };
+	motion.position = { x, y, z };
 }
\ No newline at end of file
@@ -2,7 +2,8 @@
 #include <BaseApplication.h>
 #include "SceneData.h"
 #include "TerrainManipulation.h"
-#include "FMODAudioSystem.h"
+#include "AudioSystem.h"
+#include "PlayerMotion.h"
 
 class Player {
 public:
@@ -14,27 +15,30 @@ public:
 
 	// Core gameplay functions
 	void updatePlayer(float deltaTime, Input* input, TerrainManipulation* terrain,
-		Camera* camera, FMODAudioSystem* audioSystem, Islands* islands);
+		Camera* camera, AudioSystem* audioSystem);
 
 	// Movement and camera
 	void update(float deltaTime, Input* input, TerrainManipulation* terrain);
 	void handleMouseLook(Input* input, float deltaTime, HWND hwnd, int winW, int winH);
 
 	// Gameplay systems
-	void handleSonar(Input* input, FMODAudioSystem* audioSystem);
-	void handlePlayModeReset(Islands* islands, TerrainManipulation* terrain, Camera* camera);
-	void HandlePickupCollisions(Islands* islands, FMODAudioSystem* audioSystem);
+	bool handleSonar(Input* input, AudioSystem* audioSystem);	// True when a ping was sent
+	bool handlePlayModeReset(Islands* islands, TerrainManipulation* terrain, Camera* camera);	// True when the player was pulled out of the water
 
 	// State management
 	void resetParams();
 	void setPosition(float x, float y, float z);
+	void setCollision(const PlayerCollision* playerCollision) { motion.setCollision(playerCollision); }	// Swept collision; null falls back to the terrain clamp
+	void setWater(const WaterSurface* surface) { motion.setWater(surface); }	// Null falls back to a flat sea at PlayerMotion::FALLBACK_WATER_LEVEL
 
 	// Getters
-	const XMFLOAT3& getPosition() const { return position; }
+	const XMFLOAT3& getPosition() const { return motion.position; }
 	const XMFLOAT3& getRotation() const { return rotation; }
-	XMFLOAT3 getCameraPosition() const { return { position.x, position.y + camEyeHeight, position.z }; }
+	XMFLOAT3 getCameraPosition() const { return { motion.position.x, motion.position.y + motion.eyeHeight, motion.position.z }; }
 	XMFLOAT3 getCameraTarget() const;
 
+	static constexpr float PICKUP_RADIUS = 3.0f;	// Reach for collecting pickups
+
 private:
 	// Helper methods
 	void updateCameraPosition(Camera* camera);
@@ -43,14 +47,10 @@ private:
 
 	// Member variables
 	SceneData* sceneData = nullptr;
-	XMFLOAT3 position = { 58.881f, 8.507f, 68.2f };
-	XMFLOAT3 velocity = { 0.f, 0.f, 0.f };
+	PlayerMotion motion;	// Position, velocity and the movement settings
 	XMFLOAT3 rotation = { 0.f, 90.f, 0.f };
 
 	// Configuration
-	float speed = 20.0f;
-	float camEyeHeight = 3.f;
-	float jumpForce = 7.0f;
 	float mouseSensitivity = 0.5f;
-	bool isJumping = false;
+	bool splashed = false;	// Fell below the water surface; cleared once handlePlayModeReset moves the player back
 };
\ No newline at end of file
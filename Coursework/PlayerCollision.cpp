@@ -0,0 +1,340 @@
+#include "PlayerCollision.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+	constexpr int BISECTIONS = 12;	// Terrain contact refinement, 1/4096 of a march step
+	constexpr float EPSILON = 1e-6f;
+
+	CollisionVector add(const CollisionVector& a, const CollisionVector& b) { return CollisionVector(a.x + b.x, a.y + b.y, a.z + b.z); }
+	CollisionVector subtract(const CollisionVector& a, const CollisionVector& b) { return CollisionVector(a.x - b.x, a.y - b.y, a.z - b.z); }
+	CollisionVector scale(const CollisionVector& v, float s) { return CollisionVector(v.x * s, v.y * s, v.z * s); }
+	float dot(const CollisionVector& a, const CollisionVector& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+	CollisionVector normalise(const CollisionVector& v) {
+		const float length = sqrtf(dot(v, v));
+		return length > EPSILON ? scale(v, 1.0f / length) : CollisionVector(0.0f, 1.0f, 0.0f);
+	}
+
+	// Entry time of a point moving from start by displacement into a sphere; false when it starts inside or misses
+	bool raySphere(const CollisionVector& start, const CollisionVector& displacement, const CollisionVector& centre, float radius, float& time) {
+		const CollisionVector m = subtract(start, centre);
+		const float b = dot(m, displacement), c = dot(m, m) - radius * radius;
+		if (c < 0.0f || b >= 0.0f) return false;
+		const float a = dot(displacement, displacement);
+		const float discriminant = b * b - a * c;
+		if (discriminant < 0.0f) return false;
+		time = (-b - sqrtf(discriminant)) / a;
+		return time <= 1.0f;
+	}
+}
+
+void PlayerCollision::setGeometry(const CollisionGeometry& geometry) {
+	slabs.clear();
+	for (const CollisionSlab& slab : geometry.slabs) {
+		slabs.push_back({ slab.centreX, slab.centreZ, slab.halfSize, slab.bottom, cosf(slab.rotationY), sinf(slab.rotationY) });
+	}
+	capsules = geometry.capsules;
+
+	originX = geometry.originX;
+	originZ = geometry.originZ;
+	cellSize = max(geometry.cellSize, EPSILON);
+	inverseCell = 1.0f / cellSize;
+	width = geometry.width;
+	depth = geometry.depth;
+	heights = geometry.heights;
+	if ((int)heights.size() < width * depth) width = depth = 0;
+}
+
+float PlayerCollision::gridHeight(float x, float z) const {
+	if (width < 2 || depth < 2) return heights.empty() ? 0.0f : heights[0];
+
+	const float gx = max(0.0f, min((x - originX) * inverseCell, (float)(width - 1)));
+	const float gz = max(0.0f, min((z - originZ) * inverseCell, (float)(depth - 1)));
+	const int ix = min((int)gx, width - 2), iz = min((int)gz, depth - 2);
+	const float fx = gx - ix, fz = gz - iz;
+	const float* row = &heights[(size_t)iz * width + ix];
+	const float front = row[0] + (row[1] - row[0]) * fx;
+	const float back = row[width] + (row[width + 1] - row[width]) * fx;
+	return front + (back - front) * fz;
+}
+
+// Central differences, as TerrainManipulation::getNormal
+CollisionVector PlayerCollision::terrainNormal(float x, float z) const {
+	const float delta = cellSize * 0.5f;
+	const float left = gridHeight(x - delta, z), right = gridHeight(x + delta, z);
+	const float down = gridHeight(x, z - delta), up = gridHeight(x, z + delta);
+	return normalise(CollisionVector(left - right, 2.0f * delta, down - up));
+}
+
+bool PlayerCollision::surfaceAt(float x, float z, float& height) const {
+	for (const Slab& slab : slabs) {
+		const float localX = x - slab.centreX, localZ = z - slab.centreZ;
+		if (fabsf(localX * slab.cosine - localZ * slab.sine) <= slab.halfSize && fabsf(localX * slab.sine + localZ * slab.cosine) <= slab.halfSize) {
+			height = gridHeight(x, z);
+			return true;
+		}
+	}
+	return false;
+}
+
+// Marches the path in steps of at most half a cell or half the radius, whichever is smaller, looking for the sphere's
+// bottom dropping through the surface while its centre is still above it, then bisects for the contact. Bottoms that
+// start under the surface are left to depenetrate(), which steps the sphere up.
+void PlayerCollision::sweepTerrain(const CollisionVector& start, const CollisionVector& displacement, float radius, CollisionHit& hit, bool& found) const {
+	if (slabs.empty()) return;
+
+	auto clearance = [&](float time, float& value) {
+		const CollisionVector centre = add(start, scale(displacement, time));
+		float height;
+		if (!surfaceAt(centre.x, centre.z, height)) return false;
+		value = centre.y - radius - height;
+		return value >= -radius;
+	};
+
+	const float length = sqrtf(dot(displacement, displacement));
+	const float step = max(min(cellSize, radius) * 0.5f, 1e-3f);
+	const float end = hit.time;	// Nothing past a contact already found matters
+	const int samples = max(1, (int)ceilf(length * end / step));
+
+	float previousTime = 0.0f, value = 0.0f;
+	bool previousClear = clearance(0.0f, value) && value >= -SKIN;
+	for (int i = 1; i <= samples; i++) {
+		const float time = end * i / samples;
+		const bool over = clearance(time, value);
+		if (previousClear && over && value < -SKIN) {
+			float low = previousTime, high = time;
+			for (int b = 0; b < BISECTIONS; b++) {
+				const float middle = 0.5f * (low + high);
+				float middleValue;
+				if (clearance(middle, middleValue) && middleValue < -SKIN) high = middle;
+				else low = middle;
+			}
+			const CollisionVector contact = add(start, scale(displacement, low));
+			hit.time = low;
+			hit.normal = terrainNormal(contact.x, contact.z);
+			found = true;
+			return;
+		}
+		previousClear = over && value >= -SKIN;
+		previousTime = time;
+	}
+}
+
+// Swept sphere against the slab grown by the radius, in the slab's own frame. Side contacts only count while the
+// centre is below the surface at the edge; above it the sphere is stepping onto the island, which the terrain handles.
+void PlayerCollision::sweepSlab(const Slab& slab, const CollisionVector& start, const CollisionVector& displacement, float radius, CollisionHit& hit, bool& found) const {
+	const float localX = start.x - slab.centreX, localZ = start.z - slab.centreZ;
+	const float position[3] = { localX * slab.cosine - localZ * slab.sine, start.y, localX * slab.sine + localZ * slab.cosine };
+	const float direction[3] = { displacement.x * slab.cosine - displacement.z * slab.sine, displacement.y,
+		displacement.x * slab.sine + displacement.z * slab.cosine };
+	const float extent = slab.halfSize + radius, base = slab.bottom - radius;
+
+	float enter = 0.0f, exit = hit.time;
+	int axis = -1;
+	for (int a = 0; a < 3; a += 2) {
+		if (fabsf(direction[a]) < EPSILON) {
+			if (fabsf(position[a]) > extent) return;
+			continue;
+		}
+		float entry = (-extent - position[a]) / direction[a], leave = (extent - position[a]) / direction[a];
+		if (entry > leave) swap(entry, leave);
+		if (entry > enter) {
+			enter = entry;
+			axis = a;
+		}
+		exit = min(exit, leave);
+		if (enter > exit) return;
+	}
+
+	// Open at the top; the floor is the only bound on y
+	if (fabsf(direction[1]) < EPSILON) {
+		if (position[1] < base) return;
+	}
+	else {
+		const float cross = (base - position[1]) / direction[1];
+		if (direction[1] > 0.0f) {
+			if (cross > enter) {
+				enter = cross;
+				axis = 1;
+			}
+		}
+		else exit = min(exit, cross);
+		if (enter > exit) return;
+	}
+	if (axis < 0 || enter >= hit.time) return;	// Starts inside, or later than what was already hit
+
+	const CollisionVector centre = add(start, scale(displacement, enter));
+	if (axis == 1) {
+		hit.normal = CollisionVector(0.0f, -1.0f, 0.0f);
+	}
+	else {
+		if (centre.y >= gridHeight(centre.x, centre.z)) return;
+		const float side = direction[axis] > 0.0f ? -1.0f : 1.0f;
+		const float normalX = axis == 0 ? side : 0.0f, normalZ = axis == 2 ? side : 0.0f;
+		hit.normal = CollisionVector(normalX * slab.cosine + normalZ * slab.sine, 0.0f, -normalX * slab.sine + normalZ * slab.cosine);
+	}
+	hit.time = enter;
+	found = true;
+}
+
+// Ray against the capsule grown by the sphere's radius: the cylinder between the end caps, then the caps themselves
+void PlayerCollision::sweepCapsule(const CollisionCapsule& capsule, const CollisionVector& start, const CollisionVector& displacement, float radius, CollisionHit& hit, bool& found) const {
+	const float reach = capsule.radius + radius;
+	const CollisionVector axis = subtract(capsule.b, capsule.a), m = subtract(start, capsule.a);
+	const float axisSq = dot(axis, axis);
+
+	float best = hit.time;
+	bool any = false;
+	if (axisSq > EPSILON) {
+		const float md = dot(m, axis), nd = dot(displacement, axis), nn = dot(displacement, displacement), mn = dot(m, displacement);
+		const float a = axisSq * nn - nd * nd;
+		const float c = axisSq * (dot(m, m) - reach * reach) - md * md;
+		if (fabsf(a) > EPSILON && c > 0.0f) {
+			const float b = axisSq * mn - nd * md;
+			const float discriminant = b * b - a * c;
+			if (discriminant >= 0.0f) {
+				const float time = (-b - sqrtf(discriminant)) / a;
+				const float along = md + time * nd;
+				if (time >= 0.0f && time < best && along >= 0.0f && along <= axisSq) {
+					best = time;
+					any = true;
+				}
+			}
+		}
+	}
+	float time;
+	if (raySphere(start, displacement, capsule.a, reach, time) && time >= 0.0f && time < best) {
+		best = time;
+		any = true;
+	}
+	if (raySphere(start, displacement, capsule.b, reach, time) && time >= 0.0f && time < best) {
+		best = time;
+		any = true;
+	}
+	if (!any) return;
+
+	const CollisionVector centre = add(start, scale(displacement, best));
+	const float along = axisSq > EPSILON ? max(0.0f, min(dot(subtract(centre, capsule.a), axis) / axisSq, 1.0f)) : 0.0f;
+	hit.time = best;
+	hit.normal = normalise(subtract(centre, add(capsule.a, scale(axis, along))));
+	found = true;
+}
+
+bool PlayerCollision::sweep(const CollisionVector& start, const CollisionVector& displacement, float radius, CollisionHit& hit) const {
+	hit.time = 1.0f;
+	bool found = false;
+	if (dot(displacement, displacement) < EPSILON * EPSILON) return false;
+
+	for (const Slab& slab : slabs) sweepSlab(slab, start, displacement, radius, hit, found);
+	for (const CollisionCapsule& capsule : capsules) sweepCapsule(capsule, start, displacement, radius, hit, found);
+	sweepTerrain(start, displacement, radius, hit, found);	// Last, so it only marches up to the nearest other contact
+	return found;
+}
+
+bool PlayerCollision::depenetrate(CollisionVector& position, CollisionVector& velocity, float radius) const {
+	bool grounded = false;
+
+	// Bottom under the surface with the centre still above it: step up onto it
+	float height;
+	if (surfaceAt(position.x, position.z, height)) {
+		const float clearance = position.y - radius - height;
+		if (clearance < 0.0f && clearance >= -radius) {
+			position.y = height + radius;
+			if (velocity.y < 0.0f) velocity.y = 0.0f;
+			grounded = true;
+		}
+	}
+
+	// Centre below the surface and inside a slab grown by the radius: out through the nearest side or the bottom
+	for (const Slab& slab : slabs) {
+		const float localX = position.x - slab.centreX, localZ = position.z - slab.centreZ;
+		const float rotatedX = localX * slab.cosine - localZ * slab.sine, rotatedZ = localX * slab.sine + localZ * slab.cosine;
+		const float extent = slab.halfSize + radius, base = slab.bottom - radius;
+		if (fabsf(rotatedX) >= extent || fabsf(rotatedZ) >= extent || position.y <= base) continue;
+		if (position.y >= gridHeight(position.x, position.z)) continue;
+
+		const float depthX = extent - fabsf(rotatedX), depthZ = extent - fabsf(rotatedZ), depthY = position.y - base;
+		CollisionVector normal(0.0f, -1.0f, 0.0f);
+		float push = depthY;
+		if (depthX < push) {
+			const float side = rotatedX < 0.0f ? -1.0f : 1.0f;
+			normal = CollisionVector(side * slab.cosine, 0.0f, -side * slab.sine);
+			push = depthX;
+		}
+		if (depthZ < push) {
+			const float side = rotatedZ < 0.0f ? -1.0f : 1.0f;
+			normal = CollisionVector(side * slab.sine, 0.0f, side * slab.cosine);
+			push = depthZ;
+		}
+		position = add(position, scale(normal, push + SKIN));
+		const float into = dot(velocity, normal);
+		if (into < 0.0f) velocity = subtract(velocity, scale(normal, into));
+	}
+
+	for (const CollisionCapsule& capsule : capsules) {
+		const CollisionVector axis = subtract(capsule.b, capsule.a);
+		const float axisSq = dot(axis, axis);
+		const float along = axisSq > EPSILON ? max(0.0f, min(dot(subtract(position, capsule.a), axis) / axisSq, 1.0f)) : 0.0f;
+		const CollisionVector offset = subtract(position, add(capsule.a, scale(axis, along)));
+		const float distance = sqrtf(dot(offset, offset)), reach = capsule.radius + radius;
+		if (distance >= reach || distance < EPSILON) continue;
+
+		const CollisionVector normal = scale(offset, 1.0f / distance);
+		position = add(position, scale(normal, reach - distance));
+		const float into = dot(velocity, normal);
+		if (into < 0.0f) velocity = subtract(velocity, scale(normal, into));
+		grounded = grounded || normal.y >= WALKABLE_NORMAL_Y;
+	}
+	return grounded;
+}
+
+bool PlayerCollision::move(CollisionVector& position, CollisionVector& velocity, float deltaTime, float radius) const {
+	if (!continuous) {
+		position = add(position, scale(velocity, deltaTime));
+		return depenetrate(position, velocity, radius);
+	}
+
+	const float distance = sqrtf(dot(velocity, velocity)) * deltaTime;
+	const int steps = max(1, min((int)ceilf(distance / (MAX_STEP * radius)), MAX_SUB_STEPS));
+	const float stepTime = deltaTime / steps;
+
+	bool grounded = false;
+	for (int step = 0; step < steps; step++) {
+		grounded = depenetrate(position, velocity, radius);
+
+		CollisionVector remaining = scale(velocity, stepTime);
+		for (int slide = 0; slide < MAX_SLIDES; slide++) {
+			const float length = sqrtf(dot(remaining, remaining));
+			if (length < EPSILON) break;
+
+			CollisionHit hit;
+			if (!sweep(position, remaining, radius, hit)) {
+				position = add(position, remaining);
+				break;
+			}
+
+			// Stop a skin short of the contact, then carry on along the surface with what is left
+			const float travel = max(hit.time - SKIN / length, 0.0f);
+			position = add(position, scale(remaining, travel));
+			remaining = scale(remaining, 1.0f - travel);
+			remaining = subtract(remaining, scale(hit.normal, dot(remaining, hit.normal)));
+			const float into = dot(velocity, hit.normal);
+			if (into < 0.0f) velocity = subtract(velocity, scale(hit.normal, into));
+			grounded = grounded || hit.normal.y >= WALKABLE_NORMAL_Y;
+		}
+	}
+	return grounded;
+}
+
+bool PlayerCollision::isGrounded(const CollisionVector& position, float radius) const {
+	float height;
+	if (surfaceAt(position.x, position.z, height)) {
+		const float clearance = position.y - radius - height;
+		if (clearance >= -radius && clearance <= GROUND_PROBE) return true;
+	}
+
+	CollisionHit hit;
+	return sweep(position, CollisionVector(0.0f, -GROUND_PROBE - SKIN, 0.0f), radius, hit) && hit.normal.y >= WALKABLE_NORMAL_Y;
+}
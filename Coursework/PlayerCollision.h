@@ -0,0 +1,92 @@
+#pragma once
+// Continuous collision for the player as a sphere against the world: the island heightfield, the sides and bottom of
+// each island slab, and bridge decks as capsules. A sweep finds the earliest contact along the whole path, so nothing
+// is skipped however far the sphere moves in a frame; move() splits the frame into sub-steps by distance travelled
+// and slides along each contact, so resting, sliding and stepping stay stable at any frame rate.
+
+#include "Vector3.h"
+#include <vector>
+
+typedef Vector3 CollisionVector;
+
+using namespace std;
+
+// An island slab rotated about Y like the island meshes. Its top is the heightfield; its sides and bottom are solid.
+struct CollisionSlab {
+	float centreX = 0.0f, centreZ = 0.0f;
+	float halfSize = 0.0f;
+	float rotationY = 0.0f;
+	float bottom = 0.0f;
+};
+
+// A bridge deck: everything within radius of the segment from a to b
+struct CollisionCapsule {
+	CollisionVector a, b;
+	float radius = 0.0f;
+};
+
+struct CollisionGeometry {
+	vector<CollisionSlab> slabs;
+	vector<CollisionCapsule> capsules;
+
+	// Row-major terrain height grid (x fastest) with cell (0, 0) at origin, sampled bilinearly; only walkable inside
+	// a slab's footprint
+	float originX = 0.0f, originZ = 0.0f;
+	float cellSize = 1.0f;
+	int width = 0, depth = 0;
+	vector<float> heights;
+};
+
+struct CollisionHit {
+	float time = 1.0f;	// Fraction of the displacement travelled before contact
+	CollisionVector normal;
+};
+
+class PlayerCollision {
+public:
+	void setGeometry(const CollisionGeometry& geometry);
+
+	// Earliest contact of a sphere moving from start by displacement; false when the whole path is clear
+	bool sweep(const CollisionVector& start, const CollisionVector& displacement, float radius, CollisionHit& hit) const;
+
+	// Moves the sphere by velocity * deltaTime, sliding along whatever it meets; velocity loses the part heading into
+	// each contact. True when it ends on walkable ground.
+	bool move(CollisionVector& position, CollisionVector& velocity, float deltaTime, float radius) const;
+
+	bool isGrounded(const CollisionVector& position, float radius) const;	// Walkable ground within GROUND_PROBE below
+
+	// Terrain height under (x, z); false off every island
+	bool surfaceAt(float x, float z, float& height) const;
+
+	bool isEmpty() const { return slabs.empty() && capsules.empty(); }
+
+	// Off: move() jumps the whole frame and pushes out of whatever it lands in, as collision worked before sweeps
+	void setContinuous(bool enabled) { continuous = enabled; }
+
+	static constexpr float MAX_STEP = 0.5f;	// Longest sub-step, as a fraction of the radius
+	static constexpr int MAX_SUB_STEPS = 64;	// Past this sub-steps lengthen; the sweeps inside stay continuous
+	static constexpr int MAX_SLIDES = 4;	// Contacts resolved per sub-step
+	static constexpr float SKIN = 0.01f;	// Gap kept from every surface
+	static constexpr float GROUND_PROBE = 0.1f;
+	static constexpr float WALKABLE_NORMAL_Y = 0.7f;	// About 45 degrees
+
+private:
+	struct Slab {
+		float centreX, centreZ, halfSize, bottom;
+		float cosine, sine;	// Inverse rotation, as TerrainManipulation::isOnTerrain applies it
+	};
+
+	float gridHeight(float x, float z) const;
+	CollisionVector terrainNormal(float x, float z) const;
+	void sweepTerrain(const CollisionVector& start, const CollisionVector& displacement, float radius, CollisionHit& hit, bool& found) const;
+	void sweepSlab(const Slab& slab, const CollisionVector& start, const CollisionVector& displacement, float radius, CollisionHit& hit, bool& found) const;
+	void sweepCapsule(const CollisionCapsule& capsule, const CollisionVector& start, const CollisionVector& displacement, float radius, CollisionHit& hit, bool& found) const;
+	bool depenetrate(CollisionVector& position, CollisionVector& velocity, float radius) const;	// True when pushed onto walkable ground
+
+	vector<Slab> slabs;
+	vector<CollisionCapsule> capsules;
+	bool continuous = true;
+	float originX = 0.0f, originZ = 0.0f, cellSize = 1.0f, inverseCell = 1.0f;
+	int width = 0, depth = 0;
+	vector<float> heights;
+};
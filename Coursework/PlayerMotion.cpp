@@ -0,0 +1,71 @@
+#include "PlayerMotion.h"
+
+bool PlayerMotion::step(float deltaTime, const PlayerInput& input, float yawDegrees, bool groundedWithoutCollision) {
+	// Process movement input
+	XMFLOAT3 moveInput = { 0.f, 0.f, 0.f };
+	if (input.forward) moveInput.z += 1.0f;
+	if (input.back) moveInput.z -= 1.0f;
+	if (input.left) moveInput.x -= 1.0f;
+	if (input.right) moveInput.x += 1.0f;
+	if (input.jump && !isJumping) {
+		velocity.y = jumpForce;
+		isJumping = true;
+	}
+
+	// Normalize and rotate movement vector
+	XMVECTOR moveVec = XMLoadFloat3(&moveInput);
+	if (!XMVector3Equal(moveVec, XMVectorZero())) {
+		moveVec = XMVector3Normalize(XMVector3Transform(
+			moveVec,
+			XMMatrixRotationY(XMConvertToRadians(yawDegrees))
+		));
+		XMStoreFloat3(&moveInput, moveVec);
+	}
+
+	// Physics update
+	const bool grounded = usesCollision() ? collision->isGrounded(position, eyeHeight) : groundedWithoutCollision;
+	if (!grounded) {
+		// Airborne physics
+		velocity.y -= 15.8f * deltaTime;
+		constexpr float airControlFactor = 0.5f;
+		velocity.x += moveInput.x * speed * airControlFactor * deltaTime;
+		velocity.z += moveInput.z * speed * airControlFactor * deltaTime;
+		velocity.x *= 0.92f; // Air resistance
+		velocity.z *= 0.92f;
+	}
+	else {
+		// Grounded physics
+		if (velocity.y < 0.0f) {
+			velocity.y = 0.0f;
+			isJumping = false;
+		}
+
+		if (moveInput.x != 0.0f || moveInput.z != 0.0f) {
+			velocity.x = moveInput.x * speed;
+			velocity.z = moveInput.z * speed;
+		}
+		else {
+			velocity.x *= 0.8f; // Ground friction
+			velocity.z *= 0.8f;
+		}
+	}
+
+	// Update position, swept against the islands and bridges so no frame length can carry the player through them
+	if (usesCollision()) {
+		collision->move(position, velocity, deltaTime, eyeHeight);
+	}
+	else {
+		position.x += velocity.x * deltaTime;
+		position.y += velocity.y * deltaTime;
+		position.z += velocity.z * deltaTime;
+	}
+
+	// The feet have gone under the drawn surface, waves and all
+	const float waterHeight = water ? water->getHeight(position.x, position.z) : FALLBACK_WATER_LEVEL;
+	return position.y < waterHeight;
+}
+
+void PlayerMotion::reset() {
+	velocity = { 0.f, 0.f, 0.f };
+	isJumping = false;
+}
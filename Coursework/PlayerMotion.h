@@ -0,0 +1,41 @@
+#pragma once
+// The player's movement with the window, camera and terrain classes left out: the keys turned by the look direction,
+// gravity, air control and friction, the swept move against PlayerCollision, and the fall into the water. Player
+// drives it from Input once a frame; the benchmarks drive it headless. Nothing here depends on D3D.
+
+#include <DirectXMath.h>
+#include "PlayerCollision.h"
+#include "WaterSurface.h"
+
+using namespace DirectX;
+
+// The movement keys held this frame
+struct PlayerInput {
+	bool forward = false, back = false, left = false, right = false;
+	bool jump = false;
+};
+
+class PlayerMotion {
+public:
+	// One frame. groundedWithoutCollision is the terrain's answer, only asked for while there is no collision geometry.
+	// True when the feet went under the water; the motion is left where it fell for the caller to reset.
+	bool step(float deltaTime, const PlayerInput& input, float yawDegrees, bool groundedWithoutCollision);
+	void reset();	// Stops the player and ends any jump
+
+	bool usesCollision() const { return collision && !collision->isEmpty(); }
+	void setCollision(const PlayerCollision* playerCollision) { collision = playerCollision; }	// Swept collision; null moves straight through, for the caller to clamp
+	void setWater(const WaterSurface* surface) { water = surface; }	// Null falls back to a flat sea at FALLBACK_WATER_LEVEL
+
+	XMFLOAT3 position = { 58.881f, 8.507f, 68.2f };
+	XMFLOAT3 velocity = { 0.f, 0.f, 0.f };
+	float speed = 40.0f;
+	float eyeHeight = 3.f;	// Also the radius the swept move keeps from the ground
+	float jumpForce = 7.0f;
+	bool isJumping = false;
+
+	static constexpr float FALLBACK_WATER_LEVEL = -50.0f;
+
+private:
+	const PlayerCollision* collision = nullptr;
+	const WaterSurface* water = nullptr;
+};
@@ -0,0 +1,65 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+using namespace std;
+
+// Bounded lock-free ring for exactly one producer thread and one consumer thread.
+// Capacity is rounded up to a power of two. push fails instead of blocking when the ring is full.
+template<typename T>
+class SPSCQueue {
+public:
+	explicit SPSCQueue(size_t capacity = 1024) {
+		size_t size = 2;
+		while (size < capacity) size <<= 1;
+		slots.resize(size);
+		mask = size - 1;
+	}
+
+	SPSCQueue(const SPSCQueue&) = delete;
+	SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+	// Producer only
+	bool push(const T& item) {
+		const size_t tail = tailIndex.load(memory_order_relaxed);
+		if (tail - cachedHead > mask) {
+			cachedHead = headIndex.load(memory_order_acquire);
+			if (tail - cachedHead > mask) return false;
+		}
+
+		slots[tail & mask] = item;
+		tailIndex.store(tail + 1, memory_order_release);
+		return true;
+	}
+
+	// Consumer only
+	bool pop(T& item) {
+		const size_t head = headIndex.load(memory_order_relaxed);
+		if (head == cachedTail) {
+			cachedTail = tailIndex.load(memory_order_acquire);
+			if (head == cachedTail) return false;
+		}
+
+		item = slots[head & mask];
+		headIndex.store(head + 1, memory_order_release);
+		return true;
+	}
+
+	// Approximate from either side while the other is running
+	size_t size() const { return tailIndex.load(memory_order_acquire) - headIndex.load(memory_order_acquire); }
+	bool empty() const { return size() == 0; }
+	size_t capacity() const { return mask + 1; }
+
+private:
+	static constexpr size_t CACHE_LINE = 64;
+
+	vector<T> slots;
+	size_t mask;
+
+	// Each side owns one index and keeps a stale copy of the other's, so it only touches the shared line when it must
+	alignas(CACHE_LINE) atomic<size_t> headIndex{ 0 };
+	size_t cachedTail = 0;	// Consumer's view of tailIndex
+	alignas(CACHE_LINE) atomic<size_t> tailIndex{ 0 };
+	size_t cachedHead = 0;	// Producer's view of headIndex
+};
@@ -0,0 +1,80 @@
+#include "SceneConstants.h"
+#include "MemoryTracker.h"
+
+SceneConstants::SceneConstants(ID3D11Device* device) {
+	// Rewritten only when the lights change, so it lives in default memory and goes up with UpdateSubresource
+	D3D11_BUFFER_DESC bufferDesc = {};
+	bufferDesc.Usage = D3D11_USAGE_DEFAULT;
+	bufferDesc.ByteWidth = sizeof(LightBufferType);
+	bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	device->CreateBuffer(&bufferDesc, NULL, &lightBuffer);
+
+	bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	bufferDesc.ByteWidth = sizeof(FrameBufferType);
+	bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	device->CreateBuffer(&bufferDesc, NULL, &frameBuffer);
+
+	MemoryTracker::allocateGpu(MemoryTag::Rendering, GpuMemory::Buffer, sizeof(LightBufferType) + sizeof(FrameBufferType));
+}
+
+SceneConstants::~SceneConstants() {
+	MemoryTracker::freeGpu(MemoryTag::Rendering, GpuMemory::Buffer, sizeof(LightBufferType) + sizeof(FrameBufferType));
+	if (lightBuffer) {
+		lightBuffer->Release();
+		lightBuffer = nullptr;
+	}
+	if (frameBuffer) {
+		frameBuffer->Release();
+		frameBuffer = nullptr;
+	}
+}
+
+void SceneConstants::update(ID3D11DeviceContext* deviceContext, const SceneData& sceneData) {
+	if (!packed || lightVersion != sceneData.lightData.version || shadowLightsVersion != sceneData.shadowLightsData.version ||
+		moonVersion != sceneData.moonData.version) {
+		LightBufferType lights;
+		packLights(sceneData, lights);
+		deviceContext->UpdateSubresource(lightBuffer, 0, NULL, &lights, 0, 0);
+		packed = true;
+		lightVersion = sceneData.lightData.version;
+		shadowLightsVersion = sceneData.shadowLightsData.version;
+		moonVersion = sceneData.moonData.version;
+		lightUploads++;
+	}
+
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+	if (SUCCEEDED(deviceContext->Map(frameBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource))) {
+		FrameBufferType* framePtr = (FrameBufferType*)mappedResource.pData;
+		framePtr->time = sceneData.waterData.timeVal;
+		framePtr->padding = XMFLOAT3(0.f, 0.f, 0.f);
+		deviceContext->Unmap(frameBuffer, 0);
+	}
+}
+
+void SceneConstants::packLights(const SceneData& sceneData, LightBufferType& lights) {
+	const LightData& lightData = sceneData.lightData;
+	const ShadowLightsData& shadowLightsData = sceneData.shadowLightsData;
+
+	lights.ambientColour = XMFLOAT4(lightData.ambientColour);
+	lights.diffuseColour = XMFLOAT4(lightData.diffuseColour);
+
+	lights.pointLight1Position = XMFLOAT3(lightData.pointLight_pos1);
+	lights.pointLight1Radius = lightData.pointLightRadius[0];
+	lights.pointLight1Colour = XMFLOAT4(lightData.pointLight1Colour);
+
+	lights.pointLight2Position = XMFLOAT3(lightData.pointLight_pos2);
+	lights.pointLight2Radius = lightData.pointLightRadius[1];
+	lights.pointLight2Colour = XMFLOAT4(lightData.pointLight2Colour);
+
+	lights.spotlightColour = XMFLOAT4(shadowLightsData.spotColour);
+	lights.spotlightCutoff = shadowLightsData.spotCutoff;
+	lights.spotlightDirection = XMFLOAT3(shadowLightsData.lightDirections[0]);
+	lights.spotlightFalloff = shadowLightsData.spotFalloff;
+
+	lights.moonPos = XMFLOAT3(sceneData.moonData.moon_pos);
+	lights.specularColour = XMFLOAT4(lightData.specularColour);
+	lights.specularPower = lightData.spec_pow;
+
+	lights.directionalLightDirection = XMFLOAT3(shadowLightsData.lightDirections[1]);
+	lights.directionalColour = XMFLOAT4(shadowLightsData.dirColour);
+}
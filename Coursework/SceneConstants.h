@@ -0,0 +1,76 @@
+#pragma once
+// The scene's lights, packed once for every lit shader. terrain_ps, water_ps, firefly_ps and moon_ps all read the same
+// LightBuffer at b0; rather than each shader filling a copy of its own on every draw, update() packs it from
+// LightData, ShadowLightsData and MoonData only when one of their versions has moved, and the shaders bind the one
+// buffer. The frame block (the time) goes up once a frame, for the shaders that animate.
+
+#include <d3d11.h>
+#include <DirectXMath.h>
+
+using namespace DirectX;
+
+#include "SceneData.h"
+
+class SceneConstants {
+public:
+	// As terrain_ps, water_ps, firefly_ps and moon_ps declare it
+	struct LightBufferType {
+		XMFLOAT4 ambientColour;
+		XMFLOAT4 diffuseColour;
+
+		XMFLOAT3 pointLight1Position;
+		float pointLight1Radius;
+		XMFLOAT4 pointLight1Colour;
+
+		XMFLOAT3 pointLight2Position;
+		float pointLight2Radius;
+		XMFLOAT4 pointLight2Colour;
+
+		XMFLOAT4 spotlightColour;
+
+		float spotlightCutoff;
+		XMFLOAT3 spotlightDirection;
+
+		float spotlightFalloff;
+		XMFLOAT3 moonPos;
+
+		XMFLOAT4 specularColour;
+
+		float specularPower;
+		XMFLOAT3 directionalLightDirection;
+
+		XMFLOAT4 directionalColour;
+	};
+
+	struct FrameBufferType {
+		float time;
+		XMFLOAT3 padding;
+	};
+
+	static constexpr UINT LIGHT_SLOT = 0;	// Pixel shader constant buffer registers
+	static constexpr UINT FRAME_SLOT = 1;
+
+	SceneConstants(ID3D11Device* device);
+	~SceneConstants();
+
+	// Once a frame, after the frame's changes to SceneData and before anything lit is drawn
+	void update(ID3D11DeviceContext* deviceContext, const SceneData& sceneData);
+
+	void bindLights(ID3D11DeviceContext* deviceContext) { deviceContext->PSSetConstantBuffers(LIGHT_SLOT, 1, &lightBuffer); }
+	void bindFrame(ID3D11DeviceContext* deviceContext) { deviceContext->PSSetConstantBuffers(FRAME_SLOT, 1, &frameBuffer); }
+
+	static void packLights(const SceneData& sceneData, LightBufferType& lights);
+
+	unsigned int getLightUploads() const { return lightUploads; }	// Since startup; stays put while nothing changes
+
+private:
+	ID3D11Buffer* lightBuffer = nullptr;
+	ID3D11Buffer* frameBuffer = nullptr;
+
+	// Versions the light buffer was last packed from
+	bool packed = false;
+	unsigned int lightVersion = 0;
+	unsigned int shadowLightsVersion = 0;
+	unsigned int moonVersion = 0;
+	unsigned int lightUploads = 0;
+};
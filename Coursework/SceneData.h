@@ -27,6 +27,8 @@ public:
 	float pointLight_pos2[3] = { 53.75f, 3.75f, 66.25f };
 	float pointLight2Colour[4] = { 1.f, 1.f, 1.f, 1.0f };
 	float pointLightRadius[2] = { 5.f, 5.f };
+
+	unsigned int version = 0;	// Bumped whenever a field above changes, so SceneConstants repacks the lights
 };
 
 // Water Data Structure
@@ -36,6 +38,14 @@ public:
 	float frequency = 0.37f;
 	float speed = 2.f;
 	float timeVal = 0.f;
+
+	float level = -50.f;	// Height of the still surface
+	bool visible = false;	// The water plane is drawn only when this is set
+	bool fftOcean = true;	// Tessendorf ocean from OceanFFT in place of the sine waves
+	float oceanPatchLength = 64.f;	// World units before the ocean repeats
+	float oceanWindSpeed = 12.f;
+	float oceanChoppiness = 1.2f;
+	int oceanSize = 128;	// FFT samples along each side
 };
 
 // Shadow Lights Data Structure
@@ -49,12 +59,16 @@ public:
 	float spotFalloff = 5.0f;
 	bool enableSpotShadow = true; // Toggle for spotlight shadows
 	bool enableDirShadow = true; // Toggle for directional light shadows
+
+	unsigned int version = 0;	// Bumped whenever a field above changes
 };
 
 // Moon Data Structure
 struct MoonData {
 public:
 	float moon_pos[3] = { 58.611f, 66.0f, 134.0f };
+
+	unsigned int version = 0;	// Bumped whenever a field above changes
 };
 
 // Bloom Data Structure
@@ -80,7 +94,7 @@ struct ChromaticAberrationData {
 	XMFLOAT2 ghostScreenPos = { 0.0f, 0.0f };
 };
 
-// Ghost State structure
+// Ghost State structure; mirrors the swarm ghost nearest the camera
 struct GhostData {
 	XMFLOAT3 position = { 0.f, 0.f, 0.f };
 	XMFLOAT3 velocity = { 0.f, 0.f, 0.f };
@@ -138,6 +152,7 @@ public:
 	int islandCount = 2;
 	float minIslandDistance = 30.0f;
 	int gridSize = 700;
+	int ghostCount = 1;
 	bool firstTimeGeneratingIslands = true;
 
 	bool tessMesh = false;
@@ -145,11 +160,13 @@ public:
 	// Toggle spotlight shadow
 	void toggleSpotShadow() {
 		shadowLightsData.enableSpotShadow = !shadowLightsData.enableSpotShadow;
+		shadowLightsData.version++;
 	}
 
 	// Toggle directional light shadow
 	void toggleDirShadow() {
 		shadowLightsData.enableDirShadow = !shadowLightsData.enableDirShadow;
+		shadowLightsData.version++;
 	}
 
 	// Toggle tessellation - only show tessellated meshes
@@ -190,6 +207,10 @@ public:
 		// Reset moon data
 		moonData.moon_pos[0] = 58.611f; moonData.moon_pos[1] = 66.0f; moonData.moon_pos[2] = 134.0f;
 
+		lightData.version++;
+		shadowLightsData.version++;
+		moonData.version++;
+
 		// Reset bloom data
 		bloomData.blurAmount = 2.f;
 		bloomData.blurIntensity = 2.f;
@@ -201,11 +222,23 @@ public:
 		audioState = AudioState{};
 	}
 
-	// Set the point light which will follow the player
+	// Set the point light which will follow the player; standing still leaves the version alone
 	void setPointLight1Position(float x, float y, float z) {
+		if (lightData.pointLight_pos1[0] == x && lightData.pointLight_pos1[1] == y && lightData.pointLight_pos1[2] == z) return;
 		lightData.pointLight_pos1[0] = x;
 		lightData.pointLight_pos1[1] = y;
 		lightData.pointLight_pos1[2] = z;
+		lightData.version++;
+	}
+
+	// Set the directional light's colour, leaving its alpha
+	void setDirectionalColour(float r, float g, float b) {
+		float* colour = shadowLightsData.dirColour;
+		if (colour[0] == r && colour[1] == g && colour[2] == b) return;
+		colour[0] = r;
+		colour[1] = g;
+		colour[2] = b;
+		shadowLightsData.version++;
 	}
 
 	// Set the ghost position
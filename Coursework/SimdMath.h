@@ -0,0 +1,34 @@
+#pragma once
+// Where SSE2 is available, for every module with a four-lane path (audio DSP and occlusion, ghosts, terrain, ocean,
+// water), and the SSE2 helpers they share
+
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMD_MATH_SSE 1
+#include <emmintrin.h>
+
+// Sine and cosine of four angles: reduced to a quarter turn about 0 in two steps (Cody-Waite), then the Cephes
+// minimax polynomials, swapped and negated by quadrant
+inline void sinCos(__m128 angle, __m128& sine, __m128& cosine) {
+	const __m128i quadrant = _mm_cvtps_epi32(_mm_mul_ps(angle, _mm_set1_ps(0.636619772f)));
+	const __m128 q = _mm_cvtepi32_ps(quadrant);
+	__m128 r = _mm_sub_ps(angle, _mm_mul_ps(q, _mm_set1_ps(1.5703125f)));
+	r = _mm_sub_ps(r, _mm_mul_ps(q, _mm_set1_ps(4.83751297e-4f)));
+	r = _mm_sub_ps(r, _mm_mul_ps(q, _mm_set1_ps(7.54978995e-8f)));
+	const __m128 r2 = _mm_mul_ps(r, r);
+
+	__m128 s = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(-1.9515295891e-4f), r2), _mm_set1_ps(8.3321608736e-3f));
+	s = _mm_add_ps(_mm_mul_ps(s, r2), _mm_set1_ps(-1.6666654611e-1f));
+	s = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(s, r2), r), r);
+	__m128 c = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(2.443315711809948e-5f), r2), _mm_set1_ps(-1.388731625493765e-3f));
+	c = _mm_add_ps(_mm_mul_ps(c, r2), _mm_set1_ps(4.166664568298827e-2f));
+	c = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(c, r2), r2), _mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(r2, _mm_set1_ps(0.5f))));
+
+	// Odd quadrants swap the two; sine is negated in quadrants 2 and 3, cosine in 1 and 2
+	const __m128i one = _mm_set1_epi32(1), two = _mm_set1_epi32(2);
+	const __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, one), one));
+	const __m128 sineSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, two), 30));
+	const __m128 cosineSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, one), two), 30));
+	sine = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, c), _mm_andnot_ps(swap, s)), sineSign);
+	cosine = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, s), _mm_andnot_ps(swap, c)), cosineSign);
+}
+#endif
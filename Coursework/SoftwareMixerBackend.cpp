@@ -0,0 +1,398 @@
+#include "SoftwareMixerBackend.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+	// Ducking filter, matching the THREE_EQ and COMPRESSOR settings dimBGM used in FMOD (their default crossovers,
+	// ratio and timings, with the mid/high cut and threshold FMODAudioBackend sets)
+	constexpr float DUCK_LOW_CROSSOVER = 400.0f;
+	constexpr float DUCK_HIGH_CROSSOVER = 4000.0f;
+	constexpr float DUCK_MID_GAIN_DB = -6.0f;
+	constexpr float DUCK_HIGH_GAIN_DB = -3.0f;
+	constexpr float DUCK_THRESHOLD_DB = -15.0f;
+	constexpr float DUCK_RATIO = 2.5f;
+	constexpr float DUCK_ATTACK = 0.02f;
+	constexpr float DUCK_RELEASE = 0.1f;
+
+	// Distance low-pass: fully open at minDistance, down to this at maxDistance
+	constexpr float OPEN_CUTOFF = 22000.0f;
+	constexpr float FAR_CUTOFF = 2500.0f;
+
+	constexpr float MIN_DOPPLER = 0.5f, MAX_DOPPLER = 2.0f;
+	constexpr float HALF_PI = 1.57079632679f;
+	constexpr float DEGREES_TO_RADIANS = 0.0174532925f;
+
+	float dbToLinear(float db) { return powf(10.0f, db / 20.0f); }
+
+	float dot(const AudioVector& a, const AudioVector& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+	AudioVector cross(const AudioVector& a, const AudioVector& b) {
+		return AudioVector(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+	}
+}
+
+SoftwareMixerBackend::SoftwareMixerBackend(int sampleRate_) : sampleRate(sampleRate_), simd(AudioDSP::hasSimd()) {}
+
+void SoftwareMixerBackend::registerEvent(const string& eventPath, const vector<float>& samples, bool loop) {
+	Event& event = events[eventPath];
+	event.samples = samples;
+	event.loop = loop;
+}
+
+void SoftwareMixerBackend::setDistanceRange(float minDistance_, float maxDistance_) {
+	minDistance = max(minDistance_, 0.001f);
+	maxDistance = max(maxDistance_, minDistance);
+}
+
+SoftwareMixerBackend::Voice* SoftwareMixerBackend::getVoice(AudioVoice voice) {
+	if (voice == 0 || voice > voices.size() || !voices[voice - 1].alive || voices[voice - 1].released) return nullptr;
+	return &voices[voice - 1];
+}
+
+AudioVoice SoftwareMixerBackend::allocateVoice(const Event* event) {
+	AudioVoice handle;
+	if (!freeVoices.empty()) {
+		handle = freeVoices.back();
+		freeVoices.pop_back();
+	}
+	else {
+		voices.emplace_back();
+		handle = (AudioVoice)voices.size();
+	}
+
+	Voice& voice = voices[handle - 1];
+	voice = Voice();
+	voice.event = event;
+	voice.alive = true;
+	return handle;
+}
+
+void SoftwareMixerBackend::freeVoice(size_t index) {
+	voices[index].alive = false;
+	voices[index].playing = false;
+	freeVoices.push_back((AudioVoice)(index + 1));
+}
+
+size_t SoftwareMixerBackend::getPlayingVoices() const {
+	size_t count = 0;
+	for (const Voice& voice : voices) {
+		if (voice.alive && voice.playing) count++;
+	}
+	return count;
+}
+
+bool SoftwareMixerBackend::init() {
+	return true;
+}
+
+void SoftwareMixerBackend::release() {
+	voices.clear();
+	freeVoices.clear();
+}
+
+// Nothing to do per frame; audio only advances when render is called
+void SoftwareMixerBackend::update() {}
+
+AudioVoice SoftwareMixerBackend::createVoice(const string& eventPath) {
+	const auto it = events.find(eventPath);
+	if (it == events.end()) return 0;
+	return allocateVoice(&it->second);
+}
+
+void SoftwareMixerBackend::startVoice(AudioVoice voice) {
+	Voice* v = getVoice(voice);
+	if (!v) return;
+
+	// Restarts from the top, like an FMOD event instance
+	v->position = 0.0;
+	v->playing = true;
+	v->stopping = false;
+	v->fade = 1.0f;
+	v->lastGain = v->lastLeft = v->lastRight = 0.0f;
+	v->lowpassState = v->eqLowState = v->eqHighState = v->envelope = 0.0f;
+}
+
+void SoftwareMixerBackend::stopVoice(AudioVoice voice, bool allowFadeOut) {
+	Voice* v = getVoice(voice);
+	if (!v) return;
+
+	if (allowFadeOut && v->playing) v->stopping = true;
+	else v->playing = false;
+}
+
+void SoftwareMixerBackend::releaseVoice(AudioVoice voice) {
+	Voice* v = getVoice(voice);
+	if (!v) return;
+
+	// A voice still fading out keeps going and is freed by render once it is silent
+	if (v->playing) v->released = true;
+	else freeVoice(voice - 1);
+}
+
+void SoftwareMixerBackend::playOneShot(const char* eventPath) {
+	const auto it = events.find(eventPath);
+	if (it == events.end()) return;
+
+	// Heard at the listener; released as soon as it finishes
+	const AudioVoice handle = allocateVoice(&it->second);
+	startVoice(handle);
+	Voice& voice = voices[handle - 1];
+	voice.attributes.position = listener.position;
+	voice.dopplerLevel = 0.0f;
+	voice.released = true;
+}
+
+void SoftwareMixerBackend::setVolume(AudioVoice voice, float volume) {
+	if (Voice* v = getVoice(voice)) v->volume = volume;
+}
+
+void SoftwareMixerBackend::setPitch(AudioVoice voice, float pitch) {
+	if (Voice* v = getVoice(voice)) v->pitch = pitch;
+}
+
+void SoftwareMixerBackend::set3DAttributes(AudioVoice voice, const AudioAttributes3D& attributes) {
+	if (Voice* v = getVoice(voice)) v->attributes = attributes;
+}
+
+void SoftwareMixerBackend::setCone(AudioVoice voice, const AudioVector& direction, float insideAngle, float outsideAngle, float outsideVolume) {
+	Voice* v = getVoice(voice);
+	if (!v) return;
+
+	v->coneDirection = direction;
+	v->coneInside = insideAngle;
+	v->coneOutside = max(outsideAngle, insideAngle);
+	v->coneOutsideVolume = outsideVolume;
+}
+
+void SoftwareMixerBackend::setDopplerLevel(AudioVoice voice, float level) {
+	if (Voice* v = getVoice(voice)) v->dopplerLevel = level;
+}
+
+void SoftwareMixerBackend::setSpread(AudioVoice voice, float degrees) {
+	if (Voice* v = getVoice(voice)) v->spread = degrees;
+}
+
+void SoftwareMixerBackend::setLowpass(AudioVoice voice, float cutoffHz) {
+	if (Voice* v = getVoice(voice)) v->cutoff = cutoffHz;
+}
+
+void SoftwareMixerBackend::setDuckingFilter(AudioVoice voice, bool enabled) {
+	Voice* v = getVoice(voice);
+	if (!v || v->ducked == enabled) return;
+
+	v->ducked = enabled;
+	v->eqLowState = v->eqHighState = v->envelope = 0.0f;
+}
+
+void SoftwareMixerBackend::addTransient(AudioVoice voice, float gain) {
+	if (Voice* v = getVoice(voice)) v->transient += gain;
+}
+
+void SoftwareMixerBackend::setListener(const AudioAttributes3D& attributes) {
+	listener = attributes;
+}
+
+SoftwareMixerBackend::BlockParameters SoftwareMixerBackend::computeParameters(const Voice& voice, float blockSeconds) const {
+	BlockParameters parameters;
+
+	// Unit vector from the listener to the voice; a voice on top of the listener counts as straight ahead
+	AudioVector toVoice(voice.attributes.position.x - listener.position.x, voice.attributes.position.y - listener.position.y,
+		voice.attributes.position.z - listener.position.z);
+	const float distance = sqrtf(dot(toVoice, toVoice));
+	if (distance > 1e-4f) toVoice = AudioVector(toVoice.x / distance, toVoice.y / distance, toVoice.z / distance);
+	else toVoice = listener.forward;
+
+	// Inverse roll-off, clamped inside minDistance and cut off past maxDistance
+	const float attenuation = distance >= maxDistance ? 0.0f : minDistance / max(distance, minDistance);
+
+	// Cone, measured at the voice between its facing and the direction back to the listener
+	float cone = 1.0f;
+	if (voice.coneInside < 360.0f) {
+		const float length = sqrtf(dot(voice.coneDirection, voice.coneDirection));
+		if (length > 0.0f) {
+			const float cosine = -dot(voice.coneDirection, toVoice) / length;
+			const float angle = 2.0f * acosf(min(max(cosine, -1.0f), 1.0f)) / DEGREES_TO_RADIANS;
+			if (angle >= voice.coneOutside) cone = voice.coneOutsideVolume;
+			else if (angle > voice.coneInside) {
+				const float t = (angle - voice.coneInside) / (voice.coneOutside - voice.coneInside);
+				cone = 1.0f + (voice.coneOutsideVolume - 1.0f) * t;
+			}
+		}
+	}
+
+	// Doppler: listener moving towards the voice raises pitch, the voice moving away lowers it
+	float doppler = 1.0f;
+	if (voice.dopplerLevel > 0.0f) {
+		const float listenerSpeed = dot(listener.velocity, toVoice);
+		const float voiceSpeed = dot(voice.attributes.velocity, toVoice);
+		const float shift = (SPEED_OF_SOUND + listenerSpeed) / max(SPEED_OF_SOUND + voiceSpeed, 1.0f);
+		doppler = min(max(1.0f + (shift - 1.0f) * voice.dopplerLevel, MIN_DOPPLER), MAX_DOPPLER);
+	}
+	parameters.step = max(voice.pitch, 0.0f) * doppler;
+
+	// Equal-power pan on the listener's right axis; spread pulls the image back to the centre
+	const AudioVector right = cross(listener.up, listener.forward);
+	const float rightLength = sqrtf(dot(right, right));
+	float pan = rightLength > 0.0f ? dot(toVoice, right) / rightLength : 0.0f;
+	pan *= 1.0f - min(max(voice.spread, 0.0f), 360.0f) / 360.0f;
+	const float angle = (pan + 1.0f) * 0.5f * HALF_PI;
+	parameters.left = cosf(angle);
+	parameters.right = sinf(angle);
+
+	const float fade = voice.stopping ? max(voice.fade - blockSeconds / FADE_OUT_TIME, 0.0f) : voice.fade;
+	parameters.gain = voice.volume * fade * attenuation * cone * (1.0f + voice.transient);
+
+	// Distance low-pass, interpolated in log frequency so it closes evenly with distance
+	float cutoff = voice.cutoff;
+	if (distance > minDistance) {
+		const float t = min((distance - minDistance) / (maxDistance - minDistance + 1e-6f), 1.0f);
+		cutoff = min(cutoff, OPEN_CUTOFF * powf(FAR_CUTOFF / OPEN_CUTOFF, t));
+	}
+	parameters.lowpassCoefficient = AudioDSP::coefficientForCutoff(cutoff, (float)sampleRate);
+	return parameters;
+}
+
+// Fills lane `lane` of the gather buffers with the source sample pairs and fractions for this block
+void SoftwareMixerBackend::resample(Voice& voice, float step, size_t frames, int lane, bool& finished) {
+	const vector<float>& samples = voice.event->samples;
+	const size_t length = samples.size();
+	double position = voice.position;
+
+	for (size_t f = 0; f < frames; f++) {
+		const size_t i = f * AudioDSP::LANES + lane;
+		if (length == 0 || (!voice.event->loop && position >= (double)length)) {
+			gatherA[i] = gatherB[i] = gatherT[i] = 0.0f;
+			finished = true;
+			continue;
+		}
+
+		const size_t index = (size_t)position;
+		const size_t next = index + 1 < length ? index + 1 : (voice.event->loop ? 0 : index);
+		gatherA[i] = samples[index];
+		gatherB[i] = next == index ? 0.0f : samples[next];
+		gatherT[i] = (float)(position - (double)index);
+
+		position += step;
+		if (voice.event->loop && position >= (double)length) position = fmod(position, (double)length);
+	}
+	voice.position = position;
+}
+
+void SoftwareMixerBackend::renderGroup(const size_t* indices, int count, size_t frames, float* stereo) {
+	using namespace AudioDSP;
+	const float blockSeconds = (float)frames / (float)sampleRate;
+
+	LowpassLanes lowpassLanes = {};
+	EQLanes eq = {};
+	CompressorLanes compressor = {};
+	GainLanes gain = {}, left = {}, right = {};
+	bool anyDucked = false;
+
+	const float lowCoefficient = coefficientForCutoff(DUCK_LOW_CROSSOVER, (float)sampleRate);
+	const float highCoefficient = coefficientForCutoff(DUCK_HIGH_CROSSOVER, (float)sampleRate);
+	const float attack = coefficientForTime(DUCK_ATTACK, (float)sampleRate);
+	const float release = coefficientForTime(DUCK_RELEASE, (float)sampleRate);
+
+	for (int l = 0; l < LANES; l++) {
+		// Empty lanes run silence through unity settings
+		eq.lowGain[l] = eq.midGain[l] = eq.highGain[l] = 1.0f;
+		eq.lowCoefficient[l] = lowCoefficient;
+		eq.highCoefficient[l] = highCoefficient;
+		compressor.makeup[l] = 1.0f;
+		compressor.attack[l] = attack;
+		compressor.release[l] = release;
+
+		if (l >= count) {
+			for (size_t f = 0; f < frames; f++) gatherA[f * LANES + l] = gatherB[f * LANES + l] = gatherT[f * LANES + l] = 0.0f;
+			continue;
+		}
+
+		Voice& voice = voices[indices[l]];
+		const BlockParameters parameters = computeParameters(voice, blockSeconds);
+
+		bool finished = false;
+		resample(voice, parameters.step, frames, l, finished);
+
+		lowpassLanes.coefficient[l] = parameters.lowpassCoefficient;
+		lowpassLanes.state[l] = voice.lowpassState;
+
+		if (voice.ducked) {
+			anyDucked = true;
+			eq.midGain[l] = dbToLinear(DUCK_MID_GAIN_DB);
+			eq.highGain[l] = dbToLinear(DUCK_HIGH_GAIN_DB);
+			compressor.thresholdLog2[l] = log2f(dbToLinear(DUCK_THRESHOLD_DB));
+			compressor.slope[l] = 1.0f - 1.0f / DUCK_RATIO;
+		}
+		eq.lowState[l] = voice.eqLowState;
+		eq.highState[l] = voice.eqHighState;
+		compressor.envelope[l] = voice.envelope;
+
+		gain.start[l] = voice.lastGain;
+		gain.end[l] = parameters.gain;
+		left.start[l] = voice.lastLeft;
+		left.end[l] = parameters.left;
+		right.start[l] = voice.lastRight;
+		right.end[l] = parameters.right;
+
+		voice.lastGain = parameters.gain;
+		voice.lastLeft = parameters.left;
+		voice.lastRight = parameters.right;
+
+		// Block-rate state: fade-out, transient decay, end of a one-shot
+		if (voice.stopping) {
+			voice.fade = max(voice.fade - blockSeconds / FADE_OUT_TIME, 0.0f);
+			if (voice.fade <= 0.0f) finished = true;
+		}
+		voice.transient *= expf(-blockSeconds / TRANSIENT_TIME);
+		if (voice.transient < 1e-4f) voice.transient = 0.0f;
+		if (finished) {
+			voice.playing = false;
+			voice.stopping = false;
+		}
+	}
+
+	interpolate(gatherA, gatherB, gatherT, lanes, frames * LANES, simd);
+	lowpass(lanes, frames, lowpassLanes, simd);
+	if (anyDucked) {
+		equalise(lanes, frames, eq, simd);
+		compress(lanes, frames, compressor, simd);
+	}
+	applyGain(lanes, frames, gain, simd);
+	mixToStereo(lanes, frames, left, right, stereo, simd);
+
+	for (int l = 0; l < count; l++) {
+		Voice& voice = voices[indices[l]];
+		voice.lowpassState = lowpassLanes.state[l];
+		if (anyDucked) {
+			voice.eqLowState = eq.lowState[l];
+			voice.eqHighState = eq.highState[l];
+			voice.envelope = compressor.envelope[l];
+		}
+	}
+}
+
+void SoftwareMixerBackend::render(float* stereo, size_t frames) {
+	memset(stereo, 0, frames * 2 * sizeof(float));
+
+	for (size_t offset = 0; offset < frames; offset += BLOCK_FRAMES) {
+		const size_t blockFrames = min(BLOCK_FRAMES, frames - offset);
+
+		// Ducked voices go first so the EQ and compressor only run for groups that contain one
+		playingScratch.clear();
+		for (size_t i = 0; i < voices.size(); i++) {
+			if (voices[i].alive && voices[i].playing) playingScratch.push_back(i);
+		}
+		stable_partition(playingScratch.begin(), playingScratch.end(), [this](size_t i) { return voices[i].ducked; });
+
+		for (size_t first = 0; first < playingScratch.size(); first += AudioDSP::LANES) {
+			const int count = (int)min((size_t)AudioDSP::LANES, playingScratch.size() - first);
+			renderGroup(playingScratch.data() + first, count, blockFrames, stereo + offset * 2);
+		}
+
+		// Released voices are freed once they stop
+		for (size_t i : playingScratch) {
+			if (!voices[i].playing && voices[i].released) freeVoice(i);
+		}
+	}
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include "AudioBackend.h"
+#include "AudioDSP.h"
+#include <unordered_map>
+#include <vector>
+
+// In-process mixer that renders voices offline into a float buffer, with no sound card or FMOD.
+// Events are mono sample buffers registered up front (at the mixer's sample rate); a voice runs
+//   Doppler resample -> low-pass -> 3-band EQ -> compressor -> distance/volume gain -> stereo pan
+// with every stage SIMD across four voices (see AudioDSP). The ducking filter is the same EQ and compressor
+// settings dimBGM used in FMOD. Not thread-safe: call it from one thread, as AudioSystem's audio thread does.
+class SoftwareMixerBackend : public AudioBackend {
+public:
+	explicit SoftwareMixerBackend(int sampleRate = 48000);
+
+	void registerEvent(const string& eventPath, const vector<float>& samples, bool loop);
+	void setDistanceRange(float minDistance, float maxDistance);	// Inverse roll-off, silent past maxDistance
+	void setSimd(bool enabled) { simd = enabled && AudioDSP::hasSimd(); }
+	bool isSimd() const { return simd; }
+
+	// Mixes the playing voices into `stereo` (interleaved L/R, overwritten). Call repeatedly to stream.
+	void render(float* stereo, size_t frames);
+
+	int getSampleRate() const { return sampleRate; }
+	size_t getPlayingVoices() const;
+
+	bool init() override;
+	void release() override;
+	void update() override;
+
+	AudioVoice createVoice(const string& eventPath) override;
+	void startVoice(AudioVoice voice) override;
+	void stopVoice(AudioVoice voice, bool allowFadeOut) override;
+	void releaseVoice(AudioVoice voice) override;
+	void playOneShot(const char* eventPath) override;
+
+	void setVolume(AudioVoice voice, float volume) override;
+	void setPitch(AudioVoice voice, float pitch) override;
+	void set3DAttributes(AudioVoice voice, const AudioAttributes3D& attributes) override;
+
+	void setCone(AudioVoice voice, const AudioVector& direction, float insideAngle, float outsideAngle, float outsideVolume) override;
+	void setDopplerLevel(AudioVoice voice, float level) override;
+	void setSpread(AudioVoice voice, float degrees) override;
+
+	void setDuckingFilter(AudioVoice voice, bool enabled) override;
+	void addTransient(AudioVoice voice, float gain) override;
+	void setLowpass(AudioVoice voice, float cutoffHz) override;	// Upper bound on the distance low-pass
+
+	void setListener(const AudioAttributes3D& attributes) override;
+
+	static constexpr size_t BLOCK_FRAMES = 256;
+	static constexpr float SPEED_OF_SOUND = 343.0f;
+	static constexpr float FADE_OUT_TIME = 0.05f;	// Seconds, for stop with fade-out
+	static constexpr float TRANSIENT_TIME = 0.1f;	// Decay time of addTransient boosts
+
+private:
+	struct Event {
+		vector<float> samples;
+		bool loop;
+	};
+
+	struct Voice {
+		const Event* event = nullptr;
+		double position = 0.0;	// In source samples
+		AudioAttributes3D attributes;
+		float volume = 1.0f;
+		float pitch = 1.0f;
+		float dopplerLevel = 1.0f;
+		float spread = 0.0f;
+		AudioVector coneDirection = AudioVector(0.0f, 0.0f, 1.0f);
+		float coneInside = 360.0f, coneOutside = 360.0f, coneOutsideVolume = 1.0f;
+		float cutoff = 22000.0f;
+		float fade = 1.0f;
+		float transient = 0.0f;	// Extra gain, decaying
+		bool ducked = false;
+
+		bool alive = false;
+		bool playing = false;
+		bool stopping = false;
+		bool released = false;	// Freed once it stops playing
+
+		// DSP state carried between blocks
+		float lowpassState = 0.0f;
+		float eqLowState = 0.0f, eqHighState = 0.0f;
+		float envelope = 0.0f;
+		float lastGain = 0.0f, lastLeft = 0.0f, lastRight = 0.0f;	// Ramps start from here; a new voice fades in over one block
+	};
+
+	// Per-voice values for one block, worked out before the lane pass
+	struct BlockParameters {
+		float step;	// Source samples per output frame
+		float gain, left, right;
+		float lowpassCoefficient;
+	};
+
+	Voice* getVoice(AudioVoice voice);	// Null for unknown or released handles
+	AudioVoice allocateVoice(const Event* event);
+	void freeVoice(size_t index);
+	BlockParameters computeParameters(const Voice& voice, float blockSeconds) const;
+	void renderGroup(const size_t* indices, int count, size_t frames, float* stereo);
+	void resample(Voice& voice, float step, size_t frames, int lane, bool& finished);
+
+	int sampleRate;
+	float minDistance = 1.0f, maxDistance = 100.0f;
+	bool simd;
+
+	unordered_map<string, Event> events;	// Element addresses are stable, voices point into it
+	vector<Voice> voices;	// Indexed by handle - 1
+	vector<AudioVoice> freeVoices;
+	AudioAttributes3D listener;
+
+	// Lane-interleaved scratch, frame f of lane l at [f * LANES + l]
+	alignas(16) float lanes[BLOCK_FRAMES * AudioDSP::LANES];
+	alignas(16) float gatherA[BLOCK_FRAMES * AudioDSP::LANES];
+	alignas(16) float gatherB[BLOCK_FRAMES * AudioDSP::LANES];
+	alignas(16) float gatherT[BLOCK_FRAMES * AudioDSP::LANES];
+	vector<size_t> playingScratch;
+};
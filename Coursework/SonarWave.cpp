@@ -0,0 +1,151 @@
+#include "SonarWave.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+	// Cells are picked from a ring slightly wider than the one tested, so rounding never hides a cell the ring reaches
+	constexpr float HOLE_SHRINK = 0.999f;
+	constexpr float OUTER_PAD = 0.01f;	// Of a cell
+
+	// Rounded cell coordinate clamped to just outside [0, count) before the cast, so far-off origins cannot overflow
+	int toCell(float rounded, int count) {
+		return (int)max(-1.0f, min(rounded, (float)count));
+	}
+}
+
+void SonarWave::setTargets(SonarTarget target, const vector<SonarPoint>& points) {
+	Layer& layer = layers[(int)target];
+	layer.points = points;
+	layer.dirty = true;
+}
+
+void SonarWave::setCellSize(float size) {
+	cellSize = max(size, 0.01f);
+	for (Layer& layer : layers) layer.dirty = true;
+}
+
+void SonarWave::ping(float x, float z, float ringSpeed, float ringMaxRadius) {
+	originX = x;
+	originZ = z;
+	speed = ringSpeed;
+	maxRadius = ringMaxRadius;
+	radius = 0.0f;
+	elapsed = 0.0f;
+	pingId++;
+	running = true;
+}
+
+void SonarWave::update(float deltaTime, vector<SonarHit>& hits) {
+	hits.clear();
+	lastCells = 0;
+	lastTested = 0;
+	if (!running) return;
+
+	// From the elapsed time rather than accumulated steps, so the ring stays where the shader draws it
+	const float inner = radius;
+	elapsed += deltaTime;
+	radius = min(speed * elapsed, maxRadius);
+
+	for (int i = 0; i < (int)SonarTarget::Count; i++) {
+		Layer& layer = layers[i];
+		if (layer.dirty) rebuild(layer);
+		sweep(layer, (SonarTarget)i, max(inner - layer.slack, 0.0f), radius, hits);
+	}
+	if (radius >= maxRadius) running = false;
+}
+
+// Counting sort of the points into a grid over their bounds
+void SonarWave::rebuild(Layer& layer) {
+	layer.dirty = false;
+	layer.sorted.resize(layer.points.size());
+	if (layer.points.empty()) {
+		layer.width = layer.depth = 0;
+		layer.cellStart.assign(1, 0);
+		return;
+	}
+
+	float minX = layer.points[0].x, maxX = minX, minZ = layer.points[0].z, maxZ = minZ;
+	int maxId = 0;
+	for (const SonarPoint& point : layer.points) {
+		minX = min(minX, point.x);
+		maxX = max(maxX, point.x);
+		minZ = min(minZ, point.z);
+		maxZ = max(maxZ, point.z);
+		maxId = max(maxId, point.id);
+	}
+	if ((int)layer.stamp.size() <= maxId) layer.stamp.resize(maxId + 1, 0);
+
+	layer.cellSize = max(cellSize, sqrtf((maxX - minX) * (maxZ - minZ) / MAX_CELLS));
+	layer.inverseCell = 1.0f / layer.cellSize;
+	layer.originX = minX;
+	layer.originZ = minZ;
+	layer.width = (int)((maxX - minX) * layer.inverseCell) + 1;
+	layer.depth = (int)((maxZ - minZ) * layer.inverseCell) + 1;
+
+	const int cells = layer.width * layer.depth;
+	layer.cellStart.assign(cells + 1, 0);
+	auto cellOf = [&](const SonarPoint& point) {
+		const int column = min((int)((point.x - minX) * layer.inverseCell), layer.width - 1);
+		const int row = min((int)((point.z - minZ) * layer.inverseCell), layer.depth - 1);
+		return row * layer.width + column;
+	};
+	for (const SonarPoint& point : layer.points) layer.cellStart[cellOf(point) + 1]++;
+	for (int cell = 0; cell < cells; cell++) layer.cellStart[cell + 1] += layer.cellStart[cell];
+
+	vector<int> next(layer.cellStart.begin(), layer.cellStart.end() - 1);
+	for (const SonarPoint& point : layer.points) layer.sorted[next[cellOf(point)]++] = point;
+}
+
+// Visits the cells overlapping the annulus between inner and outer, row by row, skipping the run of cells in each row
+// that lie wholly inside the inner circle
+void SonarWave::sweep(Layer& layer, SonarTarget target, float inner, float outer, vector<SonarHit>& hits) {
+	if (layer.sorted.empty()) return;
+
+	const float cell = layer.cellSize, inverse = layer.inverseCell;
+	const float innerSq = inner * inner, outerSq = outer * outer;
+	const float reach = outer + cell * OUTER_PAD;
+	const int firstRow = max(toCell(floorf((originZ - reach - layer.originZ) * inverse), layer.depth), 0);
+	const int lastRow = min(toCell(floorf((originZ + reach - layer.originZ) * inverse), layer.depth), layer.depth - 1);
+
+	for (int row = firstRow; row <= lastRow; row++) {
+		const float top = layer.originZ + row * cell - originZ, bottom = top + cell;
+		const float nearZ = top > 0.0f ? top : (bottom < 0.0f ? -bottom : 0.0f);
+		const float farZ = max(fabsf(top), fabsf(bottom));
+		if (nearZ > reach) continue;
+
+		const float outerHalf = sqrtf(reach * reach - nearZ * nearZ);
+		const int first = max(toCell(floorf((originX - outerHalf - layer.originX) * inverse), layer.width), 0);
+		const int last = min(toCell(floorf((originX + outerHalf - layer.originX) * inverse), layer.width), layer.width - 1);
+
+		int holeFirst = last + 1, holeLast = last;
+		const float hole = inner * HOLE_SHRINK;
+		if (hole > farZ) {
+			const float holeHalf = sqrtf(hole * hole - farZ * farZ);
+			holeFirst = toCell(ceilf((originX - holeHalf - layer.originX) * inverse), layer.width);
+			holeLast = toCell(floorf((originX + holeHalf - layer.originX) * inverse), layer.width) - 1;
+		}
+
+		const int rowStart = row * layer.width;
+		if (holeFirst > holeLast) {
+			for (int column = first; column <= last; column++) visitCell(layer, target, rowStart + column, innerSq, outerSq, hits);
+			continue;
+		}
+		for (int column = first; column <= min(last, holeFirst - 1); column++) visitCell(layer, target, rowStart + column, innerSq, outerSq, hits);
+		for (int column = max(first, holeLast + 1); column <= last; column++) visitCell(layer, target, rowStart + column, innerSq, outerSq, hits);
+	}
+}
+
+void SonarWave::visitCell(Layer& layer, SonarTarget target, int cell, float innerSq, float outerSq, vector<SonarHit>& hits) {
+	lastCells++;
+	const int end = layer.cellStart[cell + 1];
+	for (int i = layer.cellStart[cell]; i < end; i++) {
+		const SonarPoint& point = layer.sorted[i];
+		lastTested++;
+		const float dx = point.x - originX, dz = point.z - originZ;
+		const float distanceSq = dx * dx + dz * dz;
+		if (distanceSq < innerSq || distanceSq > outerSq || layer.stamp[point.id] == pingId) continue;
+		layer.stamp[point.id] = pingId;
+		hits.push_back({ target, point.id, sqrtf(distanceSq) });
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+// Sonar as an expanding wavefront. Entities sit in uniform grids over the ground plane, one per kind; every update the
+// ring grows from its last radius to its new one and only the grid cells overlapping that annulus are visited, so a
+// tick costs about the ring area plus the entities in it, however big the world is. Each entity is hit at most once
+// per ping. Entities that move between rebuilds get a slack band inside the ring so they cannot slip through it,
+// and a per-entity ping stamp keeps them from being hit twice. Hits come back as one batch per update.
+
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+enum class SonarTarget : uint8_t { Ghost, Pickup, Island, Count };
+
+struct SonarPoint {
+	float x = 0.0f, z = 0.0f;
+	int id = 0;	// Caller's index; at most a few times the entity count, it sizes the ping stamps
+};
+
+struct SonarHit {
+	SonarTarget target;
+	int id;
+	float distance;	// From the ping origin on the ground plane
+};
+
+class SonarWave {
+public:
+	// Replaces the entities of one kind. The grid is rebuilt on the next update that has a ping running.
+	void setTargets(SonarTarget target, const vector<SonarPoint>& points);
+	// How far an entity of this kind can move between setTargets calls; widens the band searched inside the ring
+	void setSlack(SonarTarget target, float distance) { layers[(int)target].slack = distance; }
+	void setCellSize(float size);
+
+	// Restarts the ring at origin; the previous ping, if any, ends without further hits
+	void ping(float originX, float originZ, float speed, float maxRadius);
+	void stop() { running = false; }
+
+	// Grows the ring by speed * deltaTime and appends what it crossed to hits, which is cleared first
+	void update(float deltaTime, vector<SonarHit>& hits);
+
+	bool isRunning() const { return running; }
+	float getRadius() const { return radius; }
+	float getElapsed() const { return elapsed; }
+	int getLastCellsVisited() const { return lastCells; }
+	int getLastEntitiesTested() const { return lastTested; }
+
+	static constexpr float DEFAULT_CELL_SIZE = 8.0f;
+	static constexpr int MAX_CELLS = 1 << 20;	// Per kind; cells grow past the asked size to stay under it
+
+private:
+	struct Layer {
+		vector<SonarPoint> points;	// As given; sorted into cells on rebuild
+		vector<SonarPoint> sorted;
+		vector<int> cellStart;	// Prefix sums, one past the last cell
+		vector<uint32_t> stamp;	// Ping that last hit each id
+		float originX = 0.0f, originZ = 0.0f;
+		float cellSize = DEFAULT_CELL_SIZE, inverseCell = 1.0f / DEFAULT_CELL_SIZE;	// Coarser than asked when sparse
+		int width = 0, depth = 0;
+		float slack = 0.0f;
+		bool dirty = false;
+	};
+
+	void rebuild(Layer& layer);
+	void sweep(Layer& layer, SonarTarget target, float inner, float outer, vector<SonarHit>& hits);
+	void visitCell(Layer& layer, SonarTarget target, int cell, float innerSq, float outerSq, vector<SonarHit>& hits);
+
+	Layer layers[(int)SonarTarget::Count];
+	float cellSize = DEFAULT_CELL_SIZE;
+
+	bool running = false;
+	uint32_t pingId = 0;
+	float originX = 0.0f, originZ = 0.0f;
+	float speed = 0.0f, maxRadius = 0.0f;
+	float radius = 0.0f, elapsed = 0.0f;
+	int lastCells = 0, lastTested = 0;
+};
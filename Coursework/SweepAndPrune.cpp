@@ -0,0 +1,269 @@
+#include "SweepAndPrune.h"
+#include <algorithm>
+#include <cassert>
+
+namespace {
+
+	constexpr float LIMIT = 1e30f;	// Keeps infinities out of the sort
+
+	// Equal values put mins first, so touching boxes count as overlapping on every path
+	bool sortsBefore(float valueA, uint32_t dataA, float valueB, uint32_t dataB) {
+		return valueA < valueB || (valueA == valueB && (dataA & 1) < (dataB & 1));
+	}
+
+	uint64_t pairKey(int a, int b) {
+		return (uint64_t)(uint32_t)a << 32 | (uint32_t)b;
+	}
+}
+
+bool SweepAndPrune::overlaps(const BroadphaseBox& a, const BroadphaseBox& b) {
+	return a.min[0] <= b.max[0] && b.min[0] <= a.max[0] &&
+		a.min[1] <= b.max[1] && b.min[1] <= a.max[1] &&
+		a.min[2] <= b.max[2] && b.min[2] <= a.max[2];
+}
+
+int SweepAndPrune::add(const BroadphaseBox& box, uint32_t layer, uint32_t mask, int user) {
+	int handle;
+	if (!freeHandles.empty()) {
+		handle = freeHandles.back();
+		freeHandles.pop_back();
+	}
+	else {
+		handle = (int)proxies.size();
+		proxies.emplace_back();
+		for (vector<int>& position : positions) position.resize(proxies.size() * 2);
+	}
+
+	Proxy& proxy = proxies[handle];
+	proxy = Proxy();
+	proxy.layer = layer;
+	proxy.mask = mask;
+	proxy.user = user;
+	proxy.alive = true;
+	proxy.pending = true;
+	move(handle, box);
+	pending.push_back(handle);
+	live++;
+	return handle;
+}
+
+void SweepAndPrune::remove(int handle) {
+	Proxy& proxy = proxies[handle];
+	if (!proxy.alive) return;
+	proxy.alive = false;
+	removed.push_back(handle);
+	live--;
+}
+
+void SweepAndPrune::move(int handle, const BroadphaseBox& box) {
+	Proxy& proxy = proxies[handle];
+	assert(proxy.alive && "moved after remove(); the handle may already belong to another box");
+	for (int axis = 0; axis < 3; axis++) {
+		const float low = max(-LIMIT, min(box.min[axis], LIMIT)), high = max(-LIMIT, min(box.max[axis], LIMIT));
+		proxy.box.min[axis] = low;
+		proxy.box.max[axis] = high;
+		if (proxy.pending) continue;
+		axes[axis][positions[axis][handle * 2]].value = low;
+		axes[axis][positions[axis][handle * 2 + 1]].value = high;
+	}
+}
+
+void SweepAndPrune::clear() {
+	proxies.clear();
+	freeHandles.clear();
+	removed.clear();
+	pending.clear();
+	for (int axis = 0; axis < 3; axis++) {
+		axes[axis].clear();
+		positions[axis].clear();
+	}
+	pairs.clear();
+	pairIndex.clear();
+	live = 0;
+}
+
+void SweepAndPrune::update() {
+	lastSwaps = 0;
+	lastRebuilt = false;
+	if (!removed.empty()) dropRemoved();
+
+	if (!pending.empty() && pending.size() >= REBUILD_FRACTION * live) {
+		for (int handle : pending) {
+			for (int axis = 0; axis < 3; axis++) {
+				axes[axis].push_back({ proxies[handle].box.min[axis], (uint32_t)handle << 1 });
+				axes[axis].push_back({ proxies[handle].box.max[axis], (uint32_t)handle << 1 | 1u });
+			}
+		}
+		rebuild();
+	}
+	else {
+		for (int axis = 0; axis < 3; axis++) sortAxis(axis);
+		if (!pending.empty()) insertPending();
+	}
+
+	for (int handle : pending) proxies[handle].pending = false;
+	pending.clear();
+}
+
+// Drops removed boxes from the pair list and every axis in one pass each, keeping the order of the rest
+void SweepAndPrune::dropRemoved() {
+	int kept = 0;
+	for (int i = 0; i < (int)pairs.size(); i++) {
+		const BroadphasePair pair = pairs[i];
+		if (!proxies[pair.a].alive || !proxies[pair.b].alive) {
+			pairIndex.erase(pairKey(pair.a, pair.b));
+			proxies[pair.a].pairCount--;
+			proxies[pair.b].pairCount--;
+			continue;
+		}
+		if (kept != i) {
+			pairs[kept] = pair;
+			pairIndex[pairKey(pair.a, pair.b)] = kept;
+		}
+		kept++;
+	}
+	pairs.resize(kept);
+
+	for (int axis = 0; axis < 3; axis++) {
+		vector<Endpoint>& list = axes[axis];
+		int count = 0;
+		for (const Endpoint& endpoint : list) {
+			if (!proxies[endpoint.data >> 1].alive) continue;
+			positions[axis][endpoint.data] = count;
+			list[count++] = endpoint;
+		}
+		list.resize(count);
+	}
+
+	pending.erase(std::remove_if(pending.begin(), pending.end(), [&](int handle) { return !proxies[handle].alive; }), pending.end());
+	freeHandles.insert(freeHandles.end(), removed.begin(), removed.end());
+	removed.clear();
+}
+
+// Insertion sort, reading every swap as an event: a min moving left past a max starts an overlap on this axis, so the
+// pair is checked on all three; a max moving left past a min ends one, so the pair goes
+void SweepAndPrune::sortAxis(int axis) {
+	vector<Endpoint>& list = axes[axis];
+	const int count = (int)list.size();
+	for (int i = 1; i < count; i++) {
+		const Endpoint endpoint = list[i];
+		int j = i;
+		while (j > 0 && sortsBefore(endpoint.value, endpoint.data, list[j - 1].value, list[j - 1].data)) {
+			const Endpoint other = list[j - 1];
+			const uint32_t side = endpoint.data & 1, otherSide = other.data & 1;
+			if (side != otherSide) {
+				const int handle = (int)(endpoint.data >> 1), otherHandle = (int)(other.data >> 1);
+				if (side == 0) {
+					if (wants(proxies[handle], proxies[otherHandle]) && overlaps(proxies[handle].box, proxies[otherHandle].box)) addPair(handle, otherHandle);
+				}
+				else if (proxies[handle].pairCount && proxies[otherHandle].pairCount) removePair(handle, otherHandle);
+			}
+			list[j] = other;
+			positions[axis][other.data] = j;
+			j--;
+		}
+		if (j != i) {
+			list[j] = endpoint;
+			positions[axis][endpoint.data] = j;
+			lastSwaps += i - j;
+		}
+	}
+}
+
+// Sorts the new boxes' endpoints on their own and merges them into each axis, then sweeps x for their pairs
+void SweepAndPrune::insertPending() {
+	vector<Endpoint> fresh;
+	fresh.reserve(pending.size() * 2);
+	for (int axis = 0; axis < 3; axis++) {
+		fresh.clear();
+		for (int handle : pending) {
+			fresh.push_back({ proxies[handle].box.min[axis], (uint32_t)handle << 1 });
+			fresh.push_back({ proxies[handle].box.max[axis], (uint32_t)handle << 1 | 1u });
+		}
+		sort(fresh.begin(), fresh.end(), [](const Endpoint& a, const Endpoint& b) { return sortsBefore(a.value, a.data, b.value, b.data); });
+
+		vector<Endpoint>& list = axes[axis];
+		scratch.resize(list.size() + fresh.size());
+		merge(list.begin(), list.end(), fresh.begin(), fresh.end(), scratch.begin(),
+			[](const Endpoint& a, const Endpoint& b) { return sortsBefore(a.value, a.data, b.value, b.data); });
+		list.swap(scratch);
+		for (int i = 0; i < (int)list.size(); i++) positions[axis][list[i].data] = i;
+	}
+	sweep(false);
+}
+
+// Sorts every axis from scratch and finds every pair again
+void SweepAndPrune::rebuild() {
+	lastRebuilt = true;
+	for (int axis = 0; axis < 3; axis++) {
+		vector<Endpoint>& list = axes[axis];
+		sort(list.begin(), list.end(), [](const Endpoint& a, const Endpoint& b) { return sortsBefore(a.value, a.data, b.value, b.data); });
+		for (int i = 0; i < (int)list.size(); i++) positions[axis][list[i].data] = i;
+	}
+	pairs.clear();
+	pairIndex.clear();
+	for (Proxy& proxy : proxies) proxy.pairCount = 0;
+	sweep(true);
+}
+
+// Walks x keeping lists of the boxes open at each point, and pairs each new box with those it opens inside. A pair
+// needs a mask on at least one side, so new boxes without one only look at the open boxes that have one, and boxes
+// already on the axes only look at open new ones, having been paired with each other by the sort.
+void SweepAndPrune::sweep(bool everything) {
+	enum { ALL, MASKED, FRESH };
+	for (vector<int>& list : open) list.clear();
+	auto link = [&](int list, int handle) {
+		proxies[handle].slot[list] = (int)open[list].size();
+		open[list].push_back(handle);
+	};
+	auto unlink = [&](int list, int handle) {
+		const int last = open[list].back(), slot = proxies[handle].slot[list];
+		open[list][slot] = last;
+		proxies[last].slot[list] = slot;
+		open[list].pop_back();
+	};
+
+	for (const Endpoint& endpoint : axes[0]) {
+		const int handle = (int)(endpoint.data >> 1);
+		Proxy& proxy = proxies[handle];
+		const bool fresh = everything || proxy.pending;
+
+		if ((endpoint.data & 1) == 0) {
+			for (int other : open[fresh ? (proxy.mask ? ALL : MASKED) : FRESH]) {
+				if (wants(proxy, proxies[other]) && overlaps(proxy.box, proxies[other].box)) addPair(handle, other);
+			}
+			link(ALL, handle);
+			if (proxy.mask) link(MASKED, handle);
+			if (fresh) link(FRESH, handle);
+		}
+		else {
+			unlink(ALL, handle);
+			if (proxy.mask) unlink(MASKED, handle);
+			if (fresh) unlink(FRESH, handle);
+		}
+	}
+}
+
+void SweepAndPrune::addPair(int a, int b) {
+	if (a > b) swap(a, b);
+	if (!pairIndex.emplace(pairKey(a, b), (int)pairs.size()).second) return;
+	pairs.push_back({ a, b });
+	proxies[a].pairCount++;
+	proxies[b].pairCount++;
+}
+
+void SweepAndPrune::removePair(int a, int b) {
+	if (a > b) swap(a, b);
+	const auto found = pairIndex.find(pairKey(a, b));
+	if (found == pairIndex.end()) return;
+
+	const int slot = found->second;
+	pairIndex.erase(found);
+	proxies[a].pairCount--;
+	proxies[b].pairCount--;
+	if (slot != (int)pairs.size() - 1) {
+		pairs[slot] = pairs.back();
+		pairIndex[pairKey(pairs[slot].a, pairs[slot].b)] = slot;
+	}
+	pairs.pop_back();
+}
@@ -0,0 +1,96 @@
+#pragma once
+// Incremental sweep-and-prune broadphase over axis-aligned boxes. Each axis keeps every box's min and max endpoints in
+// sorted order; moving boxes only nudges them a little from frame to frame, so update() restores the order with an
+// insertion sort that costs about one pass plus a swap per endpoint that changed places. Every swap of a min past a
+// max is exactly where a pair starts or stops overlapping on that axis, so the pair list is kept up to date from the
+// swaps alone instead of testing every box against every other. Removed boxes are compacted out and new ones sorted
+// and merged in, each in one pass, so churn costs no more than the sort.
+// Layers and masks say which boxes care about each other: a pair is only tracked when either box's mask has the
+// other's layer, so crowds that never interact with each other (ghosts, pickups) cost nothing but their sorting.
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+struct BroadphaseBox {
+	float min[3] = {}, max[3] = {};
+
+	BroadphaseBox() {}
+	BroadphaseBox(float x, float y, float z, float halfSize) {
+		min[0] = x - halfSize; min[1] = y - halfSize; min[2] = z - halfSize;
+		max[0] = x + halfSize; max[1] = y + halfSize; max[2] = z + halfSize;
+	}
+};
+
+struct BroadphasePair {
+	int a, b;	// Handles, a < b
+};
+
+class SweepAndPrune {
+public:
+	// Boxes join the axes on the next update(); the handle stays valid until remove(), and after the next update() may
+	// be handed out again, so whoever held it must forget it
+	int add(const BroadphaseBox& box, uint32_t layer, uint32_t mask, int user = -1);
+	void remove(int handle);
+	void move(int handle, const BroadphaseBox& box);
+	void clear();
+
+	// Brings the axes back into order and the pair list up to date with every add, remove and move since the last one
+	void update();
+
+	// Every overlapping pair whose layers and masks match, as of the last update()
+	const vector<BroadphasePair>& getPairs() const { return pairs; }
+
+	int getUser(int handle) const { return proxies[handle].user; }
+	uint32_t getLayer(int handle) const { return proxies[handle].layer; }
+	const BroadphaseBox& getBox(int handle) const { return proxies[handle].box; }
+	int size() const { return live; }
+	long long getLastSwaps() const { return lastSwaps; }
+	bool getLastRebuilt() const { return lastRebuilt; }
+
+	// New boxes past this share of the total and update() sorts everything from scratch rather than merging them in
+	static constexpr float REBUILD_FRACTION = 0.25f;
+
+private:
+	struct Endpoint {
+		float value;
+		uint32_t data;	// Handle << 1, low bit set for a max
+	};
+
+	struct Proxy {
+		BroadphaseBox box;
+		uint32_t layer = 0, mask = 0;
+		int user = -1;
+		int slot[3] = {};	// Places in the open lists while sweeping
+		int pairCount = 0;	// Lets most ending overlaps skip the pair lookup
+		bool alive = false;
+		bool pending = false;	// Added since the last update, so not on the axes yet
+	};
+
+	bool wants(const Proxy& a, const Proxy& b) const {
+		return a.alive && b.alive && ((a.mask & b.layer) || (b.mask & a.layer));
+	}
+	static bool overlaps(const BroadphaseBox& a, const BroadphaseBox& b);
+
+	void dropRemoved();
+	void sortAxis(int axis);
+	void insertPending();
+	void rebuild();
+	void sweep(bool everything);
+	void addPair(int a, int b);
+	void removePair(int a, int b);
+
+	vector<Proxy> proxies;
+	vector<int> freeHandles, removed, pending;
+	vector<Endpoint> axes[3];
+	vector<int> positions[3];	// Where each handle's min (2 * handle) and max (2 * handle + 1) sit on each axis
+	vector<Endpoint> scratch;
+	vector<int> open[3];	// Boxes open at the sweep's current point: all of them, those with a mask, and new ones
+	vector<BroadphasePair> pairs;
+	unordered_map<uint64_t, int> pairIndex;	// Key of (a, b) to its place in pairs
+	int live = 0;
+	long long lastSwaps = 0;
+	bool lastRebuilt = false;
+};
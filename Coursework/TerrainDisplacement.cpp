@@ -0,0 +1,208 @@
+#include "TerrainDisplacement.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+	constexpr int BATCH = 4;
+}
+
+bool TerrainDisplacement::hasSimd() {
+#ifdef SIMD_MATH_SSE
+	return true;
+#else
+	return false;
+#endif
+}
+
+void TerrainDisplacement::setTexture(int width, int height, const uint8_t* rgba, int rowPitch) {
+	levels.clear();
+	if (width < 1 || height < 1 || !rgba) return;
+
+	Level top;
+	top.width = width;
+	top.height = height;
+	top.texels.resize((size_t)width * height);
+	for (int y = 0; y < height; y++) {
+		const uint8_t* row = rgba + (size_t)y * rowPitch;
+		for (int x = 0; x < width; x++) top.texels[(size_t)y * width + x] = row[x * 4] / 255.0f;
+	}
+	levels.push_back(move(top));
+
+	// 2x2 box filter down to 1x1, clamping the odd row and column, as TextureManager builds its chains
+	while (levels.back().width > 1 || levels.back().height > 1) {
+		const Level& source = levels.back();
+		Level level;
+		level.width = max(1, source.width / 2);
+		level.height = max(1, source.height / 2);
+		level.texels.resize((size_t)level.width * level.height);
+		for (int y = 0; y < level.height; y++) {
+			const float* row0 = &source.texels[(size_t)min(y * 2, source.height - 1) * source.width];
+			const float* row1 = &source.texels[(size_t)min(y * 2 + 1, source.height - 1) * source.width];
+			for (int x = 0; x < level.width; x++) {
+				const int x0 = min(x * 2, source.width - 1), x1 = min(x * 2 + 1, source.width - 1);
+				level.texels[(size_t)y * level.width + x] = (row0[x0] + row0[x1] + row1[x0] + row1[x1]) * 0.25f;
+			}
+		}
+		levels.push_back(move(level));
+	}
+}
+
+void TerrainDisplacement::setIslands(const vector<DisplacedIsland>& source, float halfSize) {
+	islands.clear();
+	inverseHalfSize = halfSize > 0.0f ? 1.0f / halfSize : 0.0f;
+	for (const DisplacedIsland& island : source) {
+		islands.push_back({ island.centreX, island.centreZ, cosf(island.rotationY), sinf(island.rotationY), island.baseHeight });
+	}
+}
+
+// Texel centres sit at half-texel offsets; the neighbour past either edge wraps round
+float TerrainDisplacement::sample(float u, float v, int level) const {
+	if (levels.empty()) return 0.0f;
+	const Level& map = levels[min(max(level, 0), (int)levels.size() - 1)];
+	const float x = (u - floorf(u)) * map.width - 0.5f, y = (v - floorf(v)) * map.height - 0.5f;
+	const float x0 = floorf(x), y0 = floorf(y);
+	const float fx = x - x0, fy = y - y0;
+	int left = (int)x0, top = (int)y0;
+	int right = left + 1, bottom = top + 1;
+	if (left < 0) left += map.width;
+	if (top < 0) top += map.height;
+	if (right >= map.width) right -= map.width;
+	if (bottom >= map.height) bottom -= map.height;
+
+	const float* upper = &map.texels[(size_t)top * map.width];
+	const float* lower = &map.texels[(size_t)bottom * map.width];
+	const float above = upper[left] + (upper[right] - upper[left]) * fx;
+	const float below = lower[left] + (lower[right] - lower[left]) * fx;
+	return above + (below - above) * fy;
+}
+
+void TerrainDisplacement::sample(const float* u, const float* v, size_t count, float* values, int level) const {
+	size_t first = 0;
+#ifdef SIMD_MATH_SSE
+	if (simd && !levels.empty()) {
+		const Level& map = levels[min(max(level, 0), (int)levels.size() - 1)];
+		const __m128 width = _mm_set1_ps((float)map.width), height = _mm_set1_ps((float)map.height), half = _mm_set1_ps(0.5f);
+		const __m128i widthI = _mm_set1_epi32(map.width), heightI = _mm_set1_epi32(map.height);
+		const __m128i zero = _mm_setzero_si128(), one = _mm_set1_epi32(1);
+		// floor() without SSE4.1: truncate, then step down where that rounded a negative up
+		auto floorLanes = [](__m128 value, __m128i& whole) {
+			whole = _mm_cvttps_epi32(value);
+			const __m128 truncated = _mm_cvtepi32_ps(whole);
+			const __m128 roundedUp = _mm_cmpgt_ps(truncated, value);
+			whole = _mm_add_epi32(whole, _mm_castps_si128(roundedUp));
+			return _mm_sub_ps(truncated, _mm_and_ps(roundedUp, _mm_set1_ps(1.0f)));
+		};
+
+		alignas(16) int32_t left[BATCH], right[BATCH], top[BATCH], bottom[BATCH];
+		alignas(16) float texels[4][BATCH];
+		for (; first + BATCH <= count; first += BATCH) {
+			__m128i whole;
+			__m128 uu = _mm_loadu_ps(&u[first]), vv = _mm_loadu_ps(&v[first]);
+			uu = _mm_sub_ps(uu, floorLanes(uu, whole));
+			vv = _mm_sub_ps(vv, floorLanes(vv, whole));
+			const __m128 x = _mm_sub_ps(_mm_mul_ps(uu, width), half), y = _mm_sub_ps(_mm_mul_ps(vv, height), half);
+			__m128i x0, y0;
+			const __m128 fx = _mm_sub_ps(x, floorLanes(x, x0)), fy = _mm_sub_ps(y, floorLanes(y, y0));
+
+			__m128i x1 = _mm_add_epi32(x0, one), y1 = _mm_add_epi32(y0, one);
+			x0 = _mm_add_epi32(x0, _mm_and_si128(_mm_cmplt_epi32(x0, zero), widthI));
+			y0 = _mm_add_epi32(y0, _mm_and_si128(_mm_cmplt_epi32(y0, zero), heightI));
+			x1 = _mm_sub_epi32(x1, _mm_andnot_si128(_mm_cmplt_epi32(x1, widthI), widthI));
+			y1 = _mm_sub_epi32(y1, _mm_andnot_si128(_mm_cmplt_epi32(y1, heightI), heightI));
+			_mm_store_si128((__m128i*)left, x0);
+			_mm_store_si128((__m128i*)right, x1);
+			_mm_store_si128((__m128i*)top, y0);
+			_mm_store_si128((__m128i*)bottom, y1);
+
+			// No gather in SSE2, so the four corners of each lane are fetched one by one
+			for (int lane = 0; lane < BATCH; lane++) {
+				const float* upper = &map.texels[(size_t)top[lane] * map.width];
+				const float* lower = &map.texels[(size_t)bottom[lane] * map.width];
+				texels[0][lane] = upper[left[lane]];
+				texels[1][lane] = upper[right[lane]];
+				texels[2][lane] = lower[left[lane]];
+				texels[3][lane] = lower[right[lane]];
+			}
+			const __m128 upperLeft = _mm_load_ps(texels[0]), upperRight = _mm_load_ps(texels[1]);
+			const __m128 lowerLeft = _mm_load_ps(texels[2]), lowerRight = _mm_load_ps(texels[3]);
+			const __m128 above = _mm_add_ps(upperLeft, _mm_mul_ps(_mm_sub_ps(upperRight, upperLeft), fx));
+			const __m128 below = _mm_add_ps(lowerLeft, _mm_mul_ps(_mm_sub_ps(lowerRight, lowerLeft), fx));
+			_mm_storeu_ps(&values[first], _mm_add_ps(above, _mm_mul_ps(_mm_sub_ps(below, above), fy)));
+		}
+	}
+#endif
+	for (; first < count; first++) values[first] = sample(u[first], v[first], level);
+}
+
+// The first island whose top face covers the point, with the texture coordinate there. CubeMesh runs u from 0 to 1
+// along local x and v from 0 to 1 down local z, from +1 to -1.
+int TerrainDisplacement::findIsland(float x, float z, float& u, float& v) const {
+	for (int i = 0; i < (int)islands.size(); i++) {
+		const Island& island = islands[i];
+		const float offsetX = x - island.centreX, offsetZ = z - island.centreZ;
+		// Inverse of XMMatrixRotationY, as TerrainManipulation::isOnTerrain applies it
+		const float localX = (offsetX * island.cosine - offsetZ * island.sine) * inverseHalfSize;
+		const float localZ = (offsetX * island.sine + offsetZ * island.cosine) * inverseHalfSize;
+		if (fabsf(localX) > 1.0f || fabsf(localZ) > 1.0f) continue;
+		u = (localX + 1.0f) * 0.5f;
+		v = (1.0f - localZ) * 0.5f;
+		return i;
+	}
+	return -1;
+}
+
+bool TerrainDisplacement::heightAt(float x, float z, float& height) const {
+	float u, v;
+	const int island = findIsland(x, z, u, v);
+	if (island < 0) return false;
+	height = islands[island].baseHeight + TOP + sample(u, v) * DISPLACEMENT_SCALE;
+	return true;
+}
+
+// Points are mapped to texture coordinates one by one, since each may land on a different island, then sampled in
+// batches of four
+void TerrainDisplacement::heightsAt(const float* x, const float* z, size_t count, float* heights, float offTerrain) const {
+	constexpr size_t CHUNK = 256;
+	float u[CHUNK], v[CHUNK], values[CHUNK], bases[CHUNK];
+	size_t indices[CHUNK];
+	for (size_t first = 0; first < count; first += CHUNK) {
+		const size_t end = min(count, first + CHUNK);
+		size_t found = 0;
+		for (size_t i = first; i < end; i++) {
+			const int island = findIsland(x[i], z[i], u[found], v[found]);
+			if (island < 0) {
+				heights[i] = offTerrain;
+				continue;
+			}
+			bases[found] = islands[island].baseHeight + TOP;
+			indices[found++] = i;
+		}
+		sample(u, v, found, values);
+		for (size_t i = 0; i < found; i++) heights[indices[i]] = bases[i] + values[i] * DISPLACEMENT_SCALE;
+	}
+}
+
+float TerrainDisplacement::flatError(int resolution, int samples) const {
+	if (levels.empty() || resolution < 1 || samples < 1) return 0.0f;
+	const float step = 1.0f / resolution;
+	float worst = 0.0f;
+	for (int row = 0; row < resolution; row++) {
+		for (int column = 0; column < resolution; column++) {
+			// CubeMesh splits each quad from bottom left to top right
+			const float u0 = column * step, v0 = row * step, u1 = u0 + step, v1 = v0 + step;
+			const float topLeft = sample(u0, v0), topRight = sample(u1, v0), bottomLeft = sample(u0, v1), bottomRight = sample(u1, v1);
+			for (int i = 0; i <= samples; i++) {
+				for (int j = 0; j <= samples; j++) {
+					const float a = (float)i / samples, b = (float)j / samples;
+					// a across, b down; above the diagonal is the top-left triangle
+					const float flat = a + b <= 1.0f ?
+						topLeft + (topRight - topLeft) * a + (bottomLeft - topLeft) * b :
+						bottomRight + (bottomLeft - bottomRight) * (1.0f - a) + (topRight - bottomRight) * (1.0f - b);
+					worst = max(worst, fabsf(sample(u0 + a * step, v0 + b * step) - flat));
+				}
+			}
+		}
+	}
+	return worst * DISPLACEMENT_SCALE;
+}
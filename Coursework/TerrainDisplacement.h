@@ -0,0 +1,74 @@
+#pragma once
+// CPU copy of the island surface as terrain_ds.hlsl draws it. The domain shader lifts each vertex of the island cube's
+// top face by the red channel of the island floor texture, sampled bilinearly with wrap addressing at mip 0, times
+// DISPLACEMENT_SCALE, before the island's scale, rotation and translation. Here the texture's red channel is kept with
+// a box-filtered mip chain, and a point in the world is taken back through the island's transform to the texture
+// coordinate the shader would have used, so collision and ray casts meet the surface that is drawn. Batched queries
+// sample four points at a time with SSE2.
+
+#include "SimdMath.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// An island's transform in App1::generateIslands: the unit cube scaled by (halfSize, 1, halfSize), turned about Y and
+// lifted to baseHeight
+struct DisplacedIsland {
+	float centreX = 0.0f, centreZ = 0.0f;
+	float rotationY = 0.0f;
+	float baseHeight = 0.0f;
+};
+
+class TerrainDisplacement {
+public:
+	TerrainDisplacement() : simd(hasSimd()) {}
+
+	// Keeps the red channel of RGBA8 texels, rows rowPitch bytes apart, and builds its mip chain
+	void setTexture(int width, int height, const uint8_t* rgba, int rowPitch);
+	void setIslands(const vector<DisplacedIsland>& islands, float halfSize);
+
+	// SampleLevel with MIN_MAG_MIP_LINEAR and wrap addressing, in 0..1
+	float sample(float u, float v, int level = 0) const;
+	void sample(const float* u, const float* v, size_t count, float* values, int level = 0) const;
+
+	// World height of the drawn surface, or false off every island
+	bool heightAt(float x, float z, float& height) const;
+	// Batched; points off every island get offTerrain
+	void heightsAt(const float* x, const float* z, size_t count, float* heights, float offTerrain) const;
+	// Furthest the top face at CubeMesh's resolution, displaced only at its vertices, strays from the displaced surface
+	// between them: the detail tessellation adds, in local height, checked at samples x samples points per quad
+	float flatError(int resolution, int samples = 8) const;
+
+	bool isEmpty() const { return levels.empty(); }
+	int getLevelCount() const { return (int)levels.size(); }
+	int getWidth(int level = 0) const { return levels[level].width; }
+	int getHeight(int level = 0) const { return levels[level].height; }
+
+	void setSimd(bool enabled) { simd = enabled && hasSimd(); }
+	static bool hasSimd();
+
+	static constexpr float DISPLACEMENT_SCALE = 0.2f;	// terrain_ds.hlsl
+	static constexpr float TOP = 1.0f;	// CubeMesh's top face in local space
+
+private:
+	struct Level {
+		int width, height;
+		vector<float> texels;	// Red, 0..1
+	};
+
+	// An island with its inverse transform ready: local x and z in -1..1 across the top face
+	struct Island {
+		float centreX, centreZ;
+		float cosine, sine;
+		float baseHeight;
+	};
+
+	int findIsland(float x, float z, float& u, float& v) const;
+
+	vector<Level> levels;
+	vector<Island> islands;
+	float inverseHalfSize = 1.0f;
+	bool simd;
+};
@@ -0,0 +1,34 @@
+#include "TerrainLod.h"
+#include <algorithm>
+#include <cmath>
+
+void TerrainLod::setObjects(const vector<LodObject>& source) {
+	objects = source;
+	screenErrors.assign(objects.size(), 0.0f);
+	tessellated.assign(objects.size(), 0);
+	tessellatedCount = 0;
+	lastSwitches = 0;
+}
+
+void TerrainLod::setProjection(float viewportHeight, float fieldOfView) {
+	pixelsPerUnit = viewportHeight * 0.5f / tanf(fieldOfView * 0.5f);
+}
+
+void TerrainLod::update(float cameraX, float cameraY, float cameraZ) {
+	const float lower = threshold * (1.0f - hysteresis);
+	tessellatedCount = 0;
+	lastSwitches = 0;
+	for (size_t i = 0; i < objects.size(); i++) {
+		const LodObject& object = objects[i];
+		const float dx = object.centreX - cameraX, dy = object.centreY - cameraY, dz = object.centreZ - cameraZ;
+		const float distance = max(sqrtf(dx * dx + dy * dy + dz * dz) - object.radius, MIN_DISTANCE);
+		const float error = object.error * pixelsPerUnit / distance;
+		screenErrors[i] = error;
+
+		const uint8_t wanted = tessellated[i] ? error >= lower && distance < tessellationRange * (1.0f + hysteresis) :
+			error > threshold && distance < tessellationRange;
+		lastSwitches += wanted != tessellated[i];
+		tessellated[i] = wanted;
+		tessellatedCount += wanted;
+	}
+}
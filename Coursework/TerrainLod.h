@@ -0,0 +1,55 @@
+#pragma once
+// Chooses, per island and bridge, between the tessellated terrain path and the plain mesh displaced in the vertex
+// shader. The plain mesh is what the hull shader's factor of 1 draws, so the detail it misses is what tessellation
+// adds between the mesh's vertices; each object carries that as a world-space height, and its screen-space error is
+// that height projected from the nearest point of the object's bounding sphere. Objects switch to tessellation once
+// the error passes the pixel threshold and back only once it falls a hysteresis band below, so a camera resting near
+// the boundary does not make them flicker. Past the hull shader's own range every patch gets a factor of 1 and both
+// paths draw the same triangles, so nothing is tessellated from further out than that, and the same band applies on
+// the way back out.
+
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+struct LodObject {
+	float centreX = 0.0f, centreY = 0.0f, centreZ = 0.0f;
+	float radius = 0.0f;
+	float error = 0.0f;	// World height the plain mesh can be off from the fully tessellated surface
+};
+
+class TerrainLod {
+public:
+	// Objects start on the plain mesh; the next update picks each one's path from scratch
+	void setObjects(const vector<LodObject>& objects);
+	// Pixels per world unit at a distance of one, from the viewport height and vertical field of view
+	void setProjection(float viewportHeight, float fieldOfView);
+	void setThreshold(float pixels) { threshold = pixels; }
+	void setHysteresis(float fraction) { hysteresis = fraction; }
+	void setTessellationRange(float distance) { tessellationRange = distance; }
+
+	void update(float cameraX, float cameraY, float cameraZ);
+
+	bool isTessellated(int object) const { return tessellated[object] != 0; }
+	float getScreenError(int object) const { return screenErrors[object]; }
+	int size() const { return (int)objects.size(); }
+	int getTessellatedCount() const { return tessellatedCount; }
+	int getLastSwitches() const { return lastSwitches; }	// Objects that changed path in the last update
+
+	static constexpr float DEFAULT_THRESHOLD = 1.0f;
+	static constexpr float DEFAULT_HYSTERESIS = 0.25f;	// Back to the plain mesh below this share under the threshold
+	static constexpr float HULL_RANGE = 15.0f;	// terrain_hs.hlsl: factor 1 from here out
+	static constexpr float MIN_DISTANCE = 0.01f;	// Inside the bounds; keeps the projection finite
+
+private:
+	vector<LodObject> objects;
+	vector<float> screenErrors;
+	vector<uint8_t> tessellated;
+	float pixelsPerUnit = 1.0f;
+	float threshold = DEFAULT_THRESHOLD;
+	float hysteresis = DEFAULT_HYSTERESIS;
+	float tessellationRange = HULL_RANGE;
+	int tessellatedCount = 0;
+	int lastSwitches = 0;
+};
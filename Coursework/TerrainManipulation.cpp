@@ -18,7 +18,7 @@ static float distPointLineSegment2D(
 }
 
 
-TerrainManipulation::TerrainManipulation(ID3D11Device* device, HWND hwnd) : BaseShader(device, hwnd)
+TerrainManipulation::TerrainManipulation(ID3D11Device* device, HWND hwnd, SceneConstants* sceneConstants) : BaseShader(device, hwnd), sceneConstants(sceneConstants)
 {
 	initShader(L"terrain_vs.cso", L"terrain_hs.cso", L"terrain_ds.cso", L"terrain_ps.cso");
 }
@@ -32,6 +32,12 @@ TerrainManipulation::~TerrainManipulation()
 		matrixBuffer = 0;
 	}
 
+	if (staticVertexShader)
+	{
+		staticVertexShader->Release();
+		staticVertexShader = 0;
+	}
+
 	// Release the layout.
 	if (layout)
 	{
@@ -63,13 +69,6 @@ TerrainManipulation::~TerrainManipulation()
 		shadowSample2 = 0;
 	}
 
-	// Release the light constant buffer.
-	if (lightBuffer)
-	{
-		lightBuffer->Release();
-		lightBuffer = 0;
-	}
-
 	// Release the camera constant buffer.
 	if (cameraBuffer)
 	{
@@ -100,6 +99,13 @@ void TerrainManipulation::initShader(const wchar_t* vsFilename, const wchar_t* h
 	D3D11_SAMPLER_DESC samplerDesc;
 	D3D11_SAMPLER_DESC spotShadowDesc;
 
+	// The static vertex shader goes through the base loader first; its layout matches terrain_vs, which replaces it
+	loadVertexShader(L"terrainStatic_vs.cso");
+	staticVertexShader = vertexShader;
+	vertexShader = 0;
+	layout->Release();
+	layout = 0;
+
 	// InitShader must be overwritten and it will load both vertex and pixel shaders + setup buffers
 	initShader(vsFilename, psFilename);
 
@@ -116,17 +122,6 @@ void TerrainManipulation::initShader(const wchar_t* vsFilename, const wchar_t* h
 	bufferDesc.StructureByteStride = 0;
 	renderer->CreateBuffer(&bufferDesc, NULL, &matrixBuffer);
 
-	// Setup light buffer
-	// Setup the description of the light dynamic constant buffer that is in the pixel shader.
-	// Note that ByteWidth always needs to be a multiple of 16 if using D3D11_BIND_CONSTANT_BUFFER or CreateBuffer will fail.
-	bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-	bufferDesc.ByteWidth = sizeof(LightBufferType);
-	bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-	bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-	bufferDesc.MiscFlags = 0;
-	bufferDesc.StructureByteStride = 0;
-	renderer->CreateBuffer(&bufferDesc, NULL, &lightBuffer);
-
 	// Setup the description of the camera dynamic constant buffer that is in the vertex shader.
 	bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
 	bufferDesc.ByteWidth = sizeof(CameraBufferType);
@@ -285,38 +280,10 @@ void TerrainManipulation::setShaderParameters(ID3D11DeviceContext* deviceContext
 	deviceContext->Unmap(cameraBuffer, 0);
 	deviceContext->HSSetConstantBuffers(0, 1, &cameraBuffer);
 	deviceContext->DSSetConstantBuffers(1, 1, &cameraBuffer);
+	deviceContext->VSSetConstantBuffers(1, 1, &cameraBuffer);
 
-	//Additional
-	// Send light data to pixel shader
-	LightBufferType* lightPtr;
-	deviceContext->Map(lightBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
-	lightPtr = (LightBufferType*)mappedResource.pData;
-
-	lightPtr->ambientColour = XMFLOAT4(sceneData->lightData.ambientColour);
-	lightPtr->diffuseColour = XMFLOAT4(sceneData->lightData.diffuseColour);
-
-	lightPtr->pointLight1Position = XMFLOAT3(sceneData->lightData.pointLight_pos1);
-	lightPtr->pointLight1Radius = sceneData->lightData.pointLightRadius[0];
-	lightPtr->pointLight1Colour = XMFLOAT4(sceneData->lightData.pointLight1Colour);
-
-	lightPtr->pointLight2Position = XMFLOAT3(sceneData->lightData.pointLight_pos2);
-	lightPtr->pointLight2Radius = sceneData->lightData.pointLightRadius[1];
-	lightPtr->pointLight2Colour = XMFLOAT4(sceneData->lightData.pointLight2Colour);
-
-	lightPtr->spotlightColour = XMFLOAT4(sceneData->shadowLightsData.spotColour);
-	lightPtr->spotlightCutoff = sceneData->shadowLightsData.spotCutoff;
-	lightPtr->spotlightDirection = XMFLOAT3(sceneData->shadowLightsData.lightDirections[0]);
-	lightPtr->spotlightFalloff = sceneData->shadowLightsData.spotFalloff;
-
-	lightPtr->moonPos = XMFLOAT3(sceneData->moonData.moon_pos);
-	lightPtr->specularColour = XMFLOAT4(sceneData->lightData.specularColour);
-	lightPtr->specularPower = sceneData->lightData.spec_pow;
-
-	lightPtr->directionalLightDirection = XMFLOAT3(sceneData->shadowLightsData.lightDirections[1]);
-	lightPtr->directionalColour = XMFLOAT4(sceneData->shadowLightsData.dirColour);
-
-	deviceContext->Unmap(lightBuffer, 0);
-	deviceContext->PSSetConstantBuffers(0, 1, &lightBuffer);
+	// Lights, packed once a frame by SceneConstants
+	sceneConstants->bindLights(deviceContext);
 
 	SonarBufferType* sonarPtr;
 	deviceContext->Map(sonarBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
@@ -344,4 +311,20 @@ void TerrainManipulation::setShaderParameters(ID3D11DeviceContext* deviceContext
 
 	deviceContext->DSSetShaderResources(0, 1, &terrain);
 	deviceContext->DSSetSamplers(0, 1, &terrainSampleState);
+
+	// Static vertex shader, which displaces in place of the domain shader
+	deviceContext->VSSetShaderResources(0, 1, &terrain);
+	deviceContext->VSSetSamplers(0, 1, &terrainSampleState);
+}
+
+void TerrainManipulation::renderStatic(ID3D11DeviceContext* deviceContext, int indexCount)
+{
+	deviceContext->IASetInputLayout(layout);
+	deviceContext->VSSetShader(staticVertexShader, NULL, 0);
+	deviceContext->HSSetShader(NULL, NULL, 0);
+	deviceContext->DSSetShader(NULL, NULL, 0);
+	deviceContext->GSSetShader(NULL, NULL, 0);
+	deviceContext->CSSetShader(NULL, NULL, 0);
+	deviceContext->PSSetShader(pixelShader, NULL, 0);
+	deviceContext->DrawIndexed(indexCount, 0, 0);
 }
\ No newline at end of file
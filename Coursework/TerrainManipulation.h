@@ -14,6 +14,7 @@ A simple sinusoidal terrain (no external libs) and hooked up smooth collision-sl
 
 #include "DXF.h"
 #include "Islands.h"	
+#include "SceneConstants.h"
 #include <memory>
 #include <vector>
 #include <utility>
@@ -41,37 +42,6 @@ private:
 		float padding;
 	};
 
-	struct LightBufferType
-	{
-		XMFLOAT4 ambientColour;
-		XMFLOAT4 diffuseColour;
-
-		XMFLOAT3 pointLight1Position;
-		float pointLight1Radius;
-
-		XMFLOAT4 pointLight1Colour;
-
-		XMFLOAT3 pointLight2Position;
-		float pointLight2Radius;
-
-		XMFLOAT4 pointLight2Colour;
-
-		XMFLOAT4 spotlightColour;
-
-		float spotlightCutoff;
-		XMFLOAT3 spotlightDirection;
-
-		float spotlightFalloff;
-		XMFLOAT3 moonPos;
-
-		XMFLOAT4 specularColour;
-
-		float specularPower;
-		XMFLOAT3 directionalLightDirection;
-
-		XMFLOAT4 directionalColour;
-	};
-
 	struct SonarBufferType {
 		XMFLOAT3 sonarOrigin;
 		float sonarRadius;
@@ -82,9 +52,12 @@ private:
 	};
 
 	ID3D11Buffer* matrixBuffer;
-	ID3D11Buffer* lightBuffer;
 	ID3D11Buffer* cameraBuffer;
 	ID3D11Buffer* sonarBuffer;
+	SceneConstants* sceneConstants;	// The lights, shared with the other lit shaders
+
+	// terrainStatic_vs: the plain mesh displaced per vertex, for islands and bridges too far off to need tessellation
+	ID3D11VertexShader* staticVertexShader = nullptr;
 
 	ID3D11SamplerState* terrainSampleState;
 	ID3D11SamplerState* textureSamplerState;
@@ -94,7 +67,7 @@ private:
 
 	// Island and bridge data
 	unique_ptr<Islands> islandBounds;
-	const vector<Island>* m_islands = nullptr;
+	const IslandList* m_islands = nullptr;
 	float m_regionSize = 0.0f;
 	float m_bridgeWidth = 5.0f;
 	vector<pair<XMFLOAT3, XMFLOAT3>> m_bridges;
@@ -111,7 +84,7 @@ private:
 
 public:
 
-	TerrainManipulation(ID3D11Device* device, HWND hwnd);
+	TerrainManipulation(ID3D11Device* device, HWND hwnd, SceneConstants* sceneConstants);
 	~TerrainManipulation();
 
 	// Terrain query functions
@@ -126,13 +99,13 @@ public:
 	}
 
 	// Setters
-	void setIslands(const vector<Island>& islands, float regionSize) {
+	void setIslands(const IslandList& islands, float regionSize) {
 		m_islands = &islands;
 		m_regionSize = regionSize;
 	}
 
-	void setBridges(const vector<Bridge>& bridges,
-		const vector<Island>& islands) {
+	void setBridges(const BridgeList& bridges,
+		const IslandList& islands) {
 		m_bridges.clear();
 		m_bridges.reserve(bridges.size());
 
@@ -144,5 +117,8 @@ public:
 		}
 	}
 
+	// Draws a triangle list through terrainStatic_vs and the terrain pixel shader, without the hull and domain stages
+	void renderStatic(ID3D11DeviceContext* deviceContext, int indexCount);
+
 	void setShaderParameters(ID3D11DeviceContext* deviceContext, const XMMATRIX& world, const XMMATRIX& view, const XMMATRIX& projection, float sonarRadius, ID3D11ShaderResourceView* terrain, ID3D11ShaderResourceView* depth1, ID3D11ShaderResourceView* depth2, Camera* camera, Light* light, Light* directionalLight, SceneData* sceneData);
 };
\ No newline at end of file
@@ -0,0 +1,16 @@
+#pragma once
+// The position type the modules that build without D3D share (audio, ghosts, collision, height queries, snapshots).
+// Wherever DirectXMath is available it is XMFLOAT3, so the game's positions pass straight through; elsewhere it is a
+// plain struct of the same layout. XMFLOAT3 is left uninitialised by its default constructor, so neither may be relied
+// on to start at zero.
+
+#if defined(_WIN32) || __has_include(<DirectXMath.h>)
+#include <DirectXMath.h>
+typedef DirectX::XMFLOAT3 Vector3;
+#else
+struct Vector3 {
+	float x, y, z;
+	Vector3() : x(0.f), y(0.f), z(0.f) {}
+	Vector3(float x_, float y_, float z_) : x(x_), y(y_), z(z_) {}
+};
+#endif
@@ -1,6 +1,11 @@
 #include "WaterShader.h"
 
-WaterShader::WaterShader(ID3D11Device* device, HWND hwnd) : BaseShader(device, hwnd)
+// Displacement and normals, four floats a texel each
+static size_t oceanBytes(int size) {
+	return (size_t)size * size * 4 * sizeof(float) * 2;
+}
+
+WaterShader::WaterShader(ID3D11Device* device, HWND hwnd, SceneConstants* sceneConstants) : BaseShader(device, hwnd), sceneConstants(sceneConstants)
 {
 	initShader(L"water_vs.cso", L"water_ps.cso");
 }
@@ -32,17 +37,33 @@ WaterShader::~WaterShader()
 		sampleStateShadow = 0;
 	}
 
+	if (oceanSize) MemoryTracker::freeGpu(MemoryTag::Rendering, GpuMemory::Texture, oceanBytes(oceanSize));
+	for (int i = 0; i < 2; i++)
+	{
+		if (oceanViews[i])
+		{
+			oceanViews[i]->Release();
+			oceanViews[i] = 0;
+		}
+		if (oceanTextures[i])
+		{
+			oceanTextures[i]->Release();
+			oceanTextures[i] = 0;
+		}
+	}
+
+	if (oceanSampleState)
+	{
+		oceanSampleState->Release();
+		oceanSampleState = 0;
+	}
+
 	if (timeBuffer)
 	{
 		timeBuffer->Release();
 		timeBuffer = 0;
 	}
 
-	if (lightBuffer)
-	{
-		lightBuffer->Release();
-		lightBuffer = 0;
-	}
 	// Release the camera constant buffer.
 	if (cameraBuffer)
 	{
@@ -90,14 +111,6 @@ void WaterShader::initShader(const wchar_t* vsFilename, const wchar_t* psFilenam
 	bufferDesc.StructureByteStride = 0;
 	renderer->CreateBuffer(&bufferDesc, NULL, &timeBuffer);
 
-	bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-	bufferDesc.ByteWidth = sizeof(LightBufferType);
-	bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-	bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-	bufferDesc.MiscFlags = 0;
-	bufferDesc.StructureByteStride = 0;
-	renderer->CreateBuffer(&bufferDesc, NULL, &lightBuffer);
-
 	// Create a texture sampler state description.
 	waterSamplerDesc.Filter = D3D11_FILTER_ANISOTROPIC;
 	waterSamplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_WRAP;
@@ -110,6 +123,10 @@ void WaterShader::initShader(const wchar_t* vsFilename, const wchar_t* psFilenam
 	waterSamplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
 	renderer->CreateSamplerState(&waterSamplerDesc, &waterSampleState);
 
+	// Ocean textures are read in the vertex shader at one level, and repeat across the water
+	waterSamplerDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+	renderer->CreateSamplerState(&waterSamplerDesc, &oceanSampleState);
+
 	// Sampler for shadow map sampling.
 	shadowSamplerDesc.Filter = D3D11_FILTER_COMPARISON_MIN_MAG_LINEAR_MIP_POINT; // for softer edges
 	shadowSamplerDesc.ComparisonFunc = D3D11_COMPARISON_LESS_EQUAL; // handle shadow depth comparisons
@@ -168,39 +185,18 @@ void WaterShader::setShaderParameters(ID3D11DeviceContext* deviceContext, const
 	timePtr->amplitude = sceneData->waterData.amplitude;
 	timePtr->frequency = sceneData->waterData.frequency;
 	timePtr->speed = sceneData->waterData.speed;
+	timePtr->oceanPatchLength = sceneData->waterData.oceanPatchLength;
+	timePtr->oceanEnabled = sceneData->waterData.fftOcean && oceanViews[0] ? 1.0f : 0.0f;
+	timePtr->padding = XMFLOAT2(0.0f, 0.0f);
 	deviceContext->Unmap(timeBuffer, 0);
 	deviceContext->VSSetConstantBuffers(2, 1, &timeBuffer);
 
-	// Send light data to pixel shader
-	LightBufferType* lightPtr;
-	deviceContext->Map(lightBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
-	lightPtr = (LightBufferType*)mappedResource.pData;
+	// Vertex shader - FFT ocean
+	deviceContext->VSSetShaderResources(0, 2, oceanViews);
+	deviceContext->VSSetSamplers(0, 1, &oceanSampleState);
 
-	lightPtr->ambientColour = XMFLOAT4(sceneData->lightData.ambientColour);
-	lightPtr->diffuseColour = XMFLOAT4(sceneData->lightData.diffuseColour);
-
-	lightPtr->pointLight1Position = XMFLOAT3(sceneData->lightData.pointLight_pos1);
-	lightPtr->pointLight1Radius = sceneData->lightData.pointLightRadius[0];
-	lightPtr->pointLight1Colour = XMFLOAT4(sceneData->lightData.pointLight1Colour);
-
-	lightPtr->pointLight2Position = XMFLOAT3(sceneData->lightData.pointLight_pos2);
-	lightPtr->pointLight2Radius = sceneData->lightData.pointLightRadius[1];
-	lightPtr->pointLight2Colour = XMFLOAT4(sceneData->lightData.pointLight2Colour);
-
-	lightPtr->spotlightColour = XMFLOAT4(sceneData->shadowLightsData.spotColour);
-	lightPtr->spotlightCutoff = sceneData->shadowLightsData.spotCutoff;
-	lightPtr->spotlightDirection = XMFLOAT3(sceneData->shadowLightsData.lightDirections[0]);
-	lightPtr->spotlightFalloff = sceneData->shadowLightsData.spotFalloff;
-
-	lightPtr->moonPos = XMFLOAT3(sceneData->moonData.moon_pos);
-	lightPtr->specularColour = XMFLOAT4(sceneData->lightData.specularColour);
-	lightPtr->specularPower = sceneData->lightData.spec_pow;
-
-	lightPtr->directionalLightDirection = XMFLOAT3(sceneData->shadowLightsData.lightDirections[1]);
-	lightPtr->directionalColour = XMFLOAT4(sceneData->shadowLightsData.dirColour);
-
-	deviceContext->Unmap(lightBuffer, 0);
-	deviceContext->PSSetConstantBuffers(0, 1, &lightBuffer);
+	// Lights, packed once a frame by SceneConstants
+	sceneConstants->bindLights(deviceContext);
 
 
 	// Pixel Shader
@@ -212,4 +208,54 @@ void WaterShader::setShaderParameters(ID3D11DeviceContext* deviceContext, const
 
 	deviceContext->PSSetShaderResources(2, 1, &depthMap2);
 	deviceContext->PSSetSamplers(2, 1, &sampleStateShadow2);
-}
\ No newline at end of file
+}
+
+void WaterShader::updateOcean(ID3D11DeviceContext* deviceContext, const OceanFFT& ocean)
+{
+	const int size = ocean.getSize();
+	if (size == 0) return;
+
+	if (size != oceanSize)
+	{
+		if (oceanSize) MemoryTracker::freeGpu(MemoryTag::Rendering, GpuMemory::Texture, oceanBytes(oceanSize));
+		for (int i = 0; i < 2; i++)
+		{
+			if (oceanViews[i]) oceanViews[i]->Release();
+			if (oceanTextures[i]) oceanTextures[i]->Release();
+			oceanViews[i] = 0;
+			oceanTextures[i] = 0;
+		}
+
+		// Rewritten every frame from the CPU, so dynamic, with no mips
+		D3D11_TEXTURE2D_DESC textureDesc = {};
+		textureDesc.Width = size;
+		textureDesc.Height = size;
+		textureDesc.MipLevels = 1;
+		textureDesc.ArraySize = 1;
+		textureDesc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
+		textureDesc.SampleDesc.Count = 1;
+		textureDesc.Usage = D3D11_USAGE_DYNAMIC;
+		textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+		textureDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+		for (int i = 0; i < 2; i++)
+		{
+			renderer->CreateTexture2D(&textureDesc, NULL, &oceanTextures[i]);
+			renderer->CreateShaderResourceView(oceanTextures[i], NULL, &oceanViews[i]);
+		}
+		oceanSize = size;
+		MemoryTracker::allocateGpu(MemoryTag::Rendering, GpuMemory::Texture, oceanBytes(oceanSize));
+	}
+
+	const float* sources[2] = { ocean.getDisplacement(), ocean.getNormals() };
+	const size_t rowBytes = (size_t)size * 4 * sizeof(float);
+	for (int i = 0; i < 2; i++)
+	{
+		D3D11_MAPPED_SUBRESOURCE mappedResource;
+		if (FAILED(deviceContext->Map(oceanTextures[i], 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource))) continue;
+		for (int row = 0; row < size; row++)
+		{
+			memcpy((char*)mappedResource.pData + (size_t)row * mappedResource.RowPitch, sources[i] + (size_t)row * size * 4, rowBytes);
+		}
+		deviceContext->Unmap(oceanTextures[i], 0);
+	}
+}
@@ -1,5 +1,7 @@
 #pragma once
 #include "DXF.h"
+#include "OceanFFT.h"
+#include "SceneConstants.h"
 
 using namespace std;
 using namespace DirectX;
@@ -30,40 +32,18 @@ private:
 		float amplitude;
 		float frequency;
 		float speed;
-	};
-
-	struct LightBufferType
-	{
-		XMFLOAT4 ambientColour;
-		XMFLOAT4 diffuseColour;
-
-		XMFLOAT3 pointLight1Position;
-		float pointLight1Radius;
-		XMFLOAT4 pointLight1Colour;
-
-		XMFLOAT3 pointLight2Position;
-		float pointLight2Radius;
-		XMFLOAT4 pointLight2Colour;
-
-		XMFLOAT4 spotlightColour;
-
-		float spotlightCutoff;
-		XMFLOAT3 spotlightDirection;
-
-		float spotlightFalloff;
-		XMFLOAT3 moonPos;
-
-		XMFLOAT4 specularColour;
-		float specularPower;
-		XMFLOAT3 directionalLightDirection;
-
-		XMFLOAT4 directionalColour;
+		float oceanPatchLength;
+		float oceanEnabled;	// 1 to take the FFT ocean's textures in place of the sine waves
+		XMFLOAT2 padding;
 	};
 
 public:
-	WaterShader(ID3D11Device* device, HWND hwnd);
+	WaterShader(ID3D11Device* device, HWND hwnd, SceneConstants* sceneConstants);
 	~WaterShader();
 
+	// Copies the ocean's latest displacement and normals into the textures water_vs samples, resizing them to match
+	void updateOcean(ID3D11DeviceContext* deviceContext, const OceanFFT& ocean);
+
 	void setShaderParameters(ID3D11DeviceContext* deviceContext, const XMMATRIX& worldMatrix, const XMMATRIX& viewMatrix, const XMMATRIX& projectionMatrix, ID3D11ShaderResourceView* water, ID3D11ShaderResourceView* depthMap, ID3D11ShaderResourceView* depthMap2, Camera* camera, Light* light, Light* directionalLight, SceneData* sceneData);
 
 private:
@@ -73,9 +53,15 @@ private:
 	ID3D11Buffer* matrixBuffer;
 	ID3D11Buffer* cameraBuffer;
 	ID3D11Buffer* timeBuffer;
-	ID3D11Buffer* lightBuffer;
+	SceneConstants* sceneConstants;	// The lights, shared with the other lit shaders
 
 	ID3D11SamplerState* waterSampleState;
 	ID3D11SamplerState* sampleStateShadow;
 	ID3D11SamplerState* sampleStateShadow2;
+
+	// FFT ocean: displacement, then normals, both tiling
+	ID3D11Texture2D* oceanTextures[2] = {};
+	ID3D11ShaderResourceView* oceanViews[2] = {};
+	ID3D11SamplerState* oceanSampleState = nullptr;
+	int oceanSize = 0;
 };
\ No newline at end of file
@@ -0,0 +1,241 @@
+#include "WaterSurface.h"
+#include "OceanFFT.h"
+#include "SimdMath.h"
+#include <cmath>
+#include <cstdint>
+
+namespace {
+
+	constexpr int BATCH = 4;
+
+#ifdef SIMD_MATH_SSE
+	// WaterSurface::sample at four points, one to a lane: each corner's four texels are transposed so every channel
+	// blends in one register
+	void sampleFour(const float* texels, int size, float texelsPerUnit, __m128 x, __m128 z, __m128 channels[4]) {
+		const __m128 scale = _mm_set1_ps(texelsPerUnit), half = _mm_set1_ps(0.5f), one = _mm_set1_ps(1.0f);
+		const __m128 u = _mm_sub_ps(_mm_mul_ps(x, scale), half), v = _mm_sub_ps(_mm_mul_ps(z, scale), half);
+		__m128 column = _mm_cvtepi32_ps(_mm_cvttps_epi32(u)), row = _mm_cvtepi32_ps(_mm_cvttps_epi32(v));
+		column = _mm_sub_ps(column, _mm_and_ps(_mm_cmpgt_ps(column, u), one));
+		row = _mm_sub_ps(row, _mm_and_ps(_mm_cmpgt_ps(row, v), one));
+		const __m128 blendU = _mm_sub_ps(u, column), blendV = _mm_sub_ps(v, row);
+
+		alignas(16) int32_t columns[BATCH], rows[BATCH];
+		const __m128i mask = _mm_set1_epi32(size - 1);
+		_mm_store_si128((__m128i*)columns, _mm_and_si128(_mm_cvttps_epi32(column), mask));
+		_mm_store_si128((__m128i*)rows, _mm_and_si128(_mm_cvttps_epi32(row), mask));
+
+		__m128 corners[4][4];	// [corner][channel]
+		for (int corner = 0; corner < 4; corner++) {
+			__m128 lanes[BATCH];
+			for (int lane = 0; lane < BATCH; lane++) {
+				const int c = (columns[lane] + (corner & 1)) & (size - 1), r = (rows[lane] + (corner >> 1)) & (size - 1);
+				lanes[lane] = _mm_loadu_ps(&texels[((size_t)r * size + c) * 4]);
+			}
+			_MM_TRANSPOSE4_PS(lanes[0], lanes[1], lanes[2], lanes[3]);
+			for (int k = 0; k < 4; k++) corners[corner][k] = lanes[k];
+		}
+		for (int k = 0; k < 4; k++) {
+			const __m128 top = _mm_add_ps(corners[0][k], _mm_mul_ps(_mm_sub_ps(corners[1][k], corners[0][k]), blendU));
+			const __m128 bottom = _mm_add_ps(corners[2][k], _mm_mul_ps(_mm_sub_ps(corners[3][k], corners[2][k]), blendU));
+			channels[k] = _mm_add_ps(top, _mm_mul_ps(_mm_sub_ps(bottom, top), blendV));
+		}
+	}
+#endif
+}
+
+bool WaterSurface::hasSimd() {
+#ifdef SIMD_MATH_SSE
+	return true;
+#else
+	return false;
+#endif
+}
+
+void WaterSurface::setPlane(float planeScaleX, float planeScaleZ, float x, float planeLevel, float z) {
+	scaleX = planeScaleX;
+	scaleZ = planeScaleZ;
+	offsetX = x;
+	offsetZ = z;
+	level = planeLevel;
+}
+
+void WaterSurface::setWaves(float waveTime, float waveAmplitude, float waveFrequency, float waveSpeed) {
+	time = waveTime;
+	amplitude = waveAmplitude;
+	frequency = waveFrequency;
+	speed = waveSpeed;
+}
+
+void WaterSurface::setOcean(const OceanFFT* ocean, float patchLength) {
+	if (!ocean || ocean->getSize() == 0) {
+		oceanSize = 0;
+		return;
+	}
+	oceanSize = ocean->getSize();
+	texelsPerUnit = oceanSize / patchLength;
+	const size_t floats = (size_t)oceanSize * oceanSize * 4;
+	oceanDisplacement.assign(ocean->getDisplacement(), ocean->getDisplacement() + floats);
+	oceanNormals.assign(ocean->getNormals(), ocean->getNormals() + floats);
+}
+
+float WaterSurface::getHeight(float x, float z) const {
+	float height;
+	if (hasOcean()) oceanPoint(x, z, height, nullptr);
+	else wavePoint(x, z, height, nullptr);
+	return height;
+}
+
+void WaterSurface::getNormal(float x, float z, float normal[3]) const {
+	float height;
+	if (hasOcean()) oceanPoint(x, z, height, normal);
+	else wavePoint(x, z, height, normal);
+}
+
+void WaterSurface::getHeights(const float* x, const float* z, float* heights, int count, float* normalX, float* normalY, float* normalZ) const {
+	const bool normals = normalX && normalY && normalZ;
+	int i = 0;
+	if (hasOcean()) {
+#ifdef SIMD_MATH_SSE
+		// Oceans four points at a time, stepping back until every lane has settled
+		if (simd) {
+			const __m128 base = _mm_set1_ps(level), settledDistance = _mm_set1_ps(UNDISPLACE_SETTLED);
+			const __m128 absolute = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+			for (; i + BATCH <= count; i += BATCH) {
+				const __m128 pointX = _mm_loadu_ps(x + i), pointZ = _mm_loadu_ps(z + i);
+				__m128 vertexX = pointX, vertexZ = pointZ, texel[4];
+				sampleFour(oceanDisplacement.data(), oceanSize, texelsPerUnit, vertexX, vertexZ, texel);
+				for (int step = 0; step < UNDISPLACE_STEPS; step++) {
+					const __m128 nextX = _mm_sub_ps(pointX, texel[0]), nextZ = _mm_sub_ps(pointZ, texel[2]);
+					const __m128 moved = _mm_add_ps(_mm_and_ps(_mm_sub_ps(nextX, vertexX), absolute), _mm_and_ps(_mm_sub_ps(nextZ, vertexZ), absolute));
+					vertexX = nextX;
+					vertexZ = nextZ;
+					sampleFour(oceanDisplacement.data(), oceanSize, texelsPerUnit, vertexX, vertexZ, texel);
+					if (_mm_movemask_ps(_mm_cmplt_ps(moved, settledDistance)) == 0xf) break;
+				}
+				_mm_storeu_ps(heights + i, _mm_add_ps(base, texel[1]));
+				if (!normals) continue;
+
+				sampleFour(oceanNormals.data(), oceanSize, texelsPerUnit, vertexX, vertexZ, texel);
+				const __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(texel[0], texel[0]), _mm_mul_ps(texel[1], texel[1])), _mm_mul_ps(texel[2], texel[2])));
+				_mm_storeu_ps(normalX + i, _mm_div_ps(texel[0], length));
+				_mm_storeu_ps(normalY + i, _mm_div_ps(texel[1], length));
+				_mm_storeu_ps(normalZ + i, _mm_div_ps(texel[2], length));
+			}
+		}
+#endif
+		for (; i < count; i++) {
+			float normal[3];
+			oceanPoint(x[i], z[i], heights[i], normals ? normal : nullptr);
+			if (normals) {
+				normalX[i] = normal[0];
+				normalY[i] = normal[1];
+				normalZ[i] = normal[2];
+			}
+		}
+		return;
+	}
+
+#ifdef SIMD_MATH_SSE
+	if (simd) {
+		const __m128 originX = _mm_set1_ps(offsetX), originZ = _mm_set1_ps(offsetZ);
+		const __m128 planeX = _mm_set1_ps(scaleX), planeZ = _mm_set1_ps(scaleZ);
+		const __m128 f = _mm_set1_ps(frequency), a = _mm_set1_ps(amplitude), distance = _mm_set1_ps(speed * time);
+		const __m128 base = _mm_set1_ps(level), one = _mm_set1_ps(1.0f);
+		const __m128 slopeX = _mm_set1_ps(amplitude * frequency / scaleX), slopeZ = _mm_set1_ps(amplitude * frequency / scaleZ);
+		for (; i + BATCH <= count; i += BATCH) {
+			const __m128 localX = _mm_div_ps(_mm_sub_ps(_mm_loadu_ps(x + i), originX), planeX);
+			const __m128 localZ = _mm_div_ps(_mm_sub_ps(_mm_loadu_ps(z + i), originZ), planeZ);
+			__m128 sineX, cosineX, sineZ, cosineZ;
+			sinCos(_mm_add_ps(_mm_mul_ps(f, localX), distance), sineX, cosineX);
+			sinCos(_mm_add_ps(_mm_mul_ps(f, localZ), distance), sineZ, cosineZ);
+			_mm_storeu_ps(heights + i, _mm_add_ps(base, _mm_add_ps(_mm_mul_ps(a, sineX), _mm_mul_ps(a, cosineZ))));
+			if (!normals) continue;
+
+			// (-d/dx, 1, -d/dz) of the world-space height
+			const __m128 nx = _mm_sub_ps(_mm_setzero_ps(), _mm_mul_ps(slopeX, cosineX)), nz = _mm_mul_ps(slopeZ, sineZ);
+			const __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, nx), one), _mm_mul_ps(nz, nz)));
+			_mm_storeu_ps(normalX + i, _mm_div_ps(nx, length));
+			_mm_storeu_ps(normalY + i, _mm_div_ps(one, length));
+			_mm_storeu_ps(normalZ + i, _mm_div_ps(nz, length));
+		}
+	}
+#endif
+	for (; i < count; i++) {
+		float normal[3];
+		wavePoint(x[i], z[i], heights[i], normals ? normal : nullptr);
+		if (normals) {
+			normalX[i] = normal[0];
+			normalY[i] = normal[1];
+			normalZ[i] = normal[2];
+		}
+	}
+}
+
+// water_vs's sine branch, with its normal taken through the plane's scale so it is the surface's own
+void WaterSurface::wavePoint(float x, float z, float& height, float* normal) const {
+	const float localX = (x - offsetX) / scaleX, localZ = (z - offsetZ) / scaleZ;
+	const float distance = speed * time;
+	const float phaseX = frequency * localX + distance, phaseZ = frequency * localZ + distance;
+	height = level + (amplitude * sinf(phaseX) + amplitude * cosf(phaseZ));
+	if (!normal) return;
+
+	const float nx = -amplitude * frequency * cosf(phaseX) / scaleX, nz = amplitude * frequency * sinf(phaseZ) / scaleZ;
+	const float length = sqrtf(nx * nx + 1.0f + nz * nz);
+	normal[0] = nx / length;
+	normal[1] = 1.0f / length;
+	normal[2] = nz / length;
+}
+
+// water_vs's ocean branch moves the vertex at p to p + D(p); the vertex over (x, z) is where p = (x, z) - D(p)
+// settles, which it does in a few steps wherever the surface has not folded over
+void WaterSurface::oceanPoint(float x, float z, float& height, float* normal) const {
+	float texel[4];
+	float vertexX = x, vertexZ = z;
+	sample(oceanDisplacement, vertexX, vertexZ, texel);
+	for (int step = 0; step < UNDISPLACE_STEPS; step++) {
+		const float nextX = x - texel[0], nextZ = z - texel[2];
+		const bool settled = fabsf(nextX - vertexX) + fabsf(nextZ - vertexZ) < UNDISPLACE_SETTLED;
+		vertexX = nextX;
+		vertexZ = nextZ;
+		sample(oceanDisplacement, vertexX, vertexZ, texel);
+		if (settled) break;
+	}
+	height = level + texel[1];
+	if (!normal) return;
+
+	sample(oceanNormals, vertexX, vertexZ, texel);
+	const float length = sqrtf(texel[0] * texel[0] + texel[1] * texel[1] + texel[2] * texel[2]);
+	normal[0] = texel[0] / length;
+	normal[1] = texel[1] / length;
+	normal[2] = texel[2] / length;
+}
+
+// SampleLevel with a linear, wrapping sampler at uv = (x, z) / patchLength
+void WaterSurface::sample(const vector<float>& texels, float x, float z, float texel[4]) const {
+	const float u = x * texelsPerUnit - 0.5f, v = z * texelsPerUnit - 0.5f;
+	const float column = floorf(u), row = floorf(v);
+	const float blendU = u - column, blendV = v - row;
+	const int mask = oceanSize - 1;
+	const int column0 = (int)column & mask, column1 = (column0 + 1) & mask;
+	const int row0 = (int)row & mask, row1 = (row0 + 1) & mask;
+	const float* texel00 = &texels[((size_t)row0 * oceanSize + column0) * 4];
+	const float* texel01 = &texels[((size_t)row0 * oceanSize + column1) * 4];
+	const float* texel10 = &texels[((size_t)row1 * oceanSize + column0) * 4];
+	const float* texel11 = &texels[((size_t)row1 * oceanSize + column1) * 4];
+#ifdef SIMD_MATH_SSE
+	if (simd) {
+		const __m128 s = _mm_set1_ps(blendU), t = _mm_set1_ps(blendV);
+		const __m128 a = _mm_loadu_ps(texel00), b = _mm_loadu_ps(texel01);
+		const __m128 c = _mm_loadu_ps(texel10), d = _mm_loadu_ps(texel11);
+		const __m128 top = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), s));
+		const __m128 bottom = _mm_add_ps(c, _mm_mul_ps(_mm_sub_ps(d, c), s));
+		_mm_storeu_ps(texel, _mm_add_ps(top, _mm_mul_ps(_mm_sub_ps(bottom, top), t)));
+		return;
+	}
+#endif
+	for (int k = 0; k < 4; k++) {
+		const float top = texel00[k] + (texel01[k] - texel00[k]) * blendU;
+		const float bottom = texel10[k] + (texel11[k] - texel10[k]) * blendU;
+		texel[k] = top + (bottom - top) * blendV;
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+// The water surface water_vs.hlsl draws, on the CPU, so things can float on it and fall into it. The sine waves are
+// the shader's own formula in the plane's local units; the FFT ocean is sampled the way the shader samples its
+// textures (bilinear, wrapping, texel centres half a texel in), from a copy taken once a frame so an update running
+// on the job system never changes it under a query. The ocean carries each vertex sideways as well as up, so a
+// query first steps back from the point to the vertex that ends up over it, and answers with that vertex's height.
+// Batches run four points to an SSE2 register; single queries still take a whole ocean texel to a register.
+
+#include "SimdMath.h"
+#include <vector>
+
+using namespace std;
+
+class OceanFFT;
+
+class WaterSurface {
+public:
+	WaterSurface() : simd(hasSimd()) {}
+
+	// renderWater's placement of the plane: scaled by scaleX and scaleZ, then moved to (x, level, z)
+	void setPlane(float scaleX, float scaleZ, float x, float level, float z);
+	// WaterData's sine waves at this time, in the plane's own units as water_vs takes them
+	void setWaves(float time, float amplitude, float frequency, float speed);
+	// Copies the ocean's current surface, which replaces the sine waves; null goes back to them
+	void setOcean(const OceanFFT* ocean, float patchLength);
+
+	float getLevel() const { return level; }
+	bool hasOcean() const { return oceanSize > 0; }
+
+	float getHeight(float x, float z) const;
+	void getNormal(float x, float z, float normal[3]) const;
+	// heights[i] at (x[i], z[i]), and the unit normals there when the three arrays are given
+	void getHeights(const float* x, const float* z, float* heights, int count,
+		float* normalX = nullptr, float* normalY = nullptr, float* normalZ = nullptr) const;
+
+	void setSimd(bool enabled) { simd = enabled && hasSimd(); }
+	static bool hasSimd();
+
+	static constexpr int UNDISPLACE_STEPS = 8;	// Most fixed-point steps back to the ocean vertex carried over a point
+	static constexpr float UNDISPLACE_SETTLED = 1e-4f;	// World units a step may move and still count as settled
+
+private:
+	void wavePoint(float x, float z, float& height, float* normal) const;
+	void oceanPoint(float x, float z, float& height, float* normal) const;
+	void sample(const vector<float>& texels, float x, float z, float texel[4]) const;
+
+	float scaleX = 1.0f, scaleZ = 1.0f;
+	float offsetX = 0.0f, offsetZ = 0.0f;
+	float level = 0.0f;
+	float time = 0.0f, amplitude = 0.0f, frequency = 0.0f, speed = 0.0f;
+
+	// Ocean texels as OceanFFT packs them, four floats each, rows along z
+	vector<float> oceanDisplacement, oceanNormals;
+	int oceanSize = 0;
+	float texelsPerUnit = 0.0f;
+
+	bool simd;
+};
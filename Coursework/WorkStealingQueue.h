@@ -0,0 +1,90 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// Bounded Chase-Lev deque of pointers. The owning thread pushes and pops at the bottom, like a stack, so it works on
+// what it spawned most recently while that is still in cache; any other thread steals from the top, taking the oldest
+// and usually largest piece of work. Capacity is rounded up to a power of two. push fails instead of growing.
+template<typename T>
+class WorkStealingQueue {
+public:
+	explicit WorkStealingQueue(size_t capacity = 4096) : slots(roundUp(capacity)) {
+		mask = (int64_t)slots.size() - 1;
+	}
+
+	WorkStealingQueue(const WorkStealingQueue&) = delete;
+	WorkStealingQueue& operator=(const WorkStealingQueue&) = delete;
+
+	// Owner only
+	bool push(T* item) {
+		const int64_t b = bottom.load(memory_order_relaxed);
+		const int64_t t = top.load(memory_order_acquire);
+		if (b - t > mask) return false;
+
+		slots[b & mask].store(item, memory_order_relaxed);
+		atomic_thread_fence(memory_order_release);
+		bottom.store(b + 1, memory_order_relaxed);
+		return true;
+	}
+
+	// Owner only
+	T* pop() {
+		const int64_t b = bottom.load(memory_order_relaxed) - 1;
+		bottom.store(b, memory_order_relaxed);
+		atomic_thread_fence(memory_order_seq_cst);
+		int64_t t = top.load(memory_order_relaxed);
+
+		if (t > b) {
+			bottom.store(b + 1, memory_order_relaxed);	// Already empty
+			return nullptr;
+		}
+
+		T* item = slots[b & mask].load(memory_order_relaxed);
+		if (t == b) {
+			// Last item: race any thief for it
+			if (!top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed)) item = nullptr;
+			bottom.store(b + 1, memory_order_relaxed);
+		}
+		return item;
+	}
+
+	// Any thread
+	T* steal() {
+		int64_t t = top.load(memory_order_acquire);
+		atomic_thread_fence(memory_order_seq_cst);
+		const int64_t b = bottom.load(memory_order_acquire);
+		if (t >= b) return nullptr;
+
+		T* item = slots[t & mask].load(memory_order_relaxed);
+		if (!top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed)) return nullptr;	// Lost the race
+		return item;
+	}
+
+	// Approximate from any thread while others are running
+	size_t size() const {
+		const int64_t b = bottom.load(memory_order_acquire), t = top.load(memory_order_acquire);
+		return b > t ? (size_t)(b - t) : 0;
+	}
+	bool empty() const { return size() == 0; }
+	size_t capacity() const { return slots.size(); }
+
+private:
+	static constexpr size_t CACHE_LINE = 64;
+
+	static size_t roundUp(size_t capacity) {
+		size_t size = 2;
+		while (size < capacity) size <<= 1;
+		return size;
+	}
+
+	vector<atomic<T*>> slots;
+	int64_t mask;
+
+	// Thieves hammer top, the owner bottom; keep them on separate lines
+	alignas(CACHE_LINE) atomic<int64_t> top{ 0 };
+	alignas(CACHE_LINE) atomic<int64_t> bottom{ 0 };
+};
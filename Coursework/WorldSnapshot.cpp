@@ -0,0 +1,279 @@
+#include "WorldSnapshot.h"
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static_assert(sizeof(SnapshotVector) == 12, "Pickups are stored as three floats");
+static_assert(sizeof(SnapshotIsland) == 32, "Islands are stored as 32 byte records");
+static_assert(sizeof(SnapshotBridge) == 8, "Bridges are stored as two indices");
+static_assert(sizeof(SnapshotSectionEntry) == 24, "Section entries are stored as 24 bytes");
+
+namespace {
+	size_t alignSection(size_t offset) {
+		return (offset + WorldSnapshot::SECTION_ALIGNMENT - 1) & ~(WorldSnapshot::SECTION_ALIGNMENT - 1);
+	}
+
+	const uint32_t ELEMENT_BYTES[(int)SnapshotSection::Count] = {
+		sizeof(SnapshotScene), sizeof(SnapshotIsland), sizeof(SnapshotVector), sizeof(SnapshotBridge)
+	};
+
+	// A run of the new file that differs from the old one
+	struct Block {
+		uint64_t offset;
+		const uint8_t* source;
+		size_t bytes;
+	};
+}
+
+void WorldSnapshotWriter::clear() {
+	scene = SnapshotScene();
+	islands.clear();
+	pickups.clear();
+	bridges.clear();
+}
+
+void WorldSnapshotWriter::reserve(size_t islandCount, size_t pickupCount, size_t bridgeCount) {
+	islands.reserve(islandCount);
+	pickups.reserve(pickupCount);
+	bridges.reserve(bridgeCount);
+}
+
+uint32_t WorldSnapshotWriter::addIsland(const SnapshotVector& position, float rotationY, uint32_t flags, const SnapshotVector* pickupPositions, uint32_t pickupCount) {
+	SnapshotIsland island;
+	island.position = position;
+	island.rotationY = rotationY;
+	island.pickupOffset = (uint32_t)pickups.size();
+	island.pickupCount = pickupCount;
+	island.pickupCapacity = pickupCount;
+	island.flags = flags;
+	islands.push_back(island);
+	pickups.insert(pickups.end(), pickupPositions, pickupPositions + pickupCount);
+	return (uint32_t)islands.size() - 1;
+}
+
+void WorldSnapshotWriter::addBridge(uint32_t islandA, uint32_t islandB) {
+	SnapshotBridge bridge;
+	bridge.islandA = islandA;
+	bridge.islandB = islandB;
+	bridges.push_back(bridge);
+}
+
+void WorldSnapshotWriter::layout(const SnapshotIsland* previous, size_t previousCount, size_t previousPickups) {
+	bool keepSlots = previous && previousCount == islands.size();
+	for (size_t i = 0; keepSlots && i < islands.size(); i++) {
+		keepSlots = islands[i].pickupCount <= previous[i].pickupCapacity &&
+			(uint64_t)previous[i].pickupOffset + previous[i].pickupCapacity <= previousPickups;
+	}
+
+	islandSection = islands;
+	size_t pickupTotal = 0;
+	for (SnapshotIsland& island : islandSection) {
+		if (keepSlots) {
+			const SnapshotIsland& slot = previous[&island - islandSection.data()];
+			island.pickupOffset = slot.pickupOffset;
+			island.pickupCapacity = slot.pickupCapacity;
+		}
+		else {
+			island.pickupOffset = (uint32_t)pickupTotal;
+			island.pickupCapacity = island.pickupCount;
+			pickupTotal += island.pickupCount;
+		}
+	}
+	if (keepSlots) pickupTotal = previousPickups;
+
+	// Zeroed first, so an emptied slot reads the same whichever save wrote it
+	pickupSection.assign(pickupTotal, SnapshotVector(0.f, 0.f, 0.f));
+	for (size_t i = 0; i < islands.size(); i++) {
+		if (islands[i].pickupCount == 0) continue;
+		memcpy(pickupSection.data() + islandSection[i].pickupOffset, pickups.data() + islands[i].pickupOffset,
+			islands[i].pickupCount * sizeof(SnapshotVector));
+	}
+
+	const uint64_t counts[(int)SnapshotSection::Count] = { 1, islandSection.size(), pickupSection.size(), bridges.size() };
+	header = SnapshotHeader();
+	header.magic = WorldSnapshot::MAGIC;
+	header.version = WorldSnapshot::VERSION;
+	header.headerBytes = sizeof(SnapshotHeader);
+	header.byteOrder = WorldSnapshot::BYTE_ORDER_MARK;
+	size_t offset = sizeof(SnapshotHeader);
+	for (int i = 0; i < (int)SnapshotSection::Count; i++) {
+		offset = alignSection(offset);
+		header.sections[i].offset = offset;
+		header.sections[i].count = counts[i];
+		header.sections[i].elementBytes = ELEMENT_BYTES[i];
+		offset += (size_t)counts[i] * ELEMENT_BYTES[i];
+	}
+	header.fileBytes = offset;
+}
+
+bool WorldSnapshotWriter::save(const char* path) {
+	const uint8_t* sources[(int)SnapshotSection::Count];
+	vector<Block> changed;
+	bool incremental = false;
+	size_t blocksCompared = 0;
+	{
+		WorldSnapshotView previous;
+		const uint8_t* old = nullptr;
+		if (previous.open(path)) {
+			const SnapshotHeader& previousHeader = previous.getHeader();
+			old = reinterpret_cast<const uint8_t*>(&previousHeader);
+			layout(previous.getIslands(), previous.getIslandCount(), (size_t)previousHeader.sections[(int)SnapshotSection::Pickups].count);
+			incremental = header.fileBytes == previousHeader.fileBytes &&
+				memcmp(header.sections, previousHeader.sections, sizeof(header.sections)) == 0;
+			header.generation = previousHeader.generation + 1;
+		}
+		else {
+			layout(nullptr, 0, 0);
+		}
+
+		sources[(int)SnapshotSection::Scene] = reinterpret_cast<const uint8_t*>(&scene);
+		sources[(int)SnapshotSection::Islands] = reinterpret_cast<const uint8_t*>(islandSection.data());
+		sources[(int)SnapshotSection::Pickups] = reinterpret_cast<const uint8_t*>(pickupSection.data());
+		sources[(int)SnapshotSection::Bridges] = reinterpret_cast<const uint8_t*>(bridges.data());
+
+		// Only what differs from the file as it stands; the view is closed before anything is written to it
+		if (incremental) {
+			for (int i = 0; i < (int)SnapshotSection::Count; i++) {
+				const SnapshotSectionEntry& entry = header.sections[i];
+				const size_t sectionBytes = (size_t)entry.count * entry.elementBytes;
+				for (size_t start = 0; start < sectionBytes; start += WorldSnapshot::BLOCK_BYTES) {
+					const size_t blockBytes = sectionBytes - start < WorldSnapshot::BLOCK_BYTES ? sectionBytes - start : WorldSnapshot::BLOCK_BYTES;
+					blocksCompared++;
+					if (memcmp(sources[i] + start, old + entry.offset + start, blockBytes) == 0) continue;
+					if (!changed.empty() && changed.back().offset + changed.back().bytes == entry.offset + start) changed.back().bytes += blockBytes;
+					else changed.push_back({ entry.offset + start, sources[i] + start, blockBytes });
+				}
+			}
+		}
+	}
+
+	if (!incremental) {
+		header.generation = 0;
+		return writeWhole(path, sources);
+	}
+
+	fstream file(path, ios::in | ios::out | ios::binary);
+	if (!file) return false;
+	lastSave = SaveStats();
+	lastSave.incremental = true;
+	lastSave.fileBytes = (size_t)header.fileBytes;
+	lastSave.blocksCompared = blocksCompared;
+	for (const Block& block : changed) {
+		file.seekp((streamoff)block.offset);
+		file.write(reinterpret_cast<const char*>(block.source), (streamsize)block.bytes);
+		lastSave.bytesWritten += block.bytes;
+		lastSave.blocksWritten += (block.bytes + WorldSnapshot::BLOCK_BYTES - 1) / WorldSnapshot::BLOCK_BYTES;
+	}
+	// The header goes last, once the sections it describes are down
+	file.flush();
+	file.seekp(0);
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	lastSave.bytesWritten += sizeof(header);
+	lastSave.generation = header.generation;
+	file.close();
+	return !file.fail();
+}
+
+bool WorldSnapshotWriter::writeWhole(const char* path, const uint8_t* const* sources) {
+	ofstream file(path, ios::binary | ios::trunc);
+	if (!file) return false;
+	lastSave = SaveStats();
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	size_t written = sizeof(header);
+	const char padding[WorldSnapshot::SECTION_ALIGNMENT] = {};
+	for (int i = 0; i < (int)SnapshotSection::Count; i++) {
+		const SnapshotSectionEntry& entry = header.sections[i];
+		file.write(padding, (streamsize)(entry.offset - written));
+		const size_t sectionBytes = (size_t)entry.count * entry.elementBytes;
+		file.write(reinterpret_cast<const char*>(sources[i]), (streamsize)sectionBytes);
+		written = (size_t)entry.offset + sectionBytes;
+	}
+	lastSave.fileBytes = written;
+	lastSave.bytesWritten = written;
+	lastSave.blocksWritten = (written + WorldSnapshot::BLOCK_BYTES - 1) / WorldSnapshot::BLOCK_BYTES;
+	lastSave.generation = header.generation;
+	file.close();
+	return !file.fail();
+}
+
+bool WorldSnapshotView::open(const char* path) {
+	close();
+	error.clear();
+#ifdef _WIN32
+	HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (handle == INVALID_HANDLE_VALUE) return fail("cannot open the file");
+	file = handle;
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(handle, &size)) return fail("cannot read the file's size");
+	bytes = (size_t)size.QuadPart;
+	if (bytes < sizeof(SnapshotHeader)) return fail("too short for a header");
+	mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (!mapping) return fail("cannot map the file");
+	data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	if (!data) return fail("cannot map the file");
+#else
+	file = ::open(path, O_RDONLY);
+	if (file < 0) return fail("cannot open the file");
+	struct stat status;
+	if (fstat(file, &status) != 0) return fail("cannot read the file's size");
+	bytes = (size_t)status.st_size;
+	if (bytes < sizeof(SnapshotHeader)) return fail("too short for a header");
+	void* mapped = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, file, 0);
+	if (mapped == MAP_FAILED) return fail("cannot map the file");
+	data = static_cast<const uint8_t*>(mapped);
+#endif
+
+	const SnapshotHeader& header = getHeader();
+	if (header.magic != WorldSnapshot::MAGIC) return fail("not a world snapshot");
+	if (header.byteOrder != WorldSnapshot::BYTE_ORDER_MARK) return fail("written on a machine of the other byte order");
+	if (header.version != WorldSnapshot::VERSION || header.headerBytes != sizeof(SnapshotHeader)) return fail("a different snapshot version");
+	if (header.fileBytes != bytes) return fail("truncated or padded since it was written");
+	for (int i = 0; i < (int)SnapshotSection::Count; i++) {
+		const SnapshotSectionEntry& entry = header.sections[i];
+		if (entry.elementBytes != ELEMENT_BYTES[i]) return fail("a section's records are the wrong size");
+		if (entry.offset % WorldSnapshot::SECTION_ALIGNMENT || entry.offset < sizeof(SnapshotHeader) || entry.offset > bytes)
+			return fail("a section starts outside the file");
+		if (entry.count > (bytes - entry.offset) / entry.elementBytes) return fail("a section runs past the end of the file");
+	}
+	if (count(SnapshotSection::Scene) != 1) return fail("no scene settings");
+	if (count(SnapshotSection::Pickups) > UINT32_MAX) return fail("more pickups than an island can reach");
+	return true;
+}
+
+void WorldSnapshotView::close() {
+#ifdef _WIN32
+	if (data) UnmapViewOfFile(data);
+	if (mapping) CloseHandle(mapping);
+	if (file) CloseHandle(file);
+	mapping = nullptr;
+	file = nullptr;
+#else
+	if (data) munmap(const_cast<uint8_t*>(data), bytes);
+	if (file >= 0) ::close(file);
+	file = -1;
+#endif
+	data = nullptr;
+	bytes = 0;
+}
+
+const SnapshotVector* WorldSnapshotView::getPickups(const SnapshotIsland& island) const {
+	if (island.pickupCount > island.pickupCapacity ||
+		(uint64_t)island.pickupOffset + island.pickupCapacity > count(SnapshotSection::Pickups)) return nullptr;
+	return section<SnapshotVector>(SnapshotSection::Pickups) + island.pickupOffset;
+}
+
+bool WorldSnapshotView::fail(const char* message) {
+	close();
+	error = message;
+	return false;
+}
@@ -0,0 +1,201 @@
+#pragma once
+// A saved world as one binary file that loads by mapping it. After a fixed header come page-aligned sections, each a
+// flat array of fixed-size records: the scene settings, the islands, their pickups and the bridges. Records point
+// into one another by index and offset rather than by pointer, so nothing is parsed on load; WorldSnapshotView maps
+// the file, checks the header and section table, and hands out the arrays where they lie. A million-island world
+// opens in the time it takes to map it, and pages come in as they are first read.
+//
+// Saves are incremental. Each island's pickups sit in a slot of their own, and the writer keeps the slots of the file
+// it is overwriting while they still fit, so collecting a pickup leaves every other record where it was. The writer
+// then compares the new sections with the file block by block and writes only the blocks that differ, with the header
+// last. Anything that changes a section's size (a new world, an island outgrowing its slot) rewrites the whole file.
+
+#include "Vector3.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+typedef Vector3 SnapshotVector;
+
+using namespace std;
+
+// The parts of SceneData a world is remembered by: how it was generated, the water and the lights
+struct SnapshotScene {
+	int32_t gridSize = 0;
+	int32_t islandCount = 0;
+	int32_t ghostCount = 0;
+	float islandSize = 0.f;
+	float minIslandDistance = 0.f;
+
+	float waterLevel = 0.f;
+	float amplitude = 0.f;
+	float frequency = 0.f;
+	float speed = 0.f;
+	float oceanPatchLength = 0.f;
+	float oceanWindSpeed = 0.f;
+	float oceanChoppiness = 0.f;
+	int32_t oceanSize = 0;
+	uint32_t waterFlags = 0;	// WATER_VISIBLE, WATER_FFT
+
+	float ambientColour[4] = {};
+	float diffuseColour[4] = {};
+	float specularColour[4] = {};
+	float specularPower = 0.f;
+	float pointLight2Position[3] = {};
+	float pointLight1Colour[4] = {};
+	float pointLight2Colour[4] = {};
+	float pointLightRadius[2] = {};
+
+	float lightDirections[2][3] = {};
+	float directionalPosition[3] = {};
+	float spotColour[4] = {};
+	float spotCutoff = 0.f;
+	float spotFalloff = 0.f;
+	float moonPosition[3] = {};
+
+	float blurAmount = 0.f;
+	float blurIntensity = 0.f;
+
+	static constexpr uint32_t WATER_VISIBLE = 1;
+	static constexpr uint32_t WATER_FFT = 2;
+};
+
+struct SnapshotIsland {
+	SnapshotVector position;
+	float rotationY = 0.f;
+	uint32_t pickupOffset = 0;	// Into the pickups section
+	uint32_t pickupCount = 0;
+	uint32_t pickupCapacity = 0;	// The slot: pickups past the count are zeroed
+	uint32_t flags = 0;	// INITIALIZED, HAS_AMBIENCE
+
+	static constexpr uint32_t INITIALIZED = 1;
+	static constexpr uint32_t HAS_AMBIENCE = 2;
+};
+
+struct SnapshotBridge {
+	uint32_t islandA = 0;
+	uint32_t islandB = 0;
+};
+
+enum class SnapshotSection : uint32_t {
+	Scene,
+	Islands,
+	Pickups,
+	Bridges,
+	Count
+};
+
+struct SnapshotSectionEntry {
+	uint64_t offset;	// From the start of the file, a multiple of SECTION_ALIGNMENT
+	uint64_t count;
+	uint32_t elementBytes;
+	uint32_t reserved;
+};
+
+struct SnapshotHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t headerBytes;
+	uint32_t byteOrder;	// BYTE_ORDER_MARK as written; reads back swapped, and is refused, on a machine of the other order
+	uint64_t fileBytes;
+	uint64_t generation;	// Saves made to this file since it was last written whole
+	SnapshotSectionEntry sections[(int)SnapshotSection::Count];
+};
+
+namespace WorldSnapshot {
+	constexpr uint32_t MAGIC = 0x504E5357;	// "WSNP"
+	constexpr uint32_t VERSION = 1;	// Bumped with any change to the records or the header
+	constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+	constexpr size_t SECTION_ALIGNMENT = 4096;	// A page, so every array is aligned however it's mapped
+	constexpr size_t BLOCK_BYTES = 65536;	// What an incremental save compares and writes at a time
+}
+
+class WorldSnapshotWriter {
+public:
+	struct SaveStats {
+		bool incremental = false;	// False when the whole file was written
+		size_t fileBytes = 0;
+		size_t bytesWritten = 0;
+		size_t blocksWritten = 0;
+		size_t blocksCompared = 0;
+		uint64_t generation = 0;
+	};
+
+	void clear();
+	void reserve(size_t islands, size_t pickups, size_t bridges);
+
+	void setScene(const SnapshotScene& value) { scene = value; }
+	// Returns the island's index; its pickups follow in the order given
+	uint32_t addIsland(const SnapshotVector& position, float rotationY, uint32_t flags, const SnapshotVector* pickupPositions, uint32_t pickupCount);
+	void addBridge(uint32_t islandA, uint32_t islandB);
+
+	// False when the file can't be opened or written. An incremental save writes the header last, so one cut short
+	// leaves the old generation number on a file whose sections may be part new
+	bool save(const char* path);
+	const SaveStats& getLastSave() const { return lastSave; }
+
+	size_t getIslandCount() const { return islands.size(); }
+
+private:
+	// Lays out the sections, keeping the slots of the islands in previous while every island still fits its own
+	void layout(const SnapshotIsland* previous, size_t previousCount, size_t previousPickups);
+	bool writeWhole(const char* path, const uint8_t* const* sources);
+
+	SnapshotScene scene;
+	vector<SnapshotIsland> islands;	// Offsets into pickups until layout() gives them their slots
+	vector<SnapshotVector> pickups;
+	vector<SnapshotBridge> bridges;
+
+	// Built by layout(): the file as it should end up
+	SnapshotHeader header = {};
+	vector<SnapshotIsland> islandSection;
+	vector<SnapshotVector> pickupSection;
+
+	SaveStats lastSave;
+};
+
+class WorldSnapshotView {
+public:
+	WorldSnapshotView() {}
+	~WorldSnapshotView() { close(); }
+	WorldSnapshotView(const WorldSnapshotView&) = delete;
+	WorldSnapshotView& operator=(const WorldSnapshotView&) = delete;
+
+	// Maps the file and checks its header and section table; the records themselves aren't read until they're used
+	bool open(const char* path);
+	void close();
+	bool isOpen() const { return data != nullptr; }
+	const string& getError() const { return error; }
+
+	const SnapshotHeader& getHeader() const { return *reinterpret_cast<const SnapshotHeader*>(data); }
+	const SnapshotScene& getScene() const { return *section<SnapshotScene>(SnapshotSection::Scene); }
+
+	const SnapshotIsland* getIslands() const { return section<SnapshotIsland>(SnapshotSection::Islands); }
+	size_t getIslandCount() const { return count(SnapshotSection::Islands); }
+	// Null, with no pickups, when the island's slot reaches outside the section
+	const SnapshotVector* getPickups(const SnapshotIsland& island) const;
+
+	const SnapshotBridge* getBridges() const { return section<SnapshotBridge>(SnapshotSection::Bridges); }
+	size_t getBridgeCount() const { return count(SnapshotSection::Bridges); }
+
+	size_t getFileBytes() const { return bytes; }
+
+private:
+	template<typename T>
+	const T* section(SnapshotSection id) const {
+		return reinterpret_cast<const T*>(data + getHeader().sections[(int)id].offset);
+	}
+	size_t count(SnapshotSection id) const { return (size_t)getHeader().sections[(int)id].count; }
+	bool fail(const char* message);
+
+	const uint8_t* data = nullptr;
+	size_t bytes = 0;
+	string error;
+#ifdef _WIN32
+	void* file = nullptr;
+	void* mapping = nullptr;
+#else
+	int file = -1;
+#endif
+};
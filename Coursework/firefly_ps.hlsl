@@ -36,16 +36,18 @@ cbuffer LightBuffer : register(b0)
     float4 specularColour; // Specular highlight color
     float specularPower; // Specular intensity control
     
-    // Time properties
-    float timeVal; // Time passed in seconds
-    float2 padding; // Extra padding for alignment
-    float padding2;
-    
     // Directional Light properties
     float3 directionalLightDirection; // Directional light direction
     float4 directionalColour; // directional light colour
 };
 
+// Constant buffer updated once a frame
+cbuffer FrameBuffer : register(b1)
+{
+    float timeVal; // Time passed in seconds
+    float3 framePadding; // Extra padding for alignment
+};
+
 /****************************************************************************************************************************/
 
 // Struct to define the input to the pixel shader
@@ -8,14 +8,30 @@ SamplerState moonSampler : register(s0); // Sampler for moon texture
 
 /****************************************************************************************************************************/
 
-// Constant buffer to store lighting information
+// Constant buffer to store lighting information; the scene's, shared with the other lit shaders
 cbuffer LightBuffer : register(b0)
 {
     float4 ambientColour; // Ambient light color
     float4 diffuseColour; // Diffuse light color
-    float3 moonPos; // Spotlight position (moon)
-    float padding; // Padding for alignment
+
+    float3 pointLight1Pos;
+    float pointLight1Radius;
+    float4 pointLight1Colour;
+
+    float3 pointLight2Pos;
+    float pointLight2Radius;
+    float4 pointLight2Colour;
+
     float4 spotlightColour; // Spotlight color (moonlight)
+    float spotlightCutoff;
+    float3 spotlightDirection;
+    float spotlightFalloff;
+    float3 moonPos; // Spotlight position (moon)
+
+    float4 specularColour;
+    float specularPower;
+    float3 directionalLightDirection;
+    float4 directionalColour;
 };
 
 /****************************************************************************************************************************/
@@ -0,0 +1,87 @@
+/** Terrain: Static Vertex Shader Code **/
+// For islands and bridges far enough away that tessellation adds nothing on screen. Each vertex of the plain mesh is displaced and transformed here exactly as the domain shader does for tessellated vertices, so terrain_ps draws it unchanged.
+/****************************************************************************************************************************/
+
+// Textures and samplers for different types of data
+Texture2D terrainTexture : register(t0); // Texture for terrain
+SamplerState terrainSample : register(s0); // Sampler for terrain texture
+
+/****************************************************************************************************************************/
+
+// Constant buffer for storing transformation matrices
+cbuffer MatrixBuffer : register(b0)
+{
+    matrix worldMatrix; // world space
+    matrix viewMatrix; // camera view space
+    matrix projectionMatrix; // view space coordinates to screen space
+    matrix lightViewMatrix; // Spotlight - light's view space (for shadow mapping)
+    matrix lightProjectionMatrix; // light view space positions to screen space (for shadow mapping)
+    matrix lightViewMatrix2; // Directional Light - light's view space (for shadow mapping)
+    matrix lightProjectionMatrix2; // light view space positions to screen space (for shadow mapping)
+};
+
+// Constant buffer for storing camera information
+cbuffer CameraBuffer : register(b1)
+{
+    float3 cameraPosition;
+    float padding;
+};
+
+// Struct to define the input to the vertex shader
+struct InputType
+{
+    float3 position : POSITION;
+    float2 tex : TEXCOORD0;
+    float3 normal : NORMAL;
+};
+
+// Struct to define the output to the pixel shader, matching terrain_ds
+struct OutputType
+{
+    float4 position : SV_POSITION;
+    float2 tex : TEXCOORD0;
+    float3 normal : NORMAL;
+    float3 worldNormal : TEXCOORD1;
+    float3 worldPosition : TEXCOORD2;
+    float4 lightViewPos : TEXCOORD3; // Light view position for shadow mapping
+    float3 viewVector : TEXCOORD4; // Vector from vertex to camera
+    float4 lightViewPos2 : TEXCOORD5;
+};
+
+/****************************************************************************************************************************/
+
+OutputType main(InputType input)
+{
+    OutputType output;
+    
+    // Same displacement as the domain shader
+    float3 vertexPosition = input.position;
+    float height = terrainTexture.SampleLevel(terrainSample, input.tex, 0).r;
+    vertexPosition.y += height * 0.2f;
+    
+    // World space transformation (to clip space)
+    float4 worldPos = mul(float4(vertexPosition, 1.0f), worldMatrix);
+    float4 viewPos = mul(worldPos, viewMatrix);
+    float4 projPos = mul(viewPos, projectionMatrix);
+
+    output.position = projPos;
+    output.worldPosition = worldPos.xyz;
+    output.worldNormal = normalize(mul(input.normal, (float3x3) worldMatrix));
+    output.normal = normalize(input.normal);
+
+    // Light space transformation - spotlight
+    float4 lightPos = mul(worldPos, lightViewMatrix);
+    output.lightViewPos = mul(lightPos, lightProjectionMatrix);
+    
+    // Light space transformation - direcitional light
+    float4 lightPos2 = mul(worldPos, lightViewMatrix2);
+    output.lightViewPos2 = mul(lightPos2, lightProjectionMatrix2);
+    
+    // Repeat the texture
+    output.tex = input.tex * 3.f;
+    
+    // View vector for lighting
+    output.viewVector = cameraPosition - worldPos.xyz;
+
+    return output;
+}
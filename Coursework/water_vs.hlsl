@@ -28,8 +28,16 @@ cbuffer TimeBufferType : register(b2)
     float amplitude; // Height
     float frequency; // wavelength
     float speed; // speed
+    float oceanPatchLength; // World units before the FFT ocean repeats
+    float oceanEnabled; // 1 to displace by the FFT ocean rather than the sine waves
+    float2 timePadding;
 };
 
+// FFT ocean from OceanFFT, tiling across the plane: choppy x, height, choppy z; then the normal
+Texture2D oceanDisplacement : register(t0);
+Texture2D oceanNormals : register(t1);
+SamplerState oceanSampler : register(s0);
+
 /****************************************************************************************************************************/
 
 // Struct to define the input to the vertex shader
@@ -66,30 +74,42 @@ OutputType main(InputType input)
     // Original normal before wave modification
     float3 originalNormal = input.normal;
     
-    // Water wave motion is created using sine and cosine functions to displace the y-position of vertices. Normals are recalculated based on derivatives to ensure proper lighting. A static normal (originalNormal) is maintained for specular lighting, keeping reflections stationary.
-    // Wave transformation
-    float distance = speed * time;
-    float x_wave = amplitude * sin(frequency * input.position.x + distance);
-    float z_wave = amplitude * cos(frequency * input.position.z + distance);
-    input.position.y += x_wave + z_wave;
-
-    // Adjusted normal based on wave calculations (derivatives)
-    float dx = amplitude * frequency * cos(frequency * input.position.x + distance);
-    float dz = -amplitude * frequency * sin(frequency * input.position.z + distance);
-    float3 modifiedNormal = normalize(float3(-dx, 1.0f, -dz));
-
-    
-    output.position = mul(input.position, worldMatrix); // Transform position to world space
-    output.position = mul(output.position, viewMatrix); // to camera view space
+    float4 worldPosition = mul(input.position, worldMatrix);
+    float3 modifiedNormal;
+    if (oceanEnabled > 0.5f)
+    {
+        // The ocean is sampled in world space so the waves keep their size however the plane is scaled
+        float2 oceanUV = worldPosition.xz / oceanPatchLength;
+        worldPosition.xyz += oceanDisplacement.SampleLevel(oceanSampler, oceanUV, 0).xyz;
+        modifiedNormal = oceanNormals.SampleLevel(oceanSampler, oceanUV, 0).xyz;
+    }
+    else
+    {
+        // Water wave motion is created using sine and cosine functions to displace the y-position of vertices. Normals are recalculated based on derivatives to ensure proper lighting. A static normal (originalNormal) is maintained for specular lighting, keeping reflections stationary.
+        // Wave transformation
+        float distance = speed * time;
+        float x_wave = amplitude * sin(frequency * input.position.x + distance);
+        float z_wave = amplitude * cos(frequency * input.position.z + distance);
+        input.position.y += x_wave + z_wave;
+        worldPosition = mul(input.position, worldMatrix);
+
+        // Adjusted normal based on wave calculations (derivatives)
+        float dx = amplitude * frequency * cos(frequency * input.position.x + distance);
+        float dz = -amplitude * frequency * sin(frequency * input.position.z + distance);
+        // The surface's tangents through the world matrix, so its scale flattens the slopes as it stretches the plane (WaterSurface matches this)
+        float3 tangentX = mul(float3(1.0f, dx, 0.0f), (float3x3) worldMatrix);
+        float3 tangentZ = mul(float3(0.0f, dz, 1.0f), (float3x3) worldMatrix);
+        modifiedNormal = cross(tangentZ, tangentX);
+    }
+
+    output.position = mul(worldPosition, viewMatrix); // to camera view space
     output.position = mul(output.position, projectionMatrix); // to screen space
     
     // Calculate the position of the vertice as viewed by the light source.
-    output.lightViewPos = mul(input.position, worldMatrix);
-    output.lightViewPos = mul(output.lightViewPos, lightViewMatrix);
+    output.lightViewPos = mul(worldPosition, lightViewMatrix);
     output.lightViewPos = mul(output.lightViewPos, lightProjectionMatrix);
     
-    output.lightViewPos2 = mul(input.position, worldMatrix);
-    output.lightViewPos2 = mul(output.lightViewPos2, lightViewMatrix2);
+    output.lightViewPos2 = mul(worldPosition, lightViewMatrix2);
     output.lightViewPos2 = mul(output.lightViewPos2, lightProjectionMatrix2);
     
 
@@ -97,14 +117,13 @@ OutputType main(InputType input)
     output.tex.x = input.tex.x * 4.0f;
     output.tex.y = input.tex.y * 4.0f;
 
-    output.normal = normalize(mul(modifiedNormal, (float3x3) worldMatrix)); // Transform using world matrix without any translation
+    output.normal = normalize(modifiedNormal);
     output.originalNormal = normalize(mul(originalNormal, (float3x3) worldMatrix)); // Unmodified normal
 
     // World space
-    output.worldPosition = mul(input.position, worldMatrix).xyz;
+    output.worldPosition = worldPosition.xyz;
     
     // Vector from vertex to the camera normalized
-    float4 worldPosition = mul(input.position, worldMatrix);
     output.viewVector = cameraPosition.xyz - worldPosition.xyz;
     output.viewVector = normalize(output.viewVector);
 
@@ -73,6 +73,7 @@ void AModel::importModel(const std::string& pFile)
 	indexData.SysMemSlicePitch = 0;
 	// Create the index buffer.
 	device->CreateBuffer(&indexBufferDesc, &indexData, &indexBuffer);
+	trackBuffers(MemoryTag::Models);
 
 	// Release the arrays now that the vertex and index buffers have been created and loaded.
 	//delete vertices;
@@ -84,6 +84,9 @@ bool BaseApplication::frame()
 
 	timer->frame();
 
+	// Upload any streamed texture mips that finished decoding
+	textureMgr->update();
+
 	handleInput(timer->getTime());
 
 	ImGui_ImplDX11_NewFrame();
@@ -9,12 +9,20 @@ BaseMesh::BaseMesh()
 	indexBuffer = nullptr;
 	vertexCount = 0;
 	indexCount = 0;
-
+	trackedBytes = 0;
+	trackedTag = MemoryTag::Meshes;
 }
 
 // Release base objects (index, vertex buffers and texture object.
 BaseMesh::~BaseMesh()
 {
+	// Derived destructors call this one too, so it has to be safe to run twice
+	if (trackedBytes)
+	{
+		MemoryTracker::freeGpu(trackedTag, GpuMemory::Buffer, trackedBytes);
+		trackedBytes = 0;
+	}
+
 	if (indexBuffer)
 	{
 		indexBuffer->Release();
@@ -33,6 +41,34 @@ int BaseMesh::getIndexCount()
 	return indexCount;
 }
 
+void BaseMesh::trackBuffers(MemoryTag tag)
+{
+	if (trackedBytes)
+	{
+		MemoryTracker::freeGpu(trackedTag, GpuMemory::Buffer, trackedBytes);
+	}
+
+	size_t bytes = 0;
+	D3D11_BUFFER_DESC desc;
+	if (vertexBuffer)
+	{
+		vertexBuffer->GetDesc(&desc);
+		bytes += desc.ByteWidth;
+	}
+	if (indexBuffer)
+	{
+		indexBuffer->GetDesc(&desc);
+		bytes += desc.ByteWidth;
+	}
+
+	trackedBytes = bytes;
+	trackedTag = tag;
+	if (trackedBytes)
+	{
+		MemoryTracker::allocateGpu(trackedTag, GpuMemory::Buffer, trackedBytes);
+	}
+}
+
 // Sends geometry data to the GPU. Default primitive topology is TriangleList.
 // To render alternative topologies this function needs to be overwritten.
 void BaseMesh::sendData(ID3D11DeviceContext* deviceContext, D3D_PRIMITIVE_TOPOLOGY top)
@@ -0,0 +1,181 @@
+// Block decoder
+// Palette construction follows the D3D11 functional spec, rounding included, so decoded texels equal sampled ones.
+#include "BlockDecoder.h"
+#include <cstring>
+
+namespace
+{
+	const int BC7_WEIGHTS4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	// 5:6:5 to 8 bits a channel by replicating the top bits into the bottom
+	void unpack565(uint16_t value, int rgb[3])
+	{
+		const int r = (value >> 11) & 31, g = (value >> 5) & 63, b = value & 31;
+		rgb[0] = (r << 3) | (r >> 2);
+		rgb[1] = (g << 2) | (g >> 4);
+		rgb[2] = (b << 3) | (b >> 2);
+	}
+
+	// BC7 fields are packed least significant bit first through the block
+	struct BitReader
+	{
+		const uint8_t* data;
+		int position;
+
+		uint32_t read(int bits)
+		{
+			uint32_t value = 0;
+			for (int b = 0; b < bits; ++b, ++position)
+			{
+				value |= (uint32_t)((data[position >> 3] >> (position & 7)) & 1) << b;
+			}
+			return value;
+		}
+	};
+}
+
+void BlockDecoder::decodeBC1(const uint8_t in[8], uint8_t rgba[64])
+{
+	const uint16_t c0 = (uint16_t)(in[0] | (in[1] << 8));
+	const uint16_t c1 = (uint16_t)(in[2] | (in[3] << 8));
+	uint32_t indices;
+	memcpy(&indices, in + 4, 4);
+
+	int palette[4][4];
+	unpack565(c0, palette[0]);
+	unpack565(c1, palette[1]);
+	for (int c = 0; c < 3; ++c)
+	{
+		if (c0 > c1)
+		{
+			palette[2][c] = (2 * palette[0][c] + palette[1][c] + 1) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c] + 1) / 3;
+		}
+		else
+		{
+			palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+			palette[3][c] = 0;
+		}
+	}
+	palette[0][3] = palette[1][3] = palette[2][3] = 255;
+	palette[3][3] = (c0 > c1) ? 255 : 0;
+
+	for (int i = 0; i < 16; ++i)
+	{
+		const int index = (indices >> (i * 2)) & 3;
+		for (int c = 0; c < 4; ++c)
+		{
+			rgba[i * 4 + c] = (uint8_t)palette[index][c];
+		}
+	}
+}
+
+void BlockDecoder::decodeBC3(const uint8_t in[16], uint8_t rgba[64])
+{
+	decodeBC1(in + 8, rgba);
+
+	const int a0 = in[0], a1 = in[1];
+	int palette[8] = { a0, a1 };
+	if (a0 > a1)
+	{
+		for (int k = 2; k < 8; ++k)
+		{
+			palette[k] = ((8 - k) * a0 + (k - 1) * a1 + 3) / 7;
+		}
+	}
+	else
+	{
+		for (int k = 2; k < 6; ++k)
+		{
+			palette[k] = ((6 - k) * a0 + (k - 1) * a1 + 2) / 5;
+		}
+		palette[6] = 0;
+		palette[7] = 255;
+	}
+
+	uint64_t bits = 0;
+	for (int b = 0; b < 6; ++b)
+	{
+		bits |= (uint64_t)in[2 + b] << (b * 8);
+	}
+	for (int i = 0; i < 16; ++i)
+	{
+		rgba[i * 4 + 3] = (uint8_t)palette[(bits >> (i * 3)) & 7];
+	}
+}
+
+bool BlockDecoder::decodeBC7(const uint8_t in[16], uint8_t rgba[64])
+{
+	// Mode 6: six zero bits then a one
+	if ((in[0] & 0x7f) != 0x40)
+	{
+		return false;
+	}
+
+	BitReader reader = { in, 7 };
+	int endpoints[2][4];
+	for (int c = 0; c < 4; ++c)
+	{
+		endpoints[0][c] = (int)reader.read(7) << 1;
+		endpoints[1][c] = (int)reader.read(7) << 1;
+	}
+	const int p0 = (int)reader.read(1), p1 = (int)reader.read(1);
+	for (int c = 0; c < 4; ++c)
+	{
+		endpoints[0][c] |= p0;
+		endpoints[1][c] |= p1;
+	}
+
+	// The first index drops its top bit, which is implied zero
+	for (int i = 0; i < 16; ++i)
+	{
+		const int weight = BC7_WEIGHTS4[reader.read(i == 0 ? 3 : 4)];
+		for (int c = 0; c < 4; ++c)
+		{
+			rgba[i * 4 + c] = (uint8_t)(((64 - weight) * endpoints[0][c] + weight * endpoints[1][c] + 32) >> 6);
+		}
+	}
+	return true;
+}
+
+bool BlockDecoder::decode(BlockFormat format, const uint8_t* blocks, int width, int height, uint8_t* rgba, size_t rowPitch)
+{
+	const int blocksX = (width + 3) / 4;
+	const int blocksY = (height + 3) / 4;
+	const size_t stride = blockBytes(format);
+
+	uint8_t texels[64];
+	for (int by = 0; by < blocksY; ++by)
+	{
+		for (int bx = 0; bx < blocksX; ++bx)
+		{
+			const uint8_t* block = blocks + ((size_t)by * blocksX + bx) * stride;
+			switch (format)
+			{
+			case BlockFormat::BC1:
+				decodeBC1(block, texels);
+				break;
+			case BlockFormat::BC3:
+				decodeBC3(block, texels);
+				break;
+			case BlockFormat::BC7:
+				if (!decodeBC7(block, texels))
+				{
+					return false;
+				}
+				break;
+			}
+
+			// Edge blocks hang past the surface; only the texels inside it are kept
+			for (int y = 0; y < 4 && by * 4 + y < height; ++y)
+			{
+				uint8_t* row = rgba + (size_t)(by * 4 + y) * rowPitch + (size_t)bx * 16;
+				for (int x = 0; x < 4 && bx * 4 + x < width; ++x)
+				{
+					memcpy(row + x * 4, texels + (y * 4 + x) * 4, 4);
+				}
+			}
+		}
+	}
+	return true;
+}
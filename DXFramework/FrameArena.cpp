@@ -0,0 +1,131 @@
+// Frame arena
+// Block bookkeeping for FrameArena, and each thread's scratch arena.
+#include "FrameArena.h"
+#include "MemoryTracker.h"
+#include <cstdint>
+#include <cstdlib>
+
+FrameArena::FrameArena(size_t lblockSize)
+{
+	blockSize = lblockSize;
+	current = 0;
+	offset = 0;
+	stats = Stats();
+}
+
+FrameArena::~FrameArena()
+{
+	freeBlocks();
+}
+
+void* FrameArena::allocate(size_t bytes, size_t alignment)
+{
+	if (blocks.empty())
+	{
+		addBlock(bytes + alignment > blockSize ? bytes + alignment : blockSize);
+	}
+
+	for (;;)
+	{
+		Block& block = blocks[current];
+		const uintptr_t start = reinterpret_cast<uintptr_t>(block.data) + offset;
+		const uintptr_t aligned = (start + alignment - 1) & ~(uintptr_t)(alignment - 1);
+		const size_t end = (size_t)(aligned - reinterpret_cast<uintptr_t>(block.data)) + bytes;
+		if (end <= block.size)
+		{
+			stats.bytes += end - offset;
+			if (stats.bytes > stats.peakBytes)
+			{
+				stats.peakBytes = stats.bytes;
+			}
+			stats.allocations++;
+			stats.totalAllocations++;
+			offset = end;
+			return reinterpret_cast<void*>(aligned);
+		}
+
+		// The rest of this block is skipped; blocks kept from earlier frames are tried before a new one is made
+		stats.bytes += block.size - offset;
+		if (current + 1 == blocks.size())
+		{
+			const size_t grown = block.size * 2;
+			addBlock(bytes + alignment > grown ? bytes + alignment : grown);
+		}
+		current++;
+		offset = 0;
+	}
+}
+
+void FrameArena::release(void* data, size_t bytes)
+{
+	if (blocks.empty() || bytes > offset)
+	{
+		return;
+	}
+	if (static_cast<char*>(data) + bytes == blocks[current].data + offset)
+	{
+		offset -= bytes;
+		stats.bytes -= bytes;
+	}
+}
+
+// Only the position goes back: merging blocks and rolling the frame's stats over are reset()'s, so a scope opened on an
+// empty arena isn't counted as a frame
+void FrameArena::rewind(const Marker& marker)
+{
+	current = marker.block;
+	offset = marker.offset;
+	stats.bytes = marker.bytes;
+}
+
+void FrameArena::reset()
+{
+	// Every block that was needed becomes one, so next time it all fits without moving on
+	if (blocks.size() > 1)
+	{
+		size_t total = 0;
+		for (const Block& block : blocks)
+		{
+			total += block.size;
+		}
+		freeBlocks();
+		addBlock(total);
+	}
+	current = 0;
+	offset = 0;
+	stats.bytes = 0;
+	stats.lastAllocations = stats.allocations;
+	stats.allocations = 0;
+}
+
+FrameArena& FrameArena::scratch()
+{
+	static thread_local FrameArena arena;
+	return arena;
+}
+
+void FrameArena::addBlock(size_t size)
+{
+	Block block;
+	block.data = static_cast<char*>(std::malloc(size));
+	if (!block.data)
+	{
+		throw std::bad_alloc();
+	}
+	block.size = size;
+	blocks.push_back(block);
+	MemoryTracker::allocate(MemoryTag::Arenas, size);
+	stats.capacity += size;
+	stats.blockAllocations++;
+}
+
+void FrameArena::freeBlocks()
+{
+	for (const Block& block : blocks)
+	{
+		std::free(block.data);
+		MemoryTracker::free(MemoryTag::Arenas, block.size);
+	}
+	blocks.clear();
+	stats.capacity = 0;
+}
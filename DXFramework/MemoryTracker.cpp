@@ -0,0 +1,184 @@
+// Memory tracker
+// Per tag counters, and the JSON dump of them.
+#include "MemoryTracker.h"
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+
+namespace
+{
+	struct Counters
+	{
+		std::atomic<size_t> bytes;
+		std::atomic<size_t> peakBytes;
+		std::atomic<size_t> allocations;
+		std::atomic<size_t> frees;
+		std::atomic<size_t> externalBytes;
+		std::atomic<size_t> externalPeakBytes;
+		std::atomic<size_t> gpuBytes[(int)GpuMemory::Count];
+		std::atomic<size_t> gpuTotalBytes;
+		std::atomic<size_t> gpuPeakBytes;
+		std::atomic<size_t> gpuAllocations;
+		std::atomic<size_t> gpuFrees;
+	};
+
+	// Zero initialised, being static, so reports made while other statics are constructed are still counted
+	Counters counters[(int)MemoryTag::Count];
+
+	void raisePeak(std::atomic<size_t>& peak, size_t value)
+	{
+		size_t current = peak.load(std::memory_order_relaxed);
+		while (value > current && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed))
+		{
+		}
+	}
+
+	// A stray double free shows up as a count that went to zero, not one that wrapped round
+	void subtract(std::atomic<size_t>& counter, size_t value)
+	{
+		size_t current = counter.load(std::memory_order_relaxed);
+		while (!counter.compare_exchange_weak(current, current > value ? current - value : 0, std::memory_order_relaxed))
+		{
+		}
+	}
+}
+
+size_t MemoryTracker::TagStats::getGpuBytes() const
+{
+	size_t total = 0;
+	for (int i = 0; i < (int)GpuMemory::Count; i++)
+	{
+		total += gpuBytes[i];
+	}
+	return total;
+}
+
+void MemoryTracker::allocate(MemoryTag tag, size_t bytes)
+{
+	Counters& tagCounters = counters[(int)tag];
+	raisePeak(tagCounters.peakBytes, tagCounters.bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+	tagCounters.allocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+void MemoryTracker::free(MemoryTag tag, size_t bytes)
+{
+	Counters& tagCounters = counters[(int)tag];
+	subtract(tagCounters.bytes, bytes);
+	tagCounters.frees.fetch_add(1, std::memory_order_relaxed);
+}
+
+void MemoryTracker::setExternal(MemoryTag tag, size_t bytes, size_t peakBytes)
+{
+	Counters& tagCounters = counters[(int)tag];
+	tagCounters.externalBytes.store(bytes, std::memory_order_relaxed);
+	raisePeak(tagCounters.externalPeakBytes, peakBytes > bytes ? peakBytes : bytes);
+}
+
+void MemoryTracker::allocateGpu(MemoryTag tag, GpuMemory kind, size_t bytes)
+{
+	Counters& tagCounters = counters[(int)tag];
+	tagCounters.gpuBytes[(int)kind].fetch_add(bytes, std::memory_order_relaxed);
+	raisePeak(tagCounters.gpuPeakBytes, tagCounters.gpuTotalBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+	tagCounters.gpuAllocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+void MemoryTracker::freeGpu(MemoryTag tag, GpuMemory kind, size_t bytes)
+{
+	Counters& tagCounters = counters[(int)tag];
+	subtract(tagCounters.gpuBytes[(int)kind], bytes);
+	subtract(tagCounters.gpuTotalBytes, bytes);
+	tagCounters.gpuFrees.fetch_add(1, std::memory_order_relaxed);
+}
+
+MemoryTracker::TagStats MemoryTracker::getStats(MemoryTag tag)
+{
+	const Counters& tagCounters = counters[(int)tag];
+	TagStats stats;
+	stats.bytes = tagCounters.bytes.load(std::memory_order_relaxed);
+	stats.peakBytes = tagCounters.peakBytes.load(std::memory_order_relaxed);
+	stats.allocations = tagCounters.allocations.load(std::memory_order_relaxed);
+	stats.frees = tagCounters.frees.load(std::memory_order_relaxed);
+	stats.externalBytes = tagCounters.externalBytes.load(std::memory_order_relaxed);
+	stats.externalPeakBytes = tagCounters.externalPeakBytes.load(std::memory_order_relaxed);
+	for (int i = 0; i < (int)GpuMemory::Count; i++)
+	{
+		stats.gpuBytes[i] = tagCounters.gpuBytes[i].load(std::memory_order_relaxed);
+	}
+	stats.gpuPeakBytes = tagCounters.gpuPeakBytes.load(std::memory_order_relaxed);
+	stats.gpuAllocations = tagCounters.gpuAllocations.load(std::memory_order_relaxed);
+	stats.gpuFrees = tagCounters.gpuFrees.load(std::memory_order_relaxed);
+	return stats;
+}
+
+MemoryTracker::TagStats MemoryTracker::getTotal()
+{
+	TagStats total = TagStats();
+	for (int tag = 0; tag < (int)MemoryTag::Count; tag++)
+	{
+		const TagStats stats = getStats((MemoryTag)tag);
+		total.bytes += stats.bytes;
+		total.peakBytes += stats.peakBytes;
+		total.allocations += stats.allocations;
+		total.frees += stats.frees;
+		total.externalBytes += stats.externalBytes;
+		total.externalPeakBytes += stats.externalPeakBytes;
+		for (int i = 0; i < (int)GpuMemory::Count; i++)
+		{
+			total.gpuBytes[i] += stats.gpuBytes[i];
+		}
+		total.gpuPeakBytes += stats.gpuPeakBytes;
+		total.gpuAllocations += stats.gpuAllocations;
+		total.gpuFrees += stats.gpuFrees;
+	}
+	return total;
+}
+
+const char* MemoryTracker::getName(MemoryTag tag)
+{
+	static const char* names[] = { "Islands", "Textures", "Meshes", "Models", "Rendering", "Audio", "Arenas" };
+	static_assert(sizeof(names) / sizeof(names[0]) == (size_t)MemoryTag::Count, "A tag is missing its name");
+	return names[(int)tag];
+}
+
+const char* MemoryTracker::getName(GpuMemory kind)
+{
+	static const char* names[] = { "Buffer", "Texture", "RenderTarget" };
+	static_assert(sizeof(names) / sizeof(names[0]) == (size_t)GpuMemory::Count, "A kind is missing its name");
+	return names[(int)kind];
+}
+
+std::string MemoryTracker::toJson()
+{
+	std::string json = "{\n  \"tags\": [\n";
+	char line[512];
+	for (int tag = 0; tag <= (int)MemoryTag::Count; tag++)
+	{
+		// The last entry is the total over every tag
+		const bool isTotal = tag == (int)MemoryTag::Count;
+		const TagStats stats = isTotal ? getTotal() : getStats((MemoryTag)tag);
+		snprintf(line, sizeof(line),
+			"    {\"tag\": \"%s\", \"cpu\": {\"bytes\": %zu, \"peakBytes\": %zu, \"allocations\": %zu, \"frees\": %zu, "
+			"\"externalBytes\": %zu, \"externalPeakBytes\": %zu}, \"gpu\": {",
+			isTotal ? "Total" : getName((MemoryTag)tag), stats.bytes, stats.peakBytes, stats.allocations, stats.frees,
+			stats.externalBytes, stats.externalPeakBytes);
+		json += line;
+		for (int i = 0; i < (int)GpuMemory::Count; i++)
+		{
+			snprintf(line, sizeof(line), "\"%s\": %zu, ", getName((GpuMemory)i), stats.gpuBytes[i]);
+			json += line;
+		}
+		snprintf(line, sizeof(line), "\"peakBytes\": %zu, \"allocations\": %zu, \"frees\": %zu}}%s\n",
+			stats.gpuPeakBytes, stats.gpuAllocations, stats.gpuFrees, isTotal ? "" : ",");
+		json += line;
+	}
+	json += "  ]\n}\n";
+	return json;
+}
+
+bool MemoryTracker::writeJson(const char* path)
+{
+	std::ofstream file(path, std::ios::binary);
+	file << toJson();
+	file.close();
+	return !file.fail();
+}
@@ -0,0 +1,121 @@
+/**
+* \class MemoryTracker
+*
+* \brief Counts the memory each subsystem holds, on the CPU and on the GPU, for the memory panel and capacity planning
+*
+* \class TrackedAllocator
+*
+* \brief STL allocator that counts what its container holds against a MemoryTag
+*/
+
+// Memory tracker
+// Nothing is intercepted: each subsystem reports what it takes and gives back, under its tag. CPU bytes come from
+// tracked containers and explicit calls, GPU bytes from the descriptions of the buffers, textures and render targets
+// made (what they need, not what the driver rounds them up to). Libraries that keep their own books, like FMOD, are
+// reported as external bytes whenever they're polled. Counters are atomic, so any thread may report.
+
+#ifndef _MEMORYTRACKER_H_
+#define _MEMORYTRACKER_H_
+
+#include <cstddef>
+#include <new>
+#include <string>
+#include <vector>
+
+enum class MemoryTag
+{
+	Islands,
+	Textures,
+	Meshes,
+	Models,
+	Rendering,
+	Audio,
+	Arenas,
+	Count
+};
+
+enum class GpuMemory
+{
+	Buffer,
+	Texture,
+	RenderTarget,
+	Count
+};
+
+class MemoryTracker
+{
+public:
+	struct TagStats
+	{
+		size_t bytes;				///< CPU, held now
+		size_t peakBytes;
+		size_t allocations;			///< Ever made
+		size_t frees;
+		size_t externalBytes;		///< As last reported by a library
+		size_t externalPeakBytes;
+		size_t gpuBytes[(int)GpuMemory::Count];
+		size_t gpuPeakBytes;		///< All kinds together
+		size_t gpuAllocations;
+		size_t gpuFrees;
+
+		size_t getCpuBytes() const { return bytes + externalBytes; }
+		size_t getGpuBytes() const;
+	};
+
+	static void allocate(MemoryTag tag, size_t bytes);
+	static void free(MemoryTag tag, size_t bytes);
+	static void setExternal(MemoryTag tag, size_t bytes, size_t peakBytes);
+
+	static void allocateGpu(MemoryTag tag, GpuMemory kind, size_t bytes);
+	static void freeGpu(MemoryTag tag, GpuMemory kind, size_t bytes);
+
+	static TagStats getStats(MemoryTag tag);
+	static TagStats getTotal();		///< Peaks are the sum of each tag's, so may never have happened at once
+
+	static const char* getName(MemoryTag tag);
+	static const char* getName(GpuMemory kind);
+
+	static std::string toJson();
+	static bool writeJson(const char* path);
+};
+
+template<typename T, MemoryTag Tag>
+class TrackedAllocator
+{
+public:
+	typedef T value_type;
+
+	template<typename U>
+	struct rebind
+	{
+		typedef TrackedAllocator<U, Tag> other;
+	};
+
+	TrackedAllocator() {}
+	template<typename U>
+	TrackedAllocator(const TrackedAllocator<U, Tag>&) {}
+
+	T* allocate(size_t count)
+	{
+		T* data = static_cast<T*>(::operator new(count * sizeof(T)));
+		MemoryTracker::allocate(Tag, count * sizeof(T));
+		return data;
+	}
+
+	void deallocate(T* data, size_t count)
+	{
+		MemoryTracker::free(Tag, count * sizeof(T));
+		::operator delete(data);
+	}
+};
+
+template<typename T, typename U, MemoryTag Tag>
+bool operator==(const TrackedAllocator<T, Tag>&, const TrackedAllocator<U, Tag>&) { return true; }
+
+template<typename T, typename U, MemoryTag Tag>
+bool operator!=(const TrackedAllocator<T, Tag>&, const TrackedAllocator<U, Tag>&) { return false; }
+
+template<typename T, MemoryTag Tag>
+using TrackedVector = std::vector<T, TrackedAllocator<T, Tag>>;
+
+#endif
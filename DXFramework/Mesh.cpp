@@ -1,5 +1,6 @@
 // Mesh.cpp
 #include "mesh.h"
+#include "FrameArena.h"
 
 Mesh::Mesh(ID3D11Device* device, ID3D11DeviceContext* deviceContext, WCHAR* textureFilename)
 {
@@ -67,11 +68,12 @@ bool Mesh::InitBuffers(ID3D11Device* device)
 	// Set the number of indices in the index array.
 	m_indexCount = 6;
 
-	// Create the vertex array.
-	vertices = new VertexType[m_vertexCount];
+	// Create the vertex array, as scratch given back when InitBuffers returns.
+	ScratchScope scratch;
+	vertices = scratch.allocate<VertexType>(m_vertexCount);
 	
 	// Create the index array.
-	indices = new unsigned long[m_indexCount];
+	indices = scratch.allocate<unsigned long>(m_indexCount);
 	
 	// Load the vertex array with data.
 	vertices[0].position = XMFLOAT3(-1.0f, -1.0f, 0.0f);  // Bottom left.
@@ -139,13 +141,6 @@ bool Mesh::InitBuffers(ID3D11Device* device)
 		return false;
 	}
 	
-	// Release the arrays now that the vertex and index buffers have been created and loaded.
-	delete[] vertices;
-	vertices = 0;
-
-	delete[] indices;
-	indices = 0;
-
 	return true;
 }
 
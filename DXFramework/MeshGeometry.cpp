@@ -0,0 +1,733 @@
+// Mesh geometry
+// The shapes the framework meshes upload, built into caller arrays, and a basic OBJ reader.
+#include "MeshGeometry.h"
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+// Generate and store cube vertices, normals and texture coordinates
+void MeshGeometry::buildCube(int resolution, MeshVertex* vertices, unsigned long* indices)
+{
+	// Vertex variables
+	float yincrement = 2.0f / resolution;
+	float xincrement = 2.0f / resolution;
+	float ystart = 1.0f;
+	float xstart = -1.0f;
+	//UV variables
+	float txu = 0.0f;
+	float txv = 0.0f;
+	float txuinc = 1.0f / resolution;	// UV increment
+	float txvinc = 1.0f / resolution;
+	//Counters
+	int v = 0;	// vertex counter
+	int i = 0;	// index counter
+
+	//front face
+
+	for (int y = 0; y < resolution; y++)	// for each quad in the y direction
+	{
+		for (int x = 0; x < resolution; x++)	// for each quad in the x direction
+		{
+			// Load the vertex array with data.
+			//0
+			vertices[v].position = XMFLOAT3(xstart, ystart - yincrement, -1.0f);  // Bottom left. -1. -1. 0
+			vertices[v].texture = XMFLOAT2(txu, txv + txvinc);
+			vertices[v].normal = XMFLOAT3(0.0f, 0.0f, -1.0f);
+
+			indices[i] = i;
+			v++;
+			i++;
+
+			//1
+			vertices[v].position = XMFLOAT3(xstart + xincrement, ystart, -1.0f);  // Top right.	1.0, 1.0 0.0
+			vertices[v].texture = XMFLOAT2(txu + txuinc, txv);
+			vertices[v].normal = XMFLOAT3(0.0f, 0.0f, -1.0f);
+
+			indices[i] = i;
+			v++;
+			i++;
+
+			//2
+			vertices[v].position = XMFLOAT3(xstart, ystart, -1.0f);  // Top left.	-1.0, 1.0
+			vertices[v].texture = XMFLOAT2(txu, txv);
+			vertices[v].normal = XMFLOAT3(0.0f, 0.0f, -1.0f);
+
+			indices[i] = i;
+			v++;
+			i++;
+
+			//0
+			vertices[v].position = XMFLOAT3(xstart, ystart - yincrement, -1.0f);  // Bottom left. -1. -1. 0
+			vertices[v].texture = XMFLOAT2(txu, txv + txvinc);
+			vertices[v].normal = XMFLOAT3(0.0f, 0.0f, -1.0f);
+
+			indices[i] = i;
+			v++;
+			i++;
+
+			//3
+			vertices[v].position = XMFLOAT3(xstart + xincrement, ystart - yincrement, -1.0f);  // Bottom right.	1.0, -1.0, 0.0
+			vertices[v].texture = XMFLOAT2(txu + txuinc, txv + txvinc);
+			vertices[v].normal = XMFLOAT3(0.0f, 0.0f, -1.0f);
+
+			indices[i] = i;
+			v++;
+			i++;
+
+			//1
+			vertices[v].position = XMFLOAT3(xstart + xincrement, ystart, -1.0f);  // Top right.	1.0, 1.0 0.0
+			vertices[v].texture = XMFLOAT2(txu + txuinc, txv);
+			vertices[v].normal = XMFLOAT3(0.0f, 0.0f, -1.0f);
+
+			indices[i] = i;
+			v++;
+			i++;
+
+			// increment
+			xstart += xincrement;
+			txu += txuinc;
+			//ystart -= yincrement;
+
+		}
+
+		ystart -= yincrement;
+		xstart = -1;
+
+		txu = 0;
+		txv += txvinc;
+
+	}
+
+	txv = 0;
+
+	//back face
+	ystart = 1;
+	xstart = 1;
+	for (int y = 0; y < resolution; y++)	// for each quad in the y direction
+	{
+		for (int x = 0; x < resolution; x++)	// for each quad in the x direction
+		{
+			// Load the vertex array with data.
+			//0
+			vertices[v].position = XMFLOAT3(xstart, ystart - yincrement, 1.0f);  // Bottom left. -1. -1. 0
+			vertices[v].texture = XMFLOAT2(txu, txv + txvinc);
+			vertices[v].normal = XMFLOAT3(0.0f, 0.0f, 1.0f);
+
+			indices[i] = i;
+			v++;
+			i++;
+
+			//2
+			vertices[v].position = XMFLOAT3(xstart - xincrement, ystart, 1.0f);  // Top right.	1.0, 1.0 0.0
+			vertices[v].texture = XMFLOAT2(txu + txuinc, txv);
+			vertices[v].normal = XMFLOAT3(0.0f, 0.0f, 1.0f);
+
+			indices[i] = i;
+			v++;
+			i++;
+
+			//1
+			vertices[v].position = XMFLOAT3(xstart, ystart, 1.0f);  // Top left.	-1.0, 1.0
+			vertices[v].texture = XMFLOAT2(txu, txv);
+			vertices[v].normal = XMFLOAT3(0.0f, 0.0f, 1.0f);
+
+			indices[i] = i;
+			v++;
+			i++;
+
+			//0
+			vertices[v].position = XMFLOAT3(xstart, ystart - yincrement, 1.0f);  // Bottom left. -1. -1. 0
+			vertices[v].texture = XMFLOAT2(txu, txv + txvinc);
+			vertices[v].normal = XMFLOAT3(0.0f, 0.0f, 1.0f);
+
+			indices[i] = i;
+			v++;
+			i++;
+
+			//3
+			vertices[v].position = XMFLOAT3(xstart - xincrement, ystart - yincrement, 1.0f);  // Bottom right.	1.0, -1.0, 0.0
+			vertices[v].texture = XMFLOAT2(txu + txuinc, txv + txvinc);
+			vertices[v].normal = XMFLOAT3(0.0f, 0.0f, 1.0f);
+
+			indices[i] = i;
+			v++;
+			i++;
+
+			//2
+			vertices[v].position = XMFLOAT3(xstart - xincrement, ystart, 1.0f);  // Top right.	1.0, 1.0 0.0
+			vertices[v].texture = XMFLOAT2(txu + txuinc, txv);
+			vertices[v].normal = XMFLOAT3(0.0f, 0.0f, 1.0f);
+
+			indices[i] = i;
+			v++;
+			i++;
+
+			// increment
+			xstart -= xincrement;
+			//ystart -= yincrement;
+			txu += txuinc;
+
+		}
+
+		ystart -= yincrement;
+		xstart = 1;
+
+		txu = 0;
+		txv += txvinc;
+
+	}
+
+	txv = 0;
+
+	//right face
+	ystart = 1;
+	xstart = -1;
+	for (int y = 0; y < resolution; y++)	// for each quad in the y direction
+	{
+		for (int x = 0; x < resolution; x++)	// for each quad in the x direction
+		{
+			// Load the vertex array with data.
+			//0
+			vertices[v].position = XMFLOAT3(1.0f, ystart - yincrement, xstart);  // Bottom left. -1. -1. 0
+			vertices[v].texture = XMFLOAT2(txu, txv + txvinc);
+			vertices[v].normal = XMFLOAT3(1.0f, 0.0f, 0.0f);
+
+			indices[i] = i;
+			v++;
+			i++;
+
+			//2
+			vertices[v].position = XMFLOAT3(1.0f, ystart, xstart + xincrement);  // Top right.	1.0, 1.0 0.0
+			vertices[v].texture = XMFLOAT2(txu + txuinc, txv);
+			vertices[v].normal = XMFLOAT3(1.0f, 0.0f, 0.0f);
+
+			indices[i] = i;
+			v++;
+			i++;
+
+			//1
+			vertices[v].position = XMFLOAT3(1.0f, ystart, xstart);  // Top left.	-1.0, 1.0
+			vertices[v].texture = XMFLOAT2(txu, txv);
+			vertices[v].normal = XMFLOAT3(1.0f, 0.0f, 0.0f);
+
+			indices[i] = i;
+			v++;
+			i++;
+
+			//0
+			vertices[v].position = XMFLOAT3(1.0f, ystart - yincrement, xstart);  // Bottom left. -1. -1. 0
+			vertices[v].texture = XMFLOAT2(txu, txv + txvinc);
+			vertices[v].normal = XMFLOAT3(1.0f, 0.0f, 0.0f);
+
+			indices[i] = i;
+			v++;
+			i++;
+
+			//3
+			vertices[v].position = XMFLOAT3(1.0f, ystart - yincrement, xstart + xincrement);  // Bottom right.	1.0, -1.0, 0.0
+			vertices[v].texture = XMFLOAT2(txu + txuinc, txv + txvinc);
+			vertices[v].normal = XMFLOAT3(1.0f, 0.0f, 0.0f);
+
+			indices[i] = i;
+			v++;
+			i++;
+
+			//2
+			vertices[v].position = XMFLOAT3(1.0f, ystart, xstart + xincrement);  // Top right.	1.0, 1.0 0.0
+			vertices[v].texture = XMFLOAT2(txu + txuinc, txv);
+			vertices[v].normal = XMFLOAT3(1.0f, 0.0f, 0.0f);
+
+			indices[i] = i;
+			v++;
+			i++;
+
+			// increment
+			xstart += xincrement;
+			//ystart -= yincrement;
+			txu += txuinc;
+
+		}
+
+		ystart -= yincrement;
+		xstart = -1;
+		txu = 0;
+		txv += txvinc;
+	}
+
+	txv = 0;
+
+	//left face
+	ystart = 1;
+	xstart = 1;
+	for (int y = 0; y < resolution; y++)	// for each quad in the y direction
+	{
+		for (int x = 0; x < resolution; x++)	// for each quad in the x direction
+		{
+			// Load the vertex array with data.
+			//0
+			vertices[v].position = XMFLOAT3(-1.0f, ystart - yincrement, xstart);  // Bottom left. -1. -1. 0
+			vertices[v].texture = XMFLOAT2(txu, txv + txvinc);
+			vertices[v].normal = XMFLOAT3(-1.0f, 0.0f, 0.0f);
+
+			indices[i] = i;
+			v++;
+			i++;
+
+			//2
+			vertices[v].position = XMFLOAT3(-1.0f, ystart, xstart - xincrement);  // Top right.	1.0, 1.0 0.0
+			vertices[v].texture = XMFLOAT2(txu + txuinc, txv);
+			vertices[v].normal = XMFLOAT3(-1.0f, 0.0f, 0.0f);
+
+			indices[i] = i;
+			v++;
+			i++;
+
+			//1
+			vertices[v].position = XMFLOAT3(-1.0f, ystart, xstart);  // Top left.	-1.0, 1.0
+			vertices[v].texture = XMFLOAT2(txu, txv);
+			vertices[v].normal = XMFLOAT3(-1.0f, 0.0f, 0.0f);
+
+			indices[i] = i;
+			v++;
+			i++;
+
+			//0
+			vertices[v].position = XMFLOAT3(-1.0f, ystart - yincrement, xstart);  // Bottom left. -1. -1. 0
+			vertices[v].texture = XMFLOAT2(txu, txv + txvinc);
+			vertices[v].normal = XMFLOAT3(-1.0f, 0.0f, 0.0f);
+
+			indices[i] = i;
+			v++;
+			i++;
+
+			//3
+			vertices[v].position = XMFLOAT3(-1.0f, ystart - yincrement, xstart - xincrement);  // Bottom right.	1.0, -1.0, 0.0
+			vertices[v].texture = XMFLOAT2(txu + txuinc, txv + txvinc);
+			vertices[v].normal = XMFLOAT3(-1.0f, 0.0f, 0.0f);
+
+			indices[i] = i;
+			v++;
+			i++;
+
+			//2
+			vertices[v].position = XMFLOAT3(-1.0f, ystart, xstart - xincrement);  // Top right.	1.0, 1.0 0.0
+			vertices[v].texture = XMFLOAT2(txu + txuinc, txv);
+			vertices[v].normal = XMFLOAT3(-1.0f, 0.0f, 0.0f);
+
+			indices[i] = i;
+			v++;
+			i++;
+
+			// increment
+			xstart -= xincrement;
+			//ystart -= yincrement;
+			txu += txuinc;
+		}
+
+		ystart -= yincrement;
+		xstart = 1;
+		txu = 0;
+		txv += txvinc;
+	}
+
+	txv = 0;
+
+	//top face
+	ystart = 1;
+	xstart = -1;
+
+	for (int y = 0; y < resolution; y++)	// for each quad in the y direction
+	{
+		for (int x = 0; x < resolution; x++)	// for each quad in the x direction
+		{
+			// Load the vertex array with data.
+			//0
+			vertices[v].position = XMFLOAT3(xstart, 1.0f, ystart - yincrement);  // Bottom left. -1. -1. 0
+			vertices[v].texture = XMFLOAT2(txu, txv + txvinc);
+			vertices[v].normal = XMFLOAT3(0.0f, 1.0f, 0.0f);
+
+			indices[i] = i;
+			v++;
+			i++;
+
+			//2
+			vertices[v].position = XMFLOAT3(xstart + xincrement, 1.0f, ystart);  // Top right.	1.0, 1.0 0.0
+			vertices[v].texture = XMFLOAT2(txu + txuinc, txv);
+			vertices[v].normal = XMFLOAT3(0.0f, 1.0f, 0.0f);
+
+			indices[i] = i;
+			v++;
+			i++;
+
+			//1
+			vertices[v].position = XMFLOAT3(xstart, 1.0f, ystart);  // Top left.	-1.0, 1.0
+			vertices[v].texture = XMFLOAT2(txu, txv);
+			vertices[v].normal = XMFLOAT3(0.0f, 1.0f, 0.0f);
+
+			indices[i] = i;
+			v++;
+			i++;
+
+			//0
+			vertices[v].position = XMFLOAT3(xstart, 1.0f, ystart - yincrement);  // Bottom left. -1. -1. 0
+			vertices[v].texture = XMFLOAT2(txu, txv + txvinc);
+			vertices[v].normal = XMFLOAT3(0.0f, 1.0f, 0.0f);
+
+			indices[i] = i;
+			v++;
+			i++;
+
+			//3
+			vertices[v].position = XMFLOAT3(xstart + xincrement, 1.0f, ystart - yincrement);  // Bottom right.	1.0, -1.0, 0.0
+			vertices[v].texture = XMFLOAT2(txu + txuinc, txv + txvinc);
+			vertices[v].normal = XMFLOAT3(0.0f, 1.0f, 0.0f);
+
+			indices[i] = i;
+			v++;
+			i++;
+
+			//2
+			vertices[v].position = XMFLOAT3(xstart + xincrement, 1.0f, ystart);  // Top right.	1.0, 1.0 0.0
+			vertices[v].texture = XMFLOAT2(txu + txuinc, txv);
+			vertices[v].normal = XMFLOAT3(0.0f, 1.0f, 0.0f);
+
+			indices[i] = i;
+			v++;
+			i++;
+
+			// increment
+			xstart += xincrement;
+			//ystart -= yincrement;
+			txu += txuinc;
+		}
+
+		ystart -= yincrement;
+		xstart = -1;
+		txu = 0;
+		txv += txvinc;
+	}
+
+	txv = 0;
+
+	//bottom face
+	ystart = -1;
+	xstart = -1;
+
+	for (int y = 0; y < resolution; y++)	// for each quad in the y direction
+	{
+		for (int x = 0; x < resolution; x++)	// for each quad in the x direction
+		{
+			// Load the vertex array with data.
+			//0
+			vertices[v].position = XMFLOAT3(xstart, -1.0f, ystart + yincrement);  // Bottom left. -1. -1. 0
+			vertices[v].texture = XMFLOAT2(txu, txv + txvinc);
+			vertices[v].normal = XMFLOAT3(0.0f, -1.0f, 0.0f);
+
+			indices[i] = i;
+			v++;
+			i++;
+
+			//2
+			vertices[v].position = XMFLOAT3(xstart + xincrement, -1.0f, ystart);  // Top right.	1.0, 1.0 0.0
+			vertices[v].texture = XMFLOAT2(txu + txuinc, txv);
+			vertices[v].normal = XMFLOAT3(0.0f, -1.0f, 0.0f);
+
+			indices[i] = i;
+			v++;
+			i++;
+
+			//1
+			vertices[v].position = XMFLOAT3(xstart, -1.0f, ystart);  // Top left.	-1.0, 1.0
+			vertices[v].texture = XMFLOAT2(txu, txv);
+			vertices[v].normal = XMFLOAT3(0.0f, -1.0f, 0.0f);
+
+			indices[i] = i;
+			v++;
+			i++;
+
+			//0
+			vertices[v].position = XMFLOAT3(xstart, -1.0f, ystart + yincrement);  // Bottom left. -1. -1. 0
+			vertices[v].texture = XMFLOAT2(txu, txv + txvinc);
+			vertices[v].normal = XMFLOAT3(0.0f, -1.0f, 0.0f);
+
+			indices[i] = i;
+			v++;
+			i++;
+
+			//3
+			vertices[v].position = XMFLOAT3(xstart + xincrement, -1.0f, ystart + yincrement);  // Bottom right.	1.0, -1.0, 0.0
+			vertices[v].texture = XMFLOAT2(txu + txuinc, txv + txvinc);
+			vertices[v].normal = XMFLOAT3(0.0f, -1.0f, 0.0f);
+
+			indices[i] = i;
+			v++;
+			i++;
+
+			//2
+			vertices[v].position = XMFLOAT3(xstart + xincrement, -1.0f, ystart);  // Top right.	1.0, 1.0 0.0
+			vertices[v].texture = XMFLOAT2(txu + txuinc, txv);
+			vertices[v].normal = XMFLOAT3(0.0f, -1.0f, 0.0f);
+
+			indices[i] = i;
+			v++;
+			i++;
+
+			// increment
+			xstart += xincrement;
+			//ystart -= yincrement;
+			txu += txuinc;
+		}
+
+		ystart += yincrement;
+		xstart = -1;
+		txu = 0;
+		txv += txvinc;
+	}
+}
+
+// Generates a cube based on resolution provided. Then normalises vertex positions to create sphere.
+void MeshGeometry::buildSphere(int resolution, MeshVertex* vertices, unsigned long* indices)
+{
+	buildCube(resolution, vertices, indices);
+
+	// now loop over every vertex and bend into a sphere (normalise the vertices)
+	const int vertexCount = cubeVertexCount(resolution);
+	float x = 0;
+	float y = 0;
+	float z = 0;
+	float dx = 0;
+	float dy = 0;
+	float dz = 0;
+
+	for (int counter = 0; counter < vertexCount; counter++)
+	{
+		x = vertices[counter].position.x;
+		y = vertices[counter].position.y;
+		z = vertices[counter].position.z;
+
+		dx = x * sqrtf(1.0f - (y*y / 2.0f) - (z*z / 2.0f) + (y*y*z*z / 3.0f));
+		dy = y * sqrtf(1.0f - (z*z / 2.0f) - (x*x / 2.0f) + (z*z*x*x / 3.0f));
+		dz = z * sqrtf(1.0f - (x*x / 2.0f) - (y*y / 2.0f) + (x*x*y*y / 3.0f));
+
+		vertices[counter].position.x = dx;
+		vertices[counter].position.y = dy;
+		vertices[counter].position.z = dz;
+
+		vertices[counter].normal.x = dx;
+		vertices[counter].normal.y = dy;
+		vertices[counter].normal.z = dz;
+	}
+}
+
+// Generate plane (including texture coordinates and normals).
+void MeshGeometry::buildPlane(int resolution, MeshVertex* vertices, unsigned long* indices)
+{
+	int index, i, j;
+	float positionX, positionZ, u, v, increment;
+
+	index = 0;
+	// UV coords.
+	u = 0;
+	v = 0;
+	increment = 1.0f / resolution;
+
+	for (j = 0; j < (resolution - 1); j++)
+	{
+		for (i = 0; i < (resolution - 1); i++)
+		{
+			// Upper left.
+			positionX = (float)i;
+			positionZ = (float)(j);
+
+			vertices[index].position = XMFLOAT3(positionX, 0.0f, positionZ);
+			vertices[index].texture = XMFLOAT2(u, v);
+			vertices[index].normal = XMFLOAT3(0.0, 1.0, 0.0);
+			indices[index] = index;
+			index++;
+
+			// Upper right.
+			positionX = (float)(i + 1);
+			positionZ = (float)(j + 1);
+
+			vertices[index].position = XMFLOAT3(positionX, 0.0f, positionZ);
+			vertices[index].texture = XMFLOAT2(u + increment, v + increment);
+			vertices[index].normal = XMFLOAT3(0.0, 1.0, 0.0);
+			indices[index] = index;
+			index++;
+
+
+			// lower left
+			positionX = (float)(i);
+			positionZ = (float)(j + 1);
+
+
+			vertices[index].position = XMFLOAT3(positionX, 0.0f, positionZ);
+			vertices[index].texture = XMFLOAT2(u, v + increment);
+			vertices[index].normal = XMFLOAT3(0.0, 1.0, 0.0);
+			indices[index] = index;
+			index++;
+
+			// Upper left
+			positionX = (float)(i);
+			positionZ = (float)(j);
+
+			vertices[index].position = XMFLOAT3(positionX, 0.0f, positionZ);
+			vertices[index].texture = XMFLOAT2(u, v);
+			vertices[index].normal = XMFLOAT3(0.0, 1.0, 0.0);
+			indices[index] = index;
+			index++;
+
+			// Bottom right
+			positionX = (float)(i + 1);
+			positionZ = (float)(j);
+
+			vertices[index].position = XMFLOAT3(positionX, 0.0f, positionZ);
+			vertices[index].texture = XMFLOAT2(u + increment, v);
+			vertices[index].normal = XMFLOAT3(0.0, 1.0, 0.0);
+			indices[index] = index;
+			index++;
+
+			// Upper right.
+			positionX = (float)(i + 1);
+			positionZ = (float)(j + 1);
+
+			vertices[index].position = XMFLOAT3(positionX, 0.0f, positionZ);
+			vertices[index].texture = XMFLOAT2(u + increment, v + increment);
+			vertices[index].normal = XMFLOAT3(0.0, 1.0, 0.0);
+			indices[index] = index;
+			index++;
+
+			u += increment;
+
+		}
+
+		u = 0;
+		v += increment;
+	}
+}
+
+// Build quad mesh.
+void MeshGeometry::buildQuad(MeshVertex* vertices, unsigned long* indices)
+{
+	// Load the vertex array with data.
+	vertices[0].position = XMFLOAT3(-1.0f, -1.0f, 0.0f);  // Bottom left.
+	vertices[0].texture = XMFLOAT2(0.0f, 1.0f);
+	vertices[0].normal = XMFLOAT3(0.0f, 0.0f, -1.0f);
+
+	vertices[1].position = XMFLOAT3(-1.0f, 1.0f, 0.0f);  // Top left.
+	vertices[1].texture = XMFLOAT2(0.0f, 0.0f);
+	vertices[1].normal = XMFLOAT3(0.0f, 0.0f, -1.0f);
+
+	vertices[2].position = XMFLOAT3(1.0f, 1.0f, 0.0f);  // Top right.
+	vertices[2].texture = XMFLOAT2(1.0f, 0.0f);
+	vertices[2].normal = XMFLOAT3(0.0f, 0.0f, -1.0f);
+
+	vertices[3].position = XMFLOAT3(1.0f, -1.0f, 0.0f);  // Bottom right.
+	vertices[3].texture = XMFLOAT2(1.0f, 1.0f);
+	vertices[3].normal = XMFLOAT3(0.0f, 0.0f, -1.0f);
+
+	// Load the index array with data.
+	indices[0] = 0;  // Bottom left.
+	indices[1] = 2;  // Top right.
+	indices[2] = 1;  // Top left.
+
+	indices[3] = 0;	// bottom left
+	indices[4] = 3;	// bottom right
+	indices[5] = 2;	// top right
+}
+
+namespace
+{
+	// "v/vt/vn", one based, into the three indices; false unless all three are there
+	bool readCorner(const std::string& token, long corner[3])
+	{
+		const char* text = token.c_str();
+		for (int i = 0; i < 3; i++)
+		{
+			char* end;
+			corner[i] = std::strtol(text, &end, 10);
+			if (end == text || *end != (i < 2 ? '/' : '\0'))
+			{
+				return false;
+			}
+			text = end + 1;
+		}
+		return true;
+	}
+}
+
+// Modified from a mulit-threaded version by Mark Ropper (CGT).
+bool MeshGeometry::loadObj(const char* filename, std::vector<ObjVertex>& model)
+{
+	model.clear();
+	std::ifstream file(filename);
+	if (!file)
+	{
+		return false;
+	}
+
+	std::vector<XMFLOAT3> verts;
+	std::vector<XMFLOAT3> norms;
+	std::vector<XMFLOAT2> texCs;
+	std::vector<long> faces;
+
+	std::string line, lineHeader;
+	while (std::getline(file, line))
+	{
+		// Read first word of the line
+		std::istringstream words(line);
+		if (!(words >> lineHeader))
+		{
+			continue;
+		}
+
+		if (lineHeader == "v") // Vertex
+		{
+			XMFLOAT3 vertex(0.0f, 0.0f, 0.0f);
+			words >> vertex.x >> vertex.y >> vertex.z;
+			verts.push_back(vertex);
+		}
+		else if (lineHeader == "vt") // Tex Coord
+		{
+			XMFLOAT2 uv(0.0f, 0.0f);
+			words >> uv.x >> uv.y;
+			texCs.push_back(uv);
+		}
+		else if (lineHeader == "vn") // Normal
+		{
+			XMFLOAT3 normal(0.0f, 0.0f, 0.0f);
+			words >> normal.x >> normal.y >> normal.z;
+			norms.push_back(normal);
+		}
+		else if (lineHeader == "f") // Face
+		{
+			std::string token;
+			for (int i = 0; i < 3; i++)
+			{
+				long corner[3];
+				if (!(words >> token) || !readCorner(token, corner) ||
+					corner[0] < 1 || corner[0] > (long)verts.size() ||
+					corner[1] < 1 || corner[1] > (long)texCs.size() ||
+					corner[2] < 1 || corner[2] > (long)norms.size())
+				{
+					// Parser error, or not triangle faces
+					return false;
+				}
+				faces.insert(faces.end(), corner, corner + 3);
+			}
+		}
+	}
+
+	// "Unroll" the loaded obj information into a list of triangles.
+	model.resize(faces.size() / 3);
+	for (size_t f = 0, vIndex = 0; f < faces.size(); f += 3, vIndex++)
+	{
+		const XMFLOAT3& vertex = verts[faces[f + 0] - 1];
+		const XMFLOAT2& uv = texCs[faces[f + 1] - 1];
+		const XMFLOAT3& normal = norms[faces[f + 2] - 1];
+		model[vIndex] = { vertex.x, vertex.y, vertex.z, uv.x, uv.y, normal.x, normal.y, normal.z };
+	}
+	return true;
+}
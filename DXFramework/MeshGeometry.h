@@ -0,0 +1,60 @@
+/**
+* \class MeshGeometry
+*
+* \brief Builds the framework meshes' vertices and indices on the CPU, for the mesh classes to upload
+*
+* The cube, sphere, plane and quad shapes, and the triangle list a basic OBJ file unrolls to. Does not touch D3D, so
+* geometry can be generated and checked without a device.
+*/
+
+// Mesh geometry
+// Each builder fills arrays the caller sized from the matching count; indices run 0, 1, 2... except the quad's.
+
+#ifndef _MESHGEOMETRY_H_
+#define _MESHGEOMETRY_H_
+
+#include <DirectXMath.h>
+#include <vector>
+
+using namespace DirectX;
+
+/// Position, texture coordinates and normal; the layout BaseMesh::VertexType uploads
+struct MeshVertex
+{
+	XMFLOAT3 position;
+	XMFLOAT2 texture;
+	XMFLOAT3 normal;
+};
+
+/// One corner of an OBJ face as the file has it, right handed; Model turns it left handed
+struct ObjVertex
+{
+	float x, y, z;
+	float tu, tv;
+	float nx, ny, nz;
+};
+
+class MeshGeometry
+{
+public:
+	static int cubeVertexCount(int resolution) { return ((6 * resolution) * resolution) * 6; }	///< Also the sphere's
+	static int planeVertexCount(int resolution) { return (resolution - 1) * (resolution - 1) * 6; }
+	static const int quadVertexCount = 4;
+	static const int quadIndexCount = 6;
+
+	static void buildCube(int resolution, MeshVertex* vertices, unsigned long* indices);
+	static void buildSphere(int resolution, MeshVertex* vertices, unsigned long* indices);	///< The cube, bent onto the unit sphere
+	static void buildPlane(int resolution, MeshVertex* vertices, unsigned long* indices);
+	static void buildQuad(MeshVertex* vertices, unsigned long* indices);
+
+	/** \brief Reads an OBJ file of v/vt/vn triangle faces into one vertex per face corner
+	*
+	* Lines other than v, vt, vn and f are skipped, as are corners past a face's third.
+	* @param filename is the OBJ file to read
+	* @param model receives the corners, three to a face
+	* @return false if the file could not be opened or a face is not v/vt/vn corners indexing what came before; model is left empty then
+	*/
+	static bool loadObj(const char* filename, std::vector<ObjVertex>& model);
+};
+
+#endif
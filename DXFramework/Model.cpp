@@ -1,6 +1,7 @@
 // Model mesh and load
 // Loads a .obj and creates a mesh object from the data
 #include "model.h"
+#include "FrameArena.h"
 
 // load model datat, initialise buffers (with model data) and load texture.
 Model::Model(ID3D11Device* device, ID3D11DeviceContext* deviceContext, const char* filename)
@@ -19,6 +20,7 @@ Model::~Model()
 	{
 		delete[] model;
 		model = 0;
+		MemoryTracker::free(MemoryTag::Models, sizeof(ModelType) * vertexCount);
 	}
 }
 
@@ -31,8 +33,10 @@ void Model::initBuffers(ID3D11Device* device)
 	D3D11_BUFFER_DESC vertexBufferDesc, indexBufferDesc;
 	D3D11_SUBRESOURCE_DATA vertexData, indexData;
 		
-	vertices = new VertexType[vertexCount];
-	indices = new unsigned long[indexCount];
+	// Scratch arrays, given back when initBuffers returns
+	ScratchScope scratch;
+	vertices = scratch.allocate<VertexType>(vertexCount);
+	indices = scratch.allocate<unsigned long>(indexCount);
 	
 	// Load the vertex array and index array with data.
 	for (int i = 0; i<vertexCount; i++)
@@ -71,13 +75,7 @@ void Model::initBuffers(ID3D11Device* device)
 	indexData.SysMemSlicePitch = 0;
 	// Create the index buffer.
 	device->CreateBuffer(&indexBufferDesc, &indexData, &indexBuffer);
-	
-	// Release the arrays now that the vertex and index buffers have been created and loaded.
-	delete[] vertices;
-	vertices = 0;
-
-	delete[] indices;
-	indices = 0;
+	trackBuffers(MemoryTag::Models);
 }
 
 //// Read model file and parse data.
@@ -221,104 +219,19 @@ void Model::initBuffers(ID3D11Device* device)
 //	faces.clear();
 //}
 
-// Modified from a mulit-threaded version by Mark Ropper (CGT).
+// Read model file through MeshGeometry's OBJ reader. A file it can't read leaves an empty model.
 void Model::loadModel(const char* filename)
 {
-	std::vector<XMFLOAT3> verts;
-	std::vector<XMFLOAT3> norms;
-	std::vector<XMFLOAT2> texCs;
-	std::vector<unsigned int> faces;
-
-	FILE* file;// = fopen(filename, "r");
-	errno_t err;
-	err = fopen_s(&file, filename, "r");
-	if(err != 0)
-	//if (file == NULL)
-	{
-		return;
-	}
-
-	while (true)
-	{
-		char lineHeader[128];
-
-		// Read first word of the line
-		int res = fscanf_s(file, "%s", lineHeader, (int)sizeof(lineHeader));
-		if (res == EOF)
-		{
-			break; // exit loop
-		}
-		else // Parse
-		{
-			if (strcmp(lineHeader, "v") == 0) // Vertex
-			{
-				XMFLOAT3 vertex;
-				fscanf_s(file, "%f %f %f\n", &vertex.x, &vertex.y, &vertex.z);
-				verts.push_back(vertex);
-			}
-			else if (strcmp(lineHeader, "vt") == 0) // Tex Coord
-			{
-				XMFLOAT2 uv;
-				fscanf_s(file, "%f %f\n", &uv.x, &uv.y);
-				texCs.push_back(uv);
-			}
-			else if (strcmp(lineHeader, "vn") == 0) // Normal
-			{
-				XMFLOAT3 normal;
-				fscanf_s(file, "%f %f %f\n", &normal.x, &normal.y, &normal.z);
-				norms.push_back(normal);
-			}
-			else if (strcmp(lineHeader, "f") == 0) // Face
-			{
-				unsigned int face[9];
-				int matches = fscanf_s(file, "%d/%d/%d %d/%d/%d %d/%d/%d\n", &face[0], &face[1], &face[2],
-																			&face[3], &face[4], &face[5],
-																			&face[6], &face[7], &face[8]);
-				if (matches != 9)
-				{
-					// Parser error, or not triangle faces
-					return;
-				}
-
-				for (int i = 0; i < 9; i++)
-				{
-					faces.push_back(face[i]);
-				}
-
+	std::vector<ObjVertex> corners;
+	MeshGeometry::loadObj(filename, corners);
 
-			}
-		}
-	}
-
-	int vIndex = 0, nIndex = 0, tIndex = 0;
-	int numFaces = (int)faces.size() / 9;
-
-	//// Create the model using the vertex count that was read in.
-	vertexCount = numFaces * 3;
+	// Create the model using the vertex count that was read in.
+	vertexCount = (int)corners.size();
 	model = new ModelType[vertexCount];
-
-	// "Unroll" the loaded obj information into a list of triangles.
-	for (int f = 0; f < (int)faces.size(); f += 3)
+	MemoryTracker::allocate(MemoryTag::Models, sizeof(ModelType) * vertexCount);
+	for (int i = 0; i < vertexCount; i++)
 	{
-		model[vIndex].x = verts[(faces[f + 0] - 1)].x;
-		model[vIndex].y = verts[(faces[f + 0] - 1)].y;
-		model[vIndex].z = verts[(faces[f + 0] - 1)].z;
-		model[vIndex].tu = texCs[(faces[f + 1] - 1)].x;
-		model[vIndex].tv = texCs[(faces[f + 1] - 1)].y;
-		model[vIndex].nx = norms[(faces[f + 2] - 1)].x;
-		model[vIndex].ny = norms[(faces[f + 2] - 1)].y;
-		model[vIndex].nz = norms[(faces[f + 2] - 1)].z;
-
-		//increase index count
-		vIndex++;
-
+		model[i] = corners[i];
 	}
-	indexCount = vIndex;
-
-
-	verts.clear();
-	norms.clear();
-	texCs.clear();
-	faces.clear();
-
+	indexCount = vertexCount;
 }
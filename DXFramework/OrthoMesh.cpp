@@ -2,6 +2,7 @@
 // 2D quad mesh for post processing, should render a quad to match window size
 
 #include "orthomesh.h"
+#include "FrameArena.h"
 
 // Store geometry dimensions, initialise buffers and loadTexture (null as texture is provided from a rendertarget).
 OrthoMesh::OrthoMesh(ID3D11Device* device, ID3D11DeviceContext* deviceContext, int lwidth, int lheight, int lxPosition, int lyPosition)
@@ -44,8 +45,10 @@ void OrthoMesh::initBuffers(ID3D11Device* device)
 	vertexCount = 6;
 	indexCount = vertexCount;
 
-	vertices = new VertexType[vertexCount];
-	indices = new unsigned long[indexCount];
+	// Scratch arrays, given back when initBuffers returns
+	ScratchScope scratch;
+	vertices = scratch.allocate<VertexType>(vertexCount);
+	indices = scratch.allocate<unsigned long>(indexCount);
 	
 	// Load the vertex array with data.
 	vertices[0].position = XMFLOAT3(left, bottom, 0.0f);  // Bottom left.
@@ -100,11 +103,5 @@ void OrthoMesh::initBuffers(ID3D11Device* device)
 	indexData.SysMemSlicePitch = 0;
 	// Create the index buffer.
 	device->CreateBuffer(&indexBufferDesc, &indexData, &indexBuffer);
-	
-	// Release the arrays now that the vertex and index buffers have been created and loaded.
-	delete[] vertices;
-	vertices = 0;
-
-	delete[] indices;
-	indices = 0;
+	trackBuffers();
 }
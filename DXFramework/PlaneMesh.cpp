@@ -1,6 +1,8 @@
 // plane mesh
 // Quad mesh made of many quads. Default is 100x100
 #include "planemesh.h"
+#include "FrameArena.h"
+#include "MeshGeometry.h"
 
 // Initialise buffer and load texture.
 PlaneMesh::PlaneMesh(ID3D11Device* device, ID3D11DeviceContext* deviceContext, int lresolution)
@@ -21,99 +23,20 @@ void PlaneMesh::initBuffers(ID3D11Device* device)
 {
 	VertexType* vertices;
 	unsigned long* indices;
-	int index, i, j;
-	float positionX, positionZ, u, v, increment;
 	D3D11_BUFFER_DESC vertexBufferDesc, indexBufferDesc;
 	D3D11_SUBRESOURCE_DATA vertexData, indexData;
 
 	// Calculate the number of vertices in the terrain mesh.
-	vertexCount = (resolution - 1) * (resolution - 1) * 6;
+	vertexCount = MeshGeometry::planeVertexCount(resolution);
 
 
 	indexCount = vertexCount;
-	vertices = new VertexType[vertexCount];
-	indices = new unsigned long[indexCount];
+	// Scratch arrays, given back when initBuffers returns
+	ScratchScope scratch;
+	vertices = scratch.allocate<VertexType>(vertexCount);
+	indices = scratch.allocate<unsigned long>(indexCount);
 
-
-	index = 0;
-	// UV coords.
-	u = 0;
-	v = 0;
-	increment = 1.0f / resolution;
-
-	for (j = 0; j < (resolution - 1); j++)
-	{
-		for (i = 0; i < (resolution - 1); i++)
-		{
-			// Upper left.
-			positionX = (float)i;
-			positionZ = (float)(j);
-
-			vertices[index].position = XMFLOAT3(positionX, 0.0f, positionZ);
-			vertices[index].texture = XMFLOAT2(u, v);
-			vertices[index].normal = XMFLOAT3(0.0, 1.0, 0.0);
-			indices[index] = index;
-			index++;
-
-			// Upper right.
-			positionX = (float)(i + 1);
-			positionZ = (float)(j + 1);
-
-			vertices[index].position = XMFLOAT3(positionX, 0.0f, positionZ);
-			vertices[index].texture = XMFLOAT2(u + increment, v + increment);
-			vertices[index].normal = XMFLOAT3(0.0, 1.0, 0.0);
-			indices[index] = index;
-			index++;
-
-
-			// lower left
-			positionX = (float)(i);
-			positionZ = (float)(j + 1);
-
-
-			vertices[index].position = XMFLOAT3(positionX, 0.0f, positionZ);
-			vertices[index].texture = XMFLOAT2(u, v + increment);
-			vertices[index].normal = XMFLOAT3(0.0, 1.0, 0.0);
-			indices[index] = index;
-			index++;
-
-			// Upper left
-			positionX = (float)(i);
-			positionZ = (float)(j);
-
-			vertices[index].position = XMFLOAT3(positionX, 0.0f, positionZ);
-			vertices[index].texture = XMFLOAT2(u, v);
-			vertices[index].normal = XMFLOAT3(0.0, 1.0, 0.0);
-			indices[index] = index;
-			index++;
-
-			// Bottom right
-			positionX = (float)(i + 1);
-			positionZ = (float)(j);
-
-			vertices[index].position = XMFLOAT3(positionX, 0.0f, positionZ);
-			vertices[index].texture = XMFLOAT2(u + increment, v);
-			vertices[index].normal = XMFLOAT3(0.0, 1.0, 0.0);
-			indices[index] = index;
-			index++;
-
-			// Upper right.
-			positionX = (float)(i + 1);
-			positionZ = (float)(j + 1);
-
-			vertices[index].position = XMFLOAT3(positionX, 0.0f, positionZ);
-			vertices[index].texture = XMFLOAT2(u + increment, v + increment);
-			vertices[index].normal = XMFLOAT3(0.0, 1.0, 0.0);
-			indices[index] = index;
-			index++;
-
-			u += increment;
-
-		}
-
-		u = 0;
-		v += increment;
-	}
+	MeshGeometry::buildPlane(resolution, vertices, indices);
 
 	// Set up the description of the static vertex buffer.
 	vertexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
@@ -142,10 +65,5 @@ void PlaneMesh::initBuffers(ID3D11Device* device)
 	indexData.SysMemSlicePitch = 0;
 	// Create the index buffer.
 	device->CreateBuffer(&indexBufferDesc, &indexData, &indexBuffer);
-
-	// Release the arrays now that the buffers have been created and loaded.
-	delete[] vertices;
-	vertices = 0;
-	delete[] indices;
-	indices = 0;
+	trackBuffers();
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 // For geometry shader demonstration.
 // Note sendData() override.
 #include "pointmesh.h"
+#include "FrameArena.h"
 
 // Initialise buffers and load texture.
 PointMesh::PointMesh(ID3D11Device* device, ID3D11DeviceContext* deviceContext)
@@ -28,8 +29,10 @@ void PointMesh::initBuffers(ID3D11Device* device)
 	indexCount = 3;
 
 
-	vertices = new VertexType[vertexCount];
-	indices = new unsigned long[indexCount];
+	// Scratch arrays, given back when initBuffers returns
+	ScratchScope scratch;
+	vertices = scratch.allocate<VertexType>(vertexCount);
+	indices = scratch.allocate<unsigned long>(indexCount);
 
 	// Load the vertex array with data.
 	vertices[0].position = XMFLOAT3(0.0f, 1.0f, 0.0f);  // Top.
@@ -76,13 +79,7 @@ void PointMesh::initBuffers(ID3D11Device* device)
 	indexData.SysMemSlicePitch = 0;
 	// Create the index buffer.
 	device->CreateBuffer(&indexBufferDesc, &indexData, &indexBuffer);
-
-	// Release the arrays now that the vertex and index buffers have been created and loaded.
-	delete[] vertices;
-	vertices = 0;
-
-	delete[] indices;
-	indices = 0;
+	trackBuffers();
 }
 
 // Override sendData()
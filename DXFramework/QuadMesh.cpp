@@ -1,6 +1,8 @@
 // Quad Mesh
 // Simple unit quad mesh with texture coordinates and normals.
 #include "quadmesh.h"
+#include "FrameArena.h"
+#include "MeshGeometry.h"
 
 // Initialise buffers and lad texture.
 QuadMesh::QuadMesh(ID3D11Device* device, ID3D11DeviceContext* deviceContext)
@@ -24,38 +26,16 @@ void QuadMesh::initBuffers(ID3D11Device* device)
 	D3D11_BUFFER_DESC vertexBufferDesc, indexBufferDesc;
 	D3D11_SUBRESOURCE_DATA vertexData, indexData;
 	
-	vertexCount = 4;
-	indexCount = 6;
+	vertexCount = MeshGeometry::quadVertexCount;
+	indexCount = MeshGeometry::quadIndexCount;
 
 
-	vertices = new VertexType[vertexCount];
-	indices = new unsigned long[indexCount];
+	// Scratch arrays, given back when initBuffers returns
+	ScratchScope scratch;
+	vertices = scratch.allocate<VertexType>(vertexCount);
+	indices = scratch.allocate<unsigned long>(indexCount);
 
-	// Load the vertex array with data.
-	vertices[0].position = XMFLOAT3(-1.0f, -1.0f, 0.0f);  // Bottom left.
-	vertices[0].texture = XMFLOAT2(0.0f, 1.0f);
-	vertices[0].normal = XMFLOAT3(0.0f, 0.0f, -1.0f);
-
-	vertices[1].position = XMFLOAT3(-1.0f, 1.0f, 0.0f);  // Top left.
-	vertices[1].texture = XMFLOAT2(0.0f, 0.0f);
-	vertices[1].normal = XMFLOAT3(0.0f, 0.0f, -1.0f);
-
-	vertices[2].position = XMFLOAT3(1.0f, 1.0f, 0.0f);  // Top right.
-	vertices[2].texture = XMFLOAT2(1.0f, 0.0f);
-	vertices[2].normal = XMFLOAT3(0.0f, 0.0f, -1.0f);
-
-	vertices[3].position = XMFLOAT3(1.0f, -1.0f, 0.0f);  // Bottom right.
-	vertices[3].texture = XMFLOAT2(1.0f, 1.0f);
-	vertices[3].normal = XMFLOAT3(0.0f, 0.0f, -1.0f);
-
-	// Load the index array with data.
-	indices[0] = 0;  // Bottom left.
-	indices[1] = 2;  // Top right.
-	indices[2] = 1;  // Top left.
-
-	indices[3] = 0;	// bottom left
-	indices[4] = 3;	// bottom right
-	indices[5] = 2;	// top right
+	MeshGeometry::buildQuad(vertices, indices);
 
 	// Set up the description of the static vertex buffer.
 	vertexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
@@ -84,11 +64,6 @@ void QuadMesh::initBuffers(ID3D11Device* device)
 	indexData.SysMemSlicePitch = 0;
 	// Create the index buffer.
 	device->CreateBuffer(&indexBufferDesc, &indexData, &indexBuffer);
-	
-	// Release the arrays now that the vertex and index buffers have been created and loaded.
-	delete[] vertices;
-	vertices = 0;
-	delete[] indices;
-	indices = 0;
+	trackBuffers();
 }
 
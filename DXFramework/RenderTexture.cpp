@@ -1,6 +1,10 @@
 // render texture
 // alternative render target
 #include "rendertexture.h"
+#include "MemoryTracker.h"
+
+// R32G32B32A32 colour and D24S8 depth, per texel
+static const size_t bytesPerTexel = 16 + 4;
 
 // Initialise texture object based on provided dimensions. Usually to match window.
 RenderTexture::RenderTexture(ID3D11Device* device, int ltextureWidth, int ltextureHeight, float screenNear, float screenFar)
@@ -72,6 +76,7 @@ RenderTexture::RenderTexture(ID3D11Device* device, int ltextureWidth, int ltextu
 
 	// Create the depth stencil view.
 	result = device->CreateDepthStencilView(depthStencilBuffer, &depthStencilViewDesc, &depthStencilView);
+	MemoryTracker::allocateGpu(MemoryTag::Rendering, GpuMemory::RenderTarget, (size_t)textureWidth * textureHeight * bytesPerTexel);
 	
 	// Setup the viewport for rendering.
 	viewport.Width = (float)textureWidth;
@@ -91,6 +96,8 @@ RenderTexture::RenderTexture(ID3D11Device* device, int ltextureWidth, int ltextu
 // Release resources.
 RenderTexture::~RenderTexture()
 {
+	MemoryTracker::freeGpu(MemoryTag::Rendering, GpuMemory::RenderTarget, (size_t)textureWidth * textureHeight * bytesPerTexel);
+
 	if (depthStencilView)
 	{
 		depthStencilView->Release();
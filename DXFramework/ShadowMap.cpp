@@ -1,4 +1,8 @@
 #include "ShadowMap.h"
+#include "MemoryTracker.h"
+
+// R24G8, per texel
+static const size_t bytesPerTexel = 4;
 
 ShadowMap::ShadowMap(ID3D11Device* device, int mWidth, int mHeight)
 {
@@ -34,6 +38,7 @@ ShadowMap::ShadowMap(ID3D11Device* device, int mWidth, int mHeight)
 	srvDesc.Texture2D.MipLevels = texDesc.MipLevels;
 	srvDesc.Texture2D.MostDetailedMip = 0;
 	device->CreateShaderResourceView(depthMap, &srvDesc, &mDepthMapSRV);
+	MemoryTracker::allocateGpu(MemoryTag::Rendering, GpuMemory::RenderTarget, (size_t)mWidth * mHeight * bytesPerTexel);
 
 	// Setup the viewport for rendering.
 	viewport.Width = (float)mWidth;
@@ -49,6 +54,7 @@ ShadowMap::ShadowMap(ID3D11Device* device, int mWidth, int mHeight)
 
 ShadowMap::~ShadowMap()
 {
+	MemoryTracker::freeGpu(MemoryTag::Rendering, GpuMemory::RenderTarget, (size_t)viewport.Width * (size_t)viewport.Height * bytesPerTexel);
 	delete mDepthMapDSV;
 	delete mDepthMapSRV;
 }
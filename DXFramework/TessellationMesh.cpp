@@ -2,6 +2,7 @@
 // Builds a simple triangle mesh for tessellation demonstration
 // Overrides sendData() function for different primitive topology
 #include "tessellationmesh.h"
+#include "FrameArena.h"
 
 // initialise buffers and load texture.
 TessellationMesh::TessellationMesh(ID3D11Device* device, ID3D11DeviceContext* deviceContext)
@@ -27,8 +28,10 @@ void TessellationMesh::initBuffers(ID3D11Device* device)
 	vertexCount = 3;
 	indexCount = 3;
 
-	vertices = new VertexType[vertexCount];
-	indices = new unsigned long[indexCount];
+	// Scratch arrays, given back when initBuffers returns
+	ScratchScope scratch;
+	vertices = scratch.allocate<VertexType>(vertexCount);
+	indices = scratch.allocate<unsigned long>(indexCount);
 
 	// Load the vertex array with data.
 	vertices[0].position = XMFLOAT3(0.0f, 1.0f, 0.0f);  // Top.
@@ -75,12 +78,7 @@ void TessellationMesh::initBuffers(ID3D11Device* device)
 	indexData.SysMemSlicePitch = 0;
 	// Create the index buffer.
 	device->CreateBuffer(&indexBufferDesc, &indexData, &indexBuffer);
-
-	// Release the arrays now that the vertex and index buffers have been created and loaded.
-	delete[] vertices;
-	vertices = 0;
-	delete[] indices;
-	indices = 0;
+	trackBuffers();
 }
 
 // Override sendData() to change topology type. Control point patch list is required for tessellation.
@@ -2,7 +2,91 @@
 // Loads and stores a single texture.
 // Handles .dds, .png and .jpg (probably).
 #include "TextureManager.h"
+#include "DTK\include\dds.h"
+#include "MemoryTracker.h"
+#include "BlockDecoder.h"
+#include <wincodec.h>
+#include <algorithm>
 
+#pragma comment(lib, "windowscodecs.lib")
+
+namespace
+{
+	// COM for the calling thread while in scope. The streaming workers have already joined the multithreaded
+	// apartment, and a thread that joined another one (RPC_E_CHANGED_MODE) can still use WIC, so only a
+	// successful call here is undone.
+	class ComScope
+	{
+	public:
+		ComScope() : initialised(SUCCEEDED(CoInitializeEx(NULL, COINIT_MULTITHREADED))) {}
+		~ComScope() { if (initialised) CoUninitialize(); }
+		ComScope(const ComScope&) = delete;
+		ComScope& operator=(const ComScope&) = delete;
+
+	private:
+		bool initialised;
+	};
+
+	// Offline-baked sibling written by Tools/TextureBaker, e.g. res/moon.jpg -> res/moon.dds
+	std::wstring bakedSibling(const std::wstring& filename)
+	{
+		std::wstring::size_type idx = filename.rfind('.');
+		if (idx == std::wstring::npos || filename.substr(idx + 1) == L"dds")
+		{
+			return std::wstring();
+		}
+		return filename.substr(0, idx) + L".dds";
+	}
+
+	bool isBlockCompressed(DXGI_FORMAT format)
+	{
+		return format == DXGI_FORMAT_BC1_UNORM || format == DXGI_FORMAT_BC1_UNORM_SRGB ||
+			format == DXGI_FORMAT_BC3_UNORM || format == DXGI_FORMAT_BC3_UNORM_SRGB ||
+			format == DXGI_FORMAT_BC7_UNORM || format == DXGI_FORMAT_BC7_UNORM_SRGB;
+	}
+
+	UINT levelPitch(DXGI_FORMAT format, UINT width)
+	{
+		if (isBlockCompressed(format))
+		{
+			const UINT blockBytes = (format == DXGI_FORMAT_BC1_UNORM || format == DXGI_FORMAT_BC1_UNORM_SRGB) ? 8 : 16;
+			return std::max(1u, (width + 3) / 4) * blockBytes;
+		}
+		return width * 4;
+	}
+
+	UINT levelRows(DXGI_FORMAT format, UINT height)
+	{
+		return isBlockCompressed(format) ? std::max(1u, (height + 3) / 4) : height;
+	}
+
+	// VRAM estimate for a loaded view, summed over its mip chain (non-BC formats counted at 4 bytes per texel)
+	size_t textureBytes(ID3D11ShaderResourceView* view)
+	{
+		size_t bytes = 0;
+		ID3D11Resource* resource = NULL;
+		ID3D11Texture2D* texture2D = NULL;
+		view->GetResource(&resource);
+		if (resource && SUCCEEDED(resource->QueryInterface(IID_PPV_ARGS(&texture2D))))
+		{
+			D3D11_TEXTURE2D_DESC desc;
+			texture2D->GetDesc(&desc);
+			UINT width = desc.Width, height = desc.Height;
+			for (UINT level = 0; level < desc.MipLevels; ++level)
+			{
+				bytes += (size_t)levelPitch(desc.Format, width) * levelRows(desc.Format, height) * desc.ArraySize;
+				width = std::max(1u, width / 2);
+				height = std::max(1u, height / 2);
+			}
+			texture2D->Release();
+		}
+		if (resource)
+		{
+			resource->Release();
+		}
+		return bytes;
+	}
+}
 
  //Attempt to load texture. If load fails use default texture.
  //Based on extension, uses slightly different loading function for different image types .dds vs .png/.jpg.
@@ -10,31 +94,155 @@ TextureManager::TextureManager(ID3D11Device* ldevice, ID3D11DeviceContext* ldevi
 {
 	device = ldevice;
 	deviceContext = ldeviceContext;
+	texture = 0;
+	pTexture = 0;
+	memoryBudget = 512 * 1024 * 1024;
+	memoryUsage = 0;
+	frame = 0;
+	streaming = false;
+	pendingDecodes = 0;
 	addDefaultTexture();
 }
 
-void TextureManager::loadTexture(const wchar_t* uid, const wchar_t* filename)
+// Release resource.
+TextureManager::~TextureManager()
 {
-	HRESULT result;
+	stopStreaming();
+	for (TextureHandle handle = 0; handle < textures.size(); ++handle)
+	{
+		unload(handle);
+	}
+	texture = 0;
+	pTexture = 0;
+}
+
+TextureHandle TextureManager::intern(const wchar_t* uid)
+{
+	std::wstring name(uid ? uid : L"");
+	auto found = handles.find(name);
+	if (found != handles.end())
+	{
+		return found->second;
+	}
+
+	TextureEntry entry = {};
+	entry.uid = name;
+	entry.state = TextureState::Unloaded;
+	entry.lastUsedFrame = frame;
+	textures.push_back(entry);
+
+	const TextureHandle handle = (TextureHandle)(textures.size() - 1);
+	handles.emplace(name, handle);
+	return handle;
+}
 
+TextureHandle TextureManager::loadTexture(const wchar_t* uid, const wchar_t* filename)
+{
 	// check if file exists
-	if (!filename)
+	if (!filename || !does_file_exist(filename))
 	{
 		//filename = L"../res/DefaultDiffuse.png";
 		MessageBox(NULL, L"Texture filename does not exist", L"ERROR", MB_OK);
-		return;
+		return defaultTexture;
 	}
-	// if not set default texture
-	if (!does_file_exist(filename))
+
+	TextureHandle handle = intern(uid);
+	if (handle == defaultTexture)
 	{
-		// change default texture
-		//filename = L"../res/DefaultDiffuse.png";
-		MessageBox(NULL, L"Texture filename does not exist", L"ERROR", MB_OK);
-		return;
+		return defaultTexture;
+	}
+
+	TextureEntry& entry = textures[handle];
+	entry.refCount++;
+	if (entry.filename == filename && entry.state != TextureState::Unloaded)
+	{
+		return handle;
+	}
+
+	// Same name pointed at a new file: drop the old data
+	unload(handle);
+	entry.filename = filename;
+	entry.lastUsedFrame = frame;
+	requestLoad(handle);
+	return handle;
+}
+
+TextureHandle TextureManager::getHandle(const wchar_t* uid)
+{
+	auto found = handles.find(uid ? uid : L"");
+	return (found != handles.end()) ? found->second : defaultTexture;
+}
+
+// Return texture as a shader resource.
+ID3D11ShaderResourceView* TextureManager::getTexture(TextureHandle handle)
+{
+	if (handle >= textures.size())
+	{
+		return textures[defaultTexture].view;
+	}
+
+	TextureEntry& entry = textures[handle];
+	entry.lastUsedFrame = frame;
+	entry.uses++;
+
+	if (entry.state == TextureState::Unloaded && !entry.filename.empty())
+	{
+		// Evicted earlier and needed again
+		requestLoad(handle);
 	}
 
+	if (entry.view && entry.visible)
+	{
+		// texture exists
+		return entry.view;
+	}
+	return textures[defaultTexture].view;
+}
+
+ID3D11ShaderResourceView* TextureManager::getTexture(const wchar_t* uid)
+{
+	return getTexture(getHandle(uid));
+}
+
+void TextureManager::addRef(TextureHandle handle)
+{
+	if (handle < textures.size())
+	{
+		textures[handle].refCount++;
+	}
+}
+
+void TextureManager::release(TextureHandle handle)
+{
+	if (handle != defaultTexture && handle < textures.size() && textures[handle].refCount > 0)
+	{
+		textures[handle].refCount--;
+	}
+}
+
+void TextureManager::requestLoad(TextureHandle handle)
+{
+	TextureEntry& entry = textures[handle];
+	if (streaming)
+	{
+		entry.state = TextureState::Decoding;
+		pendingDecodes++;
+		streamQueue.push((int)handle, entry.filename, entry.priorityBias);
+	}
+	else
+	{
+		loadTextureImmediate(handle);
+	}
+}
+
+void TextureManager::loadTextureImmediate(TextureHandle handle)
+{
+	HRESULT result;
+	TextureEntry& entry = textures[handle];
+	ID3D11ShaderResourceView* view = NULL;
+
 	// check file extension for correct loading function.
-	std::wstring fn(filename);
+	const std::wstring& fn = entry.filename;
 	std::string::size_type idx;
 	std::wstring extension;
 
@@ -49,47 +257,103 @@ void TextureManager::loadTexture(const wchar_t* uid, const wchar_t* filename)
 		// No extension found
 	}
 
-	// Load the texture in.
-	if (extension == L"dds")
+	// Prefer an offline-baked sibling (Tools/TextureBaker): BC-compressed with a full mip chain,
+	// so it skips the WIC decode at startup and takes a fraction of the VRAM.
+	result = E_FAIL;
+	std::wstring baked = bakedSibling(fn);
+	if (!baked.empty() && does_file_exist(baked.c_str()))
 	{
-		result = CreateDDSTextureFromFile(device, deviceContext, filename, NULL, &texture);
+		result = CreateDDSTextureFromFile(device, deviceContext, baked.c_str(), NULL, &view);
 	}
-	else
+
+	// Load the texture in.
+	if (FAILED(result))
 	{
-		result = CreateWICTextureFromFile(device, deviceContext, filename, NULL, &texture, 0);
+		if (extension == L"dds")
+		{
+			result = CreateDDSTextureFromFile(device, deviceContext, fn.c_str(), NULL, &view);
+		}
+		else
+		{
+			result = CreateWICTextureFromFile(device, deviceContext, fn.c_str(), NULL, &view, 0);
+		}
 	}
-	
+
 	if (FAILED(result))
 	{
 		MessageBox(NULL, L"Texture loading error", L"ERROR", MB_OK);
+		entry.state = TextureState::Failed;
 	}
 	else
 	{
-		textureMap.insert(std::make_pair(const_cast<wchar_t*>(uid), texture));
+		entry.view = view;
+		entry.visible = true;
+		entry.state = TextureState::Resident;
+		entry.bytes = textureBytes(view);
+		memoryUsage += entry.bytes;
+		MemoryTracker::allocateGpu(MemoryTag::Textures, GpuMemory::Texture, entry.bytes);
 	}
 }
 
-// Release resource.
-TextureManager::~TextureManager()
+void TextureManager::unload(TextureHandle handle)
 {
-	if (texture)
+	TextureEntry& entry = textures[handle];
+	residency.remove((int)handle);
+
+	if (entry.view)
 	{
-		texture->Release();
-		texture = 0;
+		entry.view->Release();
+		entry.view = NULL;
+	}
+	if (entry.resource)
+	{
+		entry.resource->Release();
+		entry.resource = NULL;
+	}
+	for (const auto& level : entry.levels)
+	{
+		if (!level.data.empty())
+		{
+			MemoryTracker::free(MemoryTag::Textures, level.data.size());
+		}
+	}
+	entry.levels.clear();
+	entry.visible = false;
+	memoryUsage -= entry.bytes;
+	if (entry.bytes)
+	{
+		MemoryTracker::freeGpu(MemoryTag::Textures, GpuMemory::Texture, entry.bytes);
+	}
+	entry.bytes = 0;
+	if (entry.state != TextureState::Decoding)
+	{
+		entry.state = TextureState::Unloaded;
 	}
 }
 
-// Return texture as a shader resource.
-ID3D11ShaderResourceView* TextureManager::getTexture(const wchar_t* uid)
+// Runs before frame moves on, so textures drawn in the frame just finished read as idle 0 and are never released
+void TextureManager::evictOverBudget()
 {
-	if (textureMap.find(const_cast<wchar_t*>(uid)) != textureMap.end())
+	std::vector<TextureEvictionCandidate> candidates;
+	for (TextureHandle handle = 1; handle < textures.size(); ++handle)
 	{
-		// texture exists
-		return textureMap.at(const_cast<wchar_t*>(uid));
+		const TextureEntry& entry = textures[handle];
+		if (entry.state == TextureState::Resident || entry.state == TextureState::Uploading)
+		{
+			candidates.push_back({ (int)handle, entry.lastUsedFrame, entry.refCount > 0 });
+		}
 	}
-	else
+
+	while (memoryUsage > memoryBudget)
 	{
-		return textureMap.at(L"default");
+		const int victim = pickEvictionVictim(candidates, frame, evictionDelay);
+		if (victim < 0)
+		{
+			return;
+		}
+		unload((TextureHandle)candidates[victim].id);
+		candidates[victim] = candidates.back();
+		candidates.pop_back();
 	}
 }
 
@@ -139,7 +403,454 @@ void TextureManager::addDefaultTexture()
 		SRVDesc.Texture2D.MipLevels = 1;
 
 		hr = device->CreateShaderResourceView(pTexture, &SRVDesc, &texture);
-		textureMap.insert(std::make_pair(const_cast < wchar_t*>(L"default"), texture));
 	}
-	
-}
\ No newline at end of file
+
+	// Always handle 0, so failed lookups can index straight into the table
+	TextureHandle handle = intern(L"default");
+	TextureEntry& entry = textures[handle];
+	entry.state = TextureState::Resident;
+	entry.resource = pTexture;
+	entry.view = texture;
+	entry.visible = true;
+	entry.refCount = 1;
+	entry.bytes = sizeof(uint32_t);
+	memoryUsage += entry.bytes;
+	MemoryTracker::allocateGpu(MemoryTag::Textures, GpuMemory::Texture, entry.bytes);
+
+}
+
+
+/*****************************    Streaming    ************************************/
+
+void TextureManager::setStreaming(bool enabled, int workerCount)
+{
+	if (enabled == streaming)
+	{
+		return;
+	}
+
+	if (!enabled)
+	{
+		// Finish everything already queued so no texture is left bound to the default
+		while (pendingDecodes > 0 || !residency.isEmpty())
+		{
+			update();
+			std::this_thread::yield();
+		}
+		stopStreaming();
+		return;
+	}
+
+	streaming = true;
+	streamQueue.reopen();
+	workerCount = std::max(1, workerCount);
+	for (int i = 0; i < workerCount; ++i)
+	{
+		workers.emplace_back(&TextureManager::workerLoop, this);
+	}
+}
+
+void TextureManager::stopStreaming()
+{
+	streamQueue.close();
+	for (auto& worker : workers)
+	{
+		worker.join();
+	}
+	workers.clear();
+	decodedResults.clear();
+	pendingDecodes = 0;
+	streaming = false;
+
+	// Anything still waiting on a worker loads on its next use instead
+	for (auto& entry : textures)
+	{
+		if (entry.state == TextureState::Decoding)
+		{
+			entry.state = TextureState::Unloaded;
+		}
+	}
+}
+
+void TextureManager::setStreamingPriority(TextureHandle handle, float priority)
+{
+	if (handle < textures.size())
+	{
+		textures[handle].priorityBias = priority;
+	}
+}
+
+bool TextureManager::isResident(TextureHandle handle) const
+{
+	return handle < textures.size() && textures[handle].state == TextureState::Resident;
+}
+
+void TextureManager::workerLoop()
+{
+	// WIC objects are created per thread
+	CoInitializeEx(NULL, COINIT_MULTITHREADED);
+
+	TextureStreamJob job;
+	while (streamQueue.pop(job))
+	{
+		DecodedTexture decoded;
+		decoded.handle = (TextureHandle)job.id;
+		decoded.filename = job.filename;
+		decoded.succeeded = decodeTexture(job.filename, decoded);
+
+		std::lock_guard<std::mutex> lock(decodedMutex);
+		decodedResults.push_back(std::move(decoded));
+	}
+
+	CoUninitialize();
+}
+
+// The baked sibling when there is one, as loadTexture and the streaming decoder pick it, so CPU copies read the texels
+// the GPU samples rather than the source image the bake started from
+bool TextureManager::decodePixels(const std::wstring& filename, UINT& width, UINT& height, std::vector<uint8_t>& rgba)
+{
+	const std::wstring path = resolveFile(filename);
+	std::wstring::size_type idx = path.rfind('.');
+	if (idx == std::wstring::npos || path.substr(idx + 1) != L"dds")
+	{
+		return decodeWIC(path, width, height, rgba);
+	}
+
+	DecodedTexture dds;
+	if (!readDDS(path, dds))
+	{
+		return false;
+	}
+
+	const DecodedLevel& top = dds.levels.front();
+	width = top.width;
+	height = top.height;
+	rgba.resize((size_t)width * 4 * height);
+	switch (dds.format)
+	{
+	case DXGI_FORMAT_BC1_UNORM:
+	case DXGI_FORMAT_BC1_UNORM_SRGB:
+		return BlockDecoder::decode(BlockFormat::BC1, top.data.data(), width, height, rgba.data(), width * 4);
+	case DXGI_FORMAT_BC3_UNORM:
+	case DXGI_FORMAT_BC3_UNORM_SRGB:
+		return BlockDecoder::decode(BlockFormat::BC3, top.data.data(), width, height, rgba.data(), width * 4);
+	case DXGI_FORMAT_BC7_UNORM:
+	case DXGI_FORMAT_BC7_UNORM_SRGB:
+		return BlockDecoder::decode(BlockFormat::BC7, top.data.data(), width, height, rgba.data(), width * 4);
+	default:
+		rgba = top.data;	// RGBA8, rows already tightly packed
+		return true;
+	}
+}
+
+std::wstring TextureManager::resolveFile(const std::wstring& filename)
+{
+	std::wstring baked = bakedSibling(filename);
+	if (!baked.empty() && does_file_exist(baked.c_str()))
+	{
+		return baked;
+	}
+	return filename;
+}
+
+bool TextureManager::decodeWIC(const std::wstring& filename, UINT& width, UINT& height, std::vector<uint8_t>& rgba)
+{
+	IWICImagingFactory* factory = NULL;
+	IWICBitmapDecoder* decoder = NULL;
+	IWICBitmapFrameDecode* frame = NULL;
+	IWICFormatConverter* converter = NULL;
+	width = height = 0;
+	ComScope com;	// decodePixels runs on the main thread, which nothing else joins to COM
+
+	HRESULT result = CoCreateInstance(CLSID_WICImagingFactory, NULL, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&factory));
+	if (SUCCEEDED(result)) result = factory->CreateDecoderFromFilename(filename.c_str(), NULL, GENERIC_READ, WICDecodeMetadataCacheOnDemand, &decoder);
+	if (SUCCEEDED(result)) result = decoder->GetFrame(0, &frame);
+	if (SUCCEEDED(result)) result = frame->GetSize(&width, &height);
+	if (SUCCEEDED(result)) result = factory->CreateFormatConverter(&converter);
+	if (SUCCEEDED(result)) result = converter->Initialize(frame, GUID_WICPixelFormat32bppRGBA, WICBitmapDitherTypeNone, NULL, 0.0, WICBitmapPaletteTypeCustom);
+
+	if (SUCCEEDED(result))
+	{
+		rgba.resize((size_t)width * 4 * height);
+		result = converter->CopyPixels(NULL, width * 4, (UINT)rgba.size(), rgba.data());
+	}
+
+	if (converter) converter->Release();
+	if (frame) frame->Release();
+	if (decoder) decoder->Release();
+	if (factory) factory->Release();
+	return SUCCEEDED(result);
+}
+
+// Decodes into a full CPU mip chain. Baked .dds files already carry their mips; anything else goes through
+// WIC and gets a box-filtered chain so the residency scheduler has small levels to upload first.
+bool TextureManager::decodeTexture(const std::wstring& filename, DecodedTexture& out)
+{
+	const std::wstring path = resolveFile(filename);
+	std::wstring::size_type idx = path.rfind('.');
+	if (idx != std::wstring::npos && path.substr(idx + 1) == L"dds")
+	{
+		return readDDS(path, out);
+	}
+
+	DecodedLevel top;
+	if (!decodeWIC(path, top.width, top.height, top.data))
+	{
+		return false;
+	}
+	top.rowPitch = top.width * 4;
+	out.format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	out.levels.push_back(std::move(top));
+
+	// 2x2 box filter down to 1x1, clamping the odd row/column, same as GenerateMips does for UNORM
+	while (out.levels.back().width > 1 || out.levels.back().height > 1)
+	{
+		const DecodedLevel& src = out.levels.back();
+		DecodedLevel dst;
+		dst.width = std::max(1u, src.width / 2);
+		dst.height = std::max(1u, src.height / 2);
+		dst.rowPitch = dst.width * 4;
+		dst.data.resize((size_t)dst.rowPitch * dst.height);
+
+		for (UINT y = 0; y < dst.height; ++y)
+		{
+			const uint8_t* row0 = src.data.data() + (size_t)std::min(y * 2, src.height - 1) * src.rowPitch;
+			const uint8_t* row1 = src.data.data() + (size_t)std::min(y * 2 + 1, src.height - 1) * src.rowPitch;
+			uint8_t* out8 = dst.data.data() + (size_t)y * dst.rowPitch;
+			for (UINT x = 0; x < dst.width; ++x)
+			{
+				const UINT x0 = std::min(x * 2, src.width - 1) * 4;
+				const UINT x1 = std::min(x * 2 + 1, src.width - 1) * 4;
+				for (int c = 0; c < 4; ++c)
+				{
+					out8[x * 4 + c] = (uint8_t)((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) / 4);
+				}
+			}
+		}
+		out.levels.push_back(std::move(dst));
+	}
+	return true;
+}
+
+// Reads a .dds file's levels as they are stored, still block compressed, for upload or for BlockDecoder
+bool TextureManager::readDDS(const std::wstring& path, DecodedTexture& out)
+{
+	std::ifstream file(path, std::ios::binary);
+	std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	if (bytes.size() < sizeof(uint32_t) + sizeof(DDS_HEADER) || *reinterpret_cast<const uint32_t*>(bytes.data()) != DDS_MAGIC)
+	{
+		return false;
+	}
+
+	const DDS_HEADER* header = reinterpret_cast<const DDS_HEADER*>(bytes.data() + sizeof(uint32_t));
+	size_t offset = sizeof(uint32_t) + sizeof(DDS_HEADER);
+	if ((header->flags & DDS_HEADER_FLAGS_VOLUME) || header->caps2 != 0)
+	{
+		return false;	// Volumes and cube maps keep using DDSTextureLoader
+	}
+
+	const DDS_PIXELFORMAT& pf = header->ddspf;
+	if ((pf.flags & DDS_FOURCC) && pf.fourCC == MAKEFOURCC('D', 'X', '1', '0'))
+	{
+		if (bytes.size() < offset + sizeof(DDS_HEADER_DXT10))
+		{
+			return false;
+		}
+		const DDS_HEADER_DXT10* dx10 = reinterpret_cast<const DDS_HEADER_DXT10*>(bytes.data() + offset);
+		offset += sizeof(DDS_HEADER_DXT10);
+		if (dx10->arraySize > 1 || (dx10->miscFlag & DDS_RESOURCE_MISC_TEXTURECUBE))
+		{
+			return false;
+		}
+		out.format = dx10->dxgiFormat;
+		if (!isBlockCompressed(out.format) && out.format != DXGI_FORMAT_R8G8B8A8_UNORM && out.format != DXGI_FORMAT_R8G8B8A8_UNORM_SRGB)
+		{
+			return false;
+		}
+	}
+	else if ((pf.flags & DDS_FOURCC) && pf.fourCC == MAKEFOURCC('D', 'X', 'T', '1'))
+	{
+		out.format = DXGI_FORMAT_BC1_UNORM;
+	}
+	else if ((pf.flags & DDS_FOURCC) && pf.fourCC == MAKEFOURCC('D', 'X', 'T', '5'))
+	{
+		out.format = DXGI_FORMAT_BC3_UNORM;
+	}
+	else if ((pf.flags & DDS_RGB) && pf.RGBBitCount == 32 && pf.RBitMask == 0x000000ff && pf.GBitMask == 0x0000ff00 && pf.BBitMask == 0x00ff0000)
+	{
+		out.format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	}
+	else
+	{
+		return false;
+	}
+
+	UINT width = header->width, height = header->height;
+	const UINT mipCount = std::max(1u, (UINT)header->mipMapCount);
+	for (UINT level = 0; level < mipCount; ++level)
+	{
+		DecodedLevel mip;
+		mip.width = width;
+		mip.height = height;
+		mip.rowPitch = levelPitch(out.format, width);
+		const size_t size = (size_t)mip.rowPitch * levelRows(out.format, height);
+		if (offset + size > bytes.size())
+		{
+			return false;
+		}
+		mip.data.assign(bytes.begin() + offset, bytes.begin() + offset + size);
+		offset += size;
+		out.levels.push_back(std::move(mip));
+
+		width = std::max(1u, width / 2);
+		height = std::max(1u, height / 2);
+	}
+	return true;
+}
+
+
+// Allocates the full mip chain up front and clamps sampling with SetResourceMinLOD, so levels can be filled
+// in any order without recreating the view.
+void TextureManager::createStreamedResource(DecodedTexture& decoded)
+{
+	TextureEntry& entry = textures[decoded.handle];
+	const DecodedLevel& top = decoded.levels.front();
+
+	D3D11_TEXTURE2D_DESC desc = {};
+	desc.Width = top.width;
+	desc.Height = top.height;
+	desc.MipLevels = (UINT)decoded.levels.size();
+	desc.ArraySize = 1;
+	desc.Format = decoded.format;
+	desc.SampleDesc.Count = 1;
+	desc.Usage = D3D11_USAGE_DEFAULT;
+	desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+	HRESULT result = device->CreateTexture2D(&desc, NULL, &entry.resource);
+	if (SUCCEEDED(result))
+	{
+		D3D11_SHADER_RESOURCE_VIEW_DESC SRVDesc = {};
+		SRVDesc.Format = decoded.format;
+		SRVDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+		SRVDesc.Texture2D.MipLevels = desc.MipLevels;
+		result = device->CreateShaderResourceView(entry.resource, &SRVDesc, &entry.view);
+	}
+
+	if (FAILED(result))
+	{
+		if (entry.resource)
+		{
+			entry.resource->Release();
+			entry.resource = NULL;
+		}
+		MessageBox(NULL, L"Texture loading error", L"ERROR", MB_OK);
+		entry.state = TextureState::Failed;
+		return;
+	}
+
+	deviceContext->SetResourceMinLOD(entry.resource, (float)(desc.MipLevels - 1));
+
+	std::vector<size_t> levelBytes;
+	entry.bytes = 0;
+	for (const auto& level : decoded.levels)
+	{
+		levelBytes.push_back(level.data.size());
+		entry.bytes += level.data.size();
+		MemoryTracker::allocate(MemoryTag::Textures, level.data.size());	// Staged on the CPU until uploaded
+	}
+	memoryUsage += entry.bytes;
+	MemoryTracker::allocateGpu(MemoryTag::Textures, GpuMemory::Texture, entry.bytes);
+
+	residency.add((int)decoded.handle, levelBytes);
+	entry.levels = std::move(decoded.levels);
+	entry.state = TextureState::Uploading;
+}
+
+void TextureManager::update()
+{
+	if (streaming)
+	{
+		std::vector<DecodedTexture> results;
+		{
+			std::lock_guard<std::mutex> lock(decodedMutex);
+			results.swap(decodedResults);
+		}
+
+		for (auto& decoded : results)
+		{
+			pendingDecodes--;
+			const TextureEntry& entry = textures[decoded.handle];
+			if (entry.state != TextureState::Decoding || entry.filename != decoded.filename)
+			{
+				continue;	// Unloaded or re-pointed at another file while the worker was busy
+			}
+
+			if (decoded.succeeded && !decoded.levels.empty())
+			{
+				createStreamedResource(decoded);
+			}
+			else
+			{
+				// Formats the streamer does not parse fall back to the blocking loaders
+				loadTextureImmediate(decoded.handle);
+			}
+		}
+
+		// Textures drawn last frame are refined first
+		for (TextureHandle handle = 1; handle < textures.size(); ++handle)
+		{
+			TextureEntry& entry = textures[handle];
+			const float priority = (float)entry.uses + entry.priorityBias;
+			if (entry.state == TextureState::Uploading)
+			{
+				residency.setPriority((int)handle, priority);
+			}
+			else if (entry.state == TextureState::Decoding)
+			{
+				streamQueue.setPriority((int)handle, priority);
+			}
+		}
+
+		std::vector<MipResidencyScheduler::Upload> uploads;
+		residency.schedule(uploadBudget, uploads);
+
+		for (const auto& upload : uploads)
+		{
+			TextureEntry& entry = textures[upload.id];
+			DecodedLevel& level = entry.levels[upload.level];
+			const UINT subresource = D3D11CalcSubresource(upload.level, 0, (UINT)entry.levels.size());
+			deviceContext->UpdateSubresource(entry.resource, subresource, NULL, level.data.data(), level.rowPitch, 0);
+			MemoryTracker::free(MemoryTag::Textures, level.data.size());
+			std::vector<uint8_t>().swap(level.data);
+			residency.markResident(upload.id, upload.level);
+		}
+
+		for (const auto& upload : uploads)
+		{
+			TextureEntry& entry = textures[upload.id];
+			if (entry.state != TextureState::Uploading)
+			{
+				continue;
+			}
+
+			const int resident = residency.residentLevel(upload.id);
+			deviceContext->SetResourceMinLOD(entry.resource, (float)resident);
+			entry.visible = true;
+
+			if (resident == 0)
+			{
+				residency.remove(upload.id);
+				entry.levels.clear();
+				entry.state = TextureState::Resident;
+			}
+		}
+	}
+
+	for (auto& entry : textures)
+	{
+		entry.uses = 0;
+	}
+
+	evictOverBudget();
+	frame++;
+}
@@ -0,0 +1,258 @@
+// Texture streaming
+// Decode job queue and mip upload scheduling for TextureManager's streaming mode.
+#include "TextureStreaming.h"
+#include <algorithm>
+
+TextureStreamQueue::TextureStreamQueue()
+{
+	nextSequence = 0;
+	closed = false;
+}
+
+void TextureStreamQueue::push(int id, const std::wstring& filename, float priority)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (closed)
+		{
+			return;
+		}
+		jobs.push_back({ id, filename, priority, nextSequence++ });
+	}
+	available.notify_one();
+}
+
+void TextureStreamQueue::setPriority(int id, float priority)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	for (auto& job : jobs)
+	{
+		if (job.id == id)
+		{
+			job.priority = priority;
+		}
+	}
+}
+
+bool TextureStreamQueue::pop(TextureStreamJob& job)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	available.wait(lock, [this] { return closed || !jobs.empty(); });
+	return takeHighest(job);
+}
+
+bool TextureStreamQueue::tryPop(TextureStreamJob& job)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return takeHighest(job);
+}
+
+void TextureStreamQueue::close()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		closed = true;
+		jobs.clear();
+	}
+	available.notify_all();
+}
+
+void TextureStreamQueue::reopen()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	closed = false;
+}
+
+size_t TextureStreamQueue::size()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return jobs.size();
+}
+
+// Caller holds the lock. The queue only ever holds one job per scene texture, so a linear scan is cheaper
+// than keeping a heap consistent under setPriority.
+bool TextureStreamQueue::takeHighest(TextureStreamJob& job)
+{
+	if (closed || jobs.empty())
+	{
+		return false;
+	}
+
+	auto best = jobs.begin();
+	for (auto it = jobs.begin() + 1; it != jobs.end(); ++it)
+	{
+		if (it->priority > best->priority || (it->priority == best->priority && it->sequence < best->sequence))
+		{
+			best = it;
+		}
+	}
+
+	job = *best;
+	jobs.erase(best);
+	return true;
+}
+
+MipResidencyScheduler::MipResidencyScheduler()
+{
+}
+
+void MipResidencyScheduler::add(int id, const std::vector<size_t>& levelBytes)
+{
+	if (levelBytes.empty())
+	{
+		return;
+	}
+	remove(id);
+
+	Entry entry;
+	entry.id = id;
+	entry.levelBytes = levelBytes;
+	entry.resident = (int)levelBytes.size();
+	entry.scheduled = (int)levelBytes.size();
+	entry.priority = 0.0f;
+	textures.push_back(entry);
+}
+
+void MipResidencyScheduler::remove(int id)
+{
+	textures.erase(std::remove_if(textures.begin(), textures.end(), [id](const Entry& e) { return e.id == id; }), textures.end());
+}
+
+void MipResidencyScheduler::setPriority(int id, float priority)
+{
+	if (Entry* entry = find(id))
+	{
+		entry->priority = priority;
+	}
+}
+
+void MipResidencyScheduler::schedule(size_t byteBudget, std::vector<Upload>& uploads)
+{
+	size_t spent = 0;
+	bool issued = false;
+
+	auto fits = [&](size_t bytes) { return !issued || spent + bytes <= byteBudget; };
+	auto issue = [&](Entry& entry, int level) {
+		uploads.push_back({ entry.id, level });
+		spent += entry.levelBytes[level];
+		entry.scheduled = level;
+		issued = true;
+	};
+
+	std::vector<Entry*> order;
+	order.reserve(textures.size());
+	for (auto& entry : textures)
+	{
+		order.push_back(&entry);
+	}
+	std::stable_sort(order.begin(), order.end(), [](const Entry* a, const Entry* b) { return a->priority > b->priority; });
+
+	// Pass 1: get something on screen for every texture that has nothing yet
+	for (Entry* entry : order)
+	{
+		const int levels = (int)entry->levelBytes.size();
+		if (entry->scheduled != levels)
+		{
+			continue;
+		}
+
+		for (int level = levels - 1; level >= 0; --level)
+		{
+			const size_t bytes = entry->levelBytes[level];
+			if (level != levels - 1 && bytes > tailBytes)
+			{
+				break;
+			}
+			if (!fits(bytes))
+			{
+				return;
+			}
+			issue(*entry, level);
+		}
+	}
+
+	// Pass 2: refine in priority order, one level at a time
+	for (Entry* entry : order)
+	{
+		while (entry->scheduled > 0)
+		{
+			const int level = entry->scheduled - 1;
+			if (!fits(entry->levelBytes[level]))
+			{
+				return;
+			}
+			issue(*entry, level);
+		}
+	}
+}
+
+void MipResidencyScheduler::markResident(int id, int level)
+{
+	if (Entry* entry = find(id))
+	{
+		entry->resident = std::min(entry->resident, level);
+	}
+}
+
+int MipResidencyScheduler::residentLevel(int id) const
+{
+	const Entry* entry = find(id);
+	return entry ? entry->resident : noneResident;
+}
+
+bool MipResidencyScheduler::isComplete(int id) const
+{
+	const Entry* entry = find(id);
+	return !entry || entry->resident == 0;
+}
+
+MipResidencyScheduler::Entry* MipResidencyScheduler::find(int id)
+{
+	for (auto& entry : textures)
+	{
+		if (entry.id == id)
+		{
+			return &entry;
+		}
+	}
+	return nullptr;
+}
+
+const MipResidencyScheduler::Entry* MipResidencyScheduler::find(int id) const
+{
+	for (const auto& entry : textures)
+	{
+		if (entry.id == id)
+		{
+			return &entry;
+		}
+	}
+	return nullptr;
+}
+
+int pickEvictionVictim(const std::vector<TextureEvictionCandidate>& candidates, unsigned int frame, unsigned int evictionDelay)
+{
+	int victim = -1;
+	for (int i = 0; i < (int)candidates.size(); ++i)
+	{
+		const TextureEvictionCandidate& candidate = candidates[i];
+		const unsigned int idle = frame - candidate.lastUsedFrame;
+		if (idle == 0 || (candidate.referenced && idle < evictionDelay))
+		{
+			continue;
+		}
+
+		if (victim < 0)
+		{
+			victim = i;
+			continue;
+		}
+
+		const TextureEvictionCandidate& current = candidates[victim];
+		if (candidate.referenced != current.referenced ? !candidate.referenced : candidate.lastUsedFrame < current.lastUsedFrame)
+		{
+			victim = i;
+		}
+	}
+	return victim;
+}
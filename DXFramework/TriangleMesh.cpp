@@ -1,6 +1,7 @@
 // TriangleMesh.cpp
 // Simple triangle mesh for example purposes. With texture cooridnates and normals.
 #include "TriangleMesh.h"
+#include "FrameArena.h"
 
 // Initialise buffers and load texture.
 TriangleMesh::TriangleMesh(ID3D11Device* device, ID3D11DeviceContext* deviceContext)
@@ -32,8 +33,10 @@ void TriangleMesh::initBuffers(ID3D11Device* device)
 	vertexCount = 3;
 	indexCount = 3;
 
-	vertices = new VertexType[vertexCount];
-	indices = new unsigned long[indexCount];
+	// Scratch arrays, given back when initBuffers returns
+	ScratchScope scratch;
+	vertices = scratch.allocate<VertexType>(vertexCount);
+	indices = scratch.allocate<unsigned long>(indexCount);
 
 	// Load the vertex array with data.
 	vertices[0].position = XMFLOAT3(0.0f, 1.0f, 0.0f);  // Top.
@@ -85,12 +88,7 @@ void TriangleMesh::initBuffers(ID3D11Device* device)
 	//indexData.SysMemSlicePitch = 0;
 	// Create the index buffer.
 	device->CreateBuffer(&indexBufferDesc, &indexData, &indexBuffer);
-	
-	// Release the arrays now that the vertex and index buffers have been created and loaded.
-	delete[] vertices;
-	vertices = 0;
-	delete[] indices;
-	indices = 0;
+	trackBuffers();
 }
 
 
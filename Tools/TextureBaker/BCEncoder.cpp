@@ -0,0 +1,610 @@
+// BCEncoder.cpp
+// Endpoint fitting follows the usual principal-axis approach (van Waveren, "Real-Time DXT Compression",
+// Intel 2006): project the block onto its dominant colour axis, take the extremes, snap to the format
+// precision and pick the nearest palette entry per texel, then do one least-squares refit of the
+// endpoints for the chosen indices. BC7 uses mode 6 (one subset, RGBA 7.7.7.7 + p-bits, 4-bit indices),
+// which covers colour and alpha in a single pass and is what most real-time BC7 encoders ship first.
+
+#include "BCEncoder.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <emmintrin.h>
+
+namespace {
+
+	// 4x4 block as structure-of-arrays floats (0..255), one 16-texel row per channel
+	struct BlockSoA {
+		alignas(16) float c[4][16];
+	};
+
+	inline float hsum(__m128 v) {
+		__m128 shuf = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+		__m128 sums = _mm_add_ps(v, shuf);
+		shuf = _mm_movehl_ps(shuf, sums);
+		return _mm_cvtss_f32(_mm_add_ss(sums, shuf));
+	}
+
+	void loadBlock(const uint8_t rgba[64], BlockSoA& block) {
+		for (int i = 0; i < 16; ++i) {
+			for (int c = 0; c < 4; ++c) block.c[c][i] = rgba[i * 4 + c];
+		}
+	}
+
+	// Mean and dominant axis of the block over the first `channels` channels, via covariance + power iteration
+	void principalAxis(const BlockSoA& block, int channels, float mean[4], float axis[4]) {
+		for (int c = 0; c < channels; ++c) {
+			__m128 sum = _mm_setzero_ps();
+			for (int i = 0; i < 16; i += 4) sum = _mm_add_ps(sum, _mm_load_ps(&block.c[c][i]));
+			mean[c] = hsum(sum) * (1.0f / 16.0f);
+		}
+
+		float cov[4][4] = {};
+		for (int a = 0; a < channels; ++a) {
+			const __m128 ma = _mm_set1_ps(mean[a]);
+			for (int b = a; b < channels; ++b) {
+				const __m128 mb = _mm_set1_ps(mean[b]);
+				__m128 sum = _mm_setzero_ps();
+				for (int i = 0; i < 16; i += 4) {
+					const __m128 da = _mm_sub_ps(_mm_load_ps(&block.c[a][i]), ma);
+					const __m128 db = _mm_sub_ps(_mm_load_ps(&block.c[b][i]), mb);
+					sum = _mm_add_ps(sum, _mm_mul_ps(da, db));
+				}
+				cov[a][b] = cov[b][a] = hsum(sum);
+			}
+		}
+
+		// Start from the diagonal so a grey ramp converges immediately
+		for (int c = 0; c < 4; ++c) axis[c] = (c < channels) ? 1.0f : 0.0f;
+		for (int iteration = 0; iteration < 8; ++iteration) {
+			float next[4] = {};
+			for (int a = 0; a < channels; ++a) {
+				for (int b = 0; b < channels; ++b) next[a] += cov[a][b] * axis[b];
+			}
+			float length = 0.0f;
+			for (int c = 0; c < channels; ++c) length += next[c] * next[c];
+			if (length < 1e-12f) break;
+			length = 1.0f / sqrtf(length);
+			for (int c = 0; c < channels; ++c) axis[c] = next[c] * length;
+		}
+	}
+
+	// Projects every texel on the axis and returns the extreme points, inset slightly to reduce error on ramps
+	void fitEndpoints(const BlockSoA& block, int channels, float low[4], float high[4]) {
+		float mean[4] = {}, axis[4] = {};
+		principalAxis(block, channels, mean, axis);
+
+		__m128 minT = _mm_set1_ps(FLT_MAX);
+		__m128 maxT = _mm_set1_ps(-FLT_MAX);
+		for (int i = 0; i < 16; i += 4) {
+			__m128 t = _mm_setzero_ps();
+			for (int c = 0; c < channels; ++c) {
+				const __m128 d = _mm_sub_ps(_mm_load_ps(&block.c[c][i]), _mm_set1_ps(mean[c]));
+				t = _mm_add_ps(t, _mm_mul_ps(d, _mm_set1_ps(axis[c])));
+			}
+			minT = _mm_min_ps(minT, t);
+			maxT = _mm_max_ps(maxT, t);
+		}
+
+		alignas(16) float mins[4], maxs[4];
+		_mm_store_ps(mins, minT);
+		_mm_store_ps(maxs, maxT);
+		float tLow = std::min(std::min(mins[0], mins[1]), std::min(mins[2], mins[3]));
+		float tHigh = std::max(std::max(maxs[0], maxs[1]), std::max(maxs[2], maxs[3]));
+		const float inset = (tHigh - tLow) / 32.0f;
+		tLow += inset;
+		tHigh -= inset;
+
+		for (int c = 0; c < 4; ++c) {
+			low[c] = (c < channels) ? std::min(255.0f, std::max(0.0f, mean[c] + axis[c] * tLow)) : 255.0f;
+			high[c] = (c < channels) ? std::min(255.0f, std::max(0.0f, mean[c] + axis[c] * tHigh)) : 255.0f;
+		}
+	}
+
+	// Solves the 2x2 normal equations for endpoints given per-texel interpolation weights (fraction of `high`)
+	bool leastSquaresEndpoints(const BlockSoA& block, int channels, const float weights[16], float low[4], float high[4]) {
+		float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+		float ax[4] = {}, bx[4] = {};
+		for (int i = 0; i < 16; ++i) {
+			const float b = weights[i];
+			const float a = 1.0f - b;
+			aa += a * a;
+			ab += a * b;
+			bb += b * b;
+			for (int c = 0; c < channels; ++c) {
+				ax[c] += a * block.c[c][i];
+				bx[c] += b * block.c[c][i];
+			}
+		}
+
+		const float det = aa * bb - ab * ab;
+		if (fabsf(det) < 1e-6f) return false;
+		const float invDet = 1.0f / det;
+
+		for (int c = 0; c < channels; ++c) {
+			low[c] = std::min(255.0f, std::max(0.0f, (ax[c] * bb - bx[c] * ab) * invDet));
+			high[c] = std::min(255.0f, std::max(0.0f, (bx[c] * aa - ax[c] * ab) * invDet));
+		}
+		return true;
+	}
+
+	/*****************************    BC1    ************************************/
+
+	inline uint16_t pack565(const float c[3]) {
+		const int r = static_cast<int>(c[0] * (31.0f / 255.0f) + 0.5f);
+		const int g = static_cast<int>(c[1] * (63.0f / 255.0f) + 0.5f);
+		const int b = static_cast<int>(c[2] * (31.0f / 255.0f) + 0.5f);
+		return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+	}
+
+	inline void unpack565(uint16_t v, int out[3]) {
+		const int r = (v >> 11) & 31, g = (v >> 5) & 63, b = v & 31;
+		out[0] = (r << 3) | (r >> 2);
+		out[1] = (g << 2) | (g >> 4);
+		out[2] = (b << 3) | (b >> 2);
+	}
+
+	void bc1Palette(uint16_t c0, uint16_t c1, int palette[4][3]) {
+		unpack565(c0, palette[0]);
+		unpack565(c1, palette[1]);
+		for (int c = 0; c < 3; ++c) {
+			palette[2][c] = (2 * palette[0][c] + palette[1][c] + 1) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c] + 1) / 3;
+		}
+	}
+
+	// Picks the nearest of the four palette entries for every texel, four texels per iteration.
+	// Returns the summed squared error; indices are packed two bits per texel.
+	float bc1SelectIndices(const BlockSoA& block, uint16_t c0, uint16_t c1, uint32_t& indices) {
+		int palette[4][3];
+		bc1Palette(c0, c1, palette);
+
+		indices = 0;
+		float totalError = 0.0f;
+		for (int i = 0; i < 16; i += 4) {
+			const __m128 r = _mm_load_ps(&block.c[0][i]);
+			const __m128 g = _mm_load_ps(&block.c[1][i]);
+			const __m128 b = _mm_load_ps(&block.c[2][i]);
+
+			__m128 best = _mm_set1_ps(FLT_MAX);
+			__m128i bestIndex = _mm_setzero_si128();
+			for (int p = 0; p < 4; ++p) {
+				const __m128 dr = _mm_sub_ps(r, _mm_set1_ps(static_cast<float>(palette[p][0])));
+				const __m128 dg = _mm_sub_ps(g, _mm_set1_ps(static_cast<float>(palette[p][1])));
+				const __m128 db = _mm_sub_ps(b, _mm_set1_ps(static_cast<float>(palette[p][2])));
+				const __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dr, dr), _mm_mul_ps(dg, dg)), _mm_mul_ps(db, db));
+
+				const __m128 closer = _mm_cmplt_ps(d, best);
+				best = _mm_min_ps(d, best);
+				const __m128i mask = _mm_castps_si128(closer);
+				bestIndex = _mm_or_si128(_mm_and_si128(mask, _mm_set1_epi32(p)), _mm_andnot_si128(mask, bestIndex));
+			}
+
+			alignas(16) int chosen[4];
+			_mm_store_si128(reinterpret_cast<__m128i*>(chosen), bestIndex);
+			for (int k = 0; k < 4; ++k) indices |= static_cast<uint32_t>(chosen[k]) << ((i + k) * 2);
+			totalError += hsum(best);
+		}
+		return totalError;
+	}
+
+	void writeBC1(uint16_t c0, uint16_t c1, uint32_t indices, uint8_t out[8]) {
+		if (c0 == c1) {
+			indices = 0; // Equal endpoints would select 3-colour mode; index 0 is the solid colour
+		}
+		else if (c0 < c1) {
+			// 4-colour mode needs c0 > c1: swap endpoints, which swaps 0<->1 and 2<->3
+			std::swap(c0, c1);
+			indices ^= 0x55555555u;
+		}
+
+		out[0] = static_cast<uint8_t>(c0 & 0xff);
+		out[1] = static_cast<uint8_t>(c0 >> 8);
+		out[2] = static_cast<uint8_t>(c1 & 0xff);
+		out[3] = static_cast<uint8_t>(c1 >> 8);
+		memcpy(out + 4, &indices, 4);
+	}
+
+	void encodeColourBlock(const BlockSoA& block, uint8_t out[8]) {
+		float low[4], high[4];
+		fitEndpoints(block, 3, low, high);
+
+		uint16_t c0 = pack565(high), c1 = pack565(low);
+		uint32_t indices = 0;
+		float error = bc1SelectIndices(block, c0, c1, indices);
+
+		// One least-squares refit with the chosen indices; keep whichever is better
+		static const float weightOfC1[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+		float weights[16];
+		for (int i = 0; i < 16; ++i) weights[i] = weightOfC1[(indices >> (i * 2)) & 3];
+
+		float refinedC0[4], refinedC1[4];
+		if (leastSquaresEndpoints(block, 3, weights, refinedC0, refinedC1)) {
+			const uint16_t r0 = pack565(refinedC0), r1 = pack565(refinedC1);
+			uint32_t refinedIndices = 0;
+			const float refinedError = bc1SelectIndices(block, r0, r1, refinedIndices);
+			if (refinedError < error) {
+				c0 = r0;
+				c1 = r1;
+				indices = refinedIndices;
+			}
+		}
+
+		writeBC1(c0, c1, indices, out);
+	}
+
+	/*****************************    BC3 alpha    ************************************/
+
+	void encodeAlphaBlock(const BlockSoA& block, uint8_t out[8]) {
+		float minA = 255.0f, maxA = 0.0f;
+		for (int i = 0; i < 16; ++i) {
+			minA = std::min(minA, block.c[3][i]);
+			maxA = std::max(maxA, block.c[3][i]);
+		}
+
+		const int a0 = static_cast<int>(maxA + 0.5f);
+		const int a1 = static_cast<int>(minA + 0.5f);
+		memset(out, 0, 8);
+		out[0] = static_cast<uint8_t>(a0);
+		out[1] = static_cast<uint8_t>(a1);
+		if (a0 == a1) return;
+
+		// 8-value mode (a0 > a1): 0 = a0, 1 = a1, 2..7 interpolate from a0 towards a1
+		int palette[8] = { a0, a1 };
+		for (int k = 2; k < 8; ++k) palette[k] = ((8 - k) * a0 + (k - 1) * a1 + 3) / 7;
+
+		uint64_t bits = 0;
+		for (int i = 0; i < 16; ++i) {
+			const int a = static_cast<int>(block.c[3][i] + 0.5f);
+			int best = 0, bestError = INT32_MAX;
+			for (int k = 0; k < 8; ++k) {
+				const int error = abs(palette[k] - a);
+				if (error < bestError) { bestError = error; best = k; }
+			}
+			bits |= static_cast<uint64_t>(best) << (i * 3);
+		}
+		for (int b = 0; b < 6; ++b) out[2 + b] = static_cast<uint8_t>(bits >> (b * 8));
+	}
+
+	/*****************************    BC7 mode 6    ************************************/
+
+	const int BC7_WEIGHTS4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	struct BC7Mode6 {
+		int q[2][4];   // 7-bit endpoints
+		int p[2];      // p-bits
+		int indices[16];
+		float error;
+	};
+
+	// Nearest 4-bit index for an interpolation fraction in [0, 64]
+	struct BC7IndexLookup {
+		uint8_t nearest[65];
+		BC7IndexLookup() {
+			for (int t = 0; t <= 64; ++t) {
+				int best = 0;
+				for (int k = 1; k < 16; ++k) {
+					if (abs(BC7_WEIGHTS4[k] - t) < abs(BC7_WEIGHTS4[best] - t)) best = k;
+				}
+				nearest[t] = static_cast<uint8_t>(best);
+			}
+		}
+	};
+
+	const BC7IndexLookup& bc7Lookup() {
+		static const BC7IndexLookup instance;
+		return instance;
+	}
+
+	// Snaps endpoints to 7 bits for the given p-bits and picks indices by projecting onto the quantised segment
+	void bc7EvaluateMode6(const BlockSoA& block, const float low[4], const float high[4], int p0, int p1, BC7Mode6& result) {
+		result.p[0] = p0;
+		result.p[1] = p1;
+
+		int e[2][4];
+		for (int c = 0; c < 4; ++c) {
+			result.q[0][c] = std::min(127, std::max(0, static_cast<int>((low[c] - p0) * 0.5f + 0.5f)));
+			result.q[1][c] = std::min(127, std::max(0, static_cast<int>((high[c] - p1) * 0.5f + 0.5f)));
+			e[0][c] = (result.q[0][c] << 1) | p0;
+			e[1][c] = (result.q[1][c] << 1) | p1;
+		}
+
+		int palette[16][4];
+		for (int k = 0; k < 16; ++k) {
+			for (int c = 0; c < 4; ++c) palette[k][c] = ((64 - BC7_WEIGHTS4[k]) * e[0][c] + BC7_WEIGHTS4[k] * e[1][c] + 32) >> 6;
+		}
+
+		float dir[4], lengthSq = 0.0f;
+		for (int c = 0; c < 4; ++c) {
+			dir[c] = static_cast<float>(e[1][c] - e[0][c]);
+			lengthSq += dir[c] * dir[c];
+		}
+		const float scale = (lengthSq > 0.0f) ? 64.0f / lengthSq : 0.0f;
+		const BC7IndexLookup& lookup = bc7Lookup();
+
+		result.error = 0.0f;
+		for (int i = 0; i < 16; i += 4) {
+			__m128 t = _mm_setzero_ps();
+			for (int c = 0; c < 4; ++c) {
+				const __m128 d = _mm_sub_ps(_mm_load_ps(&block.c[c][i]), _mm_set1_ps(static_cast<float>(e[0][c])));
+				t = _mm_add_ps(t, _mm_mul_ps(d, _mm_set1_ps(dir[c])));
+			}
+			t = _mm_mul_ps(t, _mm_set1_ps(scale));
+			t = _mm_min_ps(_mm_max_ps(t, _mm_setzero_ps()), _mm_set1_ps(64.0f));
+
+			alignas(16) int fractions[4];
+			_mm_store_si128(reinterpret_cast<__m128i*>(fractions), _mm_cvtps_epi32(t));
+
+			for (int k = 0; k < 4; ++k) {
+				const int index = lookup.nearest[fractions[k]];
+				result.indices[i + k] = index;
+				for (int c = 0; c < 4; ++c) {
+					const float d = block.c[c][i + k] - palette[index][c];
+					result.error += d * d;
+				}
+			}
+		}
+	}
+
+	void bc7BestPBits(const BlockSoA& block, const float low[4], const float high[4], BC7Mode6& best) {
+		best.error = FLT_MAX;
+		for (int combo = 0; combo < 4; ++combo) {
+			BC7Mode6 candidate;
+			bc7EvaluateMode6(block, low, high, combo & 1, combo >> 1, candidate);
+			if (candidate.error < best.error) best = candidate;
+		}
+	}
+
+	// LSB-first bit writer over the 128-bit block
+	struct BitWriter {
+		uint8_t* data;
+		int position = 0;
+		explicit BitWriter(uint8_t* out) : data(out) { memset(data, 0, 16); }
+		void write(uint32_t value, int bits) {
+			for (int b = 0; b < bits; ++b, ++position) {
+				if (value & (1u << b)) data[position >> 3] |= static_cast<uint8_t>(1u << (position & 7));
+			}
+		}
+	};
+
+	struct BitReader {
+		const uint8_t* data;
+		int position = 0;
+		explicit BitReader(const uint8_t* in) : data(in) {}
+		uint32_t read(int bits) {
+			uint32_t value = 0;
+			for (int b = 0; b < bits; ++b, ++position) {
+				value |= static_cast<uint32_t>((data[position >> 3] >> (position & 7)) & 1) << b;
+			}
+			return value;
+		}
+	};
+
+	void gatherBlock(const ImageRGBA& image, int bx, int by, uint8_t rgba[64]) {
+		for (int y = 0; y < 4; ++y) {
+			const int sy = std::min(by * 4 + y, image.height - 1);
+			const uint8_t* row = image.row(sy);
+			for (int x = 0; x < 4; ++x) {
+				const int sx = std::min(bx * 4 + x, image.width - 1);
+				memcpy(rgba + (y * 4 + x) * 4, row + sx * 4, 4);
+			}
+		}
+	}
+}
+
+/*****************************    Encoders    ************************************/
+
+void BCEncoder::encodeBC1Block(const uint8_t rgba[64], uint8_t out[8]) {
+	BlockSoA block;
+	loadBlock(rgba, block);
+	encodeColourBlock(block, out);
+}
+
+void BCEncoder::encodeBC3Block(const uint8_t rgba[64], uint8_t out[16]) {
+	BlockSoA block;
+	loadBlock(rgba, block);
+	encodeAlphaBlock(block, out);
+	encodeColourBlock(block, out + 8);
+}
+
+void BCEncoder::encodeBC7Block(const uint8_t rgba[64], uint8_t out[16]) {
+	BlockSoA block;
+	loadBlock(rgba, block);
+
+	float low[4], high[4];
+	fitEndpoints(block, 4, low, high);
+
+	BC7Mode6 best;
+	bc7BestPBits(block, low, high, best);
+
+	// Least-squares refit on the chosen indices
+	float weights[16];
+	for (int i = 0; i < 16; ++i) weights[i] = BC7_WEIGHTS4[best.indices[i]] / 64.0f;
+	float refinedLow[4], refinedHigh[4];
+	if (leastSquaresEndpoints(block, 4, weights, refinedLow, refinedHigh)) {
+		BC7Mode6 refined;
+		bc7BestPBits(block, refinedLow, refinedHigh, refined);
+		if (refined.error < best.error) best = refined;
+	}
+
+	// The anchor (texel 0) index is stored with an implicit zero MSB
+	if (best.indices[0] & 8) {
+		for (int c = 0; c < 4; ++c) std::swap(best.q[0][c], best.q[1][c]);
+		std::swap(best.p[0], best.p[1]);
+		for (int i = 0; i < 16; ++i) best.indices[i] = 15 - best.indices[i];
+	}
+
+	BitWriter writer(out);
+	writer.write(1u << 6, 7); // mode 6
+	for (int c = 0; c < 4; ++c) {
+		writer.write(best.q[0][c], 7);
+		writer.write(best.q[1][c], 7);
+	}
+	writer.write(best.p[0], 1);
+	writer.write(best.p[1], 1);
+	writer.write(best.indices[0], 3);
+	for (int i = 1; i < 16; ++i) writer.write(best.indices[i], 4);
+}
+
+/*****************************    Decoders    ************************************/
+
+void BCEncoder::decodeBC1Block(const uint8_t in[8], uint8_t rgba[64]) {
+	const uint16_t c0 = static_cast<uint16_t>(in[0] | (in[1] << 8));
+	const uint16_t c1 = static_cast<uint16_t>(in[2] | (in[3] << 8));
+	uint32_t indices;
+	memcpy(&indices, in + 4, 4);
+
+	int palette[4][4];
+	int rgb0[3], rgb1[3];
+	unpack565(c0, rgb0);
+	unpack565(c1, rgb1);
+	for (int c = 0; c < 3; ++c) {
+		palette[0][c] = rgb0[c];
+		palette[1][c] = rgb1[c];
+		if (c0 > c1) {
+			palette[2][c] = (2 * rgb0[c] + rgb1[c] + 1) / 3;
+			palette[3][c] = (rgb0[c] + 2 * rgb1[c] + 1) / 3;
+		}
+		else {
+			palette[2][c] = (rgb0[c] + rgb1[c]) / 2;
+			palette[3][c] = 0;
+		}
+	}
+	palette[0][3] = palette[1][3] = palette[2][3] = 255;
+	palette[3][3] = (c0 > c1) ? 255 : 0;
+
+	for (int i = 0; i < 16; ++i) {
+		const int index = (indices >> (i * 2)) & 3;
+		for (int c = 0; c < 4; ++c) rgba[i * 4 + c] = static_cast<uint8_t>(palette[index][c]);
+	}
+}
+
+void BCEncoder::decodeBC3Block(const uint8_t in[16], uint8_t rgba[64]) {
+	decodeBC1Block(in + 8, rgba);
+
+	const int a0 = in[0], a1 = in[1];
+	int palette[8] = { a0, a1 };
+	if (a0 > a1) {
+		for (int k = 2; k < 8; ++k) palette[k] = ((8 - k) * a0 + (k - 1) * a1 + 3) / 7;
+	}
+	else {
+		for (int k = 2; k < 6; ++k) palette[k] = ((6 - k) * a0 + (k - 1) * a1 + 2) / 5;
+		palette[6] = 0;
+		palette[7] = 255;
+	}
+
+	uint64_t bits = 0;
+	for (int b = 0; b < 6; ++b) bits |= static_cast<uint64_t>(in[2 + b]) << (b * 8);
+	for (int i = 0; i < 16; ++i) rgba[i * 4 + 3] = static_cast<uint8_t>(palette[(bits >> (i * 3)) & 7]);
+}
+
+void BCEncoder::decodeBC7Block(const uint8_t in[16], uint8_t rgba[64]) {
+	if ((in[0] & 0x7f) != 0x40) {
+		// Only mode 6 is produced by this encoder; flag anything else loudly
+		for (int i = 0; i < 16; ++i) { rgba[i * 4 + 0] = 255; rgba[i * 4 + 1] = 0; rgba[i * 4 + 2] = 255; rgba[i * 4 + 3] = 255; }
+		return;
+	}
+
+	BitReader reader(in);
+	reader.read(7);
+	int q[2][4];
+	for (int c = 0; c < 4; ++c) {
+		q[0][c] = reader.read(7);
+		q[1][c] = reader.read(7);
+	}
+	const int p0 = reader.read(1);
+	const int p1 = reader.read(1);
+
+	int e[2][4];
+	for (int c = 0; c < 4; ++c) {
+		e[0][c] = (q[0][c] << 1) | p0;
+		e[1][c] = (q[1][c] << 1) | p1;
+	}
+
+	for (int i = 0; i < 16; ++i) {
+		const int index = reader.read(i == 0 ? 3 : 4);
+		const int w = BC7_WEIGHTS4[index];
+		for (int c = 0; c < 4; ++c) rgba[i * 4 + c] = static_cast<uint8_t>(((64 - w) * e[0][c] + w * e[1][c] + 32) >> 6);
+	}
+}
+
+/*****************************    Surfaces    ************************************/
+
+size_t BCEncoder::compressedSize(BCFormat format, int width, int height) {
+	const size_t blocksX = std::max(1, (width + 3) / 4);
+	const size_t blocksY = std::max(1, (height + 3) / 4);
+	return blocksX * blocksY * blockBytes(format);
+}
+
+void BCEncoder::encodeImage(const ImageRGBA& image, BCFormat format, std::vector<uint8_t>& out) {
+	const int blocksX = std::max(1, (image.width + 3) / 4);
+	const int blocksY = std::max(1, (image.height + 3) / 4);
+	const size_t stride = blockBytes(format);
+	out.resize(compressedSize(format, image.width, image.height));
+
+	uint8_t texels[64];
+	for (int by = 0; by < blocksY; ++by) {
+		for (int bx = 0; bx < blocksX; ++bx) {
+			gatherBlock(image, bx, by, texels);
+			uint8_t* dst = out.data() + (static_cast<size_t>(by) * blocksX + bx) * stride;
+			switch (format) {
+			case BCFormat::BC1: encodeBC1Block(texels, dst); break;
+			case BCFormat::BC3: encodeBC3Block(texels, dst); break;
+			case BCFormat::BC7: encodeBC7Block(texels, dst); break;
+			}
+		}
+	}
+}
+
+void BCEncoder::decodeImage(const uint8_t* data, BCFormat format, int width, int height, ImageRGBA& out) {
+	const int blocksX = std::max(1, (width + 3) / 4);
+	const int blocksY = std::max(1, (height + 3) / 4);
+	const size_t stride = blockBytes(format);
+	out.resize(width, height);
+
+	uint8_t texels[64];
+	for (int by = 0; by < blocksY; ++by) {
+		for (int bx = 0; bx < blocksX; ++bx) {
+			const uint8_t* src = data + (static_cast<size_t>(by) * blocksX + bx) * stride;
+			switch (format) {
+			case BCFormat::BC1: decodeBC1Block(src, texels); break;
+			case BCFormat::BC3: decodeBC3Block(src, texels); break;
+			case BCFormat::BC7: decodeBC7Block(src, texels); break;
+			}
+
+			for (int y = 0; y < 4 && by * 4 + y < height; ++y) {
+				for (int x = 0; x < 4 && bx * 4 + x < width; ++x) {
+					memcpy(out.row(by * 4 + y) + (bx * 4 + x) * 4, texels + (y * 4 + x) * 4, 4);
+				}
+			}
+		}
+	}
+}
+
+double BCEncoder::meanSquaredError(const ImageRGBA& source, const ImageRGBA& decoded, bool includeAlpha) {
+	double sum = 0.0;
+	size_t count = 0;
+	for (size_t i = 0; i < source.pixels.size(); ++i) {
+		if (!includeAlpha && (i & 3) == 3) continue;
+		const double d = static_cast<double>(source.pixels[i]) - decoded.pixels[i];
+		sum += d * d;
+		++count;
+	}
+	return sum / static_cast<double>(count);
+}
+
+double BCEncoder::psnr(double meanSquaredError) {
+	return (meanSquaredError <= 0.0) ? 99.0 : 10.0 * log10(255.0 * 255.0 / meanSquaredError);
+}
+
+double BCEncoder::minimumPSNR(BCFormat format) {
+	switch (format) {
+	case BCFormat::BC1: return 30.0;
+	case BCFormat::BC3: return 30.0;
+	case BCFormat::BC7: return 35.0;
+	}
+	return 0.0;
+}
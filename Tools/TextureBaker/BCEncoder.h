@@ -0,0 +1,42 @@
+// BCEncoder.h
+// CPU block compressor for the offline texture bake. Produces BC1 (opaque colour), BC3 (colour + smooth
+// alpha) and BC7 (high quality colour/alpha, mode 6 only) blocks that D3D11 samples natively.
+// Endpoint fitting and index selection are vectorised with SSE2, four texels per register.
+
+#pragma once
+#include "Image.h"
+
+enum class BCFormat {
+	BC1,
+	BC3,
+	BC7
+};
+
+class BCEncoder {
+public:
+	static size_t blockBytes(BCFormat format) { return format == BCFormat::BC1 ? 8 : 16; }
+	static size_t compressedSize(BCFormat format, int width, int height);
+
+	// Encodes a whole surface; partial edge blocks are padded by clamping to the last row/column
+	static void encodeImage(const ImageRGBA& image, BCFormat format, std::vector<uint8_t>& out);
+
+	// Reference decoder, used by the baker's --verify mode to report PSNR against the source
+	static void decodeImage(const uint8_t* data, BCFormat format, int width, int height, ImageRGBA& out);
+
+	// Error of a decoded level against its source, per channel compared, and the same as a PSNR in dB (99 when identical)
+	static double meanSquaredError(const ImageRGBA& source, const ImageRGBA& decoded, bool includeAlpha);
+	static double psnr(double meanSquaredError);
+
+	// Lowest PSNR --verify accepts over a whole mip chain. Small mips alone fall well below it on any detailed
+	// image, since a block then spans too many texels for four palette entries, so it is not a per-level limit.
+	static double minimumPSNR(BCFormat format);
+
+	// Single 4x4 blocks, texels in row-major RGBA8 order
+	static void encodeBC1Block(const uint8_t rgba[64], uint8_t out[8]);
+	static void encodeBC3Block(const uint8_t rgba[64], uint8_t out[16]);
+	static void encodeBC7Block(const uint8_t rgba[64], uint8_t out[16]);
+
+	static void decodeBC1Block(const uint8_t in[8], uint8_t rgba[64]);
+	static void decodeBC3Block(const uint8_t in[16], uint8_t rgba[64]);
+	static void decodeBC7Block(const uint8_t in[16], uint8_t rgba[64]);
+};
@@ -0,0 +1,152 @@
+// DDSWriter.cpp
+
+#include "DDSWriter.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+#pragma pack(push, 1)
+	struct DDSPixelFormat {
+		uint32_t size;
+		uint32_t flags;
+		uint32_t fourCC;
+		uint32_t rgbBitCount;
+		uint32_t rBitMask;
+		uint32_t gBitMask;
+		uint32_t bBitMask;
+		uint32_t aBitMask;
+	};
+
+	struct DDSHeader {
+		uint32_t size;
+		uint32_t flags;
+		uint32_t height;
+		uint32_t width;
+		uint32_t pitchOrLinearSize;
+		uint32_t depth;
+		uint32_t mipMapCount;
+		uint32_t reserved1[11];
+		DDSPixelFormat ddspf;
+		uint32_t caps;
+		uint32_t caps2;
+		uint32_t caps3;
+		uint32_t caps4;
+		uint32_t reserved2;
+	};
+
+	struct DDSHeaderDXT10 {
+		uint32_t dxgiFormat;
+		uint32_t resourceDimension;
+		uint32_t miscFlag;
+		uint32_t arraySize;
+		uint32_t miscFlags2;
+	};
+#pragma pack(pop)
+
+	static_assert(sizeof(DDSHeader) == 124, "DDS header must be 124 bytes");
+	static_assert(sizeof(DDSHeaderDXT10) == 20, "DX10 header must be 20 bytes");
+
+	constexpr uint32_t DDS_MAGIC = 0x20534444; // "DDS "
+	constexpr uint32_t DDS_FOURCC = 0x00000004;
+	constexpr uint32_t DDSD_CAPS = 0x1, DDSD_HEIGHT = 0x2, DDSD_WIDTH = 0x4, DDSD_PIXELFORMAT = 0x1000;
+	constexpr uint32_t DDSD_MIPMAPCOUNT = 0x20000, DDSD_LINEARSIZE = 0x80000;
+	constexpr uint32_t DDSCAPS_COMPLEX = 0x8, DDSCAPS_TEXTURE = 0x1000, DDSCAPS_MIPMAP = 0x400000;
+	constexpr uint32_t D3D10_RESOURCE_DIMENSION_TEXTURE2D = 3;
+
+	// DXGI_FORMAT values (dxgiformat.h)
+	constexpr uint32_t DXGI_BC1_UNORM = 71, DXGI_BC1_UNORM_SRGB = 72;
+	constexpr uint32_t DXGI_BC3_UNORM = 77, DXGI_BC3_UNORM_SRGB = 78;
+	constexpr uint32_t DXGI_BC7_UNORM = 98, DXGI_BC7_UNORM_SRGB = 99;
+
+	constexpr uint32_t makeFourCC(char a, char b, char c, char d) {
+		return static_cast<uint32_t>(static_cast<uint8_t>(a)) | (static_cast<uint32_t>(static_cast<uint8_t>(b)) << 8) |
+			(static_cast<uint32_t>(static_cast<uint8_t>(c)) << 16) | (static_cast<uint32_t>(static_cast<uint8_t>(d)) << 24);
+	}
+}
+
+uint32_t DDSWriter::dxgiFormat(BCFormat format, bool srgb) {
+	switch (format) {
+	case BCFormat::BC1: return srgb ? DXGI_BC1_UNORM_SRGB : DXGI_BC1_UNORM;
+	case BCFormat::BC3: return srgb ? DXGI_BC3_UNORM_SRGB : DXGI_BC3_UNORM;
+	case BCFormat::BC7: return srgb ? DXGI_BC7_UNORM_SRGB : DXGI_BC7_UNORM;
+	}
+	return 0;
+}
+
+bool DDSWriter::write(const std::string& path, BCFormat format, bool srgb, int width, int height, const std::vector<std::vector<uint8_t>>& mips) {
+	if (mips.empty()) return false;
+
+	DDSHeader header = {};
+	header.size = sizeof(DDSHeader);
+	header.flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT | DDSD_LINEARSIZE;
+	header.height = static_cast<uint32_t>(height);
+	header.width = static_cast<uint32_t>(width);
+	header.pitchOrLinearSize = static_cast<uint32_t>(mips[0].size());
+	header.mipMapCount = static_cast<uint32_t>(mips.size());
+	header.ddspf.size = sizeof(DDSPixelFormat);
+	header.ddspf.flags = DDS_FOURCC;
+	header.caps = DDSCAPS_TEXTURE | (mips.size() > 1 ? (DDSCAPS_COMPLEX | DDSCAPS_MIPMAP) : 0);
+
+	// Legacy FourCCs are always loaded as UNORM, so sRGB variants and BC7 need the DX10 header
+	const bool needsDX10 = srgb || format == BCFormat::BC7;
+	if (needsDX10) header.ddspf.fourCC = makeFourCC('D', 'X', '1', '0');
+	else header.ddspf.fourCC = (format == BCFormat::BC1) ? makeFourCC('D', 'X', 'T', '1') : makeFourCC('D', 'X', 'T', '5');
+
+	std::ofstream file(path, std::ios::binary);
+	if (!file) return false;
+
+	file.write(reinterpret_cast<const char*>(&DDS_MAGIC), sizeof(DDS_MAGIC));
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	if (needsDX10) {
+		DDSHeaderDXT10 dx10 = {};
+		dx10.dxgiFormat = dxgiFormat(format, srgb);
+		dx10.resourceDimension = D3D10_RESOURCE_DIMENSION_TEXTURE2D;
+		dx10.arraySize = 1;
+		file.write(reinterpret_cast<const char*>(&dx10), sizeof(dx10));
+	}
+
+	for (const auto& level : mips) file.write(reinterpret_cast<const char*>(level.data()), level.size());
+	return static_cast<bool>(file);
+}
+
+bool DDSWriter::read(const std::string& path, BCFormat& format, int& width, int& height, std::vector<std::vector<uint8_t>>& mips) {
+	std::ifstream file(path, std::ios::binary);
+	if (!file) return false;
+
+	uint32_t magic = 0;
+	DDSHeader header = {};
+	file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+	file.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if (!file || magic != DDS_MAGIC || header.size != sizeof(DDSHeader)) return false;
+
+	if (header.ddspf.fourCC == makeFourCC('D', 'X', '1', '0')) {
+		DDSHeaderDXT10 dx10 = {};
+		file.read(reinterpret_cast<char*>(&dx10), sizeof(dx10));
+		if (dx10.dxgiFormat == DXGI_BC1_UNORM || dx10.dxgiFormat == DXGI_BC1_UNORM_SRGB) format = BCFormat::BC1;
+		else if (dx10.dxgiFormat == DXGI_BC3_UNORM || dx10.dxgiFormat == DXGI_BC3_UNORM_SRGB) format = BCFormat::BC3;
+		else if (dx10.dxgiFormat == DXGI_BC7_UNORM || dx10.dxgiFormat == DXGI_BC7_UNORM_SRGB) format = BCFormat::BC7;
+		else return false;
+	}
+	else if (header.ddspf.fourCC == makeFourCC('D', 'X', 'T', '1')) format = BCFormat::BC1;
+	else if (header.ddspf.fourCC == makeFourCC('D', 'X', 'T', '5')) format = BCFormat::BC3;
+	else return false;
+
+	width = static_cast<int>(header.width);
+	height = static_cast<int>(header.height);
+	const uint32_t levels = std::max(1u, header.mipMapCount);
+
+	mips.clear();
+	int w = width, h = height;
+	for (uint32_t level = 0; level < levels; ++level) {
+		std::vector<uint8_t> data(BCEncoder::compressedSize(format, w, h));
+		file.read(reinterpret_cast<char*>(data.data()), data.size());
+		if (!file) return false;
+		mips.push_back(std::move(data));
+		w = std::max(1, w / 2);
+		h = std::max(1, h / 2);
+	}
+	return true;
+}
@@ -0,0 +1,21 @@
+// DDSWriter.h
+// Writes block-compressed mip chains in the layout DDSTextureLoader (DTK) reads: BC1/BC3 as legacy
+// DXT1/DXT5 FourCC files and BC7 through the DX10 extended header.
+// The structs mirror DTK's dds.h but are redeclared here because that header relies on MSVC-only
+// __declspec(selectany) and the baker has to build on Linux.
+
+#pragma once
+#include "BCEncoder.h"
+#include <string>
+#include <vector>
+
+class DDSWriter {
+public:
+	// Each entry in `mips` is one compressed level, largest first
+	static bool write(const std::string& path, BCFormat format, bool srgb, int width, int height, const std::vector<std::vector<uint8_t>>& mips);
+
+	// Parses a file written by write() back into its levels (used by --verify)
+	static bool read(const std::string& path, BCFormat& format, int& width, int& height, std::vector<std::vector<uint8_t>>& mips);
+
+	static uint32_t dxgiFormat(BCFormat format, bool srgb);
+};
@@ -0,0 +1,25 @@
+// Image.h
+// Plain RGBA8 image used by the texture baker, plus the loaders/savers the bake step needs.
+// Everything here is platform independent except the WIC path, which is only compiled on Windows.
+
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct ImageRGBA {
+	int width = 0;
+	int height = 0;
+	std::vector<uint8_t> pixels; // width * height * 4, row-major, RGBA order
+
+	bool empty() const { return width <= 0 || height <= 0; }
+	uint8_t* row(int y) { return pixels.data() + static_cast<size_t>(y) * width * 4; }
+	const uint8_t* row(int y) const { return pixels.data() + static_cast<size_t>(y) * width * 4; }
+	void resize(int w, int h) { width = w; height = h; pixels.assign(static_cast<size_t>(w) * h * 4, 255); }
+};
+
+// Loads .ppm (P6), .pam (P7 RGB/RGBA) and uncompressed .tga everywhere; .jpg/.png/.bmp through WIC on Windows.
+bool loadImage(const std::string& path, ImageRGBA& out, std::string& error);
+
+// Writes an uncompressed 32-bit .tga (used by --dump-mips and --verify for visual diffing).
+bool saveTGA(const std::string& path, const ImageRGBA& image);
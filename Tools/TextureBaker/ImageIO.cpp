@@ -0,0 +1,237 @@
+// ImageIO.cpp
+// Minimal image readers for the bake step. Netpbm and TGA are parsed by hand so the baker runs on the
+// Linux build machines without any imaging library; Windows additionally decodes JPG/PNG through WIC,
+// which is the same decoder TextureManager uses at runtime.
+
+#include "Image.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <wincodec.h>
+#pragma comment(lib, "windowscodecs.lib")
+#endif
+
+static std::string lowerExtension(const std::string& path) {
+	const size_t dot = path.rfind('.');
+	if (dot == std::string::npos) return "";
+	std::string ext = path.substr(dot + 1);
+	std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(tolower(c)); });
+	return ext;
+}
+
+static bool readFile(const std::string& path, std::vector<uint8_t>& data) {
+	std::ifstream file(path, std::ios::binary);
+	if (!file) return false;
+	data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	return true;
+}
+
+// Reads the next whitespace separated token from a netpbm header, skipping '#' comments
+static bool nextHeaderToken(const std::vector<uint8_t>& data, size_t& pos, std::string& token) {
+	token.clear();
+	while (pos < data.size()) {
+		if (data[pos] == '#') {
+			while (pos < data.size() && data[pos] != '\n') ++pos;
+		}
+		else if (isspace(data[pos])) ++pos;
+		else break;
+	}
+	while (pos < data.size() && !isspace(data[pos])) token.push_back(static_cast<char>(data[pos++]));
+	return !token.empty();
+}
+
+// Binary PPM (P6), 8-bit only
+static bool loadPPM(const std::vector<uint8_t>& data, ImageRGBA& out, std::string& error) {
+	size_t pos = 2;
+	std::string w, h, maxVal;
+	if (!nextHeaderToken(data, pos, w) || !nextHeaderToken(data, pos, h) || !nextHeaderToken(data, pos, maxVal)) {
+		error = "truncated PPM header";
+		return false;
+	}
+	if (std::stoi(maxVal) != 255) {
+		error = "only 8-bit PPM is supported";
+		return false;
+	}
+	++pos; // single whitespace after maxval
+
+	out.resize(std::stoi(w), std::stoi(h));
+	const size_t texels = static_cast<size_t>(out.width) * out.height;
+	if (data.size() < pos + texels * 3) {
+		error = "truncated PPM payload";
+		return false;
+	}
+
+	for (size_t i = 0; i < texels; ++i) {
+		out.pixels[i * 4 + 0] = data[pos + i * 3 + 0];
+		out.pixels[i * 4 + 1] = data[pos + i * 3 + 1];
+		out.pixels[i * 4 + 2] = data[pos + i * 3 + 2];
+		out.pixels[i * 4 + 3] = 255;
+	}
+	return true;
+}
+
+// PAM (P7) with RGB or RGB_ALPHA tuples, 8-bit only
+static bool loadPAM(const std::vector<uint8_t>& data, ImageRGBA& out, std::string& error) {
+	size_t pos = 2;
+	int width = 0, height = 0, depth = 0, maxVal = 0;
+	std::string token;
+
+	while (nextHeaderToken(data, pos, token) && token != "ENDHDR") {
+		std::string value;
+		if (token == "TUPLTYPE") { nextHeaderToken(data, pos, value); continue; }
+		if (!nextHeaderToken(data, pos, value)) break;
+		if (token == "WIDTH") width = std::stoi(value);
+		else if (token == "HEIGHT") height = std::stoi(value);
+		else if (token == "DEPTH") depth = std::stoi(value);
+		else if (token == "MAXVAL") maxVal = std::stoi(value);
+	}
+	++pos;
+
+	if (maxVal != 255 || (depth != 3 && depth != 4)) {
+		error = "only 8-bit RGB/RGBA PAM is supported";
+		return false;
+	}
+
+	out.resize(width, height);
+	const size_t texels = static_cast<size_t>(width) * height;
+	if (data.size() < pos + texels * depth) {
+		error = "truncated PAM payload";
+		return false;
+	}
+
+	for (size_t i = 0; i < texels; ++i) {
+		for (int c = 0; c < depth; ++c) out.pixels[i * 4 + c] = data[pos + i * depth + c];
+	}
+	return true;
+}
+
+// Uncompressed true-colour TGA (type 2), 24 or 32 bpp, either origin
+static bool loadTGA(const std::vector<uint8_t>& data, ImageRGBA& out, std::string& error) {
+	if (data.size() < 18) {
+		error = "truncated TGA header";
+		return false;
+	}
+
+	const uint8_t idLength = data[0];
+	const uint8_t imageType = data[2];
+	const int width = data[12] | (data[13] << 8);
+	const int height = data[14] | (data[15] << 8);
+	const int bpp = data[16];
+	const bool topDown = (data[17] & 0x20) != 0;
+
+	if (imageType != 2 || (bpp != 24 && bpp != 32)) {
+		error = "only uncompressed 24/32-bit TGA is supported";
+		return false;
+	}
+
+	const size_t stride = bpp / 8;
+	const size_t offset = 18 + idLength;
+	if (data.size() < offset + static_cast<size_t>(width) * height * stride) {
+		error = "truncated TGA payload";
+		return false;
+	}
+
+	out.resize(width, height);
+	for (int y = 0; y < height; ++y) {
+		const int srcY = topDown ? y : (height - 1 - y);
+		const uint8_t* src = data.data() + offset + static_cast<size_t>(srcY) * width * stride;
+		uint8_t* dst = out.row(y);
+		for (int x = 0; x < width; ++x) {
+			dst[x * 4 + 0] = src[x * stride + 2];
+			dst[x * 4 + 1] = src[x * stride + 1];
+			dst[x * 4 + 2] = src[x * stride + 0];
+			dst[x * 4 + 3] = (stride == 4) ? src[x * stride + 3] : 255;
+		}
+	}
+	return true;
+}
+
+#ifdef _WIN32
+// Decodes anything WIC understands into RGBA8
+static bool loadWIC(const std::string& path, ImageRGBA& out, std::string& error) {
+	HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+	const bool comInitialised = SUCCEEDED(hr);
+
+	IWICImagingFactory* factory = nullptr;
+	IWICBitmapDecoder* decoder = nullptr;
+	IWICBitmapFrameDecode* frame = nullptr;
+	IWICFormatConverter* converter = nullptr;
+
+	const std::wstring widePath(path.begin(), path.end());
+	bool ok = false;
+
+	hr = CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&factory));
+	if (SUCCEEDED(hr)) hr = factory->CreateDecoderFromFilename(widePath.c_str(), nullptr, GENERIC_READ, WICDecodeMetadataCacheOnDemand, &decoder);
+	if (SUCCEEDED(hr)) hr = decoder->GetFrame(0, &frame);
+	if (SUCCEEDED(hr)) hr = factory->CreateFormatConverter(&converter);
+	if (SUCCEEDED(hr)) hr = converter->Initialize(frame, GUID_WICPixelFormat32bppRGBA, WICBitmapDitherTypeNone, nullptr, 0.0, WICBitmapPaletteTypeCustom);
+
+	UINT width = 0, height = 0;
+	if (SUCCEEDED(hr)) hr = converter->GetSize(&width, &height);
+	if (SUCCEEDED(hr)) {
+		out.resize(static_cast<int>(width), static_cast<int>(height));
+		hr = converter->CopyPixels(nullptr, width * 4, static_cast<UINT>(out.pixels.size()), out.pixels.data());
+		ok = SUCCEEDED(hr);
+	}
+
+	if (!ok) error = "WIC failed to decode image";
+
+	if (converter) converter->Release();
+	if (frame) frame->Release();
+	if (decoder) decoder->Release();
+	if (factory) factory->Release();
+	if (comInitialised) CoUninitialize();
+	return ok;
+}
+#endif
+
+bool loadImage(const std::string& path, ImageRGBA& out, std::string& error) {
+	const std::string ext = lowerExtension(path);
+
+#ifdef _WIN32
+	if (ext == "jpg" || ext == "jpeg" || ext == "png" || ext == "bmp") return loadWIC(path, out, error);
+#endif
+
+	std::vector<uint8_t> data;
+	if (!readFile(path, data)) {
+		error = "cannot open " + path;
+		return false;
+	}
+
+	if (data.size() > 2 && data[0] == 'P' && data[1] == '6') return loadPPM(data, out, error);
+	if (data.size() > 2 && data[0] == 'P' && data[1] == '7') return loadPAM(data, out, error);
+	if (ext == "tga") return loadTGA(data, out, error);
+
+	error = "unsupported input format '" + ext + "' (convert to .tga/.ppm/.pam first on this platform)";
+	return false;
+}
+
+bool saveTGA(const std::string& path, const ImageRGBA& image) {
+	std::ofstream file(path, std::ios::binary);
+	if (!file) return false;
+
+	uint8_t header[18] = {};
+	header[2] = 2;
+	header[12] = static_cast<uint8_t>(image.width & 0xff);
+	header[13] = static_cast<uint8_t>(image.width >> 8);
+	header[14] = static_cast<uint8_t>(image.height & 0xff);
+	header[15] = static_cast<uint8_t>(image.height >> 8);
+	header[16] = 32;
+	header[17] = 0x28; // top-left origin, 8 alpha bits
+	file.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+	std::vector<uint8_t> bgra(image.pixels.size());
+	for (size_t i = 0; i < image.pixels.size(); i += 4) {
+		bgra[i + 0] = image.pixels[i + 2];
+		bgra[i + 1] = image.pixels[i + 1];
+		bgra[i + 2] = image.pixels[i + 0];
+		bgra[i + 3] = image.pixels[i + 3];
+	}
+	file.write(reinterpret_cast<const char*>(bgra.data()), bgra.size());
+	return static_cast<bool>(file);
+}
@@ -0,0 +1,169 @@
+// Main.cpp
+// TextureBaker: offline asset step that turns the JPG/PNG textures loaded in App1::initComponents into
+// BC-compressed DDS files with full mip chains. TextureManager::loadTexture picks up a baked .dds that
+// sits next to the source image, so baking is opt-in per texture and needs no code changes in the app.
+//
+// Usage: TextureBaker [--format bc1|bc3|bc7] [--linear] [--srgb] [--no-mips] [--verify] [--min-psnr dB] <input> <output.dds>
+
+#include "BCEncoder.h"
+#include "DDSWriter.h"
+#include "MipGenerator.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace {
+
+	struct BakeOptions {
+		std::string input;
+		std::string output;
+		BCFormat format = BCFormat::BC1;
+		bool formatSpecified = false;
+		MipColourSpace colourSpace = MipColourSpace::SRGB;
+		bool srgbFormat = false;
+		bool mips = true;
+		bool verify = false;
+		double minimumPSNR = -1.0;	// Below zero: the format's own floor
+	};
+
+	void printUsage() {
+		printf("Usage: TextureBaker [options] <input> <output.dds>\n"
+			"  --format bc1|bc3|bc7  Block format (default: bc1 for opaque images, bc3 when alpha is used)\n"
+			"  --linear              Data texture: filter mips on raw values instead of in linear light\n"
+			"  --srgb                Write the *_UNORM_SRGB DXGI format (shaders then receive linear values)\n"
+			"  --no-mips             Only write the top level\n"
+			"  --verify              Decode the written file, report PSNR per mip and fail if the chain is below the\n"
+			"                        format's floor (BC1/BC3 30 dB, BC7 35 dB)\n"
+			"  --min-psnr <dB>       Floor for --verify instead of the format's own\n");
+	}
+
+	bool parseArguments(int argc, char** argv, BakeOptions& options) {
+		for (int i = 1; i < argc; ++i) {
+			const std::string arg = argv[i];
+			if (arg == "--format" && i + 1 < argc) {
+				const std::string value = argv[++i];
+				if (value == "bc1") options.format = BCFormat::BC1;
+				else if (value == "bc3") options.format = BCFormat::BC3;
+				else if (value == "bc7") options.format = BCFormat::BC7;
+				else return false;
+				options.formatSpecified = true;
+			}
+			else if (arg == "--linear") options.colourSpace = MipColourSpace::Linear;
+			else if (arg == "--srgb") options.srgbFormat = true;
+			else if (arg == "--no-mips") options.mips = false;
+			else if (arg == "--verify") options.verify = true;
+			else if (arg == "--min-psnr" && i + 1 < argc) options.minimumPSNR = atof(argv[++i]);
+			else if (options.input.empty()) options.input = arg;
+			else if (options.output.empty()) options.output = arg;
+			else return false;
+		}
+		return !options.input.empty() && !options.output.empty();
+	}
+
+	bool usesAlpha(const ImageRGBA& image) {
+		for (size_t i = 3; i < image.pixels.size(); i += 4) {
+			if (image.pixels[i] != 255) return true;
+		}
+		return false;
+	}
+
+	const char* formatName(BCFormat format) {
+		switch (format) {
+		case BCFormat::BC1: return "BC1";
+		case BCFormat::BC3: return "BC3";
+		case BCFormat::BC7: return "BC7";
+		}
+		return "?";
+	}
+}
+
+int main(int argc, char** argv) {
+	BakeOptions options;
+	if (!parseArguments(argc, argv, options)) {
+		printUsage();
+		return 1;
+	}
+
+	ImageRGBA source;
+	std::string error;
+	if (!loadImage(options.input, source, error)) {
+		fprintf(stderr, "TextureBaker: %s: %s\n", options.input.c_str(), error.c_str());
+		return 1;
+	}
+
+	const bool alpha = usesAlpha(source);
+	if (!options.formatSpecified) options.format = alpha ? BCFormat::BC3 : BCFormat::BC1;
+
+	const auto start = std::chrono::high_resolution_clock::now();
+
+	std::vector<ImageRGBA> chain;
+	if (options.mips) chain = MipGenerator::generate(source, options.colourSpace);
+	else chain.push_back(source);
+
+	const auto mipsDone = std::chrono::high_resolution_clock::now();
+
+	std::vector<std::vector<uint8_t>> levels(chain.size());
+	size_t compressedBytes = 0;
+	for (size_t i = 0; i < chain.size(); ++i) {
+		BCEncoder::encodeImage(chain[i], options.format, levels[i]);
+		compressedBytes += levels[i].size();
+	}
+
+	const auto encodeDone = std::chrono::high_resolution_clock::now();
+
+	if (!DDSWriter::write(options.output, options.format, options.srgbFormat, source.width, source.height, levels)) {
+		fprintf(stderr, "TextureBaker: failed to write %s\n", options.output.c_str());
+		return 1;
+	}
+
+	const double mipMs = std::chrono::duration<double, std::milli>(mipsDone - start).count();
+	const double encodeMs = std::chrono::duration<double, std::milli>(encodeDone - mipsDone).count();
+	size_t rawBytes = 0;
+	for (const auto& level : chain) rawBytes += level.pixels.size();
+
+	printf("%s -> %s: %dx%d %s, %zu mips, %.2f MB -> %.2f MB, mips %.1f ms, encode %.1f ms (%.1f Mtexel/s)\n",
+		options.input.c_str(), options.output.c_str(), source.width, source.height, formatName(options.format),
+		chain.size(), rawBytes / (1024.0 * 1024.0), compressedBytes / (1024.0 * 1024.0), mipMs, encodeMs,
+		(rawBytes / 4) / (encodeMs * 1000.0));
+
+	if (options.verify) {
+		BCFormat readFormat;
+		int width = 0, height = 0;
+		std::vector<std::vector<uint8_t>> readLevels;
+		if (!DDSWriter::read(options.output, readFormat, width, height, readLevels) || readLevels.size() != chain.size()) {
+			fprintf(stderr, "TextureBaker: verify failed to read back %s\n", options.output.c_str());
+			return 1;
+		}
+
+		// Texel-weighted over the chain, so the top level, which is what's seen up close, dominates
+		const bool checkAlpha = alpha && options.format != BCFormat::BC1;
+		double chainError = 0.0;
+		size_t chainTexels = 0;
+		for (size_t i = 0; i < chain.size(); ++i) {
+			ImageRGBA decoded;
+			BCEncoder::decodeImage(readLevels[i].data(), readFormat, chain[i].width, chain[i].height, decoded);
+			const double rgbError = BCEncoder::meanSquaredError(chain[i], decoded, false);
+			const double rgbaError = BCEncoder::meanSquaredError(chain[i], decoded, true);
+			printf("  mip %zu (%dx%d): PSNR rgb %.2f dB, rgba %.2f dB\n", i, chain[i].width, chain[i].height,
+				BCEncoder::psnr(rgbError), BCEncoder::psnr(rgbaError));
+
+			const size_t texels = static_cast<size_t>(chain[i].width) * chain[i].height;
+			chainError += (checkAlpha ? rgbaError : rgbError) * texels;
+			chainTexels += texels;
+		}
+
+		const double chainPSNR = BCEncoder::psnr(chainError / chainTexels);
+		const double minimum = options.minimumPSNR >= 0.0 ? options.minimumPSNR : BCEncoder::minimumPSNR(options.format);
+		printf("  chain: PSNR %s %.2f dB, floor %.2f dB\n", checkAlpha ? "rgba" : "rgb", chainPSNR, minimum);
+		if (chainPSNR < minimum) {
+			fprintf(stderr, "TextureBaker: verify failed, %s %s is %.2f dB below the floor\n", options.output.c_str(),
+				formatName(options.format), minimum - chainPSNR);
+			return 1;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,114 @@
+// MipGenerator.cpp
+// Gamma-correct box downsampling. Texels are expanded to four floats and filtered with SSE, one texel
+// per register, so the RGB and A lanes go through the same add/scale and only the transfer differs.
+
+#include "MipGenerator.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <emmintrin.h>
+
+namespace {
+
+	// sRGB <-> linear lookup tables. Decode is exact per byte; encode picks the byte whose linear value
+	// is nearest using the midpoints between neighbouring entries, so an unfiltered texel round-trips exactly.
+	struct SRGBTables {
+		float toLinear[256];
+		float midpoints[255];
+
+		SRGBTables() {
+			for (int i = 0; i < 256; ++i) {
+				const float c = i / 255.0f;
+				toLinear[i] = (c <= 0.04045f) ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+			}
+			for (int i = 0; i < 255; ++i) midpoints[i] = 0.5f * (toLinear[i] + toLinear[i + 1]);
+		}
+
+		uint8_t encode(float linear) const {
+			return static_cast<uint8_t>(std::upper_bound(midpoints, midpoints + 255, linear) - midpoints);
+		}
+	};
+
+	const SRGBTables& tables() {
+		static const SRGBTables instance;
+		return instance;
+	}
+
+	inline __m128 loadTexel(const uint8_t* p, MipColourSpace space) {
+		if (space == MipColourSpace::SRGB) {
+			const SRGBTables& t = tables();
+			return _mm_setr_ps(t.toLinear[p[0]], t.toLinear[p[1]], t.toLinear[p[2]], p[3] * (1.0f / 255.0f));
+		}
+		int packed;
+		memcpy(&packed, p, sizeof(packed));
+		const __m128i bytes = _mm_cvtsi32_si128(packed);
+		const __m128i words = _mm_unpacklo_epi8(bytes, _mm_setzero_si128());
+		const __m128i dwords = _mm_unpacklo_epi16(words, _mm_setzero_si128());
+		return _mm_mul_ps(_mm_cvtepi32_ps(dwords), _mm_set1_ps(1.0f / 255.0f));
+	}
+
+	inline void storeTexel(uint8_t* p, __m128 v, MipColourSpace space) {
+		v = _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+		alignas(16) float f[4];
+		_mm_store_ps(f, v);
+
+		if (space == MipColourSpace::SRGB) {
+			const SRGBTables& t = tables();
+			for (int c = 0; c < 3; ++c) p[c] = t.encode(f[c]);
+			p[3] = static_cast<uint8_t>(f[3] * 255.0f + 0.5f);
+			return;
+		}
+
+		const __m128i ints = _mm_cvtps_epi32(_mm_mul_ps(v, _mm_set1_ps(255.0f)));
+		const __m128i words = _mm_packs_epi32(ints, ints);
+		const __m128i bytes = _mm_packus_epi16(words, words);
+		const int packed = _mm_cvtsi128_si32(bytes);
+		memcpy(p, &packed, sizeof(packed));
+	}
+}
+
+int MipGenerator::mipCount(int width, int height) {
+	int levels = 1;
+	while (width > 1 || height > 1) {
+		width = std::max(1, width / 2);
+		height = std::max(1, height / 2);
+		++levels;
+	}
+	return levels;
+}
+
+void MipGenerator::downsample(const ImageRGBA& source, ImageRGBA& dest, MipColourSpace colourSpace) {
+	dest.resize(std::max(1, source.width / 2), std::max(1, source.height / 2));
+	const __m128 quarter = _mm_set1_ps(0.25f);
+
+	for (int y = 0; y < dest.height; ++y) {
+		const int y0 = std::min(y * 2, source.height - 1);
+		const int y1 = std::min(y * 2 + 1, source.height - 1);
+		const uint8_t* row0 = source.row(y0);
+		const uint8_t* row1 = source.row(y1);
+		uint8_t* out = dest.row(y);
+
+		for (int x = 0; x < dest.width; ++x) {
+			const int x0 = std::min(x * 2, source.width - 1) * 4;
+			const int x1 = std::min(x * 2 + 1, source.width - 1) * 4;
+
+			__m128 sum = _mm_add_ps(loadTexel(row0 + x0, colourSpace), loadTexel(row0 + x1, colourSpace));
+			sum = _mm_add_ps(sum, loadTexel(row1 + x0, colourSpace));
+			sum = _mm_add_ps(sum, loadTexel(row1 + x1, colourSpace));
+			storeTexel(out + x * 4, _mm_mul_ps(sum, quarter), colourSpace);
+		}
+	}
+}
+
+std::vector<ImageRGBA> MipGenerator::generate(const ImageRGBA& source, MipColourSpace colourSpace) {
+	std::vector<ImageRGBA> chain;
+	chain.reserve(mipCount(source.width, source.height));
+	chain.push_back(source);
+
+	while (chain.back().width > 1 || chain.back().height > 1) {
+		ImageRGBA next;
+		downsample(chain.back(), next, colourSpace);
+		chain.push_back(std::move(next));
+	}
+	return chain;
+}
@@ -0,0 +1,22 @@
+// MipGenerator.h
+// Builds a full mip chain down to 1x1. Colour channels are filtered in linear light (sRGB decode ->
+// 2x2 box -> sRGB encode) so distant mips don't darken; alpha and data textures are filtered as-is.
+
+#pragma once
+#include "Image.h"
+
+enum class MipColourSpace {
+	SRGB,   // Albedo/sky textures: average in linear light
+	Linear  // Height/data textures (e.g. island_floor, sampled as displacement): average raw values
+};
+
+class MipGenerator {
+public:
+	// Returns level 0 (a copy of source) followed by every smaller level
+	static std::vector<ImageRGBA> generate(const ImageRGBA& source, MipColourSpace colourSpace);
+
+	// Produces the next level from the previous one. Odd dimensions clamp the last row/column.
+	static void downsample(const ImageRGBA& source, ImageRGBA& dest, MipColourSpace colourSpace);
+
+	static int mipCount(int width, int height);
+};
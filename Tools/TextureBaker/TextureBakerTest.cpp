@@ -0,0 +1,129 @@
+// TextureBakerTest.cpp
+// Round trip of the bake on a generated 96x40 gradient, with alpha, for each format: the mip chain runs down to 1x1
+// through the odd sizes, the DDS header is what DDSTextureLoader expects (FourCC or DX10 format, mip count, linear
+// size, caps, file length), the levels read back unchanged and decode to within the format's PSNR floor. Also saves
+// the gradient as gradient.tga, for the tests that run TextureBaker --verify itself.
+
+#include "BCEncoder.h"
+#include "DDSWriter.h"
+#include "MipGenerator.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace {
+
+	constexpr int WIDTH = 96;
+	constexpr int HEIGHT = 40;
+
+	// Every channel a line in one parameter, so each block's colours lie close to a line, as BC endpoints assume
+	ImageRGBA gradient() {
+		ImageRGBA image;
+		image.resize(WIDTH, HEIGHT);
+		for (int y = 0; y < HEIGHT; ++y) {
+			for (int x = 0; x < WIDTH; ++x) {
+				const int t = x + y * 2;
+				uint8_t* texel = image.row(y) + x * 4;
+				texel[0] = static_cast<uint8_t>(40 + t);
+				texel[1] = static_cast<uint8_t>(20 + t * 2 / 3);
+				texel[2] = static_cast<uint8_t>(220 - t);
+				texel[3] = static_cast<uint8_t>(255 - t / 2);
+			}
+		}
+		return image;
+	}
+
+	uint32_t readU32(const std::vector<uint8_t>& file, size_t offset) {
+		uint32_t value = 0;
+		if (offset + 4 <= file.size()) memcpy(&value, file.data() + offset, 4);
+		return value;
+	}
+
+	bool checkChain(const std::vector<ImageRGBA>& chain) {
+		const int sizes[][2] = { { 96, 40 }, { 48, 20 }, { 24, 10 }, { 12, 5 }, { 6, 2 }, { 3, 1 }, { 1, 1 } };
+		if (chain.size() != 7 || MipGenerator::mipCount(WIDTH, HEIGHT) != 7) return false;
+		for (size_t i = 0; i < chain.size(); ++i) {
+			if (chain[i].width != sizes[i][0] || chain[i].height != sizes[i][1]) return false;
+		}
+		return true;
+	}
+
+	// Offsets into the file: magic, then the 124 byte header, then the DX10 header when there is one
+	bool checkHeader(const std::vector<uint8_t>& file, BCFormat format, bool srgb, const std::vector<std::vector<uint8_t>>& levels) {
+		const bool dx10 = srgb || format == BCFormat::BC7;
+		const char* fourCC = dx10 ? "DX10" : format == BCFormat::BC1 ? "DXT1" : "DXT5";
+		size_t expectedSize = 4 + 124 + (dx10 ? 20 : 0);
+		for (const auto& level : levels) expectedSize += level.size();
+
+		const uint32_t flags = readU32(file, 8), caps = readU32(file, 108);
+		const uint32_t required = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000;	// caps, size, pixel format, mips, linear size
+		bool ok = file.size() == expectedSize && memcmp(file.data(), "DDS ", 4) == 0 && readU32(file, 4) == 124 &&
+			(flags & required) == required && readU32(file, 12) == HEIGHT && readU32(file, 16) == WIDTH &&
+			readU32(file, 20) == levels[0].size() && readU32(file, 28) == levels.size() && readU32(file, 76) == 32 &&
+			readU32(file, 80) == 0x4 && memcmp(file.data() + 84, fourCC, 4) == 0 && (caps & 0x401008) == 0x401008;
+		if (dx10) {
+			ok = ok && readU32(file, 128) == DDSWriter::dxgiFormat(format, srgb) && readU32(file, 132) == 3 &&
+				readU32(file, 140) == 1;
+		}
+		return ok;
+	}
+
+	bool roundTrip(const std::vector<ImageRGBA>& chain, BCFormat format, bool srgb, const char* name) {
+		std::vector<std::vector<uint8_t>> levels(chain.size());
+		for (size_t i = 0; i < chain.size(); ++i) BCEncoder::encodeImage(chain[i], format, levels[i]);
+
+		const std::string path = std::string("gradient_") + name + ".dds";
+		if (!DDSWriter::write(path, format, srgb, WIDTH, HEIGHT, levels)) {
+			printf("%-9s FAILED to write %s\n", name, path.c_str());
+			return false;
+		}
+
+		std::ifstream stream(path, std::ios::binary);
+		const std::vector<uint8_t> file((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+		const bool header = checkHeader(file, format, srgb, levels);
+
+		BCFormat readFormat = BCFormat::BC1;
+		int width = 0, height = 0;
+		std::vector<std::vector<uint8_t>> readLevels;
+		const bool read = DDSWriter::read(path, readFormat, width, height, readLevels) && readFormat == format &&
+			width == WIDTH && height == HEIGHT && readLevels == levels;
+
+		// BC1 here is opaque, so only its colour is held to the floor
+		const bool includeAlpha = format != BCFormat::BC1;
+		double error = 0.0;
+		size_t texels = 0;
+		for (size_t i = 0; read && i < chain.size(); ++i) {
+			ImageRGBA decoded;
+			BCEncoder::decodeImage(readLevels[i].data(), format, chain[i].width, chain[i].height, decoded);
+			const size_t count = static_cast<size_t>(chain[i].width) * chain[i].height;
+			error += BCEncoder::meanSquaredError(chain[i], decoded, includeAlpha) * count;
+			texels += count;
+		}
+		const double psnr = texels ? BCEncoder::psnr(error / texels) : 0.0;
+		const bool quality = read && psnr >= BCEncoder::minimumPSNR(format);
+
+		printf("%-9s header %s, read back %s, PSNR %.2f dB (floor %.2f) %s\n", name, header ? "ok" : "FAILED",
+			read ? "ok" : "FAILED", psnr, BCEncoder::minimumPSNR(format), quality ? "ok" : "FAILED");
+		return header && read && quality;
+	}
+}
+
+int main() {
+	const ImageRGBA source = gradient();
+	const std::vector<ImageRGBA> chain = MipGenerator::generate(source, MipColourSpace::SRGB);
+	const bool chainOk = checkChain(chain);
+	printf("TextureBaker: %dx%d gradient, %zu mips %s\n", WIDTH, HEIGHT, chain.size(), chainOk ? "ok" : "FAILED");
+
+	bool ok = chainOk;
+	ok = roundTrip(chain, BCFormat::BC1, false, "bc1") && ok;
+	ok = roundTrip(chain, BCFormat::BC1, true, "bc1_srgb") && ok;
+	ok = roundTrip(chain, BCFormat::BC3, false, "bc3") && ok;
+	ok = roundTrip(chain, BCFormat::BC7, false, "bc7") && ok;
+
+	if (!saveTGA("gradient.tga", source)) {
+		printf("FAILED to write gradient.tga\n");
+		ok = false;
+	}
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,35 @@
+#!/bin/sh
+# Bakes the scene textures into BC-compressed DDS files next to their sources.
+# TextureManager::loadTexture loads res/<name>.dds instead of res/<name>.jpg when it exists.
+# Run from the repository root after building the baker:
+#   cmake -S Tools/TextureBaker -B Tools/TextureBaker/build && cmake --build Tools/TextureBaker/build
+#   sh Tools/TextureBaker/bake_textures.sh
+# JPG decoding needs ImageMagick on Linux; on Windows the baker reads JPG/PNG through WIC directly.
+
+set -e
+
+BAKER=${BAKER:-Tools/TextureBaker/build/TextureBaker}
+RES=Coursework/res
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+
+bake() {
+	src="$1"; shift
+	if [ ! -f "$src" ]; then
+		echo "skipping $src (not found)"
+		return
+	fi
+	stem="${src%.*}"
+	convert "$src" -alpha on "$TMP/input.pam"
+	"$BAKER" "$@" --verify "$TMP/input.pam" "$stem.dds"
+}
+
+# Colour textures: mips filtered in linear light, stored UNORM so shading is unchanged
+bake "$RES/sky/brandon-griggs-PcAxQ_BMjnk-unsplash.jpg" --format bc1
+bake "$RES/blue_water.jpg" --format bc1
+bake "$RES/moon.jpg" --format bc1
+bake "$RES/yellow.jpg" --format bc1
+bake "$RES/snow2/snow.jpg" --format bc1
+
+# Displacement source for terrain_ds.hlsl: raw values, higher precision
+bake "$RES/Floor_Black.jpg" --format bc7 --linear
@@ -39,6 +39,6 @@ protected:
 	void processNode(const aiNode* node, const aiScene* scene);
 	void processMesh(const aiMesh* mesh, const aiScene* scene);
 	ID3D11Device* device;
-	std::vector<VertexType> vertices;
-	std::vector<unsigned long> indices;
+	TrackedVector<VertexType, MemoryTag::Models> vertices;		///< Kept on the CPU after upload
+	TrackedVector<unsigned long, MemoryTag::Models> indices;
 };
\ No newline at end of file
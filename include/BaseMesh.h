@@ -14,6 +14,8 @@
 
 #include <d3d11.h>
 #include <directxmath.h>
+#include "MemoryTracker.h"
+#include "MeshGeometry.h"
 
 using namespace DirectX;
 
@@ -22,12 +24,7 @@ class BaseMesh
 protected:
 
 	/// Default struct for general vertex data include position, texture coordinates and normals
-	struct VertexType
-	{
-		XMFLOAT3 position;
-		XMFLOAT2 texture;
-		XMFLOAT3 normal;
-	};
+	typedef MeshVertex VertexType;
 
 	/// Default vertex struct for geometry with only position and colour
 	struct VertexType_Colour
@@ -55,10 +52,15 @@ public:
 
 protected:
 	virtual void initBuffers(ID3D11Device*) = 0;
+	void trackBuffers(MemoryTag tag = MemoryTag::Meshes);	///< Counts the vertex and index buffers, once made, against the tag
 
 	ID3D11Buffer *vertexBuffer, *indexBuffer;
 	//D3D11_INPUT_ELEMENT_DESC *inputLayout;
 	int vertexCount, indexCount;
+
+private:
+	size_t trackedBytes;
+	MemoryTag trackedTag;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,42 @@
+/**
+* \class BlockDecoder
+*
+* \brief CPU decoder for the block-compressed formats Tools/TextureBaker writes, for code that reads texels back
+*
+* Gives the same texels the GPU samples, so CPU copies of a baked texture (TerrainDisplacement's heights) match what
+* is drawn. BC7 is decoded in mode 6 only, the one mode the baker writes; other modes are refused rather than guessed.
+* Does not touch D3D.
+*/
+
+// Block decoder
+// BC1, BC3 and BC7 (mode 6) blocks to RGBA8, bit-exact with the D3D11 decode and with TextureBaker's reference decoder.
+
+#ifndef _BLOCKDECODER_H_
+#define _BLOCKDECODER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+enum class BlockFormat
+{
+	BC1,
+	BC3,
+	BC7
+};
+
+class BlockDecoder
+{
+public:
+	static size_t blockBytes(BlockFormat format) { return format == BlockFormat::BC1 ? 8 : 16; }
+
+	// A width x height surface of blocks, rows padded to whole blocks, into rgba rows rowPitch bytes apart.
+	// False if a BC7 block is in a mode other than 6; the texels decoded so far are left in place.
+	static bool decode(BlockFormat format, const uint8_t* blocks, int width, int height, uint8_t* rgba, size_t rowPitch);
+
+	// Single 4x4 blocks, texels in row-major RGBA8 order
+	static void decodeBC1(const uint8_t in[8], uint8_t rgba[64]);
+	static void decodeBC3(const uint8_t in[16], uint8_t rgba[64]);
+	static bool decodeBC7(const uint8_t in[16], uint8_t rgba[64]);
+};
+
+#endif
@@ -0,0 +1,149 @@
+/**
+* \class FrameArena
+*
+* \brief Linear allocator for data that only lives for a frame, or for the length of a function
+*
+* \class ScratchScope
+*
+* \brief Marks a thread's scratch arena on construction and gives back everything allocated since on destruction
+*
+* \class ArenaAllocator
+*
+* \brief STL allocator over a FrameArena, so vectors and other containers can use one
+*/
+
+// Frame arena
+// Allocations bump a pointer through blocks taken from the heap; nothing is freed one at a time. reset() gives
+// everything back at once, and if more than one block was needed it replaces them with a single block big enough for
+// all of them, so after the first few frames an arena never touches the heap again. Destructors are never run, so
+// only trivially destructible types may be placed in one. An arena belongs to one thread; scratch() is the calling
+// thread's own.
+
+#ifndef _FRAMEARENA_H_
+#define _FRAMEARENA_H_
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+class FrameArena
+{
+public:
+	struct Stats
+	{
+		size_t bytes;				///< In use now, alignment padding and skipped block ends included
+		size_t peakBytes;			///< Most in use at once since the arena was made
+		size_t capacity;			///< Held in blocks
+		size_t allocations;			///< Since the last reset
+		size_t lastAllocations;		///< Between the last two resets, so a whole frame's worth
+		size_t totalAllocations;
+		size_t blockAllocations;	///< Blocks taken from the heap, ever; stops growing in the steady state
+	};
+
+	struct Marker
+	{
+		size_t block;
+		size_t offset;
+		size_t bytes;
+	};
+
+	explicit FrameArena(size_t blockSize = defaultBlockSize);
+	~FrameArena();
+
+	FrameArena(const FrameArena&) = delete;
+	FrameArena& operator=(const FrameArena&) = delete;
+
+	void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+	void release(void* data, size_t bytes);		///< Only gives the bytes back when they were the last allocated
+
+	// Default-initialised, like new T[count]
+	template<typename T>
+	T* allocate(size_t count)
+	{
+		static_assert(std::is_trivially_destructible<T>::value, "FrameArena never runs destructors");
+		T* data = static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+		for (size_t i = 0; i < count; i++)
+		{
+			new (data + i) T;
+		}
+		return data;
+	}
+
+	Marker getMarker() const { return { current, offset, stats.bytes }; }
+	void rewind(const Marker& marker);		///< Gives back everything allocated since the marker
+	void reset();							///< Gives back everything, once a frame: merges the blocks and rolls the stats over
+
+	const Stats& getStats() const { return stats; }
+
+	static FrameArena& scratch();	///< The calling thread's scratch arena, for ScratchScope
+
+	static const size_t defaultBlockSize = 64 * 1024;
+
+private:
+	struct Block
+	{
+		char* data;
+		size_t size;
+	};
+
+	void addBlock(size_t size);
+	void freeBlocks();
+
+	std::vector<Block> blocks;
+	size_t blockSize;
+	size_t current;		///< Block being allocated from
+	size_t offset;		///< Into the current block
+	Stats stats;
+};
+
+class ScratchScope
+{
+public:
+	explicit ScratchScope(FrameArena& arena = FrameArena::scratch()) : arena(arena), marker(arena.getMarker()) {}
+	~ScratchScope() { arena.rewind(marker); }
+
+	ScratchScope(const ScratchScope&) = delete;
+	ScratchScope& operator=(const ScratchScope&) = delete;
+
+	template<typename T>
+	T* allocate(size_t count) { return arena.allocate<T>(count); }
+
+	FrameArena& getArena() const { return arena; }
+
+private:
+	FrameArena& arena;
+	FrameArena::Marker marker;
+};
+
+template<typename T>
+class ArenaAllocator
+{
+public:
+	typedef T value_type;
+
+	ArenaAllocator(FrameArena& arena) : arena(&arena) {}
+	ArenaAllocator(const ScratchScope& scope) : arena(&scope.getArena()) {}
+	template<typename U>
+	ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.getArena()) {}
+
+	T* allocate(size_t count) { return static_cast<T*>(arena->allocate(count * sizeof(T), alignof(T))); }
+	void deallocate(T* data, size_t count) { arena->release(data, count * sizeof(T)); }
+
+	FrameArena* getArena() const { return arena; }
+
+private:
+	FrameArena* arena;
+};
+
+template<typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.getArena() == b.getArena(); }
+
+template<typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.getArena() != b.getArena(); }
+
+// Reserve up front where the size is known: a growing vector leaves its old buffers behind until the arena rewinds
+template<typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+#endif
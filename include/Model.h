@@ -22,12 +22,7 @@ using namespace DirectX;
 
 class Model : public BaseMesh
 {
-	struct ModelType
-	{
-		float x, y, z;
-		float tu, tv;
-		float nx, ny, nz;
-	};
+	typedef ObjVertex ModelType;
 
 public:
 	/** \brief Initialises the mesh and vertex list, but loading in from a file
@@ -15,30 +15,135 @@
 #include <fstream>
 #include <vector>
 #include <map>
+#include <unordered_map>
+#include <thread>
+#include "TextureStreaming.h"
 //#include "Texture.h"
 
 using namespace DirectX;
 
+// Index into the manager's texture table. Names are interned once with getHandle/loadTexture,
+// after which per-frame lookups are plain array indexing.
+typedef unsigned int TextureHandle;
+
 class TextureManager
 {
 public:
+	static const TextureHandle defaultTexture = 0;	///< Plain white 1x1, bound for missing or not yet resident textures
+
 	TextureManager(ID3D11Device* device, ID3D11DeviceContext* deviceContext);
 	~TextureManager();
 
-	void loadTexture(const wchar_t* uid, const wchar_t* filename);
-	ID3D11ShaderResourceView* getTexture(const wchar_t* uid);
+	// Loading the same uid again only adds a reference. Returns the handle either way.
+	TextureHandle loadTexture(const wchar_t* uid, const wchar_t* filename);
+	TextureHandle getHandle(const wchar_t* uid);	///< Interned lookup by string content; defaultTexture if unknown
+	ID3D11ShaderResourceView* getTexture(TextureHandle handle);
+	ID3D11ShaderResourceView* getTexture(const wchar_t* uid);	///< Convenience, hashes the name every call
+
+	// Reference counting. Unreferenced textures stay cached and are the first evicted when over budget.
+	void addRef(TextureHandle handle);
+	void release(TextureHandle handle);
+
+	// Whenever the estimated VRAM use is above budget, unreferenced textures not drawn last frame and then referenced
+	// ones not drawn for evictionDelay frames are released, least-recently-used first; they reload (streamed if
+	// streaming is on) the next time they are drawn. Nothing drawn last frame is released, even over budget.
+	void setMemoryBudget(size_t bytes) { memoryBudget = bytes; }
+	size_t getMemoryBudget() const { return memoryBudget; }
+	size_t getMemoryUsage() const { return memoryUsage; }
+
+	// Streaming mode: loadTexture returns immediately and "default" is bound until the texture's mips arrive.
+	// Files are decoded on worker threads; update() uploads the decoded mips, smallest first, within uploadBudget bytes a frame.
+	void setStreaming(bool enabled, int workerCount = 2);
+	void setStreamingPriority(TextureHandle handle, float priority);	///< Added to the on-screen usage priority
+	void update();	///< Call once per frame from the main thread
+	bool isStreaming() const { return streaming; }
+	bool isResident(TextureHandle handle) const;	///< True once the full mip chain is on the GPU
+
+	// CPU copy of the top level loadTexture would draw for a file, as RGBA8, for data read on the CPU: the baked .dds
+	// sibling through BlockDecoder when there is one, otherwise the file itself through WIC. Callable from any thread;
+	// COM is initialised for the decode if the thread has not done so already.
+	bool decodePixels(const std::wstring& filename, UINT& width, UINT& height, std::vector<uint8_t>& rgba);
+
+	size_t uploadBudget = 4 * 1024 * 1024;
+	unsigned int evictionDelay = 60;
 
 private:
+	enum class TextureState
+	{
+		Unloaded,	///< Known name, no GPU data (never loaded or evicted)
+		Decoding,	///< Queued on or being decoded by a worker
+		Uploading,	///< GPU resource exists, some mips resident
+		Resident,
+		Failed		///< Load error already reported, not retried
+	};
+
+	struct DecodedLevel
+	{
+		UINT width, height, rowPitch;
+		std::vector<uint8_t> data;
+	};
+
+	struct DecodedTexture
+	{
+		TextureHandle handle;
+		std::wstring filename;
+		bool succeeded;
+		DXGI_FORMAT format;
+		std::vector<DecodedLevel> levels;	///< Level 0 is the most detailed
+	};
+
+	struct TextureEntry
+	{
+		std::wstring uid;
+		std::wstring filename;
+		TextureState state;
+		ID3D11Texture2D* resource;	///< Only held for streamed textures
+		ID3D11ShaderResourceView* view;
+		std::vector<DecodedLevel> levels;	///< CPU copies, released as they are uploaded
+		bool visible;	///< Streamed textures are bound once their first mips are uploaded
+		size_t bytes;	///< Estimated VRAM footprint while loaded
+		int refCount;
+		unsigned int lastUsedFrame;
+		float priorityBias;
+		int uses;	///< getTexture calls since the last update
+	};
+
+	TextureHandle intern(const wchar_t* uid);
+	void loadTextureImmediate(TextureHandle handle);
+	void requestLoad(TextureHandle handle);
+	void unload(TextureHandle handle);
+	void evictOverBudget();
 	bool does_file_exist(const wchar_t *fileName);
 	void generateTexture(ID3D11Device* device);
 	void addDefaultTexture();
 
+	void workerLoop();
+	bool decodeTexture(const std::wstring& filename, DecodedTexture& out);
+	bool readDDS(const std::wstring& path, DecodedTexture& out);
+	bool decodeWIC(const std::wstring& filename, UINT& width, UINT& height, std::vector<uint8_t>& rgba);
+	std::wstring resolveFile(const std::wstring& filename);	///< The baked sibling if there is one
+	void createStreamedResource(DecodedTexture& decoded);
+	void stopStreaming();
+
 	ID3D11ShaderResourceView* texture;
 	ID3D11Device* device;
 	ID3D11DeviceContext* deviceContext;
 
-	std::map<wchar_t*, ID3D11ShaderResourceView*> textureMap;
+	std::vector<TextureEntry> textures;	///< Indexed by TextureHandle, main thread only
+	std::unordered_map<std::wstring, TextureHandle> handles;
 	ID3D11Texture2D *pTexture;
+
+	size_t memoryBudget;
+	size_t memoryUsage;
+	unsigned int frame;
+
+	bool streaming;
+	std::vector<std::thread> workers;
+	TextureStreamQueue streamQueue;
+	MipResidencyScheduler residency;
+	std::mutex decodedMutex;
+	std::vector<DecodedTexture> decodedResults;	///< Handed from the workers to update()
+	int pendingDecodes;	///< Queued or decoding, not yet picked up by update()
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,116 @@
+/**
+* \class TextureStreamQueue
+*
+* \brief Thread-safe priority queue of texture decode jobs, consumed by TextureManager's worker threads
+*
+* \class MipResidencyScheduler
+*
+* \brief Decides which decoded mip levels are uploaded each frame, smallest first, under a byte budget
+*
+* Neither class touches D3D, so the queueing and residency logic can be driven without a device; nor does
+* pickEvictionVictim, TextureManager's choice of what to release when over its memory budget.
+*/
+
+// Texture streaming
+// Scheduling half of TextureManager's streaming mode. Textures are identified by small integer ids
+// handed out by the manager; level 0 is always the most detailed mip.
+
+#ifndef _TEXTURESTREAMING_H_
+#define _TEXTURESTREAMING_H_
+
+#include <climits>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct TextureStreamJob
+{
+	int id;
+	std::wstring filename;
+	float priority;
+	unsigned int sequence;	///< Submission order, breaks priority ties first-in first-out
+};
+
+class TextureStreamQueue
+{
+public:
+	TextureStreamQueue();
+
+	void push(int id, const std::wstring& filename, float priority);
+	void setPriority(int id, float priority);	///< No effect once a worker has taken the job
+	bool pop(TextureStreamJob& job);			///< Blocks until a job is available, false once closed
+	bool tryPop(TextureStreamJob& job);			///< Non-blocking pop
+	void close();								///< Wakes all waiting workers; pending jobs are discarded
+	void reopen();
+	size_t size();
+
+private:
+	bool takeHighest(TextureStreamJob& job);
+
+	std::mutex mutex;
+	std::condition_variable available;
+	std::vector<TextureStreamJob> jobs;
+	unsigned int nextSequence;
+	bool closed;
+};
+
+class MipResidencyScheduler
+{
+public:
+	struct Upload
+	{
+		int id;
+		int level;
+	};
+
+	MipResidencyScheduler();
+
+	void add(int id, const std::vector<size_t>& levelBytes);	///< Registers a decoded texture, nothing resident yet
+	void remove(int id);
+	void setPriority(int id, float priority);
+
+	// Appends this frame's uploads in the order they should be issued. Textures with nothing resident get
+	// their whole mip tail first so every texture is visible quickly, then the highest-priority texture
+	// is refined one level at a time. At least one upload is issued per call so large top levels still land.
+	void schedule(size_t byteBudget, std::vector<Upload>& uploads);
+
+	void markResident(int id, int level);	///< Called by the owner once the upload for `level` is issued
+	int residentLevel(int id) const;		///< Most detailed resident level: the level count if none is, noneResident if never added
+	bool isComplete(int id) const;
+	bool isEmpty() const { return textures.empty(); }
+
+	static const size_t tailBytes = 16 * 1024;	///< Levels at or below this size are uploaded together
+	static const int noneResident = INT_MAX;	///< Past every level, so an id the scheduler doesn't hold reads as nothing resident
+
+private:
+	struct Entry
+	{
+		int id;
+		std::vector<size_t> levelBytes;
+		int resident;	///< Most detailed resident level; levelBytes.size() when nothing is resident
+		int scheduled;	///< Most detailed level already handed out by schedule()
+		float priority;
+	};
+
+	Entry* find(int id);
+	const Entry* find(int id) const;
+
+	std::vector<Entry> textures;
+};
+
+struct TextureEvictionCandidate
+{
+	int id;
+	unsigned int lastUsedFrame;
+	bool referenced;
+};
+
+// Index of the candidate to release next, or -1 when none may go. `frame` is the frame whose draws have just finished.
+// Unreferenced textures go first, then referenced ones idle for at least evictionDelay frames, least recently used
+// first. Nothing drawn in `frame` is picked, so a working set larger than the budget stays loaded rather than being
+// released and reloaded every frame.
+int pickEvictionVictim(const std::vector<TextureEvictionCandidate>& candidates, unsigned int frame, unsigned int evictionDelay);
+
+#endif